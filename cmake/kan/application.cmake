@@ -31,6 +31,11 @@ option (KAN_APPLICATION_ENABLE_AUTO_BUILD "Whether to enable auto build command
 set (KAN_APPLICATION_AUTO_BUILD_DELAY_NS "1000000000" CACHE STRING
         "Delay between auto build commands for development builds if enabled.")
 
+# Path to shared artifact cache directory for resource build tool. Artifact cache is not used if path is empty.
+# The same directory can be used by several build directories and checkouts on the same machine.
+set (KAN_APPLICATION_RESOURCE_ARTIFACT_CACHE "" CACHE STRING
+        "Path to shared artifact cache directory for resource build tool, empty to disable artifact cache.")
+
 # Whether to enable code hot reload verification target generation.
 option (KAN_APPLICATION_GENERATE_CODE_HOT_RELOAD_TEST
         "Whether to enable code hot reload verification target generation." ON)
@@ -490,6 +495,15 @@ function (application_get_resource_build_target_name OUTPUT)
     set ("${OUTPUT}" "${APPLICATION_NAME}_resource_build" PARENT_SCOPE)
 endfunction ()
 
+# Sets variable with given name to list of resource build tool arguments for artifact cache usage.
+function (application_get_resource_build_artifact_cache_arguments OUTPUT)
+    if (KAN_APPLICATION_RESOURCE_ARTIFACT_CACHE)
+        set ("${OUTPUT}" "--artifact-cache" "${KAN_APPLICATION_RESOURCE_ARTIFACT_CACHE}" PARENT_SCOPE)
+    else ()
+        set ("${OUTPUT}" "" PARENT_SCOPE)
+    endif ()
+endfunction ()
+
 # Sets variable with given name to path of resource project for current application.
 function (application_get_resource_project_path OUTPUT)
     set ("${OUTPUT}" "${CMAKE_BINARY_DIR}/workspace/${APPLICATION_NAME}/resource_project.rd" PARENT_SCOPE)
@@ -1009,6 +1023,7 @@ function (application_generate)
         endforeach ()
 
         application_get_resource_build_target_name (RESOURCE_BUILD)
+        application_get_resource_build_artifact_cache_arguments (RESOURCE_BUILD_ARTIFACT_CACHE_ARGUMENTS)
         add_custom_target ("${PROGRAM}_build_resources"
                 DEPENDS
                 "${APPLICATION_NAME}_prepare_dev_directories"
@@ -1019,6 +1034,7 @@ function (application_generate)
                 "--project" "${RESOURCE_PROJECT_PATH}"
                 "--log" "quiet"
                 "--pack" "none"
+                ${RESOURCE_BUILD_ARTIFACT_CACHE_ARGUMENTS}
                 "--targets" ${BUILD_TARGETS}
                 JOB_POOL "${APPLICATION_NAME}_resource_build_pool"
                 COMMENT "Building resource for application \"${APPLICATION_NAME}\" program \"${PROGRAM_NAME}\"."
@@ -1370,6 +1386,7 @@ function (application_generate)
         endforeach ()
 
         application_get_resource_build_target_name (RESOURCE_BUILD)
+        application_get_resource_build_artifact_cache_arguments (RESOURCE_BUILD_ARTIFACT_CACHE_ARGUMENTS)
         add_custom_target ("${VARIANT}_build_resources"
                 DEPENDS
                 "${VARIANT}_prepare_directories"
@@ -1381,6 +1398,7 @@ function (application_generate)
                 "--project" "${RESOURCE_PROJECT_PATH}"
                 "--log" "quiet"
                 "--pack" "interned"
+                ${RESOURCE_BUILD_ARTIFACT_CACHE_ARGUMENTS}
                 "--targets" ${BUILDER_TARGETS}
                 JOB_POOL "${APPLICATION_NAME}_resource_build_pool"
                 COMMENT "Running resource build for application \"${APPLICATION_NAME}\" variant \"${NAME}\"."
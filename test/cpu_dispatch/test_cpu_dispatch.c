@@ -3,6 +3,7 @@
 #include <time.h>
 
 #include <kan/cpu_dispatch/job.h>
+#include <kan/cpu_dispatch/parallel_for.h>
 #include <kan/cpu_dispatch/task.h>
 #include <kan/memory/allocation.h>
 #include <kan/precise_time/precise_time.h>
@@ -274,3 +275,106 @@ KAN_TEST_CASE (job_1000_completion_task)
         }
     }
 }
+
+#define TEST_PARALLEL_FOR_ITEMS 1000u
+#define TEST_PARALLEL_FOR_NESTED_ITEMS 64u
+
+struct test_parallel_for_user_data_t
+{
+    kan_instance_size_t max_worker_index;
+    struct kan_atomic_int_t invalid_worker_indices;
+    struct test_task_user_data_t items[TEST_PARALLEL_FOR_ITEMS];
+    struct kan_atomic_int_t executions[TEST_PARALLEL_FOR_ITEMS];
+};
+
+static void test_parallel_for_function (kan_functor_user_data_t user_data,
+                                        kan_instance_size_t worker_index,
+                                        kan_instance_size_t item_index)
+{
+    struct test_parallel_for_user_data_t *data = (struct test_parallel_for_user_data_t *) user_data;
+    if (worker_index > data->max_worker_index)
+    {
+        kan_atomic_int_add (&data->invalid_worker_indices, 1);
+    }
+
+    test_task_function ((kan_functor_user_data_t) &data->items[item_index]);
+    kan_atomic_int_add (&data->executions[item_index], 1);
+}
+
+static void test_parallel_for_execute (struct test_parallel_for_user_data_t *data, kan_instance_size_t items_count)
+{
+    data->max_worker_index = kan_cpu_parallel_for_get_helpers_count (items_count, KAN_INT_MAX (kan_instance_size_t));
+    data->invalid_worker_indices = kan_atomic_int_init (0);
+
+    for (kan_loop_size_t index = 0u; index < items_count; ++index)
+    {
+        data->items[index].work_done = kan_atomic_int_init (0);
+        data->executions[index] = kan_atomic_int_init (0);
+    }
+
+    kan_cpu_parallel_for_execute ((struct kan_cpu_parallel_for_t) {
+        .function = test_parallel_for_function,
+        .user_data = (kan_functor_user_data_t) data,
+        .items_count = items_count,
+        .max_helpers = KAN_INT_MAX (kan_instance_size_t),
+        .helper_profiler_section = kan_cpu_section_get ("test_parallel_for"),
+    });
+}
+
+static void test_parallel_for_check (struct test_parallel_for_user_data_t *data, kan_instance_size_t items_count)
+{
+    // Parallel for must only return after every item is processed exactly once.
+    KAN_TEST_CHECK (kan_atomic_int_get (&data->invalid_worker_indices) == 0)
+    for (kan_loop_size_t index = 0u; index < items_count; ++index)
+    {
+        KAN_TEST_CHECK (kan_atomic_int_get (&data->items[index].work_done) == 1)
+        KAN_TEST_CHECK (kan_atomic_int_get (&data->executions[index]) == 1)
+    }
+}
+
+KAN_TEST_CASE (parallel_for_1000_items)
+{
+    static struct test_parallel_for_user_data_t data;
+    test_parallel_for_execute (&data, TEST_PARALLEL_FOR_ITEMS);
+    test_parallel_for_check (&data, TEST_PARALLEL_FOR_ITEMS);
+
+    test_parallel_for_execute (&data, 1u);
+    test_parallel_for_check (&data, 1u);
+    test_parallel_for_execute (&data, 0u);
+}
+
+static void test_parallel_for_nested_task (kan_functor_user_data_t user_data)
+{
+    struct test_parallel_for_user_data_t *data = (struct test_parallel_for_user_data_t *) user_data;
+    test_parallel_for_execute (data, TEST_PARALLEL_FOR_NESTED_ITEMS);
+}
+
+KAN_TEST_CASE (parallel_for_inside_tasks)
+{
+    // Every worker executes parallel for at the same time, so helper tasks have nobody to execute them until some
+    // of the parallel for calls are finished. It must not result in deadlock.
+    const kan_instance_size_t tasks_count = kan_platform_get_cpu_logical_core_count () * 2u;
+    struct test_parallel_for_user_data_t *data =
+        kan_allocate_general (KAN_ALLOCATION_GROUP_IGNORE, sizeof (struct test_parallel_for_user_data_t) * tasks_count,
+                              alignof (struct test_parallel_for_user_data_t));
+
+    const kan_cpu_job_t job = kan_cpu_job_create ();
+    for (kan_loop_size_t index = 0u; index < tasks_count; ++index)
+    {
+        kan_cpu_task_detach (kan_cpu_job_dispatch_task (job, (struct kan_cpu_task_t) {
+                                                                 .function = test_parallel_for_nested_task,
+                                                                 .user_data = (kan_functor_user_data_t) &data[index],
+                                                                 .profiler_section = kan_cpu_section_get ("test_task"),
+                                                             }));
+    }
+
+    kan_cpu_job_release (job);
+    kan_cpu_job_wait (job);
+
+    for (kan_loop_size_t index = 0u; index < tasks_count; ++index)
+    {
+        test_parallel_for_check (&data[index], TEST_PARALLEL_FOR_NESTED_ITEMS);
+    }
+
+    kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, data, sizeof (struct test_parallel_for_user_data_t) * tasks_count);
+}
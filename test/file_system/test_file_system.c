@@ -1,8 +1,13 @@
 #include <string.h>
 
+#include <kan/api_common/min_max.h>
+#include <kan/file_system/async_read.h>
 #include <kan/file_system/entry.h>
 #include <kan/file_system/stream.h>
+#include <kan/precise_time/precise_time.h>
+#include <kan/stream/random_access_stream_buffer.h>
 #include <kan/testing/testing.h>
+#include <kan/threading/atomic.h>
 
 static bool write_text_file (const char *file, const char *content)
 {
@@ -97,3 +102,294 @@ KAN_TEST_CASE (query_status)
 
     KAN_TEST_CHECK (kan_file_system_remove_directory_with_content ("test_directory"))
 }
+
+static void async_read_completion_callback (kan_file_system_async_read_t read, kan_functor_user_data_t user_data)
+{
+    kan_atomic_int_add ((struct kan_atomic_int_t *) user_data, 1);
+}
+
+KAN_TEST_CASE (async_read)
+{
+    KAN_TEST_CHECK (write_text_file ("test.txt", "Hello, async world!"))
+    struct kan_atomic_int_t completed = kan_atomic_int_init (0);
+
+    char first_buffer[5u];
+    char second_buffer[32u];
+
+    kan_file_system_async_read_t first_read = kan_file_system_async_read_submit (
+        &(struct kan_file_system_async_read_request_t) {
+            .path = "test.txt",
+            .offset = 0u,
+            .size = sizeof (first_buffer),
+            .buffer = first_buffer,
+            .completion_callback = async_read_completion_callback,
+            .completion_user_data = (kan_functor_user_data_t) &completed,
+        });
+
+    // Requests more than file contains in order to check that read size is properly clamped.
+    kan_file_system_async_read_t second_read = kan_file_system_async_read_submit (
+        &(struct kan_file_system_async_read_request_t) {
+            .path = "test.txt",
+            .offset = 7u,
+            .size = sizeof (second_buffer),
+            .buffer = second_buffer,
+            .completion_callback = async_read_completion_callback,
+            .completion_user_data = (kan_functor_user_data_t) &completed,
+        });
+
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (first_read))
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (second_read))
+
+    KAN_TEST_CHECK (kan_file_system_async_read_wait (first_read) == KAN_FILE_SYSTEM_ASYNC_READ_STATUS_SUCCESSFUL)
+    KAN_TEST_CHECK (kan_file_system_async_read_wait (second_read) == KAN_FILE_SYSTEM_ASYNC_READ_STATUS_SUCCESSFUL)
+    KAN_TEST_CHECK (kan_file_system_async_read_get_read_size (first_read) == 5u)
+    KAN_TEST_CHECK (kan_file_system_async_read_get_read_size (second_read) == 12u)
+    KAN_TEST_CHECK (memcmp (first_buffer, "Hello", 5u) == 0)
+    KAN_TEST_CHECK (memcmp (second_buffer, "async world!", 12u) == 0)
+
+    kan_file_system_async_read_destroy (first_read);
+    kan_file_system_async_read_destroy (second_read);
+
+    // Callbacks are executed after status update, therefore we need to wait for them separately.
+    while (kan_atomic_int_get (&completed) < 2)
+    {
+        kan_precise_time_sleep (100000u);
+    }
+
+    KAN_TEST_CHECK (!KAN_HANDLE_IS_VALID (kan_file_system_async_read_submit (
+        &(struct kan_file_system_async_read_request_t) {
+            .path = "not_existing.txt",
+            .offset = 0u,
+            .size = sizeof (first_buffer),
+            .buffer = first_buffer,
+            .completion_callback = NULL,
+            .completion_user_data = 0u,
+        })))
+
+    KAN_TEST_CHECK (kan_file_system_remove_file ("test.txt"))
+}
+
+#define READ_AHEAD_TEST_SIZE 10000u
+#define READ_AHEAD_TEST_MIN_BLOCK 256u
+#define READ_AHEAD_TEST_MAX_BLOCK 1024u
+
+static inline uint8_t read_ahead_test_byte (kan_file_size_t position)
+{
+    // Mix in high bits too, so data is not periodic with power of two block sizes.
+    return (uint8_t) ((position * 7u + position / 251u) & 0xFFu);
+}
+
+static void write_read_ahead_test_file (const char *file)
+{
+    uint8_t data[READ_AHEAD_TEST_SIZE];
+    for (kan_file_size_t index = 0u; index < READ_AHEAD_TEST_SIZE; ++index)
+    {
+        data[index] = read_ahead_test_byte (index);
+    }
+
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_write (file, true);
+    KAN_TEST_ASSERT (stream)
+    KAN_TEST_CHECK (stream->operations->write (stream, READ_AHEAD_TEST_SIZE, data) == READ_AHEAD_TEST_SIZE)
+    stream->operations->close (stream);
+}
+
+static bool check_read_ahead_data (const uint8_t *data, kan_file_size_t position, kan_file_size_t size)
+{
+    for (kan_file_size_t index = 0u; index < size; ++index)
+    {
+        if (data[index] != read_ahead_test_byte (position + index))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static struct kan_stream_t *open_read_ahead_test_file (const char *file)
+{
+    struct kan_stream_t *source = kan_direct_file_stream_open_for_read (file, true);
+    KAN_TEST_ASSERT (source)
+
+    struct kan_stream_t *stream = kan_random_access_stream_buffer_open_for_read_ahead (
+        source, READ_AHEAD_TEST_MIN_BLOCK, READ_AHEAD_TEST_MAX_BLOCK);
+    KAN_TEST_ASSERT (stream)
+    return stream;
+}
+
+KAN_TEST_CASE (read_ahead_sequential)
+{
+    write_read_ahead_test_file ("test.bin");
+    struct kan_stream_t *stream = open_read_ahead_test_file ("test.bin");
+
+    // Chunk size is not a divisor of block size, therefore reads regularly cross block boundaries.
+    uint8_t buffer[97u];
+    kan_file_size_t position = 0u;
+
+    while (position < READ_AHEAD_TEST_SIZE)
+    {
+        const kan_file_size_t expected = KAN_MIN (sizeof (buffer), READ_AHEAD_TEST_SIZE - position);
+        const kan_file_size_t read = stream->operations->read (stream, sizeof (buffer), buffer);
+        KAN_TEST_ASSERT (read == expected)
+        KAN_TEST_ASSERT (check_read_ahead_data (buffer, position, read))
+
+        position += read;
+        KAN_TEST_CHECK (stream->operations->tell (stream) == position)
+    }
+
+    KAN_TEST_CHECK (stream->operations->read (stream, sizeof (buffer), buffer) == 0u)
+    stream->operations->close (stream);
+    KAN_TEST_CHECK (kan_file_system_remove_file ("test.bin"))
+}
+
+KAN_TEST_CASE (read_ahead_seek)
+{
+    write_read_ahead_test_file ("test.bin");
+    struct kan_stream_t *stream = open_read_ahead_test_file ("test.bin");
+    uint8_t buffer[READ_AHEAD_TEST_SIZE];
+
+    KAN_TEST_CHECK (stream->operations->read (stream, 100u, buffer) == 100u)
+    KAN_TEST_CHECK (check_read_ahead_data (buffer, 0u, 100u))
+
+    // Forward seek far outside of current and read ahead blocks.
+    KAN_TEST_CHECK (stream->operations->seek (stream, KAN_STREAM_SEEK_START, 8000))
+    KAN_TEST_CHECK (stream->operations->read (stream, 300u, buffer) == 300u)
+    KAN_TEST_CHECK (check_read_ahead_data (buffer, 8000u, 300u))
+
+    // Backward seek outside of the window.
+    KAN_TEST_CHECK (stream->operations->seek (stream, KAN_STREAM_SEEK_START, 50))
+    KAN_TEST_CHECK (stream->operations->read (stream, 500u, buffer) == 500u)
+    KAN_TEST_CHECK (check_read_ahead_data (buffer, 50u, 500u))
+
+    // Relative seek that lands into the block that was just read.
+    KAN_TEST_CHECK (stream->operations->seek (stream, KAN_STREAM_SEEK_CURRENT, -200))
+    KAN_TEST_CHECK (stream->operations->tell (stream) == 350u)
+    KAN_TEST_CHECK (stream->operations->read (stream, 10u, buffer) == 10u)
+    KAN_TEST_CHECK (check_read_ahead_data (buffer, 350u, 10u))
+
+    // Request that is bigger than block is read directly from the source.
+    KAN_TEST_CHECK (stream->operations->seek (stream, KAN_STREAM_SEEK_START, 1000))
+    KAN_TEST_CHECK (stream->operations->read (stream, 3000u, buffer) == 3000u)
+    KAN_TEST_CHECK (check_read_ahead_data (buffer, 1000u, 3000u))
+
+    // Sequential read must still work after direct read.
+    KAN_TEST_CHECK (stream->operations->read (stream, 700u, buffer) == 700u)
+    KAN_TEST_CHECK (check_read_ahead_data (buffer, 4000u, 700u))
+
+    // Read near the end is clamped by stream size.
+    KAN_TEST_CHECK (stream->operations->seek (stream, KAN_STREAM_SEEK_END, -20))
+    KAN_TEST_CHECK (stream->operations->read (stream, 100u, buffer) == 20u)
+    KAN_TEST_CHECK (check_read_ahead_data (buffer, READ_AHEAD_TEST_SIZE - 20u, 20u))
+
+    stream->operations->close (stream);
+    KAN_TEST_CHECK (kan_file_system_remove_file ("test.bin"))
+}
+
+/// \brief Memory stream that reports bigger size than it can actually read, like file that was truncated after open.
+struct truncated_test_stream_t
+{
+    struct kan_stream_t as_stream;
+    kan_file_size_t position;
+    kan_file_size_t reported_size;
+    kan_file_size_t available_size;
+};
+
+static kan_file_size_t truncated_test_stream_read (struct kan_stream_t *stream,
+                                                   kan_file_size_t amount,
+                                                   void *output_buffer)
+{
+    struct truncated_test_stream_t *data = (struct truncated_test_stream_t *) stream;
+    if (data->position >= data->available_size)
+    {
+        return 0u;
+    }
+
+    amount = KAN_MIN (amount, data->available_size - data->position);
+    for (kan_file_size_t index = 0u; index < amount; ++index)
+    {
+        ((uint8_t *) output_buffer)[index] = read_ahead_test_byte (data->position + index);
+    }
+
+    data->position += amount;
+    return amount;
+}
+
+static kan_file_size_t truncated_test_stream_tell (struct kan_stream_t *stream)
+{
+    return ((struct truncated_test_stream_t *) stream)->position;
+}
+
+static bool truncated_test_stream_seek (struct kan_stream_t *stream,
+                                        enum kan_stream_seek_pivot pivot,
+                                        kan_file_offset_t offset)
+{
+    struct truncated_test_stream_t *data = (struct truncated_test_stream_t *) stream;
+    switch (pivot)
+    {
+    case KAN_STREAM_SEEK_START:
+        data->position = (kan_file_size_t) offset;
+        break;
+
+    case KAN_STREAM_SEEK_CURRENT:
+        data->position = (kan_file_size_t) ((kan_file_offset_t) data->position + offset);
+        break;
+
+    case KAN_STREAM_SEEK_END:
+        data->position = (kan_file_size_t) ((kan_file_offset_t) data->reported_size + offset);
+        break;
+    }
+
+    return true;
+}
+
+static void truncated_test_stream_close (struct kan_stream_t *stream)
+{
+    ((struct truncated_test_stream_t *) stream)->position = KAN_INT_MAX (kan_file_size_t);
+}
+
+static struct kan_stream_operations_t truncated_test_stream_operations = {
+    .read = truncated_test_stream_read,
+    .write = NULL,
+    .flush = NULL,
+    .tell = truncated_test_stream_tell,
+    .seek = truncated_test_stream_seek,
+    .close = truncated_test_stream_close,
+};
+
+KAN_TEST_CASE (read_ahead_eof_during_prefetch)
+{
+    // Data ends in the middle of one of the blocks, therefore its prefetch hits end of file.
+    struct truncated_test_stream_t source = {
+        .as_stream = {.operations = &truncated_test_stream_operations},
+        .position = 0u,
+        .reported_size = READ_AHEAD_TEST_SIZE,
+        .available_size = READ_AHEAD_TEST_SIZE / 2u + 17u,
+    };
+
+    struct kan_stream_t *stream = kan_random_access_stream_buffer_open_for_read_ahead (
+        &source.as_stream, READ_AHEAD_TEST_MIN_BLOCK, READ_AHEAD_TEST_MAX_BLOCK);
+    KAN_TEST_ASSERT (stream)
+
+    uint8_t buffer[97u];
+    kan_file_size_t position = 0u;
+    kan_file_size_t read;
+
+    while ((read = stream->operations->read (stream, sizeof (buffer), buffer)) > 0u)
+    {
+        KAN_TEST_ASSERT (check_read_ahead_data (buffer, position, read))
+        position += read;
+        KAN_TEST_ASSERT (position <= source.available_size)
+    }
+
+    // Only the block that contains end of data can be lost, everything before it must be read.
+    KAN_TEST_CHECK (position + READ_AHEAD_TEST_MAX_BLOCK > source.available_size)
+    KAN_TEST_CHECK (stream->operations->read (stream, sizeof (buffer), buffer) == 0u)
+
+    // Seek back to the readable part must still work after failed prefetch.
+    KAN_TEST_CHECK (stream->operations->seek (stream, KAN_STREAM_SEEK_START, 100))
+    KAN_TEST_CHECK (stream->operations->read (stream, 50u, buffer) == 50u)
+    KAN_TEST_CHECK (check_read_ahead_data (buffer, 100u, 50u))
+
+    stream->operations->close (stream);
+    KAN_TEST_CHECK (source.position == KAN_INT_MAX (kan_file_size_t))
+}
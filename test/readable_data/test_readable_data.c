@@ -2,6 +2,7 @@
 
 #include <math.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <kan/file_system/stream.h>
@@ -36,14 +37,11 @@ static void save_text_to_file (const char *text)
     buffered_file_stream->operations->close (buffered_file_stream);
 }
 
-static void parse_file_and_check (const struct kan_readable_data_event_t *events, kan_instance_size_t events_count)
+static void parse_and_check (kan_readable_data_parser_t parser,
+                             const struct kan_readable_data_event_t *events,
+                             kan_instance_size_t events_count)
 {
-    struct kan_stream_t *direct_file_stream = kan_direct_file_stream_open_for_read ("test.rd", true);
-    struct kan_stream_t *buffered_file_stream =
-        kan_random_access_stream_buffer_open_for_read (direct_file_stream, 1024u);
-
     kan_instance_size_t event_index = 0u;
-    kan_readable_data_parser_t parser = kan_readable_data_parser_create (buffered_file_stream);
 
     while (true)
     {
@@ -170,9 +168,26 @@ static void parse_file_and_check (const struct kan_readable_data_event_t *events
 
     KAN_TEST_CHECK (event_index == events_count)
     kan_readable_data_parser_destroy (parser);
+}
+
+static void parse_file_and_check (const struct kan_readable_data_event_t *events, kan_instance_size_t events_count)
+{
+    struct kan_stream_t *direct_file_stream = kan_direct_file_stream_open_for_read ("test.rd", true);
+    struct kan_stream_t *buffered_file_stream =
+        kan_random_access_stream_buffer_open_for_read (direct_file_stream, 1024u);
+
+    parse_and_check (kan_readable_data_parser_create (buffered_file_stream), events, events_count);
     buffered_file_stream->operations->close (buffered_file_stream);
 }
 
+static void parse_buffer_and_check (const char *text,
+                                    const struct kan_readable_data_event_t *events,
+                                    kan_instance_size_t events_count)
+{
+    parse_and_check (kan_readable_data_parser_create_for_buffer (text, (kan_instance_size_t) strlen (text)), events,
+                     events_count);
+}
+
 KAN_TEST_CASE (emit_and_parse_all_elemental_setters)
 {
 #define TEST_EVENTS_COUNT 6u
@@ -535,7 +550,7 @@ KAN_TEST_CASE (human_input_corner_cases)
         .setter_value_first = &position_x_node,
     };
 
-    save_text_to_file (
+    const char *text =
         "//! some_data_type_t\n"
         "\n"
         "// Movement config id for our character.\n"
@@ -547,8 +562,101 @@ KAN_TEST_CASE (human_input_corner_cases)
         "// Split everything here just for fun.\n"
         "\" readable\" \" data!\"\n"
         "health_max =     100\n"
-        "transform.position   = -1.34, 5.5\n");
+        "transform.position   = -1.34, 5.5\n";
+
+    save_text_to_file (text);
+    parse_file_and_check (events_to_emit, TEST_EVENTS_COUNT);
+    parse_buffer_and_check (text, events_to_emit, TEST_EVENTS_COUNT);
+#undef TEST_EVENTS_COUNT
+}
+
+/// \brief Appends given count of separators to the output and returns pointer to the appended data end.
+/// \details Separators between statements include every separator symbol, but always end with new line. Separators
+///          inside statement only use spaces and tabs.
+static char *append_separators (char *output, kan_instance_size_t count, bool between_statements)
+{
+    const char *pattern = between_statements ? " \t\r\n\v\f \n" : " \t  ";
+    const kan_instance_size_t pattern_length = (kan_instance_size_t) strlen (pattern);
+
+    for (kan_loop_size_t index = 0u; index < count; ++index)
+    {
+        output[index] = between_statements && index + 1u == count ? '\n' : pattern[index % pattern_length];
+    }
+
+    return output + count;
+}
+
+KAN_TEST_CASE (long_separator_runs)
+{
+    // Separators are skipped 16 symbols at a time when possible, therefore runs around multiples of 16 check both
+    // chunked skip with separator run ending in every part of the chunk and scalar skip of the remaining tail.
+    const kan_instance_size_t run_lengths[] = {1u, 15u, 16u, 17u, 18u, 31u, 32u, 33u, 47u, 48u, 49u, 64u, 100u};
+#define TEST_RUNS_COUNT (sizeof (run_lengths) / sizeof (run_lengths[0u]))
+#define TEST_EVENTS_COUNT (TEST_RUNS_COUNT + 1u)
+#define TEST_TEXT_MAX_LENGTH 4096u
+
+    struct kan_readable_data_event_t events_to_emit[TEST_EVENTS_COUNT];
+    struct kan_readable_data_value_node_t value_nodes[TEST_RUNS_COUNT];
+    char text[TEST_TEXT_MAX_LENGTH];
+    char *text_end = text;
+
+    for (kan_loop_size_t index = 0u; index < TEST_RUNS_COUNT; ++index)
+    {
+        value_nodes[index] = (struct kan_readable_data_value_node_t) {
+            .next = NULL,
+            .integer = (kan_instance_offset_t) run_lengths[index],
+        };
+
+        events_to_emit[index] = (struct kan_readable_data_event_t) {
+            .type = KAN_READABLE_DATA_EVENT_ELEMENTAL_INTEGER_SETTER,
+            .output_target =
+                {
+                    .identifier = "run_lengths",
+                    .array_index = (kan_instance_size_t) index,
+                },
+            .setter_value_first = &value_nodes[index],
+        };
+
+        // The longest statement is three runs and less than 32 other symbols.
+        KAN_TEST_ASSERT (text_end + run_lengths[index] * 3u + 32u < text + TEST_TEXT_MAX_LENGTH)
+        text_end = append_separators (text_end, run_lengths[index], true);
+        text_end += sprintf (text_end, "run_lengths[%lu]", (unsigned long) index);
+        text_end = append_separators (text_end, run_lengths[index], false);
+        *text_end++ = '=';
+        text_end = append_separators (text_end, run_lengths[index], false);
+        text_end += sprintf (text_end, "%lu", (unsigned long) run_lengths[index]);
+    }
+
+    // Separators inside strings must be preserved, while separators between string parts must be skipped.
+    struct kan_readable_data_value_node_t string_node = {
+        .next = NULL,
+        .string = "Hello                    world!",
+    };
+
+    events_to_emit[TEST_RUNS_COUNT] = (struct kan_readable_data_event_t) {
+        .type = KAN_READABLE_DATA_EVENT_ELEMENTAL_STRING_SETTER,
+        .output_target =
+            {
+                .identifier = "phrase",
+                .array_index = KAN_READABLE_DATA_ARRAY_INDEX_NONE,
+            },
+        .setter_value_first = &string_node,
+    };
+
+    KAN_TEST_ASSERT (text_end + 128u < text + TEST_TEXT_MAX_LENGTH)
+    text_end = append_separators (text_end, 20u, true);
+    text_end += sprintf (text_end, "phrase = \"Hello           \"");
+    text_end = append_separators (text_end, 33u, true);
+    text_end += sprintf (text_end, "\"         world!\"");
+
+    // Trailing run is longer than one chunk and does not end at chunk border, so input ends inside scalar tail.
+    text_end = append_separators (text_end, 37u, true);
+    *text_end = '\0';
 
+    save_text_to_file (text);
     parse_file_and_check (events_to_emit, TEST_EVENTS_COUNT);
+    parse_buffer_and_check (text, events_to_emit, TEST_EVENTS_COUNT);
+#undef TEST_TEXT_MAX_LENGTH
 #undef TEST_EVENTS_COUNT
+#undef TEST_RUNS_COUNT
 }
@@ -1,10 +1,14 @@
 #include <memory.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <kan/api_common/alignment.h>
 #include <kan/api_common/min_max.h>
 #include <kan/container/dynamic_array.h>
+#include <kan/log/logging.h>
+#include <kan/memory/allocation.h>
+#include <kan/precise_time/precise_time.h>
 #include <kan/reflection/field_visibility_iterator.h>
 #include <kan/reflection/generated_reflection.h>
 #include <kan/reflection/migration.h>
@@ -19,6 +23,8 @@
 #include <section_patch_types_post.h>
 #include <section_patch_types_pre.h>
 
+KAN_LOG_DEFINE_CATEGORY (test_reflection);
+
 struct example_struct_meta_assembly_t
 {
     bool can_be_used_for_assembly;
@@ -547,6 +553,302 @@ KAN_TEST_CASE (query_local_field)
     kan_reflection_registry_destroy (registry);
 }
 
+#define FROZEN_REGISTRY_FILLER_STRUCTS 64u
+
+KAN_TEST_CASE (frozen_registry)
+{
+    struct kan_reflection_enum_value_t enum_values[] = {
+        {kan_string_intern ("FIRST"), 0},
+        {kan_string_intern ("SECOND"), 1},
+    };
+
+    struct kan_reflection_enum_t enum_data = {
+        .name = kan_string_intern ("frozen_enum_t"),
+        .size = sizeof (int),
+        .flags = false,
+        .values_count = sizeof (enum_values) / sizeof (struct kan_reflection_enum_value_t),
+        .values = enum_values,
+    };
+
+    struct kan_reflection_field_t first_struct_fields[] = {
+        {
+            kan_string_intern ("first"),
+            0u,
+            sizeof (int32_t),
+            KAN_REFLECTION_ARCHETYPE_SIGNED_INT,
+            .visibility_condition_field = NULL,
+            .visibility_condition_values_count = 0u,
+            .visibility_condition_values = NULL,
+        },
+        {
+            kan_string_intern ("second"),
+            sizeof (int32_t),
+            sizeof (uint32_t),
+            KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+            .visibility_condition_field = NULL,
+            .visibility_condition_values_count = 0u,
+            .visibility_condition_values = NULL,
+        },
+        {
+            kan_string_intern ("third"),
+            sizeof (int32_t) + sizeof (uint32_t),
+            sizeof (kan_interned_string_t),
+            KAN_REFLECTION_ARCHETYPE_INTERNED_STRING,
+            .visibility_condition_field = NULL,
+            .visibility_condition_values_count = 0u,
+            .visibility_condition_values = NULL,
+        },
+    };
+
+    struct kan_reflection_struct_t first_struct = {
+        kan_string_intern ("frozen_first_t"),
+        16u,
+        8u,
+        NULL,
+        NULL,
+        0u,
+        sizeof (first_struct_fields) / sizeof (struct kan_reflection_field_t),
+        first_struct_fields,
+    };
+
+    struct kan_reflection_field_t second_struct_fields[] = {
+        {
+            .name = kan_string_intern ("first"),
+            .offset = 0u,
+            .size = sizeof (void *),
+            .archetype = KAN_REFLECTION_ARCHETYPE_STRUCT_POINTER,
+            .archetype_struct_pointer = {first_struct.name},
+            .visibility_condition_field = NULL,
+            .visibility_condition_values_count = 0u,
+            .visibility_condition_values = NULL,
+        },
+        {
+            .name = kan_string_intern ("second"),
+            .offset = (kan_instance_size_t) kan_apply_alignment (sizeof (void *), first_struct.alignment),
+            .size = first_struct.size,
+            .archetype = KAN_REFLECTION_ARCHETYPE_STRUCT,
+            .archetype_struct = {first_struct.name},
+            .visibility_condition_field = NULL,
+            .visibility_condition_values_count = 0u,
+            .visibility_condition_values = NULL,
+        },
+    };
+
+    struct kan_reflection_struct_t second_struct = {
+        kan_string_intern ("frozen_second_t"),
+        24u,
+        8u,
+        NULL,
+        NULL,
+        0u,
+        sizeof (second_struct_fields) / sizeof (struct kan_reflection_field_t),
+        second_struct_fields,
+    };
+
+    struct kan_reflection_argument_t function_arguments[] = {
+        {
+            .name = kan_string_intern ("x"),
+            .size = sizeof (int32_t),
+            .archetype = KAN_REFLECTION_ARCHETYPE_SIGNED_INT,
+        },
+    };
+
+    struct kan_reflection_function_t function = {
+        .name = kan_string_intern ("frozen_function"),
+        .call = function_call_functor_stub,
+        .call_user_data = 0u,
+        .return_type = {.size = 0u, .archetype = KAN_REFLECTION_ARCHETYPE_SIGNED_INT},
+        .arguments_count = sizeof (function_arguments) / sizeof (struct kan_reflection_argument_t),
+        .arguments = function_arguments,
+    };
+
+    // Every meta type below is added twice to the same owner, so frozen index slots for these metas store ranges
+    // with several nodes and iterators must walk through the whole range.
+    struct example_enum_meta_serialization_t enum_serialization[] = {{1u}, {2u}};
+    struct example_universal_meta_editor_t enum_value_editor[] = {{"FIRST", "first", false}, {"FIRST", "", true}};
+    struct example_universal_meta_editor_t struct_editor[] = {{"frozen_first_t", "first", false},
+                                                              {"frozen_first_t", "second", true}};
+    struct example_struct_meta_assembly_t struct_assembly = {true};
+    struct example_field_meta_min_max_t field_min_max[] = {{-10, 10}, {0, 16}};
+    struct example_function_meta_editor_action_t function_editor_action[] = {{"Tools", "Bake", "Bake"},
+                                                                            {"Tools", "Rebake", "Rebake"}};
+    struct example_argument_meta_min_max_t argument_min_max[] = {{-10, 10}, {0, 16}};
+
+    // Filler structs make frozen index big enough to have lots of slots and hash collisions during seed search.
+    char filler_names[FROZEN_REGISTRY_FILLER_STRUCTS][32u];
+    struct kan_reflection_struct_t filler_structs[FROZEN_REGISTRY_FILLER_STRUCTS];
+
+    kan_reflection_registry_t registry = kan_reflection_registry_create ();
+    for (kan_loop_size_t index = 0u; index < FROZEN_REGISTRY_FILLER_STRUCTS; ++index)
+    {
+        snprintf (filler_names[index], sizeof (filler_names[index]), "frozen_filler_%lu_t", (unsigned long) index);
+        filler_structs[index] = first_struct;
+        filler_structs[index].name = kan_string_intern (filler_names[index]);
+        KAN_TEST_CHECK (kan_reflection_registry_add_struct (registry, &filler_structs[index]))
+    }
+
+    KAN_TEST_CHECK (kan_reflection_registry_add_enum (registry, &enum_data))
+    KAN_TEST_CHECK (kan_reflection_registry_add_struct (registry, &first_struct))
+    KAN_TEST_CHECK (kan_reflection_registry_add_struct (registry, &second_struct))
+    KAN_TEST_CHECK (kan_reflection_registry_add_function (registry, &function))
+
+    const kan_interned_string_t enum_serialization_name = kan_string_intern ("example_enum_meta_serialization_t");
+    const kan_interned_string_t editor_name = kan_string_intern ("example_universal_meta_editor_t");
+    const kan_interned_string_t assembly_name = kan_string_intern ("example_struct_meta_assembly_t");
+    const kan_interned_string_t field_min_max_name = kan_string_intern ("example_field_meta_min_max_t");
+    const kan_interned_string_t editor_action_name = kan_string_intern ("example_function_meta_editor_action_t");
+    const kan_interned_string_t argument_min_max_name = kan_string_intern ("example_argument_meta_min_max_t");
+
+    for (kan_loop_size_t index = 0u; index < 2u; ++index)
+    {
+        kan_reflection_registry_add_enum_meta (registry, enum_data.name, enum_serialization_name,
+                                               &enum_serialization[index]);
+        kan_reflection_registry_add_enum_value_meta (registry, enum_data.name, enum_values[0u].name, editor_name,
+                                                     &enum_value_editor[index]);
+        kan_reflection_registry_add_struct_meta (registry, first_struct.name, editor_name, &struct_editor[index]);
+        kan_reflection_registry_add_struct_field_meta (registry, first_struct.name, first_struct_fields[0u].name,
+                                                       field_min_max_name, &field_min_max[index]);
+        kan_reflection_registry_add_function_meta (registry, function.name, editor_action_name,
+                                                   &function_editor_action[index]);
+        kan_reflection_registry_add_function_argument_meta (registry, function.name, function_arguments[0u].name,
+                                                            argument_min_max_name, &argument_min_max[index]);
+    }
+
+    kan_reflection_registry_add_struct_meta (registry, first_struct.name, assembly_name, &struct_assembly);
+    kan_reflection_registry_freeze (registry);
+
+    KAN_TEST_CHECK (kan_reflection_registry_query_enum (registry, enum_data.name) == &enum_data)
+    KAN_TEST_CHECK (!kan_reflection_registry_query_enum (registry, first_struct.name))
+    KAN_TEST_CHECK (kan_reflection_registry_query_struct (registry, first_struct.name) == &first_struct)
+    KAN_TEST_CHECK (kan_reflection_registry_query_struct (registry, second_struct.name) == &second_struct)
+    KAN_TEST_CHECK (!kan_reflection_registry_query_struct (registry, kan_string_intern ("unknown_t")))
+    KAN_TEST_CHECK (kan_reflection_registry_query_function (registry, function.name) == &function)
+    KAN_TEST_CHECK (!kan_reflection_registry_query_function (registry, kan_string_intern ("unknown")))
+
+    for (kan_loop_size_t index = 0u; index < FROZEN_REGISTRY_FILLER_STRUCTS; ++index)
+    {
+        KAN_TEST_CHECK (kan_reflection_registry_query_struct (registry, filler_structs[index].name) ==
+                        &filler_structs[index])
+    }
+
+    // Meta order inside one range is not specified, therefore we only check that both values are visited once.
+    struct kan_reflection_enum_meta_iterator_t enum_meta_iterator =
+        kan_reflection_registry_query_enum_meta (registry, enum_data.name, enum_serialization_name);
+    const void *first_meta = kan_reflection_enum_meta_iterator_get (&enum_meta_iterator);
+    kan_reflection_enum_meta_iterator_next (&enum_meta_iterator);
+    const void *second_meta = kan_reflection_enum_meta_iterator_get (&enum_meta_iterator);
+    kan_reflection_enum_meta_iterator_next (&enum_meta_iterator);
+    KAN_TEST_CHECK (!kan_reflection_enum_meta_iterator_get (&enum_meta_iterator))
+    KAN_TEST_CHECK ((first_meta == &enum_serialization[0u] && second_meta == &enum_serialization[1u]) ||
+                    (first_meta == &enum_serialization[1u] && second_meta == &enum_serialization[0u]))
+
+    enum_meta_iterator = kan_reflection_registry_query_enum_meta (registry, enum_data.name, editor_name);
+    KAN_TEST_CHECK (!kan_reflection_enum_meta_iterator_get (&enum_meta_iterator))
+
+    struct kan_reflection_enum_value_meta_iterator_t enum_value_meta_iterator =
+        kan_reflection_registry_query_enum_value_meta (registry, enum_data.name, enum_values[0u].name, editor_name);
+    first_meta = kan_reflection_enum_value_meta_iterator_get (&enum_value_meta_iterator);
+    kan_reflection_enum_value_meta_iterator_next (&enum_value_meta_iterator);
+    second_meta = kan_reflection_enum_value_meta_iterator_get (&enum_value_meta_iterator);
+    kan_reflection_enum_value_meta_iterator_next (&enum_value_meta_iterator);
+    KAN_TEST_CHECK (!kan_reflection_enum_value_meta_iterator_get (&enum_value_meta_iterator))
+    KAN_TEST_CHECK ((first_meta == &enum_value_editor[0u] && second_meta == &enum_value_editor[1u]) ||
+                    (first_meta == &enum_value_editor[1u] && second_meta == &enum_value_editor[0u]))
+
+    enum_value_meta_iterator =
+        kan_reflection_registry_query_enum_value_meta (registry, enum_data.name, enum_values[1u].name, editor_name);
+    KAN_TEST_CHECK (!kan_reflection_enum_value_meta_iterator_get (&enum_value_meta_iterator))
+
+    struct kan_reflection_struct_meta_iterator_t struct_meta_iterator =
+        kan_reflection_registry_query_struct_meta (registry, first_struct.name, editor_name);
+    first_meta = kan_reflection_struct_meta_iterator_get (&struct_meta_iterator);
+    kan_reflection_struct_meta_iterator_next (&struct_meta_iterator);
+    second_meta = kan_reflection_struct_meta_iterator_get (&struct_meta_iterator);
+    kan_reflection_struct_meta_iterator_next (&struct_meta_iterator);
+    KAN_TEST_CHECK (!kan_reflection_struct_meta_iterator_get (&struct_meta_iterator))
+    KAN_TEST_CHECK ((first_meta == &struct_editor[0u] && second_meta == &struct_editor[1u]) ||
+                    (first_meta == &struct_editor[1u] && second_meta == &struct_editor[0u]))
+
+    struct_meta_iterator = kan_reflection_registry_query_struct_meta (registry, first_struct.name, assembly_name);
+    KAN_TEST_CHECK (kan_reflection_struct_meta_iterator_get (&struct_meta_iterator) == &struct_assembly)
+    kan_reflection_struct_meta_iterator_next (&struct_meta_iterator);
+    KAN_TEST_CHECK (!kan_reflection_struct_meta_iterator_get (&struct_meta_iterator))
+
+    struct_meta_iterator = kan_reflection_registry_query_struct_meta (registry, second_struct.name, editor_name);
+    KAN_TEST_CHECK (!kan_reflection_struct_meta_iterator_get (&struct_meta_iterator))
+
+    struct kan_reflection_struct_field_meta_iterator_t struct_field_meta_iterator =
+        kan_reflection_registry_query_struct_field_meta (registry, first_struct.name, first_struct_fields[0u].name,
+                                                         field_min_max_name);
+    first_meta = kan_reflection_struct_field_meta_iterator_get (&struct_field_meta_iterator);
+    kan_reflection_struct_field_meta_iterator_next (&struct_field_meta_iterator);
+    second_meta = kan_reflection_struct_field_meta_iterator_get (&struct_field_meta_iterator);
+    kan_reflection_struct_field_meta_iterator_next (&struct_field_meta_iterator);
+    KAN_TEST_CHECK (!kan_reflection_struct_field_meta_iterator_get (&struct_field_meta_iterator))
+    KAN_TEST_CHECK ((first_meta == &field_min_max[0u] && second_meta == &field_min_max[1u]) ||
+                    (first_meta == &field_min_max[1u] && second_meta == &field_min_max[0u]))
+
+    struct_field_meta_iterator = kan_reflection_registry_query_struct_field_meta (
+        registry, first_struct.name, first_struct_fields[1u].name, field_min_max_name);
+    KAN_TEST_CHECK (!kan_reflection_struct_field_meta_iterator_get (&struct_field_meta_iterator))
+
+    struct kan_reflection_function_meta_iterator_t function_meta_iterator =
+        kan_reflection_registry_query_function_meta (registry, function.name, editor_action_name);
+    first_meta = kan_reflection_function_meta_iterator_get (&function_meta_iterator);
+    kan_reflection_function_meta_iterator_next (&function_meta_iterator);
+    second_meta = kan_reflection_function_meta_iterator_get (&function_meta_iterator);
+    kan_reflection_function_meta_iterator_next (&function_meta_iterator);
+    KAN_TEST_CHECK (!kan_reflection_function_meta_iterator_get (&function_meta_iterator))
+    KAN_TEST_CHECK ((first_meta == &function_editor_action[0u] && second_meta == &function_editor_action[1u]) ||
+                    (first_meta == &function_editor_action[1u] && second_meta == &function_editor_action[0u]))
+
+    struct kan_reflection_function_argument_meta_iterator_t argument_meta_iterator =
+        kan_reflection_registry_query_function_argument_meta (registry, function.name, function_arguments[0u].name,
+                                                              argument_min_max_name);
+    first_meta = kan_reflection_function_argument_meta_iterator_get (&argument_meta_iterator);
+    kan_reflection_function_argument_meta_iterator_next (&argument_meta_iterator);
+    second_meta = kan_reflection_function_argument_meta_iterator_get (&argument_meta_iterator);
+    kan_reflection_function_argument_meta_iterator_next (&argument_meta_iterator);
+    KAN_TEST_CHECK (!kan_reflection_function_argument_meta_iterator_get (&argument_meta_iterator))
+    KAN_TEST_CHECK ((first_meta == &argument_min_max[0u] && second_meta == &argument_min_max[1u]) ||
+                    (first_meta == &argument_min_max[1u] && second_meta == &argument_min_max[0u]))
+
+    // Field queries are done twice: first query resolves path through frozen indices and fills the cache,
+    // second query is served from the cache. Failed queries are never cached and must fail both times.
+    for (kan_loop_size_t pass = 0u; pass < 2u; ++pass)
+    {
+        kan_instance_size_t absolute_offset;
+        kan_instance_size_t size_with_padding;
+        kan_interned_string_t first_second_path[] = {first_struct_fields[1u].name};
+        KAN_TEST_CHECK (kan_reflection_registry_query_local_field (registry, first_struct.name, 1u, first_second_path,
+                                                                   &absolute_offset,
+                                                                   &size_with_padding) == &first_struct_fields[1u])
+        KAN_TEST_CHECK (absolute_offset == first_struct_fields[1u].offset)
+        KAN_TEST_CHECK (size_with_padding == first_struct_fields[1u].size)
+
+        kan_interned_string_t first_unknown_path[] = {kan_string_intern ("unknown")};
+        KAN_TEST_CHECK (kan_reflection_registry_query_local_field (registry, first_struct.name, 1u, first_unknown_path,
+                                                                   &absolute_offset, &size_with_padding) == NULL)
+        KAN_TEST_CHECK (absolute_offset == 0u)
+
+        kan_interned_string_t second_second_third_path[] = {second_struct_fields[1u].name,
+                                                            first_struct_fields[2u].name};
+        KAN_TEST_CHECK (kan_reflection_registry_query_local_field (registry, second_struct.name, 2u,
+                                                                   second_second_third_path, &absolute_offset,
+                                                                   &size_with_padding) == &first_struct_fields[2u])
+        KAN_TEST_CHECK (absolute_offset == second_struct_fields[1u].offset + first_struct_fields[2u].offset)
+        KAN_TEST_CHECK (size_with_padding == 8u)
+
+        kan_interned_string_t second_first_third_path[] = {second_struct_fields[0u].name, first_struct_fields[2u].name};
+        KAN_TEST_CHECK (kan_reflection_registry_query_local_field (registry, second_struct.name, 2u,
+                                                                   second_first_third_path, &absolute_offset,
+                                                                   &size_with_padding) == NULL)
+        KAN_TEST_CHECK (absolute_offset == 0u)
+    }
+
+    kan_reflection_registry_destroy (registry);
+}
+
 struct struct_with_union_t
 {
     uint32_t before;
@@ -689,6 +991,9 @@ struct patch_outer_t
     double after;
 };
 
+#define PATCH_BATCH_INSTANCES 4u
+#define PATCH_BENCHMARK_INSTANCES 65536u
+
 static bool is_patch_outer_equal (const struct patch_outer_t *first, const struct patch_outer_t *second)
 {
     return first->before == second->before && first->inner[0].first == second->inner[0].first &&
@@ -696,7 +1001,20 @@ static bool is_patch_outer_equal (const struct patch_outer_t *first, const struc
            first->inner[1].second == second->inner[1].second && first->after == second->after;
 }
 
-KAN_TEST_CASE (patch)
+/// \brief Instances and patches between them that are shared by patch tests.
+struct patch_test_data_t
+{
+    struct patch_outer_t first;
+    struct patch_outer_t second;
+    struct patch_outer_t third;
+    kan_reflection_patch_t first_to_second;
+    kan_reflection_patch_t second_to_third;
+};
+
+typedef void (*patch_test_function_t) (const struct patch_test_data_t *data);
+
+/// \brief Registers patch test types, builds patches between test instances and passes them to given function.
+static void run_patch_test (patch_test_function_t function)
 {
     struct kan_reflection_field_t patch_inner_fields[] = {
         {.name = kan_string_intern ("first"),
@@ -830,20 +1148,36 @@ KAN_TEST_CASE (patch)
     KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (second_to_third))
     kan_reflection_patch_builder_destroy (patch_builder);
 
-    KAN_TEST_CHECK (!is_patch_outer_equal (&first, &second))
-    KAN_TEST_CHECK (!is_patch_outer_equal (&second, &third))
+    struct patch_test_data_t data = {
+        .first = first,
+        .second = second,
+        .third = third,
+        .first_to_second = first_to_second,
+        .second_to_third = second_to_third,
+    };
 
-    struct patch_outer_t test = first;
-    KAN_TEST_CHECK (is_patch_outer_equal (&first, &test))
+    function (&data);
 
-    kan_reflection_patch_apply (first_to_second, &test);
-    KAN_TEST_CHECK (is_patch_outer_equal (&second, &test))
+    // Patches will be automatically destroyed with owning registry.
+    kan_reflection_registry_destroy (registry);
+}
 
-    kan_reflection_patch_apply (second_to_third, &test);
-    KAN_TEST_CHECK (is_patch_outer_equal (&third, &test))
+static void check_patch (const struct patch_test_data_t *data)
+{
+    KAN_TEST_CHECK (!is_patch_outer_equal (&data->first, &data->second))
+    KAN_TEST_CHECK (!is_patch_outer_equal (&data->second, &data->third))
+
+    struct patch_outer_t test = data->first;
+    KAN_TEST_CHECK (is_patch_outer_equal (&data->first, &test))
+
+    kan_reflection_patch_apply (data->first_to_second, &test);
+    KAN_TEST_CHECK (is_patch_outer_equal (&data->second, &test))
 
-    kan_reflection_patch_iterator_t iterator = kan_reflection_patch_begin (first_to_second);
-    kan_reflection_patch_iterator_t end = kan_reflection_patch_end (first_to_second);
+    kan_reflection_patch_apply (data->second_to_third, &test);
+    KAN_TEST_CHECK (is_patch_outer_equal (&data->third, &test))
+
+    kan_reflection_patch_iterator_t iterator = kan_reflection_patch_begin (data->first_to_second);
+    kan_reflection_patch_iterator_t end = kan_reflection_patch_end (data->first_to_second);
 
     KAN_TEST_ASSERT (!KAN_HANDLE_IS_EQUAL (iterator, end))
     struct kan_reflection_patch_node_info_t chunk = kan_reflection_patch_iterator_get (iterator);
@@ -853,8 +1187,8 @@ KAN_TEST_CASE (patch)
     iterator = kan_reflection_patch_iterator_next (iterator);
     KAN_TEST_CHECK (KAN_HANDLE_IS_EQUAL (iterator, end))
 
-    iterator = kan_reflection_patch_begin (second_to_third);
-    end = kan_reflection_patch_end (second_to_third);
+    iterator = kan_reflection_patch_begin (data->second_to_third);
+    end = kan_reflection_patch_end (data->second_to_third);
 
     KAN_TEST_ASSERT (!KAN_HANDLE_IS_EQUAL (iterator, end))
     chunk = kan_reflection_patch_iterator_get (iterator);
@@ -864,10 +1198,81 @@ KAN_TEST_CASE (patch)
     iterator = kan_reflection_patch_iterator_next (iterator);
     KAN_TEST_CHECK (KAN_HANDLE_IS_EQUAL (iterator, end))
 
-    // Patches will be automatically destroyed with owning registry.
-    kan_reflection_registry_destroy (registry);
+    // Batched apply should produce the same results as separate applies.
+    struct patch_outer_t batched_instances[PATCH_BATCH_INSTANCES];
+    void *batched_targets[PATCH_BATCH_INSTANCES];
+
+    for (kan_loop_size_t index = 0u; index < PATCH_BATCH_INSTANCES; ++index)
+    {
+        batched_instances[index] = data->first;
+        batched_targets[index] = &batched_instances[index];
+    }
+
+    kan_reflection_patch_apply_batch (data->first_to_second, PATCH_BATCH_INSTANCES, batched_targets);
+    for (kan_loop_size_t index = 0u; index < PATCH_BATCH_INSTANCES; ++index)
+    {
+        KAN_TEST_CHECK (is_patch_outer_equal (&data->second, &batched_instances[index]))
+    }
+
+    kan_reflection_patch_apply_batch (data->second_to_third, PATCH_BATCH_INSTANCES, batched_targets);
+    for (kan_loop_size_t index = 0u; index < PATCH_BATCH_INSTANCES; ++index)
+    {
+        KAN_TEST_CHECK (is_patch_outer_equal (&data->third, &batched_instances[index]))
+    }
 }
 
+KAN_TEST_CASE (patch) { run_patch_test (check_patch); }
+
+static void benchmark_patch_apply_batch (const struct patch_test_data_t *data)
+{
+    // Measure both separate and batched applies to keep track of batched apply performance, as it is advised for the
+    // cases when one patch is applied to lots of instances.
+    struct patch_outer_t *separate_instances =
+        kan_allocate_general (KAN_ALLOCATION_GROUP_IGNORE, sizeof (struct patch_outer_t) * PATCH_BENCHMARK_INSTANCES,
+                              alignof (struct patch_outer_t));
+    struct patch_outer_t *batched_instances =
+        kan_allocate_general (KAN_ALLOCATION_GROUP_IGNORE, sizeof (struct patch_outer_t) * PATCH_BENCHMARK_INSTANCES,
+                              alignof (struct patch_outer_t));
+    void **batched_targets = kan_allocate_general (
+        KAN_ALLOCATION_GROUP_IGNORE, sizeof (void *) * PATCH_BENCHMARK_INSTANCES, alignof (void *));
+
+    for (kan_loop_size_t index = 0u; index < PATCH_BENCHMARK_INSTANCES; ++index)
+    {
+        separate_instances[index] = data->first;
+        batched_instances[index] = data->first;
+        batched_targets[index] = &batched_instances[index];
+    }
+
+    const kan_time_size_t separate_begin = kan_precise_time_get_elapsed_nanoseconds ();
+    for (kan_loop_size_t index = 0u; index < PATCH_BENCHMARK_INSTANCES; ++index)
+    {
+        kan_reflection_patch_apply (data->first_to_second, &separate_instances[index]);
+        kan_reflection_patch_apply (data->second_to_third, &separate_instances[index]);
+    }
+
+    const kan_time_size_t separate_end = kan_precise_time_get_elapsed_nanoseconds ();
+    kan_reflection_patch_apply_batch (data->first_to_second, PATCH_BENCHMARK_INSTANCES, batched_targets);
+    kan_reflection_patch_apply_batch (data->second_to_third, PATCH_BENCHMARK_INSTANCES, batched_targets);
+    const kan_time_size_t batched_end = kan_precise_time_get_elapsed_nanoseconds ();
+
+    KAN_LOG (test_reflection, KAN_LOG_INFO, "Applied patches to %u instances: separately in %.3fms, batched in %.3fms.",
+             (unsigned int) PATCH_BENCHMARK_INSTANCES, (double) (separate_end - separate_begin) / 1e6,
+             (double) (batched_end - separate_end) / 1e6)
+
+    for (kan_loop_size_t index = 0u; index < PATCH_BENCHMARK_INSTANCES; ++index)
+    {
+        KAN_TEST_CHECK (is_patch_outer_equal (&separate_instances[index], &batched_instances[index]))
+    }
+
+    kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, separate_instances,
+                      sizeof (struct patch_outer_t) * PATCH_BENCHMARK_INSTANCES);
+    kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, batched_instances,
+                      sizeof (struct patch_outer_t) * PATCH_BENCHMARK_INSTANCES);
+    kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, batched_targets, sizeof (void *) * PATCH_BENCHMARK_INSTANCES);
+}
+
+KAN_TEST_CASE (patch_apply_batch_benchmark) { run_patch_test (benchmark_patch_apply_batch); }
+
 enum first_enum_source_t
 {
     FIRST_ENUM_SOURCE_HELLO = 0,
@@ -1787,6 +2192,10 @@ KAN_TEST_CASE (migration)
     *(enum first_enum_source_t *) kan_dynamic_array_add_last (&second_migration_source.dynamic_array) =
         FIRST_ENUM_SOURCE_HELLO;
 
+    // Copies for batched migration. They share dynamic array data with original sources, as it is not modified.
+    struct migration_source_t first_batch_source = first_migration_source;
+    struct migration_source_t second_batch_source = second_migration_source;
+
     struct migration_target_t first_migration_target = construct_empty_migration_target ();
     kan_reflection_struct_migrator_migrate_instance (source_to_target_migrator, migration_source.name,
                                                      &first_migration_source, &first_migration_target);
@@ -1803,6 +2212,17 @@ KAN_TEST_CASE (migration)
     KAN_TEST_CHECK (strcmp (second_migration_target.interned_string, "Hello, world!") == 0)
     KAN_TEST_CHECK (strcmp (second_migration_target.owned_string, "Let's think it is owned string.") == 0)
 
+    struct migration_target_t first_batch_target = construct_empty_migration_target ();
+    struct migration_target_t second_batch_target = construct_empty_migration_target ();
+    void *batch_sources[] = {&first_batch_source, &second_batch_source};
+    void *batch_targets[] = {&first_batch_target, &second_batch_target};
+
+    kan_reflection_struct_migrator_migrate_instances (source_to_target_migrator, migration_source.name, 2u,
+                                                      batch_sources, batch_targets);
+
+    check_generic_migration_result (&first_batch_source, &first_batch_target);
+    check_generic_migration_result (&second_batch_source, &second_batch_target);
+
     kan_reflection_patch_builder_t patch_builder = kan_reflection_patch_builder_create ();
 
     kan_reflection_patch_builder_add_chunk (patch_builder, KAN_REFLECTION_PATCH_BUILDER_SECTION_ROOT,
@@ -1852,6 +2272,335 @@ KAN_TEST_CASE (migration)
     kan_dynamic_array_shutdown (&first_migration_target.dynamic_array);
     kan_dynamic_array_shutdown (&second_migration_source.dynamic_array);
     kan_dynamic_array_shutdown (&second_migration_target.dynamic_array);
+    kan_dynamic_array_shutdown (&first_batch_target.dynamic_array);
+    kan_dynamic_array_shutdown (&second_batch_target.dynamic_array);
+
+    kan_reflection_struct_migrator_destroy (source_to_target_migrator);
+    kan_reflection_migration_seed_destroy (source_to_target_migration_seed);
+    kan_reflection_registry_destroy (source_registry);
+    kan_reflection_registry_destroy (target_registry);
+}
+
+struct padding_nested_t
+{
+    uint8_t small;
+    uint32_t big;
+};
+
+struct padding_added_t
+{
+    uint8_t value;
+};
+
+struct padding_source_t
+{
+    uint8_t first;
+    uint64_t second;
+    uint16_t third;
+    uint32_t fourth;
+    struct padding_nested_t nested;
+    uint8_t fifth;
+    uint64_t sixth;
+};
+
+/// \details Shared fields have the same offsets as in source, but added fields occupy source padding.
+struct padding_target_t
+{
+    uint8_t first;
+    uint8_t added_in_padding;
+    uint64_t second;
+    uint16_t third;
+    struct padding_added_t added_nested_in_padding;
+    uint32_t fourth;
+    struct padding_nested_t nested;
+    uint8_t fifth;
+    uint64_t sixth;
+};
+
+#define PADDING_MIGRATION_INSTANCES 7u
+#define PADDING_SOURCE_GARBAGE 0xABu
+
+static void fill_padding_source (struct padding_source_t *source, kan_loop_size_t index)
+{
+    // Fill padding with garbage, so any copy of source padding into target fields is visible.
+    memset (source, PADDING_SOURCE_GARBAGE, sizeof (struct padding_source_t));
+    source->first = (uint8_t) (1u + index);
+    source->second = 0x0102030405060708u + index;
+    source->third = (uint16_t) (300u + index);
+    source->fourth = 70000u + (uint32_t) index;
+    source->nested.small = (uint8_t) (10u + index);
+    source->nested.big = 80000u + (uint32_t) index;
+    source->fifth = (uint8_t) (20u + index);
+    source->sixth = 0x1112131415161718u + index;
+}
+
+static void check_padding_migration_result (const struct padding_source_t *source,
+                                            const struct padding_target_t *target)
+{
+    KAN_TEST_CHECK (source->first == target->first)
+    KAN_TEST_CHECK (source->second == target->second)
+    KAN_TEST_CHECK (source->third == target->third)
+    KAN_TEST_CHECK (source->fourth == target->fourth)
+    KAN_TEST_CHECK (source->nested.small == target->nested.small)
+    KAN_TEST_CHECK (source->nested.big == target->nested.big)
+    KAN_TEST_CHECK (source->fifth == target->fifth)
+    KAN_TEST_CHECK (source->sixth == target->sixth)
+
+    // Fields added into source padding must not be overwritten by padding copy.
+    KAN_TEST_CHECK (target->added_in_padding == 0u)
+    KAN_TEST_CHECK (target->added_nested_in_padding.value == 0u)
+}
+
+KAN_TEST_CASE (migration_coalesce_across_padding)
+{
+    // Test relies on shared fields having the same offsets, otherwise copies cannot be coalesced at all.
+    KAN_TEST_ASSERT (offsetof (struct padding_source_t, second) == offsetof (struct padding_target_t, second))
+    KAN_TEST_ASSERT (offsetof (struct padding_source_t, third) == offsetof (struct padding_target_t, third))
+    KAN_TEST_ASSERT (offsetof (struct padding_source_t, fourth) == offsetof (struct padding_target_t, fourth))
+    KAN_TEST_ASSERT (offsetof (struct padding_source_t, nested) == offsetof (struct padding_target_t, nested))
+    KAN_TEST_ASSERT (offsetof (struct padding_source_t, fifth) == offsetof (struct padding_target_t, fifth))
+    KAN_TEST_ASSERT (offsetof (struct padding_source_t, sixth) == offsetof (struct padding_target_t, sixth))
+
+    struct kan_reflection_field_t padding_nested_fields[] = {
+        {.name = kan_string_intern ("small"),
+         .offset = offsetof (struct padding_nested_t, small),
+         .size = sizeof (((struct padding_nested_t *) NULL)->small),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("big"),
+         .offset = offsetof (struct padding_nested_t, big),
+         .size = sizeof (((struct padding_nested_t *) NULL)->big),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+    };
+
+    struct kan_reflection_struct_t padding_nested = {
+        .name = kan_string_intern ("padding_nested_t"),
+        .size = sizeof (struct padding_nested_t),
+        .alignment = alignof (struct padding_nested_t),
+        .init = NULL,
+        .shutdown = NULL,
+        .functor_user_data = 0u,
+        .fields_count = sizeof (padding_nested_fields) / sizeof (struct kan_reflection_field_t),
+        .fields = padding_nested_fields,
+    };
+
+    struct kan_reflection_field_t padding_added_fields[] = {
+        {.name = kan_string_intern ("value"),
+         .offset = offsetof (struct padding_added_t, value),
+         .size = sizeof (((struct padding_added_t *) NULL)->value),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+    };
+
+    struct kan_reflection_struct_t padding_added = {
+        .name = kan_string_intern ("padding_added_t"),
+        .size = sizeof (struct padding_added_t),
+        .alignment = alignof (struct padding_added_t),
+        .init = NULL,
+        .shutdown = NULL,
+        .functor_user_data = 0u,
+        .fields_count = sizeof (padding_added_fields) / sizeof (struct kan_reflection_field_t),
+        .fields = padding_added_fields,
+    };
+
+    struct kan_reflection_field_t padding_source_fields[] = {
+        {.name = kan_string_intern ("first"),
+         .offset = offsetof (struct padding_source_t, first),
+         .size = sizeof (((struct padding_source_t *) NULL)->first),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("second"),
+         .offset = offsetof (struct padding_source_t, second),
+         .size = sizeof (((struct padding_source_t *) NULL)->second),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("third"),
+         .offset = offsetof (struct padding_source_t, third),
+         .size = sizeof (((struct padding_source_t *) NULL)->third),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("fourth"),
+         .offset = offsetof (struct padding_source_t, fourth),
+         .size = sizeof (((struct padding_source_t *) NULL)->fourth),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("nested"),
+         .offset = offsetof (struct padding_source_t, nested),
+         .size = sizeof (((struct padding_source_t *) NULL)->nested),
+         .archetype = KAN_REFLECTION_ARCHETYPE_STRUCT,
+         .archetype_struct = {.type_name = kan_string_intern ("padding_nested_t")},
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("fifth"),
+         .offset = offsetof (struct padding_source_t, fifth),
+         .size = sizeof (((struct padding_source_t *) NULL)->fifth),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("sixth"),
+         .offset = offsetof (struct padding_source_t, sixth),
+         .size = sizeof (((struct padding_source_t *) NULL)->sixth),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+    };
+
+    struct kan_reflection_field_t padding_target_fields[] = {
+        {.name = kan_string_intern ("first"),
+         .offset = offsetof (struct padding_target_t, first),
+         .size = sizeof (((struct padding_target_t *) NULL)->first),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("added_in_padding"),
+         .offset = offsetof (struct padding_target_t, added_in_padding),
+         .size = sizeof (((struct padding_target_t *) NULL)->added_in_padding),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("second"),
+         .offset = offsetof (struct padding_target_t, second),
+         .size = sizeof (((struct padding_target_t *) NULL)->second),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("third"),
+         .offset = offsetof (struct padding_target_t, third),
+         .size = sizeof (((struct padding_target_t *) NULL)->third),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("added_nested_in_padding"),
+         .offset = offsetof (struct padding_target_t, added_nested_in_padding),
+         .size = sizeof (((struct padding_target_t *) NULL)->added_nested_in_padding),
+         .archetype = KAN_REFLECTION_ARCHETYPE_STRUCT,
+         .archetype_struct = {.type_name = kan_string_intern ("padding_added_t")},
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("fourth"),
+         .offset = offsetof (struct padding_target_t, fourth),
+         .size = sizeof (((struct padding_target_t *) NULL)->fourth),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("nested"),
+         .offset = offsetof (struct padding_target_t, nested),
+         .size = sizeof (((struct padding_target_t *) NULL)->nested),
+         .archetype = KAN_REFLECTION_ARCHETYPE_STRUCT,
+         .archetype_struct = {.type_name = kan_string_intern ("padding_nested_t")},
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("fifth"),
+         .offset = offsetof (struct padding_target_t, fifth),
+         .size = sizeof (((struct padding_target_t *) NULL)->fifth),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+        {.name = kan_string_intern ("sixth"),
+         .offset = offsetof (struct padding_target_t, sixth),
+         .size = sizeof (((struct padding_target_t *) NULL)->sixth),
+         .archetype = KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT,
+         .visibility_condition_field = NULL,
+         .visibility_condition_values_count = 0u,
+         .visibility_condition_values = NULL},
+    };
+
+    struct kan_reflection_struct_t padding_source = {
+        .name = kan_string_intern ("padding_t"),
+        .size = sizeof (struct padding_source_t),
+        .alignment = alignof (struct padding_source_t),
+        .init = NULL,
+        .shutdown = NULL,
+        .functor_user_data = 0u,
+        .fields_count = sizeof (padding_source_fields) / sizeof (struct kan_reflection_field_t),
+        .fields = padding_source_fields,
+    };
+
+    struct kan_reflection_struct_t padding_target = {
+        .name = kan_string_intern ("padding_t"),
+        .size = sizeof (struct padding_target_t),
+        .alignment = alignof (struct padding_target_t),
+        .init = NULL,
+        .shutdown = NULL,
+        .functor_user_data = 0u,
+        .fields_count = sizeof (padding_target_fields) / sizeof (struct kan_reflection_field_t),
+        .fields = padding_target_fields,
+    };
+
+    kan_reflection_registry_t source_registry = kan_reflection_registry_create ();
+    kan_reflection_registry_t target_registry = kan_reflection_registry_create ();
+
+    KAN_TEST_CHECK (kan_reflection_registry_add_struct (source_registry, &padding_nested))
+    KAN_TEST_CHECK (kan_reflection_registry_add_struct (target_registry, &padding_nested))
+    KAN_TEST_CHECK (kan_reflection_registry_add_struct (target_registry, &padding_added))
+    KAN_TEST_CHECK (kan_reflection_registry_add_struct (source_registry, &padding_source))
+    KAN_TEST_CHECK (kan_reflection_registry_add_struct (target_registry, &padding_target))
+
+    kan_reflection_migration_seed_t source_to_target_migration_seed =
+        kan_reflection_migration_seed_build (source_registry, target_registry);
+
+    const struct kan_reflection_struct_migration_seed_t *padding_seed =
+        kan_reflection_migration_seed_get_for_struct (source_to_target_migration_seed, padding_source.name);
+    KAN_TEST_ASSERT (padding_seed)
+    KAN_TEST_CHECK (padding_seed->status == KAN_REFLECTION_MIGRATION_NEEDED)
+
+    kan_reflection_struct_migrator_t source_to_target_migrator =
+        kan_reflection_struct_migrator_build (source_to_target_migration_seed);
+
+    struct padding_source_t sources[PADDING_MIGRATION_INSTANCES];
+    struct padding_target_t batch_targets[PADDING_MIGRATION_INSTANCES];
+    void *batch_sources_pointers[PADDING_MIGRATION_INSTANCES];
+    void *batch_targets_pointers[PADDING_MIGRATION_INSTANCES];
+
+    for (kan_loop_size_t index = 0u; index < PADDING_MIGRATION_INSTANCES; ++index)
+    {
+        fill_padding_source (&sources[index], index);
+        memset (&batch_targets[index], 0, sizeof (struct padding_target_t));
+        batch_sources_pointers[index] = &sources[index];
+        batch_targets_pointers[index] = &batch_targets[index];
+    }
+
+    kan_reflection_struct_migrator_migrate_instances (source_to_target_migrator, padding_source.name,
+                                                      PADDING_MIGRATION_INSTANCES, batch_sources_pointers,
+                                                      batch_targets_pointers);
+
+    for (kan_loop_size_t index = 0u; index < PADDING_MIGRATION_INSTANCES; ++index)
+    {
+        check_padding_migration_result (&sources[index], &batch_targets[index]);
+
+        // Batched migration must produce exactly the same result as migration of one instance.
+        struct padding_target_t single_target;
+        memset (&single_target, 0, sizeof (struct padding_target_t));
+        kan_reflection_struct_migrator_migrate_instance (source_to_target_migrator, padding_source.name,
+                                                         &sources[index], &single_target);
+        KAN_TEST_CHECK (memcmp (&single_target, &batch_targets[index], sizeof (struct padding_target_t)) == 0)
+    }
 
     kan_reflection_struct_migrator_destroy (source_to_target_migrator);
     kan_reflection_migration_seed_destroy (source_to_target_migration_seed);
@@ -2221,6 +2970,27 @@ KAN_TEST_CASE (patch_with_sections)
     KAN_TEST_CHECK (((enum enum_to_adapt_pre_t *) second_middle_pre->enums.data)[3u] == pre_enums[3u])
     pre_root_type->shutdown (pre_root_type->functor_user_data, &root_pre);
 
+    struct root_type_pre_t batched_roots_pre[2u];
+    void *batched_roots_pre_targets[] = {&batched_roots_pre[0u], &batched_roots_pre[1u]};
+    pre_root_type->init (pre_root_type->functor_user_data, &batched_roots_pre[0u]);
+    pre_root_type->init (pre_root_type->functor_user_data, &batched_roots_pre[1u]);
+    kan_reflection_patch_apply_batch (patch, 2u, batched_roots_pre_targets);
+
+    for (kan_loop_size_t index = 0u; index < 2u; ++index)
+    {
+        KAN_TEST_CHECK (batched_roots_pre[index].data_before == 3u)
+        KAN_TEST_CHECK (batched_roots_pre[index].data_after == 4u)
+        KAN_TEST_ASSERT (batched_roots_pre[index].middle_structs.size == 2u)
+
+        first_middle_pre = &((struct middle_type_pre_t *) batched_roots_pre[index].middle_structs.data)[0u];
+        KAN_TEST_CHECK (first_middle_pre->inner_structs.size == 3u)
+        KAN_TEST_CHECK (first_middle_pre->structs_to_delete.size == 1u)
+
+        second_middle_pre = &((struct middle_type_pre_t *) batched_roots_pre[index].middle_structs.data)[1u];
+        KAN_TEST_CHECK (second_middle_pre->enums.size == 4u)
+        pre_root_type->shutdown (pre_root_type->functor_user_data, &batched_roots_pre[index]);
+    }
+
     kan_reflection_migration_seed_t source_to_target_migration_seed =
         kan_reflection_migration_seed_build (source_registry, target_registry);
     kan_reflection_struct_migrator_t source_to_target_migrator =
@@ -34,7 +34,10 @@ static void load_pipeline_source (const char *path, struct kan_dynamic_array_t *
     file_stream->operations->close (file_stream);
 }
 
-static void compile_pipeline (kan_rpl_compiler_context_t compiler_context, struct kan_dynamic_array_t *output)
+static void compile_pipeline_with_optimization (kan_rpl_compiler_context_t compiler_context,
+                                                enum kan_rpl_optimization_flags_t optimization_flags,
+                                                struct kan_rpl_meta_t *meta_output,
+                                                struct kan_dynamic_array_t *output)
 {
     struct kan_rpl_entry_point_t entry_points[] = {
         {
@@ -51,10 +54,21 @@ static void compile_pipeline (kan_rpl_compiler_context_t compiler_context, struc
         compiler_context, sizeof (entry_points) / sizeof (entry_points[0u]), entry_points);
     KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (code_instance))
 
+    kan_rpl_compiler_instance_optimize (code_instance, optimization_flags);
+    if (meta_output)
+    {
+        KAN_TEST_ASSERT (kan_rpl_compiler_instance_emit_meta (code_instance, meta_output, KAN_RPL_META_EMISSION_FULL))
+    }
+
     KAN_TEST_ASSERT (kan_rpl_compiler_instance_emit_spirv (code_instance, output, KAN_ALLOCATION_GROUP_IGNORE))
     kan_rpl_compiler_instance_destroy (code_instance);
 }
 
+static void compile_pipeline (kan_rpl_compiler_context_t compiler_context, struct kan_dynamic_array_t *output)
+{
+    compile_pipeline_with_optimization (compiler_context, KAN_RPL_OPTIMIZATION_NONE, NULL, output);
+}
+
 static void save_code (const char *path, struct kan_dynamic_array_t *output)
 {
     struct kan_stream_t *file_stream = kan_direct_file_stream_open_for_write (path, true);
@@ -336,6 +350,320 @@ KAN_TEST_CASE (while_compile) { compile_test (PIPELINE_BASE_PATH "while.rpl"); }
 
 KAN_TEST_CASE (for_compile) { compile_test (PIPELINE_BASE_PATH "for.rpl"); }
 
+static void validate_code_if_possible (struct kan_dynamic_array_t *code)
+{
+    save_code ("result.spirv", code);
+    if (system ("spirv-val --help") == 0)
+    {
+        KAN_TEST_CHECK (system ("spirv-val --target-env vulkan1.1 result.spirv") == 0)
+    }
+}
+
+static void check_meta_strings_equal (const struct kan_dynamic_array_t *first,
+                                      const struct kan_dynamic_array_t *second)
+{
+    KAN_TEST_ASSERT (first->size == second->size)
+    for (kan_loop_size_t index = 0u; index < first->size; ++index)
+    {
+        KAN_TEST_CHECK (((kan_interned_string_t *) first->data)[index] ==
+                        ((kan_interned_string_t *) second->data)[index])
+    }
+}
+
+static void check_meta_parameters_equal (const struct kan_dynamic_array_t *first,
+                                         const struct kan_dynamic_array_t *second)
+{
+    KAN_TEST_ASSERT (first->size == second->size)
+    for (kan_loop_size_t index = 0u; index < first->size; ++index)
+    {
+        const struct kan_rpl_meta_parameter_t *first_parameter =
+            &((struct kan_rpl_meta_parameter_t *) first->data)[index];
+        const struct kan_rpl_meta_parameter_t *second_parameter =
+            &((struct kan_rpl_meta_parameter_t *) second->data)[index];
+
+        KAN_TEST_CHECK (first_parameter->name == second_parameter->name)
+        KAN_TEST_CHECK (first_parameter->type == second_parameter->type)
+        KAN_TEST_CHECK (first_parameter->offset == second_parameter->offset)
+        KAN_TEST_CHECK (first_parameter->total_item_count == second_parameter->total_item_count)
+        check_meta_strings_equal (&first_parameter->meta, &second_parameter->meta);
+    }
+}
+
+static void check_meta_set_bindings_equal (const struct kan_rpl_meta_set_bindings_t *first,
+                                           const struct kan_rpl_meta_set_bindings_t *second)
+{
+    KAN_TEST_ASSERT (first->buffers.size == second->buffers.size)
+    for (kan_loop_size_t index = 0u; index < first->buffers.size; ++index)
+    {
+        const struct kan_rpl_meta_buffer_t *first_buffer =
+            &((struct kan_rpl_meta_buffer_t *) first->buffers.data)[index];
+        const struct kan_rpl_meta_buffer_t *second_buffer =
+            &((struct kan_rpl_meta_buffer_t *) second->buffers.data)[index];
+
+        KAN_TEST_CHECK (first_buffer->name == second_buffer->name)
+        KAN_TEST_CHECK (first_buffer->binding == second_buffer->binding)
+        KAN_TEST_CHECK (first_buffer->type == second_buffer->type)
+        KAN_TEST_CHECK (first_buffer->main_size == second_buffer->main_size)
+        KAN_TEST_CHECK (first_buffer->tail_item_size == second_buffer->tail_item_size)
+        KAN_TEST_CHECK (first_buffer->tail_name == second_buffer->tail_name)
+        check_meta_parameters_equal (&first_buffer->main_parameters, &second_buffer->main_parameters);
+        check_meta_parameters_equal (&first_buffer->tail_item_parameters, &second_buffer->tail_item_parameters);
+    }
+
+    KAN_TEST_ASSERT (first->samplers.size == second->samplers.size)
+    for (kan_loop_size_t index = 0u; index < first->samplers.size; ++index)
+    {
+        const struct kan_rpl_meta_sampler_t *first_sampler =
+            &((struct kan_rpl_meta_sampler_t *) first->samplers.data)[index];
+        const struct kan_rpl_meta_sampler_t *second_sampler =
+            &((struct kan_rpl_meta_sampler_t *) second->samplers.data)[index];
+
+        KAN_TEST_CHECK (first_sampler->name == second_sampler->name)
+        KAN_TEST_CHECK (first_sampler->binding == second_sampler->binding)
+    }
+
+    KAN_TEST_ASSERT (first->images.size == second->images.size)
+    for (kan_loop_size_t index = 0u; index < first->images.size; ++index)
+    {
+        const struct kan_rpl_meta_image_t *first_image = &((struct kan_rpl_meta_image_t *) first->images.data)[index];
+        const struct kan_rpl_meta_image_t *second_image = &((struct kan_rpl_meta_image_t *) second->images.data)[index];
+
+        KAN_TEST_CHECK (first_image->name == second_image->name)
+        KAN_TEST_CHECK (first_image->binding == second_image->binding)
+        KAN_TEST_CHECK (first_image->type == second_image->type)
+        KAN_TEST_CHECK (first_image->image_array_size == second_image->image_array_size)
+    }
+}
+
+/// \brief Checks that meta is fully equal, optimizations must never change pipeline interface.
+static void check_meta_equal (const struct kan_rpl_meta_t *first, const struct kan_rpl_meta_t *second)
+{
+    KAN_TEST_ASSERT (first->pipeline_type == second->pipeline_type)
+    if (first->pipeline_type == KAN_RPL_PIPELINE_TYPE_GRAPHICS_CLASSIC)
+    {
+        KAN_TEST_CHECK (memcmp (&first->graphics_classic_settings, &second->graphics_classic_settings,
+                                sizeof (first->graphics_classic_settings)) == 0)
+    }
+
+    KAN_TEST_ASSERT (first->attribute_sources.size == second->attribute_sources.size)
+    for (kan_loop_size_t source_index = 0u; source_index < first->attribute_sources.size; ++source_index)
+    {
+        const struct kan_rpl_meta_attribute_source_t *first_source =
+            &((struct kan_rpl_meta_attribute_source_t *) first->attribute_sources.data)[source_index];
+        const struct kan_rpl_meta_attribute_source_t *second_source =
+            &((struct kan_rpl_meta_attribute_source_t *) second->attribute_sources.data)[source_index];
+
+        KAN_TEST_CHECK (first_source->name == second_source->name)
+        KAN_TEST_CHECK (first_source->rate == second_source->rate)
+        KAN_TEST_CHECK (first_source->binding == second_source->binding)
+        KAN_TEST_CHECK (first_source->block_size == second_source->block_size)
+        KAN_TEST_ASSERT (first_source->attributes.size == second_source->attributes.size)
+
+        for (kan_loop_size_t index = 0u; index < first_source->attributes.size; ++index)
+        {
+            const struct kan_rpl_meta_attribute_t *first_attribute =
+                &((struct kan_rpl_meta_attribute_t *) first_source->attributes.data)[index];
+            const struct kan_rpl_meta_attribute_t *second_attribute =
+                &((struct kan_rpl_meta_attribute_t *) second_source->attributes.data)[index];
+
+            KAN_TEST_CHECK (first_attribute->name == second_attribute->name)
+            KAN_TEST_CHECK (first_attribute->location == second_attribute->location)
+            KAN_TEST_CHECK (first_attribute->offset == second_attribute->offset)
+            KAN_TEST_CHECK (first_attribute->class == second_attribute->class)
+            KAN_TEST_CHECK (first_attribute->item_format == second_attribute->item_format)
+            check_meta_strings_equal (&first_attribute->meta, &second_attribute->meta);
+        }
+    }
+
+    KAN_TEST_CHECK (first->push_constant_size == second->push_constant_size)
+    check_meta_set_bindings_equal (&first->set_pass, &second->set_pass);
+    check_meta_set_bindings_equal (&first->set_material, &second->set_material);
+    check_meta_set_bindings_equal (&first->set_object, &second->set_object);
+    check_meta_set_bindings_equal (&first->set_shared, &second->set_shared);
+
+    KAN_TEST_ASSERT (first->color_outputs.size == second->color_outputs.size)
+    KAN_TEST_CHECK (memcmp (first->color_outputs.data, second->color_outputs.data,
+                            first->color_outputs.size * first->color_outputs.item_size) == 0)
+    KAN_TEST_CHECK (memcmp (&first->color_blend_constants, &second->color_blend_constants,
+                            sizeof (first->color_blend_constants)) == 0)
+}
+
+KAN_TEST_CASE (optimization)
+{
+    struct kan_dynamic_array_t source;
+    load_pipeline_source (PIPELINE_BASE_PATH "optimization.rpl", &source);
+
+    kan_rpl_parser_t parser = kan_rpl_parser_create (kan_string_intern ("test"));
+    KAN_TEST_ASSERT (kan_rpl_parser_add_source (parser, (const char *) source.data, kan_string_intern ("code")))
+
+    struct kan_rpl_intermediate_t intermediate;
+    kan_rpl_intermediate_init (&intermediate);
+    KAN_TEST_ASSERT (kan_rpl_parser_build_intermediate (parser, &intermediate))
+
+    kan_rpl_parser_destroy (parser);
+    kan_dynamic_array_shutdown (&source);
+
+    kan_rpl_compiler_context_t low_quality_context =
+        kan_rpl_compiler_context_create (KAN_RPL_PIPELINE_TYPE_GRAPHICS_CLASSIC, kan_string_intern ("low_quality"));
+    kan_rpl_compiler_context_use_module (low_quality_context, &intermediate);
+
+    kan_rpl_compiler_context_t high_quality_context =
+        kan_rpl_compiler_context_create (KAN_RPL_PIPELINE_TYPE_GRAPHICS_CLASSIC, kan_string_intern ("high_quality"));
+    kan_rpl_compiler_context_use_module (high_quality_context, &intermediate);
+    KAN_TEST_CHECK (kan_rpl_compiler_context_set_option_uint (high_quality_context, KAN_RPL_OPTION_TARGET_SCOPE_GLOBAL,
+                                                              kan_string_intern ("quality"), 3u))
+
+    struct kan_rpl_meta_t low_plain_meta;
+    kan_rpl_meta_init (&low_plain_meta);
+    struct kan_dynamic_array_t low_plain_code;
+    compile_pipeline_with_optimization (low_quality_context, KAN_RPL_OPTIMIZATION_NONE, &low_plain_meta,
+                                        &low_plain_code);
+    validate_code_if_possible (&low_plain_code);
+
+    struct kan_rpl_meta_t low_optimized_meta;
+    kan_rpl_meta_init (&low_optimized_meta);
+    struct kan_dynamic_array_t low_optimized_code;
+    compile_pipeline_with_optimization (low_quality_context, KAN_RPL_OPTIMIZATION_ALL, &low_optimized_meta,
+                                        &low_optimized_code);
+    validate_code_if_possible (&low_optimized_code);
+
+    struct kan_rpl_meta_t high_plain_meta;
+    kan_rpl_meta_init (&high_plain_meta);
+    struct kan_dynamic_array_t high_plain_code;
+    compile_pipeline_with_optimization (high_quality_context, KAN_RPL_OPTIMIZATION_NONE, &high_plain_meta,
+                                        &high_plain_code);
+    validate_code_if_possible (&high_plain_code);
+
+    struct kan_rpl_meta_t high_optimized_meta;
+    kan_rpl_meta_init (&high_optimized_meta);
+    struct kan_dynamic_array_t high_optimized_code;
+    compile_pipeline_with_optimization (high_quality_context, KAN_RPL_OPTIMIZATION_ALL, &high_optimized_meta,
+                                        &high_optimized_code);
+    validate_code_if_possible (&high_optimized_code);
+
+    // Optimizations only change code, pipeline interface must stay the same for every variant.
+    check_meta_equal (&low_plain_meta, &low_optimized_meta);
+    check_meta_equal (&high_plain_meta, &high_optimized_meta);
+
+    // Folded arithmetic, removed branches and removed unused function must make code smaller.
+    KAN_TEST_CHECK (low_optimized_code.size < low_plain_code.size)
+
+    // High quality variant takes the branch with function call, so function must be kept there.
+    KAN_TEST_CHECK (low_optimized_code.size < high_optimized_code.size)
+
+    kan_rpl_meta_shutdown (&low_plain_meta);
+    kan_rpl_meta_shutdown (&low_optimized_meta);
+    kan_rpl_meta_shutdown (&high_plain_meta);
+    kan_rpl_meta_shutdown (&high_optimized_meta);
+
+    kan_dynamic_array_shutdown (&low_plain_code);
+    kan_dynamic_array_shutdown (&low_optimized_code);
+    kan_dynamic_array_shutdown (&high_plain_code);
+    kan_dynamic_array_shutdown (&high_optimized_code);
+
+    kan_rpl_compiler_context_destroy (low_quality_context);
+    kan_rpl_compiler_context_destroy (high_quality_context);
+    kan_rpl_intermediate_shutdown (&intermediate);
+}
+
+KAN_TEST_CASE (batch)
+{
+    struct kan_dynamic_array_t library_source;
+    load_pipeline_source (PIPELINE_BASE_PATH "generic_library.rpl", &library_source);
+
+    struct kan_dynamic_array_t pipeline_source;
+    load_pipeline_source (PIPELINE_BASE_PATH "generic_pipeline.rpl", &pipeline_source);
+
+    kan_rpl_parser_t parser = kan_rpl_parser_create (kan_string_intern ("test"));
+    KAN_TEST_CHECK (
+        kan_rpl_parser_add_source (parser, (const char *) pipeline_source.data, kan_string_intern ("pipeline")))
+    KAN_TEST_CHECK (
+        kan_rpl_parser_add_source (parser, (const char *) library_source.data, kan_string_intern ("library")))
+
+    struct kan_rpl_intermediate_t intermediate;
+    kan_rpl_intermediate_init (&intermediate);
+    KAN_TEST_CHECK (kan_rpl_parser_build_intermediate (parser, &intermediate))
+    kan_rpl_parser_destroy (parser);
+
+    kan_dynamic_array_shutdown (&library_source);
+    kan_dynamic_array_shutdown (&pipeline_source);
+
+    struct kan_rpl_entry_point_t entry_points[] = {
+        {
+            .stage = KAN_RPL_PIPELINE_STAGE_GRAPHICS_CLASSIC_VERTEX,
+            .function_name = kan_string_intern ("vertex_main"),
+        },
+        {
+            .stage = KAN_RPL_PIPELINE_STAGE_GRAPHICS_CLASSIC_FRAGMENT,
+            .function_name = kan_string_intern ("fragment_main"),
+        },
+    };
+
+#define BATCH_VARIANTS 2u
+#define BATCH_REPEATS 8u
+#define BATCH_ITEMS (BATCH_VARIANTS * BATCH_REPEATS)
+
+    kan_rpl_compiler_context_t contexts[BATCH_VARIANTS];
+    struct kan_dynamic_array_t expected_code[BATCH_VARIANTS];
+
+    for (kan_loop_size_t variant = 0u; variant < BATCH_VARIANTS; ++variant)
+    {
+        contexts[variant] = kan_rpl_compiler_context_create (KAN_RPL_PIPELINE_TYPE_GRAPHICS_CLASSIC,
+                                                             kan_string_intern ("variant_test"));
+        kan_rpl_compiler_context_use_module (contexts[variant], &intermediate);
+        kan_rpl_compiler_context_set_option_flag (contexts[variant], KAN_RPL_OPTION_TARGET_SCOPE_ANY,
+                                                  kan_string_intern ("wireframe"), variant == 1u);
+        compile_pipeline (contexts[variant], &expected_code[variant]);
+    }
+
+    struct kan_rpl_meta_t meta[BATCH_ITEMS];
+    struct kan_dynamic_array_t code[BATCH_ITEMS];
+    struct kan_rpl_compiler_batch_item_t items[BATCH_ITEMS];
+
+    for (kan_loop_size_t index = 0u; index < BATCH_ITEMS; ++index)
+    {
+        kan_rpl_meta_init (&meta[index]);
+        items[index] = (struct kan_rpl_compiler_batch_item_t) {
+            .context = contexts[index % BATCH_VARIANTS],
+            .entry_point_count = sizeof (entry_points) / sizeof (entry_points[0u]),
+            .entry_points = entry_points,
+            .meta_output = &meta[index],
+            .meta_flags = KAN_RPL_META_EMISSION_FULL,
+            .spirv_output = &code[index],
+            .spirv_allocation_group = KAN_ALLOCATION_GROUP_IGNORE,
+            .successful = false,
+        };
+    }
+
+    KAN_TEST_CHECK (kan_rpl_compiler_batch_execute (BATCH_ITEMS, items))
+    for (kan_loop_size_t index = 0u; index < BATCH_ITEMS; ++index)
+    {
+        KAN_TEST_ASSERT (items[index].successful)
+        const kan_loop_size_t variant = index % BATCH_VARIANTS;
+        KAN_TEST_CHECK (meta[index].graphics_classic_settings.polygon_mode ==
+                        (variant == 1u ? KAN_RPL_POLYGON_MODE_WIREFRAME : KAN_RPL_POLYGON_MODE_FILL))
+
+        KAN_TEST_ASSERT (code[index].size == expected_code[variant].size)
+        KAN_TEST_CHECK (memcmp (code[index].data, expected_code[variant].data,
+                                code[index].size * code[index].item_size) == 0)
+
+        kan_rpl_meta_shutdown (&meta[index]);
+        kan_dynamic_array_shutdown (&code[index]);
+    }
+
+#undef BATCH_VARIANTS
+#undef BATCH_REPEATS
+#undef BATCH_ITEMS
+
+    for (kan_loop_size_t variant = 0u; variant < sizeof (contexts) / sizeof (contexts[0u]); ++variant)
+    {
+        kan_dynamic_array_shutdown (&expected_code[variant]);
+        kan_rpl_compiler_context_destroy (contexts[variant]);
+    }
+
+    kan_rpl_intermediate_shutdown (&intermediate);
+}
+
 static void benchmark_step (struct kan_dynamic_array_t *source, bool finishing_iteration)
 {
     kan_rpl_parser_t parser = kan_rpl_parser_create (kan_string_intern ("test"));
@@ -2637,3 +2637,327 @@ KAN_TEST_CASE (space_operations)
     kan_repository_destroy (root_repository);
     kan_reflection_registry_destroy (registry);
 }
+
+#define MIGRATION_RECORDS_COUNT 1000u
+#define MIGRATION_RECORDS_GROUPS 7u
+
+// Migration record types are registered manually as both versions need to have the same name in different registries.
+KAN_REFLECTION_IGNORE
+struct migration_record_t
+{
+    uint32_t record_id;
+    uint32_t group_id;
+    float weight;
+    uint8_t alive;
+};
+
+KAN_REFLECTION_IGNORE
+struct migration_record_migrated_t
+{
+    uint8_t alive;
+    float weight;
+    uint32_t group_id;
+    uint32_t record_id;
+};
+
+static struct kan_reflection_field_t make_migration_record_field (const char *name,
+                                                                 kan_instance_size_t offset,
+                                                                 kan_instance_size_t size,
+                                                                 enum kan_reflection_archetype_t archetype)
+{
+    return (struct kan_reflection_field_t) {
+        .name = kan_string_intern (name),
+        .offset = offset,
+        .size = size,
+        .archetype = archetype,
+        .visibility_condition_field = NULL,
+        .visibility_condition_values_count = 0u,
+        .visibility_condition_values = NULL,
+    };
+}
+
+static void check_migrated_record (const struct migration_record_migrated_t *record)
+{
+    KAN_TEST_ASSERT (record->record_id < MIGRATION_RECORDS_COUNT)
+    KAN_TEST_CHECK (record->group_id == record->record_id % MIGRATION_RECORDS_GROUPS)
+    KAN_TEST_CHECK (record->weight == (float) record->record_id * 0.5f)
+    KAN_TEST_CHECK (record->alive == (record->record_id % 3u != 0u))
+}
+
+static void check_migrated_records_by_signal (struct kan_repository_indexed_signal_read_query_t *query,
+                                              uint8_t expected_alive)
+{
+    struct kan_repository_indexed_signal_read_cursor_t cursor =
+        kan_repository_indexed_signal_read_query_execute (query);
+    kan_loop_size_t records_found = 0u;
+
+    while (true)
+    {
+        struct kan_repository_indexed_signal_read_access_t access =
+            kan_repository_indexed_signal_read_cursor_next (&cursor);
+
+        const struct migration_record_migrated_t *record =
+            (const struct migration_record_migrated_t *) kan_repository_indexed_signal_read_access_resolve (&access);
+
+        if (!record)
+        {
+            break;
+        }
+
+        ++records_found;
+        KAN_TEST_CHECK (record->alive == expected_alive)
+        check_migrated_record (record);
+        kan_repository_indexed_signal_read_access_close (&access);
+    }
+
+    kan_repository_indexed_signal_read_cursor_close (&cursor);
+    const kan_loop_size_t dead_count = (MIGRATION_RECORDS_COUNT + 2u) / 3u;
+    KAN_TEST_CHECK (records_found == (expected_alive ? MIGRATION_RECORDS_COUNT - dead_count : dead_count))
+}
+
+KAN_TEST_CASE (migration_with_indices)
+{
+    struct kan_reflection_field_t migration_record_fields[] = {
+        make_migration_record_field ("record_id", offsetof (struct migration_record_t, record_id),
+                                     sizeof (uint32_t), KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT),
+        make_migration_record_field ("group_id", offsetof (struct migration_record_t, group_id), sizeof (uint32_t),
+                                     KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT),
+        make_migration_record_field ("weight", offsetof (struct migration_record_t, weight), sizeof (float),
+                                     KAN_REFLECTION_ARCHETYPE_FLOATING),
+        make_migration_record_field ("alive", offsetof (struct migration_record_t, alive), sizeof (uint8_t),
+                                     KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT),
+    };
+
+    struct kan_reflection_struct_t migration_record = {
+        .name = kan_string_intern ("migration_record_t"),
+        .size = sizeof (struct migration_record_t),
+        .alignment = alignof (struct migration_record_t),
+        .init = NULL,
+        .shutdown = NULL,
+        .functor_user_data = 0u,
+        .fields_count = sizeof (migration_record_fields) / sizeof (struct kan_reflection_field_t),
+        .fields = migration_record_fields,
+    };
+
+    // Every field changes its offset, therefore migration is needed and indices need to be rebaked.
+    struct kan_reflection_field_t migration_record_migrated_fields[] = {
+        make_migration_record_field ("alive", offsetof (struct migration_record_migrated_t, alive), sizeof (uint8_t),
+                                     KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT),
+        make_migration_record_field ("weight", offsetof (struct migration_record_migrated_t, weight), sizeof (float),
+                                     KAN_REFLECTION_ARCHETYPE_FLOATING),
+        make_migration_record_field ("group_id", offsetof (struct migration_record_migrated_t, group_id),
+                                     sizeof (uint32_t), KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT),
+        make_migration_record_field ("record_id", offsetof (struct migration_record_migrated_t, record_id),
+                                     sizeof (uint32_t), KAN_REFLECTION_ARCHETYPE_UNSIGNED_INT),
+    };
+
+    struct kan_reflection_struct_t migration_record_migrated = {
+        .name = kan_string_intern ("migration_record_t"),
+        .size = sizeof (struct migration_record_migrated_t),
+        .alignment = alignof (struct migration_record_migrated_t),
+        .init = NULL,
+        .shutdown = NULL,
+        .functor_user_data = 0u,
+        .fields_count = sizeof (migration_record_migrated_fields) / sizeof (struct kan_reflection_field_t),
+        .fields = migration_record_migrated_fields,
+    };
+
+    kan_reflection_registry_t registry = kan_reflection_registry_create ();
+    KAN_REFLECTION_UNIT_REGISTRAR_NAME (repository) (registry);
+    KAN_REFLECTION_UNIT_REGISTRAR_NAME (test_repository) (registry);
+    KAN_TEST_CHECK (kan_reflection_registry_add_struct (registry, &migration_record))
+
+    kan_repository_t root_repository = kan_repository_create_root (KAN_ALLOCATION_GROUP_IGNORE, registry);
+    kan_repository_indexed_storage_t storage =
+        kan_repository_indexed_storage_open (root_repository, "migration_record_t");
+
+    struct kan_repository_indexed_insert_query_t insert;
+    kan_repository_indexed_insert_query_init (&insert, storage);
+
+    struct kan_repository_indexed_value_read_query_t read_by_record_id;
+    kan_repository_indexed_value_read_query_init (
+        &read_by_record_id, storage,
+        (struct kan_repository_field_path_t) {.reflection_path_length = 1u, (const char *[]) {"record_id"}});
+
+    struct kan_repository_indexed_value_read_query_t read_by_group_id;
+    kan_repository_indexed_value_read_query_init (
+        &read_by_group_id, storage,
+        (struct kan_repository_field_path_t) {.reflection_path_length = 1u, (const char *[]) {"group_id"}});
+
+    struct kan_repository_indexed_signal_read_query_t read_alive;
+    kan_repository_indexed_signal_read_query_init (
+        &read_alive, storage,
+        (struct kan_repository_field_path_t) {.reflection_path_length = 1u, (const char *[]) {"alive"}}, 1u);
+
+    struct kan_repository_indexed_signal_read_query_t read_dead;
+    kan_repository_indexed_signal_read_query_init (
+        &read_dead, storage,
+        (struct kan_repository_field_path_t) {.reflection_path_length = 1u, (const char *[]) {"alive"}}, 0u);
+
+    struct kan_repository_indexed_interval_read_query_t read_record_id_interval;
+    kan_repository_indexed_interval_read_query_init (
+        &read_record_id_interval, storage,
+        (struct kan_repository_field_path_t) {.reflection_path_length = 1u, (const char *[]) {"record_id"}});
+
+    struct kan_repository_indexed_interval_read_query_t read_weight_interval;
+    kan_repository_indexed_interval_read_query_init (
+        &read_weight_interval, storage,
+        (struct kan_repository_field_path_t) {.reflection_path_length = 1u, (const char *[]) {"weight"}});
+
+    kan_repository_enter_serving_mode (root_repository);
+    for (kan_loop_size_t index = 0u; index < MIGRATION_RECORDS_COUNT; ++index)
+    {
+        struct kan_repository_indexed_insertion_package_t package =
+            kan_repository_indexed_insert_query_execute (&insert);
+        struct migration_record_t *record =
+            (struct migration_record_t *) kan_repository_indexed_insertion_package_get (&package);
+
+        KAN_TEST_ASSERT (record)
+        record->record_id = (uint32_t) index;
+        record->group_id = (uint32_t) (index % MIGRATION_RECORDS_GROUPS);
+        record->weight = (float) index * 0.5f;
+        record->alive = index % 3u != 0u;
+        kan_repository_indexed_insertion_package_submit (&package);
+    }
+
+    kan_reflection_registry_t new_registry = kan_reflection_registry_create ();
+    KAN_REFLECTION_UNIT_REGISTRAR_NAME (repository) (new_registry);
+    KAN_REFLECTION_UNIT_REGISTRAR_NAME (test_repository) (new_registry);
+    KAN_TEST_CHECK (kan_reflection_registry_add_struct (new_registry, &migration_record_migrated))
+
+    kan_reflection_migration_seed_t migration_seed = kan_reflection_migration_seed_build (registry, new_registry);
+    KAN_TEST_CHECK (kan_reflection_migration_seed_get_for_struct (migration_seed, migration_record.name)->status ==
+                    KAN_REFLECTION_MIGRATION_NEEDED)
+    kan_reflection_struct_migrator_t migrator = kan_reflection_struct_migrator_build (migration_seed);
+
+    kan_repository_prepare_for_migration (root_repository, migration_seed);
+    kan_repository_enter_planning_mode (root_repository);
+    kan_repository_migrate (root_repository, new_registry, migration_seed, migrator);
+    kan_repository_enter_serving_mode (root_repository);
+
+    kan_reflection_struct_migrator_destroy (migrator);
+    kan_reflection_migration_seed_destroy (migration_seed);
+
+    for (uint32_t record_id = 0u; record_id < MIGRATION_RECORDS_COUNT; ++record_id)
+    {
+        struct kan_repository_indexed_value_read_cursor_t cursor =
+            kan_repository_indexed_value_read_query_execute (&read_by_record_id, &record_id);
+
+        struct kan_repository_indexed_value_read_access_t access =
+            kan_repository_indexed_value_read_cursor_next (&cursor);
+
+        const struct migration_record_migrated_t *record =
+            (const struct migration_record_migrated_t *) kan_repository_indexed_value_read_access_resolve (&access);
+
+        KAN_TEST_ASSERT (record)
+        KAN_TEST_CHECK (record->record_id == record_id)
+        check_migrated_record (record);
+        kan_repository_indexed_value_read_access_close (&access);
+
+        access = kan_repository_indexed_value_read_cursor_next (&cursor);
+        KAN_TEST_CHECK (!kan_repository_indexed_value_read_access_resolve (&access))
+        kan_repository_indexed_value_read_cursor_close (&cursor);
+    }
+
+    for (uint32_t group_id = 0u; group_id < MIGRATION_RECORDS_GROUPS; ++group_id)
+    {
+        struct kan_repository_indexed_value_read_cursor_t cursor =
+            kan_repository_indexed_value_read_query_execute (&read_by_group_id, &group_id);
+        kan_loop_size_t records_found = 0u;
+
+        while (true)
+        {
+            struct kan_repository_indexed_value_read_access_t access =
+                kan_repository_indexed_value_read_cursor_next (&cursor);
+
+            const struct migration_record_migrated_t *record =
+                (const struct migration_record_migrated_t *) kan_repository_indexed_value_read_access_resolve (
+                    &access);
+
+            if (!record)
+            {
+                break;
+            }
+
+            ++records_found;
+            KAN_TEST_CHECK (record->group_id == group_id)
+            check_migrated_record (record);
+            kan_repository_indexed_value_read_access_close (&access);
+        }
+
+        kan_repository_indexed_value_read_cursor_close (&cursor);
+        KAN_TEST_CHECK (records_found ==
+                        (MIGRATION_RECORDS_COUNT - group_id + MIGRATION_RECORDS_GROUPS - 1u) / MIGRATION_RECORDS_GROUPS)
+    }
+
+    check_migrated_records_by_signal (&read_alive, 1u);
+    check_migrated_records_by_signal (&read_dead, 0u);
+
+    {
+        struct kan_repository_indexed_interval_ascending_read_cursor_t cursor =
+            kan_repository_indexed_interval_read_query_execute_ascending (&read_record_id_interval, NULL, NULL);
+
+        for (kan_loop_size_t index = 0u; index < MIGRATION_RECORDS_COUNT; ++index)
+        {
+            struct kan_repository_indexed_interval_read_access_t access =
+                kan_repository_indexed_interval_ascending_read_cursor_next (&cursor);
+
+            const struct migration_record_migrated_t *record =
+                (const struct migration_record_migrated_t *) kan_repository_indexed_interval_read_access_resolve (
+                    &access);
+
+            KAN_TEST_ASSERT (record)
+            KAN_TEST_CHECK (record->record_id == index)
+            check_migrated_record (record);
+            kan_repository_indexed_interval_read_access_close (&access);
+        }
+
+        struct kan_repository_indexed_interval_read_access_t access =
+            kan_repository_indexed_interval_ascending_read_cursor_next (&cursor);
+        KAN_TEST_CHECK (!kan_repository_indexed_interval_read_access_resolve (&access))
+        kan_repository_indexed_interval_ascending_read_cursor_close (&cursor);
+    }
+
+    {
+        const float including_start = 100.0f;
+        const float including_end = 200.0f;
+
+        struct kan_repository_indexed_interval_descending_read_cursor_t cursor =
+            kan_repository_indexed_interval_read_query_execute_descending (&read_weight_interval, &including_start,
+                                                                           &including_end);
+
+        // Weight is a half of record id, therefore records from 400 to 200 should be found in descending order.
+        for (kan_loop_size_t index = 400u; index >= 200u; --index)
+        {
+            struct kan_repository_indexed_interval_read_access_t access =
+                kan_repository_indexed_interval_descending_read_cursor_next (&cursor);
+
+            const struct migration_record_migrated_t *record =
+                (const struct migration_record_migrated_t *) kan_repository_indexed_interval_read_access_resolve (
+                    &access);
+
+            KAN_TEST_ASSERT (record)
+            KAN_TEST_CHECK (record->record_id == index)
+            check_migrated_record (record);
+            kan_repository_indexed_interval_read_access_close (&access);
+        }
+
+        struct kan_repository_indexed_interval_read_access_t access =
+            kan_repository_indexed_interval_descending_read_cursor_next (&cursor);
+        KAN_TEST_CHECK (!kan_repository_indexed_interval_read_access_resolve (&access))
+        kan_repository_indexed_interval_descending_read_cursor_close (&cursor);
+    }
+
+    kan_repository_enter_planning_mode (root_repository);
+    kan_repository_indexed_insert_query_shutdown (&insert);
+    kan_repository_indexed_value_read_query_shutdown (&read_by_record_id);
+    kan_repository_indexed_value_read_query_shutdown (&read_by_group_id);
+    kan_repository_indexed_signal_read_query_shutdown (&read_alive);
+    kan_repository_indexed_signal_read_query_shutdown (&read_dead);
+    kan_repository_indexed_interval_read_query_shutdown (&read_record_id_interval);
+    kan_repository_indexed_interval_read_query_shutdown (&read_weight_interval);
+
+    kan_repository_destroy (root_repository);
+    kan_reflection_registry_destroy (new_registry);
+    kan_reflection_registry_destroy (registry);
+}
@@ -2,6 +2,7 @@
 
 #include <test_resource_pipeline_build_api.h>
 
+#include <stdio.h>
 #include <string.h>
 
 #include <kan/context/all_system_names.h>
@@ -17,10 +18,13 @@
 #include <kan/resource_pipeline/index.h>
 #include <kan/resource_pipeline/meta.h>
 #include <kan/resource_pipeline/platform_configuration.h>
+#include <kan/resource_pipeline/scan_snapshot.h>
+#include <kan/resource_pipeline/timing_report.h>
 #include <kan/serialization/binary.h>
 #include <kan/serialization/readable_data.h>
 #include <kan/stream/random_access_stream_buffer.h>
 #include <kan/testing/testing.h>
+#include <kan/threading/atomic.h>
 #include <kan/virtual_file_system/virtual_file_system.h>
 
 KAN_LOG_DEFINE_CATEGORY (test_resource_pipeline_build);
@@ -239,8 +243,29 @@ TEST_RESOURCE_PIPELINE_BUILD_API struct kan_resource_build_rule_t sum_parsed_sou
     .version = CUSHION_START_NS_X64,
 };
 
+/// \brief Counts sum parsed source build rule executions in order to check that build rule execution was skipped.
+static struct kan_atomic_int_t sum_parsed_source_build_executions;
+
+#define SUM_PARSED_SOURCE_BUILD_ORDER_MAX 16u
+
+/// \brief When enabled, names of built sum parsed sources are recorded in order of build rule execution.
+static bool sum_parsed_source_build_order_enabled = false;
+static struct kan_atomic_int_t sum_parsed_source_build_order_lock;
+static kan_instance_size_t sum_parsed_source_build_order_count = 0u;
+static kan_interned_string_t sum_parsed_source_build_order[SUM_PARSED_SOURCE_BUILD_ORDER_MAX];
+
 static enum kan_resource_build_rule_result_t sum_parsed_source_build (struct kan_resource_build_rule_context_t *context)
 {
+    kan_atomic_int_add (&sum_parsed_source_build_executions, 1);
+    if (sum_parsed_source_build_order_enabled)
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK (&sum_parsed_source_build_order_lock)
+        if (sum_parsed_source_build_order_count < SUM_PARSED_SOURCE_BUILD_ORDER_MAX)
+        {
+            sum_parsed_source_build_order[sum_parsed_source_build_order_count++] = context->primary_name;
+        }
+    }
+
     struct sum_parsed_source_t *output = context->primary_output;
     output->source_number = 0u;
 
@@ -311,13 +336,43 @@ TEST_RESOURCE_PIPELINE_BUILD_API struct kan_resource_build_rule_t sum_resource_b
     .version = CUSHION_START_NS_X64,
 };
 
+/// \brief Counts sum resource build rule executions that have loaded their result from rule cache.
+static struct kan_atomic_int_t sum_resource_rule_cache_hits;
+
+#define SUM_RESOURCE_SLOW_BUILD_NS 50000000u
+
+/// \brief Name of sum resource which build rule is artificially slowed down, used for build priority test.
+static kan_interned_string_t sum_resource_slow_build_name = NULL;
+
 static enum kan_resource_build_rule_result_t sum_resource_build (struct kan_resource_build_rule_context_t *context)
 {
     const struct sum_resource_raw_t *input = context->primary_input;
     struct sum_resource_t *output = context->primary_output;
     output->sum = 0u;
 
+    if (context->primary_name == sum_resource_slow_build_name)
+    {
+        kan_precise_time_sleep (SUM_RESOURCE_SLOW_BUILD_NS);
+    }
+
+    // Sum is too simple to actually need rule cache, but we use it here in order to test rule cache.
     const struct kan_resource_build_rule_secondary_node_t *secondary = context->secondary_input_first;
+    kan_file_size_t cache_key = 14695981039346656037u;
+
+    while (secondary)
+    {
+        const struct sum_parsed_source_t *source = secondary->data;
+        cache_key = (cache_key ^ (kan_file_size_t) source->source_number) * 1099511628211u;
+        secondary = secondary->next;
+    }
+
+    if (context->load_cached (context->interface, KAN_STATIC_INTERNED_ID_GET (sum_resource_t), cache_key, output))
+    {
+        kan_atomic_int_add (&sum_resource_rule_cache_hits, 1);
+        return KAN_RESOURCE_BUILD_RULE_SUCCESS;
+    }
+
+    secondary = context->secondary_input_first;
     kan_loop_size_t secondary_received = 0u;
 
     while (secondary)
@@ -336,6 +391,7 @@ static enum kan_resource_build_rule_result_t sum_resource_build (struct kan_reso
                  context->primary_name, (unsigned int) input->sources.size, (unsigned int) secondary_received)
     }
 
+    context->store_cached (context->interface, KAN_STATIC_INTERNED_ID_GET (sum_resource_t), cache_key, output);
     return KAN_RESOURCE_BUILD_RULE_SUCCESS;
 }
 
@@ -1049,6 +1105,238 @@ KAN_TEST_CASE (rebuild)
         load_binary_from (script_storage, read_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_t), &resource);
         KAN_TEST_CHECK (resource.sum == 50u)
     }
+
+    // Sleep some time before doing next build to avoid error with unchanged last modification time because
+    // changes were too close to each to other for filesystem to change modification time.
+    kan_precise_time_sleep (10000000u);
+
+    // Rewrite file with the same content: only timestamp is changed, so nothing should be rebuilt.
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "2.txt");
+    save_text_to (write_path.path, "20");
+
+    result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+
+    {
+        kan_file_system_path_container_reset_length (&read_path, read_path_base_length);
+        kan_resource_build_append_deploy_path_in_workspace (&read_path, TEST_TARGET_NAME, "sum_resource_t", "test_1_2");
+
+        struct kan_file_system_entry_status_t status;
+        KAN_TEST_ASSERT (kan_file_system_query_entry (read_path.path, &status))
+        KAN_TEST_CHECK (last_build_time_test_1_2 == status.last_modification_time_ns)
+    }
+
+    {
+        kan_file_system_path_container_reset_length (&read_path, read_path_base_length);
+        kan_resource_build_append_deploy_path_in_workspace (&read_path, TEST_TARGET_NAME, "sum_resource_t", "test_2_3");
+
+        struct kan_file_system_entry_status_t status;
+        KAN_TEST_ASSERT (kan_file_system_query_entry (read_path.path, &status))
+        KAN_TEST_CHECK (last_build_time_test_2_3 == status.last_modification_time_ns)
+    }
+}
+
+KAN_TEST_CASE (scan_snapshot)
+{
+    SETUP_TRIVIAL_TEST_ENVIRONMENT;
+    struct kan_file_system_path_container_t write_path;
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "nested");
+    KAN_TEST_CHECK (kan_file_system_make_directory (write_path.path))
+    kan_file_system_path_container_append (&write_path, "deeper");
+    KAN_TEST_CHECK (kan_file_system_make_directory (write_path.path))
+    const kan_instance_size_t deeper_length = write_path.length;
+
+    kan_file_system_path_container_append (&write_path, "1.txt");
+    save_text_to (write_path.path, "1");
+
+    kan_file_system_path_container_reset_length (&write_path, deeper_length);
+    kan_file_system_path_container_append (&write_path, "2.txt");
+    save_text_to (write_path.path, "2");
+
+    {
+        kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+        kan_file_system_path_container_append (&write_path, "nested");
+        kan_file_system_path_container_append (&write_path, "test_1_2.rd");
+
+        struct sum_resource_raw_t raw;
+        sum_resource_raw_init (&raw);
+        kan_dynamic_array_set_capacity (&raw.sources, 2u);
+
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&raw.sources) = kan_string_intern ("1.txt");
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&raw.sources) = kan_string_intern ("2.txt");
+
+        save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_raw_t), &raw);
+        sum_resource_raw_shutdown (&raw);
+    }
+
+    {
+        kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+        kan_file_system_path_container_append (&write_path, "root.rd");
+
+        struct root_resource_t root;
+        root_resource_init (&root);
+
+        kan_dynamic_array_set_capacity (&root.needed_sums, 1u);
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&root.needed_sums) =
+            KAN_STATIC_INTERNED_ID_GET (test_1_2);
+
+        save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (root_resource_t), &root);
+        root_resource_shutdown (&root);
+    }
+
+    enum kan_resource_build_result_t result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+
+    struct kan_file_system_path_container_t read_path;
+    kan_file_system_path_container_copy_string (&read_path, WORKSPACE_DIRECTORY);
+    const kan_instance_size_t read_path_base_length = read_path.length;
+
+    kan_file_system_path_container_append (&read_path, KAN_RESOURCE_SCAN_SNAPSHOT_DEFAULT_NAME);
+    KAN_TEST_CHECK (kan_file_system_check_existence (read_path.path))
+
+    {
+        kan_file_system_path_container_reset_length (&read_path, read_path_base_length);
+        kan_resource_build_append_deploy_path_in_workspace (&read_path, TEST_TARGET_NAME, "sum_resource_t", "test_1_2");
+
+        struct sum_resource_t resource;
+        load_binary_from (script_storage, read_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_t), &resource);
+        KAN_TEST_CHECK (resource.sum == 3u)
+    }
+
+    // Sleep some time before doing next build to avoid error with unchanged last modification time because
+    // changes were too close to each to other for filesystem to change modification time.
+    kan_precise_time_sleep (10000000u);
+
+    // Add new directory deep inside the hierarchy: only directories on its path are changed, while resources in
+    // other directories should be taken from scan snapshot.
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "nested");
+    kan_file_system_path_container_append (&write_path, "deeper");
+    kan_file_system_path_container_append (&write_path, "more");
+    KAN_TEST_CHECK (kan_file_system_make_directory (write_path.path))
+    const kan_instance_size_t more_length = write_path.length;
+
+    kan_file_system_path_container_append (&write_path, "3.txt");
+    save_text_to (write_path.path, "3");
+
+    {
+        kan_file_system_path_container_reset_length (&write_path, more_length);
+        kan_file_system_path_container_append (&write_path, "test_2_3.rd");
+
+        struct sum_resource_raw_t raw;
+        sum_resource_raw_init (&raw);
+        kan_dynamic_array_set_capacity (&raw.sources, 2u);
+
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&raw.sources) = kan_string_intern ("2.txt");
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&raw.sources) = kan_string_intern ("3.txt");
+
+        save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_raw_t), &raw);
+        sum_resource_raw_shutdown (&raw);
+    }
+
+    {
+        kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+        kan_file_system_path_container_append (&write_path, "root.rd");
+
+        struct root_resource_t root;
+        root_resource_init (&root);
+
+        kan_dynamic_array_set_capacity (&root.needed_sums, 2u);
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&root.needed_sums) =
+            KAN_STATIC_INTERNED_ID_GET (test_1_2);
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&root.needed_sums) =
+            KAN_STATIC_INTERNED_ID_GET (test_2_3);
+
+        save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (root_resource_t), &root);
+        root_resource_shutdown (&root);
+    }
+
+    result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+
+    {
+        kan_file_system_path_container_reset_length (&read_path, read_path_base_length);
+        kan_resource_build_append_deploy_path_in_workspace (&read_path, TEST_TARGET_NAME, "sum_resource_t", "test_1_2");
+
+        struct sum_resource_t resource;
+        load_binary_from (script_storage, read_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_t), &resource);
+        KAN_TEST_CHECK (resource.sum == 3u)
+    }
+
+    {
+        kan_file_system_path_container_reset_length (&read_path, read_path_base_length);
+        kan_resource_build_append_deploy_path_in_workspace (&read_path, TEST_TARGET_NAME, "sum_resource_t", "test_2_3");
+
+        struct sum_resource_t resource;
+        load_binary_from (script_storage, read_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_t), &resource);
+        KAN_TEST_CHECK (resource.sum == 5u)
+    }
+
+    // Full scan without snapshot must produce the same result.
+    setup.use_scan_snapshot = false;
+    result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+
+    {
+        kan_file_system_path_container_reset_length (&read_path, read_path_base_length);
+        kan_resource_build_append_deploy_path_in_workspace (&read_path, TEST_TARGET_NAME, "sum_resource_t", "test_2_3");
+
+        struct sum_resource_t resource;
+        load_binary_from (script_storage, read_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_t), &resource);
+        KAN_TEST_CHECK (resource.sum == 5u)
+    }
+
+    kan_precise_time_sleep (10000000u);
+    setup.use_scan_snapshot = true;
+
+    // Edit files in place so their directories modification time stays the same: snapshot must not reuse old types.
+    {
+        kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+        kan_file_system_path_container_append (&write_path, "nested");
+        kan_file_system_path_container_append (&write_path, "test_1_2.rd");
+
+        struct secondary_producer_resource_raw_t raw;
+        raw.count_to_produce = 2u;
+        save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (secondary_producer_resource_raw_t), &raw);
+    }
+
+    {
+        kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+        kan_file_system_path_container_append (&write_path, "root.rd");
+
+        struct root_resource_t root;
+        root_resource_init (&root);
+
+        kan_dynamic_array_set_capacity (&root.needed_sums, 1u);
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&root.needed_sums) =
+            KAN_STATIC_INTERNED_ID_GET (test_2_3);
+
+        kan_dynamic_array_set_capacity (&root.needed_secondary_producers, 1u);
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&root.needed_secondary_producers) =
+            KAN_STATIC_INTERNED_ID_GET (test_1_2);
+
+        save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (root_resource_t), &root);
+        root_resource_shutdown (&root);
+    }
+
+    result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+
+    {
+        kan_file_system_path_container_reset_length (&read_path, read_path_base_length);
+        kan_resource_build_append_deploy_path_in_workspace (&read_path, TEST_TARGET_NAME,
+                                                            "secondary_producer_resource_t", "test_1_2");
+
+        struct secondary_producer_resource_t resource;
+        secondary_producer_resource_init (&resource);
+        load_binary_from (script_storage, read_path.path, KAN_STATIC_INTERNED_ID_GET (secondary_producer_resource_t),
+                          &resource);
+
+        KAN_TEST_CHECK (resource.produced.size == 2u)
+        secondary_producer_resource_shutdown (&resource);
+    }
 }
 
 KAN_TEST_CASE (references)
@@ -1637,28 +1925,475 @@ KAN_TEST_CASE (platform_unsupported_dependency)
     }
 }
 
-#define SCALE_TXT_DIR "txt"
-#define SCALE_SUM_DIR "sum"
-#define SCALE_SECONDARY_DIR "secondary"
-#define SCALE_SIZE_SUM 800u
-#define SCALE_REFERENCED_SUM (SCALE_SIZE_SUM * 4u / 5u)
-#define SCALE_SIZE_SECONDARY 100u
-#define SCALE_REFERENCED_SECONDARY (SCALE_SIZE_SECONDARY * 4u / 5u)
+#define ARTIFACT_CACHE_DIRECTORY "artifact_cache"
 
-KAN_TEST_CASE (scale)
+static kan_instance_size_t count_cache_files (const char *directory)
 {
-    SETUP_TRIVIAL_TEST_ENVIRONMENT;
-    struct kan_file_system_path_container_t write_path;
+    kan_instance_size_t count = 0u;
+    kan_file_system_directory_iterator_t iterator = kan_file_system_directory_iterator_create (directory);
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (iterator))
+    const char *name;
 
-    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
-    kan_file_system_path_container_append (&write_path, SCALE_TXT_DIR);
-    KAN_TEST_CHECK (kan_file_system_make_directory (write_path.path))
+    while ((name = kan_file_system_directory_iterator_advance (iterator)))
+    {
+        const kan_instance_size_t length = (kan_instance_size_t) strlen (name);
+        if (length > 4u && strcmp (name + length - 4u, ".bin") == 0)
+        {
+            ++count;
+        }
+    }
 
-    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
-    kan_file_system_path_container_append (&write_path, SCALE_SUM_DIR);
-    KAN_TEST_CHECK (kan_file_system_make_directory (write_path.path))
+    kan_file_system_directory_iterator_destroy (iterator);
+    return count;
+}
 
-    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+static void check_artifact_cache_sum (kan_serialization_binary_script_storage_t script_storage,
+                                      kan_instance_size_t expected_sum)
+{
+    struct kan_file_system_path_container_t read_path;
+    kan_file_system_path_container_copy_string (&read_path, WORKSPACE_DIRECTORY);
+    kan_resource_build_append_deploy_path_in_workspace (&read_path, TEST_TARGET_NAME, "sum_resource_t", "test");
+
+    struct sum_resource_t resource;
+    load_binary_from (script_storage, read_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_t), &resource);
+    KAN_TEST_CHECK (resource.sum == expected_sum)
+}
+
+static void reset_workspace_for_artifact_cache_test (void)
+{
+    // Fresh workspace simulates other checkout or build directory that uses the same artifact cache.
+    kan_file_system_remove_directory_with_content (WORKSPACE_DIRECTORY);
+    KAN_TEST_CHECK (kan_file_system_make_directory (WORKSPACE_DIRECTORY))
+    kan_atomic_int_set (&sum_parsed_source_build_executions, 0);
+}
+
+KAN_TEST_CASE (artifact_cache)
+{
+    SETUP_TRIVIAL_TEST_ENVIRONMENT;
+    kan_file_system_remove_directory_with_content (ARTIFACT_CACHE_DIRECTORY);
+    setup.artifact_cache_directory = ARTIFACT_CACHE_DIRECTORY;
+
+    struct kan_file_system_path_container_t write_path;
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "1.txt");
+    save_text_to (write_path.path, "12");
+
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "2.txt");
+    save_text_to (write_path.path, "30");
+
+    {
+        kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+        kan_file_system_path_container_append (&write_path, "test.rd");
+
+        struct sum_resource_raw_t raw;
+        sum_resource_raw_init (&raw);
+        kan_dynamic_array_set_capacity (&raw.sources, 2u);
+
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&raw.sources) = kan_string_intern ("1.txt");
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&raw.sources) = kan_string_intern ("2.txt");
+
+        save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_raw_t), &raw);
+        sum_resource_raw_shutdown (&raw);
+    }
+
+    {
+        kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+        kan_file_system_path_container_append (&write_path, "root.rd");
+
+        struct root_resource_t root;
+        root_resource_init (&root);
+
+        kan_dynamic_array_set_capacity (&root.needed_sums, 1u);
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&root.needed_sums) = KAN_STATIC_INTERNED_ID_GET (test);
+
+        save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (root_resource_t), &root);
+        root_resource_shutdown (&root);
+    }
+
+    // First build populates artifact cache.
+    reset_workspace_for_artifact_cache_test ();
+    enum kan_resource_build_result_t result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+    KAN_TEST_CHECK (kan_atomic_int_get (&sum_parsed_source_build_executions) == 2)
+    KAN_TEST_CHECK (count_cache_files (ARTIFACT_CACHE_DIRECTORY) == 3u)
+    check_artifact_cache_sum (script_storage, 42u);
+
+    // Build in fresh workspace should take everything from artifact cache.
+    reset_workspace_for_artifact_cache_test ();
+    result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+    KAN_TEST_CHECK (kan_atomic_int_get (&sum_parsed_source_build_executions) == 0)
+    KAN_TEST_CHECK (count_cache_files (ARTIFACT_CACHE_DIRECTORY) == 3u)
+    check_artifact_cache_sum (script_storage, 42u);
+
+    // Changed input must produce new artifact instead of reusing old one.
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "2.txt");
+    save_text_to (write_path.path, "31");
+
+    reset_workspace_for_artifact_cache_test ();
+    result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+    KAN_TEST_CHECK (kan_atomic_int_get (&sum_parsed_source_build_executions) == 1)
+    KAN_TEST_CHECK (count_cache_files (ARTIFACT_CACHE_DIRECTORY) == 5u)
+    check_artifact_cache_sum (script_storage, 43u);
+
+    // Simulate artifact that is being written by other build right now.
+    kan_file_system_path_container_copy_string (&write_path, ARTIFACT_CACHE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "0123456789abcdef.0123456789abcdef_0123456789abcdef.tmp");
+    save_text_to (write_path.path, "in progress");
+
+    // With zero limit, everything must be evicted after the build, except temporary files of other builds.
+    setup.artifact_cache_size_limit = 0u;
+    reset_workspace_for_artifact_cache_test ();
+    result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+    KAN_TEST_CHECK (kan_atomic_int_get (&sum_parsed_source_build_executions) == 0)
+    KAN_TEST_CHECK (count_cache_files (ARTIFACT_CACHE_DIRECTORY) == 0u)
+    KAN_TEST_CHECK (kan_file_system_check_existence (write_path.path))
+    check_artifact_cache_sum (script_storage, 43u);
+
+    reset_workspace_for_artifact_cache_test ();
+    result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+    KAN_TEST_CHECK (kan_atomic_int_get (&sum_parsed_source_build_executions) == 2)
+    check_artifact_cache_sum (script_storage, 43u);
+}
+
+static void save_sum_for_rule_cache_test (kan_reflection_registry_t registry, const char *name)
+{
+    struct kan_file_system_path_container_t write_path;
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, name);
+
+    struct sum_resource_raw_t raw;
+    sum_resource_raw_init (&raw);
+    kan_dynamic_array_set_capacity (&raw.sources, 2u);
+
+    *(kan_interned_string_t *) kan_dynamic_array_add_last (&raw.sources) = kan_string_intern ("1.txt");
+    *(kan_interned_string_t *) kan_dynamic_array_add_last (&raw.sources) = kan_string_intern ("2.txt");
+
+    save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_raw_t), &raw);
+    sum_resource_raw_shutdown (&raw);
+}
+
+static void save_root_for_rule_cache_test (kan_reflection_registry_t registry, kan_instance_size_t sums_count)
+{
+    struct kan_file_system_path_container_t write_path;
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "root.rd");
+
+    struct root_resource_t root;
+    root_resource_init (&root);
+    kan_dynamic_array_set_capacity (&root.needed_sums, 2u);
+
+    *(kan_interned_string_t *) kan_dynamic_array_add_last (&root.needed_sums) = KAN_STATIC_INTERNED_ID_GET (first);
+    if (sums_count > 1u)
+    {
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&root.needed_sums) =
+            KAN_STATIC_INTERNED_ID_GET (second);
+    }
+
+    save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (root_resource_t), &root);
+    root_resource_shutdown (&root);
+}
+
+static void check_rule_cache_sum (kan_serialization_binary_script_storage_t script_storage, const char *name)
+{
+    struct kan_file_system_path_container_t read_path;
+    kan_file_system_path_container_copy_string (&read_path, WORKSPACE_DIRECTORY);
+    kan_resource_build_append_deploy_path_in_workspace (&read_path, TEST_TARGET_NAME, "sum_resource_t", name);
+
+    struct sum_resource_t resource;
+    load_binary_from (script_storage, read_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_t), &resource);
+    KAN_TEST_CHECK (resource.sum == 42u)
+}
+
+KAN_TEST_CASE (rule_cache)
+{
+    SETUP_TRIVIAL_TEST_ENVIRONMENT;
+    kan_atomic_int_set (&sum_resource_rule_cache_hits, 0);
+
+    struct kan_file_system_path_container_t rule_cache_path;
+    kan_file_system_path_container_copy_string (&rule_cache_path, WORKSPACE_DIRECTORY);
+    kan_file_system_path_container_append (&rule_cache_path, KAN_RESOURCE_PROJECT_WORKSPACE_RULE_CACHE_DIRECTORY);
+
+    struct kan_file_system_path_container_t write_path;
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "1.txt");
+    save_text_to (write_path.path, "12");
+
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "2.txt");
+    save_text_to (write_path.path, "30");
+
+    save_sum_for_rule_cache_test (registry, "first.rd");
+    save_root_for_rule_cache_test (registry, 1u);
+
+    // First build has nothing to load, so it stores sum into rule cache.
+    enum kan_resource_build_result_t result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+    KAN_TEST_CHECK (kan_atomic_int_get (&sum_resource_rule_cache_hits) == 0)
+    KAN_TEST_CHECK (count_cache_files (rule_cache_path.path) == 1u)
+    check_rule_cache_sum (script_storage, "first");
+
+    // Second sum has different name, but the same inputs, therefore it must be loaded from rule cache.
+    save_sum_for_rule_cache_test (registry, "second.rd");
+    save_root_for_rule_cache_test (registry, 2u);
+
+    result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+    KAN_TEST_CHECK (kan_atomic_int_get (&sum_resource_rule_cache_hits) == 1)
+    KAN_TEST_CHECK (count_cache_files (rule_cache_path.path) == 1u)
+    check_rule_cache_sum (script_storage, "first");
+    check_rule_cache_sum (script_storage, "second");
+
+    // Simulate rule cache data that is being written by other build rule execution right now.
+    kan_file_system_path_container_copy_string (&write_path, rule_cache_path.path);
+    kan_file_system_path_container_append (&write_path, "sum_resource_t_0123456789abcdef.0123456789abcdef.tmp");
+    save_text_to (write_path.path, "in progress");
+
+    // With zero limit, everything must be evicted after the build, except temporary files.
+    setup.rule_cache_size_limit = 0u;
+    result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+    KAN_TEST_CHECK (count_cache_files (rule_cache_path.path) == 0u)
+    KAN_TEST_CHECK (kan_file_system_check_existence (write_path.path))
+    check_rule_cache_sum (script_storage, "first");
+    check_rule_cache_sum (script_storage, "second");
+}
+
+#define TIMING_REPORT_PATH "timing_report.rd"
+
+static void load_timing_report (kan_reflection_registry_t registry, struct kan_resource_timing_report_t *report)
+{
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_read (TIMING_REPORT_PATH, true);
+    KAN_TEST_ASSERT (stream)
+
+    stream = kan_random_access_stream_buffer_open_for_read (stream, 4096u);
+    CUSHION_DEFER { stream->operations->close (stream); }
+
+    kan_serialization_rd_reader_t reader =
+        kan_serialization_rd_reader_create (stream, report, KAN_STATIC_INTERNED_ID_GET (kan_resource_timing_report_t),
+                                            registry, KAN_ALLOCATION_GROUP_IGNORE);
+
+    CUSHION_DEFER { kan_serialization_rd_reader_destroy (reader); }
+    enum kan_serialization_state_t state;
+
+    while ((state = kan_serialization_rd_reader_step (reader)) == KAN_SERIALIZATION_IN_PROGRESS)
+    {
+    }
+
+    KAN_TEST_ASSERT (state == KAN_SERIALIZATION_FINISHED)
+}
+
+KAN_TEST_CASE (timing_report)
+{
+    SETUP_TRIVIAL_TEST_ENVIRONMENT;
+    kan_file_system_remove_file (TIMING_REPORT_PATH);
+    setup.timing_report_path = TIMING_REPORT_PATH;
+
+    struct kan_file_system_path_container_t write_path;
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "1.txt");
+    save_text_to (write_path.path, "12");
+
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "2.txt");
+    save_text_to (write_path.path, "30");
+
+    {
+        kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+        kan_file_system_path_container_append (&write_path, "test.rd");
+
+        struct sum_resource_raw_t raw;
+        sum_resource_raw_init (&raw);
+        kan_dynamic_array_set_capacity (&raw.sources, 2u);
+
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&raw.sources) = kan_string_intern ("1.txt");
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&raw.sources) = kan_string_intern ("2.txt");
+
+        save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_raw_t), &raw);
+        sum_resource_raw_shutdown (&raw);
+    }
+
+    {
+        kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+        kan_file_system_path_container_append (&write_path, "root.rd");
+
+        struct root_resource_t root;
+        root_resource_init (&root);
+
+        kan_dynamic_array_set_capacity (&root.needed_sums, 1u);
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&root.needed_sums) = KAN_STATIC_INTERNED_ID_GET (test);
+
+        save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (root_resource_t), &root);
+        root_resource_shutdown (&root);
+    }
+
+    enum kan_resource_build_result_t result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+
+    {
+        struct kan_resource_timing_report_t report;
+        kan_resource_timing_report_init (&report);
+        load_timing_report (registry, &report);
+
+        // Two parsed sources and one sum.
+        KAN_TEST_CHECK (report.entries.size == 3u)
+        KAN_TEST_CHECK (report.rules.size == 2u)
+        KAN_TEST_CHECK (report.build_wall_ns >= report.rules_wall_ns)
+
+        kan_time_size_t previous_wall_ns = KAN_INT_MAX (kan_time_size_t);
+        for (kan_loop_size_t index = 0u; index < report.rules.size; ++index)
+        {
+            const struct kan_resource_timing_report_rule_t *rule =
+                &((struct kan_resource_timing_report_rule_t *) report.rules.data)[index];
+
+            // Rules must be sorted by total wall time.
+            KAN_TEST_CHECK (rule->wall_ns_total <= previous_wall_ns)
+            previous_wall_ns = rule->wall_ns_total;
+
+            if (rule->type == KAN_STATIC_INTERNED_ID_GET (sum_parsed_source_t))
+            {
+                KAN_TEST_CHECK (rule->executions == 2u)
+            }
+            else
+            {
+                KAN_TEST_CHECK (rule->type == KAN_STATIC_INTERNED_ID_GET (sum_resource_t))
+                KAN_TEST_CHECK (rule->executions == 1u)
+            }
+        }
+
+        kan_resource_timing_report_shutdown (&report);
+    }
+
+    // Nothing is rebuilt, therefore report must be empty.
+    result = kan_resource_build (&setup);
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+
+    {
+        struct kan_resource_timing_report_t report;
+        kan_resource_timing_report_init (&report);
+        load_timing_report (registry, &report);
+        KAN_TEST_CHECK (report.entries.size == 0u)
+        KAN_TEST_CHECK (report.rules.size == 0u)
+        kan_resource_timing_report_shutdown (&report);
+    }
+}
+
+#define PRIORITY_FAST_SUMS 8u
+
+static void save_sources_for_priority_test (const char *content)
+{
+    struct kan_file_system_path_container_t write_path;
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, "slow.txt");
+    save_text_to (write_path.path, content);
+
+    for (kan_loop_size_t index = 0u; index < PRIORITY_FAST_SUMS; ++index)
+    {
+        char name[32u];
+        snprintf (name, sizeof (name), "fast_%u.txt", (unsigned int) index);
+        kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+        kan_file_system_path_container_append (&write_path, name);
+        save_text_to (write_path.path, content);
+    }
+}
+
+static void save_sum_for_priority_test (kan_reflection_registry_t registry, const char *name, const char *source)
+{
+    struct kan_file_system_path_container_t write_path;
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, name);
+    kan_file_system_path_container_add_suffix (&write_path, ".rd");
+
+    struct sum_resource_raw_t raw;
+    sum_resource_raw_init (&raw);
+    kan_dynamic_array_set_capacity (&raw.sources, 1u);
+    *(kan_interned_string_t *) kan_dynamic_array_add_last (&raw.sources) = kan_string_intern (source);
+
+    save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_raw_t), &raw);
+    sum_resource_raw_shutdown (&raw);
+}
+
+KAN_TEST_CASE (build_priority)
+{
+    SETUP_TRIVIAL_TEST_ENVIRONMENT;
+    save_sources_for_priority_test ("1");
+
+    struct root_resource_t root;
+    root_resource_init (&root);
+    kan_dynamic_array_set_capacity (&root.needed_sums, PRIORITY_FAST_SUMS + 1u);
+
+    // Slow sum is requested last, therefore without priorities its chain would be built last.
+    for (kan_loop_size_t index = 0u; index < PRIORITY_FAST_SUMS; ++index)
+    {
+        char sum_name[32u];
+        snprintf (sum_name, sizeof (sum_name), "fast_sum_%u", (unsigned int) index);
+        char source_name[32u];
+        snprintf (source_name, sizeof (source_name), "fast_%u.txt", (unsigned int) index);
+
+        save_sum_for_priority_test (registry, sum_name, source_name);
+        *(kan_interned_string_t *) kan_dynamic_array_add_last (&root.needed_sums) = kan_string_intern (sum_name);
+    }
+
+    save_sum_for_priority_test (registry, "slow_sum", "slow.txt");
+    *(kan_interned_string_t *) kan_dynamic_array_add_last (&root.needed_sums) = KAN_STATIC_INTERNED_ID_GET (slow_sum);
+
+    {
+        struct kan_file_system_path_container_t write_path;
+        kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+        kan_file_system_path_container_append (&write_path, "root.rd");
+        save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (root_resource_t), &root);
+        root_resource_shutdown (&root);
+    }
+
+    // First build records build rule durations to resource log. Slow sum makes its chain the critical one.
+    sum_resource_slow_build_name = KAN_STATIC_INTERNED_ID_GET (slow_sum);
+    enum kan_resource_build_result_t result = kan_resource_build (&setup);
+    sum_resource_slow_build_name = NULL;
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+
+    kan_precise_time_sleep (10000000u);
+    save_sources_for_priority_test ("2");
+
+    // Budget that is smaller than any estimate makes build tasks execute one by one, so execution order is the same
+    // as dispatch order. Critical chain must be dispatched first even though its root was requested last.
+    setup.memory_budget = 1u;
+    sum_parsed_source_build_order_count = 0u;
+    sum_parsed_source_build_order_enabled = true;
+    result = kan_resource_build (&setup);
+    sum_parsed_source_build_order_enabled = false;
+    KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+
+    KAN_TEST_CHECK (sum_parsed_source_build_order_count == PRIORITY_FAST_SUMS + 1u)
+    KAN_TEST_CHECK (sum_parsed_source_build_order[0u] == kan_string_intern ("slow.txt"))
+}
+
+#define SCALE_TXT_DIR "txt"
+#define SCALE_SUM_DIR "sum"
+#define SCALE_SECONDARY_DIR "secondary"
+#define SCALE_SIZE_SUM 800u
+#define SCALE_REFERENCED_SUM (SCALE_SIZE_SUM * 4u / 5u)
+#define SCALE_SIZE_SECONDARY 100u
+#define SCALE_REFERENCED_SECONDARY (SCALE_SIZE_SECONDARY * 4u / 5u)
+
+KAN_TEST_CASE (scale)
+{
+    SETUP_TRIVIAL_TEST_ENVIRONMENT;
+    struct kan_file_system_path_container_t write_path;
+
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, SCALE_TXT_DIR);
+    KAN_TEST_CHECK (kan_file_system_make_directory (write_path.path))
+
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
+    kan_file_system_path_container_append (&write_path, SCALE_SUM_DIR);
+    KAN_TEST_CHECK (kan_file_system_make_directory (write_path.path))
+
+    kan_file_system_path_container_copy_string (&write_path, TEST_TARGET_RESOURCE_DIRECTORY);
     kan_file_system_path_container_append (&write_path, SCALE_SECONDARY_DIR);
     KAN_TEST_CHECK (kan_file_system_make_directory (write_path.path))
 
@@ -1848,10 +2583,8 @@ static void load_pack_resource_index (kan_virtual_file_system_volume_t volume,
     KAN_TEST_ASSERT (state == KAN_SERIALIZATION_FINISHED)
 }
 
-KAN_TEST_CASE (pack)
+static void generate_pack_test_resources (kan_reflection_registry_t registry)
 {
-    SETUP_TRIVIAL_TEST_ENVIRONMENT;
-    setup.pack_mode = KAN_RESOURCE_BUILD_PACK_MODE_INTERNED;
     struct kan_file_system_path_container_t write_path;
 
     for (kan_loop_size_t index = 0u; index < PACK_SIZE_SUM; ++index)
@@ -1922,6 +2655,13 @@ KAN_TEST_CASE (pack)
         save_rd_to (registry, write_path.path, KAN_STATIC_INTERNED_ID_GET (root_resource_t), &root);
         root_resource_shutdown (&root);
     }
+}
+
+KAN_TEST_CASE (pack)
+{
+    SETUP_TRIVIAL_TEST_ENVIRONMENT;
+    setup.pack_mode = KAN_RESOURCE_BUILD_PACK_MODE_INTERNED;
+    generate_pack_test_resources (registry);
 
     const enum kan_resource_build_result_t result = kan_resource_build (&setup);
     KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
@@ -2099,6 +2839,108 @@ KAN_TEST_CASE (pack)
     }
 }
 
+static void load_pack_bytes (struct kan_dynamic_array_t *output)
+{
+    struct kan_file_system_path_container_t pack_path;
+    kan_file_system_path_container_copy_string (&pack_path, WORKSPACE_DIRECTORY);
+    kan_resource_build_append_pack_path_in_workspace (&pack_path, TEST_TARGET_NAME);
+
+    struct kan_file_system_entry_status_t status;
+    KAN_TEST_ASSERT (kan_file_system_query_entry (pack_path.path, &status))
+
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_read (pack_path.path, true);
+    KAN_TEST_ASSERT (stream)
+    CUSHION_DEFER { stream->operations->close (stream); }
+
+    kan_dynamic_array_set_capacity (output, (kan_instance_size_t) status.size);
+    output->size = (kan_instance_size_t) status.size;
+    KAN_TEST_CHECK (stream->operations->read (stream, status.size, output->data) == status.size)
+}
+
+KAN_TEST_CASE (pack_deterministic)
+{
+    SETUP_TRIVIAL_TEST_ENVIRONMENT;
+    setup.pack_mode = KAN_RESOURCE_BUILD_PACK_MODE_INTERNED;
+    generate_pack_test_resources (registry);
+    KAN_TEST_ASSERT (kan_resource_build (&setup) == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+
+    struct kan_dynamic_array_t first_pack;
+    kan_dynamic_array_init (&first_pack, 0u, sizeof (uint8_t), alignof (uint8_t), KAN_ALLOCATION_GROUP_IGNORE);
+    CUSHION_DEFER { kan_dynamic_array_shutdown (&first_pack); }
+    load_pack_bytes (&first_pack);
+
+    // Rebuild everything from scratch, so entries are staged in parallel again with different scheduling.
+    kan_file_system_remove_directory_with_content (WORKSPACE_DIRECTORY);
+    KAN_TEST_CHECK (kan_file_system_make_directory (WORKSPACE_DIRECTORY))
+    KAN_TEST_ASSERT (kan_resource_build (&setup) == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+
+    struct kan_dynamic_array_t second_pack;
+    kan_dynamic_array_init (&second_pack, 0u, sizeof (uint8_t), alignof (uint8_t), KAN_ALLOCATION_GROUP_IGNORE);
+    CUSHION_DEFER { kan_dynamic_array_shutdown (&second_pack); }
+    load_pack_bytes (&second_pack);
+
+    KAN_TEST_ASSERT (first_pack.size == second_pack.size)
+    KAN_TEST_CHECK (memcmp (first_pack.data, second_pack.data, first_pack.size) == 0)
+}
+
+static void check_pack_test_resources_deployed (kan_serialization_binary_script_storage_t script_storage)
+{
+    struct kan_file_system_path_container_t read_path;
+    kan_file_system_path_container_copy_string (&read_path, WORKSPACE_DIRECTORY);
+    const kan_instance_size_t read_path_base_length = read_path.length;
+
+    for (kan_loop_size_t index = 0u; index < PACK_SIZE_SUM; ++index)
+    {
+        char buffer[128u];
+        snprintf (buffer, sizeof (buffer), "sum_%u", (unsigned int) index);
+
+        kan_file_system_path_container_reset_length (&read_path, read_path_base_length);
+        kan_resource_build_append_deploy_path_in_workspace (&read_path, TEST_TARGET_NAME, "sum_resource_t", buffer);
+
+        struct sum_resource_t resource;
+        load_binary_from (script_storage, read_path.path, KAN_STATIC_INTERNED_ID_GET (sum_resource_t), &resource);
+        KAN_TEST_CHECK (resource.sum == 59u)
+    }
+
+    for (kan_loop_size_t index = 0u; index < PACK_SIZE_SECONDARY; ++index)
+    {
+        char buffer[128u];
+        snprintf (buffer, sizeof (buffer), "secondary_%u", (unsigned int) index);
+
+        kan_file_system_path_container_reset_length (&read_path, read_path_base_length);
+        kan_resource_build_append_deploy_path_in_workspace (&read_path, TEST_TARGET_NAME,
+                                                            "secondary_producer_resource_t", buffer);
+
+        struct secondary_producer_resource_t resource;
+        secondary_producer_resource_init (&resource);
+
+        load_binary_from (script_storage, read_path.path, KAN_STATIC_INTERNED_ID_GET (secondary_producer_resource_t),
+                          &resource);
+
+        KAN_TEST_CHECK (resource.produced.size == 3u)
+        secondary_producer_resource_shutdown (&resource);
+    }
+}
+
+KAN_TEST_CASE (memory_budget)
+{
+    SETUP_TRIVIAL_TEST_ENVIRONMENT;
+    generate_pack_test_resources (registry);
+
+    // Budget that is smaller than any estimate: every task must be admitted only when nothing else is scheduled.
+    setup.memory_budget = 1u;
+    KAN_TEST_ASSERT (kan_resource_build (&setup) == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+    check_pack_test_resources_deployed (script_storage);
+
+    // Budget that fits only several tasks at once: tasks are skipped and aged while others are running.
+    kan_file_system_remove_directory_with_content (WORKSPACE_DIRECTORY);
+    KAN_TEST_CHECK (kan_file_system_make_directory (WORKSPACE_DIRECTORY))
+
+    setup.memory_budget = 3u * 65536u;
+    KAN_TEST_ASSERT (kan_resource_build (&setup) == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
+    check_pack_test_resources_deployed (script_storage);
+}
+
 static void check_third_party_content_internal (struct kan_stream_t *stream, const char *expected_content)
 {
     char max_expected_buffer[1024u];
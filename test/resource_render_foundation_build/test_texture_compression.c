@@ -0,0 +1,299 @@
+#include <math.h>
+#include <string.h>
+
+#include <kan/api_common/min_max.h>
+#include <kan/resource_render_foundation_build/texture.h>
+#include <kan/testing/testing.h>
+
+// Image size is intentionally not a multiple of block size in order to cover edge blocks.
+#define TEST_IMAGE_WIDTH 14u
+#define TEST_IMAGE_HEIGHT 10u
+#define TEST_IMAGE_EDGE_X 7u
+
+#define TEST_BLOCKS_X ((TEST_IMAGE_WIDTH + 3u) / 4u)
+#define TEST_BLOCKS_Y ((TEST_IMAGE_HEIGHT + 3u) / 4u)
+#define TEST_MAX_BLOCK_SIZE 16u
+
+/// \brief Fills image with smooth gradients in every channel and hard vertical edge in the middle.
+/// \details Values are multiples of 1/255, therefore expected 8 bit values can be calculated without rounding.
+static void fill_test_image (float *rgba, uint8_t *expected)
+{
+    for (kan_loop_size_t y = 0u; y < TEST_IMAGE_HEIGHT; ++y)
+    {
+        for (kan_loop_size_t x = 0u; x < TEST_IMAGE_WIDTH; ++x)
+        {
+            uint8_t *pixel = expected + (y * TEST_IMAGE_WIDTH + x) * 4u;
+            pixel[0u] = (uint8_t) (16u + x * 16u);
+            pixel[1u] = (uint8_t) (32u + y * 20u);
+            pixel[2u] = (uint8_t) (200u - x * 6u - y * 6u);
+            pixel[3u] = (uint8_t) (255u - y * 12u);
+
+            if (x >= TEST_IMAGE_EDGE_X)
+            {
+                pixel[0u] = (uint8_t) (255u - pixel[0u]);
+                pixel[1u] = (uint8_t) (255u - pixel[1u]);
+                pixel[3u] = (uint8_t) (pixel[3u] / 4u);
+            }
+
+            for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+            {
+                rgba[(y * TEST_IMAGE_WIDTH + x) * 4u + channel] = (float) pixel[channel] / 255.0f;
+            }
+        }
+    }
+}
+
+static inline uint32_t read_bits (const uint8_t *block, kan_instance_size_t *position, kan_instance_size_t bits)
+{
+    uint32_t value = 0u;
+    for (kan_loop_size_t bit = 0u; bit < bits; ++bit, ++*position)
+    {
+        value |= (uint32_t) ((block[*position / 8u] >> (*position % 8u)) & 1u) << bit;
+    }
+
+    return value;
+}
+
+static void unpack_565 (uint16_t packed, int32_t *output)
+{
+    const int32_t red = (packed >> 11u) & 31u;
+    const int32_t green = (packed >> 5u) & 63u;
+    const int32_t blue = packed & 31u;
+
+    output[0u] = (red << 3u) | (red >> 2u);
+    output[1u] = (green << 2u) | (green >> 4u);
+    output[2u] = (blue << 3u) | (blue >> 2u);
+}
+
+/// \brief Reference BC1 decoder that supports both 4 color and 3 color modes.
+static void decode_bc1 (const uint8_t *block, uint8_t texels[16u][4u])
+{
+    const uint16_t color_0 = (uint16_t) (block[0u] | (block[1u] << 8u));
+    const uint16_t color_1 = (uint16_t) (block[2u] | (block[3u] << 8u));
+
+    int32_t palette[4u][4u];
+    unpack_565 (color_0, palette[0u]);
+    unpack_565 (color_1, palette[1u]);
+    palette[0u][3u] = 255;
+    palette[1u][3u] = 255;
+
+    for (kan_loop_size_t channel = 0u; channel < 3u; ++channel)
+    {
+        if (color_0 > color_1)
+        {
+            palette[2u][channel] = (2 * palette[0u][channel] + palette[1u][channel] + 1) / 3;
+            palette[3u][channel] = (palette[0u][channel] + 2 * palette[1u][channel] + 1) / 3;
+        }
+        else
+        {
+            palette[2u][channel] = (palette[0u][channel] + palette[1u][channel]) / 2;
+            palette[3u][channel] = 0;
+        }
+    }
+
+    palette[2u][3u] = 255;
+    palette[3u][3u] = color_0 > color_1 ? 255 : 0;
+
+    for (kan_loop_size_t texel = 0u; texel < 16u; ++texel)
+    {
+        const uint32_t index = (block[4u + texel / 4u] >> ((texel % 4u) * 2u)) & 3u;
+        for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+        {
+            texels[texel][channel] = (uint8_t) palette[index][channel];
+        }
+    }
+}
+
+/// \brief Reference BC4 decoder that writes decoded values into given channel of texels.
+static void decode_bc4 (const uint8_t *block, uint8_t texels[16u][4u], kan_instance_size_t channel)
+{
+    int32_t palette[8u];
+    palette[0u] = block[0u];
+    palette[1u] = block[1u];
+
+    if (palette[0u] > palette[1u])
+    {
+        for (int32_t index = 1; index < 7; ++index)
+        {
+            palette[index + 1] = ((7 - index) * palette[0u] + index * palette[1u] + 3) / 7;
+        }
+    }
+    else
+    {
+        for (int32_t index = 1; index < 5; ++index)
+        {
+            palette[index + 1] = ((5 - index) * palette[0u] + index * palette[1u] + 2) / 5;
+        }
+
+        palette[6u] = 0;
+        palette[7u] = 255;
+    }
+
+    kan_instance_size_t position = 16u;
+    for (kan_loop_size_t texel = 0u; texel < 16u; ++texel)
+    {
+        texels[texel][channel] = (uint8_t) palette[read_bits (block, &position, 3u)];
+    }
+}
+
+/// \brief Reference BC7 decoder for mode 6, which is the only mode emitted by texture build.
+static void decode_bc7 (const uint8_t *block, uint8_t texels[16u][4u])
+{
+    static const int32_t index_weights[16u] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    kan_instance_size_t position = 0u;
+    KAN_TEST_ASSERT (read_bits (block, &position, 7u) == 1u << 6u)
+
+    int32_t endpoints[2u][4u];
+    for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+    {
+        endpoints[0u][channel] = (int32_t) read_bits (block, &position, 7u) << 1;
+        endpoints[1u][channel] = (int32_t) read_bits (block, &position, 7u) << 1;
+    }
+
+    const int32_t p_bit_0 = (int32_t) read_bits (block, &position, 1u);
+    const int32_t p_bit_1 = (int32_t) read_bits (block, &position, 1u);
+
+    for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+    {
+        endpoints[0u][channel] |= p_bit_0;
+        endpoints[1u][channel] |= p_bit_1;
+    }
+
+    for (kan_loop_size_t texel = 0u; texel < 16u; ++texel)
+    {
+        const uint32_t index = read_bits (block, &position, texel == 0u ? 3u : 4u);
+        for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+        {
+            texels[texel][channel] = (uint8_t) (((64 - index_weights[index]) * endpoints[0u][channel] +
+                                                 index_weights[index] * endpoints[1u][channel] + 32) >>
+                                                6);
+        }
+    }
+
+    KAN_TEST_CHECK (position == 128u)
+}
+
+/// \brief Compresses test image with every quality preset, decodes it and checks error in given channels.
+/// \details Root mean square error checks overall quality, while maximum error checks that edge texels and texels
+///          near hard edge are not broken, which is the typical symptom of wrong block layout or endpoint order.
+///          Fast quality uses bounding box endpoints, which are far from optimal when channels are not correlated,
+///          therefore it has separate limits.
+static void check_round_trip (enum kan_resource_texture_format_t format,
+                              kan_instance_size_t channels,
+                              float fast_root_mean_square_limit,
+                              int32_t fast_max_error_limit,
+                              float root_mean_square_limit,
+                              int32_t max_error_limit)
+{
+    float source[TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT * 4u];
+    uint8_t expected[TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT * 4u];
+    fill_test_image (source, expected);
+
+    const kan_instance_size_t block_size = kan_resource_texture_format_block_size (format);
+    KAN_TEST_ASSERT (block_size > 0u && block_size <= TEST_MAX_BLOCK_SIZE)
+
+    for (kan_loop_size_t quality = KAN_RESOURCE_TEXTURE_COMPRESSION_QUALITY_FAST;
+         quality <= KAN_RESOURCE_TEXTURE_COMPRESSION_QUALITY_HIGH; ++quality)
+    {
+        uint8_t compressed[TEST_BLOCKS_X * TEST_BLOCKS_Y * TEST_MAX_BLOCK_SIZE];
+        kan_resource_texture_compress_blocks (format, (enum kan_resource_texture_compression_quality_t) quality,
+                                              source, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, compressed);
+
+        uint64_t square_error_sum = 0u;
+        int32_t max_error = 0;
+
+        for (kan_loop_size_t block_y = 0u; block_y < TEST_BLOCKS_Y; ++block_y)
+        {
+            for (kan_loop_size_t block_x = 0u; block_x < TEST_BLOCKS_X; ++block_x)
+            {
+                const uint8_t *block = compressed + (block_y * TEST_BLOCKS_X + block_x) * block_size;
+                uint8_t texels[16u][4u];
+                memset (texels, 0, sizeof (texels));
+
+                switch (format)
+                {
+                case KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_UNORM:
+                    decode_bc1 (block, texels);
+                    break;
+
+                case KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_UNORM:
+                    decode_bc1 (block + 8u, texels);
+                    decode_bc4 (block, texels, 3u);
+                    break;
+
+                case KAN_RESOURCE_TEXTURE_FORMAT_BC4_R_UNORM:
+                    decode_bc4 (block, texels, 0u);
+                    break;
+
+                case KAN_RESOURCE_TEXTURE_FORMAT_BC5_RG_UNORM:
+                    decode_bc4 (block, texels, 0u);
+                    decode_bc4 (block + 8u, texels, 1u);
+                    break;
+
+                case KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_UNORM:
+                    decode_bc7 (block, texels);
+                    break;
+
+                default:
+                    KAN_TEST_ASSERT (false)
+                    break;
+                }
+
+                for (kan_loop_size_t texel = 0u; texel < 16u; ++texel)
+                {
+                    const kan_instance_size_t x = block_x * 4u + texel % 4u;
+                    const kan_instance_size_t y = block_y * 4u + texel / 4u;
+
+                    // Texels outside of the image only exist in compressed data.
+                    if (x >= TEST_IMAGE_WIDTH || y >= TEST_IMAGE_HEIGHT)
+                    {
+                        continue;
+                    }
+
+                    const uint8_t *expected_pixel = expected + (y * TEST_IMAGE_WIDTH + x) * 4u;
+                    for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+                    {
+                        const int32_t error = (int32_t) texels[texel][channel] - (int32_t) expected_pixel[channel];
+                        square_error_sum += (uint64_t) (error * error);
+                        max_error = KAN_MAX (max_error, error < 0 ? -error : error);
+                    }
+                }
+            }
+        }
+
+        const float root_mean_square =
+            sqrtf ((float) square_error_sum / (float) (TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT * channels));
+        if (quality == KAN_RESOURCE_TEXTURE_COMPRESSION_QUALITY_FAST)
+        {
+            KAN_TEST_CHECK (root_mean_square <= fast_root_mean_square_limit)
+            KAN_TEST_CHECK (max_error <= fast_max_error_limit)
+        }
+        else
+        {
+            KAN_TEST_CHECK (root_mean_square <= root_mean_square_limit)
+            KAN_TEST_CHECK (max_error <= max_error_limit)
+        }
+    }
+}
+
+KAN_TEST_CASE (bc1_round_trip)
+{
+    check_round_trip (KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_UNORM, 3u, 16.0f, 56, 12.0f, 40);
+}
+
+KAN_TEST_CASE (bc3_round_trip)
+{
+    check_round_trip (KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_UNORM, 4u, 14.0f, 56, 11.0f, 40);
+}
+
+KAN_TEST_CASE (bc4_round_trip) { check_round_trip (KAN_RESOURCE_TEXTURE_FORMAT_BC4_R_UNORM, 1u, 2.0f, 6, 2.0f, 6); }
+
+KAN_TEST_CASE (bc5_round_trip)
+{
+    check_round_trip (KAN_RESOURCE_TEXTURE_FORMAT_BC5_RG_UNORM, 2u, 3.5f, 16, 3.5f, 16);
+}
+
+KAN_TEST_CASE (bc7_round_trip)
+{
+    check_round_trip (KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_UNORM, 4u, 26.0f, 120, 11.0f, 40);
+}
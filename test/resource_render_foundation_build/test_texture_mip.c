@@ -0,0 +1,157 @@
+#include <float.h>
+
+#include <kan/api_common/min_max.h>
+#include <kan/resource_render_foundation_build/texture.h>
+#include <kan/testing/testing.h>
+
+// Source sizes are intentionally odd and non-square, so skipped last rows and columns and scalar tails of wide loops
+// are covered for every instruction set. Mips are small enough to be generated in one band.
+#define TEST_MIP_MAX_SOURCE_SIZE 40u
+#define TEST_MIP_GUARD_VALUES 8u
+#define TEST_MIP_GUARD_VALUE 12345.0f
+
+struct test_mip_size_t
+{
+    kan_instance_size_t width;
+    kan_instance_size_t height;
+};
+
+static const struct test_mip_size_t test_mip_sizes[] = {
+    {2u, 2u}, {3u, 9u}, {17u, 6u}, {34u, 5u}, {35u, 3u}, {9u, 40u}, {40u, 13u},
+};
+
+/// \brief Fills image with pseudo random values from [min_value, max_value] range.
+static void fill_test_mip_source (float *source, kan_instance_size_t count, float min_value, float max_value)
+{
+    uint32_t state = 17u;
+    for (kan_loop_size_t index = 0u; index < count; ++index)
+    {
+        state = state * 1664525u + 1013904223u;
+        source[index] = min_value + (max_value - min_value) * (float) (state >> 8u) / (float) (1u << 24u);
+    }
+}
+
+/// \brief Calculates expected value in the same order as kernels, so results must be exactly equal.
+static float calculate_expected_mip_value (enum kan_resource_texture_mip_generation_t mode,
+                                           float top_left,
+                                           float top_right,
+                                           float bottom_left,
+                                           float bottom_right)
+{
+    switch (mode)
+    {
+    case KAN_RESOURCE_TEXTURE_MIP_GENERATION_AVERAGE:
+        return ((top_left + top_right) + (bottom_left + bottom_right)) * 0.25f;
+
+    case KAN_RESOURCE_TEXTURE_MIP_GENERATION_MIN:
+        return KAN_MIN (KAN_MIN (top_left, top_right), KAN_MIN (bottom_left, bottom_right));
+
+    case KAN_RESOURCE_TEXTURE_MIP_GENERATION_MAX:
+        return KAN_MAX (KAN_MAX (top_left, top_right), KAN_MAX (bottom_left, bottom_right));
+    }
+
+    KAN_TEST_ASSERT (false)
+    return 0.0f;
+}
+
+static void check_mip_generation (float min_value, float max_value)
+{
+    float source[TEST_MIP_MAX_SOURCE_SIZE * TEST_MIP_MAX_SOURCE_SIZE * 4u];
+    fill_test_mip_source (source, sizeof (source) / sizeof (source[0u]), min_value, max_value);
+
+    float scalar_target[TEST_MIP_MAX_SOURCE_SIZE * TEST_MIP_MAX_SOURCE_SIZE + TEST_MIP_GUARD_VALUES];
+    float target[TEST_MIP_MAX_SOURCE_SIZE * TEST_MIP_MAX_SOURCE_SIZE + TEST_MIP_GUARD_VALUES];
+    KAN_TEST_ASSERT (kan_resource_texture_mip_instruction_set_is_supported (
+        kan_resource_texture_mip_instruction_set_select_best ()))
+
+    for (kan_loop_size_t size_index = 0u; size_index < sizeof (test_mip_sizes) / sizeof (test_mip_sizes[0u]);
+         ++size_index)
+    {
+        const kan_instance_size_t source_width = test_mip_sizes[size_index].width;
+        const kan_instance_size_t source_height = test_mip_sizes[size_index].height;
+        const kan_instance_size_t target_width = source_width / 2u;
+        const kan_instance_size_t target_height = source_height / 2u;
+
+        for (kan_loop_size_t channels = 1u; channels <= 4u; channels += 3u)
+        {
+            const kan_instance_size_t target_count = target_width * target_height * channels;
+            for (kan_loop_size_t mode = KAN_RESOURCE_TEXTURE_MIP_GENERATION_AVERAGE;
+                 mode <= KAN_RESOURCE_TEXTURE_MIP_GENERATION_MAX; ++mode)
+            {
+                for (kan_loop_size_t index = 0u; index < target_count + TEST_MIP_GUARD_VALUES; ++index)
+                {
+                    scalar_target[index] = TEST_MIP_GUARD_VALUE;
+                }
+
+                kan_resource_texture_generate_mip ((enum kan_resource_texture_mip_generation_t) mode,
+                                                   KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_SCALAR, channels, source,
+                                                   source_width, scalar_target, target_width, target_height);
+
+                for (kan_loop_size_t y = 0u; y < target_height; ++y)
+                {
+                    const float *source_row_0 = source + (y * 2u) * source_width * channels;
+                    const float *source_row_1 = source_row_0 + source_width * channels;
+
+                    for (kan_loop_size_t x = 0u; x < target_width; ++x)
+                    {
+                        for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+                        {
+                            const kan_instance_size_t left = x * 2u * channels + channel;
+                            const kan_instance_size_t right = left + channels;
+                            const float expected = calculate_expected_mip_value (
+                                (enum kan_resource_texture_mip_generation_t) mode, source_row_0[left],
+                                source_row_0[right], source_row_1[left], source_row_1[right]);
+
+                            KAN_TEST_CHECK (scalar_target[(y * target_width + x) * channels + channel] == expected)
+                        }
+                    }
+                }
+
+                for (kan_loop_size_t index = target_count; index < target_count + TEST_MIP_GUARD_VALUES; ++index)
+                {
+                    KAN_TEST_CHECK (scalar_target[index] == TEST_MIP_GUARD_VALUE)
+                }
+
+                for (kan_loop_size_t instruction_set = KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_SSE2;
+                     instruction_set <= KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_AVX2; ++instruction_set)
+                {
+                    if (!kan_resource_texture_mip_instruction_set_is_supported (
+                            (enum kan_resource_texture_mip_instruction_set_t) instruction_set))
+                    {
+                        continue;
+                    }
+
+                    for (kan_loop_size_t index = 0u; index < target_count + TEST_MIP_GUARD_VALUES; ++index)
+                    {
+                        target[index] = TEST_MIP_GUARD_VALUE;
+                    }
+
+                    kan_resource_texture_generate_mip (
+                        (enum kan_resource_texture_mip_generation_t) mode,
+                        (enum kan_resource_texture_mip_instruction_set_t) instruction_set, channels, source,
+                        source_width, target, target_width, target_height);
+
+                    // Scalar results are already checked, guard values included, so exact comparison is enough.
+                    for (kan_loop_size_t index = 0u; index < target_count + TEST_MIP_GUARD_VALUES; ++index)
+                    {
+                        KAN_TEST_CHECK (target[index] == scalar_target[index])
+                    }
+                }
+            }
+        }
+    }
+}
+
+KAN_TEST_CASE (mip_kernels_mixed_values) { check_mip_generation (-4.0f, 4.0f); }
+
+KAN_TEST_CASE (mip_kernels_negative_values)
+{
+    // Max mode used to start from FLT_MIN, which is the smallest positive value, so negative maximums were lost.
+    check_mip_generation (-4.0f, -FLT_MIN);
+}
+
+KAN_TEST_CASE (mip_kernels_positive_values)
+{
+    // Values near FLT_MIN make sure that kernels do not treat it as neutral element for max mode.
+    check_mip_generation (FLT_MIN, 2.0f * FLT_MIN);
+}
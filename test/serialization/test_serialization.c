@@ -658,27 +658,14 @@ KAN_TEST_CASE (binary_no_interned_string_registry)
     kan_reflection_registry_destroy (registry);
 }
 
-KAN_TEST_CASE (binary_with_interned_string_registry)
+static void save_interned_string_registry (kan_serialization_interned_string_registry_t interned_string_registry)
 {
-    kan_reflection_registry_t registry = kan_reflection_registry_create ();
-    KAN_REFLECTION_UNIT_REGISTRAR_NAME (test_serialization) (registry);
-    kan_serialization_binary_script_storage_t script_storage =
-        kan_serialization_binary_script_storage_create (registry);
-
-    kan_serialization_interned_string_registry_t interned_string_registry_write =
-        kan_serialization_interned_string_registry_create_empty ();
-
-    struct map_t initial_map;
-    map_init (&initial_map);
-    fill_test_map (&initial_map, registry);
-    save_map_binary (&initial_map, script_storage, interned_string_registry_write);
-
     struct kan_stream_t *direct_file_stream = kan_direct_file_stream_open_for_write ("string_registry.bin", true);
     struct kan_stream_t *buffered_file_stream =
         kan_random_access_stream_buffer_open_for_write (direct_file_stream, 1024u);
 
     kan_serialization_interned_string_registry_writer_t registry_writer =
-        kan_serialization_interned_string_registry_writer_create (buffered_file_stream, interned_string_registry_write);
+        kan_serialization_interned_string_registry_writer_create (buffered_file_stream, interned_string_registry);
 
     while (true)
     {
@@ -693,9 +680,13 @@ KAN_TEST_CASE (binary_with_interned_string_registry)
 
     kan_serialization_interned_string_registry_writer_destroy (registry_writer);
     buffered_file_stream->operations->close (buffered_file_stream);
+}
 
-    direct_file_stream = kan_direct_file_stream_open_for_read ("string_registry.bin", true);
-    buffered_file_stream = kan_random_access_stream_buffer_open_for_read (direct_file_stream, 1024u);
+static kan_serialization_interned_string_registry_t load_interned_string_registry (void)
+{
+    struct kan_stream_t *direct_file_stream = kan_direct_file_stream_open_for_read ("string_registry.bin", true);
+    struct kan_stream_t *buffered_file_stream =
+        kan_random_access_stream_buffer_open_for_read (direct_file_stream, 1024u);
 
     kan_serialization_interned_string_registry_reader_t registry_reader =
         kan_serialization_interned_string_registry_reader_create (buffered_file_stream, true);
@@ -711,11 +702,71 @@ KAN_TEST_CASE (binary_with_interned_string_registry)
         }
     }
 
-    kan_serialization_interned_string_registry_t interned_string_registry_read =
+    kan_serialization_interned_string_registry_t interned_string_registry =
         kan_serialization_interned_string_registry_reader_get (registry_reader);
 
     kan_serialization_interned_string_registry_reader_destroy (registry_reader);
     buffered_file_stream->operations->close (buffered_file_stream);
+    return interned_string_registry;
+}
+
+KAN_TEST_CASE (binary_with_interned_string_registry)
+{
+    kan_reflection_registry_t registry = kan_reflection_registry_create ();
+    KAN_REFLECTION_UNIT_REGISTRAR_NAME (test_serialization) (registry);
+    kan_serialization_binary_script_storage_t script_storage =
+        kan_serialization_binary_script_storage_create (registry);
+
+    kan_serialization_interned_string_registry_t interned_string_registry_write =
+        kan_serialization_interned_string_registry_create_empty ();
+
+    struct map_t initial_map;
+    map_init (&initial_map);
+    fill_test_map (&initial_map, registry);
+    save_map_binary (&initial_map, script_storage, interned_string_registry_write);
+
+    save_interned_string_registry (interned_string_registry_write);
+    kan_serialization_interned_string_registry_t interned_string_registry_read = load_interned_string_registry ();
+
+    struct map_t deserialized_map;
+    map_init (&deserialized_map);
+    load_map_binary (&deserialized_map, script_storage, interned_string_registry_read);
+
+    check_map_equality (&initial_map, &deserialized_map);
+    map_shutdown (&initial_map);
+    map_shutdown (&deserialized_map);
+
+    kan_serialization_binary_script_storage_destroy (script_storage);
+    kan_reflection_registry_destroy (registry);
+
+    kan_serialization_interned_string_registry_destroy (interned_string_registry_write);
+    kan_serialization_interned_string_registry_destroy (interned_string_registry_read);
+}
+
+KAN_TEST_CASE (binary_with_merged_interned_string_registry)
+{
+    kan_reflection_registry_t registry = kan_reflection_registry_create ();
+    KAN_REFLECTION_UNIT_REGISTRAR_NAME (test_serialization) (registry);
+    kan_serialization_binary_script_storage_t script_storage =
+        kan_serialization_binary_script_storage_create (registry);
+
+    struct map_t initial_map;
+    map_init (&initial_map);
+    fill_test_map (&initial_map, registry);
+
+    // Collect strings into local registry first, then merge it into the registry that is used for the real save.
+    kan_serialization_interned_string_registry_t interned_string_registry_local =
+        kan_serialization_interned_string_registry_create_empty ();
+    save_map_binary (&initial_map, script_storage, interned_string_registry_local);
+
+    kan_serialization_interned_string_registry_t interned_string_registry_write =
+        kan_serialization_interned_string_registry_create_empty ();
+    kan_serialization_interned_string_registry_merge (interned_string_registry_write, interned_string_registry_local);
+    kan_serialization_interned_string_registry_merge (interned_string_registry_write, interned_string_registry_local);
+    save_map_binary (&initial_map, script_storage, interned_string_registry_write);
+
+    save_interned_string_registry (interned_string_registry_write);
+    kan_serialization_interned_string_registry_t interned_string_registry_read = load_interned_string_registry ();
 
     struct map_t deserialized_map;
     map_init (&deserialized_map);
@@ -728,6 +779,7 @@ KAN_TEST_CASE (binary_with_interned_string_registry)
     kan_serialization_binary_script_storage_destroy (script_storage);
     kan_reflection_registry_destroy (registry);
 
+    kan_serialization_interned_string_registry_destroy (interned_string_registry_local);
     kan_serialization_interned_string_registry_destroy (interned_string_registry_write);
     kan_serialization_interned_string_registry_destroy (interned_string_registry_read);
 }
@@ -357,9 +357,14 @@ static kan_render_graphics_pipeline_t create_text_pipeline (
 
 #define TEST_WIDTH 800u
 #define TEST_HEIGHT 800u
+#define TEST_UV_TOLERANCE 0.00001
 
 #define FONT_STYLE_NAME_BOLD "bold"
 
+#define FONT_PATH_REGULAR "../../../tests_resources/text/fonts/OpenSans-VariableFont_wdth,wght.ttf"
+#define FONT_PATH_ITALIC "../../../tests_resources/text/fonts/OpenSans-Italic-VariableFont_wdth,wght.ttf"
+#define FONT_PATH_ARABIC "../../../tests_resources/text/fonts/Cairo-VariableFont_slnt,wght.ttf"
+
 static void check_rgba_equal_enough (uint32_t *first, uint32_t *second, uint32_t count)
 {
     uint32_t error_count = 0u;
@@ -380,56 +385,75 @@ static void check_rgba_equal_enough (uint32_t *first, uint32_t *second, uint32_t
     KAN_TEST_CHECK (error_count < max_error_count)
 }
 
-static void run_test (const char *expectation_file, struct kan_text_shaping_request_t *text_request)
+/// \brief Reads whole font file into memory that should be freed with `KAN_ALLOCATION_GROUP_IGNORE`.
+static void *load_test_font (const char *path, kan_file_size_t *output_size)
 {
-    struct kan_stream_t *input_stream_regular = kan_direct_file_stream_open_for_read (
-        "../../../tests_resources/text/fonts/OpenSans-VariableFont_wdth,wght.ttf", true);
-    KAN_TEST_ASSERT (input_stream_regular)
-
-    KAN_TEST_ASSERT (input_stream_regular->operations->seek (input_stream_regular, KAN_STREAM_SEEK_END, 0))
-    const kan_file_size_t font_file_size_regular = input_stream_regular->operations->tell (input_stream_regular);
-    KAN_TEST_ASSERT (input_stream_regular->operations->seek (input_stream_regular, KAN_STREAM_SEEK_START, 0))
-
-    void *font_memory_regular = kan_allocate_general (KAN_ALLOCATION_GROUP_IGNORE, font_file_size_regular, 1u);
-    CUSHION_DEFER { kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, font_memory_regular, font_file_size_regular); }
+    struct kan_stream_t *input_stream = kan_direct_file_stream_open_for_read (path, true);
+    KAN_TEST_ASSERT (input_stream)
+
+    KAN_TEST_ASSERT (input_stream->operations->seek (input_stream, KAN_STREAM_SEEK_END, 0))
+    *output_size = input_stream->operations->tell (input_stream);
+    KAN_TEST_ASSERT (input_stream->operations->seek (input_stream, KAN_STREAM_SEEK_START, 0))
+
+    void *font_memory = kan_allocate_general (KAN_ALLOCATION_GROUP_IGNORE, *output_size, 1u);
+    const kan_file_size_t font_read = input_stream->operations->read (input_stream, *output_size, font_memory);
+    KAN_TEST_ASSERT (font_read == *output_size)
+    input_stream->operations->close (input_stream);
+    return font_memory;
+}
 
-    const kan_file_size_t font_read_regular =
-        input_stream_regular->operations->read (input_stream_regular, font_file_size_regular, font_memory_regular);
-    KAN_TEST_ASSERT (font_read_regular == font_file_size_regular)
-    input_stream_regular->operations->close (input_stream_regular);
+static void select_test_device (kan_context_system_t render_backend_system)
+{
+    struct kan_render_supported_devices_t *devices = kan_render_backend_system_get_devices (render_backend_system);
+    printf ("Devices (%lu):\n", (unsigned long) devices->supported_device_count);
+    kan_render_device_t picked_device = KAN_HANDLE_INITIALIZE_INVALID;
+    kan_instance_size_t picked_device_index = KAN_INT_MAX (kan_instance_size_t);
 
-    struct kan_stream_t *input_stream_italic = kan_direct_file_stream_open_for_read (
-        "../../../tests_resources/text/fonts/OpenSans-Italic-VariableFont_wdth,wght.ttf", true);
-    KAN_TEST_ASSERT (input_stream_italic)
+    for (kan_loop_size_t index = 0u; index < devices->supported_device_count; ++index)
+    {
+        printf ("  - name: %s\n    device_type: %lu\n    memory_type: %lu\n", devices->devices[index].name,
+                (unsigned long) devices->devices[index].device_type,
+                (unsigned long) devices->devices[index].memory_type);
 
-    KAN_TEST_ASSERT (input_stream_italic->operations->seek (input_stream_italic, KAN_STREAM_SEEK_END, 0))
-    const kan_file_size_t font_file_size_italic = input_stream_italic->operations->tell (input_stream_italic);
-    KAN_TEST_ASSERT (input_stream_italic->operations->seek (input_stream_italic, KAN_STREAM_SEEK_START, 0))
+        if (picked_device_index == KAN_INT_MAX (kan_instance_size_t) ||
+            devices->devices[picked_device_index].device_type != KAN_RENDER_DEVICE_TYPE_DISCRETE_GPU)
+        {
+            picked_device = devices->devices[index].id;
+            picked_device_index = index;
+        }
+    }
 
-    void *font_memory_italic = kan_allocate_general (KAN_ALLOCATION_GROUP_IGNORE, font_file_size_italic, 1u);
-    CUSHION_DEFER { kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, font_memory_italic, font_file_size_italic); }
+    kan_render_backend_system_select_device (render_backend_system, picked_device);
+}
 
-    const kan_file_size_t font_read_italic =
-        input_stream_italic->operations->read (input_stream_italic, font_file_size_italic, font_memory_italic);
-    KAN_TEST_ASSERT (font_read_italic == font_file_size_italic)
-    input_stream_italic->operations->close (input_stream_italic);
+static void check_shaped_data_equal (struct kan_text_shaped_data_t *first, struct kan_text_shaped_data_t *second)
+{
+    KAN_TEST_CHECK (first->min.x == second->min.x)
+    KAN_TEST_CHECK (first->min.y == second->min.y)
+    KAN_TEST_CHECK (first->max.x == second->max.x)
+    KAN_TEST_CHECK (first->max.y == second->max.y)
+    KAN_TEST_ASSERT (first->glyphs.size == second->glyphs.size)
+    KAN_TEST_CHECK (memcmp (first->glyphs.data, second->glyphs.data,
+                            sizeof (struct kan_text_shaped_glyph_instance_data_t) * first->glyphs.size) == 0)
+    KAN_TEST_ASSERT (first->icons.size == second->icons.size)
+    KAN_TEST_CHECK (memcmp (first->icons.data, second->icons.data,
+                            sizeof (struct kan_text_shaped_icon_instance_data_t) * first->icons.size) == 0)
+}
 
-    struct kan_stream_t *input_stream_arabic = kan_direct_file_stream_open_for_read (
-        "../../../tests_resources/text/fonts/Cairo-VariableFont_slnt,wght.ttf", true);
-    KAN_TEST_ASSERT (input_stream_arabic)
+static void run_test (const char *expectation_file, struct kan_text_shaping_request_t *text_request)
+{
+    kan_file_size_t font_file_size_regular;
+    void *font_memory_regular = load_test_font (FONT_PATH_REGULAR, &font_file_size_regular);
+    CUSHION_DEFER { kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, font_memory_regular, font_file_size_regular); }
 
-    KAN_TEST_ASSERT (input_stream_arabic->operations->seek (input_stream_arabic, KAN_STREAM_SEEK_END, 0))
-    const kan_file_size_t font_file_size_arabic = input_stream_arabic->operations->tell (input_stream_arabic);
-    KAN_TEST_ASSERT (input_stream_arabic->operations->seek (input_stream_arabic, KAN_STREAM_SEEK_START, 0))
+    kan_file_size_t font_file_size_italic;
+    void *font_memory_italic = load_test_font (FONT_PATH_ITALIC, &font_file_size_italic);
+    CUSHION_DEFER { kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, font_memory_italic, font_file_size_italic); }
 
-    void *font_memory_arabic = kan_allocate_general (KAN_ALLOCATION_GROUP_IGNORE, font_file_size_arabic, 1u);
+    kan_file_size_t font_file_size_arabic;
+    void *font_memory_arabic = load_test_font (FONT_PATH_ARABIC, &font_file_size_arabic);
     CUSHION_DEFER { kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, font_memory_arabic, font_file_size_arabic); }
 
-    const kan_file_size_t font_read_arabic =
-        input_stream_arabic->operations->read (input_stream_arabic, font_file_size_arabic, font_memory_arabic);
-    KAN_TEST_ASSERT (font_read_arabic == font_file_size_arabic)
-    input_stream_arabic->operations->close (input_stream_arabic);
-
     kan_platform_application_init ();
     CUSHION_DEFER { kan_platform_application_shutdown (); }
 
@@ -454,27 +478,8 @@ static void run_test (const char *expectation_file, struct kan_text_shaping_requ
 
     kan_context_system_t render_backend_system = kan_context_query (context, KAN_CONTEXT_RENDER_BACKEND_SYSTEM_NAME);
     kan_render_context_t render_context = kan_render_backend_system_get_render_context (render_backend_system);
+    select_test_device (render_backend_system);
 
-    struct kan_render_supported_devices_t *devices = kan_render_backend_system_get_devices (render_backend_system);
-    printf ("Devices (%lu):\n", (unsigned long) devices->supported_device_count);
-    kan_render_device_t picked_device = KAN_HANDLE_INITIALIZE_INVALID;
-    kan_instance_size_t picked_device_index = KAN_INT_MAX (kan_instance_size_t);
-
-    for (kan_loop_size_t index = 0u; index < devices->supported_device_count; ++index)
-    {
-        printf ("  - name: %s\n    device_type: %lu\n    memory_type: %lu\n", devices->devices[index].name,
-                (unsigned long) devices->devices[index].device_type,
-                (unsigned long) devices->devices[index].memory_type);
-
-        if (picked_device_index == KAN_INT_MAX (kan_instance_size_t) ||
-            devices->devices[picked_device_index].device_type != KAN_RENDER_DEVICE_TYPE_DISCRETE_GPU)
-        {
-            picked_device = devices->devices[index].id;
-            picked_device_index = index;
-        }
-    }
-
-    kan_render_backend_system_select_device (render_backend_system, picked_device);
     float open_sans_regular_variable_axis[] = {
         400.0f,
         100.0f,
@@ -569,6 +574,13 @@ static void run_test (const char *expectation_file, struct kan_text_shaping_requ
     CUSHION_DEFER { kan_text_shaped_data_shutdown (&shaped_data); }
     KAN_TEST_ASSERT (kan_font_library_shape (font_library, text_request, &shaped_data))
 
+    // Shape again to make sure that shaping from cached runs produces exactly the same result.
+    struct kan_text_shaped_data_t reshaped_data;
+    kan_text_shaped_data_init (&reshaped_data);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&reshaped_data); }
+    KAN_TEST_ASSERT (kan_font_library_shape (font_library, text_request, &reshaped_data))
+    check_shaped_data_equal (&reshaped_data, &shaped_data);
+
     kan_render_pass_t text_pass = create_text_pass (render_context);
     KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (text_pass))
 
@@ -1189,3 +1201,440 @@ KAN_TEST_CASE (ltr_3_langs)
 
     run_test ("../../../tests_resources/text/expectations/ltr_3_langs.png", &request);
 }
+
+typedef void (*font_library_check_function_t) (kan_font_library_t font_library,
+                                               kan_font_library_t second_font_library);
+
+/// \brief Creates two font libraries with regular and bold latin categories and passes them to given check function.
+/// \details These tests do not render anything, but font libraries still need render context for their atlases.
+///          Second library makes it possible to compare results of different code paths on the same fonts.
+static void run_font_library_test (font_library_check_function_t check_function)
+{
+    kan_file_size_t font_file_size_regular;
+    void *font_memory_regular = load_test_font (FONT_PATH_REGULAR, &font_file_size_regular);
+    CUSHION_DEFER { kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, font_memory_regular, font_file_size_regular); }
+
+    kan_platform_application_init ();
+    CUSHION_DEFER { kan_platform_application_shutdown (); }
+
+    kan_context_t context =
+        kan_context_create (kan_allocation_group_get_child (kan_allocation_group_root (), "context"));
+    CUSHION_DEFER { kan_context_destroy (context); }
+
+    struct kan_render_backend_system_config_t render_backend_config = {
+        .application_info_name = kan_string_intern ("Kan autotest"),
+        .version_major = 1u,
+        .version_minor = 0u,
+        .version_patch = 0u,
+    };
+
+    KAN_TEST_CHECK (kan_context_request_system (context, KAN_CONTEXT_APPLICATION_SYSTEM_NAME, NULL))
+    KAN_TEST_CHECK (
+        kan_context_request_system (context, KAN_CONTEXT_RENDER_BACKEND_SYSTEM_NAME, &render_backend_config))
+
+    kan_context_assembly (context);
+    kan_context_system_t application_system = kan_context_query (context, KAN_CONTEXT_APPLICATION_SYSTEM_NAME);
+    CUSHION_DEFER { kan_application_system_prepare_for_destroy_in_main_thread (application_system); }
+
+    kan_context_system_t render_backend_system = kan_context_query (context, KAN_CONTEXT_RENDER_BACKEND_SYSTEM_NAME);
+    kan_render_context_t render_context = kan_render_backend_system_get_render_context (render_backend_system);
+    select_test_device (render_backend_system);
+
+    float open_sans_regular_variable_axis[] = {
+        400.0f,
+        100.0f,
+    };
+
+    float open_sans_bold_variable_axis[] = {
+        700.0f,
+        100.0f,
+    };
+
+    struct kan_font_library_category_t font_library_categories[] = {
+        {
+            .script = kan_string_intern ("Latn"),
+            .style = NULL,
+            .variable_axis_count =
+                sizeof (open_sans_regular_variable_axis) / sizeof (open_sans_regular_variable_axis[0u]),
+            .variable_axis = open_sans_regular_variable_axis,
+            .data_size = (kan_memory_size_t) font_file_size_regular,
+            .data = font_memory_regular,
+        },
+        {
+            .script = kan_string_intern ("Latn"),
+            .style = kan_string_intern (FONT_STYLE_NAME_BOLD),
+            .variable_axis_count = sizeof (open_sans_bold_variable_axis) / sizeof (open_sans_bold_variable_axis[0u]),
+            .variable_axis = open_sans_bold_variable_axis,
+            .data_size = (kan_memory_size_t) font_file_size_regular,
+            .data = font_memory_regular,
+        },
+    };
+
+    kan_font_library_t font_library = kan_font_library_create (
+        render_context, sizeof (font_library_categories) / sizeof (font_library_categories[0u]),
+        font_library_categories);
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (font_library))
+    CUSHION_DEFER { kan_font_library_destroy (font_library); }
+
+    kan_font_library_t second_font_library = kan_font_library_create (
+        render_context, sizeof (font_library_categories) / sizeof (font_library_categories[0u]),
+        font_library_categories);
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (second_font_library))
+    CUSHION_DEFER { kan_font_library_destroy (second_font_library); }
+
+    // Cache might be disabled by default through build configuration, but these tests need it.
+    kan_font_library_set_shape_cache_max_size (font_library, 1024u * 1024u);
+    kan_font_library_set_shape_cache_max_size (second_font_library, 1024u * 1024u);
+    check_function (font_library, second_font_library);
+}
+
+/// \brief Creates text with three runs: bold, regular and bold again, so every part is shaped as separate run.
+static kan_text_t create_shape_cache_test_text (const char *bold_begin, const char *regular, const char *bold_end)
+{
+    struct kan_text_item_t text_content[] = {
+        {
+            .type = KAN_TEXT_ITEM_STYLE,
+            .style =
+                {
+                    .style = kan_string_intern (FONT_STYLE_NAME_BOLD),
+                    .mark = 1u,
+                },
+        },
+        {
+            .type = KAN_TEXT_ITEM_UTF8,
+            .utf8 = bold_begin,
+        },
+        {
+            .type = KAN_TEXT_ITEM_STYLE,
+            .style =
+                {
+                    .style = NULL,
+                    .mark = 0u,
+                },
+        },
+        {
+            .type = KAN_TEXT_ITEM_UTF8,
+            .utf8 = regular,
+        },
+        {
+            .type = KAN_TEXT_ITEM_STYLE,
+            .style =
+                {
+                    .style = kan_string_intern (FONT_STYLE_NAME_BOLD),
+                    .mark = 1u,
+                },
+        },
+        {
+            .type = KAN_TEXT_ITEM_UTF8,
+            .utf8 = bold_end,
+        },
+    };
+
+    kan_text_t text = kan_text_create (sizeof (text_content) / sizeof (text_content[0u]), text_content);
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (text))
+    return text;
+}
+
+static kan_text_t create_shape_cache_single_run_text (const char *utf8)
+{
+    struct kan_text_item_t text_content[] = {
+        {
+            .type = KAN_TEXT_ITEM_UTF8,
+            .utf8 = utf8,
+        },
+    };
+
+    kan_text_t text = kan_text_create (sizeof (text_content) / sizeof (text_content[0u]), text_content);
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (text))
+    return text;
+}
+
+static void shape_cache_test_shape (kan_font_library_t font_library,
+                                    kan_text_t text,
+                                    struct kan_text_shaped_data_t *output)
+{
+    struct kan_text_shaping_request_t request = {
+        .font_size = 30u,
+        .render_format = KAN_FONT_GLYPH_RENDER_FORMAT_SDF,
+        .orientation = KAN_TEXT_ORIENTATION_HORIZONTAL,
+        .reading_direction = KAN_TEXT_READING_DIRECTION_LEFT_TO_RIGHT,
+        .alignment = KAN_TEXT_SHAPING_ALIGNMENT_LEFT,
+        .primary_axis_limit = 600u,
+        .text = text,
+    };
+
+    KAN_TEST_ASSERT (kan_font_library_shape (font_library, &request, output))
+}
+
+/// \brief Shapes given text and checks how many runs were taken from the cache and how many were shaped.
+static void shape_cache_test_shape_and_check (kan_font_library_t font_library,
+                                              kan_text_t text,
+                                              struct kan_text_shaped_data_t *output,
+                                              kan_instance_size_t expected_hits,
+                                              kan_instance_size_t expected_misses)
+{
+    struct kan_font_library_shape_cache_statistics_t before;
+    kan_font_library_get_shape_cache_statistics (font_library, &before);
+    shape_cache_test_shape (font_library, text, output);
+
+    struct kan_font_library_shape_cache_statistics_t after;
+    kan_font_library_get_shape_cache_statistics (font_library, &after);
+    KAN_TEST_CHECK (after.hits - before.hits == expected_hits)
+    KAN_TEST_CHECK (after.misses - before.misses == expected_misses)
+}
+
+/// \brief Shapes given text with disabled cache in order to get reference result that does not depend on cache.
+static void shape_cache_test_shape_uncached (kan_font_library_t font_library,
+                                             kan_text_t text,
+                                             struct kan_text_shaped_data_t *output)
+{
+    kan_font_library_set_shape_cache_max_size (font_library, 0u);
+    shape_cache_test_shape_and_check (font_library, text, output, 0u, 0u);
+    kan_font_library_set_shape_cache_max_size (font_library, 1024u * 1024u);
+}
+
+static void check_shape_cache_cross_text_reuse (kan_font_library_t font_library, kan_font_library_t second_font_library)
+{
+    kan_text_t first_text = create_shape_cache_test_text ("Robert Guiscard", " was a Norman adventurer ", "Hauteville");
+    CUSHION_DEFER { kan_text_destroy (first_text); }
+
+    kan_text_t second_text =
+        create_shape_cache_test_text ("Robert Guiscard", " was a Norman adventurer ", "Hauteville");
+    CUSHION_DEFER { kan_text_destroy (second_text); }
+
+    struct kan_text_shaped_data_t first_shaped;
+    kan_text_shaped_data_init (&first_shaped);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&first_shaped); }
+    shape_cache_test_shape_and_check (font_library, first_text, &first_shaped, 0u, 3u);
+
+    // Different text object with the same runs must reuse all of them.
+    struct kan_text_shaped_data_t second_shaped;
+    kan_text_shaped_data_init (&second_shaped);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&second_shaped); }
+    shape_cache_test_shape_and_check (font_library, second_text, &second_shaped, 3u, 0u);
+    check_shaped_data_equal (&first_shaped, &second_shaped);
+
+    // Runs are cached per category, so the same utf8 with different style must not be reused.
+    kan_text_t swapped_text =
+        create_shape_cache_test_text ("Hauteville", "Robert Guiscard", " was a Norman adventurer ");
+    CUSHION_DEFER { kan_text_destroy (swapped_text); }
+
+    struct kan_text_shaped_data_t swapped_shaped;
+    kan_text_shaped_data_init (&swapped_shaped);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&swapped_shaped); }
+    shape_cache_test_shape_and_check (font_library, swapped_text, &swapped_shaped, 1u, 2u);
+
+    struct kan_text_shaped_data_t swapped_reference;
+    kan_text_shaped_data_init (&swapped_reference);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&swapped_reference); }
+    shape_cache_test_shape_uncached (font_library, swapped_text, &swapped_reference);
+    check_shaped_data_equal (&swapped_shaped, &swapped_reference);
+}
+
+KAN_TEST_CASE (shape_cache_cross_text_reuse) { run_font_library_test (check_shape_cache_cross_text_reuse); }
+
+static void check_shape_cache_partial_reshape (kan_font_library_t font_library, kan_font_library_t second_font_library)
+{
+    kan_text_t text = create_shape_cache_test_text ("Score ", " collected by player ", " points");
+    CUSHION_DEFER { kan_text_destroy (text); }
+
+    struct kan_text_shaped_data_t shaped;
+    kan_text_shaped_data_init (&shaped);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&shaped); }
+    shape_cache_test_shape_and_check (font_library, text, &shaped, 0u, 3u);
+
+    // Only the changed run must be passed to harfbuzz, the rest of the text must be taken from the cache.
+    kan_text_t changed_text = create_shape_cache_test_text ("Score ", " collected by other player ", " points");
+    CUSHION_DEFER { kan_text_destroy (changed_text); }
+
+    struct kan_text_shaped_data_t changed_shaped;
+    kan_text_shaped_data_init (&changed_shaped);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&changed_shaped); }
+    shape_cache_test_shape_and_check (font_library, changed_text, &changed_shaped, 2u, 1u);
+
+    // Layout is recalculated for the whole text, so result must be the same as without cache at all.
+    struct kan_text_shaped_data_t changed_reference;
+    kan_text_shaped_data_init (&changed_reference);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&changed_reference); }
+    shape_cache_test_shape_uncached (font_library, changed_text, &changed_reference);
+    check_shaped_data_equal (&changed_shaped, &changed_reference);
+    KAN_TEST_CHECK (changed_shaped.glyphs.size > shaped.glyphs.size)
+}
+
+KAN_TEST_CASE (shape_cache_partial_reshape) { run_font_library_test (check_shape_cache_partial_reshape); }
+
+static void check_shape_cache_lru_eviction (kan_font_library_t font_library, kan_font_library_t second_font_library)
+{
+    kan_text_t first_text = create_shape_cache_single_run_text ("Robert Guiscard");
+    CUSHION_DEFER { kan_text_destroy (first_text); }
+
+    kan_text_t second_text = create_shape_cache_single_run_text ("Normandy adventurer");
+    CUSHION_DEFER { kan_text_destroy (second_text); }
+
+    // Shorter than the second text, so it always fits instead of the second one.
+    kan_text_t third_text = create_shape_cache_single_run_text ("Sicily");
+    CUSHION_DEFER { kan_text_destroy (third_text); }
+
+    struct kan_text_shaped_data_t shaped;
+    kan_text_shaped_data_init (&shaped);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&shaped); }
+
+    struct kan_font_library_shape_cache_statistics_t statistics;
+    kan_font_library_get_shape_cache_statistics (font_library, &statistics);
+    KAN_TEST_CHECK (statistics.entries == 0u)
+    KAN_TEST_CHECK (statistics.size == 0u)
+
+    shape_cache_test_shape_and_check (font_library, first_text, &shaped, 0u, 1u);
+    kan_font_library_get_shape_cache_statistics (font_library, &statistics);
+    const kan_memory_size_t first_size = statistics.size;
+
+    shape_cache_test_shape_and_check (font_library, second_text, &shaped, 0u, 1u);
+    kan_font_library_get_shape_cache_statistics (font_library, &statistics);
+    const kan_memory_size_t second_size = statistics.size - first_size;
+    KAN_TEST_CHECK (statistics.entries == 2u)
+    KAN_TEST_CHECK (statistics.evictions == 0u)
+
+    // Shrink the cache so it is only able to hold the first two runs.
+    kan_font_library_set_shape_cache_max_size (font_library, first_size + second_size);
+    kan_font_library_get_shape_cache_statistics (font_library, &statistics);
+    KAN_TEST_CHECK (statistics.entries == 2u)
+    KAN_TEST_CHECK (statistics.evictions == 0u)
+
+    // Use the first run, so the second one becomes the least recently used.
+    shape_cache_test_shape_and_check (font_library, first_text, &shaped, 1u, 0u);
+
+    // New run does not fit, so the least recently used run must be evicted.
+    shape_cache_test_shape_and_check (font_library, third_text, &shaped, 0u, 1u);
+    kan_font_library_get_shape_cache_statistics (font_library, &statistics);
+    KAN_TEST_CHECK (statistics.entries == 2u)
+    KAN_TEST_CHECK (statistics.evictions == 1u)
+    KAN_TEST_CHECK (statistics.size <= first_size + second_size)
+
+    shape_cache_test_shape_and_check (font_library, first_text, &shaped, 1u, 0u);
+    shape_cache_test_shape_and_check (font_library, third_text, &shaped, 1u, 0u);
+    shape_cache_test_shape_and_check (font_library, second_text, &shaped, 0u, 1u);
+
+    // Disabling the cache evicts everything.
+    kan_font_library_set_shape_cache_max_size (font_library, 0u);
+    kan_font_library_get_shape_cache_statistics (font_library, &statistics);
+    KAN_TEST_CHECK (statistics.entries == 0u)
+    KAN_TEST_CHECK (statistics.size == 0u)
+}
+
+KAN_TEST_CASE (shape_cache_lru_eviction) { run_font_library_test (check_shape_cache_lru_eviction); }
+
+/// \brief Contains much more unique latin glyphs than parallel render threshold.
+static const char *parallel_render_test_utf8 =
+    "Sphinx of black quartz, judge my vow! THE FIVE BOXING WIZARDS JUMP QUICKLY 0123456789";
+
+/// \brief Checks that shaped data is equal except for glyph placement on atlas, which depends on render order.
+static void check_shaped_data_equal_except_atlas_placement (struct kan_text_shaped_data_t *first,
+                                                            struct kan_text_shaped_data_t *second)
+{
+    KAN_TEST_CHECK (first->min.x == second->min.x)
+    KAN_TEST_CHECK (first->min.y == second->min.y)
+    KAN_TEST_CHECK (first->max.x == second->max.x)
+    KAN_TEST_CHECK (first->max.y == second->max.y)
+    KAN_TEST_ASSERT (first->glyphs.size == second->glyphs.size)
+
+    for (kan_loop_size_t index = 0u; index < first->glyphs.size; ++index)
+    {
+        struct kan_text_shaped_glyph_instance_data_t *first_glyph =
+            &((struct kan_text_shaped_glyph_instance_data_t *) first->glyphs.data)[index];
+        struct kan_text_shaped_glyph_instance_data_t *second_glyph =
+            &((struct kan_text_shaped_glyph_instance_data_t *) second->glyphs.data)[index];
+
+        KAN_TEST_CHECK (first_glyph->min.x == second_glyph->min.x)
+        KAN_TEST_CHECK (first_glyph->min.y == second_glyph->min.y)
+        KAN_TEST_CHECK (first_glyph->max.x == second_glyph->max.x)
+        KAN_TEST_CHECK (first_glyph->max.y == second_glyph->max.y)
+        KAN_TEST_CHECK (first_glyph->layer == second_glyph->layer)
+        KAN_TEST_CHECK (first_glyph->mark == second_glyph->mark)
+        KAN_TEST_CHECK (first_glyph->read_index == second_glyph->read_index)
+
+        // Bitmap sizes must be the same, but position on atlas might differ.
+        KAN_TEST_CHECK (fabs ((first_glyph->uv_max.x - first_glyph->uv_min.x) -
+                              (second_glyph->uv_max.x - second_glyph->uv_min.x)) < TEST_UV_TOLERANCE)
+        KAN_TEST_CHECK (fabs ((first_glyph->uv_max.y - first_glyph->uv_min.y) -
+                              (second_glyph->uv_max.y - second_glyph->uv_min.y)) < TEST_UV_TOLERANCE)
+    }
+
+    KAN_TEST_ASSERT (first->icons.size == second->icons.size)
+}
+
+static void check_parallel_glyph_render (kan_font_library_t font_library, kan_font_library_t serial_font_library)
+{
+    kan_text_t text = create_shape_cache_single_run_text (parallel_render_test_utf8);
+    CUSHION_DEFER { kan_text_destroy (text); }
+
+    // Every glyph is rendered at once, so batch is big enough to be rendered in parallel.
+    struct kan_text_shaped_data_t parallel_shaped;
+    kan_text_shaped_data_init (&parallel_shaped);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&parallel_shaped); }
+    shape_cache_test_shape (font_library, text, &parallel_shaped);
+
+    const kan_instance_size_t rendered_count = kan_font_library_get_rendered_glyphs_count (font_library);
+    KAN_TEST_CHECK (rendered_count >= KAN_TEXT_FT_HB_SDF_RENDER_PARALLEL_THRESHOLD)
+
+    // Shape characters one by one, so second library never has enough glyphs in batch to render them in parallel.
+    struct kan_text_shaped_data_t character_shaped;
+    kan_text_shaped_data_init (&character_shaped);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&character_shaped); }
+    char character_utf8[2u] = {'\0', '\0'};
+
+    for (const char *character = parallel_render_test_utf8; *character; ++character)
+    {
+        const kan_instance_size_t rendered_before = kan_font_library_get_rendered_glyphs_count (serial_font_library);
+        character_utf8[0u] = *character;
+
+        kan_text_t character_text = create_shape_cache_single_run_text (character_utf8);
+        shape_cache_test_shape (serial_font_library, character_text, &character_shaped);
+        kan_text_destroy (character_text);
+        KAN_TEST_CHECK (kan_font_library_get_rendered_glyphs_count (serial_font_library) - rendered_before <= 1u)
+    }
+
+    KAN_TEST_CHECK (kan_font_library_get_rendered_glyphs_count (serial_font_library) == rendered_count)
+    struct kan_text_shaped_data_t serial_shaped;
+    kan_text_shaped_data_init (&serial_shaped);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&serial_shaped); }
+    shape_cache_test_shape (serial_font_library, text, &serial_shaped);
+
+    KAN_TEST_CHECK (kan_font_library_get_rendered_glyphs_count (serial_font_library) == rendered_count)
+    check_shaped_data_equal_except_atlas_placement (&parallel_shaped, &serial_shaped);
+}
+
+KAN_TEST_CASE (parallel_glyph_render) { run_font_library_test (check_parallel_glyph_render); }
+
+static void check_precache_then_shape (kan_font_library_t font_library, kan_font_library_t second_font_library)
+{
+    struct kan_text_precache_request_t precache_request = {
+        .script = kan_string_intern ("Latn"),
+        .style = NULL,
+        .render_format = KAN_FONT_GLYPH_RENDER_FORMAT_SDF,
+        .orientation = KAN_TEXT_ORIENTATION_HORIZONTAL,
+        .utf8 = parallel_render_test_utf8,
+    };
+
+    KAN_TEST_ASSERT (kan_font_library_precache (font_library, &precache_request))
+    const kan_instance_size_t rendered_count = kan_font_library_get_rendered_glyphs_count (font_library);
+    KAN_TEST_CHECK (rendered_count >= KAN_TEXT_FT_HB_SDF_RENDER_PARALLEL_THRESHOLD)
+
+    kan_text_t text = create_shape_cache_single_run_text (parallel_render_test_utf8);
+    CUSHION_DEFER { kan_text_destroy (text); }
+
+    struct kan_text_shaped_data_t shaped;
+    kan_text_shaped_data_init (&shaped);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&shaped); }
+    shape_cache_test_shape (font_library, text, &shaped);
+    KAN_TEST_CHECK (kan_font_library_get_rendered_glyphs_count (font_library) == rendered_count)
+
+    // Precached glyphs must be the same as the ones rendered during shaping.
+    struct kan_text_shaped_data_t reference_shaped;
+    kan_text_shaped_data_init (&reference_shaped);
+    CUSHION_DEFER { kan_text_shaped_data_shutdown (&reference_shaped); }
+    shape_cache_test_shape (second_font_library, text, &reference_shaped);
+    KAN_TEST_CHECK (kan_font_library_get_rendered_glyphs_count (second_font_library) == rendered_count)
+    check_shaped_data_equal_except_atlas_placement (&shaped, &reference_shaped);
+}
+
+KAN_TEST_CASE (precache_then_shape) { run_font_library_test (check_precache_then_shape); }
@@ -3,6 +3,7 @@
 #include <test_universe_resource_provider_api.h>
 
 #include <stddef.h>
+#include <stdio.h>
 
 #include <kan/context/all_system_names.h>
 #include <kan/context/hot_reload_coordination_system.h>
@@ -272,7 +273,10 @@ static void execute_resource_build (kan_reflection_registry_t registry, enum kan
     KAN_TEST_ASSERT (result == KAN_RESOURCE_BUILD_RESULT_SUCCESS)
 }
 
-static void run_test_loop (kan_context_t context, kan_interned_string_t mutator_name)
+static void run_test_loop_with_configuration (
+    kan_context_t context,
+    kan_interned_string_t mutator_name,
+    const struct kan_resource_provider_configuration_t *resource_provider_configuration)
 {
     kan_context_system_t universe_system_handle = kan_context_query (context, KAN_CONTEXT_UNIVERSE_SYSTEM_NAME);
     KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (universe_system_handle))
@@ -292,15 +296,10 @@ static void run_test_loop (kan_context_t context, kan_interned_string_t mutator_
     definition.world_name = KAN_STATIC_INTERNED_ID_GET (root_world);
     definition.scheduler_name = kan_string_intern (KAN_UNIVERSE_TRIVIAL_SCHEDULER_NAME);
 
-    struct kan_resource_provider_configuration_t resource_provider_configuration = {
-        .serve_budget_ns = 2000000u,
-        .resource_directory_path = kan_string_intern (RESOURCE_MOUNT_PATH),
-    };
-
     kan_reflection_patch_builder_t patch_builder = kan_reflection_patch_builder_create ();
     kan_reflection_patch_builder_add_chunk (patch_builder, KAN_REFLECTION_PATCH_BUILDER_SECTION_ROOT, 0u,
                                             sizeof (struct kan_resource_provider_configuration_t),
-                                            &resource_provider_configuration);
+                                            resource_provider_configuration);
     kan_reflection_patch_t resource_provider_configuration_patch = kan_reflection_patch_builder_build (
         patch_builder, registry,
         kan_reflection_registry_query_struct (registry,
@@ -340,6 +339,17 @@ static void run_test_loop (kan_context_t context, kan_interned_string_t mutator_
     }
 }
 
+static void run_test_loop (kan_context_t context,
+                           kan_interned_string_t mutator_name,
+                           bool background_deserialization)
+{
+    struct kan_resource_provider_configuration_t resource_provider_configuration;
+    kan_resource_provider_configuration_init (&resource_provider_configuration);
+    resource_provider_configuration.resource_directory_path = kan_string_intern (RESOURCE_MOUNT_PATH);
+    resource_provider_configuration.background_deserialization = background_deserialization;
+    run_test_loop_with_configuration (context, mutator_name, &resource_provider_configuration);
+}
+
 struct trivial_test_singleton_t
 {
     bool registration_checked;
@@ -541,7 +551,7 @@ TEST_UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_EXECUTE (trivial_test)
     }
 }
 
-KAN_TEST_CASE (trivial)
+static void run_trivial_test (bool background_deserialization)
 {
     kan_static_interned_ids_ensure_initialized ();
     kan_file_system_remove_directory_with_content (WORKSPACE_DIRECTORY);
@@ -558,9 +568,13 @@ KAN_TEST_CASE (trivial)
     initialize_platform_configuration (registry);
     setup_trivial_raw_resources (registry);
     execute_resource_build (registry, KAN_RESOURCE_BUILD_PACK_MODE_NONE);
-    run_test_loop (context, KAN_STATIC_INTERNED_ID_GET (trivial_test));
+    run_test_loop (context, KAN_STATIC_INTERNED_ID_GET (trivial_test), background_deserialization);
 }
 
+KAN_TEST_CASE (trivial) { run_trivial_test (false); }
+
+KAN_TEST_CASE (trivial_background) { run_trivial_test (true); }
+
 KAN_TEST_CASE (trivial_pack)
 {
     kan_static_interned_ids_ensure_initialized ();
@@ -594,7 +608,7 @@ KAN_TEST_CASE (trivial_pack)
         kan_virtual_file_system_volume_mount_read_only_pack (volume, RESOURCE_MOUNT_PATH, path_container.path);
     }
 
-    run_test_loop (context, KAN_STATIC_INTERNED_ID_GET (trivial_test));
+    run_test_loop (context, KAN_STATIC_INTERNED_ID_GET (trivial_test), false);
 }
 
 static void setup_hot_reload_initial_resources (kan_reflection_registry_t registry)
@@ -1020,7 +1034,7 @@ TEST_UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_EXECUTE (hot_reload_test)
     }
 }
 
-KAN_TEST_CASE (hot_reload)
+static void run_hot_reload_test (bool background_deserialization)
 {
     kan_static_interned_ids_ensure_initialized ();
     kan_file_system_remove_directory_with_content (WORKSPACE_DIRECTORY);
@@ -1038,7 +1052,15 @@ KAN_TEST_CASE (hot_reload)
 
     setup_hot_reload_initial_resources (registry);
     execute_resource_build (registry, KAN_RESOURCE_BUILD_PACK_MODE_NONE);
-    run_test_loop (context, KAN_STATIC_INTERNED_ID_GET (hot_reload_test));
+    run_test_loop (context, KAN_STATIC_INTERNED_ID_GET (hot_reload_test), background_deserialization);
+}
+
+KAN_TEST_CASE (hot_reload) { run_hot_reload_test (false); }
+
+KAN_TEST_CASE (hot_reload_background)
+{
+    // Hot reload is delayed while background loads are in flight, so it must still reload everything properly.
+    run_hot_reload_test (true);
 }
 
 static void save_third_party (const char *path, void *data, kan_memory_size_t length)
@@ -1140,5 +1162,313 @@ KAN_TEST_CASE (third_party_blob)
     initialize_platform_configuration (registry);
     setup_third_party_test_resources (registry);
     execute_resource_build (registry, KAN_RESOURCE_BUILD_PACK_MODE_NONE);
-    run_test_loop (context, KAN_STATIC_INTERNED_ID_GET (third_party_blob_test));
+    run_test_loop (context, KAN_STATIC_INTERNED_ID_GET (third_party_blob_test), false);
+}
+
+KAN_TEST_CASE (serve_budget)
+{
+    struct kan_resource_provider_configuration_t configuration;
+    kan_resource_provider_configuration_init (&configuration);
+
+    // Adaptive budgeting is disabled by default.
+    KAN_TEST_CHECK (configuration.target_frame_time_ns == 0u)
+    KAN_TEST_CHECK (configuration.serve_budget_max_ns == configuration.serve_budget_ns)
+    KAN_TEST_CHECK (kan_resource_provider_calculate_serve_budget (&configuration, 5000000u, 2000000u) ==
+                    configuration.serve_budget_ns)
+
+    configuration.serve_budget_ns = 2000000u;
+    configuration.serve_budget_max_ns = 8000000u;
+    configuration.target_frame_time_ns = 16000000u;
+
+    // Unknown previous frame time: minimal budget.
+    KAN_TEST_CHECK (kan_resource_provider_calculate_serve_budget (&configuration, 0u, 0u) == 2000000u)
+
+    // Frame is almost empty: budget is clamped to maximum.
+    KAN_TEST_CHECK (kan_resource_provider_calculate_serve_budget (&configuration, 4000000u, 2000000u) == 8000000u)
+
+    // Headroom is between minimum and maximum: 16ms target - (15ms frame - 4ms budget) = 5ms.
+    KAN_TEST_CHECK (kan_resource_provider_calculate_serve_budget (&configuration, 15000000u, 4000000u) == 5000000u)
+
+    // Headroom is smaller than minimum: budget is clamped to minimum.
+    KAN_TEST_CHECK (kan_resource_provider_calculate_serve_budget (&configuration, 17000000u, 2000000u) == 2000000u)
+
+    // Other work alone exceeds the target: minimal budget.
+    KAN_TEST_CHECK (kan_resource_provider_calculate_serve_budget (&configuration, 30000000u, 2000000u) == 2000000u)
+
+    // Maximum smaller than minimum is treated as minimum.
+    configuration.serve_budget_max_ns = 1000000u;
+    KAN_TEST_CHECK (kan_resource_provider_calculate_serve_budget (&configuration, 4000000u, 2000000u) == 2000000u)
+}
+
+#define COST_ORDERING_BIG_RESOURCE_NAME "big_third_party.something"
+#define COST_ORDERING_BIG_RESOURCE_SIZE (8u * 1024u * 1024u)
+#define COST_ORDERING_SERVE_BUDGET_NS 20000000u
+
+static void setup_cost_ordering_test_resources (kan_reflection_registry_t registry)
+{
+    setup_trivial_raw_resources (registry);
+    struct third_party_reference_resource_type_t reference_resource;
+    reference_resource.third_party_name = kan_string_intern (COST_ORDERING_BIG_RESOURCE_NAME);
+    save_rd (RAW_DIRECTORY "/big_referencer.rd", &reference_resource,
+             kan_string_intern ("third_party_reference_resource_type_t"), registry);
+
+    uint8_t *data =
+        kan_allocate_general (KAN_ALLOCATION_GROUP_IGNORE, COST_ORDERING_BIG_RESOURCE_SIZE, alignof (uint8_t));
+    for (kan_loop_size_t index = 0u; index < COST_ORDERING_BIG_RESOURCE_SIZE; ++index)
+    {
+        data[index] = (uint8_t) index;
+    }
+
+    save_third_party (RAW_DIRECTORY "/" COST_ORDERING_BIG_RESOURCE_NAME, data, COST_ORDERING_BIG_RESOURCE_SIZE);
+    kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, data, COST_ORDERING_BIG_RESOURCE_SIZE);
+}
+
+struct cost_ordering_test_singleton_t
+{
+    bool requests_created;
+    bool beta_loaded;
+    kan_resource_third_party_blob_id_t big_blob_id;
+};
+
+TEST_UNIVERSE_RESOURCE_PROVIDER_API void cost_ordering_test_singleton_init (
+    struct cost_ordering_test_singleton_t *instance)
+{
+    instance->requests_created = false;
+    instance->beta_loaded = false;
+    instance->big_blob_id = KAN_TYPED_ID_32_SET_INVALID (kan_resource_third_party_blob_id_t);
+}
+
+struct cost_ordering_test_state_t
+{
+    KAN_UM_GENERATE_STATE_QUERIES (cost_ordering_test_state)
+    KAN_UM_BIND_STATE (cost_ordering_test_state, state)
+};
+
+TEST_UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_DEPLOY (cost_ordering_test)
+{
+    kan_workflow_graph_node_depend_on (workflow_node, KAN_RESOURCE_PROVIDER_END_CHECKPOINT);
+}
+
+TEST_UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_EXECUTE (cost_ordering_test)
+{
+    KAN_UMI_SINGLETON_WRITE (singleton, cost_ordering_test_singleton_t)
+    KAN_UMI_SINGLETON_READ (provider, kan_resource_provider_singleton_t)
+
+    if (!provider->scan_done)
+    {
+        return;
+    }
+
+    if (!singleton->requests_created)
+    {
+        // Big resource has higher priority than beta, but its estimated cost does not fit into the budget that is left
+        // after serving alpha, therefore beta must be served first.
+        KAN_UMO_INDEXED_INSERT (alpha_usage, kan_resource_usage_t)
+        {
+            alpha_usage->usage_id = kan_next_resource_usage_id (provider);
+            alpha_usage->type = KAN_STATIC_INTERNED_ID_GET (first_resource_type_t);
+            alpha_usage->name = KAN_STATIC_INTERNED_ID_GET (alpha);
+            alpha_usage->priority = 3u;
+        }
+
+        KAN_UMO_INDEXED_INSERT (blob, kan_resource_third_party_blob_t)
+        {
+            blob->blob_id = kan_next_resource_third_party_blob_id (provider);
+            singleton->big_blob_id = blob->blob_id;
+            blob->name = kan_string_intern (COST_ORDERING_BIG_RESOURCE_NAME);
+            blob->priority = 2u;
+        }
+
+        KAN_UMO_INDEXED_INSERT (beta_usage, kan_resource_usage_t)
+        {
+            beta_usage->usage_id = kan_next_resource_usage_id (provider);
+            beta_usage->type = KAN_STATIC_INTERNED_ID_GET (first_resource_type_t);
+            beta_usage->name = KAN_STATIC_INTERNED_ID_GET (beta);
+            beta_usage->priority = 1u;
+        }
+
+        singleton->requests_created = true;
+    }
+
+    KAN_UML_RESOURCE_LOADED_EVENT_FETCH (first_loaded, first_resource_type_t)
+    {
+        if (first_loaded->name == KAN_STATIC_INTERNED_ID_GET (beta))
+        {
+            singleton->beta_loaded = true;
+        }
+    }
+
+    KAN_UML_EVENT_FETCH (failed_event, kan_resource_third_party_blob_failed_t) {
+        KAN_TEST_CHECK (!KAN_TYPED_ID_32_IS_EQUAL (failed_event->blob_id, singleton->big_blob_id))}
+
+    KAN_UML_EVENT_FETCH (available_event, kan_resource_third_party_blob_available_t)
+    {
+        KAN_TEST_CHECK (KAN_TYPED_ID_32_IS_EQUAL (available_event->blob_id, singleton->big_blob_id))
+        KAN_TEST_CHECK (singleton->beta_loaded)
+
+        KAN_UMI_VALUE_READ_REQUIRED (blob, kan_resource_third_party_blob_t, blob_id, &singleton->big_blob_id)
+        KAN_TEST_CHECK (blob->available)
+        KAN_TEST_CHECK (blob->available_size == COST_ORDERING_BIG_RESOURCE_SIZE)
+        KAN_TEST_CHECK (((const uint8_t *) blob->available_data)[COST_ORDERING_BIG_RESOURCE_SIZE - 1u] ==
+                        (uint8_t) (COST_ORDERING_BIG_RESOURCE_SIZE - 1u))
+        global_test_finished = true;
+    }
+}
+
+KAN_TEST_CASE (serve_cost_ordering)
+{
+    kan_static_interned_ids_ensure_initialized ();
+    kan_file_system_remove_directory_with_content (WORKSPACE_DIRECTORY);
+    kan_file_system_remove_directory_with_content (RAW_DIRECTORY);
+    kan_file_system_make_directory (WORKSPACE_DIRECTORY);
+
+    kan_context_t context = setup_context (SETUP_CONTEXT_MOUNT_DEPLOY);
+    CUSHION_DEFER { kan_context_destroy (context); }
+
+    kan_context_system_t reflection_system = kan_context_query (context, KAN_CONTEXT_REFLECTION_SYSTEM_NAME);
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (reflection_system))
+
+    kan_reflection_registry_t registry = kan_reflection_system_get_registry (reflection_system);
+    initialize_platform_configuration (registry);
+    setup_cost_ordering_test_resources (registry);
+    execute_resource_build (registry, KAN_RESOURCE_BUILD_PACK_MODE_NONE);
+
+    struct kan_resource_provider_configuration_t configuration;
+    kan_resource_provider_configuration_init (&configuration);
+    configuration.serve_budget_ns = COST_ORDERING_SERVE_BUDGET_NS;
+    configuration.serve_budget_max_ns = COST_ORDERING_SERVE_BUDGET_NS;
+    configuration.resource_directory_path = kan_string_intern (RESOURCE_MOUNT_PATH);
+    run_test_loop_with_configuration (context, KAN_STATIC_INTERNED_ID_GET (cost_ordering_test), &configuration);
+}
+
+// Much more resources than background loads cap are requested at once, so most of them must wait for free slot.
+#define BACKGROUND_CAP_RESOURCES (KAN_UNIVERSE_RESOURCE_PROVIDER_BACKGROUND_LOADS_MAX * 4u + 1u)
+
+static kan_interned_string_t background_cap_names[BACKGROUND_CAP_RESOURCES];
+static bool background_cap_loaded[BACKGROUND_CAP_RESOURCES];
+
+static void setup_background_cap_test_resources (kan_reflection_registry_t registry)
+{
+    kan_file_system_make_directory (RAW_DIRECTORY);
+    kan_file_system_make_directory (RAW_DIRECTORY "/background_cap");
+
+    for (kan_loop_size_t index = 0u; index < BACKGROUND_CAP_RESOURCES; ++index)
+    {
+        char name[32u];
+        snprintf (name, sizeof (name), "background_cap_%u", (unsigned int) index);
+        background_cap_names[index] = kan_string_intern (name);
+        background_cap_loaded[index] = false;
+
+        char path[128u];
+        snprintf (path, sizeof (path), RAW_DIRECTORY "/background_cap/%s.rd", name);
+
+        struct first_resource_type_t resource = {
+            .some_integer = index,
+            .flag_1 = index % 2u == 0u,
+            .flag_2 = index % 3u == 0u,
+            .flag_3 = false,
+            .flag_4 = true,
+        };
+
+        save_rd (path, &resource, kan_string_intern ("first_resource_type_t"), registry);
+    }
+}
+
+struct background_cap_test_singleton_t
+{
+    bool usages_created;
+    kan_instance_size_t loaded_count;
+};
+
+TEST_UNIVERSE_RESOURCE_PROVIDER_API void background_cap_test_singleton_init (
+    struct background_cap_test_singleton_t *instance)
+{
+    instance->usages_created = false;
+    instance->loaded_count = 0u;
+}
+
+struct background_cap_test_state_t
+{
+    KAN_UM_GENERATE_STATE_QUERIES (background_cap_test_state)
+    KAN_UM_BIND_STATE (background_cap_test_state, state)
+};
+
+TEST_UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_DEPLOY (background_cap_test)
+{
+    kan_workflow_graph_node_depend_on (workflow_node, KAN_RESOURCE_PROVIDER_END_CHECKPOINT);
+}
+
+TEST_UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_EXECUTE (background_cap_test)
+{
+    KAN_UMI_SINGLETON_WRITE (singleton, background_cap_test_singleton_t)
+    KAN_UMI_SINGLETON_READ (provider, kan_resource_provider_singleton_t)
+
+    if (!provider->scan_done)
+    {
+        return;
+    }
+
+    if (!singleton->usages_created)
+    {
+        for (kan_loop_size_t index = 0u; index < BACKGROUND_CAP_RESOURCES; ++index)
+        {
+            KAN_UMO_INDEXED_INSERT (usage, kan_resource_usage_t)
+            {
+                usage->usage_id = kan_next_resource_usage_id (provider);
+                usage->type = KAN_STATIC_INTERNED_ID_GET (first_resource_type_t);
+                usage->name = background_cap_names[index];
+                usage->priority = 0u;
+            }
+        }
+
+        singleton->usages_created = true;
+    }
+
+    KAN_UML_RESOURCE_LOADED_EVENT_FETCH (first_loaded, first_resource_type_t)
+    {
+        KAN_UMI_RESOURCE_RETRIEVE_IF_LOADED (loaded, first_resource_type_t, &first_loaded->name)
+        KAN_TEST_ASSERT (loaded)
+
+        kan_loop_size_t index = 0u;
+        while (index < BACKGROUND_CAP_RESOURCES && background_cap_names[index] != first_loaded->name)
+        {
+            ++index;
+        }
+
+        KAN_TEST_ASSERT (index < BACKGROUND_CAP_RESOURCES)
+        KAN_TEST_CHECK (!background_cap_loaded[index])
+        KAN_TEST_CHECK (loaded->some_integer == index)
+        KAN_TEST_CHECK (loaded->flag_1 == (index % 2u == 0u))
+        KAN_TEST_CHECK (loaded->flag_2 == (index % 3u == 0u))
+        KAN_TEST_CHECK (!loaded->flag_3)
+        KAN_TEST_CHECK (loaded->flag_4)
+
+        background_cap_loaded[index] = true;
+        ++singleton->loaded_count;
+    }
+
+    if (singleton->loaded_count == BACKGROUND_CAP_RESOURCES)
+    {
+        global_test_finished = true;
+    }
+}
+
+KAN_TEST_CASE (background_loads_cap)
+{
+    kan_static_interned_ids_ensure_initialized ();
+    kan_file_system_remove_directory_with_content (WORKSPACE_DIRECTORY);
+    kan_file_system_remove_directory_with_content (RAW_DIRECTORY);
+    kan_file_system_make_directory (WORKSPACE_DIRECTORY);
+
+    kan_context_t context = setup_context (SETUP_CONTEXT_MOUNT_DEPLOY);
+    CUSHION_DEFER { kan_context_destroy (context); }
+
+    kan_context_system_t reflection_system = kan_context_query (context, KAN_CONTEXT_REFLECTION_SYSTEM_NAME);
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (reflection_system))
+
+    kan_reflection_registry_t registry = kan_reflection_system_get_registry (reflection_system);
+    initialize_platform_configuration (registry);
+    setup_background_cap_test_resources (registry);
+    execute_resource_build (registry, KAN_RESOURCE_BUILD_PACK_MODE_NONE);
+    run_test_loop (context, KAN_STATIC_INTERNED_ID_GET (background_cap_test), true);
 }
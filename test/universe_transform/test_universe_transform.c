@@ -379,3 +379,293 @@ static void test_global (kan_interned_string_t test_mutator)
 KAN_TEST_CASE (global_2) { test_global (kan_string_intern ("test_global_2")); }
 
 KAN_TEST_CASE (global_3) { test_global (kan_string_intern ("test_global_3")); }
+
+#define TEST_BATCHED_CHILDREN 1000u
+
+static bool global_test_finished = false;
+
+static inline struct kan_transform_2_t make_batched_transform_2 (float x, float y)
+{
+    return (struct kan_transform_2_t) {
+        .location = {x, y},
+        .rotation = 0.0f,
+        .scale = {1.0f, 1.0f},
+    };
+}
+
+static inline struct kan_transform_3_t make_batched_transform_3 (float x, float y)
+{
+    return (struct kan_transform_3_t) {
+        .location = {x, y, 0.0f},
+        .rotation = kan_make_float_vector_4_t (0.0f, 0.0f, 0.0f, 1.0f),
+        .scale = {1.0f, 1.0f, 1.0f},
+    };
+}
+
+/// \brief Makes transform with rotation and non-uniform scale, so global transforms of grandchildren have shear.
+static inline struct kan_transform_2_t make_batched_skewed_transform_2 (float x, float y, float angle)
+{
+    return (struct kan_transform_2_t) {
+        .location = {x, y},
+        .rotation = angle,
+        .scale = {1.5f, 0.5f},
+    };
+}
+
+/// \brief Makes transform with rotation and non-uniform scale, so global transforms of grandchildren have shear.
+static inline struct kan_transform_3_t make_batched_skewed_transform_3 (float x, float y, float angle)
+{
+    return (struct kan_transform_3_t) {
+        .location = {x, y, 0.5f},
+        .rotation = kan_make_quaternion_from_euler (0.2f, angle, 0.1f),
+        .scale = {1.5f, 0.5f, 0.75f},
+    };
+}
+
+struct test_batched_2_state_t
+{
+    KAN_UM_GENERATE_STATE_QUERIES (test_batched_2)
+    KAN_UM_BIND_STATE (test_batched_2, state)
+
+    struct test_utility_queries_2_t utility;
+    kan_instance_size_t stage;
+    kan_universe_object_id_t root_object_id;
+    kan_universe_object_id_t copy_root_object_id;
+
+    KAN_REFLECTION_IGNORE
+    kan_universe_object_id_t children_object_ids[TEST_BATCHED_CHILDREN];
+
+    KAN_REFLECTION_IGNORE
+    kan_universe_object_id_t grandchildren_object_ids[TEST_BATCHED_CHILDREN];
+
+    KAN_REFLECTION_IGNORE
+    kan_universe_object_id_t copy_children_object_ids[TEST_BATCHED_CHILDREN];
+
+    KAN_REFLECTION_IGNORE
+    kan_universe_object_id_t copy_grandchildren_object_ids[TEST_BATCHED_CHILDREN];
+};
+
+struct test_batched_3_state_t
+{
+    KAN_UM_GENERATE_STATE_QUERIES (test_batched_3)
+    KAN_UM_BIND_STATE (test_batched_3, state)
+
+    struct test_utility_queries_3_t utility;
+    kan_instance_size_t stage;
+    kan_universe_object_id_t root_object_id;
+    kan_universe_object_id_t copy_root_object_id;
+
+    KAN_REFLECTION_IGNORE
+    kan_universe_object_id_t children_object_ids[TEST_BATCHED_CHILDREN];
+
+    KAN_REFLECTION_IGNORE
+    kan_universe_object_id_t grandchildren_object_ids[TEST_BATCHED_CHILDREN];
+
+    KAN_REFLECTION_IGNORE
+    kan_universe_object_id_t copy_children_object_ids[TEST_BATCHED_CHILDREN];
+
+    KAN_REFLECTION_IGNORE
+    kan_universe_object_id_t copy_grandchildren_object_ids[TEST_BATCHED_CHILDREN];
+};
+
+// Hierarchy is root -> children -> grandchildren, where every child has local location (index, 0) and its only
+// grandchild has local location (index, 1). Checks read global transform directly from components in order to make
+// sure that it was calculated by the batched update and not by the lazy getter. Copy of the hierarchy is created
+// under separate root: after rotation and non-uniform scale are applied, copy globals are calculated by the lazy
+// getter before the update, so batched results must be exactly the same as lazy getter results.
+#define TEST_BATCHED(DIMENSIONS)                                                                                       \
+    TEST_UNIVERSE_TRANSFORM_API void test_batched_##DIMENSIONS##_state_init (                                          \
+        struct test_batched_##DIMENSIONS##_state_t *instance)                                                          \
+    {                                                                                                                  \
+        instance->stage = 0u;                                                                                          \
+        instance->root_object_id = KAN_TYPED_ID_32_SET_INVALID (kan_universe_object_id_t);                             \
+        instance->copy_root_object_id = KAN_TYPED_ID_32_SET_INVALID (kan_universe_object_id_t);                        \
+    }                                                                                                                  \
+                                                                                                                       \
+    TEST_UNIVERSE_TRANSFORM_API KAN_UM_MUTATOR_DEPLOY (test_batched_##DIMENSIONS)                                      \
+    {                                                                                                                  \
+        kan_workflow_graph_node_depend_on (workflow_node, KAN_TRANSFORM_UPDATE_END_CHECKPOINT);                        \
+    }                                                                                                                  \
+                                                                                                                       \
+    static void check_batched_##DIMENSIONS (struct test_batched_##DIMENSIONS##_state_t *state, float root_x,           \
+                                            float root_y)                                                              \
+    {                                                                                                                  \
+        KAN_UM_BIND_STATE (test_batched_##DIMENSIONS, state)                                                           \
+        kan_instance_size_t checked = 0u;                                                                              \
+        KAN_UML_SEQUENCE_READ (component, kan_transform_##DIMENSIONS##_component_t)                                    \
+        {                                                                                                              \
+            if (!KAN_TYPED_ID_32_IS_VALID (component->parent_object_id))                                               \
+            {                                                                                                          \
+                continue;                                                                                              \
+            }                                                                                                          \
+                                                                                                                       \
+            KAN_TEST_CHECK (!component->global_dirty)                                                                  \
+            const float index = component->local.location.x;                                                           \
+            const bool grandchild = component->local.location.y > 0.5f;                                                \
+                                                                                                                       \
+            KAN_TEST_CHECK (check_transform_equality_##DIMENSIONS (                                                    \
+                component->global, grandchild ?                                                                        \
+                                       make_batched_transform_##DIMENSIONS (root_x + index * 2.0f, root_y + 1.0f) :    \
+                                       make_batched_transform_##DIMENSIONS (root_x + index, root_y)))                  \
+            ++checked;                                                                                                 \
+        }                                                                                                              \
+                                                                                                                       \
+        /* Both the hierarchy and its copy. */                                                                         \
+        KAN_TEST_CHECK (checked == TEST_BATCHED_CHILDREN * 4u)                                                         \
+    }                                                                                                                  \
+                                                                                                                       \
+    static void check_batched_node_##DIMENSIONS (struct test_batched_##DIMENSIONS##_state_t *state,                    \
+                                                 kan_universe_object_id_t object_id,                                   \
+                                                 kan_universe_object_id_t copy_object_id)                              \
+    {                                                                                                                  \
+        KAN_UM_BIND_STATE (test_batched_##DIMENSIONS, state)                                                           \
+        KAN_UMI_VALUE_READ_REQUIRED (component, kan_transform_##DIMENSIONS##_component_t, object_id, &object_id)       \
+        KAN_TEST_CHECK (!component->global_dirty)                                                                      \
+        KAN_TEST_CHECK (check_transform_global_##DIMENSIONS (&state->utility, copy_object_id, component->global))      \
+    }                                                                                                                  \
+                                                                                                                       \
+    static void calculate_lazy_global_##DIMENSIONS (struct test_batched_##DIMENSIONS##_state_t *state,                 \
+                                                    kan_universe_object_id_t object_id)                                \
+    {                                                                                                                  \
+        KAN_UM_BIND_STATE (test_batched_##DIMENSIONS, state)                                                           \
+        KAN_UMI_VALUE_READ_REQUIRED (component, kan_transform_##DIMENSIONS##_component_t, object_id, &object_id)       \
+        kan_transform_##DIMENSIONS##_component_get_global (&state->utility.inner_queries, component);                  \
+    }                                                                                                                  \
+                                                                                                                       \
+    static void create_batched_hierarchy_##DIMENSIONS (struct test_batched_##DIMENSIONS##_state_t *state,              \
+                                                       kan_universe_object_id_t *root_object_id,                       \
+                                                       kan_universe_object_id_t *children_object_ids,                  \
+                                                       kan_universe_object_id_t *grandchildren_object_ids)             \
+    {                                                                                                                  \
+        *root_object_id = create_transform_##DIMENSIONS (&state->utility,                                              \
+                                                         KAN_TYPED_ID_32_SET_INVALID (kan_universe_object_id_t),       \
+                                                         make_batched_transform_##DIMENSIONS (1.0f, 2.0f));            \
+                                                                                                                       \
+        for (kan_loop_size_t index = 0u; index < TEST_BATCHED_CHILDREN; ++index)                                       \
+        {                                                                                                              \
+            children_object_ids[index] = create_transform_##DIMENSIONS (                                               \
+                &state->utility, *root_object_id, make_batched_transform_##DIMENSIONS ((float) index, 0.0f));          \
+            grandchildren_object_ids[index] =                                                                          \
+                create_transform_##DIMENSIONS (&state->utility, children_object_ids[index],                            \
+                                               make_batched_transform_##DIMENSIONS ((float) index, 1.0f));             \
+        }                                                                                                              \
+    }                                                                                                                  \
+                                                                                                                       \
+    static void skew_batched_hierarchy_##DIMENSIONS (struct test_batched_##DIMENSIONS##_state_t *state,                \
+                                                     kan_universe_object_id_t root_object_id,                          \
+                                                     kan_universe_object_id_t *children_object_ids,                    \
+                                                     kan_universe_object_id_t *grandchildren_object_ids)               \
+    {                                                                                                                  \
+        set_transform_local_##DIMENSIONS (&state->utility, root_object_id,                                             \
+                                          make_batched_skewed_transform_##DIMENSIONS (5.0f, -3.0f, 0.4f));             \
+                                                                                                                       \
+        for (kan_loop_size_t index = 0u; index < TEST_BATCHED_CHILDREN; ++index)                                       \
+        {                                                                                                              \
+            const float angle = 0.3f + 0.01f * (float) index;                                                          \
+            set_transform_local_##DIMENSIONS (                                                                         \
+                &state->utility, children_object_ids[index],                                                           \
+                make_batched_skewed_transform_##DIMENSIONS (0.5f * (float) index, 0.0f, angle));                       \
+            set_transform_local_##DIMENSIONS (&state->utility, grandchildren_object_ids[index],                        \
+                                              make_batched_skewed_transform_##DIMENSIONS (1.0f, 1.0f, -angle));        \
+        }                                                                                                              \
+    }                                                                                                                  \
+                                                                                                                       \
+    TEST_UNIVERSE_TRANSFORM_API KAN_UM_MUTATOR_EXECUTE (test_batched_##DIMENSIONS)                                     \
+    {                                                                                                                  \
+        switch (state->stage)                                                                                          \
+        {                                                                                                              \
+        case 0u:                                                                                                       \
+            create_batched_hierarchy_##DIMENSIONS (state, &state->root_object_id, state->children_object_ids,          \
+                                                   state->grandchildren_object_ids);                                   \
+            create_batched_hierarchy_##DIMENSIONS (state, &state->copy_root_object_id,                                 \
+                                                   state->copy_children_object_ids,                                    \
+                                                   state->copy_grandchildren_object_ids);                              \
+            break;                                                                                                     \
+                                                                                                                       \
+        case 1u:                                                                                                       \
+            check_batched_##DIMENSIONS (state, 1.0f, 2.0f);                                                            \
+            set_transform_local_##DIMENSIONS (&state->utility, state->root_object_id,                                  \
+                                              make_batched_transform_##DIMENSIONS (5.0f, -3.0f));                      \
+            set_transform_local_##DIMENSIONS (&state->utility, state->copy_root_object_id,                             \
+                                              make_batched_transform_##DIMENSIONS (5.0f, -3.0f));                      \
+            break;                                                                                                     \
+                                                                                                                       \
+        case 2u:                                                                                                       \
+            check_batched_##DIMENSIONS (state, 5.0f, -3.0f);                                                           \
+            skew_batched_hierarchy_##DIMENSIONS (state, state->root_object_id, state->children_object_ids,             \
+                                                 state->grandchildren_object_ids);                                     \
+            skew_batched_hierarchy_##DIMENSIONS (state, state->copy_root_object_id, state->copy_children_object_ids,   \
+                                                 state->copy_grandchildren_object_ids);                                \
+                                                                                                                       \
+            /* Calculate copy globals right away, so they are not dirty and are skipped by the batched update. */      \
+            for (kan_loop_size_t index = 0u; index < TEST_BATCHED_CHILDREN; ++index)                                   \
+            {                                                                                                          \
+                calculate_lazy_global_##DIMENSIONS (state, state->copy_grandchildren_object_ids[index]);               \
+            }                                                                                                          \
+                                                                                                                       \
+            break;                                                                                                     \
+                                                                                                                       \
+        case 3u:                                                                                                       \
+            for (kan_loop_size_t index = 0u; index < TEST_BATCHED_CHILDREN; ++index)                                   \
+            {                                                                                                          \
+                check_batched_node_##DIMENSIONS (state, state->children_object_ids[index],                             \
+                                                 state->copy_children_object_ids[index]);                              \
+                check_batched_node_##DIMENSIONS (state, state->grandchildren_object_ids[index],                        \
+                                                 state->copy_grandchildren_object_ids[index]);                         \
+            }                                                                                                          \
+                                                                                                                       \
+            global_test_finished = true;                                                                               \
+            break;                                                                                                     \
+        }                                                                                                              \
+                                                                                                                       \
+        ++state->stage;                                                                                                \
+    }
+
+TEST_BATCHED (2)
+TEST_BATCHED (3)
+#undef TEST_BATCHED
+
+static void test_batched (kan_interned_string_t test_mutator)
+{
+    kan_context_t context = create_context ();
+    kan_context_system_t universe_system_handle = kan_context_query (context, KAN_CONTEXT_UNIVERSE_SYSTEM_NAME);
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (universe_system_handle))
+
+    kan_universe_t universe = kan_universe_system_get_universe (universe_system_handle);
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (universe))
+
+    struct kan_universe_world_definition_t definition;
+    kan_universe_world_definition_init (&definition);
+    definition.world_name = kan_string_intern ("root_world");
+    definition.scheduler_name = kan_string_intern (KAN_UNIVERSE_TRIVIAL_SCHEDULER_NAME);
+
+    kan_dynamic_array_set_capacity (&definition.pipelines, 1u);
+    struct kan_universe_world_pipeline_definition_t *update_pipeline =
+        kan_dynamic_array_add_last (&definition.pipelines);
+
+    kan_universe_world_pipeline_definition_init (update_pipeline);
+    update_pipeline->name = kan_string_intern (KAN_UNIVERSE_TRIVIAL_SCHEDULER_PIPELINE_NAME);
+
+    kan_dynamic_array_set_capacity (&update_pipeline->mutators, 1u);
+    *(kan_interned_string_t *) kan_dynamic_array_add_last (&update_pipeline->mutators) = test_mutator;
+
+    kan_dynamic_array_set_capacity (&update_pipeline->mutator_groups, 1u);
+    *(kan_interned_string_t *) kan_dynamic_array_add_last (&update_pipeline->mutator_groups) =
+        kan_string_intern (KAN_TRANSFORM_UPDATE_MUTATOR_GROUP);
+
+    kan_universe_deploy_root (universe, &definition);
+    kan_universe_world_definition_shutdown (&definition);
+
+    kan_context_system_t update_system = kan_context_query (context, KAN_CONTEXT_UPDATE_SYSTEM_NAME);
+    KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (update_system))
+
+    global_test_finished = false;
+    while (!global_test_finished)
+    {
+        kan_update_system_run (update_system);
+    }
+}
+
+KAN_TEST_CASE (batched_2) { test_batched (kan_string_intern ("test_batched_2")); }
+
+KAN_TEST_CASE (batched_3) { test_batched (kan_string_intern ("test_batched_3")); }
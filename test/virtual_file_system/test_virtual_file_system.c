@@ -1,9 +1,11 @@
+#include <stdio.h>
 #include <string.h>
 
 #include <kan/memory/allocation.h>
 #include <kan/precise_time/precise_time.h>
 #include <kan/stream/stream.h>
 #include <kan/testing/testing.h>
+#include <kan/threading/atomic.h>
 #include <kan/virtual_file_system/virtual_file_system.h>
 
 static bool write_text_file (kan_virtual_file_system_volume_t volume, const char *file, const char *content)
@@ -230,6 +232,116 @@ KAN_TEST_CASE (plain_read_only_pack)
     kan_virtual_file_system_volume_destroy (volume);
 }
 
+struct async_read_test_request_t
+{
+    const char *path;
+    kan_file_size_t offset;
+    kan_file_size_t size;
+    const char *expected_content;
+
+    char buffer[64u];
+    kan_file_system_async_read_t read;
+    struct kan_atomic_int_t callback_counter;
+};
+
+static void async_read_test_callback (kan_file_system_async_read_t read, kan_functor_user_data_t user_data)
+{
+    struct async_read_test_request_t *request = (struct async_read_test_request_t *) user_data;
+    // Status must already be final when callback is executed.
+    KAN_TEST_CHECK (kan_file_system_async_read_poll (read) != KAN_FILE_SYSTEM_ASYNC_READ_STATUS_PENDING)
+    kan_atomic_int_add (&request->callback_counter, 1);
+}
+
+KAN_TEST_CASE (read_async)
+{
+    kan_virtual_file_system_volume_t volume = kan_virtual_file_system_volume_create ();
+    KAN_TEST_CHECK (kan_virtual_file_system_volume_mount_real (volume, "workspace", "."))
+    KAN_TEST_CHECK (write_text_file (volume, "workspace/first.txt", "First file content."))
+    KAN_TEST_CHECK (write_text_file (volume, "workspace/second.txt", "Second file has a bit longer content."))
+
+    kan_virtual_file_system_read_only_pack_builder_t builder = kan_virtual_file_system_read_only_pack_builder_create ();
+    struct kan_stream_t *pack_stream = kan_virtual_file_stream_open_for_write (volume, "workspace/async.pack");
+    KAN_TEST_ASSERT (kan_virtual_file_system_read_only_pack_builder_begin (builder, pack_stream))
+
+    struct kan_stream_t *file_stream = kan_virtual_file_stream_open_for_read (volume, "workspace/first.txt");
+    kan_virtual_file_system_read_only_pack_builder_add (builder, file_stream, "first.txt");
+    file_stream->operations->close (file_stream);
+
+    file_stream = kan_virtual_file_stream_open_for_read (volume, "workspace/second.txt");
+    kan_virtual_file_system_read_only_pack_builder_add (builder, file_stream, "second.txt");
+    file_stream->operations->close (file_stream);
+
+    KAN_TEST_ASSERT (kan_virtual_file_system_read_only_pack_builder_finalize (builder))
+    pack_stream->operations->close (pack_stream);
+    kan_virtual_file_system_read_only_pack_builder_destroy (builder);
+    KAN_TEST_CHECK (kan_virtual_file_system_volume_mount_read_only_pack (volume, "packed", "async.pack"))
+
+    struct async_read_test_request_t requests[] = {
+        {.path = "workspace/first.txt", .offset = 0u, .size = 19u, .expected_content = "First file content."},
+        {.path = "workspace/first.txt", .offset = 6u, .size = 4u, .expected_content = "file"},
+        {.path = "workspace/second.txt", .offset = 18u, .size = 64u, .expected_content = "bit longer content."},
+        {.path = "packed/first.txt", .offset = 0u, .size = 5u, .expected_content = "First"},
+        // Range must be clamped to the pack entry, otherwise data of the next entry would be read too.
+        {.path = "packed/first.txt", .offset = 11u, .size = 64u, .expected_content = "content."},
+        {.path = "packed/second.txt", .offset = 0u, .size = 6u, .expected_content = "Second"},
+        {.path = "packed/second.txt", .offset = 30u, .size = 64u, .expected_content = "ontent."},
+    };
+
+    const kan_loop_size_t requests_count = sizeof (requests) / sizeof (requests[0u]);
+    for (kan_loop_size_t index = 0u; index < requests_count; ++index)
+    {
+        struct async_read_test_request_t *request = &requests[index];
+        request->callback_counter = kan_atomic_int_init (0);
+
+        request->read = kan_virtual_file_system_read_async (
+            volume, &(struct kan_file_system_async_read_request_t) {
+                        .path = request->path,
+                        .offset = request->offset,
+                        .size = request->size,
+                        .buffer = request->buffer,
+                        .completion_callback = async_read_test_callback,
+                        .completion_user_data = (kan_functor_user_data_t) request,
+                    });
+
+        KAN_TEST_ASSERT (KAN_HANDLE_IS_VALID (request->read))
+    }
+
+    for (kan_loop_size_t index = 0u; index < requests_count; ++index)
+    {
+        struct async_read_test_request_t *request = &requests[index];
+        const kan_file_size_t expected_size = (kan_file_size_t) strlen (request->expected_content);
+
+        KAN_TEST_CHECK (kan_file_system_async_read_wait (request->read) ==
+                        KAN_FILE_SYSTEM_ASYNC_READ_STATUS_SUCCESSFUL)
+        KAN_TEST_CHECK (kan_file_system_async_read_get_read_size (request->read) == expected_size)
+        KAN_TEST_CHECK (memcmp (request->buffer, request->expected_content, expected_size) == 0)
+
+        // Status is updated right before callback, so wait for the callback in order to avoid false negatives.
+        while (kan_atomic_int_get (&request->callback_counter) == 0)
+        {
+            kan_precise_time_sleep (1000000u);
+        }
+
+        KAN_TEST_CHECK (kan_atomic_int_get (&request->callback_counter) == 1)
+        kan_file_system_async_read_destroy (request->read);
+    }
+
+    KAN_TEST_CHECK (!KAN_HANDLE_IS_VALID (kan_virtual_file_system_read_async (
+        volume, &(struct kan_file_system_async_read_request_t) {
+                    .path = "packed/missing.txt",
+                    .offset = 0u,
+                    .size = 1u,
+                    .buffer = requests[0u].buffer,
+                    .completion_callback = NULL,
+                    .completion_user_data = 0u,
+                })))
+
+    KAN_TEST_CHECK (kan_virtual_file_system_remove_file (volume, "workspace/first.txt"))
+    KAN_TEST_CHECK (kan_virtual_file_system_remove_file (volume, "workspace/second.txt"))
+    KAN_TEST_CHECK (kan_virtual_file_system_remove_file (volume, "workspace/async.pack"))
+    kan_virtual_file_system_volume_destroy (volume);
+}
+
 KAN_TEST_CASE (hierarchical_read_only_pack)
 {
     kan_virtual_file_system_volume_t volume = kan_virtual_file_system_volume_create ();
@@ -270,6 +382,168 @@ KAN_TEST_CASE (hierarchical_read_only_pack)
     kan_virtual_file_system_volume_destroy (volume);
 }
 
+KAN_TEST_CASE (large_read_only_pack)
+{
+    kan_virtual_file_system_volume_t volume = kan_virtual_file_system_volume_create ();
+    KAN_TEST_CHECK (kan_virtual_file_system_volume_mount_real (volume, "workspace", "."))
+
+    kan_virtual_file_system_read_only_pack_builder_t builder = kan_virtual_file_system_read_only_pack_builder_create ();
+    struct kan_stream_t *pack_stream = kan_virtual_file_stream_open_for_write (volume, "workspace/data.pack");
+    KAN_TEST_ASSERT (kan_virtual_file_system_read_only_pack_builder_begin (builder, pack_stream))
+
+#define DIRECTORIES_COUNT 8u
+#define FILES_PER_DIRECTORY 64u
+    char path_buffer[64u];
+    char content_buffer[64u];
+
+    for (kan_loop_size_t directory_index = 0u; directory_index < DIRECTORIES_COUNT; ++directory_index)
+    {
+        for (kan_loop_size_t file_index = 0u; file_index < FILES_PER_DIRECTORY; ++file_index)
+        {
+            // Use redundant separators for some paths to check that they are normalized.
+            snprintf (path_buffer, sizeof (path_buffer),
+                      file_index % 2u ? "dir_%u/sub//file_%u.bin" : "/dir_%u/sub/file_%u.bin",
+                      (unsigned int) directory_index, (unsigned int) file_index);
+            snprintf (content_buffer, sizeof (content_buffer), "Content %u %u", (unsigned int) directory_index,
+                      (unsigned int) file_index);
+
+            struct kan_stream_t *file_stream =
+                kan_virtual_file_system_read_only_pack_builder_add_streamed (builder, path_buffer);
+            KAN_TEST_ASSERT (file_stream)
+
+            const kan_file_size_t length = (kan_file_size_t) strlen (content_buffer);
+            KAN_TEST_CHECK (file_stream->operations->write (file_stream, length, content_buffer) == length)
+            file_stream->operations->close (file_stream);
+        }
+    }
+
+    KAN_TEST_ASSERT (kan_virtual_file_system_read_only_pack_builder_finalize (builder))
+    pack_stream->operations->close (pack_stream);
+    kan_virtual_file_system_read_only_pack_builder_destroy (builder);
+    KAN_TEST_CHECK (kan_virtual_file_system_volume_mount_read_only_pack (volume, "packed", "data.pack"))
+
+    for (kan_loop_size_t directory_index = 0u; directory_index < DIRECTORIES_COUNT; ++directory_index)
+    {
+        struct kan_virtual_file_system_entry_status_t status;
+        snprintf (path_buffer, sizeof (path_buffer), "packed/dir_%u//sub/", (unsigned int) directory_index);
+        KAN_TEST_CHECK (kan_virtual_file_system_query_entry (volume, path_buffer, &status))
+        KAN_TEST_CHECK (status.type == KAN_VIRTUAL_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY)
+
+        struct kan_virtual_file_system_directory_iterator_t iterator =
+            kan_virtual_file_system_directory_iterator_create (volume, path_buffer);
+        kan_loop_size_t found_files = 0u;
+
+        while (kan_virtual_file_system_directory_iterator_advance (&iterator))
+        {
+            ++found_files;
+        }
+
+        kan_virtual_file_system_directory_iterator_destroy (&iterator);
+        KAN_TEST_CHECK (found_files == FILES_PER_DIRECTORY)
+
+        for (kan_loop_size_t file_index = 0u; file_index < FILES_PER_DIRECTORY; ++file_index)
+        {
+            snprintf (path_buffer, sizeof (path_buffer), "packed/dir_%u/sub/file_%u.bin",
+                      (unsigned int) directory_index, (unsigned int) file_index);
+            snprintf (content_buffer, sizeof (content_buffer), "Content %u %u", (unsigned int) directory_index,
+                      (unsigned int) file_index);
+
+            KAN_TEST_CHECK (kan_virtual_file_system_query_entry (volume, path_buffer, &status))
+            KAN_TEST_CHECK (status.type == KAN_VIRTUAL_FILE_SYSTEM_ENTRY_TYPE_FILE)
+            KAN_TEST_CHECK (status.size == strlen (content_buffer))
+            KAN_TEST_CHECK (read_text_file (volume, path_buffer, content_buffer))
+        }
+    }
+
+#undef DIRECTORIES_COUNT
+#undef FILES_PER_DIRECTORY
+
+    KAN_TEST_CHECK (!kan_virtual_file_system_check_existence (volume, "packed/dir_0/file_0.bin"))
+    KAN_TEST_CHECK (!kan_virtual_file_system_check_existence (volume, "packed/dir_0/sub/file_1000.bin"))
+    KAN_TEST_CHECK (kan_virtual_file_system_volume_unmount (volume, "packed"))
+    KAN_TEST_CHECK (kan_virtual_file_system_remove_file (volume, "workspace/data.pack"))
+    kan_virtual_file_system_volume_destroy (volume);
+}
+
+static bool mount_corrupted_read_only_pack (kan_virtual_file_system_volume_t volume,
+                                            const uint8_t *pack_data,
+                                            kan_file_size_t pack_size,
+                                            kan_file_size_t corruption_offset)
+{
+    struct kan_stream_t *stream = kan_virtual_file_stream_open_for_write (volume, "workspace/broken.pack");
+    KAN_TEST_ASSERT (stream)
+    KAN_TEST_ASSERT (stream->operations->write (stream, corruption_offset, pack_data) == corruption_offset)
+
+    const uint32_t corrupted_value = KAN_INT_MAX (uint32_t);
+    KAN_TEST_ASSERT (stream->operations->write (stream, sizeof (uint32_t), &corrupted_value) == sizeof (uint32_t))
+
+    const kan_file_size_t rest_offset = corruption_offset + sizeof (uint32_t);
+    KAN_TEST_ASSERT (stream->operations->write (stream, pack_size - rest_offset, pack_data + rest_offset) ==
+                     pack_size - rest_offset)
+    stream->operations->close (stream);
+
+    const bool mounted = kan_virtual_file_system_volume_mount_read_only_pack (volume, "broken", "broken.pack");
+    if (mounted)
+    {
+        kan_virtual_file_system_volume_unmount (volume, "broken");
+    }
+
+    KAN_TEST_CHECK (kan_virtual_file_system_remove_file (volume, "workspace/broken.pack"))
+    return mounted;
+}
+
+KAN_TEST_CASE (malformed_read_only_pack)
+{
+    kan_virtual_file_system_volume_t volume = kan_virtual_file_system_volume_create ();
+    KAN_TEST_CHECK (kan_virtual_file_system_volume_mount_real (volume, "workspace", "."))
+    KAN_TEST_CHECK (write_text_file (volume, "workspace/log.txt", "Some text data"))
+
+    kan_virtual_file_system_read_only_pack_builder_t builder = kan_virtual_file_system_read_only_pack_builder_create ();
+    struct kan_stream_t *pack_stream = kan_virtual_file_stream_open_for_write (volume, "workspace/data.pack");
+    KAN_TEST_ASSERT (kan_virtual_file_system_read_only_pack_builder_begin (builder, pack_stream))
+
+    struct kan_stream_t *file_stream = kan_virtual_file_stream_open_for_read (volume, "workspace/log.txt");
+    kan_virtual_file_system_read_only_pack_builder_add (builder, file_stream, "sub/log.txt");
+    file_stream->operations->close (file_stream);
+
+    KAN_TEST_ASSERT (kan_virtual_file_system_read_only_pack_builder_finalize (builder))
+    pack_stream->operations->close (pack_stream);
+    kan_virtual_file_system_read_only_pack_builder_destroy (builder);
+
+    pack_stream = kan_virtual_file_stream_open_for_read (volume, "workspace/data.pack");
+    KAN_TEST_ASSERT (pack_stream)
+    KAN_TEST_ASSERT (pack_stream->operations->seek (pack_stream, KAN_STREAM_SEEK_END, 0))
+    const kan_file_size_t pack_size = pack_stream->operations->tell (pack_stream);
+    KAN_TEST_ASSERT (pack_stream->operations->seek (pack_stream, KAN_STREAM_SEEK_START, 0))
+
+    uint8_t *pack_data = kan_allocate_general (KAN_ALLOCATION_GROUP_IGNORE, pack_size, alignof (uint8_t));
+    KAN_TEST_ASSERT (pack_stream->operations->read (pack_stream, pack_size, pack_data) == pack_size)
+    pack_stream->operations->close (pack_stream);
+
+    kan_file_size_t registry_offset;
+    memcpy (&registry_offset, pack_data, sizeof (kan_file_size_t));
+
+    // Registry header consists of 6 32-bit fields and is followed by directory records. Root directory record
+    // starts with path offset, name offset, first child, children count, first file and files count fields.
+    const kan_file_size_t root_directory_offset = registry_offset + 6u * sizeof (uint32_t);
+    KAN_TEST_CHECK (!mount_corrupted_read_only_pack (volume, pack_data, pack_size,
+                                                     root_directory_offset + 1u * sizeof (uint32_t)))
+    KAN_TEST_CHECK (!mount_corrupted_read_only_pack (volume, pack_data, pack_size,
+                                                     root_directory_offset + 2u * sizeof (uint32_t)))
+    KAN_TEST_CHECK (!mount_corrupted_read_only_pack (volume, pack_data, pack_size,
+                                                     root_directory_offset + 4u * sizeof (uint32_t)))
+
+    // Sanity check: unchanged pack must still be mountable.
+    KAN_TEST_CHECK (kan_virtual_file_system_volume_mount_read_only_pack (volume, "packed", "data.pack"))
+    KAN_TEST_CHECK (read_text_file (volume, "packed/sub/log.txt", "Some text data"))
+    KAN_TEST_CHECK (kan_virtual_file_system_volume_unmount (volume, "packed"))
+
+    kan_free_general (KAN_ALLOCATION_GROUP_IGNORE, pack_data, pack_size);
+    KAN_TEST_CHECK (kan_virtual_file_system_remove_file (volume, "workspace/log.txt"))
+    KAN_TEST_CHECK (kan_virtual_file_system_remove_file (volume, "workspace/data.pack"))
+    kan_virtual_file_system_volume_destroy (volume);
+}
+
 KAN_TEST_CASE (directory_iterators)
 {
     kan_virtual_file_system_volume_t volume = kan_virtual_file_system_volume_create ();
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <kan/context/all_system_names.h>
@@ -9,6 +10,7 @@
 #include <kan/file_system/entry.h>
 #include <kan/file_system/path_container.h>
 #include <kan/resource_pipeline/build.h>
+#include <kan/resource_pipeline/timing_report.h>
 
 KAN_LOG_DEFINE_CATEGORY (application_framework_resource_build);
 
@@ -19,6 +21,10 @@ enum argument_mode_t
     ARGUMENT_MODE_LOG,
     ARGUMENT_MODE_PACK,
     ARGUMENT_MODE_TARGETS,
+    ARGUMENT_MODE_ARTIFACT_CACHE,
+    ARGUMENT_MODE_ARTIFACT_CACHE_LIMIT,
+    ARGUMENT_MODE_MEMORY_BUDGET,
+    ARGUMENT_MODE_TIMING_REPORT,
 };
 
 static const char help_message[] =
@@ -42,6 +48,22 @@ static const char help_message[] =
     "\n"
     "    --targets        Specifies target names to build. Supports several arguments.\n"
     "\n"
+    "    --artifact-cache Argument after this one is treated as path to shared artifact cache directory.\n"
+    "                     Artifact cache can be shared between several workspaces on the same machine.\n"
+    "\n"
+    "    --artifact-cache-limit\n"
+    "                     Argument after this one is treated as artifact cache size limit in megabytes.\n"
+    "\n"
+    "    --memory-budget  Argument after this one is treated as memory budget for simultaneous build tasks in\n"
+    "                     megabytes. Zero disables memory budget.\n"
+    "\n"
+    "    --timing-report  Enables build timing report. Optional argument after this one is treated as path to save\n"
+    "                     report to. When path is not specified, report is saved to workspace directory as\n"
+    "                     \"" KAN_RESOURCE_TIMING_REPORT_DEFAULT_NAME "\".\n"
+    "\n"
+    "    --full-scan      Scan all resource directories instead of skipping directories that are unchanged\n"
+    "                     according to scan snapshot from previous build. Does not expect arguments after it.\n"
+    "\n"
     "For proper execution, resource project and at least one target must be specified.\n";
 
 enum error_code_t
@@ -67,6 +89,9 @@ int main (int argc, char **argv)
     const char *project_path = NULL;
     bool log_level_selected = false;
     bool pack_selected = false;
+    bool artifact_cache_limit_selected = false;
+    bool memory_budget_selected = false;
+    bool timing_report_requested = false;
 
     struct kan_resource_build_setup_t setup;
     kan_resource_build_setup_init (&setup);
@@ -95,6 +120,33 @@ int main (int argc, char **argv)
             argument_mode = ARGUMENT_MODE_TARGETS;
             continue;
         }
+        else if (strcmp (argument, "--artifact-cache") == 0)
+        {
+            argument_mode = ARGUMENT_MODE_ARTIFACT_CACHE;
+            continue;
+        }
+        else if (strcmp (argument, "--artifact-cache-limit") == 0)
+        {
+            argument_mode = ARGUMENT_MODE_ARTIFACT_CACHE_LIMIT;
+            continue;
+        }
+        else if (strcmp (argument, "--memory-budget") == 0)
+        {
+            argument_mode = ARGUMENT_MODE_MEMORY_BUDGET;
+            continue;
+        }
+        else if (strcmp (argument, "--timing-report") == 0)
+        {
+            timing_report_requested = true;
+            argument_mode = ARGUMENT_MODE_TIMING_REPORT;
+            continue;
+        }
+        else if (strcmp (argument, "--full-scan") == 0)
+        {
+            setup.use_scan_snapshot = false;
+            argument_mode = ARGUMENT_MODE_NONE;
+            continue;
+        }
 
         switch (argument_mode)
         {
@@ -186,6 +238,76 @@ int main (int argc, char **argv)
             *spot = kan_string_intern (argument);
             break;
         }
+
+        case ARGUMENT_MODE_ARTIFACT_CACHE:
+            if (setup.artifact_cache_directory)
+            {
+                KAN_LOG (application_framework_resource_build, KAN_LOG_ERROR,
+                         "Encountered artifact cache argument when artifact cache is already provided.")
+                return ERROR_CODE_INVALID_ARGUMENTS;
+            }
+
+            setup.artifact_cache_directory = argument;
+            break;
+
+        case ARGUMENT_MODE_ARTIFACT_CACHE_LIMIT:
+        {
+            if (artifact_cache_limit_selected)
+            {
+                KAN_LOG (application_framework_resource_build, KAN_LOG_ERROR,
+                         "Encountered artifact cache limit argument when artifact cache limit is already provided.")
+                return ERROR_CODE_INVALID_ARGUMENTS;
+            }
+
+            char *parse_end = NULL;
+            const unsigned long long megabytes = strtoull (argument, &parse_end, 10);
+
+            if (parse_end == argument || *parse_end != '\0')
+            {
+                KAN_LOG (application_framework_resource_build, KAN_LOG_ERROR,
+                         "Encountered invalid artifact cache limit argument: \"%s\".", argument)
+                return ERROR_CODE_INVALID_ARGUMENTS;
+            }
+
+            artifact_cache_limit_selected = true;
+            setup.artifact_cache_size_limit = (kan_file_size_t) megabytes * 1024u * 1024u;
+            break;
+        }
+
+        case ARGUMENT_MODE_MEMORY_BUDGET:
+        {
+            if (memory_budget_selected)
+            {
+                KAN_LOG (application_framework_resource_build, KAN_LOG_ERROR,
+                         "Encountered memory budget argument when memory budget is already provided.")
+                return ERROR_CODE_INVALID_ARGUMENTS;
+            }
+
+            char *parse_end = NULL;
+            const unsigned long long megabytes = strtoull (argument, &parse_end, 10);
+
+            if (parse_end == argument || *parse_end != '\0')
+            {
+                KAN_LOG (application_framework_resource_build, KAN_LOG_ERROR,
+                         "Encountered invalid memory budget argument: \"%s\".", argument)
+                return ERROR_CODE_INVALID_ARGUMENTS;
+            }
+
+            memory_budget_selected = true;
+            setup.memory_budget = (kan_memory_size_t) megabytes * 1024u * 1024u;
+            break;
+        }
+
+        case ARGUMENT_MODE_TIMING_REPORT:
+            if (setup.timing_report_path)
+            {
+                KAN_LOG (application_framework_resource_build, KAN_LOG_ERROR,
+                         "Encountered timing report argument when timing report path is already provided.")
+                return ERROR_CODE_INVALID_ARGUMENTS;
+            }
+
+            setup.timing_report_path = argument;
+            break;
         }
     }
 
@@ -247,6 +369,15 @@ int main (int argc, char **argv)
     }
 
     CUSHION_DEFER { kan_file_system_lock_file_destroy (lock_file_path.path, lock_flags); }
+    struct kan_file_system_path_container_t timing_report_path;
+
+    if (timing_report_requested && !setup.timing_report_path)
+    {
+        kan_file_system_path_container_copy_string (&timing_report_path, project.workspace_directory);
+        kan_file_system_path_container_append (&timing_report_path, KAN_RESOURCE_TIMING_REPORT_DEFAULT_NAME);
+        setup.timing_report_path = timing_report_path.path;
+    }
+
     const kan_allocation_group_t context_allocation_group =
         kan_allocation_group_get_child (kan_allocation_group_root (), "tool_context");
 
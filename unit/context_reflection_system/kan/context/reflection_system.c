@@ -684,6 +684,9 @@ static void reflection_system_generate (struct reflection_system_t *system)
     KAN_LOG (reflection_system, KAN_LOG_INFO, "Generation finished.")
     kan_stack_group_allocator_shutdown (&generation_context.temporary_allocator);
 
+    KAN_LOG (reflection_system, KAN_LOG_INFO, "Freezing reflection registry.")
+    kan_reflection_registry_freeze (new_registry);
+
     KAN_LOG (reflection_system, KAN_LOG_INFO, "Running generation callbacks.")
     struct generated_connection_node_t *generated_node = system->first_generated_connection;
 
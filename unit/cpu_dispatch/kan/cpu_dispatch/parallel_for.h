@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cpu_dispatch_api.h>
+
+#include <kan/api_common/c_header.h>
+#include <kan/api_common/core_types.h>
+#include <kan/cpu_dispatch/task.h>
+
+/// \file
+/// \brief Provides parallel for -- a way to split synchronous work into items that are processed in parallel.
+///
+/// \par Parallel for
+/// \parblock
+/// Parallel for is designed for the code that needs result right away, but has lots of independent items to process,
+/// for example build rules that generate texture mips or batches of pipeline variants. Such code is usually executed
+/// inside cpu task already, so it cannot wait for helper tasks: if all workers are busy with such waits, nobody would
+/// execute helpers. Therefore, items are claimed through atomic counter by the calling thread and by helper tasks.
+/// Calling thread never waits for helper tasks to start and processes items by itself, it only waits for the items
+/// that were already claimed by helpers and are being processed right now. Whoever finishes the last item lets the
+/// calling thread continue: either it is the calling thread itself or helper wakes it up, so there is no polling.
+/// Helpers that were started too late just exit without touching items.
+/// \endparblock
+
+KAN_C_HEADER_BEGIN
+
+/// \brief Function that processes one item of parallel for.
+/// \details Worker index is zero for the calling thread and goes from one to helpers count for helper tasks, so it
+///          can be used to select per-worker resources. Worker index is stable during the whole execution.
+typedef void (*kan_cpu_parallel_for_function_t) (kan_functor_user_data_t user_data,
+                                                 kan_instance_size_t worker_index,
+                                                 kan_instance_size_t item_index);
+
+/// \brief Describes parallel for execution.
+struct kan_cpu_parallel_for_t
+{
+    kan_cpu_parallel_for_function_t function;
+    kan_functor_user_data_t user_data;
+    kan_instance_size_t items_count;
+
+    /// \brief Max count of helper tasks, actual count is also limited by items count and logical core count.
+    kan_instance_size_t max_helpers;
+
+    /// \brief Profiler section for helper tasks.
+    kan_cpu_section_t helper_profiler_section;
+};
+
+/// \brief Returns count of helper tasks that would be used to execute given parallel for.
+/// \details Useful when per-worker resources need to be prepared before execution.
+CPU_DISPATCH_API kan_instance_size_t kan_cpu_parallel_for_get_helpers_count (kan_instance_size_t items_count,
+                                                                             kan_instance_size_t max_helpers);
+
+/// \brief Processes all items of given parallel for and returns when all of them are processed.
+/// \details Can be safely called from inside of cpu tasks.
+CPU_DISPATCH_API void kan_cpu_parallel_for_execute (struct kan_cpu_parallel_for_t parallel_for);
+
+KAN_C_HEADER_END
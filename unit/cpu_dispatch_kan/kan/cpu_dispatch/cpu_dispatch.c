@@ -2,6 +2,7 @@
 #include <stdlib.h>
 
 #include <kan/cpu_dispatch/job.h>
+#include <kan/cpu_dispatch/parallel_for.h>
 #include <kan/cpu_dispatch/task.h>
 #include <kan/cpu_profiler/markup.h>
 #include <kan/error/critical.h>
@@ -9,6 +10,8 @@
 #include <kan/platform/hardware.h>
 #include <kan/precise_time/precise_time.h>
 #include <kan/threading/atomic.h>
+#include <kan/threading/conditional_variable.h>
+#include <kan/threading/mutex.h>
 #include <kan/threading/thread.h>
 
 KAN_USE_STATIC_CPU_SECTIONS
@@ -64,6 +67,9 @@ static bool global_task_dispatcher_ready = false;
 static struct kan_atomic_int_t global_task_dispatcher_init_lock = {.value = 0};
 static struct task_dispatcher_t global_task_dispatcher;
 
+/// \brief Allocation group for parallel for data, initialized along with global task dispatcher.
+static kan_allocation_group_t parallel_for_allocation_group;
+
 static void job_report_task_finished (struct job_t *job);
 
 static kan_thread_result_t worker_thread_function (kan_thread_user_data_t user_data)
@@ -169,6 +175,8 @@ static void ensure_global_task_dispatcher_ready (void)
             }
 
             global_task_dispatcher.dispatched_tasks_counter = kan_atomic_int_init (0);
+            parallel_for_allocation_group =
+                kan_allocation_group_get_child (kan_allocation_group_root (), "cpu_parallel_for");
             atexit (shutdown_global_task_dispatcher);
             global_task_dispatcher_ready = true;
         }
@@ -491,3 +499,157 @@ void kan_cpu_job_wait (kan_cpu_job_t job)
         kan_precise_time_sleep (KAN_CPU_DISPATCHER_WAIT_CHECK_DELAY_NS);
     }
 }
+
+/// \brief Shared state of parallel for execution.
+/// \details Helpers that were started too late exit without touching items, but still access this structure, therefore
+///          it is reference counted. Mutex and conditional variable are only used when calling thread has no items to
+///          claim, but some items are still being processed by helpers.
+struct parallel_for_t
+{
+    struct kan_cpu_parallel_for_t description;
+    struct kan_atomic_int_t next_item;
+    struct kan_atomic_int_t next_worker;
+    struct kan_atomic_int_t items_done;
+    struct kan_atomic_int_t references;
+
+    kan_mutex_t finish_mutex;
+    kan_conditional_variable_t finish_variable;
+
+    /// \brief Whether all items are processed, protected by finish mutex.
+    bool finished;
+
+    kan_instance_size_t helpers_count;
+    struct kan_cpu_task_list_node_t helper_nodes[];
+};
+
+/// \brief Processes items until there is nothing to claim.
+/// \return True if this worker has finished the last item.
+static bool parallel_for_process (struct parallel_for_t *parallel_for, kan_instance_size_t worker_index)
+{
+    bool finished_last = false;
+    while (true)
+    {
+        const kan_instance_size_t item = (kan_instance_size_t) kan_atomic_int_add (&parallel_for->next_item, 1);
+        if (item >= parallel_for->description.items_count)
+        {
+            return finished_last;
+        }
+
+        parallel_for->description.function (parallel_for->description.user_data, worker_index, item);
+        finished_last = (kan_instance_size_t) kan_atomic_int_add (&parallel_for->items_done, 1) + 1u ==
+                        parallel_for->description.items_count;
+    }
+}
+
+static void parallel_for_release (struct parallel_for_t *parallel_for)
+{
+    if (kan_atomic_int_add (&parallel_for->references, -1) == 1)
+    {
+        kan_conditional_variable_destroy (parallel_for->finish_variable);
+        kan_mutex_destroy (parallel_for->finish_mutex);
+        kan_free_general (parallel_for_allocation_group, parallel_for,
+                          sizeof (struct parallel_for_t) +
+                              sizeof (struct kan_cpu_task_list_node_t) * parallel_for->helpers_count);
+    }
+}
+
+static void parallel_for_helper (kan_functor_user_data_t user_data)
+{
+    struct parallel_for_t *parallel_for = (struct parallel_for_t *) user_data;
+    const kan_instance_size_t worker_index =
+        (kan_instance_size_t) kan_atomic_int_add (&parallel_for->next_worker, 1) + 1u;
+
+    if (parallel_for_process (parallel_for, worker_index))
+    {
+        // Calling thread is either waiting or about to wait for us, let it continue.
+        kan_mutex_lock (parallel_for->finish_mutex);
+        parallel_for->finished = true;
+        kan_conditional_variable_signal_one (parallel_for->finish_variable);
+        kan_mutex_unlock (parallel_for->finish_mutex);
+    }
+
+    parallel_for_release (parallel_for);
+}
+
+kan_instance_size_t kan_cpu_parallel_for_get_helpers_count (kan_instance_size_t items_count,
+                                                            kan_instance_size_t max_helpers)
+{
+    if (items_count <= 1u)
+    {
+        return 0u;
+    }
+
+    return KAN_MIN (max_helpers,
+                    KAN_MIN (items_count - 1u, KAN_MAX (1u, kan_platform_get_cpu_logical_core_count ()) - 1u));
+}
+
+void kan_cpu_parallel_for_execute (struct kan_cpu_parallel_for_t parallel_for)
+{
+    const kan_instance_size_t helpers_count =
+        kan_cpu_parallel_for_get_helpers_count (parallel_for.items_count, parallel_for.max_helpers);
+
+    if (helpers_count == 0u)
+    {
+        for (kan_loop_size_t index = 0u; index < parallel_for.items_count; ++index)
+        {
+            parallel_for.function (parallel_for.user_data, 0u, index);
+        }
+
+        return;
+    }
+
+    // Helpers are dispatched anyway, so we can use dispatcher initialization for parallel for statics too.
+    ensure_global_task_dispatcher_ready ();
+
+    struct parallel_for_t *data = kan_allocate_general (
+        parallel_for_allocation_group,
+        sizeof (struct parallel_for_t) + sizeof (struct kan_cpu_task_list_node_t) * helpers_count,
+        alignof (struct parallel_for_t));
+
+    data->description = parallel_for;
+    data->next_item = kan_atomic_int_init (0);
+    data->next_worker = kan_atomic_int_init (0);
+    data->items_done = kan_atomic_int_init (0);
+    data->references = kan_atomic_int_init ((int) helpers_count + 1);
+    data->finish_mutex = kan_mutex_create ();
+    data->finish_variable = kan_conditional_variable_create ();
+    data->finished = false;
+    data->helpers_count = helpers_count;
+
+    for (kan_loop_size_t index = 0u; index < helpers_count; ++index)
+    {
+        data->helper_nodes[index] = (struct kan_cpu_task_list_node_t) {
+            .next = index + 1u < helpers_count ? &data->helper_nodes[index + 1u] : NULL,
+            .task =
+                {
+                    .function = parallel_for_helper,
+                    .user_data = (kan_functor_user_data_t) data,
+                    .profiler_section = parallel_for.helper_profiler_section,
+                },
+            .dispatch_handle = KAN_HANDLE_INITIALIZE_INVALID,
+        };
+    }
+
+    // Handles are read right after dispatch, before we start processing items, so nobody can release data yet.
+    kan_cpu_task_dispatch_list (data->helper_nodes);
+    for (kan_loop_size_t index = 0u; index < helpers_count; ++index)
+    {
+        kan_cpu_task_detach (data->helper_nodes[index].dispatch_handle);
+    }
+
+    if (!parallel_for_process (data, 0u) &&
+        (kan_instance_size_t) kan_atomic_int_get (&data->items_done) < parallel_for.items_count)
+    {
+        // Only items that are being processed by helpers right now are left, helper that finishes the last one
+        // wakes us up. Finished flag protects us from missing the signal if it was sent before we started to wait.
+        kan_mutex_lock (data->finish_mutex);
+        while (!data->finished)
+        {
+            kan_conditional_variable_wait (data->finish_variable, data->finish_mutex);
+        }
+
+        kan_mutex_unlock (data->finish_mutex);
+    }
+
+    parallel_for_release (data);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <file_system_api.h>
+
+#include <kan/api_common/c_header.h>
+#include <kan/api_common/core_types.h>
+
+/// \file
+/// \brief Contains API for asynchronous reading of file ranges.
+///
+/// \par Overview
+/// \parblock
+/// Asynchronous read request reads given range of given file into user provided buffer without blocking caller
+/// thread. It makes it possible to avoid blocking cpu dispatch workers inside file reads: user can submit the read,
+/// return from the task and continue the work when read is finished.
+/// \endparblock
+///
+/// \par Backends
+/// \parblock
+/// On Linux, io_uring is used for executing reads if it is supported by the kernel. Otherwise, reads are executed on
+/// dedicated IO worker threads, so reads are never executed on cpu dispatch worker threads in any case.
+/// \endparblock
+///
+/// \par Completion
+/// \parblock
+/// When read is finished, its status is atomically updated and completion callback, if any, is called. Status can also
+/// be checked through kan_file_system_async_read_poll or awaited through kan_file_system_async_read_wait. Read handle
+/// must always be destroyed through kan_file_system_async_read_destroy, but it is allowed to destroy handle right
+/// after submit if user only relies on completion callback. Buffer must be kept alive until read is finished.
+///
+/// Completion callback is called from IO thread, therefore it must be lightweight. File system is below cpu dispatch
+/// in dependency graph, therefore it cannot dispatch tasks by itself, but completion callback is a good place to
+/// dispatch cpu task that continues the work with read data.
+/// \endparblock
+
+KAN_C_HEADER_BEGIN
+
+KAN_HANDLE_DEFINE (kan_file_system_async_read_t);
+
+/// \brief Enumerates statuses of asynchronous read.
+enum kan_file_system_async_read_status_t
+{
+    KAN_FILE_SYSTEM_ASYNC_READ_STATUS_PENDING = 0u,
+    KAN_FILE_SYSTEM_ASYNC_READ_STATUS_SUCCESSFUL,
+    KAN_FILE_SYSTEM_ASYNC_READ_STATUS_FAILED,
+};
+
+/// \brief Signature of the function that is called from IO thread when asynchronous read is finished.
+/// \details Read handle is guaranteed to be alive during callback execution even if user has already destroyed it.
+typedef void (*kan_file_system_async_read_callback_t) (kan_file_system_async_read_t read,
+                                                       kan_functor_user_data_t user_data);
+
+/// \brief Describes asynchronous read to be submitted.
+struct kan_file_system_async_read_request_t
+{
+    /// \brief Path to the file to read. File is opened during submit, therefore path is not used after it.
+    const char *path;
+
+    /// \brief Offset from the beginning of the file.
+    kan_file_size_t offset;
+
+    /// \brief Size of the range to read. Actual read size might be less if file ends earlier.
+    kan_file_size_t size;
+
+    /// \brief Buffer to read into, must be able to contain at least `size` bytes.
+    void *buffer;
+
+    /// \brief Function that is called when read is finished. Optional.
+    kan_file_system_async_read_callback_t completion_callback;
+
+    /// \brief User data for the completion callback.
+    kan_functor_user_data_t completion_user_data;
+};
+
+/// \brief Submits given asynchronous read. Returns invalid handle if read cannot be submitted, for example when
+///        file cannot be opened.
+FILE_SYSTEM_API kan_file_system_async_read_t
+kan_file_system_async_read_submit (const struct kan_file_system_async_read_request_t *request);
+
+/// \brief Returns current status of given asynchronous read.
+FILE_SYSTEM_API enum kan_file_system_async_read_status_t kan_file_system_async_read_poll (
+    kan_file_system_async_read_t read);
+
+/// \brief Blocks execution until given asynchronous read is finished and returns its status.
+FILE_SYSTEM_API enum kan_file_system_async_read_status_t kan_file_system_async_read_wait (
+    kan_file_system_async_read_t read);
+
+/// \brief Returns count of bytes that were read by successfully finished asynchronous read.
+FILE_SYSTEM_API kan_file_size_t kan_file_system_async_read_get_read_size (kan_file_system_async_read_t read);
+
+/// \brief Destroys given asynchronous read handle. Pending read is not cancelled and will still be finished.
+FILE_SYSTEM_API void kan_file_system_async_read_destroy (kan_file_system_async_read_t read);
+
+KAN_C_HEADER_END
@@ -32,7 +32,8 @@ struct kan_file_system_entry_status_t
     kan_file_size_t size;
 
     /// \brief In nanoseconds from Unix epoch in UTC zone.
-    /// \warning Not used for KAN_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY.
+    /// \details For KAN_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY, it is changed when entries are added, removed or renamed
+    ///          inside directory, but not when content of these entries is changed.
     kan_time_size_t last_modification_time_ns;
 
     /// \warning Not used for KAN_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY.
@@ -60,6 +61,10 @@ FILE_SYSTEM_API bool kan_file_system_move_file (const char *from, const char *to
 /// \brief Attempts to remove file entry at given path. Returns true on success.
 FILE_SYSTEM_API bool kan_file_system_remove_file (const char *path);
 
+/// \brief Attempts to update last modification time of file entry at given path to current time.
+///        Returns true on success.
+FILE_SYSTEM_API bool kan_file_system_touch_file (const char *path);
+
 /// \brief Attempts to create directory entry at given path. Returns true on success.
 /// \warning We treat failure due to the existence of directory as success, as it is much more convenient for tools.
 FILE_SYSTEM_API bool kan_file_system_make_directory (const char *path);
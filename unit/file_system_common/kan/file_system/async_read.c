@@ -0,0 +1,711 @@
+#define _CRT_SECURE_NO_WARNINGS __CUSHION_PRESERVE__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#    include <errno.h>
+#    include <fcntl.h>
+#    include <linux/io_uring.h>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+#include <kan/api_common/min_max.h>
+#include <kan/error/critical.h>
+#include <kan/file_system/async_read.h>
+#include <kan/log/logging.h>
+#include <kan/memory/allocation.h>
+#include <kan/precise_time/precise_time.h>
+#include <kan/threading/atomic.h>
+#include <kan/threading/conditional_variable.h>
+#include <kan/threading/mutex.h>
+#include <kan/threading/thread.h>
+
+KAN_LOG_DEFINE_CATEGORY (file_system_async_read);
+
+/// \brief Maximum size of one read operation, bigger reads are split into several operations.
+#define ASYNC_READ_MAX_OPERATION_SIZE (1u << 30u)
+
+struct async_read_t
+{
+    /// \brief Used for queueing reads when they cannot be immediately submitted to the backend.
+    struct async_read_t *next;
+
+    struct kan_atomic_int_t status;
+
+    /// \brief One reference is owned by user handle and one is owned by backend until read is finished.
+    struct kan_atomic_int_t references;
+
+    kan_file_size_t offset;
+    kan_file_size_t size;
+    kan_file_size_t read_size;
+    uint8_t *buffer;
+    kan_file_system_async_read_callback_t completion_callback;
+    kan_functor_user_data_t completion_user_data;
+
+#if defined(__linux__)
+    int file_descriptor;
+#else
+    FILE *file;
+#endif
+};
+
+#if defined(__linux__)
+struct io_uring_backend_t
+{
+    int ring_descriptor;
+
+    void *submission_ring;
+    kan_memory_size_t submission_ring_size;
+
+    void *completion_ring;
+    kan_memory_size_t completion_ring_size;
+
+    struct io_uring_sqe *submission_entries;
+    kan_memory_size_t submission_entries_size;
+
+    unsigned int *submission_tail;
+    unsigned int submission_mask;
+    unsigned int *submission_array;
+
+    unsigned int *completion_head;
+    unsigned int *completion_tail;
+    unsigned int completion_mask;
+    struct io_uring_cqe *completion_entries;
+
+    /// \brief Count of read operations that are pushed to the submission ring, but not yet completed.
+    kan_instance_size_t in_flight;
+
+    /// \brief Count of read operations that are pushed to the submission ring, but not yet consumed by kernel.
+    kan_instance_size_t not_consumed;
+
+    /// \brief Maximum count of read operations in flight, so completion ring would never overflow.
+    /// \details One entry of the rings is always reserved for the shutdown no-op.
+    kan_instance_size_t capacity;
+};
+#endif
+
+struct async_read_context_t
+{
+    kan_allocation_group_t allocation_group;
+    struct kan_atomic_int_t shutting_down;
+
+    kan_mutex_t queue_mutex;
+    kan_conditional_variable_t queue_signal;
+    struct async_read_t *queue_first;
+    struct async_read_t *queue_last;
+
+    kan_instance_size_t threads_count;
+    kan_thread_t *threads;
+
+#if defined(__linux__)
+    bool io_uring_enabled;
+    struct io_uring_backend_t io_uring;
+#endif
+};
+
+static bool global_async_read_context_ready = false;
+static struct kan_atomic_int_t global_async_read_context_init_lock = {.value = 0};
+static struct async_read_context_t global_async_read_context;
+
+static inline void async_read_release (struct async_read_t *read)
+{
+    if (kan_atomic_int_add (&read->references, -1) == 1)
+    {
+#if defined(__linux__)
+        close (read->file_descriptor);
+#else
+        fclose (read->file);
+#endif
+
+        kan_free_batched (global_async_read_context.allocation_group, read);
+    }
+}
+
+static void async_read_finish (struct async_read_t *read, bool successful)
+{
+    kan_atomic_int_set (&read->status, successful ? KAN_FILE_SYSTEM_ASYNC_READ_STATUS_SUCCESSFUL :
+                                                    KAN_FILE_SYSTEM_ASYNC_READ_STATUS_FAILED);
+
+    if (read->completion_callback)
+    {
+        read->completion_callback (KAN_HANDLE_SET (kan_file_system_async_read_t, read), read->completion_user_data);
+    }
+
+    async_read_release (read);
+}
+
+static bool async_read_execute_blocking (struct async_read_t *read)
+{
+#if defined(__linux__)
+    while (read->read_size < read->size)
+    {
+        const ssize_t result =
+            pread (read->file_descriptor, read->buffer + read->read_size,
+                   (size_t) KAN_MIN (read->size - read->read_size, (kan_file_size_t) ASYNC_READ_MAX_OPERATION_SIZE),
+                   (off_t) (read->offset + read->read_size));
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            KAN_LOG (file_system_async_read, KAN_LOG_ERROR, "Failed to execute read: %s.", strerror (errno))
+            return false;
+        }
+
+        if (result == 0)
+        {
+            break;
+        }
+
+        read->read_size += (kan_file_size_t) result;
+    }
+
+    return true;
+#else
+#    if defined(_WIN32)
+    if (_fseeki64 (read->file, (long long) read->offset, SEEK_SET) != 0)
+#    else
+    if (fseek (read->file, (long) read->offset, SEEK_SET) != 0)
+#    endif
+    {
+        KAN_LOG (file_system_async_read, KAN_LOG_ERROR, "Failed to seek to the read offset.")
+        return false;
+    }
+
+    read->read_size = (kan_file_size_t) fread (read->buffer, 1u, (size_t) read->size, read->file);
+    if (ferror (read->file))
+    {
+        KAN_LOG (file_system_async_read, KAN_LOG_ERROR, "Failed to execute read.")
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+/// \brief Detaches all reads that are still waiting in the queue, so they can be cancelled during shutdown.
+/// \details Should only be called under queue mutex.
+static struct async_read_t *detach_queued_reads_unsafe (void)
+{
+    struct async_read_t *queued = global_async_read_context.queue_first;
+    global_async_read_context.queue_first = NULL;
+    global_async_read_context.queue_last = NULL;
+    return queued;
+}
+
+/// \brief Finishes given detached reads as failed, so their owners are notified through status and callbacks.
+static void cancel_detached_reads (struct async_read_t *read)
+{
+    while (read)
+    {
+        struct async_read_t *next = read->next;
+        KAN_LOG (file_system_async_read, KAN_LOG_ERROR, "Async read was cancelled due to file system shutdown.")
+        async_read_finish (read, false);
+        read = next;
+    }
+}
+
+static kan_thread_result_t worker_thread_function (kan_thread_user_data_t user_data)
+{
+    while (true)
+    {
+        struct async_read_t *read = NULL;
+        kan_mutex_lock (global_async_read_context.queue_mutex);
+
+        while (!global_async_read_context.queue_first &&
+               !kan_atomic_int_get (&global_async_read_context.shutting_down))
+        {
+            kan_conditional_variable_wait (global_async_read_context.queue_signal,
+                                           global_async_read_context.queue_mutex);
+        }
+
+        if (kan_atomic_int_get (&global_async_read_context.shutting_down))
+        {
+            // Reads that were not started yet are cancelled, so nobody waits for them forever.
+            struct async_read_t *queued = detach_queued_reads_unsafe ();
+            kan_mutex_unlock (global_async_read_context.queue_mutex);
+            cancel_detached_reads (queued);
+            return 0;
+        }
+
+        read = global_async_read_context.queue_first;
+        global_async_read_context.queue_first = read->next;
+
+        if (!global_async_read_context.queue_first)
+        {
+            global_async_read_context.queue_last = NULL;
+        }
+
+        kan_mutex_unlock (global_async_read_context.queue_mutex);
+        async_read_finish (read, async_read_execute_blocking (read));
+    }
+}
+
+#if defined(__linux__)
+static inline int io_uring_setup (unsigned int entries, struct io_uring_params *parameters)
+{
+    return (int) syscall (__NR_io_uring_setup, entries, parameters);
+}
+
+static inline int io_uring_enter (int ring_descriptor,
+                                  unsigned int to_submit,
+                                  unsigned int min_complete,
+                                  unsigned int flags)
+{
+    return (int) syscall (__NR_io_uring_enter, ring_descriptor, to_submit, min_complete, flags, NULL, 0u);
+}
+
+static void io_uring_backend_destroy (struct io_uring_backend_t *backend)
+{
+    if (backend->submission_entries && backend->submission_entries != MAP_FAILED)
+    {
+        munmap (backend->submission_entries, backend->submission_entries_size);
+    }
+
+    if (backend->completion_ring && backend->completion_ring != MAP_FAILED &&
+        backend->completion_ring != backend->submission_ring)
+    {
+        munmap (backend->completion_ring, backend->completion_ring_size);
+    }
+
+    if (backend->submission_ring && backend->submission_ring != MAP_FAILED)
+    {
+        munmap (backend->submission_ring, backend->submission_ring_size);
+    }
+
+    close (backend->ring_descriptor);
+}
+
+static bool io_uring_backend_init (struct io_uring_backend_t *backend)
+{
+    struct io_uring_params parameters;
+    memset (&parameters, 0, sizeof (parameters));
+    memset (backend, 0, sizeof (struct io_uring_backend_t));
+
+    backend->ring_descriptor = io_uring_setup (KAN_FILE_SYSTEM_ASYNC_READ_IO_URING_ENTRIES, &parameters);
+    if (backend->ring_descriptor < 0)
+    {
+        KAN_LOG (file_system_async_read, KAN_LOG_INFO,
+                 "Unable to setup io_uring (%s), falling back to worker threads for async reads.", strerror (errno))
+        return false;
+    }
+
+    // Feature flag with current position reads was introduced in the same kernel version as read operation,
+    // therefore we use it as a marker that read operation is supported.
+    if (!(parameters.features & IORING_FEAT_SINGLE_MMAP) || !(parameters.features & IORING_FEAT_RW_CUR_POS))
+    {
+        KAN_LOG (file_system_async_read, KAN_LOG_INFO,
+                 "Kernel io_uring implementation is too old, falling back to worker threads for async reads.")
+        close (backend->ring_descriptor);
+        return false;
+    }
+
+    backend->submission_ring_size = parameters.sq_off.array + parameters.sq_entries * sizeof (unsigned int);
+    backend->completion_ring_size = parameters.cq_off.cqes + parameters.cq_entries * sizeof (struct io_uring_cqe);
+    backend->submission_ring_size = KAN_MAX (backend->submission_ring_size, backend->completion_ring_size);
+    backend->completion_ring_size = backend->submission_ring_size;
+
+    backend->submission_ring = mmap (NULL, backend->submission_ring_size, PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_POPULATE, backend->ring_descriptor, IORING_OFF_SQ_RING);
+    backend->completion_ring = backend->submission_ring;
+
+    backend->submission_entries_size = parameters.sq_entries * sizeof (struct io_uring_sqe);
+    backend->submission_entries = mmap (NULL, backend->submission_entries_size, PROT_READ | PROT_WRITE,
+                                        MAP_SHARED | MAP_POPULATE, backend->ring_descriptor, IORING_OFF_SQES);
+
+    if (backend->submission_ring == MAP_FAILED || backend->submission_entries == MAP_FAILED)
+    {
+        KAN_LOG (file_system_async_read, KAN_LOG_INFO,
+                 "Unable to map io_uring memory (%s), falling back to worker threads for async reads.",
+                 strerror (errno))
+        io_uring_backend_destroy (backend);
+        return false;
+    }
+
+    uint8_t *submission_ring = backend->submission_ring;
+    backend->submission_tail = (unsigned int *) (submission_ring + parameters.sq_off.tail);
+    backend->submission_mask = *(unsigned int *) (submission_ring + parameters.sq_off.ring_mask);
+    backend->submission_array = (unsigned int *) (submission_ring + parameters.sq_off.array);
+
+    uint8_t *completion_ring = backend->completion_ring;
+    backend->completion_head = (unsigned int *) (completion_ring + parameters.cq_off.head);
+    backend->completion_tail = (unsigned int *) (completion_ring + parameters.cq_off.tail);
+    backend->completion_mask = *(unsigned int *) (completion_ring + parameters.cq_off.ring_mask);
+    backend->completion_entries = (struct io_uring_cqe *) (completion_ring + parameters.cq_off.cqes);
+
+    backend->in_flight = 0u;
+    backend->not_consumed = 0u;
+    // Reserve one entry for the shutdown no-op, so it can always be pushed regardless of the reads in flight.
+    backend->capacity = (kan_instance_size_t) KAN_MIN (parameters.sq_entries, parameters.cq_entries) - 1u;
+    return true;
+}
+
+/// \details Should only be called under queue mutex.
+static void io_uring_backend_push_unsafe (struct io_uring_backend_t *backend, uint8_t operation, void *user_data)
+{
+    const unsigned int tail = *backend->submission_tail;
+    const unsigned int index = tail & backend->submission_mask;
+    struct io_uring_sqe *entry = &backend->submission_entries[index];
+    memset (entry, 0, sizeof (struct io_uring_sqe));
+
+    entry->opcode = operation;
+    entry->fd = -1;
+    entry->user_data = (uint64_t) (uintptr_t) user_data;
+
+    if (operation == IORING_OP_READ)
+    {
+        struct async_read_t *read = user_data;
+        entry->fd = read->file_descriptor;
+        entry->addr = (uint64_t) (uintptr_t) (read->buffer + read->read_size);
+        entry->len = (uint32_t) KAN_MIN (read->size - read->read_size, (kan_file_size_t) ASYNC_READ_MAX_OPERATION_SIZE);
+        entry->off = (uint64_t) (read->offset + read->read_size);
+    }
+
+    backend->submission_array[index] = index;
+    __atomic_store_n (backend->submission_tail, tail + 1u, __ATOMIC_RELEASE);
+    ++backend->not_consumed;
+}
+
+/// \details Should only be called under queue mutex.
+static void io_uring_backend_submit_unsafe (struct io_uring_backend_t *backend)
+{
+    while (backend->not_consumed > 0u)
+    {
+        const int result = io_uring_enter (backend->ring_descriptor, backend->not_consumed, 0u, 0u);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            // Not consumed entries will be submitted during next submit call.
+            if (errno != EAGAIN && errno != EBUSY)
+            {
+                KAN_LOG (file_system_async_read, KAN_LOG_ERROR, "Failed to submit reads to io_uring: %s.",
+                         strerror (errno))
+            }
+
+            break;
+        }
+
+        backend->not_consumed -= (kan_instance_size_t) result;
+    }
+}
+
+/// \details Should only be called under queue mutex.
+static void io_uring_backend_push_queued_unsafe (struct io_uring_backend_t *backend)
+{
+    while (global_async_read_context.queue_first && backend->in_flight < backend->capacity)
+    {
+        struct async_read_t *read = global_async_read_context.queue_first;
+        global_async_read_context.queue_first = read->next;
+
+        if (!global_async_read_context.queue_first)
+        {
+            global_async_read_context.queue_last = NULL;
+        }
+
+        io_uring_backend_push_unsafe (backend, IORING_OP_READ, read);
+        ++backend->in_flight;
+    }
+}
+
+static kan_thread_result_t io_uring_completion_thread_function (kan_thread_user_data_t user_data)
+{
+    struct io_uring_backend_t *backend = &global_async_read_context.io_uring;
+    bool shutdown_requested = false;
+    bool reads_in_flight = false;
+
+    // Reads that are already submitted to the kernel cannot be safely abandoned as kernel would write into their
+    // buffers after shutdown, therefore completion ring is drained until every read in flight is finished.
+    while (!shutdown_requested || reads_in_flight)
+    {
+        if (io_uring_enter (backend->ring_descriptor, 0u, 1u, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+        {
+            KAN_LOG (file_system_async_read, KAN_LOG_ERROR, "Failed to wait for io_uring completions: %s.",
+                     strerror (errno))
+            kan_precise_time_sleep (KAN_FILE_SYSTEM_ASYNC_READ_WAIT_CHECK_DELAY_NS);
+            continue;
+        }
+
+        struct async_read_t *finished_successfully = NULL;
+        struct async_read_t *finished_with_error = NULL;
+        struct async_read_t *cancelled = NULL;
+        kan_mutex_lock (global_async_read_context.queue_mutex);
+
+        unsigned int head = *backend->completion_head;
+        const unsigned int tail = __atomic_load_n (backend->completion_tail, __ATOMIC_ACQUIRE);
+
+        while (head != tail)
+        {
+            const struct io_uring_cqe *entry = &backend->completion_entries[head & backend->completion_mask];
+            ++head;
+
+            if (entry->user_data == 0u)
+            {
+                // Only shutdown wake up operation has no user data.
+                shutdown_requested = true;
+                continue;
+            }
+
+            struct async_read_t *read = (struct async_read_t *) (uintptr_t) entry->user_data;
+            if (entry->res < 0)
+            {
+                if (entry->res == -EINTR || entry->res == -EAGAIN)
+                {
+                    io_uring_backend_push_unsafe (backend, IORING_OP_READ, read);
+                    continue;
+                }
+
+                KAN_LOG (file_system_async_read, KAN_LOG_ERROR, "Failed to execute read: %s.", strerror (-entry->res))
+                read->next = finished_with_error;
+                finished_with_error = read;
+                --backend->in_flight;
+                continue;
+            }
+
+            read->read_size += (kan_file_size_t) entry->res;
+            if (entry->res > 0 && read->read_size < read->size)
+            {
+                // Partial read, submit the rest of the range.
+                io_uring_backend_push_unsafe (backend, IORING_OP_READ, read);
+                continue;
+            }
+
+            read->next = finished_successfully;
+            finished_successfully = read;
+            --backend->in_flight;
+        }
+
+        __atomic_store_n (backend->completion_head, head, __ATOMIC_RELEASE);
+        if (shutdown_requested)
+        {
+            // Reads that were not submitted yet are cancelled, so nobody waits for them forever.
+            cancelled = detach_queued_reads_unsafe ();
+        }
+        else
+        {
+            io_uring_backend_push_queued_unsafe (backend);
+        }
+
+        io_uring_backend_submit_unsafe (backend);
+        reads_in_flight = backend->in_flight > 0u;
+        kan_mutex_unlock (global_async_read_context.queue_mutex);
+
+        while (finished_successfully)
+        {
+            struct async_read_t *next = finished_successfully->next;
+            async_read_finish (finished_successfully, true);
+            finished_successfully = next;
+        }
+
+        while (finished_with_error)
+        {
+            struct async_read_t *next = finished_with_error->next;
+            async_read_finish (finished_with_error, false);
+            finished_with_error = next;
+        }
+
+        cancel_detached_reads (cancelled);
+    }
+
+    return 0;
+}
+#endif
+
+static void shutdown_global_async_read_context (void)
+{
+    kan_mutex_lock (global_async_read_context.queue_mutex);
+    kan_atomic_int_set (&global_async_read_context.shutting_down, 1);
+
+#if defined(__linux__)
+    if (global_async_read_context.io_uring_enabled)
+    {
+        // Submit no-op without user data in order to wake up completion thread.
+        // There is always space for it as one entry is reserved and not included into capacity.
+        io_uring_backend_push_unsafe (&global_async_read_context.io_uring, IORING_OP_NOP, NULL);
+        io_uring_backend_submit_unsafe (&global_async_read_context.io_uring);
+    }
+#endif
+
+    kan_conditional_variable_signal_all (global_async_read_context.queue_signal);
+    kan_mutex_unlock (global_async_read_context.queue_mutex);
+
+    for (kan_loop_size_t index = 0u; index < global_async_read_context.threads_count; ++index)
+    {
+        kan_thread_wait (global_async_read_context.threads[index]);
+    }
+
+#if defined(__linux__)
+    if (global_async_read_context.io_uring_enabled)
+    {
+        io_uring_backend_destroy (&global_async_read_context.io_uring);
+    }
+#endif
+}
+
+static void ensure_global_async_read_context_ready (void)
+{
+    if (!global_async_read_context_ready)
+    {
+        // Initialization clash is a really rare situation, but must be checked any way.
+        KAN_ATOMIC_INT_SCOPED_LOCK (&global_async_read_context_init_lock)
+
+        if (!global_async_read_context_ready)
+        {
+            global_async_read_context.allocation_group =
+                kan_allocation_group_get_child (kan_allocation_group_root (), "file_system_async_read");
+
+            global_async_read_context.shutting_down = kan_atomic_int_init (0);
+            global_async_read_context.queue_mutex = kan_mutex_create ();
+            global_async_read_context.queue_signal = kan_conditional_variable_create ();
+            global_async_read_context.queue_first = NULL;
+            global_async_read_context.queue_last = NULL;
+
+            kan_thread_function_t thread_function = worker_thread_function;
+            const char *thread_name = "file_system_async_read_worker";
+            global_async_read_context.threads_count = KAN_FILE_SYSTEM_ASYNC_READ_WORKERS;
+
+#if defined(__linux__)
+            global_async_read_context.io_uring_enabled = io_uring_backend_init (&global_async_read_context.io_uring);
+            if (global_async_read_context.io_uring_enabled)
+            {
+                // Only one thread is needed to process completions and dispatch completion tasks.
+                thread_function = io_uring_completion_thread_function;
+                thread_name = "file_system_async_read_io_uring";
+                global_async_read_context.threads_count = 1u;
+            }
+#endif
+
+            global_async_read_context.threads =
+                kan_allocate_general (global_async_read_context.allocation_group,
+                                      sizeof (kan_thread_t) * global_async_read_context.threads_count,
+                                      alignof (kan_thread_t));
+
+            for (kan_loop_size_t index = 0u; index < global_async_read_context.threads_count; ++index)
+            {
+                global_async_read_context.threads[index] = kan_thread_create (thread_name, thread_function, 0u);
+                KAN_ASSERT (KAN_HANDLE_IS_VALID (global_async_read_context.threads[index]))
+            }
+
+            atexit (shutdown_global_async_read_context);
+            global_async_read_context_ready = true;
+        }
+    }
+}
+
+kan_file_system_async_read_t kan_file_system_async_read_submit (
+    const struct kan_file_system_async_read_request_t *request)
+{
+    ensure_global_async_read_context_ready ();
+#if defined(__linux__)
+    const int file_descriptor = open (request->path, O_RDONLY | O_CLOEXEC);
+    if (file_descriptor < 0)
+    {
+        KAN_LOG (file_system_async_read, KAN_LOG_ERROR, "Failed to open \"%s\" for async read: %s.", request->path,
+                 strerror (errno))
+        return KAN_HANDLE_SET_INVALID (kan_file_system_async_read_t);
+    }
+#else
+    FILE *file = fopen (request->path, "rb");
+    if (!file)
+    {
+        KAN_LOG (file_system_async_read, KAN_LOG_ERROR, "Failed to open \"%s\" for async read.", request->path)
+        return KAN_HANDLE_SET_INVALID (kan_file_system_async_read_t);
+    }
+#endif
+
+    struct async_read_t *read = kan_allocate_batched (global_async_read_context.allocation_group,
+                                                      sizeof (struct async_read_t));
+    read->next = NULL;
+    read->status = kan_atomic_int_init (KAN_FILE_SYSTEM_ASYNC_READ_STATUS_PENDING);
+    read->references = kan_atomic_int_init (2);
+    read->offset = request->offset;
+    read->size = request->size;
+    read->read_size = 0u;
+    read->buffer = request->buffer;
+    read->completion_callback = request->completion_callback;
+    read->completion_user_data = request->completion_user_data;
+
+#if defined(__linux__)
+    read->file_descriptor = file_descriptor;
+#else
+    read->file = file;
+#endif
+
+    kan_mutex_lock (global_async_read_context.queue_mutex);
+    if (kan_atomic_int_get (&global_async_read_context.shutting_down))
+    {
+        kan_mutex_unlock (global_async_read_context.queue_mutex);
+        KAN_LOG (file_system_async_read, KAN_LOG_ERROR, "Async read \"%s\" was cancelled due to file system shutdown.",
+                 request->path)
+
+        async_read_finish (read, false);
+        return KAN_HANDLE_SET (kan_file_system_async_read_t, read);
+    }
+
+#if defined(__linux__)
+    struct io_uring_backend_t *io_uring = &global_async_read_context.io_uring;
+    if (global_async_read_context.io_uring_enabled && io_uring->in_flight < io_uring->capacity &&
+        !global_async_read_context.queue_first)
+    {
+        io_uring_backend_push_unsafe (io_uring, IORING_OP_READ, read);
+        ++io_uring->in_flight;
+        io_uring_backend_submit_unsafe (io_uring);
+        kan_mutex_unlock (global_async_read_context.queue_mutex);
+        return KAN_HANDLE_SET (kan_file_system_async_read_t, read);
+    }
+#endif
+
+    // When io_uring is used, queue is only used for reads that do not fit into the rings right now.
+    if (global_async_read_context.queue_last)
+    {
+        global_async_read_context.queue_last->next = read;
+    }
+    else
+    {
+        global_async_read_context.queue_first = read;
+    }
+
+    global_async_read_context.queue_last = read;
+    kan_conditional_variable_signal_one (global_async_read_context.queue_signal);
+    kan_mutex_unlock (global_async_read_context.queue_mutex);
+    return KAN_HANDLE_SET (kan_file_system_async_read_t, read);
+}
+
+enum kan_file_system_async_read_status_t kan_file_system_async_read_poll (kan_file_system_async_read_t read)
+{
+    struct async_read_t *data = KAN_HANDLE_GET (read);
+    return (enum kan_file_system_async_read_status_t) kan_atomic_int_get (&data->status);
+}
+
+enum kan_file_system_async_read_status_t kan_file_system_async_read_wait (kan_file_system_async_read_t read)
+{
+    enum kan_file_system_async_read_status_t status;
+    while ((status = kan_file_system_async_read_poll (read)) == KAN_FILE_SYSTEM_ASYNC_READ_STATUS_PENDING)
+    {
+        kan_precise_time_sleep (KAN_FILE_SYSTEM_ASYNC_READ_WAIT_CHECK_DELAY_NS);
+    }
+
+    return status;
+}
+
+kan_file_size_t kan_file_system_async_read_get_read_size (kan_file_system_async_read_t read)
+{
+    struct async_read_t *data = KAN_HANDLE_GET (read);
+    KAN_ASSERT (kan_atomic_int_get (&data->status) == KAN_FILE_SYSTEM_ASYNC_READ_STATUS_SUCCESSFUL)
+    return data->read_size;
+}
+
+void kan_file_system_async_read_destroy (kan_file_system_async_read_t read)
+{
+    async_read_release (KAN_HANDLE_GET (read));
+}
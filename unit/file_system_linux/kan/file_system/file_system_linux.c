@@ -104,6 +104,17 @@ bool kan_file_system_remove_file (const char *path)
     return true;
 }
 
+bool kan_file_system_touch_file (const char *path)
+{
+    if (utimensat (AT_FDCWD, path, NULL, 0) != 0)
+    {
+        KAN_LOG (file_system_linux, KAN_LOG_ERROR, "Failed to touch file \"%s\": %s.", path, strerror (errno))
+        return false;
+    }
+
+    return true;
+}
+
 bool kan_file_system_make_directory (const char *path)
 {
     if (mkdir (path, S_IRWXU | S_IRWXG | S_IRWXO) != 0)
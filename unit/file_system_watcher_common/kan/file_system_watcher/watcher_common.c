@@ -0,0 +1,618 @@
+#define KAN_FILE_SYSTEM_WATCHER_IMPLEMENTATION
+
+#include <string.h>
+
+#include <kan/error/critical.h>
+#include <kan/file_system/entry.h>
+#include <kan/file_system_watcher/watcher_common.h>
+#include <kan/log/logging.h>
+#include <kan/memory/allocation.h>
+
+KAN_LOG_DEFINE_CATEGORY (file_system_watcher);
+
+struct event_queue_node_t
+{
+    struct kan_event_queue_node_t node;
+    struct kan_file_system_watcher_event_t event;
+};
+
+struct watcher_common_statics_t kan_file_system_watcher_common_statics;
+
+static bool statics_initialized = false;
+static struct kan_atomic_int_t statics_initialization_lock = {.value = 0};
+
+void kan_file_system_watcher_common_ensure_statics_initialized (void)
+{
+    if (!statics_initialized)
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK (&statics_initialization_lock)
+        if (!statics_initialized)
+        {
+            kan_file_system_watcher_common_statics.watcher_allocation_group =
+                kan_allocation_group_get_child (kan_allocation_group_root (), "file_system_watcher");
+            kan_file_system_watcher_common_statics.hierarchy_allocation_group = kan_allocation_group_get_child (
+                kan_file_system_watcher_common_statics.watcher_allocation_group, "hierarchy");
+            kan_file_system_watcher_common_statics.event_allocation_group = kan_allocation_group_get_child (
+                kan_file_system_watcher_common_statics.watcher_allocation_group, "event");
+            statics_initialized = true;
+        }
+    }
+}
+
+static struct event_queue_node_t *allocate_event_queue_node (void)
+{
+    return (struct event_queue_node_t *) kan_allocate_general (
+        kan_file_system_watcher_common_statics.event_allocation_group, sizeof (struct event_queue_node_t),
+        alignof (struct event_queue_node_t));
+}
+
+static void free_event_queue_node (struct event_queue_node_t *node)
+{
+    kan_free_general (kan_file_system_watcher_common_statics.event_allocation_group, node,
+                      sizeof (struct event_queue_node_t));
+}
+
+static inline struct watcher_file_node_t *file_node_allocate (void)
+{
+    return (struct watcher_file_node_t *) kan_allocate_batched (
+        kan_file_system_watcher_common_statics.hierarchy_allocation_group, sizeof (struct watcher_file_node_t));
+}
+
+static inline void file_node_free (struct watcher_file_node_t *node)
+{
+    kan_free_batched (kan_file_system_watcher_common_statics.hierarchy_allocation_group, node);
+}
+
+static struct watcher_directory_node_t *directory_node_create (struct watcher_t *watcher,
+                                                               struct watcher_directory_node_t *parent,
+                                                               kan_interned_string_t name)
+{
+    // We assume that path container holds path to given directory.
+    struct watcher_directory_node_t *node = (struct watcher_directory_node_t *) kan_allocate_batched (
+        kan_file_system_watcher_common_statics.hierarchy_allocation_group, watcher->hooks->directory_node_size);
+
+    node->parent = parent;
+    node->next_on_level_directory = NULL;
+    node->first_child_directory = NULL;
+    node->first_file = NULL;
+    node->name = name;
+    node->mark_found = true;
+
+    if (watcher->hooks->directory_created)
+    {
+        watcher->hooks->directory_created (watcher, node);
+    }
+
+    return node;
+}
+
+static void directory_node_destroy (struct watcher_t *watcher, struct watcher_directory_node_t *node)
+{
+    while (node->first_file)
+    {
+        struct watcher_file_node_t *next = node->first_file->next;
+        file_node_free (node->first_file);
+        node->first_file = next;
+    }
+
+    while (node->first_child_directory)
+    {
+        struct watcher_directory_node_t *next = node->first_child_directory->next_on_level_directory;
+        directory_node_destroy (watcher, node->first_child_directory);
+        node->first_child_directory = next;
+    }
+
+    if (watcher->hooks->directory_destroyed)
+    {
+        watcher->hooks->directory_destroyed (watcher, node);
+    }
+
+    kan_free_batched (kan_file_system_watcher_common_statics.hierarchy_allocation_group, node);
+}
+
+static inline void split_entry_name (const char *entry_name,
+                                     kan_interned_string_t *name_output,
+                                     kan_interned_string_t *extension_output)
+{
+    const char *last_dot_position = strrchr (entry_name, '.');
+    if (last_dot_position)
+    {
+        *name_output = kan_char_sequence_intern (entry_name, last_dot_position);
+        *extension_output = kan_string_intern (last_dot_position + 1u);
+    }
+    else
+    {
+        *name_output = kan_string_intern (entry_name);
+        *extension_output = NULL;
+    }
+}
+
+static void directory_node_append_file (struct watcher_directory_node_t *directory,
+                                        const char *entry_name,
+                                        const struct kan_file_system_entry_status_t *status)
+{
+    struct watcher_file_node_t *file = file_node_allocate ();
+    split_entry_name (entry_name, &file->name, &file->extension);
+
+    file->last_modification_time_ns = status->last_modification_time_ns;
+    file->size = status->size;
+    file->mark_found = true;
+
+    file->next = directory->first_file;
+    directory->first_file = file;
+}
+
+static struct watcher_directory_node_t *directory_node_append_empty_child_directory (
+    struct watcher_t *watcher, struct watcher_directory_node_t *directory, kan_interned_string_t interned_entry_name)
+{
+    // We assume that path container holds path to the new child directory.
+    struct watcher_directory_node_t *child = directory_node_create (watcher, directory, interned_entry_name);
+    child->next_on_level_directory = directory->first_child_directory;
+    directory->first_child_directory = child;
+    return child;
+}
+
+static void initial_poll_to_directory_recursive (struct watcher_t *watcher,
+                                                 struct watcher_directory_node_t *directory)
+{
+    // We assume that path container holds path to given directory.
+    kan_file_system_directory_iterator_t iterator =
+        kan_file_system_directory_iterator_create (watcher->path_container.path);
+
+    if (KAN_HANDLE_IS_VALID (iterator))
+    {
+        const char *entry_name;
+        while ((entry_name = kan_file_system_directory_iterator_advance (iterator)))
+        {
+            if ((entry_name[0u] == '.' && entry_name[1u] == '\0') ||
+                (entry_name[0u] == '.' && entry_name[1u] == '.' && entry_name[2u] == '\0'))
+            {
+                // Skip current and parent entries.
+                continue;
+            }
+
+            const kan_instance_size_t length_backup = watcher->path_container.length;
+            kan_file_system_path_container_append (&watcher->path_container, entry_name);
+
+            struct kan_file_system_entry_status_t status;
+            if (kan_file_system_query_entry (watcher->path_container.path, &status))
+            {
+                switch (status.type)
+                {
+                case KAN_FILE_SYSTEM_ENTRY_TYPE_UNKNOWN:
+                    KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, file_system_watcher, KAN_LOG_WARNING,
+                                         "Entry at \"%s\" has unknown type and will be ignored in snapshot.",
+                                         watcher->path_container.path)
+                    break;
+
+                case KAN_FILE_SYSTEM_ENTRY_TYPE_FILE:
+                    directory_node_append_file (directory, entry_name, &status);
+                    break;
+
+                case KAN_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY:
+                {
+                    struct watcher_directory_node_t *child = directory_node_append_empty_child_directory (
+                        watcher, directory, kan_string_intern (entry_name));
+                    initial_poll_to_directory_recursive (watcher, child);
+                    break;
+                }
+                }
+            }
+            else
+            {
+                KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, file_system_watcher, KAN_LOG_ERROR,
+                                     "Unable to query status of \"%s\", file system snapshot will be incomplete.",
+                                     watcher->path_container.path)
+            }
+
+            kan_file_system_path_container_reset_length (&watcher->path_container, length_backup);
+        }
+
+        kan_file_system_directory_iterator_destroy (iterator);
+    }
+    else
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, file_system_watcher, KAN_LOG_ERROR,
+                             "Unable to iterate directory \"%s\", file system snapshot will be incomplete.",
+                             watcher->path_container.path)
+    }
+}
+
+static void send_event (struct watcher_t *watcher,
+                        enum kan_file_system_watcher_event_type_t event_type,
+                        enum kan_file_system_entry_type_t entry_type,
+                        kan_interned_string_t name,
+                        kan_interned_string_t extension)
+{
+    // We assume that path container holds path to the entry if name and extension are NULL.
+    // Otherwise, we assume that path container holds path to the owner directory.
+
+    KAN_ATOMIC_INT_SCOPED_LOCK (&watcher->event_queue_lock)
+    struct event_queue_node_t *event_node =
+        (struct event_queue_node_t *) kan_event_queue_submit_begin (&watcher->event_queue);
+
+    if (event_node)
+    {
+        event_node->event.event_type = event_type;
+        event_node->event.entry_type = entry_type;
+        kan_file_system_path_container_copy (&event_node->event.path_container, &watcher->path_container);
+
+        if (name)
+        {
+            kan_file_system_path_container_append (&event_node->event.path_container, name);
+            if (extension)
+            {
+                kan_file_system_path_container_add_suffix (&event_node->event.path_container, ".");
+                kan_file_system_path_container_add_suffix (&event_node->event.path_container, extension);
+            }
+        }
+        else if (extension)
+        {
+            kan_file_system_path_container_append (&event_node->event.path_container, ".");
+            kan_file_system_path_container_add_suffix (&event_node->event.path_container, extension);
+        }
+
+        kan_event_queue_submit_end (&watcher->event_queue, &allocate_event_queue_node ()->node);
+    }
+}
+
+static void send_removal_events_to_directory_content (struct watcher_t *watcher,
+                                                      struct watcher_directory_node_t *directory)
+{
+    // We assume that path container holds path to given directory.
+
+    struct watcher_directory_node_t *child_directory = directory->first_child_directory;
+    while (child_directory)
+    {
+        const kan_instance_size_t length_backup = watcher->path_container.length;
+        kan_file_system_path_container_append (&watcher->path_container, child_directory->name);
+        send_removal_events_to_directory_content (watcher, child_directory);
+        kan_file_system_path_container_reset_length (&watcher->path_container, length_backup);
+        child_directory = child_directory->next_on_level_directory;
+    }
+
+    struct watcher_file_node_t *child_file = directory->first_file;
+    while (child_file)
+    {
+        send_event (watcher, KAN_FILE_SYSTEM_EVENT_TYPE_REMOVED, KAN_FILE_SYSTEM_ENTRY_TYPE_FILE, child_file->name,
+                    child_file->extension);
+        child_file = child_file->next;
+    }
+}
+
+static inline struct watcher_directory_node_t *directory_find_child_directory_node (
+    struct watcher_directory_node_t *directory, kan_interned_string_t interned_directory_name)
+{
+    // We don't use hash storages to accelerate search because in general file systems aren't optimized to handle tons
+    // of files and directories in one directory either.
+    struct watcher_directory_node_t *child_directory = directory->first_child_directory;
+
+    while (child_directory)
+    {
+        if (child_directory->name == interned_directory_name)
+        {
+            return child_directory;
+        }
+
+        child_directory = child_directory->next_on_level_directory;
+    }
+
+    return NULL;
+}
+
+static inline struct watcher_file_node_t *directory_find_child_file_node (struct watcher_directory_node_t *directory,
+                                                                          kan_interned_string_t name_part,
+                                                                          kan_interned_string_t extension_part)
+{
+    // We don't use hash storages to accelerate search because in general file systems aren't optimized to handle tons
+    // of files and directories in one directory either.
+    struct watcher_file_node_t *child_file = directory->first_file;
+
+    while (child_file)
+    {
+        if (child_file->name == name_part && child_file->extension == extension_part)
+        {
+            return child_file;
+        }
+
+        child_file = child_file->next;
+    }
+
+    return NULL;
+}
+
+void kan_file_system_watcher_common_init (struct watcher_t *watcher,
+                                          const char *directory_path,
+                                          const struct watcher_hooks_t *hooks)
+{
+    KAN_ASSERT (hooks->directory_node_size >= sizeof (struct watcher_directory_node_t))
+    watcher->next_watcher = NULL;
+    watcher->root_directory = NULL;
+    watcher->event_queue_lock = kan_atomic_int_init (0);
+    kan_event_queue_init (&watcher->event_queue, &allocate_event_queue_node ()->node);
+    watcher->status = kan_atomic_int_init (WATCHER_STATUS_INITIAL);
+    watcher->hooks = hooks;
+    kan_file_system_path_container_copy_string (&watcher->path_container, directory_path);
+}
+
+void kan_file_system_watcher_common_initial_poll (struct watcher_t *watcher)
+{
+    KAN_ASSERT (!watcher->root_directory)
+    watcher->root_directory = directory_node_create (watcher, NULL, NULL);
+    initial_poll_to_directory_recursive (watcher, watcher->root_directory);
+}
+
+void kan_file_system_watcher_common_poll (struct watcher_t *watcher,
+                                          struct watcher_directory_node_t *directory,
+                                          bool recursive)
+{
+    // We assume that path container holds path to given directory.
+    if (watcher->hooks->directory_poll_begin)
+    {
+        watcher->hooks->directory_poll_begin (watcher, directory);
+    }
+
+    // Start by marking everything as not found.
+
+    struct watcher_directory_node_t *child_directory = directory->first_child_directory;
+    while (child_directory)
+    {
+        child_directory->mark_found = false;
+        child_directory = child_directory->next_on_level_directory;
+    }
+
+    struct watcher_file_node_t *child_file = directory->first_file;
+    while (child_file)
+    {
+        child_file->mark_found = false;
+        child_file = child_file->next;
+    }
+
+    // Poll file system to discover existing entries, update timestamps and discover new entries.
+
+    kan_file_system_directory_iterator_t iterator =
+        kan_file_system_directory_iterator_create (watcher->path_container.path);
+
+    if (KAN_HANDLE_IS_VALID (iterator))
+    {
+        const char *entry_name;
+        while ((entry_name = kan_file_system_directory_iterator_advance (iterator)))
+        {
+            if ((entry_name[0u] == '.' && entry_name[1u] == '\0') ||
+                (entry_name[0u] == '.' && entry_name[1u] == '.' && entry_name[2u] == '\0'))
+            {
+                // Skip current and parent entries.
+                continue;
+            }
+
+            const kan_instance_size_t length_backup = watcher->path_container.length;
+            kan_file_system_path_container_append (&watcher->path_container, entry_name);
+
+            struct kan_file_system_entry_status_t status;
+            if (kan_file_system_query_entry (watcher->path_container.path, &status))
+            {
+                switch (status.type)
+                {
+                case KAN_FILE_SYSTEM_ENTRY_TYPE_UNKNOWN:
+                    KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, file_system_watcher, KAN_LOG_WARNING,
+                                         "Entry at \"%s\" has unknown type and will be ignored in snapshot.",
+                                         watcher->path_container.path)
+                    break;
+
+                case KAN_FILE_SYSTEM_ENTRY_TYPE_FILE:
+                {
+                    kan_interned_string_t name_part;
+                    kan_interned_string_t extension_part;
+                    split_entry_name (entry_name, &name_part, &extension_part);
+
+                    struct watcher_file_node_t *file_node =
+                        directory_find_child_file_node (directory, name_part, extension_part);
+
+                    if (file_node)
+                    {
+                        if (file_node->last_modification_time_ns != status.last_modification_time_ns ||
+                            file_node->size != status.size)
+                        {
+                            send_event (watcher, KAN_FILE_SYSTEM_EVENT_TYPE_MODIFIED, KAN_FILE_SYSTEM_ENTRY_TYPE_FILE,
+                                        NULL, NULL);
+                            file_node->last_modification_time_ns = status.last_modification_time_ns;
+                            file_node->size = status.size;
+                        }
+
+                        file_node->mark_found = true;
+                    }
+                    else
+                    {
+                        directory_node_append_file (directory, entry_name, &status);
+                        send_event (watcher, KAN_FILE_SYSTEM_EVENT_TYPE_ADDED, KAN_FILE_SYSTEM_ENTRY_TYPE_FILE, NULL,
+                                    NULL);
+                    }
+
+                    break;
+                }
+
+                case KAN_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY:
+                {
+                    kan_interned_string_t name = kan_string_intern (entry_name);
+                    struct watcher_directory_node_t *child_directory_node =
+                        directory_find_child_directory_node (directory, name);
+
+                    if (child_directory_node)
+                    {
+                        child_directory_node->mark_found = true;
+                        if (recursive)
+                        {
+                            kan_file_system_watcher_common_poll (watcher, child_directory_node, true);
+                        }
+                    }
+                    else
+                    {
+                        child_directory_node = directory_node_append_empty_child_directory (watcher, directory, name);
+                        send_event (watcher, KAN_FILE_SYSTEM_EVENT_TYPE_ADDED, KAN_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY,
+                                    NULL, NULL);
+                        kan_file_system_watcher_common_poll (watcher, child_directory_node, true);
+                    }
+
+                    break;
+                }
+                }
+            }
+            else
+            {
+                KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, file_system_watcher, KAN_LOG_ERROR,
+                                     "Unable to query status of \"%s\", file system snapshot will be incomplete.",
+                                     watcher->path_container.path)
+            }
+
+            kan_file_system_path_container_reset_length (&watcher->path_container, length_backup);
+        }
+
+        kan_file_system_directory_iterator_destroy (iterator);
+    }
+    else
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, file_system_watcher, KAN_LOG_ERROR,
+                             "Unable to iterate directory \"%s\", file system snapshot will be incomplete.",
+                             watcher->path_container.path)
+    }
+
+    // Delete undiscovered entries.
+
+    child_directory = directory->first_child_directory;
+    struct watcher_directory_node_t *previous_child_directory = NULL;
+
+    while (child_directory)
+    {
+        struct watcher_directory_node_t *next = child_directory->next_on_level_directory;
+        if (child_directory->mark_found)
+        {
+            previous_child_directory = child_directory;
+        }
+        else
+        {
+            const kan_instance_size_t length_backup = watcher->path_container.length;
+            kan_file_system_path_container_append (&watcher->path_container, child_directory->name);
+            send_removal_events_to_directory_content (watcher, child_directory);
+            kan_file_system_path_container_reset_length (&watcher->path_container, length_backup);
+            send_event (watcher, KAN_FILE_SYSTEM_EVENT_TYPE_REMOVED, KAN_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY,
+                        child_directory->name, NULL);
+
+            if (previous_child_directory)
+            {
+                previous_child_directory->next_on_level_directory = next;
+            }
+            else
+            {
+                directory->first_child_directory = next;
+            }
+
+            directory_node_destroy (watcher, child_directory);
+        }
+
+        child_directory = next;
+    }
+
+    child_file = directory->first_file;
+    struct watcher_file_node_t *previous_child_file = NULL;
+
+    while (child_file)
+    {
+        struct watcher_file_node_t *next = child_file->next;
+        if (child_file->mark_found)
+        {
+            previous_child_file = child_file;
+        }
+        else
+        {
+            send_event (watcher, KAN_FILE_SYSTEM_EVENT_TYPE_REMOVED, KAN_FILE_SYSTEM_ENTRY_TYPE_FILE, child_file->name,
+                        child_file->extension);
+
+            if (previous_child_file)
+            {
+                previous_child_file->next = next;
+            }
+            else
+            {
+                directory->first_file = next;
+            }
+
+            file_node_free (child_file);
+        }
+
+        child_file = next;
+    }
+}
+
+void kan_file_system_watcher_common_shutdown (struct watcher_t *watcher)
+{
+    if (watcher->root_directory)
+    {
+        directory_node_destroy (watcher, watcher->root_directory);
+        watcher->root_directory = NULL;
+    }
+
+    struct event_queue_node_t *queue_node = (struct event_queue_node_t *) watcher->event_queue.oldest;
+    while (queue_node)
+    {
+        struct event_queue_node_t *next_event = (struct event_queue_node_t *) queue_node->node.next;
+        free_event_queue_node (queue_node);
+        queue_node = next_event;
+    }
+}
+
+bool kan_file_system_watcher_is_up_to_date (kan_file_system_watcher_t watcher)
+{
+    struct watcher_t *data = KAN_HANDLE_GET (watcher);
+    return kan_atomic_int_get (&data->status) != WATCHER_STATUS_WAITING_UPDATE;
+}
+
+kan_file_system_watcher_iterator_t kan_file_system_watcher_iterator_create (kan_file_system_watcher_t watcher)
+{
+    struct watcher_t *watcher_data = KAN_HANDLE_GET (watcher);
+    KAN_ATOMIC_INT_SCOPED_LOCK (&watcher_data->event_queue_lock)
+    kan_event_queue_iterator_t iterator = kan_event_queue_iterator_create (&watcher_data->event_queue);
+    return KAN_HANDLE_TRANSIT (kan_file_system_watcher_iterator_t, iterator);
+}
+
+const struct kan_file_system_watcher_event_t *kan_file_system_watcher_iterator_get (
+    kan_file_system_watcher_t watcher, kan_file_system_watcher_iterator_t iterator)
+{
+    struct watcher_t *watcher_data = KAN_HANDLE_GET (watcher);
+    KAN_ATOMIC_INT_SCOPED_LOCK (&watcher_data->event_queue_lock)
+
+    const struct event_queue_node_t *node = (const struct event_queue_node_t *) kan_event_queue_iterator_get (
+        &watcher_data->event_queue, KAN_HANDLE_TRANSIT (kan_event_queue_iterator_t, iterator));
+    return node ? &node->event : NULL;
+}
+
+static inline void watcher_cleanup_events (struct watcher_t *watcher)
+{
+    struct event_queue_node_t *node;
+    while ((node = (struct event_queue_node_t *) kan_event_queue_clean_oldest (&watcher->event_queue)))
+    {
+        free_event_queue_node (node);
+    }
+}
+
+kan_file_system_watcher_iterator_t kan_file_system_watcher_iterator_advance (
+    kan_file_system_watcher_t watcher, kan_file_system_watcher_iterator_t iterator)
+{
+    struct watcher_t *watcher_data = KAN_HANDLE_GET (watcher);
+    KAN_ATOMIC_INT_SCOPED_LOCK (&watcher_data->event_queue_lock)
+    iterator = KAN_HANDLE_TRANSIT (
+        kan_file_system_watcher_iterator_t,
+        kan_event_queue_iterator_advance (KAN_HANDLE_TRANSIT (kan_event_queue_iterator_t, iterator)));
+
+    watcher_cleanup_events (watcher_data);
+    return iterator;
+}
+
+void kan_file_system_watcher_iterator_destroy (kan_file_system_watcher_t watcher,
+                                               kan_file_system_watcher_iterator_t iterator)
+{
+    struct watcher_t *watcher_data = KAN_HANDLE_GET (watcher);
+    KAN_ATOMIC_INT_SCOPED_LOCK (&watcher_data->event_queue_lock)
+    kan_event_queue_iterator_destroy (&watcher_data->event_queue,
+                                      KAN_HANDLE_TRANSIT (kan_event_queue_iterator_t, iterator));
+    watcher_cleanup_events (watcher_data);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#if !defined(KAN_FILE_SYSTEM_WATCHER_IMPLEMENTATION)
+#    error                                                                                                             \
+        "kan/file_system_watcher/watcher_common.h should only be included by file system watcher implementations."
+#endif
+
+#include <kan/api_common/c_header.h>
+#include <kan/api_common/core_types.h>
+#include <kan/container/event_queue.h>
+#include <kan/container/interned_string.h>
+#include <kan/file_system/path_container.h>
+#include <kan/file_system_watcher/watcher.h>
+#include <kan/memory_profiler/allocation_group.h>
+#include <kan/threading/atomic.h>
+
+// Common part of file system watcher implementations. Every implementation keeps snapshot of the file system tree and
+// produces events by comparing snapshot with actual file system state, because watcher API requires events to be
+// the diff between updates. Implementations only differ in the way they decide which directories need to be polled
+// and in the way they schedule updates, therefore snapshot, polling and event queue logic is shared.
+
+// Interned strings are used for files and directories for following reasons:
+// - In asset tree there are usually lots of common patterns, therefore we could have lots of directories with the
+//   same name in different parts of tree and save memory by interning.
+// - File names are frequently used as resource IDs, therefore they're almost always used by other systems as interned
+//   strings already. It means that we can save memory by separating name into interned string.
+// - Extensions are usually really-really common, therefore it is logical to intern them separately from names.
+
+KAN_C_HEADER_BEGIN
+
+struct watcher_file_node_t
+{
+    struct watcher_file_node_t *next;
+    kan_interned_string_t name;
+    kan_interned_string_t extension;
+    kan_time_size_t last_modification_time_ns;
+    kan_file_size_t size;
+    bool mark_found;
+};
+
+/// \brief Common part of directory node, implementations can store additional data right after it.
+struct watcher_directory_node_t
+{
+    struct watcher_directory_node_t *parent;
+    struct watcher_directory_node_t *next_on_level_directory;
+    struct watcher_directory_node_t *first_child_directory;
+    struct watcher_file_node_t *first_file;
+    kan_interned_string_t name;
+    bool mark_found;
+};
+
+#define WATCHER_STATUS_INITIAL 0
+#define WATCHER_STATUS_IDLE 1
+#define WATCHER_STATUS_WAITING_UPDATE 2
+#define WATCHER_STATUS_WAITING_DESTROY 3
+
+struct watcher_t;
+
+typedef void (*watcher_directory_hook_t) (struct watcher_t *watcher, struct watcher_directory_node_t *directory);
+
+/// \brief Describes how implementation extends directory nodes and reacts to snapshot changes.
+struct watcher_hooks_t
+{
+    /// \brief Size of implementation directory node structure that starts with `watcher_directory_node_t`.
+    kan_instance_size_t directory_node_size;
+
+    /// \brief Optional hook that is called right after directory node creation.
+    /// \details Path container holds path to the created directory when this hook is called.
+    watcher_directory_hook_t directory_created;
+
+    /// \brief Optional hook that is called right before directory node destruction.
+    watcher_directory_hook_t directory_destroyed;
+
+    /// \brief Optional hook that is called before directory content is polled.
+    watcher_directory_hook_t directory_poll_begin;
+};
+
+/// \brief Common part of watcher, implementations can store additional data right after it.
+struct watcher_t
+{
+    struct watcher_t *next_watcher;
+    struct watcher_directory_node_t *root_directory;
+    struct kan_atomic_int_t event_queue_lock;
+    struct kan_event_queue_t event_queue;
+    struct kan_atomic_int_t status;
+    const struct watcher_hooks_t *hooks;
+
+    /// \details Stores initial path by default. Used by recursive algorithms to store current recurrent path.
+    struct kan_file_system_path_container_t path_container;
+};
+
+struct watcher_common_statics_t
+{
+    kan_allocation_group_t watcher_allocation_group;
+    kan_allocation_group_t hierarchy_allocation_group;
+    kan_allocation_group_t event_allocation_group;
+};
+
+extern struct watcher_common_statics_t kan_file_system_watcher_common_statics;
+
+/// \brief Initializes allocation groups, must be called by implementation before creating watchers.
+void kan_file_system_watcher_common_ensure_statics_initialized (void);
+
+/// \brief Initializes common part of the watcher. Snapshot is not created until initial poll.
+void kan_file_system_watcher_common_init (struct watcher_t *watcher,
+                                          const char *directory_path,
+                                          const struct watcher_hooks_t *hooks);
+
+/// \brief Creates snapshot of the whole watched directory tree without sending any events.
+void kan_file_system_watcher_common_initial_poll (struct watcher_t *watcher);
+
+/// \brief Polls given directory, updates its snapshot and sends events for the changes.
+/// \details Path container must hold path to given directory. When recursive is false, already known child
+///          directories are not polled, but new child directories are always polled recursively as they have no
+///          snapshot yet.
+void kan_file_system_watcher_common_poll (struct watcher_t *watcher,
+                                          struct watcher_directory_node_t *directory,
+                                          bool recursive);
+
+/// \brief Destroys snapshot and pending events. Watcher memory itself is owned by implementation.
+void kan_file_system_watcher_common_shutdown (struct watcher_t *watcher);
+
+KAN_C_HEADER_END
@@ -0,0 +1,557 @@
+#define KAN_FILE_SYSTEM_WATCHER_IMPLEMENTATION
+
+#include <errno.h>
+#include <poll.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <kan/container/hash_storage.h>
+#include <kan/error/critical.h>
+#include <kan/file_system_watcher/watcher_common.h>
+#include <kan/log/logging.h>
+#include <kan/memory/allocation.h>
+#include <kan/threading/atomic.h>
+#include <kan/threading/thread.h>
+
+KAN_LOG_DEFINE_CATEGORY (file_system_watcher_linux);
+
+// Watcher uses the same snapshot and polling logic as user level implementation, because watcher API requires events
+// to be the diff between updates. But instead of polling the whole tree on every update, inotify is used to mark
+// directories that might have changed and only these directories are polled during update. inotify events are
+// generated synchronously by the kernel during file system operations, therefore draining inotify queue right before
+// the update guarantees that all the changes that happened before update request are taken into account.
+
+struct linux_directory_node_t
+{
+    /// \brief Common directory data, must be the first field as common logic allocates and casts directory nodes.
+    struct watcher_directory_node_t base;
+
+    /// \brief Node in watch descriptor to directory mapping. Only used when watch descriptor is valid.
+    struct kan_hash_storage_node_t watch_node;
+
+    int watch_descriptor;
+
+    /// \brief Direct content of this directory might have been changed and needs to be polled.
+    bool dirty;
+
+    /// \brief Some of the children directories are dirty.
+    bool has_dirty_children;
+};
+
+#define LINUX_DIRECTORY_FROM_WATCH_NODE(NODE)                                                                         \
+    ((struct linux_directory_node_t *) (((uint8_t *) (NODE)) - offsetof (struct linux_directory_node_t, watch_node)))
+
+/// \brief Mask of inotify events that might change directory content from watcher point of view.
+#define WATCH_MASK                                                                                                     \
+    (IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF |   \
+     IN_MOVE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK)
+
+struct linux_watcher_t
+{
+    /// \brief Common watcher data, must be the first field as watcher handle points to it.
+    struct watcher_t base;
+
+    /// \brief Inotify instance descriptor or -1 if inotify is not available for this watcher.
+    int inotify_descriptor;
+
+    /// \brief Maps watch descriptors to directory nodes.
+    struct kan_hash_storage_t watches;
+
+    /// \brief If true, whole tree must be polled during next update, for example due to inotify queue overflow.
+    bool full_poll_needed;
+
+    /// \brief Set when watch cannot be added, for example due to system watch limit.
+    ///        Whole tree is polled during every update in this case as we cannot trust inotify anymore.
+    bool always_full_poll;
+};
+
+static bool statics_initialized = false;
+static struct kan_atomic_int_t statics_initialization_lock = {.value = 0};
+
+static struct kan_atomic_int_t server_thread_access_lock = {0};
+static kan_thread_t server_thread = KAN_HANDLE_INITIALIZE_INVALID;
+static struct linux_watcher_t *serve_queue = NULL;
+static kan_instance_size_t serve_queue_size = 0u;
+
+/// \brief Event file descriptor that is used to wake up server thread when there is work for it.
+static int server_wake_up_descriptor = -1;
+
+// Atomic for the rare cases when server thread was already killed,
+// but wasn't able to lift access lock due to being killed.
+static struct kan_atomic_int_t server_shutting_down = {0};
+
+static void wake_up_server_thread (void)
+{
+    if (server_wake_up_descriptor != -1)
+    {
+        const uint64_t value = 1u;
+        if (write (server_wake_up_descriptor, &value, sizeof (value)) != sizeof (value) && errno != EAGAIN)
+        {
+            KAN_LOG (file_system_watcher_linux, KAN_LOG_ERROR, "Failed to wake up server thread: %s.",
+                     strerror (errno))
+        }
+    }
+}
+
+static void shutdown_server_thread (void)
+{
+    kan_atomic_int_set (&server_shutting_down, 1);
+    if (KAN_HANDLE_IS_VALID (server_thread))
+    {
+        wake_up_server_thread ();
+        kan_thread_wait (server_thread);
+    }
+
+    if (server_wake_up_descriptor != -1)
+    {
+        close (server_wake_up_descriptor);
+    }
+}
+
+static void ensure_statics_initialized (void)
+{
+    if (!statics_initialized)
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK (&statics_initialization_lock)
+        if (!statics_initialized)
+        {
+            kan_file_system_watcher_common_ensure_statics_initialized ();
+            server_wake_up_descriptor = eventfd (0u, EFD_CLOEXEC | EFD_NONBLOCK);
+
+            if (server_wake_up_descriptor == -1)
+            {
+                KAN_LOG (file_system_watcher_linux, KAN_LOG_ERROR, "Failed to create server wake up event: %s.",
+                         strerror (errno))
+            }
+
+            atexit (shutdown_server_thread);
+            statics_initialized = true;
+        }
+    }
+}
+
+static inline struct linux_directory_node_t *watcher_find_directory_by_watch (struct linux_watcher_t *watcher,
+                                                                              int watch_descriptor)
+{
+    const struct kan_hash_storage_bucket_t *bucket =
+        kan_hash_storage_query (&watcher->watches, (kan_hash_t) watch_descriptor);
+    struct kan_hash_storage_node_t *node = (struct kan_hash_storage_node_t *) bucket->first;
+    const struct kan_hash_storage_node_t *node_end =
+        (struct kan_hash_storage_node_t *) (bucket->last ? bucket->last->next : NULL);
+
+    while (node != node_end)
+    {
+        struct linux_directory_node_t *directory = LINUX_DIRECTORY_FROM_WATCH_NODE (node);
+        if (directory->watch_descriptor == watch_descriptor)
+        {
+            return directory;
+        }
+
+        node = (struct kan_hash_storage_node_t *) node->list_node.next;
+    }
+
+    return NULL;
+}
+
+static void linux_directory_created (struct watcher_t *common_watcher, struct watcher_directory_node_t *common_node)
+{
+    // Path container holds path to given directory. Watch is added before the first poll of the new directory,
+    // so changes that happen during polling are not lost.
+    struct linux_watcher_t *watcher = (struct linux_watcher_t *) common_watcher;
+    struct linux_directory_node_t *node = (struct linux_directory_node_t *) common_node;
+    node->watch_descriptor = -1;
+    node->dirty = false;
+    node->has_dirty_children = false;
+
+    if (watcher->inotify_descriptor == -1)
+    {
+        return;
+    }
+
+    const int watch_descriptor =
+        inotify_add_watch (watcher->inotify_descriptor, watcher->base.path_container.path, WATCH_MASK);
+
+    if (watch_descriptor == -1)
+    {
+        if (!watcher->always_full_poll)
+        {
+            KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, file_system_watcher_linux, KAN_LOG_WARNING,
+                                 "Unable to watch directory \"%s\" (%s), watcher will poll whole tree on every update.",
+                                 watcher->base.path_container.path, strerror (errno))
+            watcher->always_full_poll = true;
+        }
+
+        return;
+    }
+
+    // Inotify returns the same watch descriptor for the same inode, which can happen when directory was moved
+    // inside watched tree and its old node was not yet removed. New node takes ownership of the watch in this case.
+    struct linux_directory_node_t *old_owner = watcher_find_directory_by_watch (watcher, watch_descriptor);
+    if (old_owner)
+    {
+        kan_hash_storage_remove (&watcher->watches, &old_owner->watch_node);
+        old_owner->watch_descriptor = -1;
+    }
+
+    node->watch_descriptor = watch_descriptor;
+    node->watch_node.hash = (kan_hash_t) watch_descriptor;
+    kan_hash_storage_update_bucket_count_default (&watcher->watches, KAN_FILE_SYSTEM_WATCHER_LINUX_WATCH_BUCKETS);
+    kan_hash_storage_add (&watcher->watches, &node->watch_node);
+}
+
+static void linux_directory_destroyed (struct watcher_t *common_watcher, struct watcher_directory_node_t *common_node)
+{
+    struct linux_watcher_t *watcher = (struct linux_watcher_t *) common_watcher;
+    struct linux_directory_node_t *node = (struct linux_directory_node_t *) common_node;
+
+    if (node->watch_descriptor != -1)
+    {
+        kan_hash_storage_remove (&watcher->watches, &node->watch_node);
+        // Watch might be already removed by kernel if directory was deleted, therefore errors are ignored.
+        inotify_rm_watch (watcher->inotify_descriptor, node->watch_descriptor);
+    }
+}
+
+static void linux_directory_poll_begin (struct watcher_t *common_watcher, struct watcher_directory_node_t *common_node)
+{
+    ((struct linux_directory_node_t *) common_node)->dirty = false;
+}
+
+static const struct watcher_hooks_t linux_hooks = {
+    .directory_node_size = sizeof (struct linux_directory_node_t),
+    .directory_created = linux_directory_created,
+    .directory_destroyed = linux_directory_destroyed,
+    .directory_poll_begin = linux_directory_poll_begin,
+};
+
+static void update_dirty_directories_recursive (struct linux_watcher_t *watcher,
+                                                struct linux_directory_node_t *directory)
+{
+    // We assume that path container holds path to given directory.
+    if (directory->dirty)
+    {
+        kan_file_system_watcher_common_poll (&watcher->base, &directory->base, false);
+    }
+
+    if (directory->has_dirty_children)
+    {
+        directory->has_dirty_children = false;
+        struct linux_directory_node_t *child_directory =
+            (struct linux_directory_node_t *) directory->base.first_child_directory;
+
+        while (child_directory)
+        {
+            if (child_directory->dirty || child_directory->has_dirty_children)
+            {
+                const kan_instance_size_t length_backup = watcher->base.path_container.length;
+                kan_file_system_path_container_append (&watcher->base.path_container, child_directory->base.name);
+                update_dirty_directories_recursive (watcher, child_directory);
+                kan_file_system_path_container_reset_length (&watcher->base.path_container, length_backup);
+            }
+
+            child_directory = (struct linux_directory_node_t *) child_directory->base.next_on_level_directory;
+        }
+    }
+}
+
+static inline void mark_directory_dirty (struct linux_directory_node_t *directory)
+{
+    directory->dirty = true;
+    struct linux_directory_node_t *parent = (struct linux_directory_node_t *) directory->base.parent;
+
+    while (parent && !parent->has_dirty_children)
+    {
+        parent->has_dirty_children = true;
+        parent = (struct linux_directory_node_t *) parent->base.parent;
+    }
+}
+
+static void watcher_drain_inotify_events (struct linux_watcher_t *watcher)
+{
+    if (watcher->inotify_descriptor == -1)
+    {
+        return;
+    }
+
+    alignas (struct inotify_event) uint8_t buffer[KAN_FILE_SYSTEM_WATCHER_LINUX_EVENT_BUFFER];
+    while (true)
+    {
+        const ssize_t read_size = read (watcher->inotify_descriptor, buffer, sizeof (buffer));
+        if (read_size <= 0)
+        {
+            if (read_size < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (read_size < 0 && errno != EAGAIN)
+            {
+                KAN_LOG (file_system_watcher_linux, KAN_LOG_ERROR, "Failed to read inotify events: %s.",
+                         strerror (errno))
+                watcher->full_poll_needed = true;
+            }
+
+            return;
+        }
+
+        const uint8_t *event_data = buffer;
+        const uint8_t *end = buffer + read_size;
+
+        while (event_data < end)
+        {
+            const struct inotify_event *event = (const struct inotify_event *) event_data;
+            event_data += sizeof (struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                watcher->full_poll_needed = true;
+                continue;
+            }
+
+            struct linux_directory_node_t *directory = watcher_find_directory_by_watch (watcher, event->wd);
+            if (!directory)
+            {
+                // Events for already removed watches.
+                continue;
+            }
+
+            if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))
+            {
+                // Directory itself is gone from its place, its parent needs to be polled in order to remove it.
+                if (directory->base.parent)
+                {
+                    mark_directory_dirty ((struct linux_directory_node_t *) directory->base.parent);
+                }
+                else
+                {
+                    watcher->full_poll_needed = true;
+                }
+
+                if (event->mask & IN_IGNORED)
+                {
+                    kan_hash_storage_remove (&watcher->watches, &directory->watch_node);
+                    directory->watch_descriptor = -1;
+                }
+
+                continue;
+            }
+
+            mark_directory_dirty (directory);
+        }
+    }
+}
+
+static void watcher_update (struct linux_watcher_t *watcher)
+{
+    // Kernel generates inotify events synchronously with file system operations,
+    // therefore after draining we know about every change that happened before update request.
+    watcher_drain_inotify_events (watcher);
+
+    if (watcher->inotify_descriptor == -1 || watcher->always_full_poll || watcher->full_poll_needed)
+    {
+        watcher->full_poll_needed = false;
+        kan_file_system_watcher_common_poll (&watcher->base, watcher->base.root_directory, true);
+        return;
+    }
+
+    update_dirty_directories_recursive (watcher, (struct linux_directory_node_t *) watcher->base.root_directory);
+}
+
+static void destroy_watcher (struct linux_watcher_t *watcher)
+{
+    kan_file_system_watcher_common_shutdown (&watcher->base);
+    kan_hash_storage_shutdown (&watcher->watches);
+
+    if (watcher->inotify_descriptor != -1)
+    {
+        close (watcher->inotify_descriptor);
+    }
+
+    kan_free_general (kan_file_system_watcher_common_statics.watcher_allocation_group, watcher,
+                      sizeof (struct linux_watcher_t));
+}
+
+static int server_thread_function (void *user_data)
+{
+    struct pollfd *poll_descriptors = NULL;
+    kan_instance_size_t poll_descriptors_capacity = 0u;
+
+    while (true)
+    {
+        struct linux_watcher_t *last_serve_queue;
+        kan_instance_size_t poll_descriptors_count = 1u;
+
+        {
+            KAN_ATOMIC_INT_SCOPED_LOCK (&server_thread_access_lock)
+            if (kan_atomic_int_get (&server_shutting_down))
+            {
+                if (poll_descriptors)
+                {
+                    kan_free_general (kan_file_system_watcher_common_statics.watcher_allocation_group, poll_descriptors,
+                                      sizeof (struct pollfd) * poll_descriptors_capacity);
+                }
+
+                return 0;
+            }
+
+            struct linux_watcher_t *previous = NULL;
+            struct linux_watcher_t *watcher = serve_queue;
+
+            while (watcher)
+            {
+                struct linux_watcher_t *next = (struct linux_watcher_t *) watcher->base.next_watcher;
+                if (kan_atomic_int_get (&watcher->base.status) == WATCHER_STATUS_WAITING_DESTROY)
+                {
+                    destroy_watcher (watcher);
+                    --serve_queue_size;
+
+                    if (previous)
+                    {
+                        previous->base.next_watcher = (struct watcher_t *) next;
+                    }
+                    else
+                    {
+                        serve_queue = next;
+                    }
+                }
+                else
+                {
+                    previous = watcher;
+                }
+
+                watcher = next;
+            }
+
+            last_serve_queue = serve_queue;
+            if (serve_queue_size + 1u > poll_descriptors_capacity)
+            {
+                if (poll_descriptors)
+                {
+                    kan_free_general (kan_file_system_watcher_common_statics.watcher_allocation_group, poll_descriptors,
+                                      sizeof (struct pollfd) * poll_descriptors_capacity);
+                }
+
+                poll_descriptors_capacity = serve_queue_size + 1u;
+                poll_descriptors = kan_allocate_general (
+                    kan_file_system_watcher_common_statics.watcher_allocation_group,
+                    sizeof (struct pollfd) * poll_descriptors_capacity, alignof (struct pollfd));
+            }
+        }
+
+        // We've captured serve queue value and there is no one who changes next pointers.
+        // Therefore, we can safely iterate and serve watchers.
+        struct linux_watcher_t *watcher = last_serve_queue;
+
+        while (watcher)
+        {
+            KAN_ASSERT (watcher->base.root_directory)
+            switch (kan_atomic_int_get (&watcher->base.status))
+            {
+            case WATCHER_STATUS_WAITING_UPDATE:
+                watcher_update (watcher);
+                // Update status can be overridden by destroy, we should not override destroy status.
+                kan_atomic_int_compare_and_set (&watcher->base.status, WATCHER_STATUS_WAITING_UPDATE,
+                                                WATCHER_STATUS_IDLE);
+                break;
+
+            default:
+                // Drain events even when update is not requested in order to avoid queue overflow.
+                watcher_drain_inotify_events (watcher);
+                break;
+            }
+
+            if (watcher->inotify_descriptor != -1)
+            {
+                poll_descriptors[poll_descriptors_count].fd = watcher->inotify_descriptor;
+                poll_descriptors[poll_descriptors_count].events = POLLIN;
+                poll_descriptors[poll_descriptors_count].revents = 0;
+                ++poll_descriptors_count;
+            }
+
+            watcher = (struct linux_watcher_t *) watcher->base.next_watcher;
+        }
+
+        // Sleep until there are new inotify events or until we're woken up due to update request or watcher change.
+        poll_descriptors[0u].fd = server_wake_up_descriptor;
+        poll_descriptors[0u].events = POLLIN;
+        poll_descriptors[0u].revents = 0;
+
+        if (poll (poll_descriptors, poll_descriptors_count, -1) < 0 && errno != EINTR)
+        {
+            KAN_LOG (file_system_watcher_linux, KAN_LOG_ERROR, "Failed to poll for file system events: %s.",
+                     strerror (errno))
+        }
+
+        if (poll_descriptors[0u].revents & POLLIN)
+        {
+            uint64_t value;
+            if (read (server_wake_up_descriptor, &value, sizeof (value)) < 0 && errno != EAGAIN)
+            {
+                KAN_LOG (file_system_watcher_linux, KAN_LOG_ERROR, "Failed to consume wake up event: %s.",
+                         strerror (errno))
+            }
+        }
+    }
+}
+
+static void register_new_watcher (struct linux_watcher_t *watcher)
+{
+    KAN_ATOMIC_INT_SCOPED_LOCK (&server_thread_access_lock)
+    watcher->base.next_watcher = (struct watcher_t *) serve_queue;
+    serve_queue = watcher;
+    ++serve_queue_size;
+
+    if (!KAN_HANDLE_IS_VALID (server_thread))
+    {
+        server_thread = kan_thread_create ("file_system_watcher_server", server_thread_function, NULL);
+    }
+
+    wake_up_server_thread ();
+}
+
+kan_file_system_watcher_t kan_file_system_watcher_create (const char *directory_path)
+{
+    ensure_statics_initialized ();
+    struct linux_watcher_t *watcher_data =
+        kan_allocate_general (kan_file_system_watcher_common_statics.watcher_allocation_group,
+                              sizeof (struct linux_watcher_t), alignof (struct linux_watcher_t));
+
+    kan_file_system_watcher_common_init (&watcher_data->base, directory_path, &linux_hooks);
+    kan_hash_storage_init (&watcher_data->watches, kan_file_system_watcher_common_statics.hierarchy_allocation_group,
+                           KAN_FILE_SYSTEM_WATCHER_LINUX_WATCH_BUCKETS);
+    watcher_data->full_poll_needed = false;
+    watcher_data->always_full_poll = false;
+
+    watcher_data->inotify_descriptor = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+    if (watcher_data->inotify_descriptor == -1)
+    {
+        KAN_LOG (file_system_watcher_linux, KAN_LOG_WARNING,
+                 "Unable to create inotify instance for \"%s\" (%s), watcher will poll whole tree on every update.",
+                 directory_path, strerror (errno))
+    }
+
+    // Initial poll is done right away for the same reason as in user level implementation: otherwise there is
+    // a window between watcher creation and initial poll where new files would be considered already existing.
+    kan_file_system_watcher_common_initial_poll (&watcher_data->base);
+
+    register_new_watcher (watcher_data);
+    return KAN_HANDLE_SET (kan_file_system_watcher_t, &watcher_data->base);
+}
+
+void kan_file_system_watcher_mark_for_update (kan_file_system_watcher_t watcher)
+{
+    struct watcher_t *data = KAN_HANDLE_GET (watcher);
+    kan_atomic_int_set (&data->status, WATCHER_STATUS_WAITING_UPDATE);
+    wake_up_server_thread ();
+}
+
+void kan_file_system_watcher_destroy (kan_file_system_watcher_t watcher)
+{
+    struct watcher_t *data = KAN_HANDLE_GET (watcher);
+    kan_atomic_int_set (&data->status, WATCHER_STATUS_WAITING_DESTROY);
+    wake_up_server_thread ();
+}
@@ -145,17 +145,17 @@ bool kan_file_system_query_entry (const char *path, struct kan_file_system_entry
             size.LowPart = win32_status.nFileSizeLow;
             size.HighPart = (LONG) win32_status.nFileSizeHigh;
             status->size = (kan_file_size_t) size.QuadPart;
+        }
 
-            // Unfortunately, there is no better way to convert Windows file time to
-            // Unix-like time than to do it manually.
+        // Unfortunately, there is no better way to convert Windows file time to
+        // Unix-like time than to do it manually.
 #define WINDOWS_TICKS_IN_SECOND 10000000LL
 #define SEC_TO_UNIX_EPOCH 11644473600LL
-            long long windows_ticks = (((long long) win32_status.ftLastWriteTime.dwHighDateTime) << 32u) |
-                                      win32_status.ftLastWriteTime.dwLowDateTime;
-            long long unix_like_time_ns =
-                (windows_ticks - SEC_TO_UNIX_EPOCH * WINDOWS_TICKS_IN_SECOND) * (1000000000u / WINDOWS_TICKS_IN_SECOND);
-            status->last_modification_time_ns = (kan_time_size_t) unix_like_time_ns;
-        }
+        long long windows_ticks = (((long long) win32_status.ftLastWriteTime.dwHighDateTime) << 32u) |
+                                  win32_status.ftLastWriteTime.dwLowDateTime;
+        long long unix_like_time_ns =
+            (windows_ticks - SEC_TO_UNIX_EPOCH * WINDOWS_TICKS_IN_SECOND) * (1000000000u / WINDOWS_TICKS_IN_SECOND);
+        status->last_modification_time_ns = (kan_time_size_t) unix_like_time_ns;
 
         status->read_only = (win32_status.dwFileAttributes & FILE_ATTRIBUTE_READONLY) ? true : false;
         return true;
@@ -198,6 +198,32 @@ bool kan_file_system_remove_file (const char *path)
     return false;
 }
 
+bool kan_file_system_touch_file (const char *path)
+{
+    HANDLE file = CreateFile (path, FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        KAN_LOG (file_system_win32, KAN_LOG_ERROR, "Failed to open file \"%s\" for touch: error code %lu.", path,
+                 (unsigned long) GetLastError ())
+        return false;
+    }
+
+    FILETIME current_time;
+    GetSystemTimeAsFileTime (&current_time);
+    const bool result = SetFileTime (file, NULL, NULL, &current_time);
+    CloseHandle (file);
+
+    if (!result)
+    {
+        KAN_LOG (file_system_win32, KAN_LOG_ERROR, "Failed to touch file \"%s\": error code %lu.", path,
+                 (unsigned long) GetLastError ())
+    }
+
+    return result;
+}
+
 bool kan_file_system_make_directory (const char *path)
 {
     if (CreateDirectory (path, NULL) ||
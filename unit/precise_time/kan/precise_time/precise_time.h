@@ -18,6 +18,10 @@ PRECISE_TIME_API kan_time_size_t kan_precise_time_get_elapsed_nanoseconds (void)
 /// \brief Returns count of nanoseconds since Unix epoch in nanoseconds in UTC zone.
 PRECISE_TIME_API kan_time_size_t kan_precise_time_get_epoch_nanoseconds_utc (void);
 
+/// \brief Returns count of nanoseconds of CPU time that was consumed by the calling thread.
+/// \details Returns zero if it is not possible to query thread CPU time on current platform.
+PRECISE_TIME_API kan_time_size_t kan_precise_time_get_thread_cpu_nanoseconds (void);
+
 /// \brief Transfers current thread to sleeping state for given amount of nanoseconds.
 PRECISE_TIME_API void kan_precise_time_sleep (kan_time_offset_t nanoseconds);
 
@@ -1,6 +1,13 @@
 #include <SDL3/SDL_time.h>
 #include <SDL3/SDL_timer.h>
 
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    include <windows.h>
+#else
+#    include <time.h>
+#endif
+
 #include <kan/api_common/core_types.h>
 #include <kan/log/logging.h>
 #include <kan/precise_time/precise_time.h>
@@ -21,4 +28,33 @@ kan_time_size_t kan_precise_time_get_epoch_nanoseconds_utc (void)
     return 0u;
 }
 
+kan_time_size_t kan_precise_time_get_thread_cpu_nanoseconds (void)
+{
+    // SDL does not provide thread CPU time, therefore we need to use platform API directly.
+#if defined(_WIN32)
+    FILETIME creation_time;
+    FILETIME exit_time;
+    FILETIME kernel_time;
+    FILETIME user_time;
+
+    if (!GetThreadTimes (GetCurrentThread (), &creation_time, &exit_time, &kernel_time, &user_time))
+    {
+        return 0u;
+    }
+
+    // File time is measured in 100 nanosecond intervals.
+    const kan_time_size_t kernel = ((kan_time_size_t) kernel_time.dwHighDateTime << 32u) | kernel_time.dwLowDateTime;
+    const kan_time_size_t user = ((kan_time_size_t) user_time.dwHighDateTime << 32u) | user_time.dwLowDateTime;
+    return (kernel + user) * 100u;
+#else
+    struct timespec time;
+    if (clock_gettime (CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+    {
+        return 0u;
+    }
+
+    return ((kan_time_size_t) time.tv_sec) * 1000000000u + (kan_time_size_t) time.tv_nsec;
+#endif
+}
+
 void kan_precise_time_sleep (kan_time_offset_t nanoseconds) { SDL_DelayNS (nanoseconds); }
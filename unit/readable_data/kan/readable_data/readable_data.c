@@ -12,6 +12,11 @@
 #include <kan/readable_data/readable_data.h>
 #include <kan/threading/atomic.h>
 
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#    define READABLE_DATA_USE_SSE2
+#    include <emmintrin.h>
+#endif
+
 KAN_LOG_DEFINE_CATEGORY (readable_data);
 
 struct re2c_tags_t
@@ -21,6 +26,7 @@ struct re2c_tags_t
 
 struct parser_t
 {
+    /// \brief Stream from which input is read by chunks or NULL if whole input is already in the input buffer.
     struct kan_stream_t *stream;
     struct kan_stack_group_allocator_t temporary_allocator;
     struct kan_readable_data_event_t current_event;
@@ -43,7 +49,11 @@ struct parser_t
     size_t opened_blocks;
     struct re2c_tags_t tags;
 
-    char input_buffer[KAN_READABLE_DATA_PARSE_INPUT_BUFFER_SIZE];
+    /// \brief Beginning of the input buffer: either owned buffer or buffer provided by user.
+    char *input_buffer;
+
+    /// \brief Size of the input buffer allocation if it is owned by parser, zero otherwise.
+    kan_instance_size_t owned_input_buffer_size;
 };
 
 struct emitter_t
@@ -166,6 +176,146 @@ static inline void re2c_restore_saved_cursor (struct parser_t *parser)
     parser->cursor_symbol = parser->saved_symbol;
 }
 
+static inline bool is_separator (char symbol)
+{
+    return symbol == ' ' || (symbol >= '\t' && symbol <= '\r');
+}
+
+/// \brief Skips separators in currently available input without going through lexer state machine.
+/// \details Separators are usually the most common symbols in readable data, because of indentation, therefore
+///          skipping them in bulk saves significant amount of time.
+static inline void skip_separators_in_buffer (struct parser_t *parser)
+{
+    const char *cursor = parser->cursor;
+    const char *limit = parser->limit;
+    size_t line = parser->cursor_line;
+    size_t symbol = parser->cursor_symbol;
+
+#if defined(READABLE_DATA_USE_SSE2)
+    const __m128i space = _mm_set1_epi8 (' ');
+    const __m128i new_line = _mm_set1_epi8 ('\n');
+    const __m128i control_first = _mm_set1_epi8 ('\t');
+    const __m128i control_range = _mm_set1_epi8 ('\r' - '\t');
+
+    while (limit - cursor >= 16)
+    {
+        const __m128i chunk = _mm_loadu_si128 ((const __m128i *) cursor);
+        // Control separators are in [\t, \r] range: check it through unsigned comparison after subtraction.
+        const __m128i control_offset = _mm_sub_epi8 (chunk, control_first);
+        const __m128i control_mask = _mm_cmpeq_epi8 (_mm_min_epu8 (control_offset, control_range), control_offset);
+
+        const unsigned int separators =
+            (unsigned int) _mm_movemask_epi8 (_mm_or_si128 (_mm_cmpeq_epi8 (chunk, space), control_mask));
+        const unsigned int new_lines = (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi8 (chunk, new_line));
+
+        const unsigned int count = separators == 0xFFFFu ? 16u : (unsigned int) __builtin_ctz (~separators);
+        const unsigned int skipped_new_lines = count == 16u ? new_lines : new_lines & ((1u << count) - 1u);
+
+        if (skipped_new_lines)
+        {
+            line += (size_t) __builtin_popcount (skipped_new_lines);
+            // Symbol index is reset on new line and then incremented for new line symbol itself.
+            symbol = (size_t) (count - (31u - (unsigned int) __builtin_clz (skipped_new_lines)));
+        }
+        else
+        {
+            symbol += count;
+        }
+
+        cursor += count;
+        if (count < 16u)
+        {
+            parser->cursor = cursor;
+            parser->cursor_line = line;
+            parser->cursor_symbol = symbol;
+            return;
+        }
+    }
+#endif
+
+    while (cursor < limit && is_separator (*cursor))
+    {
+        if (*cursor == '\n')
+        {
+            ++line;
+            symbol = 0u;
+        }
+
+        ++cursor;
+        ++symbol;
+    }
+
+    parser->cursor = cursor;
+    parser->cursor_line = line;
+    parser->cursor_symbol = symbol;
+}
+
+/// \brief Skips separators and comments before the next token, refilling input buffer when needed.
+/// \details Lexer is able to skip them too, but it processes input symbol by symbol with line tracking and buffer
+///          limit checks on every symbol, which is much slower than bulk skipping.
+static void skip_separators_and_comments (struct parser_t *parser)
+{
+    while (true)
+    {
+        if (parser->limit - parser->cursor < 2)
+        {
+            // Either we need more data or we're near the end of input. Comments need at least two symbols.
+            if (parser->end_of_input_reached)
+            {
+                if (parser->cursor < parser->limit && is_separator (*parser->cursor))
+                {
+                    skip_separators_in_buffer (parser);
+                }
+
+                return;
+            }
+
+            parser->token = parser->cursor;
+            if (re2c_refill_buffer (parser) != 0)
+            {
+                return;
+            }
+
+            continue;
+        }
+
+        if (is_separator (*parser->cursor))
+        {
+            skip_separators_in_buffer (parser);
+            continue;
+        }
+
+        if (parser->cursor[0u] != '/' || parser->cursor[1u] != '/')
+        {
+            return;
+        }
+
+        const char *line_end =
+            memchr (parser->cursor + 2u, '\n', (size_t) (parser->limit - parser->cursor - 2u));
+
+        if (!line_end)
+        {
+            // Comment is not terminated in currently available input. If input has ended, lexer will report error.
+            if (parser->end_of_input_reached)
+            {
+                return;
+            }
+
+            parser->token = parser->cursor;
+            if (re2c_refill_buffer (parser) != 0)
+            {
+                return;
+            }
+
+            continue;
+        }
+
+        parser->cursor = line_end + 1u;
+        ++parser->cursor_line;
+        parser->cursor_symbol = 1u;
+    }
+}
+
 /*!re2c
  re2c:api = custom;
  re2c:api:style = free-form;
@@ -446,6 +596,7 @@ static enum kan_readable_data_parser_response_t re2c_parse_next_event (struct pa
 {
     while (true)
     {
+        skip_separators_and_comments (parser);
         parser->token = parser->cursor;
         const char *output_target_identifier_begin = NULL;
         const char *output_target_identifier_end = NULL;
@@ -576,6 +727,7 @@ static enum kan_readable_data_parser_response_t re2c_parse_first_value (struct p
 {
     while (true)
     {
+        skip_separators_and_comments (parser);
         parser->token = parser->cursor;
         const char *literal_begin = NULL;
         const char *literal_end = NULL;
@@ -638,6 +790,7 @@ static enum kan_readable_data_parser_response_t re2c_parse_next_identifier_value
 {
     while (true)
     {
+        skip_separators_and_comments (parser);
         parser->token = parser->cursor;
         const char *literal_begin = NULL;
         const char *literal_end = NULL;
@@ -674,6 +827,7 @@ static enum kan_readable_data_parser_response_t re2c_parse_next_string_value (st
 {
     while (true)
     {
+        skip_separators_and_comments (parser);
         parser->token = parser->cursor;
         const char *literal_begin = NULL;
         const char *literal_end = NULL;
@@ -710,6 +864,7 @@ static enum kan_readable_data_parser_response_t re2c_parse_next_integer_value (s
 {
     while (true)
     {
+        skip_separators_and_comments (parser);
         parser->token = parser->cursor;
         const char *literal_begin = NULL;
         const char *literal_end = NULL;
@@ -746,6 +901,7 @@ static enum kan_readable_data_parser_response_t re2c_parse_next_floating_value (
 {
     while (true)
     {
+        skip_separators_and_comments (parser);
         parser->token = parser->cursor;
         const char *literal_begin = NULL;
         const char *literal_end = NULL;
@@ -778,35 +934,95 @@ static enum kan_readable_data_parser_response_t re2c_parse_next_floating_value (
     }
 }
 
-kan_readable_data_parser_t kan_readable_data_parser_create (struct kan_stream_t *input_stream)
+static struct parser_t *parser_allocate (void)
 {
     ensure_statics_initialized ();
-    KAN_ASSERT (kan_stream_is_readable (input_stream))
-
     struct parser_t *parser = (struct parser_t *) kan_allocate_general (
         readable_data_allocation_group, sizeof (struct parser_t), alignof (struct parser_t));
 
-    parser->stream = input_stream;
+    parser->stream = NULL;
     kan_stack_group_allocator_init (&parser->temporary_allocator, readable_data_temporary_allocation_group,
                                     KAN_READABLE_DATA_PARSE_TEMPORARY_ALLOCATOR_SIZE);
 
-    parser->limit = parser->input_buffer + KAN_READABLE_DATA_PARSE_INPUT_BUFFER_SIZE - 1u;
-    parser->cursor = parser->input_buffer + KAN_READABLE_DATA_PARSE_INPUT_BUFFER_SIZE - 1u;
-    parser->marker = parser->input_buffer + KAN_READABLE_DATA_PARSE_INPUT_BUFFER_SIZE - 1u;
-    parser->token = parser->input_buffer + KAN_READABLE_DATA_PARSE_INPUT_BUFFER_SIZE - 1u;
-    *parser->limit = '\0';
-
     parser->end_of_input_reached = false;
     parser->cursor_line = 1u;
     parser->cursor_symbol = 1u;
     parser->marker_line = 1u;
     parser->marker_symbol = 1u;
+    parser->saved_line = 1u;
+    parser->saved_symbol = 1u;
+
+    parser->opened_blocks = 0u;
+    parser->input_buffer = NULL;
+    parser->owned_input_buffer_size = 0u;
+    return parser;
+}
+
+static inline void parser_set_whole_input (struct parser_t *parser, char *begin, char *end)
+{
+    parser->input_buffer = begin;
+    parser->limit = end;
+    parser->cursor = begin;
+    parser->marker = begin;
+    parser->token = begin;
+    parser->saved = begin;
+
+    // Whole input is available, therefore refill is never needed.
+    parser->end_of_input_reached = true;
+}
+
+kan_readable_data_parser_t kan_readable_data_parser_create (struct kan_stream_t *input_stream)
+{
+    KAN_ASSERT (kan_stream_is_readable (input_stream))
+    struct parser_t *parser = parser_allocate ();
+
+    if (kan_stream_is_random_access (input_stream))
+    {
+        // When size of the remaining input is known and is small enough, we read it all at once and parse it without
+        // refills: it removes buffer shifting and lets skipping logic to process input in bulk.
+        const kan_file_size_t position = input_stream->operations->tell (input_stream);
+        if (input_stream->operations->seek (input_stream, KAN_STREAM_SEEK_END, 0))
+        {
+            const kan_file_size_t end = input_stream->operations->tell (input_stream);
+            const bool restored =
+                input_stream->operations->seek (input_stream, KAN_STREAM_SEEK_START, (kan_file_offset_t) position);
+            KAN_ASSERT (restored)
+
+            if (restored && end >= position && end - position <= KAN_READABLE_DATA_PARSE_WHOLE_INPUT_MAX_SIZE)
+            {
+                parser->owned_input_buffer_size = (kan_instance_size_t) (end - position) + 1u;
+                parser->input_buffer = kan_allocate_general (readable_data_allocation_group,
+                                                             parser->owned_input_buffer_size, alignof (char));
+
+                const kan_file_size_t read = input_stream->operations->read (
+                    input_stream, parser->owned_input_buffer_size - 1u, parser->input_buffer);
+                parser->input_buffer[read] = '\0';
+                parser_set_whole_input (parser, parser->input_buffer, parser->input_buffer + read);
+                return KAN_HANDLE_SET (kan_readable_data_parser_t, parser);
+            }
+        }
+    }
 
+    parser->stream = input_stream;
+    parser->owned_input_buffer_size = KAN_READABLE_DATA_PARSE_INPUT_BUFFER_SIZE;
+    parser->input_buffer =
+        kan_allocate_general (readable_data_allocation_group, parser->owned_input_buffer_size, alignof (char));
+
+    parser->limit = parser->input_buffer + KAN_READABLE_DATA_PARSE_INPUT_BUFFER_SIZE - 1u;
+    parser->cursor = parser->input_buffer + KAN_READABLE_DATA_PARSE_INPUT_BUFFER_SIZE - 1u;
+    parser->marker = parser->input_buffer + KAN_READABLE_DATA_PARSE_INPUT_BUFFER_SIZE - 1u;
+    parser->token = parser->input_buffer + KAN_READABLE_DATA_PARSE_INPUT_BUFFER_SIZE - 1u;
     parser->saved = parser->cursor;
-    parser->saved_line = parser->cursor_line;
-    parser->saved_symbol = parser->cursor_symbol;
+    *parser->limit = '\0';
+    return KAN_HANDLE_SET (kan_readable_data_parser_t, parser);
+}
 
-    parser->opened_blocks = 0u;
+kan_readable_data_parser_t kan_readable_data_parser_create_for_buffer (const char *buffer, kan_instance_size_t size)
+{
+    KAN_ASSERT (buffer[size] == '\0')
+    struct parser_t *parser = parser_allocate ();
+    // Buffer is never modified as refill is never executed for whole input.
+    parser_set_whole_input (parser, (char *) buffer, (char *) buffer + size);
     return KAN_HANDLE_SET (kan_readable_data_parser_t, parser);
 }
 
@@ -828,6 +1044,12 @@ void kan_readable_data_parser_destroy (kan_readable_data_parser_t parser)
 {
     struct parser_t *data = KAN_HANDLE_GET (parser);
     kan_stack_group_allocator_shutdown (&data->temporary_allocator);
+
+    if (data->owned_input_buffer_size > 0u)
+    {
+        kan_free_general (readable_data_allocation_group, data->input_buffer, data->owned_input_buffer_size);
+    }
+
     kan_free_general (readable_data_allocation_group, data, sizeof (struct parser_t));
 }
 
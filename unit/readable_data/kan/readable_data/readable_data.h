@@ -99,6 +99,11 @@
 /// // Destroy parser after usage.
 /// kan_readable_data_parser_destroy (parser);
 /// ```
+///
+/// When input stream is a random access stream and remaining input is not bigger than
+/// `KAN_READABLE_DATA_PARSE_WHOLE_INPUT_MAX_SIZE`, parser reads the whole input at once and parses it without refills,
+/// which is noticeably faster. `kan_readable_data_parser_create_for_buffer` can be used to parse input that is
+/// already in memory without any copying.
 /// \endparblock
 ///
 /// \par Emission
@@ -211,6 +216,12 @@ KAN_HANDLE_DEFINE (kan_readable_data_parser_t);
 /// \brief Creates new instance of readable data parser.
 READABLE_DATA_API kan_readable_data_parser_t kan_readable_data_parser_create (struct kan_stream_t *input_stream);
 
+/// \brief Creates new instance of readable data parser for input that is already fully loaded into memory.
+/// \details Buffer is not copied and must be kept alive until parser is destroyed. Symbol after the last input symbol,
+///          `buffer[size]`, must be zero terminator.
+READABLE_DATA_API kan_readable_data_parser_t kan_readable_data_parser_create_for_buffer (const char *buffer,
+                                                                                        kan_instance_size_t size);
+
 /// \brief Attempts to read next event from parser input stream.
 READABLE_DATA_API enum kan_readable_data_parser_response_t kan_readable_data_parser_step (
     kan_readable_data_parser_t parser);
@@ -99,6 +99,16 @@ REFLECTION_API void kan_reflection_struct_migrator_migrate_instance (kan_reflect
                                                                      void *source,
                                                                      void *target);
 
+/// \brief Migrates array of source instances to array of target instances of the same type. Every target instance
+///        must be properly allocated and initialized.
+/// \details Migration logic lookup and temporary data allocation are done once for the whole batch, therefore it is
+///          preferred over kan_reflection_struct_migrator_migrate_instance when a lot of instances are migrated.
+REFLECTION_API void kan_reflection_struct_migrator_migrate_instances (kan_reflection_struct_migrator_t migrator,
+                                                                      kan_interned_string_t type_name,
+                                                                      kan_instance_size_t count,
+                                                                      void **sources,
+                                                                      void **targets);
+
 /// \brief Migrates all patches from source registry to target registry.
 /// \details Patch handles are preserved the same.
 REFLECTION_API void kan_reflection_struct_migrator_migrate_patches (kan_reflection_struct_migrator_t migrator,
@@ -162,6 +162,13 @@ REFLECTION_API kan_id_32_t kan_reflection_patch_get_section_id_bound (kan_reflec
 /// \brief Applies given patch to given memory block and its child blocks through patch sections.
 REFLECTION_API void kan_reflection_patch_apply (kan_reflection_patch_t patch, void *target);
 
+/// \brief Applies given patch to every memory block from given array of targets.
+/// \details Patches without sections are applied node by node to all targets at once, so patch data is only read
+///          once. It is advised to use this function when the same patch is applied to lots of instances.
+REFLECTION_API void kan_reflection_patch_apply_batch (kan_reflection_patch_t patch,
+                                                      kan_instance_size_t count,
+                                                      void **targets);
+
 /// \brief Returns iterator that points to the first node of built patch.
 /// \details Keep in mind that during build process chunks can be optimized out and compressed.
 REFLECTION_API kan_reflection_patch_iterator_t kan_reflection_patch_begin (kan_reflection_patch_t patch);
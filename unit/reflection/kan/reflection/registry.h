@@ -34,6 +34,10 @@
 /// goal of registry is to unite reflection data into single context that can be used by other modules. Keep in mind
 /// that registry does not control lifetime of reflection data, therefore reflection data should be manually disposed
 /// when it is no longer needed (if it was allocated dynamically, for example from scripts in assets).
+///
+/// When registry population is finished, registry can be frozen using `kan_reflection_registry_freeze`. Frozen
+/// registry no longer accepts new reflection data and meta, but builds read-only perfect hash indices for its data and
+/// caches field path resolution results, which makes queries faster. Patches can still be added to frozen registry.
 /// \endparblock
 ///
 /// \par Field visibility
@@ -345,6 +349,12 @@ REFLECTION_API void kan_reflection_registry_add_function_argument_meta (kan_refl
                                                                         kan_interned_string_t meta_type_name,
                                                                         const void *meta);
 
+/// \brief Finishes registry population and prepares registry for fast read-only usage.
+/// \details Builds perfect hash indices for enums, structs, functions and all meta storages and enables caching for
+///          `kan_reflection_registry_query_local_field` results. Adding reflection data or meta to frozen registry
+///          is forbidden.
+REFLECTION_API void kan_reflection_registry_freeze (kan_reflection_registry_t registry);
+
 /// \brief Queries for enum by its name.
 REFLECTION_API const struct kan_reflection_enum_t *kan_reflection_registry_query_enum (
     kan_reflection_registry_t registry, kan_interned_string_t enum_name);
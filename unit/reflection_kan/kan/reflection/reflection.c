@@ -183,6 +183,37 @@ static_assert (alignof (struct function_argument_meta_iterator_t) ==
                    alignof (struct kan_reflection_function_argument_meta_iterator_t),
                "Iterator alignments match.");
 
+/// \brief Read-only perfect hash index over hash storage that is built when registry is frozen.
+/// \details Index uses hash and displace scheme: hash selects bucket, bucket selects seed and combination of hash and
+///          seed selects slot. Seeds are selected during build so every unique hash has its own slot, therefore
+///          lookup never walks through nodes with other hashes. Slot stores range of storage nodes that starts with
+///          the first node with slot hash, so multi-value storages like meta storages are supported as well.
+struct frozen_index_slot_t
+{
+    kan_hash_t hash;
+    struct kan_bd_list_node_t *first;
+    struct kan_bd_list_node_t *end;
+};
+
+struct frozen_index_t
+{
+    kan_instance_size_t buckets_count;
+    kan_instance_size_t slots_count;
+    kan_instance_size_t *seeds;
+    struct frozen_index_slot_t *slots;
+};
+
+struct field_path_cache_node_t
+{
+    struct kan_hash_storage_node_t node;
+    kan_interned_string_t struct_name;
+    const struct kan_reflection_field_t *field;
+    kan_instance_size_t absolute_offset;
+    kan_instance_size_t size_with_padding;
+    kan_instance_size_t path_length;
+    kan_interned_string_t path[];
+};
+
 struct registry_t
 {
     kan_allocation_group_t allocation_group;
@@ -197,6 +228,20 @@ struct registry_t
     struct kan_hash_storage_t function_argument_meta_storage;
     struct kan_atomic_int_t patch_addition_lock;
     struct compiled_patch_t *first_patch;
+
+    bool frozen;
+    struct frozen_index_t enum_index;
+    struct frozen_index_t struct_index;
+    struct frozen_index_t function_index;
+    struct frozen_index_t enum_meta_index;
+    struct frozen_index_t enum_value_meta_index;
+    struct frozen_index_t struct_meta_index;
+    struct frozen_index_t struct_field_meta_index;
+    struct frozen_index_t function_meta_index;
+    struct frozen_index_t function_argument_meta_index;
+
+    struct kan_atomic_int_t field_path_cache_lock;
+    struct kan_hash_storage_t field_path_cache;
 };
 
 struct patch_builder_section_node_t
@@ -258,6 +303,9 @@ struct compiled_patch_node_section_suffix_t
 
     /// \brief Type of the structure inside which source field was found.
     const struct kan_reflection_struct_t *source_field_struct;
+
+    /// \brief Type of dynamic array items if they are structs, resolved during build to avoid queries during apply.
+    const struct kan_reflection_struct_t *item_struct;
 };
 
 struct compiled_patch_node_data_suffix_t
@@ -285,6 +333,11 @@ struct compiled_patch_t
     const struct kan_reflection_struct_t *type;
     kan_instance_size_t node_count;
     kan_instance_size_t section_id_bound;
+
+    /// \brief True if patch contains only data nodes for the root section.
+    /// \details Such patches are just a list of memory copy spans and are applied through the fast path.
+    bool data_only;
+
     struct compiled_patch_node_t *begin;
     struct compiled_patch_node_t *end;
 
@@ -430,6 +483,10 @@ struct struct_migrator_node_t
     kan_instance_size_t conditions_count;
     struct migrator_condition_t *conditions;
     kan_instance_size_t copy_commands_count;
+
+    /// \brief Copy commands are sorted so unconditional commands go first and can be executed without any checks.
+    kan_instance_size_t copy_commands_unconditional_count;
+
     struct migrator_command_copy_t *copy_commands;
     kan_instance_size_t adapt_numeric_commands_count;
     struct migrator_command_adapt_numeric_t *adapt_numeric_commands;
@@ -462,6 +519,232 @@ static kan_allocation_group_t get_compiled_patch_allocation_group (void)
     return compiled_patch_allocation_group;
 }
 
+static inline void frozen_index_init (struct frozen_index_t *index)
+{
+    index->buckets_count = 0u;
+    index->slots_count = 0u;
+    index->seeds = NULL;
+    index->slots = NULL;
+}
+
+static void frozen_index_shutdown (struct frozen_index_t *index, kan_allocation_group_t allocation_group)
+{
+    if (index->seeds)
+    {
+        kan_free_general (allocation_group, index->seeds, sizeof (kan_instance_size_t) * index->buckets_count);
+    }
+
+    if (index->slots)
+    {
+        kan_free_general (allocation_group, index->slots, sizeof (struct frozen_index_slot_t) * index->slots_count);
+    }
+
+    frozen_index_init (index);
+}
+
+static inline kan_instance_size_t frozen_index_get_slot (kan_hash_t hash,
+                                                         kan_instance_size_t seed,
+                                                         kan_instance_size_t slots_count)
+{
+    return (kan_instance_size_t) (kan_hash_combine (hash, (kan_hash_t) seed) % slots_count);
+}
+
+static void frozen_index_build (struct frozen_index_t *index,
+                                const struct kan_hash_storage_t *storage,
+                                kan_allocation_group_t allocation_group)
+{
+    KAN_ASSERT (!index->slots)
+    if (storage->items.size == 0u)
+    {
+        // Nothing to index, regular hash storage query is used then.
+        return;
+    }
+
+    // Collect unique hashes with their node ranges. Hash storage keeps nodes of one bucket together, therefore we can
+    // find first node for every hash by scanning storage buckets.
+    struct frozen_index_slot_t *entries =
+        kan_allocate_general (allocation_group, sizeof (struct frozen_index_slot_t) * storage->items.size,
+                              alignof (struct frozen_index_slot_t));
+    kan_instance_size_t entries_count = 0u;
+
+    for (kan_loop_size_t bucket_index = 0u; bucket_index < storage->bucket_count; ++bucket_index)
+    {
+        const struct kan_hash_storage_bucket_t *bucket = &storage->buckets[bucket_index];
+        struct kan_bd_list_node_t *end = bucket->last ? bucket->last->next : NULL;
+        struct kan_bd_list_node_t *node = bucket->first;
+        const kan_instance_size_t bucket_entries_begin = entries_count;
+
+        while (node != end)
+        {
+            const kan_hash_t hash = ((struct kan_hash_storage_node_t *) node)->hash;
+            bool already_added = false;
+
+            for (kan_loop_size_t check_index = bucket_entries_begin; check_index < entries_count; ++check_index)
+            {
+                if (entries[check_index].hash == hash)
+                {
+                    already_added = true;
+                    break;
+                }
+            }
+
+            if (!already_added)
+            {
+                entries[entries_count] = (struct frozen_index_slot_t) {
+                    .hash = hash,
+                    .first = node,
+                    .end = end,
+                };
+
+                ++entries_count;
+            }
+
+            node = node->next;
+        }
+    }
+
+    index->buckets_count = entries_count / KAN_REFLECTION_FROZEN_INDEX_KEYS_PER_BUCKET + 1u;
+    // Several free slots make seed search much faster, while memory overhead is negligible for reflection data.
+    index->slots_count = entries_count + entries_count / 4u + 1u;
+
+    index->seeds = kan_allocate_general (allocation_group, sizeof (kan_instance_size_t) * index->buckets_count,
+                                         alignof (kan_instance_size_t));
+    index->slots = kan_allocate_general (allocation_group, sizeof (struct frozen_index_slot_t) * index->slots_count,
+                                         alignof (struct frozen_index_slot_t));
+
+    memset (index->seeds, 0u, sizeof (kan_instance_size_t) * index->buckets_count);
+    memset (index->slots, 0u, sizeof (struct frozen_index_slot_t) * index->slots_count);
+
+    // Seeds array is used to store bucket sizes until seeds are selected, so buckets can be sorted by size.
+    // Buckets with more entries are harder to place, therefore they're processed first.
+    for (kan_loop_size_t entry_index = 0u; entry_index < entries_count; ++entry_index)
+    {
+        ++index->seeds[entries[entry_index].hash % index->buckets_count];
+    }
+
+    {
+        struct frozen_index_slot_t temporary;
+        unsigned long sort_length = (unsigned long) entries_count;
+        const kan_instance_size_t buckets_count = index->buckets_count;
+        const kan_instance_size_t *bucket_sizes = index->seeds;
+
+#define BUCKET_OF(INDEX) (entries[INDEX].hash % buckets_count)
+#define LESS(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    (bucket_sizes[BUCKET_OF (first_index)] > bucket_sizes[BUCKET_OF (second_index)] ||                                 \
+     (bucket_sizes[BUCKET_OF (first_index)] == bucket_sizes[BUCKET_OF (second_index)] &&                               \
+      BUCKET_OF (first_index) < BUCKET_OF (second_index)))
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = entries[first_index], entries[first_index] = entries[second_index], entries[second_index] = temporary
+
+        QSORT (sort_length, LESS, SWAP);
+#undef BUCKET_OF
+#undef LESS
+#undef SWAP
+    }
+
+    kan_instance_size_t *selected_slots = kan_allocate_general (
+        allocation_group, sizeof (kan_instance_size_t) * entries_count, alignof (kan_instance_size_t));
+    kan_instance_size_t run_begin = 0u;
+    bool successful = true;
+
+    while (run_begin < entries_count)
+    {
+        const kan_instance_size_t bucket = entries[run_begin].hash % index->buckets_count;
+        kan_instance_size_t run_end = run_begin + 1u;
+
+        while (run_end < entries_count && entries[run_end].hash % index->buckets_count == bucket)
+        {
+            ++run_end;
+        }
+
+        kan_instance_size_t seed = 0u;
+        for (; seed < KAN_REFLECTION_FROZEN_INDEX_MAX_SEED; ++seed)
+        {
+            bool fits = true;
+            for (kan_loop_size_t entry_index = run_begin; entry_index < run_end && fits; ++entry_index)
+            {
+                selected_slots[entry_index] =
+                    frozen_index_get_slot (entries[entry_index].hash, seed, index->slots_count);
+                fits = !index->slots[selected_slots[entry_index]].first;
+
+                for (kan_loop_size_t check_index = run_begin; check_index < entry_index && fits; ++check_index)
+                {
+                    fits = selected_slots[check_index] != selected_slots[entry_index];
+                }
+            }
+
+            if (fits)
+            {
+                break;
+            }
+        }
+
+        if (seed == KAN_REFLECTION_FROZEN_INDEX_MAX_SEED)
+        {
+            successful = false;
+            break;
+        }
+
+        index->seeds[bucket] = seed;
+        for (kan_loop_size_t entry_index = run_begin; entry_index < run_end; ++entry_index)
+        {
+            index->slots[selected_slots[entry_index]] = entries[entry_index];
+        }
+
+        run_begin = run_end;
+    }
+
+    kan_free_general (allocation_group, selected_slots, sizeof (kan_instance_size_t) * entries_count);
+    kan_free_general (allocation_group, entries, sizeof (struct frozen_index_slot_t) * storage->items.size);
+
+    if (!successful)
+    {
+        KAN_LOG (reflection_registry, KAN_LOG_WARNING,
+                 "Failed to build frozen index for %lu unique hashes, falling back to hash storage queries.",
+                 (unsigned long) entries_count)
+        frozen_index_shutdown (index, allocation_group);
+    }
+}
+
+struct registry_query_range_t
+{
+    struct kan_bd_list_node_t *first;
+    struct kan_bd_list_node_t *end;
+};
+
+/// \brief Returns range of storage nodes that should be checked in order to find node with given hash.
+static inline struct registry_query_range_t registry_query_range (const struct frozen_index_t *index,
+                                                                  const struct kan_hash_storage_t *storage,
+                                                                  kan_hash_t hash)
+{
+    struct registry_query_range_t range;
+    if (index->slots)
+    {
+        const struct frozen_index_slot_t *slot = &index->slots[frozen_index_get_slot (
+            hash, index->seeds[hash % index->buckets_count], index->slots_count)];
+
+        if (slot->first && slot->hash == hash)
+        {
+            range.first = slot->first;
+            range.end = slot->end;
+        }
+        else
+        {
+            range.first = NULL;
+            range.end = NULL;
+        }
+
+        return range;
+    }
+
+    const struct kan_hash_storage_bucket_t *bucket = kan_hash_storage_query (storage, hash);
+    range.first = bucket->first;
+    range.end = bucket->last ? bucket->last->next : NULL;
+    return range;
+}
+
 kan_reflection_registry_t kan_reflection_registry_create (void)
 {
     const kan_allocation_group_t group =
@@ -483,6 +766,19 @@ kan_reflection_registry_t kan_reflection_registry_create (void)
     kan_hash_storage_init (&registry->function_argument_meta_storage, group,
                            KAN_REFLECTION_FUNCTION_ARGUMENT_META_INITIAL_BUCKETS);
 
+    registry->frozen = false;
+    frozen_index_init (&registry->enum_index);
+    frozen_index_init (&registry->struct_index);
+    frozen_index_init (&registry->function_index);
+    frozen_index_init (&registry->enum_meta_index);
+    frozen_index_init (&registry->enum_value_meta_index);
+    frozen_index_init (&registry->struct_meta_index);
+    frozen_index_init (&registry->struct_field_meta_index);
+    frozen_index_init (&registry->function_meta_index);
+    frozen_index_init (&registry->function_argument_meta_index);
+
+    registry->field_path_cache_lock = kan_atomic_int_init (0);
+    kan_hash_storage_init (&registry->field_path_cache, group, KAN_REFLECTION_FIELD_PATH_CACHE_INITIAL_BUCKETS);
     return KAN_HANDLE_SET (kan_reflection_registry_t, registry);
 }
 
@@ -500,6 +796,7 @@ bool kan_reflection_registry_add_enum (kan_reflection_registry_t registry,
 #endif
 
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
+    KAN_ASSERT (!registry_struct->frozen)
     struct enum_node_t *node =
         (struct enum_node_t *) kan_allocate_batched (registry_struct->allocation_group, sizeof (struct enum_node_t));
     node->node.hash = KAN_HASH_OBJECT_POINTER (enum_reflection->name);
@@ -516,6 +813,7 @@ void kan_reflection_registry_add_enum_meta (kan_reflection_registry_t registry,
                                             const void *meta)
 {
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
+    KAN_ASSERT (!registry_struct->frozen)
     struct enum_meta_node_t *node = (struct enum_meta_node_t *) kan_allocate_batched (registry_struct->allocation_group,
                                                                                       sizeof (struct enum_meta_node_t));
 
@@ -536,6 +834,7 @@ void kan_reflection_registry_add_enum_value_meta (kan_reflection_registry_t regi
                                                   const void *meta)
 {
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
+    KAN_ASSERT (!registry_struct->frozen)
     struct enum_value_meta_node_t *node = (struct enum_value_meta_node_t *) kan_allocate_batched (
         registry_struct->allocation_group, sizeof (struct enum_value_meta_node_t));
 
@@ -627,6 +926,7 @@ bool kan_reflection_registry_add_struct (kan_reflection_registry_t registry,
 #endif
 
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
+    KAN_ASSERT (!registry_struct->frozen)
     struct struct_node_t *node = (struct struct_node_t *) kan_allocate_batched (registry_struct->allocation_group,
                                                                                 sizeof (struct struct_node_t));
     node->node.hash = KAN_HASH_OBJECT_POINTER (struct_reflection->name);
@@ -644,6 +944,7 @@ void kan_reflection_registry_add_struct_meta (kan_reflection_registry_t registry
                                               const void *meta)
 {
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
+    KAN_ASSERT (!registry_struct->frozen)
     struct struct_meta_node_t *node = (struct struct_meta_node_t *) kan_allocate_batched (
         registry_struct->allocation_group, sizeof (struct struct_meta_node_t));
 
@@ -665,6 +966,7 @@ void kan_reflection_registry_add_struct_field_meta (kan_reflection_registry_t re
                                                     const void *meta)
 {
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
+    KAN_ASSERT (!registry_struct->frozen)
     struct struct_field_meta_node_t *node = (struct struct_field_meta_node_t *) kan_allocate_batched (
         registry_struct->allocation_group, sizeof (struct struct_field_meta_node_t));
 
@@ -750,6 +1052,7 @@ bool kan_reflection_registry_add_function (kan_reflection_registry_t registry,
 #endif
 
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
+    KAN_ASSERT (!registry_struct->frozen)
     struct function_node_t *node = (struct function_node_t *) kan_allocate_batched (registry_struct->allocation_group,
                                                                                     sizeof (struct function_node_t));
     node->node.hash = KAN_HASH_OBJECT_POINTER (function_reflection->name);
@@ -767,6 +1070,7 @@ void kan_reflection_registry_add_function_meta (kan_reflection_registry_t regist
                                                 const void *meta)
 {
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
+    KAN_ASSERT (!registry_struct->frozen)
     struct function_meta_node_t *node = (struct function_meta_node_t *) kan_allocate_batched (
         registry_struct->allocation_group, sizeof (struct function_meta_node_t));
 
@@ -788,6 +1092,7 @@ void kan_reflection_registry_add_function_argument_meta (kan_reflection_registry
                                                          const void *meta)
 {
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
+    KAN_ASSERT (!registry_struct->frozen)
     struct function_argument_meta_node_t *node = (struct function_argument_meta_node_t *) kan_allocate_batched (
         registry_struct->allocation_group, sizeof (struct function_argument_meta_node_t));
 
@@ -804,14 +1109,36 @@ void kan_reflection_registry_add_function_argument_meta (kan_reflection_registry
     kan_hash_storage_add (&registry_struct->function_argument_meta_storage, &node->node);
 }
 
+void kan_reflection_registry_freeze (kan_reflection_registry_t registry)
+{
+    struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
+    if (registry_struct->frozen)
+    {
+        return;
+    }
+
+    const kan_allocation_group_t group = registry_struct->allocation_group;
+    frozen_index_build (&registry_struct->enum_index, &registry_struct->enum_storage, group);
+    frozen_index_build (&registry_struct->struct_index, &registry_struct->struct_storage, group);
+    frozen_index_build (&registry_struct->function_index, &registry_struct->function_storage, group);
+    frozen_index_build (&registry_struct->enum_meta_index, &registry_struct->enum_meta_storage, group);
+    frozen_index_build (&registry_struct->enum_value_meta_index, &registry_struct->enum_value_meta_storage, group);
+    frozen_index_build (&registry_struct->struct_meta_index, &registry_struct->struct_meta_storage, group);
+    frozen_index_build (&registry_struct->struct_field_meta_index, &registry_struct->struct_field_meta_storage, group);
+    frozen_index_build (&registry_struct->function_meta_index, &registry_struct->function_meta_storage, group);
+    frozen_index_build (&registry_struct->function_argument_meta_index,
+                        &registry_struct->function_argument_meta_storage, group);
+    registry_struct->frozen = true;
+}
+
 const struct kan_reflection_enum_t *kan_reflection_registry_query_enum (kan_reflection_registry_t registry,
                                                                         kan_interned_string_t enum_name)
 {
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
-    const struct kan_hash_storage_bucket_t *bucket =
-        kan_hash_storage_query (&registry_struct->enum_storage, KAN_HASH_OBJECT_POINTER (enum_name));
-    struct enum_node_t *node = (struct enum_node_t *) bucket->first;
-    const struct enum_node_t *end = (struct enum_node_t *) (bucket->last ? bucket->last->next : NULL);
+    const struct registry_query_range_t range = registry_query_range (
+        &registry_struct->enum_index, &registry_struct->enum_storage, KAN_HASH_OBJECT_POINTER (enum_name));
+    struct enum_node_t *node = (struct enum_node_t *) range.first;
+    const struct enum_node_t *end = (struct enum_node_t *) range.end;
 
     while (node != end)
     {
@@ -832,11 +1159,12 @@ struct kan_reflection_enum_meta_iterator_t kan_reflection_registry_query_enum_me
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
     const kan_hash_t hash =
         kan_hash_combine (KAN_HASH_OBJECT_POINTER (enum_name), KAN_HASH_OBJECT_POINTER (meta_type_name));
-    const struct kan_hash_storage_bucket_t *bucket = kan_hash_storage_query (&registry_struct->enum_meta_storage, hash);
+    const struct registry_query_range_t range =
+        registry_query_range (&registry_struct->enum_meta_index, &registry_struct->enum_meta_storage, hash);
 
     struct enum_meta_iterator_t iterator = {
-        .current = (struct enum_meta_node_t *) bucket->first,
-        .end = (struct enum_meta_node_t *) (bucket->last ? bucket->last->next : NULL),
+        .current = (struct enum_meta_node_t *) range.first,
+        .end = (struct enum_meta_node_t *) range.end,
         .enum_name = enum_name,
         .meta_type_name = meta_type_name,
     };
@@ -885,12 +1213,12 @@ struct kan_reflection_enum_value_meta_iterator_t kan_reflection_registry_query_e
     const kan_hash_t hash = kan_hash_combine (
         kan_hash_combine (KAN_HASH_OBJECT_POINTER (enum_name), KAN_HASH_OBJECT_POINTER (enum_value_name)),
         KAN_HASH_OBJECT_POINTER (meta_type_name));
-    const struct kan_hash_storage_bucket_t *bucket =
-        kan_hash_storage_query (&registry_struct->enum_value_meta_storage, hash);
+    const struct registry_query_range_t range =
+        registry_query_range (&registry_struct->enum_value_meta_index, &registry_struct->enum_value_meta_storage, hash);
 
     struct enum_value_meta_iterator_t iterator = {
-        .current = (struct enum_value_meta_node_t *) bucket->first,
-        .end = (struct enum_value_meta_node_t *) (bucket->last ? bucket->last->next : NULL),
+        .current = (struct enum_value_meta_node_t *) range.first,
+        .end = (struct enum_value_meta_node_t *) range.end,
         .enum_name = enum_name,
         .enum_value_name = enum_value_name,
         .meta_type_name = meta_type_name,
@@ -937,10 +1265,10 @@ const struct kan_reflection_struct_t *kan_reflection_registry_query_struct (kan_
                                                                             kan_interned_string_t struct_name)
 {
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
-    const struct kan_hash_storage_bucket_t *bucket =
-        kan_hash_storage_query (&registry_struct->struct_storage, KAN_HASH_OBJECT_POINTER (struct_name));
-    struct struct_node_t *node = (struct struct_node_t *) bucket->first;
-    const struct struct_node_t *end = (struct struct_node_t *) (bucket->last ? bucket->last->next : NULL);
+    const struct registry_query_range_t range = registry_query_range (
+        &registry_struct->struct_index, &registry_struct->struct_storage, KAN_HASH_OBJECT_POINTER (struct_name));
+    struct struct_node_t *node = (struct struct_node_t *) range.first;
+    const struct struct_node_t *end = (struct struct_node_t *) range.end;
 
     while (node != end)
     {
@@ -961,12 +1289,12 @@ struct kan_reflection_struct_meta_iterator_t kan_reflection_registry_query_struc
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
     const kan_hash_t hash =
         kan_hash_combine (KAN_HASH_OBJECT_POINTER (struct_name), KAN_HASH_OBJECT_POINTER (meta_type_name));
-    const struct kan_hash_storage_bucket_t *bucket =
-        kan_hash_storage_query (&registry_struct->struct_meta_storage, hash);
+    const struct registry_query_range_t range =
+        registry_query_range (&registry_struct->struct_meta_index, &registry_struct->struct_meta_storage, hash);
 
     struct struct_meta_iterator_t iterator = {
-        .current = (struct struct_meta_node_t *) bucket->first,
-        .end = (struct struct_meta_node_t *) (bucket->last ? bucket->last->next : NULL),
+        .current = (struct struct_meta_node_t *) range.first,
+        .end = (struct struct_meta_node_t *) range.end,
         .struct_name = struct_name,
         .meta_type_name = meta_type_name,
     };
@@ -1015,12 +1343,12 @@ struct kan_reflection_struct_field_meta_iterator_t kan_reflection_registry_query
     const kan_hash_t hash = kan_hash_combine (
         kan_hash_combine (KAN_HASH_OBJECT_POINTER (struct_name), KAN_HASH_OBJECT_POINTER (struct_field_name)),
         KAN_HASH_OBJECT_POINTER (meta_type_name));
-    const struct kan_hash_storage_bucket_t *bucket =
-        kan_hash_storage_query (&registry_struct->struct_field_meta_storage, hash);
+    const struct registry_query_range_t range = registry_query_range (
+        &registry_struct->struct_field_meta_index, &registry_struct->struct_field_meta_storage, hash);
 
     struct struct_field_meta_iterator_t iterator = {
-        .current = (struct struct_field_meta_node_t *) bucket->first,
-        .end = (struct struct_field_meta_node_t *) (bucket->last ? bucket->last->next : NULL),
+        .current = (struct struct_field_meta_node_t *) range.first,
+        .end = (struct struct_field_meta_node_t *) range.end,
         .struct_name = struct_name,
         .struct_field_name = struct_field_name,
         .meta_type_name = meta_type_name,
@@ -1068,10 +1396,10 @@ const struct kan_reflection_function_t *kan_reflection_registry_query_function (
                                                                                 kan_interned_string_t function_name)
 {
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
-    const struct kan_hash_storage_bucket_t *bucket =
-        kan_hash_storage_query (&registry_struct->function_storage, KAN_HASH_OBJECT_POINTER (function_name));
-    struct function_node_t *node = (struct function_node_t *) bucket->first;
-    const struct function_node_t *end = (struct function_node_t *) (bucket->last ? bucket->last->next : NULL);
+    const struct registry_query_range_t range = registry_query_range (
+        &registry_struct->function_index, &registry_struct->function_storage, KAN_HASH_OBJECT_POINTER (function_name));
+    struct function_node_t *node = (struct function_node_t *) range.first;
+    const struct function_node_t *end = (struct function_node_t *) range.end;
 
     while (node != end)
     {
@@ -1092,12 +1420,12 @@ struct kan_reflection_function_meta_iterator_t kan_reflection_registry_query_fun
     struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
     const kan_hash_t hash =
         kan_hash_combine (KAN_HASH_OBJECT_POINTER (function_name), KAN_HASH_OBJECT_POINTER (meta_type_name));
-    const struct kan_hash_storage_bucket_t *bucket =
-        kan_hash_storage_query (&registry_struct->function_meta_storage, hash);
+    const struct registry_query_range_t range =
+        registry_query_range (&registry_struct->function_meta_index, &registry_struct->function_meta_storage, hash);
 
     struct function_meta_iterator_t iterator = {
-        .current = (struct function_meta_node_t *) bucket->first,
-        .end = (struct function_meta_node_t *) (bucket->last ? bucket->last->next : NULL),
+        .current = (struct function_meta_node_t *) range.first,
+        .end = (struct function_meta_node_t *) range.end,
         .function_name = function_name,
         .meta_type_name = meta_type_name,
     };
@@ -1147,12 +1475,12 @@ struct kan_reflection_function_argument_meta_iterator_t kan_reflection_registry_
     const kan_hash_t hash = kan_hash_combine (
         kan_hash_combine (KAN_HASH_OBJECT_POINTER (function_name), KAN_HASH_OBJECT_POINTER (function_argument_name)),
         KAN_HASH_OBJECT_POINTER (meta_type_name));
-    const struct kan_hash_storage_bucket_t *bucket =
-        kan_hash_storage_query (&registry_struct->function_argument_meta_storage, hash);
+    const struct registry_query_range_t range = registry_query_range (
+        &registry_struct->function_argument_meta_index, &registry_struct->function_argument_meta_storage, hash);
 
     struct function_argument_meta_iterator_t iterator = {
-        .current = (struct function_argument_meta_node_t *) bucket->first,
-        .end = (struct function_argument_meta_node_t *) (bucket->last ? bucket->last->next : NULL),
+        .current = (struct function_argument_meta_node_t *) range.first,
+        .end = (struct function_argument_meta_node_t *) range.end,
         .function_name = function_name,
         .function_argument_name = function_argument_name,
         .meta_type_name = meta_type_name,
@@ -1199,18 +1527,14 @@ void kan_reflection_function_argument_meta_iterator_next (
                                             data->current->meta_type_name != data->meta_type_name));
 }
 
-const struct kan_reflection_field_t *kan_reflection_registry_query_local_field (
+static const struct kan_reflection_field_t *registry_resolve_local_field (
     kan_reflection_registry_t registry,
     kan_interned_string_t struct_name,
     kan_instance_size_t path_length,
     kan_interned_string_t *path,
     kan_instance_size_t *absolute_offset_output,
     kan_instance_size_t *size_with_padding_output)
-
 {
-    KAN_ASSERT (path_length > 0u)
-    KAN_ASSERT (absolute_offset_output)
-    KAN_ASSERT (size_with_padding_output)
     *absolute_offset_output = 0u;
     const struct kan_reflection_struct_t *struct_reflection =
         kan_reflection_registry_query_struct (registry, struct_name);
@@ -1326,6 +1650,105 @@ const struct kan_reflection_field_t *kan_reflection_registry_query_local_field (
     return field_reflection;
 }
 
+static struct field_path_cache_node_t *registry_find_cached_field_path (struct registry_t *registry_struct,
+                                                                        kan_hash_t hash,
+                                                                        kan_interned_string_t struct_name,
+                                                                        kan_instance_size_t path_length,
+                                                                        kan_interned_string_t *path)
+{
+    const struct kan_hash_storage_bucket_t *bucket = kan_hash_storage_query (&registry_struct->field_path_cache, hash);
+    struct field_path_cache_node_t *node = (struct field_path_cache_node_t *) bucket->first;
+    const struct field_path_cache_node_t *end =
+        (struct field_path_cache_node_t *) (bucket->last ? bucket->last->next : NULL);
+
+    while (node != end)
+    {
+        if (node->node.hash == hash && node->struct_name == struct_name && node->path_length == path_length &&
+            memcmp (node->path, path, sizeof (kan_interned_string_t) * path_length) == 0)
+        {
+            return node;
+        }
+
+        node = (struct field_path_cache_node_t *) node->node.list_node.next;
+    }
+
+    return NULL;
+}
+
+const struct kan_reflection_field_t *kan_reflection_registry_query_local_field (
+    kan_reflection_registry_t registry,
+    kan_interned_string_t struct_name,
+    kan_instance_size_t path_length,
+    kan_interned_string_t *path,
+    kan_instance_size_t *absolute_offset_output,
+    kan_instance_size_t *size_with_padding_output)
+
+{
+    KAN_ASSERT (path_length > 0u)
+    KAN_ASSERT (absolute_offset_output)
+    KAN_ASSERT (size_with_padding_output)
+    struct registry_t *registry_struct = KAN_HANDLE_GET (registry);
+
+    if (!registry_struct->frozen)
+    {
+        return registry_resolve_local_field (registry, struct_name, path_length, path, absolute_offset_output,
+                                             size_with_padding_output);
+    }
+
+    // Frozen registry cannot change, therefore successful resolution results can be safely cached.
+    kan_hash_t hash = KAN_HASH_OBJECT_POINTER (struct_name);
+    for (kan_loop_size_t index = 0u; index < path_length; ++index)
+    {
+        hash = kan_hash_combine (hash, KAN_HASH_OBJECT_POINTER (path[index]));
+    }
+
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&registry_struct->field_path_cache_lock)
+        struct field_path_cache_node_t *cached =
+            registry_find_cached_field_path (registry_struct, hash, struct_name, path_length, path);
+
+        if (cached)
+        {
+            *absolute_offset_output = cached->absolute_offset;
+            *size_with_padding_output = cached->size_with_padding;
+            return cached->field;
+        }
+    }
+
+    const struct kan_reflection_field_t *field = registry_resolve_local_field (
+        registry, struct_name, path_length, path, absolute_offset_output, size_with_padding_output);
+
+    if (!field)
+    {
+        // Failures are not cached as they're not expected on hot paths and are reported through log.
+        return NULL;
+    }
+
+    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&registry_struct->field_path_cache_lock)
+    if (!registry_find_cached_field_path (registry_struct, hash, struct_name, path_length, path))
+    {
+        const kan_instance_size_t node_size = sizeof (struct field_path_cache_node_t) +
+                                              sizeof (kan_interned_string_t) * (kan_instance_size_t) path_length;
+
+        struct field_path_cache_node_t *node = kan_allocate_general (
+            registry_struct->allocation_group, node_size, alignof (struct field_path_cache_node_t));
+
+        node->node.hash = hash;
+        node->struct_name = struct_name;
+        node->field = field;
+        node->absolute_offset = *absolute_offset_output;
+        node->size_with_padding = *size_with_padding_output;
+        node->path_length = path_length;
+        memcpy (node->path, path, sizeof (kan_interned_string_t) * path_length);
+
+        kan_hash_storage_update_bucket_count_default (&registry_struct->field_path_cache,
+                                                      KAN_REFLECTION_FIELD_PATH_CACHE_INITIAL_BUCKETS);
+        kan_hash_storage_add (&registry_struct->field_path_cache, &node->node);
+    }
+
+    return field;
+}
+
 const struct kan_reflection_field_t *kan_reflection_registry_query_local_field_by_offset (
     kan_reflection_registry_t registry,
     kan_interned_string_t struct_name,
@@ -1626,6 +2049,28 @@ void kan_reflection_registry_destroy (kan_reflection_registry_t registry)
         node = next;
     }
 
+    node = registry_struct->field_path_cache.items.first;
+    while (node)
+    {
+        struct kan_bd_list_node_t *next = node->next;
+        struct field_path_cache_node_t *cache_node = (struct field_path_cache_node_t *) node;
+        kan_free_general (registry_struct->allocation_group, cache_node,
+                          sizeof (struct field_path_cache_node_t) +
+                              sizeof (kan_interned_string_t) * (kan_instance_size_t) cache_node->path_length);
+        node = next;
+    }
+
+    frozen_index_shutdown (&registry_struct->enum_index, registry_struct->allocation_group);
+    frozen_index_shutdown (&registry_struct->struct_index, registry_struct->allocation_group);
+    frozen_index_shutdown (&registry_struct->function_index, registry_struct->allocation_group);
+    frozen_index_shutdown (&registry_struct->enum_meta_index, registry_struct->allocation_group);
+    frozen_index_shutdown (&registry_struct->enum_value_meta_index, registry_struct->allocation_group);
+    frozen_index_shutdown (&registry_struct->struct_meta_index, registry_struct->allocation_group);
+    frozen_index_shutdown (&registry_struct->struct_field_meta_index, registry_struct->allocation_group);
+    frozen_index_shutdown (&registry_struct->function_meta_index, registry_struct->allocation_group);
+    frozen_index_shutdown (&registry_struct->function_argument_meta_index, registry_struct->allocation_group);
+
+    kan_hash_storage_shutdown (&registry_struct->field_path_cache);
     kan_hash_storage_shutdown (&registry_struct->enum_storage);
     kan_hash_storage_shutdown (&registry_struct->struct_storage);
     kan_hash_storage_shutdown (&registry_struct->function_storage);
@@ -2036,6 +2481,7 @@ static uint8_t *add_section_nodes (uint8_t *output,
     output_node->section_suffix.my_section_id = (uint16_t) COMPILED_SECTION_ID_GET (section);
     output_patch->section_id_bound =
         KAN_MAX (output_patch->section_id_bound, output_node->section_suffix.my_section_id + 1u);
+    output_patch->data_only = false;
     output_node->section_suffix.packed_type = (uint16_t) section->type;
     output_node->section_suffix.source_offset_in_parent = section->source_offset;
     output_node->section_suffix.bounding_address = 0u;
@@ -2067,6 +2513,23 @@ static uint8_t *add_section_nodes (uint8_t *output,
 
     KAN_ASSERT (output_node->section_suffix.source_field)
     KAN_ASSERT (output_node->section_suffix.source_field_struct)
+    output_node->section_suffix.item_struct = NULL;
+
+    switch (section->type)
+    {
+    case KAN_REFLECTION_PATCH_SECTION_TYPE_DYNAMIC_ARRAY_SET:
+    case KAN_REFLECTION_PATCH_SECTION_TYPE_DYNAMIC_ARRAY_APPEND:
+        if (output_node->section_suffix.source_field->archetype_dynamic_array.item_archetype ==
+            KAN_REFLECTION_ARCHETYPE_STRUCT)
+        {
+            output_node->section_suffix.item_struct = kan_reflection_registry_query_struct (
+                registry, output_node->section_suffix.source_field->archetype_dynamic_array.item_archetype_struct
+                              .type_name);
+            KAN_ASSERT (output_node->section_suffix.item_struct)
+        }
+
+        break;
+    }
 
 #if defined(KAN_WITH_ASSERT)
     switch (section->type)
@@ -2201,6 +2664,7 @@ static bool compiled_patch_build_into (struct patch_builder_t *patch_builder,
     output_patch->type = type;
     output_patch->node_count = node_count;
     output_patch->section_id_bound = 0u;
+    output_patch->data_only = true;
     output_patch->begin = kan_allocate_general (get_compiled_patch_allocation_group (), patch_data_size,
                                                 alignof (struct compiled_patch_node_t));
     output_patch->end = (struct compiled_patch_node_t *) (((uint8_t *) output_patch->begin) + patch_data_size);
@@ -2311,8 +2775,7 @@ static inline void compiled_patch_section_stack_init (struct compiled_patch_sect
     stack->stack_end_pointer = stack->stack;
 }
 
-static inline void compiled_patch_section_stack_go_to (kan_reflection_registry_t registry,
-                                                       struct compiled_patch_section_stack_t *stack,
+static inline void compiled_patch_section_stack_go_to (struct compiled_patch_section_stack_t *stack,
                                                        struct compiled_patch_node_section_suffix_t *section_data)
 {
     struct compiled_patch_section_stack_item_t *old_append_section = NULL;
@@ -2367,12 +2830,9 @@ static inline void compiled_patch_section_stack_go_to (kan_reflection_registry_t
             kan_dynamic_array_set_capacity (array, required_size);
         }
 
-        if (section_data->source_field->archetype_dynamic_array.item_archetype == KAN_REFLECTION_ARCHETYPE_STRUCT)
+        const struct kan_reflection_struct_t *inner_struct = section_data->item_struct;
+        if (inner_struct)
         {
-            const struct kan_reflection_struct_t *inner_struct = kan_reflection_registry_query_struct (
-                registry, section_data->source_field->archetype_dynamic_array.item_archetype_struct.type_name);
-            KAN_ASSERT (inner_struct)
-
             if (inner_struct->init)
             {
                 uint8_t *output = array->data + array->size * array->item_size;
@@ -2404,12 +2864,9 @@ static inline void compiled_patch_section_stack_go_to (kan_reflection_registry_t
             KAN_ASSERT (target);
         }
 
-        if (section_data->source_field->archetype_dynamic_array.item_archetype == KAN_REFLECTION_ARCHETYPE_STRUCT)
+        const struct kan_reflection_struct_t *inner_struct = section_data->item_struct;
+        if (inner_struct)
         {
-            const struct kan_reflection_struct_t *inner_struct = kan_reflection_registry_query_struct (
-                registry, section_data->source_field->archetype_dynamic_array.item_archetype_struct.type_name);
-            KAN_ASSERT (inner_struct)
-
             if (inner_struct->init)
             {
                 inner_struct->init (inner_struct->functor_user_data, target);
@@ -2428,17 +2885,18 @@ static inline void compiled_patch_section_stack_go_to (kan_reflection_registry_t
     stack->target_data = target;
 }
 
-void kan_reflection_patch_apply (kan_reflection_patch_t patch, void *target)
+static inline struct compiled_patch_node_t *compiled_patch_data_node_next (struct compiled_patch_node_t *node)
+{
+    uint8_t *data_end = ((uint8_t *) node->data_suffix.data) + node->data_suffix.size;
+    data_end = (uint8_t *) kan_apply_alignment ((kan_memory_size_t) data_end, alignof (struct compiled_patch_node_t));
+    return (struct compiled_patch_node_t *) data_end;
+}
+
+static void compiled_patch_apply_with_sections (struct compiled_patch_t *patch_data, void *target)
 {
-    struct compiled_patch_t *patch_data = KAN_HANDLE_GET (patch);
     struct compiled_patch_node_t *node = patch_data->begin;
     const struct compiled_patch_node_t *end = patch_data->end;
 
-    if (!node)
-    {
-        return;
-    }
-
     struct compiled_patch_section_stack_t section_stack;
     compiled_patch_section_stack_init (&section_stack, target);
 
@@ -2448,15 +2906,11 @@ void kan_reflection_patch_apply (kan_reflection_patch_t patch, void *target)
         {
             memcpy (((uint8_t *) section_stack.target_data) + node->data_suffix.offset, node->data_suffix.data,
                     node->data_suffix.size);
-            uint8_t *data_end = ((uint8_t *) node->data_suffix.data) + node->data_suffix.size;
-            data_end =
-                (uint8_t *) kan_apply_alignment ((kan_memory_size_t) data_end, alignof (struct compiled_patch_node_t));
-            node = (struct compiled_patch_node_t *) data_end;
+            node = compiled_patch_data_node_next (node);
         }
         else
         {
-            compiled_patch_section_stack_go_to (KAN_HANDLE_SET (kan_reflection_registry_t, patch_data->registry),
-                                                &section_stack, &node->section_suffix);
+            compiled_patch_section_stack_go_to (&section_stack, &node->section_suffix);
             // Sections have standard size.
             ++node;
         }
@@ -2477,6 +2931,68 @@ void kan_reflection_patch_apply (kan_reflection_patch_t patch, void *target)
     }
 }
 
+void kan_reflection_patch_apply (kan_reflection_patch_t patch, void *target)
+{
+    struct compiled_patch_t *patch_data = KAN_HANDLE_GET (patch);
+    struct compiled_patch_node_t *node = patch_data->begin;
+    const struct compiled_patch_node_t *end = patch_data->end;
+
+    if (!node)
+    {
+        return;
+    }
+
+    if (!patch_data->data_only)
+    {
+        compiled_patch_apply_with_sections (patch_data, target);
+        return;
+    }
+
+    // Data only patch is just a list of copy spans, no need to manage section stack.
+    while (node != end)
+    {
+        KAN_ASSERT (node->is_data_node)
+        memcpy (((uint8_t *) target) + node->data_suffix.offset, node->data_suffix.data, node->data_suffix.size);
+        node = compiled_patch_data_node_next (node);
+    }
+}
+
+void kan_reflection_patch_apply_batch (kan_reflection_patch_t patch, kan_instance_size_t count, void **targets)
+{
+    struct compiled_patch_t *patch_data = KAN_HANDLE_GET (patch);
+    struct compiled_patch_node_t *node = patch_data->begin;
+    const struct compiled_patch_node_t *end = patch_data->end;
+
+    if (!node)
+    {
+        return;
+    }
+
+    if (!patch_data->data_only)
+    {
+        // Every target needs its own section stack and its own array resizes, nothing to share between targets.
+        for (kan_loop_size_t index = 0u; index < (kan_loop_size_t) count; ++index)
+        {
+            compiled_patch_apply_with_sections (patch_data, targets[index]);
+        }
+
+        return;
+    }
+
+    // Nodes are iterated in the outer loop, so node data is read once and stays hot while it is copied to targets.
+    while (node != end)
+    {
+        KAN_ASSERT (node->is_data_node)
+        for (kan_loop_size_t index = 0u; index < (kan_loop_size_t) count; ++index)
+        {
+            memcpy (((uint8_t *) targets[index]) + node->data_suffix.offset, node->data_suffix.data,
+                    node->data_suffix.size);
+        }
+
+        node = compiled_patch_data_node_next (node);
+    }
+}
+
 kan_reflection_patch_iterator_t kan_reflection_patch_begin (kan_reflection_patch_t patch)
 {
     struct compiled_patch_t *patch_data = KAN_HANDLE_GET (patch);
@@ -2494,10 +3010,7 @@ kan_reflection_patch_iterator_t kan_reflection_patch_iterator_next (kan_reflecti
     struct compiled_patch_node_t *node = KAN_HANDLE_GET (iterator);
     if (node->is_data_node)
     {
-        uint8_t *data_end = ((uint8_t *) node->data_suffix.data) + node->data_suffix.size;
-        data_end =
-            (uint8_t *) kan_apply_alignment ((kan_memory_size_t) data_end, alignof (struct compiled_patch_node_t));
-        return KAN_HANDLE_SET (kan_reflection_patch_iterator_t, data_end);
+        return KAN_HANDLE_SET (kan_reflection_patch_iterator_t, compiled_patch_data_node_next (node));
     }
     else
     {
@@ -3259,7 +3772,8 @@ static inline void migrator_add_set_zero_command (struct migrator_command_set_ze
             queues->set_zero_last->set_zero.absolute_source_offset + queues->set_zero_last->set_zero.size ==
             set_zero_command.absolute_source_offset;
 
-        const bool matching_visibility = queues->copy_last->copy.condition_index == set_zero_command.condition_index;
+        const bool matching_visibility =
+            queues->set_zero_last->set_zero.condition_index == set_zero_command.condition_index;
 
         if (end_is_start && matching_visibility)
         {
@@ -3430,6 +3944,145 @@ static inline void migrator_add_enum_commands (kan_instance_size_t source_offset
     }
 }
 
+/// \brief Checks that given range of target struct is not occupied by any field, including fields of nested structs.
+static bool migrator_is_target_padding (kan_reflection_registry_t target_registry,
+                                        const struct kan_reflection_struct_t *target_struct,
+                                        kan_instance_size_t begin,
+                                        kan_instance_size_t end)
+{
+    for (kan_loop_size_t field_index = 0u; field_index < target_struct->fields_count; ++field_index)
+    {
+        const struct kan_reflection_field_t *field = &target_struct->fields[field_index];
+        const kan_instance_size_t field_end = field->offset + field->size;
+
+        if (field->offset >= end || field_end <= begin)
+        {
+            continue;
+        }
+
+        if (field->archetype != KAN_REFLECTION_ARCHETYPE_STRUCT)
+        {
+            return false;
+        }
+
+        const struct kan_reflection_struct_t *nested_struct =
+            kan_reflection_registry_query_struct (target_registry, field->archetype_struct.type_name);
+
+        if (!nested_struct ||
+            !migrator_is_target_padding (target_registry, nested_struct, KAN_MAX (begin, field->offset) - field->offset,
+                                         KAN_MIN (end, field_end) - field->offset))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static inline bool migrator_copy_command_less (const struct migrator_command_copy_t *left,
+                                               const struct migrator_command_copy_t *right)
+{
+    if (left->condition_index != right->condition_index)
+    {
+        // Unconditional commands go first.
+        if (left->condition_index == MIGRATOR_CONDITION_INDEX_NONE)
+        {
+            return true;
+        }
+
+        if (right->condition_index == MIGRATOR_CONDITION_INDEX_NONE)
+        {
+            return false;
+        }
+
+        return left->condition_index < right->condition_index;
+    }
+
+    return left->absolute_source_offset < right->absolute_source_offset;
+}
+
+/// \brief Sorts copy commands and merges them into the biggest possible memory spans.
+/// \details Copy commands are already merged on insertion when they go one after another, but fields are not always
+///          visited in memory order and padding between fields prevents merging on insertion. Padding is copied along
+///          with fields when layout between commands is the same in source and target and there is nothing in target
+///          padding, because there is no need to preserve padding values.
+static void migrator_coalesce_copy_commands (struct migration_seed_t *migration_seed,
+                                             kan_interned_string_t type_name,
+                                             kan_stack_allocator_t algorithm_allocator,
+                                             struct migrator_command_temporary_queues_t *queues)
+{
+    if (queues->copy_count < 2u)
+    {
+        return;
+    }
+
+    const struct kan_reflection_struct_t *target_struct =
+        kan_reflection_registry_query_struct (migration_seed->target_registry, type_name);
+    KAN_ASSERT (target_struct)
+
+    struct migrator_temporary_node_t **nodes_array =
+        (struct migrator_temporary_node_t **) kan_stack_allocator_allocate (
+            algorithm_allocator, queues->copy_count * sizeof (struct migrator_temporary_node_t *),
+            alignof (struct migrator_temporary_node_t *));
+
+    struct migrator_temporary_node_t *node = queues->copy_first;
+    for (kan_loop_size_t index = 0u; index < queues->copy_count; ++index)
+    {
+        KAN_ASSERT (node)
+        nodes_array[index] = node;
+        node = node->next;
+    }
+
+    {
+        struct migrator_temporary_node_t *temporary;
+        unsigned long sort_length = (unsigned long) queues->copy_count;
+
+#define LESS(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    migrator_copy_command_less (&nodes_array[first_index]->copy, &nodes_array[second_index]->copy)
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = nodes_array[first_index], nodes_array[first_index] = nodes_array[second_index],                        \
+    nodes_array[second_index] = temporary
+
+        QSORT (sort_length, LESS, SWAP);
+#undef LESS
+#undef SWAP
+    }
+
+    const kan_instance_size_t input_count = queues->copy_count;
+    queues->copy_count = 0u;
+    queues->copy_first = NULL;
+    queues->copy_last = NULL;
+
+    for (kan_loop_size_t index = 0u; index < input_count; ++index)
+    {
+        struct migrator_temporary_node_t *current = nodes_array[index];
+        struct migrator_temporary_node_t *last = queues->copy_last;
+
+        if (last && last->copy.condition_index == current->copy.condition_index)
+        {
+            const kan_instance_size_t source_end = last->copy.absolute_source_offset + last->copy.size;
+            const kan_instance_size_t target_end = last->copy.absolute_target_offset + last->copy.size;
+
+            if (current->copy.absolute_source_offset >= source_end &&
+                current->copy.absolute_target_offset >= target_end &&
+                current->copy.absolute_source_offset - source_end ==
+                    current->copy.absolute_target_offset - target_end &&
+                migrator_is_target_padding (migration_seed->target_registry, target_struct, target_end,
+                                            current->copy.absolute_target_offset))
+            {
+                last->copy.size = current->copy.absolute_source_offset + current->copy.size -
+                                  last->copy.absolute_source_offset;
+                continue;
+            }
+        }
+
+        migrator_add_node (current, &queues->copy_first, &queues->copy_last);
+        ++queues->copy_count;
+    }
+}
+
 static struct struct_migrator_node_t *migrator_request_struct_by_type_name (struct migrator_t *migrator,
                                                                             struct migration_seed_t *migration_seed,
                                                                             kan_interned_string_t type_name,
@@ -3783,6 +4436,7 @@ static struct struct_migrator_node_t *migrator_add_struct (struct migrator_t *mi
         }
     }
 
+    migrator_coalesce_copy_commands (migration_seed, source_struct->name, algorithm_allocator, &queues);
     struct struct_migrator_node_t *struct_migrator =
         kan_allocate_batched (get_migrator_allocation_group (), sizeof (struct struct_migrator_node_t));
     struct_migrator->node.hash = KAN_HASH_OBJECT_POINTER (source_struct->name);
@@ -3825,6 +4479,7 @@ static struct struct_migrator_node_t *migrator_add_struct (struct migrator_t *mi
     }
 
     struct_migrator->copy_commands_count = queues.copy_count;
+    struct_migrator->copy_commands_unconditional_count = 0u;
     struct_migrator->copy_commands = (struct migrator_command_copy_t *) command_line;
     command_line += sizeof (struct migrator_command_copy_t) * queues.copy_count;
 
@@ -3833,6 +4488,13 @@ static struct struct_migrator_node_t *migrator_add_struct (struct migrator_t *mi
     {
         KAN_ASSERT (node)
         struct_migrator->copy_commands[index] = node->copy;
+
+        if (node->copy.condition_index == MIGRATOR_CONDITION_INDEX_NONE)
+        {
+            KAN_ASSERT (struct_migrator->copy_commands_unconditional_count == index)
+            ++struct_migrator->copy_commands_unconditional_count;
+        }
+
         node = node->next;
     }
 
@@ -4280,6 +4942,33 @@ static inline void migrator_adapt_enum (const struct migrator_t *migrator,
     migrator_adapt_enum_with_migration_node (migrator, migration_node, located_input, located_output);
 }
 
+static inline bool *migrator_conditions_allocate (const struct struct_migrator_node_t *struct_node, bool *fixed_buffer)
+{
+    if (struct_node->conditions_count > KAN_REFLECTION_MIGRATOR_MAX_CONDITIONS)
+    {
+        return kan_allocate_general (get_migrator_allocation_group (), sizeof (bool) * struct_node->conditions_count,
+                                     alignof (bool));
+    }
+
+    return fixed_buffer;
+}
+
+static inline void migrator_conditions_free (const struct struct_migrator_node_t *struct_node,
+                                             bool *conditions,
+                                             bool *fixed_buffer)
+{
+    if (conditions != fixed_buffer)
+    {
+        kan_free_general (get_migrator_allocation_group (), conditions, sizeof (bool) * struct_node->conditions_count);
+    }
+}
+
+static void migrator_execute (kan_reflection_struct_migrator_t migrator,
+                              const struct struct_migrator_node_t *struct_node,
+                              bool *conditions,
+                              void *source,
+                              void *target);
+
 static void migrator_adapt_dynamic_array (kan_reflection_struct_migrator_t migrator,
                                           const struct migrator_command_adapt_dynamic_array_t *command,
                                           const void *located_input,
@@ -4294,6 +4983,26 @@ static void migrator_adapt_dynamic_array (kan_reflection_struct_migrator_t migra
     kan_dynamic_array_set_capacity (output_array, input_array->capacity);
     uint8_t *input_data = input_array->data;
 
+    // Items share the type, therefore struct migrator lookup and conditions allocation are done once for all items.
+    const struct struct_migrator_node_t *item_struct_node = NULL;
+    bool item_conditions_fixed[KAN_REFLECTION_MIGRATOR_MAX_CONDITIONS];
+    bool *item_conditions = NULL;
+
+    if (command->source_field->archetype_dynamic_array.item_archetype == KAN_REFLECTION_ARCHETYPE_STRUCT)
+    {
+        item_struct_node = migrator_query_struct (
+            KAN_HANDLE_GET (migrator), command->source_field->archetype_dynamic_array.item_archetype_struct.type_name);
+
+        if (!item_struct_node)
+        {
+            KAN_LOG (reflection_migrator, KAN_LOG_ERROR, "Unable to find migrator for struct \"%s\".",
+                     command->source_field->archetype_dynamic_array.item_archetype_struct.type_name)
+            return;
+        }
+
+        item_conditions = migrator_conditions_allocate (item_struct_node, item_conditions_fixed);
+    }
+
     for (kan_loop_size_t index = 0u; index < input_array->size; ++index)
     {
         void *output = kan_dynamic_array_add_last (output_array);
@@ -4325,9 +5034,7 @@ static void migrator_adapt_dynamic_array (kan_reflection_struct_migrator_t migra
             KAN_ASSERT (command->source_field->archetype_dynamic_array.item_archetype_struct.type_name ==
                         command->target_field->archetype_dynamic_array.item_archetype_struct.type_name)
 
-            kan_reflection_struct_migrator_migrate_instance (
-                migrator, command->source_field->archetype_dynamic_array.item_archetype_struct.type_name, input_data,
-                output);
+            migrator_execute (migrator, item_struct_node, item_conditions, input_data, output);
             break;
 
             // Archetypes below do not need any adaptation, therefore this command should not be issued.
@@ -4346,31 +5053,20 @@ static void migrator_adapt_dynamic_array (kan_reflection_struct_migrator_t migra
 
         input_data += command->source_field->archetype_dynamic_array.item_size;
     }
-}
-
-void kan_reflection_struct_migrator_migrate_instance (kan_reflection_struct_migrator_t migrator,
-                                                      kan_interned_string_t type_name,
-                                                      void *source,
-                                                      void *target)
-{
-    struct migrator_t *migrator_data = KAN_HANDLE_GET (migrator);
-    struct struct_migrator_node_t *struct_node = migrator_query_struct (migrator_data, type_name);
-
-    if (!struct_node)
-    {
-        KAN_LOG (reflection_migrator, KAN_LOG_ERROR, "Unable to find migrator for struct \"%s\".", type_name)
-        return;
-    }
-
-    bool conditions_fixed[KAN_REFLECTION_MIGRATOR_MAX_CONDITIONS];
-    bool *conditions = conditions_fixed;
 
-    if (struct_node->conditions_count > KAN_REFLECTION_MIGRATOR_MAX_CONDITIONS)
+    if (item_struct_node)
     {
-        conditions = kan_allocate_general (get_migrator_allocation_group (),
-                                           sizeof (bool) * struct_node->conditions_count, alignof (bool));
+        migrator_conditions_free (item_struct_node, item_conditions, item_conditions_fixed);
     }
+}
 
+static void migrator_execute (kan_reflection_struct_migrator_t migrator,
+                              const struct struct_migrator_node_t *struct_node,
+                              bool *conditions,
+                              void *source,
+                              void *target)
+{
+    struct migrator_t *migrator_data = KAN_HANDLE_GET (migrator);
     for (kan_loop_size_t condition_index = 0u; condition_index < struct_node->conditions_count; ++condition_index)
     {
         const struct migrator_condition_t *condition = &struct_node->conditions[condition_index];
@@ -4388,11 +5084,21 @@ void kan_reflection_struct_migrator_migrate_instance (kan_reflection_struct_migr
             ((uint8_t *) source) + condition->absolute_source_offset);
     }
 
-    for (kan_loop_size_t command_index = 0u; command_index < struct_node->copy_commands_count; ++command_index)
+    for (kan_loop_size_t command_index = 0u; command_index < struct_node->copy_commands_unconditional_count;
+         ++command_index)
+    {
+        const struct migrator_command_copy_t *copy_command = &struct_node->copy_commands[command_index];
+        memcpy (((uint8_t *) target) + copy_command->absolute_target_offset,
+                ((uint8_t *) source) + copy_command->absolute_source_offset, copy_command->size);
+    }
+
+    for (kan_loop_size_t command_index = struct_node->copy_commands_unconditional_count;
+         command_index < struct_node->copy_commands_count; ++command_index)
     {
         const struct migrator_command_copy_t *copy_command = &struct_node->copy_commands[command_index];
-        if (copy_command->condition_index != MIGRATOR_CONDITION_INDEX_NONE &&
-            !conditions[copy_command->condition_index])
+        KAN_ASSERT (copy_command->condition_index != MIGRATOR_CONDITION_INDEX_NONE)
+
+        if (!conditions[copy_command->condition_index])
         {
             continue;
         }
@@ -4463,10 +5169,40 @@ void kan_reflection_struct_migrator_migrate_instance (kan_reflection_struct_migr
         memset (((uint8_t *) source) + set_zero_command->absolute_source_offset, 0u, set_zero_command->size);
     }
 
-    if (conditions != conditions_fixed)
+}
+
+void kan_reflection_struct_migrator_migrate_instance (kan_reflection_struct_migrator_t migrator,
+                                                      kan_interned_string_t type_name,
+                                                      void *source,
+                                                      void *target)
+{
+    kan_reflection_struct_migrator_migrate_instances (migrator, type_name, 1u, &source, &target);
+}
+
+void kan_reflection_struct_migrator_migrate_instances (kan_reflection_struct_migrator_t migrator,
+                                                       kan_interned_string_t type_name,
+                                                       kan_instance_size_t count,
+                                                       void **sources,
+                                                       void **targets)
+{
+    struct migrator_t *migrator_data = KAN_HANDLE_GET (migrator);
+    struct struct_migrator_node_t *struct_node = migrator_query_struct (migrator_data, type_name);
+
+    if (!struct_node)
+    {
+        KAN_LOG (reflection_migrator, KAN_LOG_ERROR, "Unable to find migrator for struct \"%s\".", type_name)
+        return;
+    }
+
+    bool conditions_fixed[KAN_REFLECTION_MIGRATOR_MAX_CONDITIONS];
+    bool *conditions = migrator_conditions_allocate (struct_node, conditions_fixed);
+
+    for (kan_loop_size_t index = 0u; index < count; ++index)
     {
-        kan_free_general (get_migrator_allocation_group (), conditions, sizeof (bool) * struct_node->conditions_count);
+        migrator_execute (migrator, struct_node, conditions, sources[index], targets[index]);
     }
+
+    migrator_conditions_free (struct_node, conditions, conditions_fixed);
 }
 
 enum patch_condition_status_t
@@ -475,6 +475,29 @@ enum kan_rpl_meta_emission_flags_t
     KAN_RPL_META_EMISSION_SKIP_SETS = 1u << 1u,
 };
 
+/// \brief Flags for optional optimization step on resolved instance before code emission.
+KAN_REFLECTION_FLAGS
+enum kan_rpl_optimization_flags_t
+{
+    /// \brief Constant that indicates that no optimizations are applied.
+    KAN_RPL_OPTIMIZATION_NONE = 0u,
+
+    /// \brief Folds arithmetic on scalar literals, including literals produced from options and constants.
+    KAN_RPL_OPTIMIZATION_CONSTANT_FOLDING = 1u << 0u,
+
+    /// \brief Removes if branches and while loops which conditions are known during compilation.
+    /// \details Branches that contain return, break, continue or discard are left as is, so control flow stays valid.
+    KAN_RPL_OPTIMIZATION_DEAD_BRANCHES = 1u << 1u,
+
+    /// \brief Removes functions that are not called from entry points anymore, for example after branch removal.
+    /// \details Only applied when resolve has at least one entry point.
+    KAN_RPL_OPTIMIZATION_DEAD_FUNCTIONS = 1u << 2u,
+
+    /// \brief Constant that enables all optimizations.
+    KAN_RPL_OPTIMIZATION_ALL = KAN_RPL_OPTIMIZATION_CONSTANT_FOLDING | KAN_RPL_OPTIMIZATION_DEAD_BRANCHES |
+                               KAN_RPL_OPTIMIZATION_DEAD_FUNCTIONS,
+};
+
 RENDER_PIPELINE_LANGUAGE_API void kan_rpl_meta_init (struct kan_rpl_meta_t *instance);
 
 RENDER_PIPELINE_LANGUAGE_API void kan_rpl_meta_init_copy (struct kan_rpl_meta_t *instance,
@@ -482,6 +505,11 @@ RENDER_PIPELINE_LANGUAGE_API void kan_rpl_meta_init_copy (struct kan_rpl_meta_t
 
 RENDER_PIPELINE_LANGUAGE_API void kan_rpl_meta_shutdown (struct kan_rpl_meta_t *instance);
 
+/// \brief Version of parser and compiler logic.
+/// \details Must be incremented when parser or compiler changes can alter emitted meta or code for the same input, as
+///          it is used as a part of the keys for caching compilation results.
+#define KAN_RPL_COMPILER_VERSION 2u
+
 /// \brief Creates compiler context for gathering options and modules to be resolved.
 RENDER_PIPELINE_LANGUAGE_API kan_rpl_compiler_context_t
 kan_rpl_compiler_context_create (enum kan_rpl_pipeline_type_t pipeline_type, kan_interned_string_t log_name);
@@ -538,6 +566,13 @@ kan_rpl_compiler_context_resolve (kan_rpl_compiler_context_t compiler_context,
                                   kan_instance_size_t entry_point_count,
                                   struct kan_rpl_entry_point_t *entry_points);
 
+/// \brief Applies optimizations selected by flags to resolved instance data.
+/// \details Optional step between resolve and emit. Only changes code: bindings and settings are left intact, so
+///          emitted meta is the same with and without optimizations. Optimizations are applied to compile time
+///          known values only, therefore results of emitted code execution are not changed.
+RENDER_PIPELINE_LANGUAGE_API void kan_rpl_compiler_instance_optimize (kan_rpl_compiler_instance_t compiler_instance,
+                                                                      enum kan_rpl_optimization_flags_t flags);
+
 /// \brief Emits meta using resolved instance data.
 RENDER_PIPELINE_LANGUAGE_API bool kan_rpl_compiler_instance_emit_meta (kan_rpl_compiler_instance_t compiler_instance,
                                                                        struct kan_rpl_meta_t *meta,
@@ -550,6 +585,43 @@ RENDER_PIPELINE_LANGUAGE_API bool kan_rpl_compiler_instance_emit_spirv (kan_rpl_
                                                                         struct kan_dynamic_array_t *output,
                                                                         kan_allocation_group_t output_allocation_group);
 
+/// \brief Describes one variant for batched resolve and emit.
+struct kan_rpl_compiler_batch_item_t
+{
+    /// \brief Context that provides modules and option values for this variant.
+    /// \details Several items can share the same context, for example to emit different entry point sets.
+    kan_rpl_compiler_context_t context;
+
+    kan_instance_size_t entry_point_count;
+    struct kan_rpl_entry_point_t *entry_points;
+
+    /// \brief Optimizations that are applied after resolve.
+    enum kan_rpl_optimization_flags_t optimization_flags;
+
+    /// \brief Initialized meta to emit into or NULL if meta is not needed.
+    struct kan_rpl_meta_t *meta_output;
+
+    enum kan_rpl_meta_emission_flags_t meta_flags;
+
+    /// \brief Not initialized array to emit SPIRV into or NULL if code is not needed.
+    /// \invariant Follows the same rules as output for `kan_rpl_compiler_instance_emit_spirv`.
+    struct kan_dynamic_array_t *spirv_output;
+
+    kan_allocation_group_t spirv_allocation_group;
+
+    /// \brief Set by batch execution: whether resolve and all requested emits were successful.
+    bool successful;
+};
+
+/// \brief Resolves and emits all given items, possibly in parallel using cpu dispatch.
+/// \details Contexts and modules are only read during resolve, so they're shared by all items instead of being copied.
+///          Every item writes only to its own outputs, therefore results do not depend on execution order.
+///          Contexts must not be changed until batch is finished. Safe to call from inside cpu task: calling thread
+///          processes items too and only waits for the items that are already being processed by other threads.
+///          Returns true if all items were successful.
+RENDER_PIPELINE_LANGUAGE_API bool kan_rpl_compiler_batch_execute (kan_instance_size_t item_count,
+                                                                  struct kan_rpl_compiler_batch_item_t *items);
+
 /// \brief Destroys resolved instance data.
 RENDER_PIPELINE_LANGUAGE_API void kan_rpl_compiler_instance_destroy (kan_rpl_compiler_instance_t compiler_instance);
 
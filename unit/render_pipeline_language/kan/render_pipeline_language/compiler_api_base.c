@@ -476,8 +476,6 @@ kan_rpl_compiler_context_t kan_rpl_compiler_context_create (enum kan_rpl_pipelin
                             STATICS.rpl_compiler_allocation_group);
     kan_dynamic_array_init (&instance->modules, 0u, sizeof (struct kan_rpl_intermediate_t *),
                             alignof (struct kan_rpl_intermediate_t *), STATICS.rpl_compiler_allocation_group);
-    kan_stack_group_allocator_init (&instance->resolve_allocator, STATICS.rpl_compiler_context_allocation_group,
-                                    KAN_RPL_COMPILER_CONTEXT_RESOLVE_STACK);
 
     return KAN_HANDLE_SET (kan_rpl_compiler_context_t, instance);
 }
@@ -833,6 +831,5 @@ void kan_rpl_compiler_context_destroy (kan_rpl_compiler_context_t compiler_conte
     struct rpl_compiler_context_t *instance = KAN_HANDLE_GET (compiler_context);
     kan_dynamic_array_shutdown (&instance->option_values);
     kan_dynamic_array_shutdown (&instance->modules);
-    kan_stack_group_allocator_shutdown (&instance->resolve_allocator);
     kan_free_general (STATICS.rpl_compiler_context_allocation_group, instance, sizeof (struct rpl_compiler_context_t));
 }
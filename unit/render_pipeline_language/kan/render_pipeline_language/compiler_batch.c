@@ -0,0 +1,91 @@
+#include <kan/cpu_dispatch/parallel_for.h>
+
+#define KAN_RPL_COMPILER_IMPLEMENTATION
+#include <kan/render_pipeline_language/compiler_internal.h>
+
+/// \brief User data for parallel execution of batch items.
+struct rpl_compiler_batch_t
+{
+    struct kan_atomic_int_t items_failed;
+    struct kan_rpl_compiler_batch_item_t *items;
+};
+
+static void rpl_compiler_batch_execute_item (struct kan_rpl_compiler_batch_item_t *item)
+{
+    item->successful = false;
+    kan_rpl_compiler_instance_t instance =
+        kan_rpl_compiler_context_resolve (item->context, item->entry_point_count, item->entry_points);
+
+    if (!KAN_HANDLE_IS_VALID (instance))
+    {
+        return;
+    }
+
+    if (item->optimization_flags != KAN_RPL_OPTIMIZATION_NONE)
+    {
+        kan_rpl_compiler_instance_optimize (instance, item->optimization_flags);
+    }
+
+    bool successful = true;
+    if (item->meta_output && !kan_rpl_compiler_instance_emit_meta (instance, item->meta_output, item->meta_flags))
+    {
+        successful = false;
+    }
+
+    if (successful && item->spirv_output &&
+        !kan_rpl_compiler_instance_emit_spirv (instance, item->spirv_output, item->spirv_allocation_group))
+    {
+        successful = false;
+    }
+
+    kan_rpl_compiler_instance_destroy (instance);
+    item->successful = successful;
+}
+
+static void rpl_compiler_batch_execute_parallel_item (kan_functor_user_data_t user_data,
+                                                     kan_instance_size_t worker_index,
+                                                     kan_instance_size_t item_index)
+{
+    struct rpl_compiler_batch_t *batch = (struct rpl_compiler_batch_t *) user_data;
+    // First item is executed before parallel for.
+    struct kan_rpl_compiler_batch_item_t *item = &batch->items[item_index + 1u];
+    rpl_compiler_batch_execute_item (item);
+
+    if (!item->successful)
+    {
+        kan_atomic_int_add (&batch->items_failed, 1);
+    }
+}
+
+bool kan_rpl_compiler_batch_execute (kan_instance_size_t item_count, struct kan_rpl_compiler_batch_item_t *items)
+{
+    if (item_count == 0u)
+    {
+        return true;
+    }
+
+    // First item is always executed right away: it makes sure that lazily initialized statics of resolve and emit
+    // are initialized before anything runs concurrently.
+    rpl_compiler_batch_execute_item (&items[0u]);
+    bool successful = items[0u].successful;
+
+    if (item_count == 1u)
+    {
+        return successful;
+    }
+
+    struct rpl_compiler_batch_t batch = {
+        .items_failed = kan_atomic_int_init (successful ? 0 : 1),
+        .items = items,
+    };
+
+    kan_cpu_parallel_for_execute ((struct kan_cpu_parallel_for_t) {
+        .function = rpl_compiler_batch_execute_parallel_item,
+        .user_data = (kan_functor_user_data_t) &batch,
+        .items_count = item_count - 1u,
+        .max_helpers = KAN_INT_MAX (kan_instance_size_t),
+        .helper_profiler_section = kan_cpu_section_get ("rpl_compiler_batch"),
+    });
+
+    return kan_atomic_int_get (&batch.items_failed) == 0;
+}
@@ -77,6 +77,9 @@ struct rpl_compiler_context_t
     KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (struct kan_rpl_intermediate_t *)
     struct kan_dynamic_array_t modules;
 
+    /// \brief Allocator for temporary resolve data.
+    /// \details Only valid in shallow copies of the context that are created for every resolve. Shared context is
+    ///          never modified by resolves, therefore one context can be resolved from several threads at once.
     struct kan_stack_group_allocator_t resolve_allocator;
 };
 
@@ -608,6 +611,9 @@ struct compiler_instance_function_node_t
     spirv_size_t spirv_external_instruction_id;
     const struct spirv_generation_function_type_t *spirv_function_type;
 
+    /// \brief Used by dead function elimination, only valid during optimization.
+    bool optimization_reachable;
+
     kan_interned_string_t module_name;
     kan_interned_string_t source_name;
     kan_instance_size_t source_line;
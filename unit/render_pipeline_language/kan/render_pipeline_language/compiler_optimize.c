@@ -0,0 +1,842 @@
+#define KAN_RPL_COMPILER_IMPLEMENTATION
+#include <kan/render_pipeline_language/compiler_internal.h>
+
+// Optimizations are done on resolved instance tree instead of emitted code, because resolved tree still knows which
+// values are literals and which statements form branches, so there is no need to reconstruct this from bytecode.
+
+static inline bool optimization_is_scalar_literal (struct compiler_instance_expression_node_t *expression)
+{
+    switch (expression->type)
+    {
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_FLOATING_LITERAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_UNSIGNED_LITERAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_SIGNED_LITERAL:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static inline bool optimization_is_signed_in_range (int64_t value)
+{
+    return value >= (int64_t) INT32_MIN && value <= (int64_t) INT32_MAX;
+}
+
+/// \brief Attempts to replace binary operation on two literals with literal that contains its result.
+/// \details Operations are only folded when result is exactly the same as result of execution on GPU, therefore
+///          we skip division by zero, signed overflows, shifts out of range and modulus for negative values.
+static void optimization_fold_binary_operation (struct compiler_instance_expression_node_t *expression)
+{
+    struct compiler_instance_expression_node_t *left = expression->binary_operation.left_operand;
+    struct compiler_instance_expression_node_t *right = expression->binary_operation.right_operand;
+
+    if (!optimization_is_scalar_literal (left) || left->type != right->type)
+    {
+        return;
+    }
+
+    switch (left->type)
+    {
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_FLOATING_LITERAL:
+    {
+        const float left_value = left->floating_literal;
+        const float right_value = right->floating_literal;
+        float result;
+
+        switch (expression->type)
+        {
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_ADD:
+            result = left_value + right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_SUBTRACT:
+            result = left_value - right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_MULTIPLY:
+            result = left_value * right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_DIVIDE:
+            if (right_value == 0.0f)
+            {
+                return;
+            }
+
+            result = left_value / right_value;
+            break;
+
+        default:
+            return;
+        }
+
+        expression->floating_literal = result;
+        break;
+    }
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_UNSIGNED_LITERAL:
+    {
+        const uint32_t left_value = (uint32_t) left->unsigned_literal;
+        const uint32_t right_value = (uint32_t) right->unsigned_literal;
+        uint32_t result;
+
+        switch (expression->type)
+        {
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_ADD:
+            result = left_value + right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_SUBTRACT:
+            result = left_value - right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_MULTIPLY:
+            result = left_value * right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_DIVIDE:
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_MODULUS:
+            if (right_value == 0u)
+            {
+                return;
+            }
+
+            result = expression->type == COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_DIVIDE ? left_value / right_value :
+                                                                                              left_value % right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_AND:
+            result = left_value & right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_OR:
+            result = left_value | right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_XOR:
+            result = left_value ^ right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_LEFT_SHIFT:
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_RIGHT_SHIFT:
+            if (right_value >= 32u)
+            {
+                return;
+            }
+
+            result = expression->type == COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_LEFT_SHIFT ?
+                         left_value << right_value :
+                         left_value >> right_value;
+            break;
+
+        default:
+            return;
+        }
+
+        expression->unsigned_literal = (kan_instance_size_t) result;
+        break;
+    }
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_SIGNED_LITERAL:
+    {
+        const int64_t left_value = (int64_t) left->signed_literal;
+        const int64_t right_value = (int64_t) right->signed_literal;
+        int64_t result;
+
+        switch (expression->type)
+        {
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_ADD:
+            result = left_value + right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_SUBTRACT:
+            result = left_value - right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_MULTIPLY:
+            result = left_value * right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_DIVIDE:
+            if (right_value == 0)
+            {
+                return;
+            }
+
+            result = left_value / right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_MODULUS:
+            // Signed modulus sign rules differ between C and SPIRV for negative values.
+            if (left_value < 0 || right_value <= 0)
+            {
+                return;
+            }
+
+            result = left_value % right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_AND:
+            result = left_value & right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_OR:
+            result = left_value | right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_XOR:
+            result = left_value ^ right_value;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_LEFT_SHIFT:
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_RIGHT_SHIFT:
+            if (left_value < 0 || right_value < 0 || right_value >= 32)
+            {
+                return;
+            }
+
+            result = expression->type == COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_LEFT_SHIFT ?
+                         left_value << right_value :
+                         left_value >> right_value;
+            break;
+
+        default:
+            return;
+        }
+
+        if (!optimization_is_signed_in_range (result))
+        {
+            return;
+        }
+
+        expression->signed_literal = (kan_instance_offset_t) result;
+        break;
+    }
+
+    default:
+        KAN_ASSERT (false)
+        return;
+    }
+
+    // Operands have the same literal type, so their output type is also the output type of the folded literal.
+    expression->type = left->type;
+    expression->output = left->output;
+}
+
+static void optimization_fold_unary_operation (struct compiler_instance_expression_node_t *expression)
+{
+    struct compiler_instance_expression_node_t *operand = expression->unary_operation.operand;
+    switch (expression->type)
+    {
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_NEGATE:
+        switch (operand->type)
+        {
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_FLOATING_LITERAL:
+            expression->floating_literal = -operand->floating_literal;
+            break;
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_SIGNED_LITERAL:
+            if (!optimization_is_signed_in_range (-(int64_t) operand->signed_literal))
+            {
+                return;
+            }
+
+            expression->signed_literal = -operand->signed_literal;
+            break;
+
+        default:
+            return;
+        }
+
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_NOT:
+        if (operand->type != COMPILER_INSTANCE_EXPRESSION_TYPE_UNSIGNED_LITERAL)
+        {
+            return;
+        }
+
+        expression->unsigned_literal = (kan_instance_size_t) (~(uint32_t) operand->unsigned_literal);
+        break;
+
+    default:
+        return;
+    }
+
+    expression->type = operand->type;
+    expression->output = operand->output;
+}
+
+#define OPTIMIZATION_COMPARE(OPERATOR)                                                                                 \
+    switch (left->type)                                                                                                \
+    {                                                                                                                  \
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_FLOATING_LITERAL:                                                           \
+        *output = left->floating_literal OPERATOR right->floating_literal;                                             \
+        return true;                                                                                                   \
+                                                                                                                       \
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_UNSIGNED_LITERAL:                                                           \
+        *output = (uint32_t) left->unsigned_literal OPERATOR (uint32_t) right->unsigned_literal;                       \
+        return true;                                                                                                   \
+                                                                                                                       \
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_SIGNED_LITERAL:                                                             \
+        *output = left->signed_literal OPERATOR right->signed_literal;                                                 \
+        return true;                                                                                                   \
+                                                                                                                       \
+    default:                                                                                                           \
+        return false;                                                                                                  \
+    }
+
+/// \brief Evaluates boolean expression if it only depends on literals.
+/// \details Logical operations are only evaluated when both operands are known, because unknown operand might have
+///          side effects like function calls that we should not remove.
+static bool optimization_evaluate_condition (struct compiler_instance_expression_node_t *expression, bool *output)
+{
+    switch (expression->type)
+    {
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_AND:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_OR:
+    {
+        bool left_value;
+        bool right_value;
+
+        if (!optimization_evaluate_condition (expression->binary_operation.left_operand, &left_value) ||
+            !optimization_evaluate_condition (expression->binary_operation.right_operand, &right_value))
+        {
+            return false;
+        }
+
+        *output = expression->type == COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_AND ? left_value && right_value :
+                                                                                         left_value || right_value;
+        return true;
+    }
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_NOT:
+    {
+        bool operand_value;
+        if (!optimization_evaluate_condition (expression->unary_operation.operand, &operand_value))
+        {
+            return false;
+        }
+
+        *output = !operand_value;
+        return true;
+    }
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_EQUAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_NOT_EQUAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_LESS:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_GREATER:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_LESS_OR_EQUAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_GREATER_OR_EQUAL:
+    {
+        struct compiler_instance_expression_node_t *left = expression->binary_operation.left_operand;
+        struct compiler_instance_expression_node_t *right = expression->binary_operation.right_operand;
+
+        if (!optimization_is_scalar_literal (left) || left->type != right->type)
+        {
+            return false;
+        }
+
+        switch (expression->type)
+        {
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_EQUAL:
+            OPTIMIZATION_COMPARE (==)
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_NOT_EQUAL:
+            OPTIMIZATION_COMPARE (!=)
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_LESS:
+            OPTIMIZATION_COMPARE (<)
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_GREATER:
+            OPTIMIZATION_COMPARE (>)
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_LESS_OR_EQUAL:
+            OPTIMIZATION_COMPARE (<=)
+
+        case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_GREATER_OR_EQUAL:
+            OPTIMIZATION_COMPARE (>=)
+
+        default:
+            return false;
+        }
+    }
+
+    default:
+        return false;
+    }
+}
+
+#undef OPTIMIZATION_COMPARE
+
+static bool optimization_list_contains_control_transfer (struct compiler_instance_expression_list_item_t *list);
+
+/// \brief Checks whether expression contains anything that transfers control out of its block.
+/// \details Such expressions affect scope termination flags that are calculated during resolve, so we do not move
+///          or remove them in order to keep these flags valid.
+static bool optimization_contains_control_transfer (struct compiler_instance_expression_node_t *expression)
+{
+    if (!expression)
+    {
+        return false;
+    }
+
+    switch (expression->type)
+    {
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_BREAK:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_CONTINUE:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_RETURN:
+        return true;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_FUNCTION_CALL:
+        return expression->function_call.function == &STATICS.builtin_fragment_stage_discard;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_SCOPE:
+        return optimization_list_contains_control_transfer (expression->scope.first_expression);
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_IF:
+        return optimization_contains_control_transfer (expression->if_.when_true) ||
+               optimization_contains_control_transfer (expression->if_.when_false);
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_FOR:
+        return optimization_contains_control_transfer (expression->for_.body);
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_WHILE:
+        return optimization_contains_control_transfer (expression->while_.body);
+
+    default:
+        // Other expressions cannot contain statements.
+        return false;
+    }
+}
+
+static bool optimization_list_contains_control_transfer (struct compiler_instance_expression_list_item_t *list)
+{
+    while (list)
+    {
+        if (optimization_contains_control_transfer (list->expression))
+        {
+            return true;
+        }
+
+        list = list->next;
+    }
+
+    return false;
+}
+
+static void optimization_process_expression (enum kan_rpl_optimization_flags_t flags,
+                                             struct compiler_instance_expression_node_t *expression);
+
+static void optimization_process_list (enum kan_rpl_optimization_flags_t flags,
+                                       struct compiler_instance_expression_list_item_t *list)
+{
+    while (list)
+    {
+        optimization_process_expression (flags, list->expression);
+        list = list->next;
+    }
+}
+
+/// \brief Processes scope statements and removes statements that are never executed.
+static void optimization_process_scope (enum kan_rpl_optimization_flags_t flags,
+                                        struct compiler_instance_expression_node_t *scope)
+{
+    struct compiler_instance_expression_list_item_t *previous = NULL;
+    struct compiler_instance_expression_list_item_t *statement = scope->scope.first_expression;
+
+    while (statement)
+    {
+        struct compiler_instance_expression_list_item_t *next = statement->next;
+        struct compiler_instance_expression_node_t *expression = statement->expression;
+        optimization_process_expression (flags, expression);
+
+        bool remove = false;
+        bool condition_value;
+
+        if ((flags & KAN_RPL_OPTIMIZATION_DEAD_BRANCHES) && !optimization_contains_control_transfer (expression))
+        {
+            switch (expression->type)
+            {
+            case COMPILER_INSTANCE_EXPRESSION_TYPE_IF:
+                if (optimization_evaluate_condition (expression->if_.condition, &condition_value))
+                {
+                    struct compiler_instance_expression_node_t *taken =
+                        condition_value ? expression->if_.when_true : expression->if_.when_false;
+
+                    if (taken)
+                    {
+                        // Branch scope is inlined as nested scope statement, so its variables stay in its scope.
+                        statement->expression = taken;
+                    }
+                    else
+                    {
+                        remove = true;
+                    }
+                }
+
+                break;
+
+            case COMPILER_INSTANCE_EXPRESSION_TYPE_WHILE:
+                if (optimization_evaluate_condition (expression->while_.condition, &condition_value) &&
+                    !condition_value)
+                {
+                    remove = true;
+                }
+
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        if (remove)
+        {
+            if (previous)
+            {
+                previous->next = next;
+            }
+            else
+            {
+                scope->scope.first_expression = next;
+            }
+        }
+        else
+        {
+            previous = statement;
+        }
+
+        statement = next;
+    }
+}
+
+static void optimization_process_expression (enum kan_rpl_optimization_flags_t flags,
+                                             struct compiler_instance_expression_node_t *expression)
+{
+    if (!expression)
+    {
+        return;
+    }
+
+    switch (expression->type)
+    {
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_STRUCTURED_BUFFER_REFERENCE:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_SAMPLER_REFERENCE:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_IMAGE_REFERENCE:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_VARIABLE_REFERENCE:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_CONTAINER_FIELD_ACCESS_INPUT:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_CONTAINER_FIELD_ACCESS_OUTPUT:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_FLOATING_LITERAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_UNSIGNED_LITERAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_SIGNED_LITERAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_VARIABLE_DECLARATION:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_BREAK:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_CONTINUE:
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_STRUCTURED_ACCESS:
+        optimization_process_expression (flags, expression->structured_access.input);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_SWIZZLE:
+        optimization_process_expression (flags, expression->swizzle.input);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_ARRAY_INDEX:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_ASSIGN:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_AND:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_OR:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_EQUAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_NOT_EQUAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_LESS:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_GREATER:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_LESS_OR_EQUAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_GREATER_OR_EQUAL:
+        optimization_process_expression (flags, expression->binary_operation.left_operand);
+        optimization_process_expression (flags, expression->binary_operation.right_operand);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_ADD:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_SUBTRACT:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_MULTIPLY:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_DIVIDE:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_MODULUS:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_AND:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_OR:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_XOR:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_LEFT_SHIFT:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_RIGHT_SHIFT:
+        optimization_process_expression (flags, expression->binary_operation.left_operand);
+        optimization_process_expression (flags, expression->binary_operation.right_operand);
+
+        if (flags & KAN_RPL_OPTIMIZATION_CONSTANT_FOLDING)
+        {
+            optimization_fold_binary_operation (expression);
+        }
+
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_NOT:
+        optimization_process_expression (flags, expression->unary_operation.operand);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_NEGATE:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_NOT:
+        optimization_process_expression (flags, expression->unary_operation.operand);
+        if (flags & KAN_RPL_OPTIMIZATION_CONSTANT_FOLDING)
+        {
+            optimization_fold_unary_operation (expression);
+        }
+
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_SCOPE:
+        optimization_process_scope (flags, expression);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_FUNCTION_CALL:
+        optimization_process_list (flags, expression->function_call.first_argument);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_IMAGE_SAMPLE:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_IMAGE_SAMPLE_DREF:
+        optimization_process_expression (flags, expression->image_sample.sampler);
+        optimization_process_expression (flags, expression->image_sample.image);
+        optimization_process_list (flags, expression->image_sample.first_argument);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_VECTOR_CONSTRUCTOR:
+        optimization_process_list (flags, expression->vector_constructor.first_argument);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_MATRIX_CONSTRUCTOR:
+        optimization_process_list (flags, expression->matrix_constructor.first_argument);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_STRUCT_CONSTRUCTOR:
+        optimization_process_list (flags, expression->struct_constructor.first_argument);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_IF:
+        optimization_process_expression (flags, expression->if_.condition);
+        optimization_process_expression (flags, expression->if_.when_true);
+        optimization_process_expression (flags, expression->if_.when_false);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_FOR:
+        optimization_process_expression (flags, expression->for_.init);
+        optimization_process_expression (flags, expression->for_.condition);
+        optimization_process_expression (flags, expression->for_.step);
+        optimization_process_expression (flags, expression->for_.body);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_WHILE:
+        optimization_process_expression (flags, expression->while_.condition);
+        optimization_process_expression (flags, expression->while_.body);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_RETURN:
+        optimization_process_expression (flags, expression->return_expression);
+        break;
+    }
+}
+
+static void optimization_mark_reachable_list (struct compiler_instance_expression_list_item_t *list);
+
+static void optimization_mark_reachable_function (struct compiler_instance_function_node_t *function);
+
+static void optimization_mark_reachable (struct compiler_instance_expression_node_t *expression)
+{
+    if (!expression)
+    {
+        return;
+    }
+
+    switch (expression->type)
+    {
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_STRUCTURED_ACCESS:
+        optimization_mark_reachable (expression->structured_access.input);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_SWIZZLE:
+        optimization_mark_reachable (expression->swizzle.input);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_ARRAY_INDEX:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_ADD:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_SUBTRACT:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_MULTIPLY:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_DIVIDE:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_MODULUS:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_ASSIGN:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_AND:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_OR:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_EQUAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_NOT_EQUAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_LESS:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_GREATER:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_LESS_OR_EQUAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_GREATER_OR_EQUAL:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_AND:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_OR:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_XOR:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_LEFT_SHIFT:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_RIGHT_SHIFT:
+        optimization_mark_reachable (expression->binary_operation.left_operand);
+        optimization_mark_reachable (expression->binary_operation.right_operand);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_NEGATE:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_NOT:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_OPERATION_BITWISE_NOT:
+        optimization_mark_reachable (expression->unary_operation.operand);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_SCOPE:
+        optimization_mark_reachable_list (expression->scope.first_expression);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_FUNCTION_CALL:
+        optimization_mark_reachable_function (expression->function_call.function);
+        optimization_mark_reachable_list (expression->function_call.first_argument);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_IMAGE_SAMPLE:
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_IMAGE_SAMPLE_DREF:
+        optimization_mark_reachable (expression->image_sample.sampler);
+        optimization_mark_reachable (expression->image_sample.image);
+        optimization_mark_reachable_list (expression->image_sample.first_argument);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_VECTOR_CONSTRUCTOR:
+        optimization_mark_reachable_list (expression->vector_constructor.first_argument);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_MATRIX_CONSTRUCTOR:
+        optimization_mark_reachable_list (expression->matrix_constructor.first_argument);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_STRUCT_CONSTRUCTOR:
+        optimization_mark_reachable_list (expression->struct_constructor.first_argument);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_IF:
+        optimization_mark_reachable (expression->if_.condition);
+        optimization_mark_reachable (expression->if_.when_true);
+        optimization_mark_reachable (expression->if_.when_false);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_FOR:
+        optimization_mark_reachable (expression->for_.init);
+        optimization_mark_reachable (expression->for_.condition);
+        optimization_mark_reachable (expression->for_.step);
+        optimization_mark_reachable (expression->for_.body);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_WHILE:
+        optimization_mark_reachable (expression->while_.condition);
+        optimization_mark_reachable (expression->while_.body);
+        break;
+
+    case COMPILER_INSTANCE_EXPRESSION_TYPE_RETURN:
+        optimization_mark_reachable (expression->return_expression);
+        break;
+
+    default:
+        // Leaf expressions cannot call functions.
+        break;
+    }
+}
+
+static void optimization_mark_reachable_list (struct compiler_instance_expression_list_item_t *list)
+{
+    while (list)
+    {
+        optimization_mark_reachable (list->expression);
+        list = list->next;
+    }
+}
+
+static void optimization_mark_reachable_function (struct compiler_instance_function_node_t *function)
+{
+    // Builtin functions have no body and are shared between instances, so we must not write into them.
+    if (!function->body || function->optimization_reachable)
+    {
+        return;
+    }
+
+    function->optimization_reachable = true;
+    optimization_mark_reachable (function->body);
+}
+
+static void optimization_remove_dead_functions (struct rpl_compiler_instance_t *instance)
+{
+    struct compiler_instance_function_node_t *function = instance->first_function;
+    while (function)
+    {
+        function->optimization_reachable = false;
+        function = function->next;
+    }
+
+    for (kan_loop_size_t entry_point_index = 0u; entry_point_index < instance->entry_point_count;
+         ++entry_point_index)
+    {
+        function = instance->first_function;
+        while (function)
+        {
+            if (function->name == instance->entry_points[entry_point_index].function_name)
+            {
+                optimization_mark_reachable_function (function);
+                break;
+            }
+
+            function = function->next;
+        }
+    }
+
+    struct compiler_instance_function_node_t *previous = NULL;
+    function = instance->first_function;
+
+    while (function)
+    {
+        struct compiler_instance_function_node_t *next = function->next;
+        if (function->optimization_reachable)
+        {
+            previous = function;
+        }
+        else if (previous)
+        {
+            previous->next = next;
+        }
+        else
+        {
+            instance->first_function = next;
+        }
+
+        function = next;
+    }
+
+    instance->last_function = previous;
+}
+
+void kan_rpl_compiler_instance_optimize (kan_rpl_compiler_instance_t compiler_instance,
+                                         enum kan_rpl_optimization_flags_t flags)
+{
+    struct rpl_compiler_instance_t *instance = KAN_HANDLE_GET (compiler_instance);
+    if (flags & (KAN_RPL_OPTIMIZATION_CONSTANT_FOLDING | KAN_RPL_OPTIMIZATION_DEAD_BRANCHES))
+    {
+        struct compiler_instance_function_node_t *function = instance->first_function;
+        while (function)
+        {
+            optimization_process_expression (flags, function->body);
+            function = function->next;
+        }
+    }
+
+    if ((flags & KAN_RPL_OPTIMIZATION_DEAD_FUNCTIONS) && instance->entry_point_count > 0u)
+    {
+        optimization_remove_dead_functions (instance);
+    }
+}
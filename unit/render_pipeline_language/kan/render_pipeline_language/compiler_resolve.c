@@ -6542,7 +6542,12 @@ kan_rpl_compiler_instance_t kan_rpl_compiler_context_resolve (kan_rpl_compiler_c
                                                               struct kan_rpl_entry_point_t *entry_points)
 {
     kan_static_interned_ids_ensure_initialized ();
-    struct rpl_compiler_context_t *context = KAN_HANDLE_GET (compiler_context);
+    // Shallow copy with its own temporary allocator, so shared context is not modified and can be resolved in parallel.
+    struct rpl_compiler_context_t context_copy = *(struct rpl_compiler_context_t *) KAN_HANDLE_GET (compiler_context);
+    kan_stack_group_allocator_init (&context_copy.resolve_allocator, STATICS.rpl_compiler_context_allocation_group,
+                                    KAN_RPL_COMPILER_CONTEXT_RESOLVE_STACK);
+
+    struct rpl_compiler_context_t *context = &context_copy;
     struct rpl_compiler_instance_t *instance =
         kan_allocate_general (STATICS.rpl_compiler_instance_allocation_group, sizeof (struct rpl_compiler_instance_t),
                               alignof (struct rpl_compiler_instance_t));
@@ -6663,7 +6668,7 @@ kan_rpl_compiler_instance_t kan_rpl_compiler_context_resolve (kan_rpl_compiler_c
         }
     }
 
-    kan_stack_group_allocator_reset (&context->resolve_allocator);
+    kan_stack_group_allocator_shutdown (&context->resolve_allocator);
     kan_rpl_compiler_instance_t handle = KAN_HANDLE_SET (kan_rpl_compiler_instance_t, instance);
 
     if (successfully_resolved)
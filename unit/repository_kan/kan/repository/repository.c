@@ -4077,47 +4077,264 @@ void kan_repository_prepare_for_migration (kan_repository_t root_repository,
     repository_prepare_for_migration_internal (repository, migration_seed);
 }
 
-KAN_CPU_TASK_BATCHED_HEADER (execute_migration) { kan_reflection_struct_migrator_t migrator; };
-
-KAN_CPU_TASK_BATCHED_BODY (execute_migration)
+struct migration_types_t
 {
-    void **record_pointer;
-    kan_allocation_group_t allocation_group;
-    bool batched_allocation;
+    kan_reflection_struct_migrator_t migrator;
     const struct kan_reflection_struct_t *old_type;
     const struct kan_reflection_struct_t *new_type;
+    kan_allocation_group_t allocation_group;
+};
+
+struct singleton_migration_user_data_t
+{
+    struct migration_types_t types;
+    struct singleton_storage_node_t *storage;
 };
 
-KAN_CPU_TASK_BATCHED_DEFINE (execute_migration)
+static void execute_singleton_migration (kan_functor_user_data_t user_data)
 {
-    void *old_object = *body->record_pointer;
-    void *new_object = body->batched_allocation ? kan_allocate_batched (body->allocation_group, body->new_type->size) :
-                                                  kan_allocate_general (body->allocation_group, body->new_type->size,
-                                                                        body->new_type->alignment);
+    struct singleton_migration_user_data_t *data = (struct singleton_migration_user_data_t *) user_data;
+    const struct kan_reflection_struct_t *old_type = data->types.old_type;
+    const struct kan_reflection_struct_t *new_type = data->types.new_type;
 
-    if (body->new_type->init)
+    void *old_object = data->storage->singleton;
+    void *new_object = kan_allocate_general (data->types.allocation_group, new_type->size, new_type->alignment);
+
+    if (new_type->init)
     {
-        kan_allocation_group_stack_push (body->allocation_group);
-        body->new_type->init (body->new_type->functor_user_data, new_object);
+        kan_allocation_group_stack_push (data->types.allocation_group);
+        new_type->init (new_type->functor_user_data, new_object);
         kan_allocation_group_stack_pop ();
     }
 
-    kan_reflection_struct_migrator_migrate_instance (header->migrator, body->new_type->name, old_object, new_object);
-    if (body->old_type->shutdown)
+    kan_reflection_struct_migrator_migrate_instance (data->types.migrator, new_type->name, old_object, new_object);
+    if (old_type->shutdown)
+    {
+        old_type->shutdown (old_type->functor_user_data, old_object);
+    }
+
+    kan_free_general (data->types.allocation_group, old_object, old_type->size);
+    data->storage->singleton = new_object;
+}
+
+/// \brief Max value for KAN_REPOSITORY_MIGRATION_CHUNK_RECORDS.
+/// \details Migration tasks keep three pointer arrays of chunk size on their stacks, which is 24 kilobytes on 64-bit
+///          platforms for the max value. Bigger chunks do not make migration faster anyway: there would be too few
+///          tasks to load all the workers.
+#define MIGRATION_CHUNK_RECORDS_MAX 1024u
+
+static_assert (KAN_REPOSITORY_MIGRATION_CHUNK_RECORDS > 0u &&
+                   KAN_REPOSITORY_MIGRATION_CHUNK_RECORDS <= MIGRATION_CHUNK_RECORDS_MAX,
+               "Migration chunk records count must be in [1, 1024] range as chunk pointers are stored on task stack.");
+
+/// \brief Migrates chunk of batch-allocated records through one batched migrator call and replaces record pointers.
+static void migrate_records_chunk (const struct migration_types_t *types,
+                                   kan_instance_size_t count,
+                                   void **record_pointers[])
+{
+    KAN_ASSERT (count <= KAN_REPOSITORY_MIGRATION_CHUNK_RECORDS)
+    void *old_objects[KAN_REPOSITORY_MIGRATION_CHUNK_RECORDS];
+    void *new_objects[KAN_REPOSITORY_MIGRATION_CHUNK_RECORDS];
+
+    if (types->new_type->init)
     {
-        body->old_type->shutdown (body->old_type->functor_user_data, old_object);
+        kan_allocation_group_stack_push (types->allocation_group);
     }
 
-    if (body->batched_allocation)
+    for (kan_loop_size_t index = 0u; index < count; ++index)
     {
-        kan_free_batched (body->allocation_group, old_object);
+        old_objects[index] = *record_pointers[index];
+        new_objects[index] = kan_allocate_batched (types->allocation_group, types->new_type->size);
+
+        if (types->new_type->init)
+        {
+            types->new_type->init (types->new_type->functor_user_data, new_objects[index]);
+        }
     }
-    else
+
+    if (types->new_type->init)
     {
-        kan_free_general (body->allocation_group, old_object, body->old_type->size);
+        kan_allocation_group_stack_pop ();
     }
 
-    *body->record_pointer = new_object;
+    kan_reflection_struct_migrator_migrate_instances (types->migrator, types->new_type->name, count, old_objects,
+                                                      new_objects);
+
+    for (kan_loop_size_t index = 0u; index < count; ++index)
+    {
+        if (types->old_type->shutdown)
+        {
+            types->old_type->shutdown (types->old_type->functor_user_data, old_objects[index]);
+        }
+
+        kan_free_batched (types->allocation_group, old_objects[index]);
+        *record_pointers[index] = new_objects[index];
+    }
+}
+
+/// \details Records are stored in lists, therefore chunk is described by its first node and count of nodes.
+///          Task walks the list by itself, so preparation only needs to find chunk beginnings.
+struct indexed_records_migration_user_data_t
+{
+    struct migration_types_t types;
+    struct indexed_storage_record_node_t *first;
+    kan_instance_size_t count;
+};
+
+static void execute_indexed_records_migration (kan_functor_user_data_t user_data)
+{
+    struct indexed_records_migration_user_data_t *data = (struct indexed_records_migration_user_data_t *) user_data;
+    struct indexed_storage_record_node_t *node = data->first;
+    void **record_pointers[KAN_REPOSITORY_MIGRATION_CHUNK_RECORDS];
+
+    for (kan_loop_size_t index = 0u; index < data->count; ++index)
+    {
+        KAN_ASSERT (node)
+        record_pointers[index] = &node->record;
+        node = (struct indexed_storage_record_node_t *) node->list_node.next;
+    }
+
+    migrate_records_chunk (&data->types, data->count, record_pointers);
+}
+
+struct events_migration_user_data_t
+{
+    struct migration_types_t types;
+    struct event_queue_node_t *first;
+    kan_instance_size_t count;
+};
+
+static void execute_events_migration (kan_functor_user_data_t user_data)
+{
+    struct events_migration_user_data_t *data = (struct events_migration_user_data_t *) user_data;
+    struct event_queue_node_t *node = data->first;
+    void **record_pointers[KAN_REPOSITORY_MIGRATION_CHUNK_RECORDS];
+
+    for (kan_loop_size_t index = 0u; index < data->count; ++index)
+    {
+        record_pointers[index] = &node->event;
+        node = (struct event_queue_node_t *) node->node.next;
+    }
+
+    migrate_records_chunk (&data->types, data->count, record_pointers);
+}
+
+struct indices_migration_user_data_t
+{
+    struct indexed_storage_node_t *storage;
+    kan_reflection_registry_t new_registry;
+    kan_interned_string_t type_name;
+};
+
+static void execute_indices_migration (kan_functor_user_data_t user_data)
+{
+    struct indices_migration_user_data_t *data = (struct indices_migration_user_data_t *) user_data;
+    struct indexed_storage_node_t *indexed_storage_node = data->storage;
+    const kan_reflection_registry_t new_registry = data->new_registry;
+    const kan_interned_string_t type_name = data->type_name;
+
+#define HELPER_UPDATE_SINGLE_FIELD_INDEX(INDEX_TYPE, ARCHETYPE_OUTPUT, ALLOW_NOT_COMPARABLE)                           \
+    struct INDEX_TYPE##_index_t *INDEX_TYPE##_index = indexed_storage_node->first_##INDEX_TYPE##_index;                \
+    struct INDEX_TYPE##_index_t *previous_##INDEX_TYPE##_index = NULL;                                                 \
+                                                                                                                       \
+    while (INDEX_TYPE##_index)                                                                                         \
+    {                                                                                                                  \
+        struct INDEX_TYPE##_index_t *next_##INDEX_TYPE##_index = INDEX_TYPE##_index->next;                             \
+        if (!indexed_field_baked_data_bake_from_reflection (&INDEX_TYPE##_index->baked, new_registry, type_name,       \
+                                                            INDEX_TYPE##_index->source_path, ARCHETYPE_OUTPUT, NULL,   \
+                                                            ALLOW_NOT_COMPARABLE))                                     \
+        {                                                                                                              \
+            INDEX_TYPE##_index_shutdown_and_free (INDEX_TYPE##_index);                                                 \
+                                                                                                                       \
+            if (previous_##INDEX_TYPE##_index)                                                                         \
+            {                                                                                                          \
+                previous_##INDEX_TYPE##_index->next = next_##INDEX_TYPE##_index;                                       \
+            }                                                                                                          \
+            else                                                                                                       \
+            {                                                                                                          \
+                indexed_storage_node->first_##INDEX_TYPE##_index = next_##INDEX_TYPE##_index;                          \
+            }                                                                                                          \
+        }                                                                                                              \
+        else                                                                                                           \
+        {                                                                                                              \
+            previous_##INDEX_TYPE##_index = INDEX_TYPE##_index;                                                        \
+        }                                                                                                              \
+                                                                                                                       \
+        INDEX_TYPE##_index = next_##INDEX_TYPE##_index;                                                                \
+    }
+
+    HELPER_UPDATE_SINGLE_FIELD_INDEX (value, NULL, true)
+    HELPER_UPDATE_SINGLE_FIELD_INDEX (signal, NULL, true)
+    HELPER_UPDATE_SINGLE_FIELD_INDEX (interval, &interval_index->baked_archetype, false)
+
+#undef HELPER_UPDATE_SINGLE_FIELD_INDEX
+
+    struct space_index_t *space_index = indexed_storage_node->first_space_index;
+    struct space_index_t *previous_space_index = NULL;
+
+    while (space_index)
+    {
+        struct space_index_t *next_space_index = space_index->next;
+        kan_instance_size_t min_size = 0u;
+        kan_instance_size_t max_size = 0u;
+
+        enum kan_reflection_archetype_t min_archetype = KAN_REFLECTION_ARCHETYPE_SIGNED_INT;
+        enum kan_reflection_archetype_t max_archetype = KAN_REFLECTION_ARCHETYPE_SIGNED_INT;
+
+        const bool min_baked = indexed_field_baked_data_bake_from_reflection (
+            &space_index->baked_min, new_registry, type_name, space_index->source_path_min, &min_archetype,
+            &min_size, false);
+
+        const bool max_baked = indexed_field_baked_data_bake_from_reflection (
+            &space_index->baked_max, new_registry, type_name, space_index->source_path_max, &max_archetype,
+            &max_size, false);
+
+        space_index->baked_archetype = min_archetype;
+        space_index->baked_dimension_count = min_size;
+
+        if (min_archetype != max_archetype)
+        {
+            KAN_LOG (repository, KAN_LOG_ERROR,
+                     "Failed to migrate space index on type %s, min and max archetypes mismatch detected.",
+                     type_name)
+        }
+
+        if (min_size != max_size)
+        {
+            KAN_LOG (
+                repository, KAN_LOG_ERROR,
+                "Failed to migrate space index on type %s, min and max array sizes do not match: %lu and %lu.",
+                type_name, (unsigned long) min_size, (unsigned long) max_size)
+        }
+
+        if (min_size > KAN_CONTAINER_SPACE_TREE_MAX_DIMENSIONS)
+        {
+            KAN_LOG (repository, KAN_LOG_ERROR,
+                     "Failed to migrate space index on type %s, min array size is bigger that allowed for "
+                     "space tree: %lu > %lu.",
+                     type_name, (unsigned long) min_size,
+                     (unsigned long) KAN_CONTAINER_SPACE_TREE_MAX_DIMENSIONS)
+        }
+
+        if (!min_baked || !max_baked || min_archetype != max_archetype || min_size != max_size ||
+            min_size > KAN_CONTAINER_SPACE_TREE_MAX_DIMENSIONS)
+        {
+            space_index_shutdown_and_free (space_index);
+            if (previous_space_index)
+            {
+                previous_space_index->next = next_space_index;
+            }
+            else
+            {
+                indexed_storage_node->first_space_index = next_space_index;
+            }
+        }
+        else
+        {
+            previous_space_index = space_index;
+        }
+        space_index = next_space_index;
+    }
 }
 
 static void repository_migrate_internal (struct repository_t *repository,
@@ -4130,12 +4347,6 @@ static void repository_migrate_internal (struct repository_t *repository,
     struct singleton_storage_node_t *singleton_storage_node =
         (struct singleton_storage_node_t *) repository->singleton_storages.items.first;
 
-    KAN_CPU_TASK_LIST_BATCHED_PREPARE (execute_migration, KAN_REPOSITORY_MIGRATION_TASK_BATCH_MIN,
-                                       KAN_REPOSITORY_MIGRATION_TASK_BATCH_ATE,
-                                       {
-                                           .migrator = migrator,
-                                       });
-
     while (singleton_storage_node)
     {
         struct singleton_storage_node_t *next =
@@ -4158,15 +4369,19 @@ static void repository_migrate_internal (struct repository_t *repository,
         {
         case KAN_REFLECTION_MIGRATION_NEEDED:
         {
-            KAN_CPU_TASK_LIST_BATCHED (&context->task_list, &context->allocator, execute_migration,
-                                       KAN_CPU_STATIC_SECTION_GET (repository_migration),
-                                       {
-                                           .record_pointer = &singleton_storage_node->singleton,
-                                           .allocation_group = singleton_storage_node->allocation_group,
-                                           .batched_allocation = false,
-                                           .old_type = old_type,
-                                           .new_type = new_type,
-                                       });
+            KAN_CPU_TASK_LIST_USER_STRUCT (&context->task_list, &context->allocator, execute_singleton_migration,
+                                           KAN_CPU_STATIC_SECTION_GET (repository_migration),
+                                           struct singleton_migration_user_data_t,
+                                           {
+                                               .types =
+                                                   {
+                                                       .migrator = migrator,
+                                                       .old_type = old_type,
+                                                       .new_type = new_type,
+                                                       .allocation_group = singleton_storage_node->allocation_group,
+                                                   },
+                                               .storage = singleton_storage_node,
+                                           });
             break;
         }
 
@@ -4208,125 +4423,43 @@ static void repository_migrate_internal (struct repository_t *repository,
         {
         case KAN_REFLECTION_MIGRATION_NEEDED:
         {
-#define HELPER_UPDATE_SINGLE_FIELD_INDEX(INDEX_TYPE, ARCHETYPE_OUTPUT, ALLOW_NOT_COMPARABLE)                           \
-    struct INDEX_TYPE##_index_t *INDEX_TYPE##_index = indexed_storage_node->first_##INDEX_TYPE##_index;                \
-    struct INDEX_TYPE##_index_t *previous_##INDEX_TYPE##_index = NULL;                                                 \
-                                                                                                                       \
-    while (INDEX_TYPE##_index)                                                                                         \
-    {                                                                                                                  \
-        struct INDEX_TYPE##_index_t *next_##INDEX_TYPE##_index = INDEX_TYPE##_index->next;                             \
-        if (!indexed_field_baked_data_bake_from_reflection (&INDEX_TYPE##_index->baked, new_registry, old_type->name,  \
-                                                            INDEX_TYPE##_index->source_path, ARCHETYPE_OUTPUT, NULL,   \
-                                                            ALLOW_NOT_COMPARABLE))                                     \
-        {                                                                                                              \
-            INDEX_TYPE##_index_shutdown_and_free (INDEX_TYPE##_index);                                                 \
-                                                                                                                       \
-            if (previous_##INDEX_TYPE##_index)                                                                         \
-            {                                                                                                          \
-                previous_##INDEX_TYPE##_index->next = next_##INDEX_TYPE##_index;                                       \
-            }                                                                                                          \
-            else                                                                                                       \
-            {                                                                                                          \
-                indexed_storage_node->first_##INDEX_TYPE##_index = next_##INDEX_TYPE##_index;                          \
-            }                                                                                                          \
-        }                                                                                                              \
-        else                                                                                                           \
-        {                                                                                                              \
-            previous_##INDEX_TYPE##_index = INDEX_TYPE##_index;                                                        \
-        }                                                                                                              \
-                                                                                                                       \
-        INDEX_TYPE##_index = next_##INDEX_TYPE##_index;                                                                \
-    }
-
-            HELPER_UPDATE_SINGLE_FIELD_INDEX (value, NULL, true)
-            HELPER_UPDATE_SINGLE_FIELD_INDEX (signal, NULL, true)
-            HELPER_UPDATE_SINGLE_FIELD_INDEX (interval, &interval_index->baked_archetype, false)
-
-#undef HELPER_UPDATE_SINGLE_FIELD_INDEX
+            KAN_CPU_TASK_LIST_USER_STRUCT (&context->task_list, &context->allocator, execute_indices_migration,
+                                           KAN_CPU_STATIC_SECTION_GET (repository_migration),
+                                           struct indices_migration_user_data_t,
+                                           {
+                                               .storage = indexed_storage_node,
+                                               .new_registry = new_registry,
+                                               .type_name = old_type->name,
+                                           });
 
-            struct space_index_t *space_index = indexed_storage_node->first_space_index;
-            struct space_index_t *previous_space_index = NULL;
+            struct indexed_storage_record_node_t *node =
+                (struct indexed_storage_record_node_t *) indexed_storage_node->records.first;
 
-            while (space_index)
+            while (node)
             {
-                struct space_index_t *next_space_index = space_index->next;
-                kan_instance_size_t min_size = 0u;
-                kan_instance_size_t max_size = 0u;
-
-                enum kan_reflection_archetype_t min_archetype = KAN_REFLECTION_ARCHETYPE_SIGNED_INT;
-                enum kan_reflection_archetype_t max_archetype = KAN_REFLECTION_ARCHETYPE_SIGNED_INT;
-
-                const bool min_baked = indexed_field_baked_data_bake_from_reflection (
-                    &space_index->baked_min, new_registry, old_type->name, space_index->source_path_min, &min_archetype,
-                    &min_size, false);
-
-                const bool max_baked = indexed_field_baked_data_bake_from_reflection (
-                    &space_index->baked_max, new_registry, old_type->name, space_index->source_path_max, &max_archetype,
-                    &max_size, false);
-
-                space_index->baked_archetype = min_archetype;
-                space_index->baked_dimension_count = min_size;
-
-                if (min_archetype != max_archetype)
-                {
-                    KAN_LOG (repository, KAN_LOG_ERROR,
-                             "Failed to migrate space index on type %s, min and max archetypes mismatch detected.",
-                             old_type->name)
-                }
-
-                if (min_size != max_size)
-                {
-                    KAN_LOG (
-                        repository, KAN_LOG_ERROR,
-                        "Failed to migrate space index on type %s, min and max array sizes do not match: %lu and %lu.",
-                        old_type->name, (unsigned long) min_size, (unsigned long) max_size)
-                }
+                struct indexed_storage_record_node_t *chunk_first = node;
+                kan_instance_size_t chunk_count = 0u;
 
-                if (min_size > KAN_CONTAINER_SPACE_TREE_MAX_DIMENSIONS)
+                while (node && chunk_count < KAN_REPOSITORY_MIGRATION_CHUNK_RECORDS)
                 {
-                    KAN_LOG (repository, KAN_LOG_ERROR,
-                             "Failed to migrate space index on type %s, min array size is bigger that allowed for "
-                             "space tree: %lu > %lu.",
-                             old_type->name, (unsigned long) min_size,
-                             (unsigned long) KAN_CONTAINER_SPACE_TREE_MAX_DIMENSIONS)
+                    ++chunk_count;
+                    node = (struct indexed_storage_record_node_t *) node->list_node.next;
                 }
 
-                if (!min_baked || !max_baked || min_archetype != max_archetype || min_size != max_size ||
-                    min_size > KAN_CONTAINER_SPACE_TREE_MAX_DIMENSIONS)
-                {
-                    space_index_shutdown_and_free (space_index);
-                    if (previous_space_index)
+                KAN_CPU_TASK_LIST_USER_STRUCT (
+                    &context->task_list, &context->allocator, execute_indexed_records_migration,
+                    KAN_CPU_STATIC_SECTION_GET (repository_migration), struct indexed_records_migration_user_data_t,
                     {
-                        previous_space_index->next = next_space_index;
-                    }
-                    else
-                    {
-                        indexed_storage_node->first_space_index = next_space_index;
-                    }
-                }
-                else
-                {
-                    previous_space_index = space_index;
-                }
-                space_index = next_space_index;
-            }
-
-            struct indexed_storage_record_node_t *node =
-                (struct indexed_storage_record_node_t *) indexed_storage_node->records.first;
-
-            while (node)
-            {
-                KAN_CPU_TASK_LIST_BATCHED (&context->task_list, &context->allocator, execute_migration,
-                                           KAN_CPU_STATIC_SECTION_GET (repository_migration),
-                                           {
-                                               .record_pointer = &node->record,
-                                               .allocation_group = indexed_storage_node->records_allocation_group,
-                                               .batched_allocation = true,
-                                               .old_type = old_type,
-                                               .new_type = new_type,
-                                           });
-
-                node = (struct indexed_storage_record_node_t *) node->list_node.next;
+                        .types =
+                            {
+                                .migrator = migrator,
+                                .old_type = old_type,
+                                .new_type = new_type,
+                                .allocation_group = indexed_storage_node->records_allocation_group,
+                            },
+                        .first = chunk_first,
+                        .count = chunk_count,
+                    });
             }
 
             break;
@@ -4372,17 +4505,30 @@ static void repository_migrate_internal (struct repository_t *repository,
             struct event_queue_node_t *node = (struct event_queue_node_t *) event_storage_node->event_queue.oldest;
             while (&node->node != event_storage_node->event_queue.next_placeholder)
             {
-                KAN_CPU_TASK_LIST_BATCHED (&context->task_list, &context->allocator, execute_migration,
-                                           KAN_CPU_STATIC_SECTION_GET (repository_migration),
-                                           {
-                                               .record_pointer = &node->event,
-                                               .allocation_group = event_storage_node->allocation_group,
-                                               .batched_allocation = true,
-                                               .old_type = old_type,
-                                               .new_type = new_type,
-                                           });
+                struct event_queue_node_t *chunk_first = node;
+                kan_instance_size_t chunk_count = 0u;
+
+                while (&node->node != event_storage_node->event_queue.next_placeholder &&
+                       chunk_count < KAN_REPOSITORY_MIGRATION_CHUNK_RECORDS)
+                {
+                    ++chunk_count;
+                    node = (struct event_queue_node_t *) node->node.next;
+                }
 
-                node = (struct event_queue_node_t *) node->node.next;
+                KAN_CPU_TASK_LIST_USER_STRUCT (&context->task_list, &context->allocator, execute_events_migration,
+                                               KAN_CPU_STATIC_SECTION_GET (repository_migration),
+                                               struct events_migration_user_data_t,
+                                               {
+                                                   .types =
+                                                       {
+                                                           .migrator = migrator,
+                                                           .old_type = old_type,
+                                                           .new_type = new_type,
+                                                           .allocation_group = event_storage_node->allocation_group,
+                                                       },
+                                                   .first = chunk_first,
+                                                   .count = chunk_count,
+                                               });
             }
 
             break;
@@ -26,6 +26,7 @@ void kan_resource_index_item_init (struct kan_resource_index_item_t *item)
 {
     item->name = NULL;
     item->path = NULL;
+    item->size = 0u;
 }
 
 void kan_resource_index_item_shutdown (struct kan_resource_index_item_t *item)
@@ -3,6 +3,7 @@
 #include <resource_pipeline_api.h>
 
 #include <kan/api_common/c_header.h>
+#include <kan/api_common/core_types.h>
 #include <kan/container/dynamic_array.h>
 #include <kan/container/interned_string.h>
 #include <kan/reflection/markup.h>
@@ -33,6 +34,9 @@ struct kan_resource_index_item_t
 {
     kan_interned_string_t name;
     char *path;
+
+    /// \brief Size of resource file in bytes, used by runtime as an estimation of resource loading cost.
+    kan_file_size_t size;
 };
 
 RESOURCE_PIPELINE_API void kan_resource_index_item_init (struct kan_resource_index_item_t *item);
@@ -26,6 +26,7 @@ void kan_resource_log_raw_entry_init (struct kan_resource_log_raw_entry_t *insta
     instance->name = NULL;
     instance->version.type_version = 0u;
     instance->version.last_modification_time = 0u;
+    instance->version.content_hash = KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
     instance->deployed = false;
 
     kan_dynamic_array_init (&instance->references, 0u, sizeof (struct kan_resource_log_reference_t),
@@ -60,11 +61,14 @@ void kan_resource_log_built_entry_init (struct kan_resource_log_built_entry_t *i
     instance->name = NULL;
     instance->version.type_version = 0u;
     instance->version.last_modification_time = 0u;
+    instance->version.content_hash = KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
     instance->platform_configuration_time = 0u;
     instance->rule_version = 0u;
     instance->primary_input_version.type_version = 0u;
     instance->primary_input_version.last_modification_time = 0u;
+    instance->primary_input_version.content_hash = KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
     instance->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE;
+    instance->build_rule_duration_ns = 0u;
 
     kan_dynamic_array_init (&instance->references, 0u, sizeof (struct kan_resource_log_reference_t),
                             alignof (struct kan_resource_log_reference_t), allocation_group);
@@ -83,6 +87,7 @@ void kan_resource_log_built_entry_init_copy (struct kan_resource_log_built_entry
     instance->rule_version = copy_from->rule_version;
     instance->primary_input_version = copy_from->primary_input_version;
     instance->saved_directory = copy_from->saved_directory;
+    instance->build_rule_duration_ns = copy_from->build_rule_duration_ns;
 
     kan_dynamic_array_init (&instance->references, copy_from->references.size,
                             sizeof (struct kan_resource_log_reference_t), alignof (struct kan_resource_log_reference_t),
@@ -113,12 +118,14 @@ void kan_resource_log_secondary_entry_init (struct kan_resource_log_secondary_en
     instance->name = NULL;
     instance->version.type_version = 0u;
     instance->version.last_modification_time = 0u;
+    instance->version.content_hash = KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
     instance->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY;
 
     instance->producer_type = NULL;
     instance->producer_name = NULL;
     instance->producer_version.type_version = 0u;
     instance->producer_version.last_modification_time = 0u;
+    instance->producer_version.content_hash = KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
 
     kan_dynamic_array_init (&instance->references, 0u, sizeof (struct kan_resource_log_reference_t),
                             alignof (struct kan_resource_log_reference_t), allocation_group);
@@ -44,11 +44,20 @@ struct kan_resource_log_reference_t
     enum kan_resource_reference_flags_t flags;
 };
 
-/// \brief Contains full resource version: type version in code and file timestamp.
+/// \brief Value of kan_resource_log_version_t::content_hash that means that content hash is unknown.
+#define KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN 0u
+
+/// \brief Contains full resource version: type version in code, file timestamp and file content hash.
+/// \details Timestamps can be changed without changing the file content, for example by version control checkout,
+///          CI cache restore or file movement on some OSes. Therefore, content hash is used as a fallback when
+///          timestamps do not match, so only resources with really changed content are rebuilt.
 struct kan_resource_log_version_t
 {
     kan_resource_version_t type_version;
     kan_time_size_t last_modification_time;
+
+    /// \brief Checksum of the file content or KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN if it wasn't calculated.
+    kan_file_size_t content_hash;
 };
 
 /// \brief Returns true if logged version is decided new enough to not cause a rebuild compared to detected version.
@@ -56,7 +65,9 @@ static inline bool kan_resource_log_version_is_up_to_date (struct kan_resource_l
                                                            struct kan_resource_log_version_t detected)
 {
     return logged.type_version == detected.type_version &&
-           logged.last_modification_time == detected.last_modification_time;
+           (logged.last_modification_time == detected.last_modification_time ||
+            (logged.content_hash != KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN &&
+             logged.content_hash == detected.content_hash));
 }
 
 /// \brief Resource build action log entry for raw resources.
@@ -118,6 +129,10 @@ struct kan_resource_log_built_entry_t
     struct kan_resource_log_version_t primary_input_version;
     enum kan_resource_log_saved_directory_t saved_directory;
 
+    /// \brief Wall time in nanoseconds spent on the last build rule execution for this resource or zero if unknown.
+    /// \details Used to estimate length of dependant build chains and prioritize them on subsequent builds.
+    kan_time_size_t build_rule_duration_ns;
+
     /// \brief List of resource references that were found in this resource.
     KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (struct kan_resource_log_reference_t)
     struct kan_dynamic_array_t references;
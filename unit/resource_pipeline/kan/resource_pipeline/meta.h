@@ -139,6 +139,24 @@ KAN_HANDLE_DEFINE (kan_resource_build_rule_interface_t);
 typedef bool (*kan_resource_build_rule_produce_secondary_output_functor_t) (
     kan_resource_build_rule_interface_t interface, kan_interned_string_t type, kan_interned_string_t name, void *data);
 
+/// \brief Declares signature for loading data of given type from rule cache under given key.
+/// \details Rule cache is a persistent workspace storage for the data that build rules are able to reuse between
+///          different resources and different builds, for example compiled code that depends only on content of
+///          several inputs. Key is fully calculated by build rule and must include everything that affects cached data,
+///          except for the cached type version, which is taken into account automatically. `output` must be already
+///          initialized. Returns true if data was found and loaded, otherwise output might be partially filled.
+typedef bool (*kan_resource_build_rule_load_cached_functor_t) (kan_resource_build_rule_interface_t interface,
+                                                               kan_interned_string_t type,
+                                                               kan_file_size_t key,
+                                                               void *output);
+
+/// \brief Declares signature for storing data of given type in rule cache under given key.
+/// \details Failure to store data is not an error, it is only reported through logs.
+typedef void (*kan_resource_build_rule_store_cached_functor_t) (kan_resource_build_rule_interface_t interface,
+                                                                kan_interned_string_t type,
+                                                                kan_file_size_t key,
+                                                                const void *data);
+
 /// \brief Context that is provided to build rule execution functor.
 struct kan_resource_build_rule_context_t
 {
@@ -173,6 +191,12 @@ struct kan_resource_build_rule_context_t
 
     /// \brief Functor that is used to produce secondary outputs.
     kan_resource_build_rule_produce_secondary_output_functor_t produce_secondary_output;
+
+    /// \brief Functor that is used to load data from rule cache.
+    kan_resource_build_rule_load_cached_functor_t load_cached;
+
+    /// \brief Functor that is used to store data in rule cache.
+    kan_resource_build_rule_store_cached_functor_t store_cached;
 };
 
 /// \brief Functor for build rule implementation logic.
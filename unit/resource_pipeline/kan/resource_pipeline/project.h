@@ -48,6 +48,10 @@ RESOURCE_PIPELINE_API void kan_resource_project_target_shutdown (struct kan_reso
 /// \brief Temporary data for every target must be stored in "<workspace>/temporary/<target_name>".
 #define KAN_RESOURCE_PROJECT_WORKSPACE_TEMPORARY_DIRECTORY "temporary"
 
+/// \brief Data cached by build rules must be stored in "<workspace>/rule_cache".
+/// \details Unlike other directories, rule cache is shared between targets as its keys are calculated from content.
+#define KAN_RESOURCE_PROJECT_WORKSPACE_RULE_CACHE_DIRECTORY "rule_cache"
+
 /// \brief Defines project format for application framework tools.
 struct kan_resource_project_t
 {
@@ -0,0 +1,64 @@
+#include <kan/memory/allocation.h>
+#include <kan/resource_pipeline/scan_snapshot.h>
+
+static kan_allocation_group_t allocation_group;
+static bool statics_initialized = false;
+
+static void ensure_statics_initialized (void)
+{
+    if (!statics_initialized)
+    {
+        allocation_group =
+            kan_allocation_group_get_child (kan_allocation_group_root (), "resource_pipeline_scan_snapshot");
+        statics_initialized = true;
+    }
+}
+
+kan_allocation_group_t kan_resource_scan_snapshot_get_allocation_group (void)
+{
+    ensure_statics_initialized ();
+    return allocation_group;
+}
+
+void kan_resource_scan_snapshot_directory_init (struct kan_resource_scan_snapshot_directory_t *instance)
+{
+    ensure_statics_initialized ();
+    instance->path = NULL;
+    instance->last_modification_time = 0u;
+
+    kan_dynamic_array_init (&instance->files, 0u, sizeof (struct kan_resource_scan_snapshot_file_t),
+                            alignof (struct kan_resource_scan_snapshot_file_t), allocation_group);
+    kan_dynamic_array_init (&instance->directories, 0u, sizeof (kan_interned_string_t),
+                            alignof (kan_interned_string_t), allocation_group);
+}
+
+void kan_resource_scan_snapshot_directory_shutdown (struct kan_resource_scan_snapshot_directory_t *instance)
+{
+    kan_dynamic_array_shutdown (&instance->files);
+    kan_dynamic_array_shutdown (&instance->directories);
+}
+
+void kan_resource_scan_snapshot_target_init (struct kan_resource_scan_snapshot_target_t *instance)
+{
+    ensure_statics_initialized ();
+    instance->name = NULL;
+    kan_dynamic_array_init (&instance->directories, 0u, sizeof (struct kan_resource_scan_snapshot_directory_t),
+                            alignof (struct kan_resource_scan_snapshot_directory_t), allocation_group);
+}
+
+void kan_resource_scan_snapshot_target_shutdown (struct kan_resource_scan_snapshot_target_t *instance)
+{
+    KAN_DYNAMIC_ARRAY_SHUTDOWN_WITH_ITEMS_AUTO (instance->directories, kan_resource_scan_snapshot_directory)
+}
+
+void kan_resource_scan_snapshot_init (struct kan_resource_scan_snapshot_t *instance)
+{
+    ensure_statics_initialized ();
+    kan_dynamic_array_init (&instance->targets, 0u, sizeof (struct kan_resource_scan_snapshot_target_t),
+                            alignof (struct kan_resource_scan_snapshot_target_t), allocation_group);
+}
+
+void kan_resource_scan_snapshot_shutdown (struct kan_resource_scan_snapshot_t *instance)
+{
+    KAN_DYNAMIC_ARRAY_SHUTDOWN_WITH_ITEMS_AUTO (instance->targets, kan_resource_scan_snapshot_target)
+}
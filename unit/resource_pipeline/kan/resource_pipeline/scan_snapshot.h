@@ -0,0 +1,94 @@
+#pragma once
+
+#include <resource_pipeline_api.h>
+
+#include <kan/api_common/c_header.h>
+#include <kan/api_common/core_types.h>
+#include <kan/container/dynamic_array.h>
+#include <kan/container/interned_string.h>
+#include <kan/reflection/markup.h>
+
+/// \file
+/// \brief Contains data structures for persisted snapshot of raw resource directories.
+///
+/// \par Overview
+/// \parblock
+/// Scanning target directories for raw resources requires iterating every directory, querying status of every file
+/// and reading type headers of native resources, which is slow for big resource trees even when nothing has changed.
+/// Scan snapshot stores results of the previous scan in workspace, so next scan can skip most of this work:
+///
+/// - Directory with unchanged last modification time still has the same list of children as entries are neither
+///   added, removed nor renamed there. Therefore, children from snapshot are reused without iterating directory.
+///   Child directories are still checked as their content might have changed.
+/// - When directory is changed, native files with unchanged size and last modification time reuse resource type
+///   from snapshot instead of reading type header.
+///
+/// File content changes are not detected through the snapshot, they're detected by build routine using resource log.
+/// \endparblock
+
+KAN_C_HEADER_BEGIN
+
+RESOURCE_PIPELINE_API kan_allocation_group_t kan_resource_scan_snapshot_get_allocation_group (void);
+
+/// \brief Default name for scan snapshot file in workspace.
+#define KAN_RESOURCE_SCAN_SNAPSHOT_DEFAULT_NAME ".resource_scan_snapshot"
+
+/// \brief Describes one file that was found during scan.
+struct kan_resource_scan_snapshot_file_t
+{
+    /// \brief File name without directory path.
+    kan_interned_string_t name;
+
+    /// \brief Type of native resource or NULL if file is a third party resource.
+    kan_interned_string_t native_type;
+
+    kan_file_size_t size;
+    kan_time_size_t last_modification_time;
+};
+
+/// \brief Describes one scanned directory.
+struct kan_resource_scan_snapshot_directory_t
+{
+    kan_interned_string_t path;
+    kan_time_size_t last_modification_time;
+
+    KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (struct kan_resource_scan_snapshot_file_t)
+    struct kan_dynamic_array_t files;
+
+    /// \brief Names of child directories.
+    KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (kan_interned_string_t)
+    struct kan_dynamic_array_t directories;
+};
+
+RESOURCE_PIPELINE_API void kan_resource_scan_snapshot_directory_init (
+    struct kan_resource_scan_snapshot_directory_t *instance);
+
+RESOURCE_PIPELINE_API void kan_resource_scan_snapshot_directory_shutdown (
+    struct kan_resource_scan_snapshot_directory_t *instance);
+
+/// \brief Contains all scanned directories of one target.
+struct kan_resource_scan_snapshot_target_t
+{
+    kan_interned_string_t name;
+
+    KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (struct kan_resource_scan_snapshot_directory_t)
+    struct kan_dynamic_array_t directories;
+};
+
+RESOURCE_PIPELINE_API void kan_resource_scan_snapshot_target_init (struct kan_resource_scan_snapshot_target_t *instance);
+
+RESOURCE_PIPELINE_API void kan_resource_scan_snapshot_target_shutdown (
+    struct kan_resource_scan_snapshot_target_t *instance);
+
+/// \brief Scan snapshot root data structure.
+struct kan_resource_scan_snapshot_t
+{
+    KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (struct kan_resource_scan_snapshot_target_t)
+    struct kan_dynamic_array_t targets;
+};
+
+RESOURCE_PIPELINE_API void kan_resource_scan_snapshot_init (struct kan_resource_scan_snapshot_t *instance);
+
+RESOURCE_PIPELINE_API void kan_resource_scan_snapshot_shutdown (struct kan_resource_scan_snapshot_t *instance);
+
+KAN_C_HEADER_END
@@ -0,0 +1,40 @@
+#include <kan/memory/allocation.h>
+#include <kan/resource_pipeline/timing_report.h>
+
+static kan_allocation_group_t allocation_group;
+static bool statics_initialized = false;
+
+static void ensure_statics_initialized (void)
+{
+    if (!statics_initialized)
+    {
+        allocation_group =
+            kan_allocation_group_get_child (kan_allocation_group_root (), "resource_pipeline_timing_report");
+        statics_initialized = true;
+    }
+}
+
+kan_allocation_group_t kan_resource_timing_report_get_allocation_group (void)
+{
+    ensure_statics_initialized ();
+    return allocation_group;
+}
+
+void kan_resource_timing_report_init (struct kan_resource_timing_report_t *instance)
+{
+    ensure_statics_initialized ();
+    instance->build_wall_ns = 0u;
+    instance->rules_wall_ns = 0u;
+    instance->rules_cpu_ns = 0u;
+
+    kan_dynamic_array_init (&instance->rules, 0u, sizeof (struct kan_resource_timing_report_rule_t),
+                            alignof (struct kan_resource_timing_report_rule_t), allocation_group);
+    kan_dynamic_array_init (&instance->entries, 0u, sizeof (struct kan_resource_timing_report_entry_t),
+                            alignof (struct kan_resource_timing_report_entry_t), allocation_group);
+}
+
+void kan_resource_timing_report_shutdown (struct kan_resource_timing_report_t *instance)
+{
+    kan_dynamic_array_shutdown (&instance->rules);
+    kan_dynamic_array_shutdown (&instance->entries);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <resource_pipeline_api.h>
+
+#include <kan/api_common/c_header.h>
+#include <kan/api_common/core_types.h>
+#include <kan/container/dynamic_array.h>
+#include <kan/container/interned_string.h>
+#include <kan/reflection/markup.h>
+
+/// \file
+/// \brief Contains data structures for resource build timing report.
+///
+/// \par Overview
+/// \parblock
+/// Timing report is an optional output of resource build that describes where build time was spent. It is saved in
+/// readable data format, so it can be inspected by hand or processed by scripts. Every build rule execution is listed
+/// separately and build rules are also aggregated by the type they produce. Both wall time and CPU time of the thread
+/// that executed the rule are recorded: when wall time is noticeably bigger than CPU time, rule is most likely waiting
+/// for IO or for other tasks.
+/// \endparblock
+
+KAN_C_HEADER_BEGIN
+
+RESOURCE_PIPELINE_API kan_allocation_group_t kan_resource_timing_report_get_allocation_group (void);
+
+/// \brief Describes one build rule execution.
+struct kan_resource_timing_report_entry_t
+{
+    kan_interned_string_t target;
+    kan_interned_string_t type;
+    kan_interned_string_t name;
+    kan_time_size_t wall_ns;
+    kan_time_size_t cpu_ns;
+};
+
+/// \brief Aggregated build rule executions for one build rule, which is identified by the type it produces.
+struct kan_resource_timing_report_rule_t
+{
+    kan_interned_string_t type;
+    kan_instance_size_t executions;
+    kan_time_size_t wall_ns_total;
+    kan_time_size_t wall_ns_max;
+    kan_time_size_t cpu_ns_total;
+};
+
+/// \brief Default name for resource build timing report file.
+#define KAN_RESOURCE_TIMING_REPORT_DEFAULT_NAME "resource_timing_report.rd"
+
+/// \brief Resource build timing report root data structure.
+struct kan_resource_timing_report_t
+{
+    /// \brief Wall time of the whole build step, including loading and saving, in nanoseconds.
+    kan_time_size_t build_wall_ns;
+
+    /// \brief Sum of wall times of all build rule executions.
+    kan_time_size_t rules_wall_ns;
+
+    /// \brief Sum of CPU times of all build rule executions.
+    kan_time_size_t rules_cpu_ns;
+
+    /// \brief Build rules aggregated by produced type, sorted by total wall time in descending order.
+    KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (struct kan_resource_timing_report_rule_t)
+    struct kan_dynamic_array_t rules;
+
+    /// \brief All build rule executions, sorted by wall time in descending order.
+    KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (struct kan_resource_timing_report_entry_t)
+    struct kan_dynamic_array_t entries;
+};
+
+RESOURCE_PIPELINE_API void kan_resource_timing_report_init (struct kan_resource_timing_report_t *instance);
+
+RESOURCE_PIPELINE_API void kan_resource_timing_report_shutdown (struct kan_resource_timing_report_t *instance);
+
+KAN_C_HEADER_END
@@ -1,5 +1,7 @@
 #include <qsort.h>
+#include <stdio.h>
 
+#include <kan/checksum/checksum.h>
 #include <kan/cpu_dispatch/job.h>
 #include <kan/error/critical.h>
 #include <kan/file_system/entry.h>
@@ -15,6 +17,8 @@
 #include <kan/resource_pipeline/index.h>
 #include <kan/resource_pipeline/log.h>
 #include <kan/resource_pipeline/platform_configuration.h>
+#include <kan/resource_pipeline/scan_snapshot.h>
+#include <kan/resource_pipeline/timing_report.h>
 #include <kan/serialization/binary.h>
 #include <kan/serialization/readable_data.h>
 #include <kan/stream/random_access_stream_buffer.h>
@@ -23,6 +27,7 @@
 
 static kan_resource_version_t resource_build_version = CUSHION_START_NS_X64;
 KAN_LOG_DEFINE_CATEGORY (resource_pipeline_build);
+KAN_REFLECTION_EXPECT_UNIT_REGISTRAR (resource_pipeline);
 
 static kan_allocation_group_t main_allocation_group;
 static kan_allocation_group_t platform_configuration_allocation_group;
@@ -214,17 +219,26 @@ struct resource_entry_t
 
     /// \details It is only populated for built entries if build has happened already for this resource on this
     ///          execution. This is true when `status` is `RESOURCE_STATUS_AVAILABLE` or
-    ///          `RESOURCE_STATUS_PLATFORM_UNSUPPORTED` and
-    ///          `!kan_resource_log_version_is_up_to_date (initial_log_built_entry->version, available_version)`.
+    ///          `RESOURCE_STATUS_PLATFORM_UNSUPPORTED` and `passed_build_routine_mark` is set.
     KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (struct new_build_secondary_input_t)
     struct kan_dynamic_array_t new_build_secondary_inputs;
 
     /// \details It is only populated for entries if build has happened already for this resource on this execution.
-    ///          This is true when `status` is `RESOURCE_STATUS_AVAILABLE` and
-    ///          `!kan_resource_log_version_is_up_to_date (initial_log_built_entry->version, available_version)`.
+    ///          This is true when `status` is `RESOURCE_STATUS_AVAILABLE` and `passed_build_routine_mark` is set.
     KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (struct kan_resource_log_reference_t)
     struct kan_dynamic_array_t new_references;
 
+    /// \brief Estimated time in nanoseconds of the longest build chain that starts from this entry.
+    /// \details Calculated from the initial log before build and used to order build queue, so long chains are
+    ///          started as early as possible. Zero if there is no information about this entry.
+    kan_time_size_t build_priority_ns;
+
+    /// \details Only populated for primary entries if build rule was executed during this execution, which is
+    ///          indicated by `build_rule_executed` flag. Written only from build rule execution step.
+    kan_time_size_t build_rule_wall_ns;
+    kan_time_size_t build_rule_cpu_ns;
+    bool build_rule_executed;
+
     kan_allocation_group_t allocation_group;
 };
 
@@ -285,6 +299,11 @@ struct platform_configuration_entry_t
     struct kan_hash_storage_node_t node;
     const struct kan_reflection_struct_t *type;
     kan_time_size_t file_time;
+
+    /// \brief Combined content hash of all the files that were applied to this entry.
+    /// \details Only calculated when artifact cache is used, KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN otherwise.
+    kan_file_size_t content_hash;
+
     void *data;
 };
 
@@ -295,6 +314,14 @@ struct build_queue_item_t
 
     /// \brief State pointer is needed to make build queue items usable as full build task user data.
     struct build_state_t *state;
+
+    /// \brief Estimated amount of memory that will be needed to execute this task.
+    /// \details Calculated when item is created, before it is added to the queue, so build queue lock is never held
+    ///          while querying file system. Zero if memory budget is disabled.
+    kan_memory_size_t memory_estimate;
+
+    /// \brief Count of times this item was skipped during admission because it did not fit into memory budget.
+    kan_loop_size_t admission_skips;
 };
 
 struct build_info_list_item_t
@@ -328,6 +355,10 @@ struct build_state_t
 
     kan_instance_size_t currently_scheduled_build_operations;
 
+    /// \brief Sum of memory estimates of currently scheduled build operations.
+    /// \details Used to avoid scheduling too many memory-heavy operations at once when memory budget is set.
+    kan_memory_size_t currently_scheduled_memory_estimate;
+
     struct kan_bd_list_t build_queue;
     struct kan_bd_list_t paused_list;
     struct kan_bd_list_t failed_list;
@@ -335,6 +366,9 @@ struct build_state_t
     /// \details Initial log is saved if it was parsed as we would need to use data from it and is much easier to just
     ///          save pointers to it from nodes.
     struct kan_resource_log_t initial_log;
+
+    /// \brief Wall time of the build step for the timing report.
+    kan_time_size_t build_wall_ns;
 };
 
 // Section for common utility functions that are not part of single complex build operation.
@@ -354,6 +388,7 @@ static struct resource_entry_t *resource_entry_create (struct resource_type_cont
     instance->header.status = RESOURCE_STATUS_UNCONFIRMED;
     instance->header.available_version.type_version = 0u;
     instance->header.available_version.last_modification_time = 0u;
+    instance->header.available_version.content_hash = KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
     instance->header.deployment_mark = false;
     instance->header.cache_mark = false;
     instance->header.passed_build_routine_mark = false;
@@ -376,6 +411,11 @@ static struct resource_entry_t *resource_entry_create (struct resource_type_cont
                             alignof (struct new_build_secondary_input_t), group);
     kan_dynamic_array_init (&instance->new_references, 0u, sizeof (struct kan_resource_log_reference_t),
                             alignof (struct kan_resource_log_reference_t), group);
+
+    instance->build_priority_ns = 0u;
+    instance->build_rule_wall_ns = 0u;
+    instance->build_rule_cpu_ns = 0u;
+    instance->build_rule_executed = false;
     instance->allocation_group = group;
 
     kan_hash_storage_update_bucket_count_default (&owner->entries, KAN_RESOURCE_PIPELINE_BUILD_RESOURCE_BUCKETS);
@@ -470,6 +510,111 @@ static void resource_type_container_destroy (struct resource_type_container_t *i
     kan_free_batched (instance->allocation_group, instance);
 }
 
+/// \brief Calculates checksum of the file content for resource log version.
+/// \details Returns KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN if file cannot be read.
+static kan_file_size_t calculate_file_content_hash (const char *path)
+{
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_read (path, true);
+    if (!stream)
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "Unable to open \"%s\" for calculating its content hash.", path);
+        return KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
+    }
+
+    uint8_t buffer[KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER];
+    kan_checksum_state_t checksum = kan_checksum_create ();
+    kan_file_size_t read;
+
+    while ((read = stream->operations->read (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER, buffer)) > 0u)
+    {
+        kan_checksum_append (checksum, read, buffer);
+    }
+
+    stream->operations->close (stream);
+    kan_file_size_t hash = kan_checksum_finalize (checksum);
+
+    // Extremely unlikely, but we should not produce unknown hash value from real data.
+    if (hash == KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN)
+    {
+        hash = 1u;
+    }
+
+    return hash;
+}
+
+/// \brief Combines two content hashes into one in order-dependant way.
+/// \details Returns KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN if any of the hashes is unknown.
+static inline kan_file_size_t combine_content_hash (kan_file_size_t first, kan_file_size_t second)
+{
+    if (first == KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN || second == KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN)
+    {
+        return KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
+    }
+
+    kan_checksum_state_t checksum = kan_checksum_create ();
+    kan_checksum_append (checksum, sizeof (first), &first);
+    kan_checksum_append (checksum, sizeof (second), &second);
+    const kan_file_size_t hash = kan_checksum_finalize (checksum);
+    return hash == KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN ? 1u : hash;
+}
+
+/// \brief Calculates detected content hash for file that is compared to the logged version.
+/// \details When timestamps match, logged hash is reused in order to avoid reading the file. When logged version has
+///          no content hash, there is nothing to compare with and file is not read either.
+static inline kan_file_size_t detect_file_content_hash (const struct kan_resource_log_version_t *logged_version,
+                                                        kan_time_size_t last_modification_time,
+                                                        const char *path)
+{
+    if (!logged_version || logged_version->content_hash == KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN)
+    {
+        return KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
+    }
+
+    if (logged_version->last_modification_time == last_modification_time)
+    {
+        return logged_version->content_hash;
+    }
+
+    return calculate_file_content_hash (path);
+}
+
+/// \brief Checks whether raw third party file is the same as the one described by logged version.
+static inline bool raw_third_party_entry_is_up_to_date (const struct raw_third_party_entry_t *entry,
+                                                        const struct kan_resource_log_version_t *logged_version)
+{
+    const struct kan_resource_log_version_t detected_version = {
+        .type_version = logged_version->type_version,
+        .last_modification_time = entry->last_modification_time,
+        .content_hash = detect_file_content_hash (logged_version, entry->last_modification_time, entry->file_location),
+    };
+
+    return kan_resource_log_version_is_up_to_date (*logged_version, detected_version);
+}
+
+/// \brief Updates logged version of raw third party file that was confirmed to be up to date by availability check.
+/// \details If file was touched, but its content hash is still the same, saving new modification time makes it
+///          possible to confirm it by timestamp during the next build instead of calculating content hash again.
+static inline void raw_third_party_entry_refresh_log_version (const struct raw_third_party_entry_t *entry,
+                                                               struct kan_resource_log_version_t *logged_version)
+{
+    if (entry && logged_version->content_hash != KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN)
+    {
+        logged_version->last_modification_time = entry->last_modification_time;
+    }
+}
+
+/// \brief Creates resource log version for raw third party file in order to save it into the log.
+static inline struct kan_resource_log_version_t raw_third_party_entry_get_log_version (
+    const struct raw_third_party_entry_t *entry)
+{
+    return (struct kan_resource_log_version_t) {
+        .type_version = 0u,
+        .last_modification_time = entry->last_modification_time,
+        .content_hash = calculate_file_content_hash (entry->file_location),
+    };
+}
+
 static struct raw_third_party_entry_t *raw_third_party_entry_create (
     struct target_t *owner, kan_interned_string_t name, const struct kan_file_system_path_container_t *path)
 {
@@ -694,11 +839,13 @@ static void build_state_init (struct build_state_t *instance, struct kan_resourc
     // Right now just limit to core count, might add separate setting for that later.
     instance->max_simultaneous_build_operations = kan_platform_get_cpu_logical_core_count ();
     instance->currently_scheduled_build_operations = 0u;
+    instance->currently_scheduled_memory_estimate = 0u;
 
     kan_bd_list_init (&instance->build_queue);
     kan_bd_list_init (&instance->paused_list);
     kan_bd_list_init (&instance->failed_list);
     kan_resource_log_init (&instance->initial_log);
+    instance->build_wall_ns = 0u;
 }
 
 static struct platform_configuration_entry_t *build_state_find_platform_configuration (struct build_state_t *instance,
@@ -732,6 +879,7 @@ static struct platform_configuration_entry_t *build_state_new_platform_configura
     entry->node.hash = KAN_HASH_OBJECT_POINTER (type->name);
     entry->type = type;
     entry->file_time = 0u;
+    entry->content_hash = KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
     entry->data = kan_allocate_general (platform_configuration_allocation_group, type->size, type->alignment);
 
     if (type->init)
@@ -819,6 +967,15 @@ void kan_resource_build_setup_init (struct kan_resource_build_setup_t *instance)
     instance->reflected_data = NULL;
     instance->pack_mode = KAN_RESOURCE_BUILD_PACK_MODE_NONE;
     instance->log_verbosity = KAN_LOG_INFO;
+    instance->artifact_cache_directory = NULL;
+    instance->artifact_cache_size_limit = KAN_RESOURCE_PIPELINE_BUILD_ARTIFACT_CACHE_SIZE_LIMIT;
+    instance->rule_cache_size_limit = KAN_RESOURCE_PIPELINE_BUILD_RULE_CACHE_SIZE_LIMIT;
+    // Calculated in 64 bits as random access memory size in bytes might not fit into 32 bit memory size.
+    const uint64_t memory_budget = ((uint64_t) kan_platform_get_random_access_memory ()) * 1024u * 1024u *
+                                   KAN_RESOURCE_PIPELINE_BUILD_DEFAULT_MEMORY_BUDGET_PERCENT / 100u;
+    instance->memory_budget = (kan_memory_size_t) KAN_MIN (memory_budget, (uint64_t) KAN_INT_MAX (kan_memory_size_t));
+    instance->timing_report_path = NULL;
+    instance->use_scan_snapshot = true;
     kan_dynamic_array_init (&instance->targets, 0u, sizeof (kan_interned_string_t), alignof (kan_interned_string_t),
                             main_allocation_group);
 }
@@ -998,6 +1155,7 @@ struct transient_platform_configuration_entry_t
 {
     kan_reflection_patch_t data;
     kan_time_size_t file_time;
+    kan_file_size_t content_hash;
 };
 
 static void transient_platform_configuration_entry_shutdown (struct transient_platform_configuration_entry_t *instance)
@@ -1216,6 +1374,11 @@ static enum kan_resource_build_result_t load_platform_configuration_entries_recu
                 // Otherwise entry shutdown will destroy owned patch.
                 entry.data = KAN_HANDLE_SET_INVALID (kan_reflection_patch_t);
                 spot->file_time = status.last_modification_time_ns;
+
+                // Timestamps are workspace-specific, therefore artifact cache needs content hash instead.
+                spot->content_hash = state->setup->artifact_cache_directory ?
+                                         calculate_file_content_hash (path_container->path) :
+                                         KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
                 break;
             }
 
@@ -1351,6 +1514,12 @@ static enum kan_resource_build_result_t load_platform_configuration (struct buil
             {
                 built_entry = build_state_new_platform_configuration (
                     state, kan_reflection_patch_get_type (transient_entry->data));
+                built_entry->content_hash = transient_entry->content_hash;
+            }
+            else
+            {
+                built_entry->content_hash =
+                    combine_content_hash (built_entry->content_hash, transient_entry->content_hash);
             }
 
             built_entry->file_time = KAN_MAX (built_entry->file_time, transient_entry->file_time);
@@ -1524,6 +1693,8 @@ static void instantiate_log_target (struct build_state_t *state,
         struct resource_entry_t *entry = resource_entry_create (container, log_entry->name);
         entry->class = RESOURCE_PRODUCTION_CLASS_PRIMARY;
         entry->initial_log_built_entry = log_entry;
+        // Own build duration is the base for priority, dependant chains are added later.
+        entry->build_priority_ns = log_entry->build_rule_duration_ns;
 
         if (log_entry->saved_directory != KAN_RESOURCE_LOG_SAVED_DIRECTORY_UNSUPPORTED)
         {
@@ -1652,70 +1823,193 @@ static enum kan_resource_build_result_t instantiate_initial_resource_log (struct
     return KAN_RESOURCE_BUILD_RESULT_SUCCESS;
 }
 
-// Raw resource scanning step section.
+// Build priority calculation step section.
 
-static bool scan_file (struct target_t *target, struct kan_file_system_path_container_t *reused_path)
+static inline bool propagate_build_priority (struct resource_entry_t *input, const struct resource_entry_t *consumer)
 {
-    kan_interned_string_t native_type = NULL;
-    const char *native_name_end = NULL;
+    const kan_time_size_t own_duration =
+        input->class == RESOURCE_PRODUCTION_CLASS_PRIMARY && input->initial_log_built_entry ?
+            input->initial_log_built_entry->build_rule_duration_ns :
+            0u;
 
-    if (reused_path->length >= 4u && reused_path->path[reused_path->length - 4u] == '.' &&
-        reused_path->path[reused_path->length - 3u] == 'b' && reused_path->path[reused_path->length - 2u] == 'i' &&
-        reused_path->path[reused_path->length - 1u] == 'n')
+    const kan_time_size_t priority = own_duration + consumer->build_priority_ns;
+    if (priority > input->build_priority_ns)
     {
-        native_name_end = reused_path->path + reused_path->length - 4u;
-        struct kan_stream_t *stream = kan_direct_file_stream_open_for_read (reused_path->path, true);
+        input->build_priority_ns = priority;
+        return true;
+    }
 
-        if (!stream)
-        {
-            KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                                 "Unable to open read stream at \"%s\" in order to retrieve entry type while scanning "
-                                 "target \"%s\" directories.",
-                                 reused_path->path, target->name)
-            return false;
-        }
+    return false;
+}
+
+static bool propagate_build_priorities_from_entry (struct build_state_t *state, struct resource_entry_t *entry)
+{
+    if (entry->class != RESOURCE_PRODUCTION_CLASS_PRIMARY || !entry->initial_log_built_entry ||
+        entry->build_priority_ns == 0u)
+    {
+        return false;
+    }
+
+    bool changed = false;
+    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
 
-        stream = kan_random_access_stream_buffer_open_for_read (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
-        CUSHION_DEFER { stream->operations->close (stream); }
+    if (reflected_type && reflected_type->build_rule_primary_input_type)
+    {
+        struct resource_entry_t *input = target_search_visible_resource_unsafe (
+            entry->target, reflected_type->build_rule_primary_input_type, entry->name);
 
-        if (!kan_serialization_binary_read_type_header (
-                stream, &native_type, KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t)))
+        if (input)
         {
-            KAN_LOG_WITH_BUFFER (
-                KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                "Failed to deserialize type information from \"%s\" while scanning target \"%s\" directories.",
-                reused_path->path, target->name)
-            return false;
+            changed |= propagate_build_priority (input, entry);
         }
     }
-    else if (reused_path->length >= 3u && reused_path->path[reused_path->length - 3u] == '.' &&
-             reused_path->path[reused_path->length - 2u] == 'r' && reused_path->path[reused_path->length - 1u] == 'd')
+
+    const struct kan_dynamic_array_t *secondary_inputs = &entry->initial_log_built_entry->secondary_inputs;
+    for (kan_loop_size_t index = 0u; index < secondary_inputs->size; ++index)
     {
-        native_name_end = reused_path->path + reused_path->length - 3u;
-        struct kan_stream_t *stream = kan_direct_file_stream_open_for_read (reused_path->path, true);
+        const struct kan_resource_log_secondary_input_t *secondary =
+            &((struct kan_resource_log_secondary_input_t *) secondary_inputs->data)[index];
 
-        if (!stream)
+        // Third party inputs have no type and are never built.
+        if (!secondary->type)
         {
-            KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                                 "Unable to open read stream at \"%s\" in order to retrieve entry type while scanning "
-                                 "target \"%s\" directories.",
-                                 reused_path->path, target->name)
-            return false;
+            continue;
         }
 
-        stream = kan_random_access_stream_buffer_open_for_read (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
-        CUSHION_DEFER { stream->operations->close (stream); }
+        struct resource_entry_t *input =
+            target_search_visible_resource_unsafe (entry->target, secondary->type, secondary->name);
 
-        if (!kan_serialization_rd_read_type_header (stream, &native_type))
+        if (input)
         {
-            KAN_LOG_WITH_BUFFER (
-                KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                "Failed to deserialize type information from \"%s\" while scanning target \"%s\" directories.",
-                reused_path->path, target->name)
-            return false;
+            changed |= propagate_build_priority (input, entry);
         }
     }
-    else
+
+    return changed;
+}
+
+/// \brief Calculates build priorities as estimated durations of the longest build chains starting from entries.
+/// \details Build rule durations from previous build are propagated from built entries to their inputs until nothing
+///          changes. Every pass propagates durations at least one step deeper, therefore pass count is limited by
+///          the longest build chain, which is usually short. Pass count is still capped just in case log contains
+///          cyclic data.
+static enum kan_resource_build_result_t calculate_build_priorities (struct build_state_t *state)
+{
+    bool changed = true;
+    kan_loop_size_t passes = 0u;
+
+    while (changed && passes < KAN_RESOURCE_PIPELINE_BUILD_PRIORITY_MAX_PASSES)
+    {
+        changed = false;
+        ++passes;
+        struct target_t *target = state->targets_first;
+
+        while (target)
+        {
+            struct resource_type_container_t *container =
+                (struct resource_type_container_t *) target->resource_types.items.first;
+
+            while (container)
+            {
+                struct resource_entry_t *entry = (struct resource_entry_t *) container->entries.items.first;
+                while (entry)
+                {
+                    changed |= propagate_build_priorities_from_entry (state, entry);
+                    entry = (struct resource_entry_t *) entry->node.list_node.next;
+                }
+
+                container = (struct resource_type_container_t *) container->node.list_node.next;
+            }
+
+            target = target->next;
+        }
+    }
+
+    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG, "Build priorities calculated in %lu passes.",
+             (unsigned long) passes)
+    return KAN_RESOURCE_BUILD_RESULT_SUCCESS;
+}
+
+// Raw resource scanning step section.
+
+enum scan_file_format_t
+{
+    SCAN_FILE_FORMAT_BINARY = 0u,
+    SCAN_FILE_FORMAT_READABLE_DATA,
+    SCAN_FILE_FORMAT_THIRD_PARTY,
+};
+
+static enum scan_file_format_t scan_detect_file_format (const char *path, kan_instance_size_t length)
+{
+    if (length >= 4u && path[length - 4u] == '.' && path[length - 3u] == 'b' && path[length - 2u] == 'i' &&
+        path[length - 1u] == 'n')
+    {
+        return SCAN_FILE_FORMAT_BINARY;
+    }
+
+    if (length >= 3u && path[length - 3u] == '.' && path[length - 2u] == 'r' && path[length - 1u] == 'd')
+    {
+        return SCAN_FILE_FORMAT_READABLE_DATA;
+    }
+
+    return SCAN_FILE_FORMAT_THIRD_PARTY;
+}
+
+/// \details Does not access target storages, therefore can be called from any thread.
+static bool scan_read_native_type (struct target_t *target,
+                                   const struct kan_file_system_path_container_t *path,
+                                   enum scan_file_format_t format,
+                                   kan_interned_string_t *output)
+{
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_read (path->path, true);
+    if (!stream)
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "Unable to open read stream at \"%s\" in order to retrieve entry type while scanning "
+                             "target \"%s\" directories.",
+                             path->path, target->name)
+        return false;
+    }
+
+    stream = kan_random_access_stream_buffer_open_for_read (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
+    CUSHION_DEFER { stream->operations->close (stream); }
+    bool read = false;
+
+    switch (format)
+    {
+    case SCAN_FILE_FORMAT_BINARY:
+        read = kan_serialization_binary_read_type_header (
+            stream, output, KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
+        break;
+
+    case SCAN_FILE_FORMAT_READABLE_DATA:
+        read = kan_serialization_rd_read_type_header (stream, output);
+        break;
+
+    case SCAN_FILE_FORMAT_THIRD_PARTY:
+        KAN_ASSERT (false)
+        break;
+    }
+
+    if (!read)
+    {
+        KAN_LOG_WITH_BUFFER (
+            KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+            "Failed to deserialize type information from \"%s\" while scanning target \"%s\" directories.", path->path,
+            target->name)
+        return false;
+    }
+
+    return true;
+}
+
+/// \brief Registers scanned file in target. Native type is expected to be NULL for third party files.
+static bool scan_register_file (struct target_t *target,
+                                struct kan_file_system_path_container_t *reused_path,
+                                kan_interned_string_t native_type)
+{
+    if (!native_type)
     {
         const char *name_begin = reused_path->path + reused_path->length;
         while (name_begin > reused_path->path && *(name_begin - 1u) != '/' && *(name_begin - 1u) != '\\')
@@ -1753,7 +2047,11 @@ static bool scan_file (struct target_t *target, struct kan_file_system_path_cont
         return true;
     }
 
+    const char *native_name_end =
+        reused_path->path + reused_path->length -
+        (scan_detect_file_format (reused_path->path, reused_path->length) == SCAN_FILE_FORMAT_BINARY ? 4u : 3u);
     const char *native_name_begin = native_name_end;
+
     while (native_name_begin > reused_path->path && *(native_name_begin - 1u) != '/' &&
            *(native_name_begin - 1u) != '\\')
     {
@@ -1770,7 +2068,7 @@ static bool scan_file (struct target_t *target, struct kan_file_system_path_cont
     }
 
     const kan_interned_string_t native_name = kan_char_sequence_intern (native_name_begin, native_name_end);
-    // Can safely use unsafe here as target is scanned as a whole and targets do not access each other during scan.
+    // Can safely use unsafe here as target is registered as a whole and targets do not access each other during scan.
     struct resource_entry_t *entry = target_search_local_resource_unsafe (target, native_type, native_name);
 
     if (entry)
@@ -1839,689 +2137,1315 @@ static bool scan_file (struct target_t *target, struct kan_file_system_path_cont
     return true;
 }
 
-static bool scan_directory (struct target_t *target, struct kan_file_system_path_container_t *reused_path)
+/// \brief Describes scan of one directory that is executed as a part of scan wave.
+struct scan_directory_task_t
 {
-    kan_file_system_directory_iterator_t iterator = kan_file_system_directory_iterator_create (reused_path->path);
-    CUSHION_DEFER { kan_file_system_directory_iterator_destroy (iterator); }
-    bool successful = true;
-    const char *item_name;
+    struct target_t *target;
+    struct kan_resource_scan_snapshot_target_t *snapshot_target;
+    kan_interned_string_t path;
 
-    while ((item_name = kan_file_system_directory_iterator_advance (iterator)))
+    /// \brief Index of directory record in new snapshot target.
+    /// \details Records are added before the wave is dispatched, so record pointer is only resolved after that.
+    kan_instance_size_t record_index;
+
+    struct kan_resource_scan_snapshot_directory_t *record;
+
+    /// \brief The same directory from previous snapshot if it exists.
+    const struct kan_resource_scan_snapshot_directory_t *previous;
+
+    bool reused;
+    bool successful;
+};
+
+struct scan_directory_batch_t
+{
+    struct scan_directory_task_t *first;
+    kan_instance_size_t count;
+};
+
+struct scan_previous_directory_node_t
+{
+    struct kan_hash_storage_node_t node;
+    kan_interned_string_t target;
+    const struct kan_resource_scan_snapshot_directory_t *directory;
+};
+
+struct scan_register_context_t
+{
+    struct target_t *target;
+    const struct kan_resource_scan_snapshot_target_t *snapshot_target;
+};
+
+static const struct kan_resource_scan_snapshot_directory_t *scan_find_previous_directory (
+    const struct kan_hash_storage_t *storage, kan_interned_string_t target, kan_interned_string_t path)
+{
+    const struct kan_hash_storage_bucket_t *bucket = kan_hash_storage_query (storage, KAN_HASH_OBJECT_POINTER (path));
+    struct scan_previous_directory_node_t *node = (struct scan_previous_directory_node_t *) bucket->first;
+    const struct scan_previous_directory_node_t *node_end =
+        (struct scan_previous_directory_node_t *) (bucket->last ? bucket->last->next : NULL);
+
+    while (node != node_end)
     {
-        if ((item_name[0u] == '.' && item_name[1u] == '\0') ||
-            (item_name[0u] == '.' && item_name[1u] == '.' && item_name[2u] == '\0'))
+        if (node->target == target && node->directory->path == path)
         {
-            // Skip special entries.
-            continue;
+            return node->directory;
         }
 
-        const kan_instance_size_t base_length = reused_path->length;
-        CUSHION_DEFER { kan_file_system_path_container_reset_length (reused_path, base_length); }
-        kan_file_system_path_container_append (reused_path, item_name);
-        struct kan_file_system_entry_status_t status;
+        node = (struct scan_previous_directory_node_t *) node->node.list_node.next;
+    }
 
-        if (kan_file_system_query_entry (reused_path->path, &status))
-        {
-            switch (status.type)
-            {
-            case KAN_FILE_SYSTEM_ENTRY_TYPE_UNKNOWN:
-                KAN_LOG_WITH_BUFFER (
-                    KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                    "Encountered file entry \"%s\" with unknown type while scanning target \"%s\" directories.",
-                    reused_path->path, target->name)
-                successful = false;
-                break;
+    return NULL;
+}
 
-            case KAN_FILE_SYSTEM_ENTRY_TYPE_FILE:
-                successful &= scan_file (target, reused_path);
-                break;
+/// \details Files in snapshot directories are sorted by name, therefore we can use binary search.
+static const struct kan_resource_scan_snapshot_file_t *scan_find_previous_file (
+    const struct kan_resource_scan_snapshot_directory_t *directory, kan_interned_string_t name)
+{
+    const struct kan_resource_scan_snapshot_file_t *files =
+        (const struct kan_resource_scan_snapshot_file_t *) directory->files.data;
+    kan_instance_size_t left = 0u;
+    kan_instance_size_t right = directory->files.size;
 
-            case KAN_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY:
-                successful &= scan_directory (target, reused_path);
-                break;
-            }
+    while (left < right)
+    {
+        const kan_instance_size_t middle = (left + right) / 2u;
+        const int comparison = strcmp (files[middle].name, name);
+
+        if (comparison == 0)
+        {
+            return &files[middle];
+        }
+        else if (comparison < 0)
+        {
+            left = middle + 1u;
         }
         else
         {
-            KAN_LOG_WITH_BUFFER (
-                KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                "Failed to query status of file entry \"%s\" while scanning target \"%s\" directories.",
-                reused_path->path, target->name)
-            successful = false;
+            right = middle;
         }
     }
 
-    return successful;
+    return NULL;
 }
 
-static void execute_raw_resource_scan_for_target (kan_functor_user_data_t user_data)
+/// \brief Copies directory content from previous snapshot when directory entries were not added, removed or renamed.
+/// \details Directory modification time is not changed when files are edited in place, therefore every file is still
+///          queried and its type header is read again when its size or modification time differ from the previous
+///          snapshot. Returns false if directory content cannot be reused and full scan is needed instead.
+static bool scan_directory_copy_from_previous (struct scan_directory_task_t *task,
+                                               struct kan_file_system_path_container_t *path)
 {
-    struct target_t *target = (struct target_t *) user_data;
-    target->raw_resource_scan_step_successful = true;
-    struct kan_file_system_path_container_t reused_path;
+    struct kan_resource_scan_snapshot_directory_t *record = task->record;
+    const struct kan_resource_scan_snapshot_directory_t *previous = task->previous;
 
-    for (kan_loop_size_t directory_index = 0u; directory_index < target->source->directories.size; ++directory_index)
+    if (previous->files.size > 0u)
     {
-        const char *directory_path = ((char **) target->source->directories.data)[directory_index];
-        kan_file_system_path_container_copy_string (&reused_path, directory_path);
-        target->raw_resource_scan_step_successful &= scan_directory (target, &reused_path);
+        kan_dynamic_array_set_capacity (&record->files, previous->files.size);
+        record->files.size = previous->files.size;
+        memcpy (record->files.data, previous->files.data,
+                sizeof (struct kan_resource_scan_snapshot_file_t) * previous->files.size);
     }
-}
-
-static enum kan_resource_build_result_t scan_for_raw_resources (struct build_state_t *state)
-{
-    struct target_t *target = state->targets_first;
-    kan_cpu_job_t job = kan_cpu_job_create ();
 
-    while (target)
+    for (kan_loop_size_t index = 0u; index < record->files.size; ++index)
     {
-        CUSHION_DEFER { target = target->next; }
-        // For the reasons described in mark_root_for_deployment, non-selected target reference structure is also
-        // checked, but not built unless necessary, therefore we need to scan all the targets: otherwise non-selected
-        // targets will lose references to deployed third party resources and trigger errors.
+        struct kan_resource_scan_snapshot_file_t *file =
+            &((struct kan_resource_scan_snapshot_file_t *) record->files.data)[index];
 
-        // There is not that many targets, so we can just post tasks one by one instead of using task list.
-        kan_cpu_job_dispatch_task (job, (struct kan_cpu_task_t) {
-                                            .function = execute_raw_resource_scan_for_target,
-                                            .user_data = (kan_functor_user_data_t) target,
-                                            .profiler_section = kan_cpu_section_get (target->name),
-                                        });
-    }
+        const kan_instance_size_t base_length = path->length;
+        CUSHION_DEFER { kan_file_system_path_container_reset_length (path, base_length); }
+        kan_file_system_path_container_append (path, file->name);
+        struct kan_file_system_entry_status_t status;
 
-    kan_cpu_job_release (job);
-    kan_cpu_job_wait (job);
+        if (!kan_file_system_query_entry (path->path, &status) || status.type != KAN_FILE_SYSTEM_ENTRY_TYPE_FILE)
+        {
+            // File was removed or is no longer a regular file: directory content has changed, so it must be rescanned.
+            record->files.size = 0u;
+            return false;
+        }
 
-    bool successful = true;
-    target = state->targets_first;
+        if (file->size == status.size && file->last_modification_time == status.last_modification_time_ns)
+        {
+            continue;
+        }
 
-    while (target)
+        file->size = status.size;
+        file->last_modification_time = status.last_modification_time_ns;
+        const enum scan_file_format_t format = scan_detect_file_format (path->path, path->length);
+
+        if (format != SCAN_FILE_FORMAT_THIRD_PARTY)
+        {
+            file->native_type = NULL;
+            if (!scan_read_native_type (task->target, path, format, &file->native_type))
+            {
+                task->successful = false;
+            }
+        }
+    }
+
+    if (previous->directories.size > 0u)
     {
-        successful &= target->raw_resource_scan_step_successful;
-        target = target->next;
+        kan_dynamic_array_set_capacity (&record->directories, previous->directories.size);
+        record->directories.size = previous->directories.size;
+        memcpy (record->directories.data, previous->directories.data,
+                sizeof (kan_interned_string_t) * previous->directories.size);
     }
 
-    return successful ? KAN_RESOURCE_BUILD_RESULT_SUCCESS : KAN_RESOURCE_BUILD_RESULT_ERROR_RAW_RESOURCE_SCAN_FAILED;
+    return true;
 }
 
-// Resource request feature section which is a significant part of resource build routine.
-
-enum resource_request_mode_t
+static void scan_directory (struct scan_directory_task_t *task)
 {
-    /// \brief Dependency for build operation execution that must always be available.
-    /// \details Causes resource to be loaded. Pauses build operation execution until available.
-    RESOURCE_REQUEST_MODE_BUILD_REQUIRED = 0u,
+    struct kan_resource_scan_snapshot_directory_t *record = task->record;
+    const struct kan_resource_scan_snapshot_directory_t *previous = task->previous;
+    struct kan_file_system_entry_status_t status;
 
-    /// \brief Dependency for build operation execution that is allowed to be unavailable on some platforms.
-    /// \details Causes resource to be loaded. Pauses build operation execution until available if can be
-    ///          available at all.
-    RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL,
+    if (!kan_file_system_query_entry (record->path, &status) || status.type != KAN_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY)
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "Unable to query status of directory \"%s\" while scanning target \"%s\" directories.",
+                             record->path, task->target->name)
+        task->successful = false;
+        return;
+    }
 
-    /// \brief Used for resource status recursive hierarchical confirmation and for internal utility requests..
-    RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION,
+    struct kan_file_system_path_container_t path;
+    kan_file_system_path_container_copy_string (&path, record->path);
+    record->last_modification_time = status.last_modification_time_ns;
 
-    /// \brief Marks this resource as requested for deployment. Triggers resource build if necessary.
-    RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT,
+    if (previous && previous->last_modification_time == record->last_modification_time &&
+        scan_directory_copy_from_previous (task, &path))
+    {
+        // Entries were neither added, removed nor renamed in this directory since previous scan.
+        task->reused = true;
+        return;
+    }
 
-    /// \brief Marks this resource as requested for deployment. Triggers resource build if necessary.
-    /// \details Unlike `RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT`, does not result in an error if resource has
-    ///          platform unsupported status.
-    RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT_PLATFORM_OPTIONAL,
+    kan_file_system_directory_iterator_t iterator = kan_file_system_directory_iterator_create (path.path);
+    if (!KAN_HANDLE_IS_VALID (iterator))
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "Unable to iterate directory \"%s\" while scanning target \"%s\" directories.",
+                             record->path, task->target->name)
+        task->successful = false;
+        return;
+    }
 
-    /// \brief Marks this resource as needed for the build cache.
-    /// \details Produces an error if this resource does not exist or is not available yet. Should only be used to mark
-    ///          resources to be cached after the build operation is done.
-    RESOURCE_REQUEST_MODE_MARK_CACHE,
-};
+    CUSHION_DEFER { kan_file_system_directory_iterator_destroy (iterator); }
+    const char *item_name;
 
-struct resource_request_t
-{
-    struct target_t *from_target;
-    kan_interned_string_t type;
-    kan_interned_string_t name;
-    enum resource_request_mode_t mode;
+    while ((item_name = kan_file_system_directory_iterator_advance (iterator)))
+    {
+        if ((item_name[0u] == '.' && item_name[1u] == '\0') ||
+            (item_name[0u] == '.' && item_name[1u] == '.' && item_name[2u] == '\0'))
+        {
+            // Skip special entries.
+            continue;
+        }
 
-    /// \brief Entry that needs this resource for build operation if `RESOURCE_REQUEST_MODE_BUILD_REQUIRED` or
-    ///        `RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL` is used.
-    struct resource_entry_t *needed_to_build_entry;
-};
+        const kan_instance_size_t base_length = path.length;
+        CUSHION_DEFER { kan_file_system_path_container_reset_length (&path, base_length); }
+        kan_file_system_path_container_append (&path, item_name);
 
-struct resource_response_t
-{
-    bool success;
-    struct resource_entry_t *entry;
-};
+        if (!kan_file_system_query_entry (path.path, &status))
+        {
+            KAN_LOG_WITH_BUFFER (
+                KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                "Failed to query status of file entry \"%s\" while scanning target \"%s\" directories.", path.path,
+                task->target->name)
+            task->successful = false;
+            continue;
+        }
 
-struct resource_request_backtrace_t
-{
-    const struct resource_request_backtrace_t *previous;
-    kan_interned_string_t type;
-    kan_interned_string_t name;
-};
+        switch (status.type)
+        {
+        case KAN_FILE_SYSTEM_ENTRY_TYPE_UNKNOWN:
+            KAN_LOG_WITH_BUFFER (
+                KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                "Encountered file entry \"%s\" with unknown type while scanning target \"%s\" directories.",
+                path.path, task->target->name)
+            task->successful = false;
+            break;
 
-static struct resource_response_t execute_resource_request_internal (
-    struct build_state_t *state,
-    struct resource_request_t request,
-    const struct resource_request_backtrace_t *backtrace);
+        case KAN_FILE_SYSTEM_ENTRY_TYPE_FILE:
+        {
+            const kan_interned_string_t name = kan_string_intern (item_name);
+            const enum scan_file_format_t format = scan_detect_file_format (path.path, path.length);
+            kan_interned_string_t native_type = NULL;
 
-static inline struct resource_response_t execute_resource_request (struct build_state_t *state,
-                                                                   struct resource_request_t request)
+            if (format != SCAN_FILE_FORMAT_THIRD_PARTY)
+            {
+                const struct kan_resource_scan_snapshot_file_t *previous_file =
+                    previous ? scan_find_previous_file (previous, name) : NULL;
+
+                if (previous_file && previous_file->native_type && previous_file->size == status.size &&
+                    previous_file->last_modification_time == status.last_modification_time_ns)
+                {
+                    // File is not changed, therefore its type header is the same too.
+                    native_type = previous_file->native_type;
+                }
+                else if (!scan_read_native_type (task->target, &path, format, &native_type))
+                {
+                    task->successful = false;
+                    break;
+                }
+            }
+
+            struct kan_resource_scan_snapshot_file_t *file = kan_dynamic_array_add_last (&record->files);
+            if (!file)
+            {
+                kan_dynamic_array_set_capacity (&record->files,
+                                                KAN_MAX (KAN_RESOURCE_PIPELINE_BUILD_SCAN_FILES_CAPACITY,
+                                                         record->files.size * 2u));
+                file = kan_dynamic_array_add_last (&record->files);
+            }
+
+            *file = (struct kan_resource_scan_snapshot_file_t) {
+                .name = name,
+                .native_type = native_type,
+                .size = status.size,
+                .last_modification_time = status.last_modification_time_ns,
+            };
+
+            break;
+        }
+
+        case KAN_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY:
+        {
+            kan_interned_string_t *spot = kan_dynamic_array_add_last (&record->directories);
+            if (!spot)
+            {
+                kan_dynamic_array_set_capacity (&record->directories, KAN_MAX (1u, record->directories.size * 2u));
+                spot = kan_dynamic_array_add_last (&record->directories);
+            }
+
+            *spot = kan_string_intern (item_name);
+            break;
+        }
+        }
+    }
+
+    if (record->files.size > 1u)
+    {
+        struct kan_resource_scan_snapshot_file_t temporary;
+
+#define AT_INDEX(INDEX) (((struct kan_resource_scan_snapshot_file_t *) record->files.data)[INDEX])
+#define LESS(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__ (strcmp (AT_INDEX (first_index).name, AT_INDEX (second_index).name) < 0)
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = AT_INDEX (first_index), AT_INDEX (first_index) = AT_INDEX (second_index),                              \
+    AT_INDEX (second_index) = temporary
+
+        QSORT (record->files.size, LESS, SWAP);
+#undef LESS
+#undef SWAP
+#undef AT_INDEX
+    }
+}
+
+static void execute_scan_directory_batch (kan_functor_user_data_t user_data)
 {
-    return execute_resource_request_internal (state, request, NULL);
+    struct scan_directory_batch_t *batch = (struct scan_directory_batch_t *) user_data;
+    for (kan_loop_size_t index = 0u; index < batch->count; ++index)
+    {
+        scan_directory (&batch->first[index]);
+    }
 }
 
-static void add_to_build_queue_new_unsafe (struct build_state_t *state, struct resource_entry_t *entry);
+static void scan_wave_add (struct kan_dynamic_array_t *wave,
+                           const struct kan_hash_storage_t *previous_directories,
+                           struct target_t *target,
+                           struct kan_resource_scan_snapshot_target_t *snapshot_target,
+                           kan_interned_string_t path)
+{
+    struct scan_directory_task_t *task = kan_dynamic_array_add_last (wave);
+    if (!task)
+    {
+        kan_dynamic_array_set_capacity (wave, wave->size * 2u);
+        task = kan_dynamic_array_add_last (wave);
+    }
+
+    *task = (struct scan_directory_task_t) {
+        .target = target,
+        .snapshot_target = snapshot_target,
+        .path = path,
+        .record_index = 0u,
+        .record = NULL,
+        .previous = scan_find_previous_directory (previous_directories, target->name, path),
+        .reused = false,
+        .successful = true,
+    };
+}
 
-static inline void confirm_resource_status (struct build_state_t *state,
-                                            struct resource_entry_t *entry,
-                                            const struct resource_request_backtrace_t *backtrace)
+static void execute_raw_resource_register_for_target (kan_functor_user_data_t user_data)
 {
+    struct scan_register_context_t *context = (struct scan_register_context_t *) user_data;
+    context->target->raw_resource_scan_step_successful = true;
+    struct kan_file_system_path_container_t reused_path;
+
+    for (kan_loop_size_t directory_index = 0u; directory_index < context->snapshot_target->directories.size;
+         ++directory_index)
     {
-        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&entry->header.lock)
-        if (entry->header.status != RESOURCE_STATUS_UNCONFIRMED)
+        const struct kan_resource_scan_snapshot_directory_t *directory =
+            &((struct kan_resource_scan_snapshot_directory_t *)
+                  context->snapshot_target->directories.data)[directory_index];
+
+        kan_file_system_path_container_copy_string (&reused_path, directory->path);
+        const kan_instance_size_t base_length = reused_path.length;
+
+        for (kan_loop_size_t file_index = 0u; file_index < directory->files.size; ++file_index)
         {
-            return;
+            const struct kan_resource_scan_snapshot_file_t *file =
+                &((struct kan_resource_scan_snapshot_file_t *) directory->files.data)[file_index];
+
+            kan_file_system_path_container_reset_length (&reused_path, base_length);
+            kan_file_system_path_container_append (&reused_path, file->name);
+            context->target->raw_resource_scan_step_successful &=
+                scan_register_file (context->target, &reused_path, file->native_type);
         }
     }
+}
 
-    // We do resource status confirmation without locking as calculated status should always be the same and chance of
-    // calculating status twice should be quite rare.
+static bool load_scan_snapshot (struct build_state_t *state, struct kan_resource_scan_snapshot_t *snapshot)
+{
+    struct kan_file_system_path_container_t snapshot_path;
+    kan_file_system_path_container_copy_string (&snapshot_path, state->setup->project->workspace_directory);
+    kan_file_system_path_container_append (&snapshot_path, KAN_RESOURCE_SCAN_SNAPSHOT_DEFAULT_NAME);
 
-    struct target_t *target = entry->target;
-    enum resource_status_t new_status = RESOURCE_STATUS_AVAILABLE;
-    struct kan_resource_log_version_t available_version = {.type_version = 0u, .last_modification_time = 0u};
+    if (!kan_file_system_check_existence (snapshot_path.path))
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Scan snapshot not found, all directories will be scanned.");
+        return false;
+    }
 
-    switch (entry->class)
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_read (snapshot_path.path, true);
+    if (!stream)
     {
-    case RESOURCE_PRODUCTION_CLASS_RAW:
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_WARNING,
+                             "Unable to open scan snapshot at \"%s\", all directories will be scanned.",
+                             snapshot_path.path);
+        return false;
+    }
+
+    stream = kan_random_access_stream_buffer_open_for_read (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
+    CUSHION_DEFER { stream->operations->close (stream); }
+
+    kan_resource_version_t saved_version = 0u;
+    if (stream->operations->read (stream, sizeof (saved_version), &saved_version) != sizeof (saved_version) ||
+        saved_version != resource_build_version)
     {
-        if (!entry->current_file_location)
-        {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                     "[Target \"%s\"] Marking raw resource \"%s\" of type \"%s\" as unavailable as it wasn't detected "
-                     "during raw resource scan phase.",
-                     target->name, entry->name, entry->type->name)
+        KAN_LOG (resource_pipeline_build, KAN_LOG_INFO,
+                 "Scan snapshot is saved for another resource build version, all directories will be scanned.");
+        return false;
+    }
 
-            new_status = RESOURCE_STATUS_UNAVAILABLE;
-            break;
-        }
+    kan_serialization_binary_reader_t reader = kan_serialization_binary_reader_create (
+        stream, snapshot, KAN_STATIC_INTERNED_ID_GET (kan_resource_scan_snapshot_t), state->binary_script_storage,
+        KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t),
+        kan_resource_scan_snapshot_get_allocation_group ());
 
-        struct kan_file_system_entry_status_t file_status;
-        if (!kan_file_system_query_entry (entry->current_file_location, &file_status))
-        {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                     "[Target \"%s\"] Marking raw resource \"%s\" of type \"%s\" as unavailable as it wasn't "
-                     "possible to query its file status.",
-                     target->name, entry->name, entry->type->name)
+    CUSHION_DEFER { kan_serialization_binary_reader_destroy (reader); }
+    enum kan_serialization_state_t serialization_state;
 
-            new_status = RESOURCE_STATUS_UNAVAILABLE;
-            break;
-        }
+    while ((serialization_state = kan_serialization_binary_reader_step (reader)) == KAN_SERIALIZATION_IN_PROGRESS)
+    {
+    }
 
-        const struct kan_resource_reflected_data_resource_type_t *reflected_type =
-            kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+    if (serialization_state == KAN_SERIALIZATION_FAILED)
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_WARNING,
+                             "Failed to deserialize scan snapshot from \"%s\", all directories will be scanned.",
+                             snapshot_path.path);
+        return false;
+    }
 
-        available_version.type_version = reflected_type->resource_type_meta->version;
-        available_version.last_modification_time = file_status.last_modification_time_ns;
+    return true;
+}
 
-        if (!entry->initial_log_raw_entry ||
-            !kan_resource_log_version_is_up_to_date (entry->initial_log_raw_entry->version, available_version))
-        {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                     "[Target \"%s\"] Marking raw resource \"%s\" of type \"%s\" as out of date in current build.",
-                     target->name, entry->name, entry->type->name)
-            new_status = RESOURCE_STATUS_BUILDING;
-            break;
-        }
+static void save_scan_snapshot (struct build_state_t *state, struct kan_resource_scan_snapshot_t *snapshot)
+{
+    struct kan_file_system_path_container_t snapshot_path;
+    kan_file_system_path_container_copy_string (&snapshot_path, state->setup->project->workspace_directory);
+    kan_file_system_path_container_append (&snapshot_path, KAN_RESOURCE_SCAN_SNAPSHOT_DEFAULT_NAME);
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_write (snapshot_path.path, true);
 
-        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                 "[Target \"%s\"] Marking raw resource \"%s\" of type \"%s\" as up to date in current build.",
-                 target->name, entry->name, entry->type->name)
-        break;
+    if (!stream)
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_WARNING,
+                             "Failed to save scan snapshot at \"%s\": unable to open write stream.",
+                             snapshot_path.path);
+        return;
     }
 
-    case RESOURCE_PRODUCTION_CLASS_PRIMARY:
+    stream = kan_random_access_stream_buffer_open_for_write (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
+    bool successful = stream->operations->write (stream, sizeof (resource_build_version), &resource_build_version) ==
+                      sizeof (resource_build_version);
+
+    if (successful)
     {
-        const struct kan_resource_reflected_data_resource_type_t *reflected_type =
-            kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+        kan_serialization_binary_writer_t writer = kan_serialization_binary_writer_create (
+            stream, snapshot, KAN_STATIC_INTERNED_ID_GET (kan_resource_scan_snapshot_t), state->binary_script_storage,
+            KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
 
-        if (!reflected_type->produced_from_build_rule)
+        enum kan_serialization_state_t serialization_state;
+        while ((serialization_state = kan_serialization_binary_writer_step (writer)) ==
+               KAN_SERIALIZATION_IN_PROGRESS)
         {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                     "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as unavailable because build rule "
-                     "is no longer exists.",
-                     target->name, entry->name, entry->type->name)
-            new_status = RESOURCE_STATUS_UNAVAILABLE;
-            break;
         }
 
-        const struct kan_resource_log_built_entry_t *initial = entry->initial_log_built_entry;
-        // Use initial version value if availability checks succeed.
-        available_version = initial->version;
+        kan_serialization_binary_writer_destroy (writer);
+        successful = serialization_state == KAN_SERIALIZATION_FINISHED;
+    }
 
-        KAN_ASSERT_FORMATTED (
-            initial,
-            "[Target %s] Built resource \"%s\" of type \"%s\" is in unconfirmed status and no initial log, which "
-            "should be impossible as newly created built entries must start in building status right away.",
-            target->name, entry->type->name, entry->type->name)
+    stream->operations->close (stream);
+    if (!successful)
+    {
+        // Partially written snapshot must never be used, therefore we remove it.
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_WARNING,
+                             "Failed to save scan snapshot at \"%s\": serialization error encountered.",
+                             snapshot_path.path);
+        kan_file_system_remove_file (snapshot_path.path);
+    }
+}
 
-        if (initial->rule_version != reflected_type->build_rule_version)
+static enum kan_resource_build_result_t scan_for_raw_resources (struct build_state_t *state)
+{
+    // For the reasons described in mark_root_for_deployment, non-selected target reference structure is also
+    // checked, but not built unless necessary, therefore we need to scan all the targets: otherwise non-selected
+    // targets will lose references to deployed third party resources and trigger errors.
+
+    struct kan_resource_scan_snapshot_t previous_snapshot;
+    kan_resource_scan_snapshot_init (&previous_snapshot);
+    CUSHION_DEFER { kan_resource_scan_snapshot_shutdown (&previous_snapshot); }
+
+    struct kan_hash_storage_t previous_directories;
+    kan_hash_storage_init (&previous_directories, temporary_allocation_group,
+                           KAN_RESOURCE_PIPELINE_BUILD_SCAN_SNAPSHOT_BUCKETS);
+
+    CUSHION_DEFER
+    {
+        struct scan_previous_directory_node_t *node =
+            (struct scan_previous_directory_node_t *) previous_directories.items.first;
+
+        while (node)
         {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                     "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because of build "
-                     "rule version mismatch.",
-                     target->name, entry->name, entry->type->name)
-            new_status = RESOURCE_STATUS_BUILDING;
-            break;
+            struct scan_previous_directory_node_t *next =
+                (struct scan_previous_directory_node_t *) node->node.list_node.next;
+            kan_free_batched (temporary_allocation_group, node);
+            node = next;
         }
 
-        if (initial->version.type_version != reflected_type->resource_type_meta->version)
-        {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                     "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because of resource "
-                     "type version mismatch.",
-                     target->name, entry->name, entry->type->name)
-            new_status = RESOURCE_STATUS_BUILDING;
-            break;
-        }
+        kan_hash_storage_shutdown (&previous_directories);
+    }
 
-        if (reflected_type->build_rule_platform_configuration_type)
+    if (state->setup->use_scan_snapshot && load_scan_snapshot (state, &previous_snapshot))
+    {
+        for (kan_loop_size_t target_index = 0u; target_index < previous_snapshot.targets.size; ++target_index)
         {
-            const struct platform_configuration_entry_t *platform_configuration =
-                build_state_find_platform_configuration (state, reflected_type->build_rule_platform_configuration_type);
+            const struct kan_resource_scan_snapshot_target_t *snapshot_target =
+                &((struct kan_resource_scan_snapshot_target_t *) previous_snapshot.targets.data)[target_index];
 
-            if (!platform_configuration)
+            for (kan_loop_size_t index = 0u; index < snapshot_target->directories.size; ++index)
             {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as unavailable because platform "
-                         "configuration entry is absent",
-                         target->name, entry->name, entry->type->name)
-                new_status = RESOURCE_STATUS_UNAVAILABLE;
-                break;
-            }
+                const struct kan_resource_scan_snapshot_directory_t *directory =
+                    &((struct kan_resource_scan_snapshot_directory_t *) snapshot_target->directories.data)[index];
 
-            if (platform_configuration->file_time != initial->platform_configuration_time)
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because of "
-                         "platform configuration time mismatch.",
-                         target->name, entry->name, entry->type->name)
-                new_status = RESOURCE_STATUS_BUILDING;
-                break;
+                struct scan_previous_directory_node_t *node = kan_allocate_batched (
+                    temporary_allocation_group, sizeof (struct scan_previous_directory_node_t));
+
+                node->node.hash = KAN_HASH_OBJECT_POINTER (directory->path);
+                node->target = snapshot_target->name;
+                node->directory = directory;
+
+                kan_hash_storage_update_bucket_count_default (&previous_directories,
+                                                              KAN_RESOURCE_PIPELINE_BUILD_SCAN_SNAPSHOT_BUCKETS);
+                kan_hash_storage_add (&previous_directories, &node->node);
             }
         }
+    }
 
-        if (reflected_type->build_rule_primary_input_type)
-        {
-            struct resource_response_t primary_input_response =
-                execute_resource_request_internal (state,
-                                                   (struct resource_request_t) {
-                                                       .from_target = target,
-                                                       .type = reflected_type->build_rule_primary_input_type,
-                                                       .name = entry->name,
-                                                       .mode = RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION,
-                                                       .needed_to_build_entry = NULL,
-                                                   },
-                                                   backtrace);
+    kan_instance_size_t targets_count = 0u;
+    struct target_t *target = state->targets_first;
 
-            if (primary_input_response.success)
-            {
-                KAN_ATOMIC_INT_SCOPED_LOCK_READ (&primary_input_response.entry->header.lock)
-                switch (primary_input_response.entry->header.status)
-                {
-                case RESOURCE_STATUS_UNCONFIRMED:
-                    KAN_ASSERT_FORMATTED (
-                        false, "Internal error, entry still has unconfirmed even after status confirmation request.", )
-                    break;
+    while (target)
+    {
+        ++targets_count;
+        target = target->next;
+    }
 
-                case RESOURCE_STATUS_UNAVAILABLE:
-                    KAN_LOG (
-                        resource_pipeline_build, KAN_LOG_DEBUG,
-                        "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as unavailable because primary "
-                        "input is unavailable too.",
-                        target->name, entry->name, entry->type->name)
-                    new_status = RESOURCE_STATUS_UNAVAILABLE;
-                    break;
+    struct kan_resource_scan_snapshot_t new_snapshot;
+    kan_resource_scan_snapshot_init (&new_snapshot);
+    CUSHION_DEFER { kan_resource_scan_snapshot_shutdown (&new_snapshot); }
 
-                case RESOURCE_STATUS_BUILDING:
-                    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                             "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
-                             "primary input already has building status.",
-                             target->name, entry->name, entry->type->name)
-                    new_status = RESOURCE_STATUS_BUILDING;
-                    break;
+    struct kan_dynamic_array_t register_contexts;
+    kan_dynamic_array_init (&register_contexts, targets_count, sizeof (struct scan_register_context_t),
+                            alignof (struct scan_register_context_t), temporary_allocation_group);
+    CUSHION_DEFER { kan_dynamic_array_shutdown (&register_contexts); }
 
-                case RESOURCE_STATUS_AVAILABLE:
-                    if (!kan_resource_log_version_is_up_to_date (
-                            initial->primary_input_version, primary_input_response.entry->header.available_version))
-                    {
-                        KAN_LOG (
-                            resource_pipeline_build, KAN_LOG_DEBUG,
-                            "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because of "
-                            "version mismatch with its primary input.",
-                            target->name, entry->name, entry->type->name)
-                        new_status = RESOURCE_STATUS_BUILDING;
-                        break;
-                    }
+    struct kan_dynamic_array_t wave;
+    kan_dynamic_array_init (&wave, KAN_RESOURCE_PIPELINE_BUILD_SCAN_WAVE_CAPACITY,
+                            sizeof (struct scan_directory_task_t), alignof (struct scan_directory_task_t),
+                            temporary_allocation_group);
+    CUSHION_DEFER { kan_dynamic_array_shutdown (&wave); }
 
-                    break;
+    struct kan_dynamic_array_t next_wave;
+    kan_dynamic_array_init (&next_wave, KAN_RESOURCE_PIPELINE_BUILD_SCAN_WAVE_CAPACITY,
+                            sizeof (struct scan_directory_task_t), alignof (struct scan_directory_task_t),
+                            temporary_allocation_group);
+    CUSHION_DEFER { kan_dynamic_array_shutdown (&next_wave); }
 
-                case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
-                    KAN_LOG (
-                        resource_pipeline_build, KAN_LOG_DEBUG,
-                        "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as platform unsupported because "
-                        "primary input is platform unsupported too.",
-                        target->name, entry->name, entry->type->name)
-                    new_status = RESOURCE_STATUS_PLATFORM_UNSUPPORTED;
-                    break;
+    struct kan_dynamic_array_t batches;
+    kan_dynamic_array_init (&batches, 0u, sizeof (struct scan_directory_batch_t),
+                            alignof (struct scan_directory_batch_t), temporary_allocation_group);
+    CUSHION_DEFER { kan_dynamic_array_shutdown (&batches); }
 
-                case RESOURCE_STATUS_OUT_OF_SCOPE:
-                    KAN_ASSERT_FORMATTED (false,
-                                          "Internal error, primary input entry has out of scope status, which "
-                                          "shouldn't be possible due to target visibility rules.", )
-                    break;
-                }
+    // Snapshot targets array is never resized after this point, so pointers to its items are stable.
+    kan_dynamic_array_set_capacity (&new_snapshot.targets, targets_count);
+    target = state->targets_first;
 
-                if (new_status != RESOURCE_STATUS_AVAILABLE)
-                {
-                    // Changed the status inside switch, break from the check.
-                    break;
-                }
-            }
-            else
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as unavailable because primary "
-                         "input can no longer be found.",
-                         target->name, entry->name, entry->type->name)
-                new_status = RESOURCE_STATUS_UNAVAILABLE;
-                break;
-            }
+    while (target)
+    {
+        CUSHION_DEFER { target = target->next; }
+        struct kan_resource_scan_snapshot_target_t *snapshot_target =
+            kan_dynamic_array_add_last (&new_snapshot.targets);
+        kan_resource_scan_snapshot_target_init (snapshot_target);
+        snapshot_target->name = target->name;
+
+        struct scan_register_context_t *context = kan_dynamic_array_add_last (&register_contexts);
+        context->target = target;
+        context->snapshot_target = snapshot_target;
+
+        for (kan_loop_size_t index = 0u; index < target->source->directories.size; ++index)
+        {
+            scan_wave_add (&wave, &previous_directories, target, snapshot_target,
+                           kan_string_intern (((char **) target->source->directories.data)[index]));
         }
-        else
+    }
+
+    bool successful = true;
+    kan_instance_size_t directories_scanned = 0u;
+    kan_instance_size_t directories_reused = 0u;
+
+    // Directories are scanned in waves by their depth: every wave is dispatched from this thread and is waited here,
+    // so tasks never need to wait for each other.
+    while (wave.size > 0u && successful)
+    {
+        for (kan_loop_size_t index = 0u; index < wave.size; ++index)
         {
-            // Import build rule, custom handling.
-            struct raw_third_party_entry_t *third_party = target_search_visible_third_party (target, entry->name);
+            struct scan_directory_task_t *task = &((struct scan_directory_task_t *) wave.data)[index];
+            struct kan_resource_scan_snapshot_directory_t *record =
+                kan_dynamic_array_add_last (&task->snapshot_target->directories);
 
-            if (!third_party)
+            if (!record)
             {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
-                         "primary input which is raw third party file cannot be found.",
-                         target->name, entry->name, entry->type->name)
-                new_status = RESOURCE_STATUS_BUILDING;
-                break;
+                kan_dynamic_array_set_capacity (
+                    &task->snapshot_target->directories,
+                    KAN_MAX (KAN_RESOURCE_PIPELINE_BUILD_SCAN_WAVE_CAPACITY,
+                             task->snapshot_target->directories.size * 2u));
+                record = kan_dynamic_array_add_last (&task->snapshot_target->directories);
             }
 
-            if (third_party->last_modification_time != initial->primary_input_version.last_modification_time)
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
-                         "primary input which is raw third party file has been changed.",
-                         target->name, entry->name, entry->type->name)
-                new_status = RESOURCE_STATUS_BUILDING;
-                break;
-            }
+            kan_resource_scan_snapshot_directory_init (record);
+            record->path = task->path;
+            task->record_index = task->snapshot_target->directories.size - 1u;
         }
 
-        for (kan_loop_size_t index = 0u; index < initial->secondary_inputs.size; ++index)
+        batches.size = 0u;
+        kan_dynamic_array_set_capacity (
+            &batches, (wave.size + KAN_RESOURCE_PIPELINE_BUILD_SCAN_DIRECTORIES_PER_TASK - 1u) /
+                          KAN_RESOURCE_PIPELINE_BUILD_SCAN_DIRECTORIES_PER_TASK);
+
+        for (kan_loop_size_t index = 0u; index < wave.size; ++index)
         {
-            const struct kan_resource_log_secondary_input_t *secondary =
-                &((struct kan_resource_log_secondary_input_t *) initial->secondary_inputs.data)[index];
+            struct scan_directory_task_t *task = &((struct scan_directory_task_t *) wave.data)[index];
+            task->record = &((struct kan_resource_scan_snapshot_directory_t *)
+                                 task->snapshot_target->directories.data)[task->record_index];
 
-            if (!secondary->type)
+            if (index % KAN_RESOURCE_PIPELINE_BUILD_SCAN_DIRECTORIES_PER_TASK == 0u)
             {
-                // Third party dependency, custom handling.
-                struct raw_third_party_entry_t *third_party =
-                    target_search_visible_third_party (target, secondary->name);
-
-                if (!third_party)
-                {
-                    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                             "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
-                             "secondary input \"%s\" which is raw third party file cannot be found.",
-                             target->name, entry->name, entry->type->name, secondary->name, secondary->type)
-                    new_status = RESOURCE_STATUS_BUILDING;
-                    break;
-                }
+                struct scan_directory_batch_t *batch = kan_dynamic_array_add_last (&batches);
+                batch->first = task;
+                batch->count = KAN_MIN (KAN_RESOURCE_PIPELINE_BUILD_SCAN_DIRECTORIES_PER_TASK, wave.size - index);
+            }
+        }
 
-                if (third_party->last_modification_time != secondary->version.last_modification_time)
-                {
-                    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                             "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
-                             "secondary input \"%s\" which is raw third party file has been changed.",
-                             target->name, entry->name, entry->type->name, secondary->name, secondary->type)
-                    new_status = RESOURCE_STATUS_BUILDING;
-                    break;
-                }
+        kan_cpu_job_t job = kan_cpu_job_create ();
+        for (kan_loop_size_t index = 0u; index < batches.size; ++index)
+        {
+            struct scan_directory_batch_t *batch = &((struct scan_directory_batch_t *) batches.data)[index];
+            kan_cpu_job_dispatch_task (job, (struct kan_cpu_task_t) {
+                                                .function = execute_scan_directory_batch,
+                                                .user_data = (kan_functor_user_data_t) batch,
+                                                .profiler_section = kan_cpu_section_get (batch->first->target->name),
+                                            });
+        }
 
-                continue;
-            }
+        kan_cpu_job_release (job);
+        kan_cpu_job_wait (job);
+        next_wave.size = 0u;
 
-            struct resource_response_t secondary_response =
-                execute_resource_request_internal (state,
-                                                   (struct resource_request_t) {
-                                                       .from_target = target,
-                                                       .type = secondary->type,
-                                                       .name = secondary->name,
-                                                       .mode = RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION,
-                                                       .needed_to_build_entry = NULL,
-                                                   },
-                                                   backtrace);
+        for (kan_loop_size_t index = 0u; index < wave.size; ++index)
+        {
+            struct scan_directory_task_t *task = &((struct scan_directory_task_t *) wave.data)[index];
+            successful &= task->successful;
+            ++directories_scanned;
 
-            if (!secondary_response.success)
+            if (task->reused)
             {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
-                         "secondary input \"%s\" of type \"%s\" cannot be found.",
-                         target->name, entry->name, entry->type->name, secondary->name, secondary->type)
-                new_status = RESOURCE_STATUS_BUILDING;
-                break;
+                ++directories_reused;
             }
 
-            KAN_ATOMIC_INT_SCOPED_LOCK_READ (&secondary_response.entry->header.lock)
-            if (secondary_response.entry->header.status != RESOURCE_STATUS_AVAILABLE)
+            if (!task->successful)
             {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
-                         "secondary input \"%s\" of type \"%s\" has other status than available.",
-                         target->name, entry->name, entry->type->name, secondary->name, secondary->type)
-                new_status = RESOURCE_STATUS_BUILDING;
-                break;
+                continue;
             }
 
-            if (!kan_resource_log_version_is_up_to_date (secondary->version,
-                                                         secondary_response.entry->header.available_version))
+            struct kan_file_system_path_container_t path;
+            kan_file_system_path_container_copy_string (&path, task->path);
+            const kan_instance_size_t base_length = path.length;
+
+            for (kan_loop_size_t child_index = 0u; child_index < task->record->directories.size; ++child_index)
             {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
-                         "secondary input \"%s\" of type \"%s\" version mismatch.",
-                         target->name, entry->name, entry->type->name, secondary->name, secondary->type)
-                new_status = RESOURCE_STATUS_BUILDING;
-                break;
+                kan_file_system_path_container_reset_length (&path, base_length);
+                kan_file_system_path_container_append (
+                    &path, ((kan_interned_string_t *) task->record->directories.data)[child_index]);
+
+                scan_wave_add (&next_wave, &previous_directories, task->target, task->snapshot_target,
+                               kan_char_sequence_intern (path.path, path.path + path.length));
             }
         }
 
-        if (new_status != RESOURCE_STATUS_AVAILABLE)
-        {
-            break;
-        }
+        struct kan_dynamic_array_t swap = wave;
+        wave = next_wave;
+        next_wave = swap;
+    }
 
-        // If this resource was marked as unsupported during previous build, we should not mark it as available now.
-        if (initial->saved_directory == KAN_RESOURCE_LOG_SAVED_DIRECTORY_UNSUPPORTED)
-        {
-            new_status = RESOURCE_STATUS_PLATFORM_UNSUPPORTED;
-        }
+    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO,
+             "Scanned %lu directories, %lu of them were unchanged and reused from scan snapshot.",
+             (unsigned long) directories_scanned, (unsigned long) directories_reused)
 
-        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                 "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as up to date.", target->name,
-                 entry->name, entry->type->name)
-        break;
+    if (!successful)
+    {
+        return KAN_RESOURCE_BUILD_RESULT_ERROR_RAW_RESOURCE_SCAN_FAILED;
     }
 
-    case RESOURCE_PRODUCTION_CLASS_SECONDARY:
+    kan_cpu_job_t job = kan_cpu_job_create ();
+    for (kan_loop_size_t index = 0u; index < register_contexts.size; ++index)
     {
-        const struct kan_resource_log_secondary_entry_t *initial = entry->initial_log_secondary_entry;
-        // Use initial version value if availability checks succeed.
-        available_version = initial->version;
+        struct scan_register_context_t *context = &((struct scan_register_context_t *) register_contexts.data)[index];
 
-        KAN_ASSERT_FORMATTED (
-            initial,
-            "[Target %s] Secondary resource \"%s\" of type \"%s\" is in unconfirmed status and no initial log, which "
-            "should be impossible as newly created built entries must start in building status right away.",
-            target->name, entry->type->name, entry->type->name)
+        // There is not that many targets, so we can just post tasks one by one instead of using task list.
+        kan_cpu_job_dispatch_task (job, (struct kan_cpu_task_t) {
+                                            .function = execute_raw_resource_register_for_target,
+                                            .user_data = (kan_functor_user_data_t) context,
+                                            .profiler_section = kan_cpu_section_get (context->target->name),
+                                        });
+    }
 
-        const struct kan_resource_reflected_data_resource_type_t *reflected_type =
-            kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+    kan_cpu_job_release (job);
+    kan_cpu_job_wait (job);
+    target = state->targets_first;
 
-        if (initial->version.type_version != reflected_type->resource_type_meta->version)
-        {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                     "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as out of date because of "
-                     "resource type version mismatch.",
-                     target->name, entry->name, entry->type->name)
-            new_status = RESOURCE_STATUS_BUILDING;
-            break;
-        }
+    while (target)
+    {
+        successful &= target->raw_resource_scan_step_successful;
+        target = target->next;
+    }
 
-        struct resource_response_t primary_input_response =
-            execute_resource_request_internal (state,
-                                               (struct resource_request_t) {
-                                                   .from_target = target,
-                                                   .type = initial->producer_type,
-                                                   .name = initial->producer_name,
-                                                   .mode = RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION,
-                                                   .needed_to_build_entry = NULL,
-                                               },
-                                               backtrace);
+    if (!successful)
+    {
+        return KAN_RESOURCE_BUILD_RESULT_ERROR_RAW_RESOURCE_SCAN_FAILED;
+    }
 
-        if (primary_input_response.success)
-        {
-            KAN_ATOMIC_INT_SCOPED_LOCK_READ (&primary_input_response.entry->header.lock)
-            switch (primary_input_response.entry->header.status)
-            {
-            case RESOURCE_STATUS_UNCONFIRMED:
-                KAN_ASSERT_FORMATTED (
-                    false, "Internal error, entry still has unconfirmed even after status confirmation request.", )
-                break;
+    save_scan_snapshot (state, &new_snapshot);
+    return KAN_RESOURCE_BUILD_RESULT_SUCCESS;
+}
 
-            case RESOURCE_STATUS_UNAVAILABLE:
-                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                         "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as unavailable "
-                         "because its producer \"%s\" of type \"%s\" is unavailable too.",
-                         target->name, entry->name, entry->type->name, initial->producer_name, initial->producer_type)
-                new_status = RESOURCE_STATUS_UNAVAILABLE;
-                break;
+// Resource request feature section which is a significant part of resource build routine.
 
-            case RESOURCE_STATUS_BUILDING:
-                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                         "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as out of date "
-                         "because its producer \"%s\" of type \"%s\" already has building status.",
-                         target->name, entry->name, entry->type->name, initial->producer_name, initial->producer_type)
-                new_status = RESOURCE_STATUS_BUILDING;
-                break;
+enum resource_request_mode_t
+{
+    /// \brief Dependency for build operation execution that must always be available.
+    /// \details Causes resource to be loaded. Pauses build operation execution until available.
+    RESOURCE_REQUEST_MODE_BUILD_REQUIRED = 0u,
 
-            case RESOURCE_STATUS_AVAILABLE:
-                if (!kan_resource_log_version_is_up_to_date (initial->producer_version,
-                                                             primary_input_response.entry->header.available_version))
-                {
-                    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                             "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as unavailable "
-                             "because its producer \"%s\" of type \"%s\" has other version and this secondary resource "
-                             "is not produced, making it unavailable.",
-                             target->name, entry->name, entry->type->name)
-                    new_status = RESOURCE_STATUS_UNAVAILABLE;
-                    break;
-                }
+    /// \brief Dependency for build operation execution that is allowed to be unavailable on some platforms.
+    /// \details Causes resource to be loaded. Pauses build operation execution until available if can be
+    ///          available at all.
+    RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL,
 
-                break;
+    /// \brief Used for resource status recursive hierarchical confirmation and for internal utility requests..
+    RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION,
 
-            case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
-                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                         "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as unavailable "
-                         "because its producer \"%s\" of type \"%s\" is marked platform unsupported.",
-                         target->name, entry->name, entry->type->name)
-                new_status = RESOURCE_STATUS_UNAVAILABLE;
-                break;
+    /// \brief Marks this resource as requested for deployment. Triggers resource build if necessary.
+    RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT,
 
-            case RESOURCE_STATUS_OUT_OF_SCOPE:
-                KAN_ASSERT_FORMATTED (false,
-                                      "Internal error, producer entry has out of scope status, which shouldn't be "
-                                      "possible due to target visibility rules.", )
-                break;
-            }
+    /// \brief Marks this resource as requested for deployment. Triggers resource build if necessary.
+    /// \details Unlike `RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT`, does not result in an error if resource has
+    ///          platform unsupported status.
+    RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT_PLATFORM_OPTIONAL,
 
-            if (new_status != RESOURCE_STATUS_AVAILABLE)
-            {
-                // Changed the status inside switch, break from the check.
-                break;
-            }
+    /// \brief Marks this resource as needed for the build cache.
+    /// \details Produces an error if this resource does not exist or is not available yet. Should only be used to mark
+    ///          resources to be cached after the build operation is done.
+    RESOURCE_REQUEST_MODE_MARK_CACHE,
+};
+
+struct resource_request_t
+{
+    struct target_t *from_target;
+    kan_interned_string_t type;
+    kan_interned_string_t name;
+    enum resource_request_mode_t mode;
+
+    /// \brief Entry that needs this resource for build operation if `RESOURCE_REQUEST_MODE_BUILD_REQUIRED` or
+    ///        `RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL` is used.
+    struct resource_entry_t *needed_to_build_entry;
+};
+
+struct resource_response_t
+{
+    bool success;
+    struct resource_entry_t *entry;
+};
+
+struct resource_request_backtrace_t
+{
+    const struct resource_request_backtrace_t *previous;
+    kan_interned_string_t type;
+    kan_interned_string_t name;
+};
+
+static struct resource_response_t execute_resource_request_internal (
+    struct build_state_t *state,
+    struct resource_request_t request,
+    const struct resource_request_backtrace_t *backtrace);
+
+static inline struct resource_response_t execute_resource_request (struct build_state_t *state,
+                                                                   struct resource_request_t request)
+{
+    return execute_resource_request_internal (state, request, NULL);
+}
+
+static struct build_queue_item_t *build_queue_item_create (struct build_state_t *state, struct resource_entry_t *entry);
+
+static void add_to_build_queue_new_unsafe (struct build_state_t *state, struct build_queue_item_t *item);
+
+static inline void confirm_resource_status (struct build_state_t *state,
+                                            struct resource_entry_t *entry,
+                                            const struct resource_request_backtrace_t *backtrace)
+{
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&entry->header.lock)
+        if (entry->header.status != RESOURCE_STATUS_UNCONFIRMED)
+        {
+            return;
         }
-        else
+    }
+
+    // We do resource status confirmation without locking as calculated status should always be the same and chance of
+    // calculating status twice should be quite rare.
+
+    struct target_t *target = entry->target;
+    enum resource_status_t new_status = RESOURCE_STATUS_AVAILABLE;
+    struct kan_resource_log_version_t available_version = {.type_version = 0u, .last_modification_time = 0u};
+
+    switch (entry->class)
+    {
+    case RESOURCE_PRODUCTION_CLASS_RAW:
+    {
+        if (!entry->current_file_location)
         {
             KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                     "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as unavailable "
-                     "because its producer \"%s\" of type \"%s\" can no longer be found.",
+                     "[Target \"%s\"] Marking raw resource \"%s\" of type \"%s\" as unavailable as it wasn't detected "
+                     "during raw resource scan phase.",
                      target->name, entry->name, entry->type->name)
+
             new_status = RESOURCE_STATUS_UNAVAILABLE;
             break;
         }
 
-        if (new_status != RESOURCE_STATUS_AVAILABLE)
+        struct kan_file_system_entry_status_t file_status;
+        if (!kan_file_system_query_entry (entry->current_file_location, &file_status))
         {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                     "[Target \"%s\"] Marking raw resource \"%s\" of type \"%s\" as unavailable as it wasn't "
+                     "possible to query its file status.",
+                     target->name, entry->name, entry->type->name)
+
+            new_status = RESOURCE_STATUS_UNAVAILABLE;
             break;
         }
 
-        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                 "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as up to date.", target->name,
-                 entry->name, entry->type->name)
-        break;
-    }
-    }
+        const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+            kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
 
-    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->header.lock)
-    if (entry->header.status != RESOURCE_STATUS_UNCONFIRMED)
-    {
-        // We've calculated status for this entry two times.
-        // It is possible due to absence of locking and should be fine as it won't change the result of the execution.
-        return;
-    }
+        available_version.type_version = reflected_type->resource_type_meta->version;
+        available_version.last_modification_time = file_status.last_modification_time_ns;
+        available_version.content_hash =
+            detect_file_content_hash (entry->initial_log_raw_entry ? &entry->initial_log_raw_entry->version : NULL,
+                                      file_status.last_modification_time_ns, entry->current_file_location);
 
-    entry->header.status = new_status;
-    switch (entry->header.status)
-    {
-    case RESOURCE_STATUS_UNCONFIRMED:
-    case RESOURCE_STATUS_OUT_OF_SCOPE:
-        KAN_ASSERT (false)
-        break;
+        if (!entry->initial_log_raw_entry ||
+            !kan_resource_log_version_is_up_to_date (entry->initial_log_raw_entry->version, available_version))
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                     "[Target \"%s\"] Marking raw resource \"%s\" of type \"%s\" as out of date in current build.",
+                     target->name, entry->name, entry->type->name)
+            new_status = RESOURCE_STATUS_BUILDING;
+            break;
+        }
 
-    case RESOURCE_STATUS_UNAVAILABLE:
-        // Nothing special to do.
+        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                 "[Target \"%s\"] Marking raw resource \"%s\" of type \"%s\" as up to date in current build.",
+                 target->name, entry->name, entry->type->name)
         break;
+    }
 
-    case RESOURCE_STATUS_BUILDING:
+    case RESOURCE_PRODUCTION_CLASS_PRIMARY:
     {
-        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->build.lock)
-        entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START;
+        const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+            kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
 
-        KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
-        add_to_build_queue_new_unsafe (state, entry);
-        break;
-    }
+        if (!reflected_type->produced_from_build_rule)
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                     "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as unavailable because build rule "
+                     "is no longer exists.",
+                     target->name, entry->name, entry->type->name)
+            new_status = RESOURCE_STATUS_UNAVAILABLE;
+            break;
+        }
 
-    case RESOURCE_STATUS_AVAILABLE:
-    case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
-        entry->header.available_version = available_version;
-        break;
-    }
-}
+        const struct kan_resource_log_built_entry_t *initial = entry->initial_log_built_entry;
+        // Use initial version value if availability checks succeed.
+        available_version = initial->version;
 
-static void print_circular_reference_backtrace (const struct resource_request_backtrace_t *backtrace)
-{
-    char chain_buffer[KAN_RESOURCE_PIPELINE_BUILD_CR_MESSAGE_BUFFER];
-    kan_instance_size_t chain_size = 0u;
+        KAN_ASSERT_FORMATTED (
+            initial,
+            "[Target %s] Built resource \"%s\" of type \"%s\" is in unconfirmed status and no initial log, which "
+            "should be impossible as newly created built entries must start in building status right away.",
+            target->name, entry->type->name, entry->type->name)
 
-    while (backtrace)
-    {
+        if (initial->rule_version != reflected_type->build_rule_version)
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                     "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because of build "
+                     "rule version mismatch.",
+                     target->name, entry->name, entry->type->name)
+            new_status = RESOURCE_STATUS_BUILDING;
+            break;
+        }
+
+        if (initial->version.type_version != reflected_type->resource_type_meta->version)
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                     "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because of resource "
+                     "type version mismatch.",
+                     target->name, entry->name, entry->type->name)
+            new_status = RESOURCE_STATUS_BUILDING;
+            break;
+        }
+
+        if (reflected_type->build_rule_platform_configuration_type)
+        {
+            const struct platform_configuration_entry_t *platform_configuration =
+                build_state_find_platform_configuration (state, reflected_type->build_rule_platform_configuration_type);
+
+            if (!platform_configuration)
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as unavailable because platform "
+                         "configuration entry is absent",
+                         target->name, entry->name, entry->type->name)
+                new_status = RESOURCE_STATUS_UNAVAILABLE;
+                break;
+            }
+
+            if (platform_configuration->file_time != initial->platform_configuration_time)
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because of "
+                         "platform configuration time mismatch.",
+                         target->name, entry->name, entry->type->name)
+                new_status = RESOURCE_STATUS_BUILDING;
+                break;
+            }
+        }
+
+        if (reflected_type->build_rule_primary_input_type)
+        {
+            struct resource_response_t primary_input_response =
+                execute_resource_request_internal (state,
+                                                   (struct resource_request_t) {
+                                                       .from_target = target,
+                                                       .type = reflected_type->build_rule_primary_input_type,
+                                                       .name = entry->name,
+                                                       .mode = RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION,
+                                                       .needed_to_build_entry = NULL,
+                                                   },
+                                                   backtrace);
+
+            if (primary_input_response.success)
+            {
+                KAN_ATOMIC_INT_SCOPED_LOCK_READ (&primary_input_response.entry->header.lock)
+                switch (primary_input_response.entry->header.status)
+                {
+                case RESOURCE_STATUS_UNCONFIRMED:
+                    KAN_ASSERT_FORMATTED (
+                        false, "Internal error, entry still has unconfirmed even after status confirmation request.", )
+                    break;
+
+                case RESOURCE_STATUS_UNAVAILABLE:
+                    KAN_LOG (
+                        resource_pipeline_build, KAN_LOG_DEBUG,
+                        "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as unavailable because primary "
+                        "input is unavailable too.",
+                        target->name, entry->name, entry->type->name)
+                    new_status = RESOURCE_STATUS_UNAVAILABLE;
+                    break;
+
+                case RESOURCE_STATUS_BUILDING:
+                    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                             "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
+                             "primary input already has building status.",
+                             target->name, entry->name, entry->type->name)
+                    new_status = RESOURCE_STATUS_BUILDING;
+                    break;
+
+                case RESOURCE_STATUS_AVAILABLE:
+                    if (!kan_resource_log_version_is_up_to_date (
+                            initial->primary_input_version, primary_input_response.entry->header.available_version))
+                    {
+                        KAN_LOG (
+                            resource_pipeline_build, KAN_LOG_DEBUG,
+                            "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because of "
+                            "version mismatch with its primary input.",
+                            target->name, entry->name, entry->type->name)
+                        new_status = RESOURCE_STATUS_BUILDING;
+                        break;
+                    }
+
+                    break;
+
+                case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
+                    KAN_LOG (
+                        resource_pipeline_build, KAN_LOG_DEBUG,
+                        "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as platform unsupported because "
+                        "primary input is platform unsupported too.",
+                        target->name, entry->name, entry->type->name)
+                    new_status = RESOURCE_STATUS_PLATFORM_UNSUPPORTED;
+                    break;
+
+                case RESOURCE_STATUS_OUT_OF_SCOPE:
+                    KAN_ASSERT_FORMATTED (false,
+                                          "Internal error, primary input entry has out of scope status, which "
+                                          "shouldn't be possible due to target visibility rules.", )
+                    break;
+                }
+
+                if (new_status != RESOURCE_STATUS_AVAILABLE)
+                {
+                    // Changed the status inside switch, break from the check.
+                    break;
+                }
+            }
+            else
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as unavailable because primary "
+                         "input can no longer be found.",
+                         target->name, entry->name, entry->type->name)
+                new_status = RESOURCE_STATUS_UNAVAILABLE;
+                break;
+            }
+        }
+        else
+        {
+            // Import build rule, custom handling.
+            struct raw_third_party_entry_t *third_party = target_search_visible_third_party (target, entry->name);
+
+            if (!third_party)
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
+                         "primary input which is raw third party file cannot be found.",
+                         target->name, entry->name, entry->type->name)
+                new_status = RESOURCE_STATUS_BUILDING;
+                break;
+            }
+
+            if (!raw_third_party_entry_is_up_to_date (third_party, &initial->primary_input_version))
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
+                         "primary input which is raw third party file has been changed.",
+                         target->name, entry->name, entry->type->name)
+                new_status = RESOURCE_STATUS_BUILDING;
+                break;
+            }
+        }
+
+        for (kan_loop_size_t index = 0u; index < initial->secondary_inputs.size; ++index)
+        {
+            const struct kan_resource_log_secondary_input_t *secondary =
+                &((struct kan_resource_log_secondary_input_t *) initial->secondary_inputs.data)[index];
+
+            if (!secondary->type)
+            {
+                // Third party dependency, custom handling.
+                struct raw_third_party_entry_t *third_party =
+                    target_search_visible_third_party (target, secondary->name);
+
+                if (!third_party)
+                {
+                    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                             "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
+                             "secondary input \"%s\" which is raw third party file cannot be found.",
+                             target->name, entry->name, entry->type->name, secondary->name, secondary->type)
+                    new_status = RESOURCE_STATUS_BUILDING;
+                    break;
+                }
+
+                if (!raw_third_party_entry_is_up_to_date (third_party, &secondary->version))
+                {
+                    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                             "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
+                             "secondary input \"%s\" which is raw third party file has been changed.",
+                             target->name, entry->name, entry->type->name, secondary->name, secondary->type)
+                    new_status = RESOURCE_STATUS_BUILDING;
+                    break;
+                }
+
+                continue;
+            }
+
+            struct resource_response_t secondary_response =
+                execute_resource_request_internal (state,
+                                                   (struct resource_request_t) {
+                                                       .from_target = target,
+                                                       .type = secondary->type,
+                                                       .name = secondary->name,
+                                                       .mode = RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION,
+                                                       .needed_to_build_entry = NULL,
+                                                   },
+                                                   backtrace);
+
+            if (!secondary_response.success)
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
+                         "secondary input \"%s\" of type \"%s\" cannot be found.",
+                         target->name, entry->name, entry->type->name, secondary->name, secondary->type)
+                new_status = RESOURCE_STATUS_BUILDING;
+                break;
+            }
+
+            KAN_ATOMIC_INT_SCOPED_LOCK_READ (&secondary_response.entry->header.lock)
+            if (secondary_response.entry->header.status != RESOURCE_STATUS_AVAILABLE)
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
+                         "secondary input \"%s\" of type \"%s\" has other status than available.",
+                         target->name, entry->name, entry->type->name, secondary->name, secondary->type)
+                new_status = RESOURCE_STATUS_BUILDING;
+                break;
+            }
+
+            if (!kan_resource_log_version_is_up_to_date (secondary->version,
+                                                         secondary_response.entry->header.available_version))
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                         "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as out of date because its "
+                         "secondary input \"%s\" of type \"%s\" version mismatch.",
+                         target->name, entry->name, entry->type->name, secondary->name, secondary->type)
+                new_status = RESOURCE_STATUS_BUILDING;
+                break;
+            }
+        }
+
+        if (new_status != RESOURCE_STATUS_AVAILABLE)
+        {
+            break;
+        }
+
+        // If this resource was marked as unsupported during previous build, we should not mark it as available now.
+        if (initial->saved_directory == KAN_RESOURCE_LOG_SAVED_DIRECTORY_UNSUPPORTED)
+        {
+            new_status = RESOURCE_STATUS_PLATFORM_UNSUPPORTED;
+        }
+
+        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                 "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as up to date.", target->name,
+                 entry->name, entry->type->name)
+        break;
+    }
+
+    case RESOURCE_PRODUCTION_CLASS_SECONDARY:
+    {
+        const struct kan_resource_log_secondary_entry_t *initial = entry->initial_log_secondary_entry;
+        // Use initial version value if availability checks succeed.
+        available_version = initial->version;
+
+        KAN_ASSERT_FORMATTED (
+            initial,
+            "[Target %s] Secondary resource \"%s\" of type \"%s\" is in unconfirmed status and no initial log, which "
+            "should be impossible as newly created built entries must start in building status right away.",
+            target->name, entry->type->name, entry->type->name)
+
+        const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+            kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+
+        if (initial->version.type_version != reflected_type->resource_type_meta->version)
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                     "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as out of date because of "
+                     "resource type version mismatch.",
+                     target->name, entry->name, entry->type->name)
+            new_status = RESOURCE_STATUS_BUILDING;
+            break;
+        }
+
+        struct resource_response_t primary_input_response =
+            execute_resource_request_internal (state,
+                                               (struct resource_request_t) {
+                                                   .from_target = target,
+                                                   .type = initial->producer_type,
+                                                   .name = initial->producer_name,
+                                                   .mode = RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION,
+                                                   .needed_to_build_entry = NULL,
+                                               },
+                                               backtrace);
+
+        if (primary_input_response.success)
+        {
+            KAN_ATOMIC_INT_SCOPED_LOCK_READ (&primary_input_response.entry->header.lock)
+            switch (primary_input_response.entry->header.status)
+            {
+            case RESOURCE_STATUS_UNCONFIRMED:
+                KAN_ASSERT_FORMATTED (
+                    false, "Internal error, entry still has unconfirmed even after status confirmation request.", )
+                break;
+
+            case RESOURCE_STATUS_UNAVAILABLE:
+                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                         "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as unavailable "
+                         "because its producer \"%s\" of type \"%s\" is unavailable too.",
+                         target->name, entry->name, entry->type->name, initial->producer_name, initial->producer_type)
+                new_status = RESOURCE_STATUS_UNAVAILABLE;
+                break;
+
+            case RESOURCE_STATUS_BUILDING:
+                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                         "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as out of date "
+                         "because its producer \"%s\" of type \"%s\" already has building status.",
+                         target->name, entry->name, entry->type->name, initial->producer_name, initial->producer_type)
+                new_status = RESOURCE_STATUS_BUILDING;
+                break;
+
+            case RESOURCE_STATUS_AVAILABLE:
+                if (!kan_resource_log_version_is_up_to_date (initial->producer_version,
+                                                             primary_input_response.entry->header.available_version))
+                {
+                    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                             "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as unavailable "
+                             "because its producer \"%s\" of type \"%s\" has other version and this secondary resource "
+                             "is not produced, making it unavailable.",
+                             target->name, entry->name, entry->type->name)
+                    new_status = RESOURCE_STATUS_UNAVAILABLE;
+                    break;
+                }
+
+                break;
+
+            case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
+                KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                         "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as unavailable "
+                         "because its producer \"%s\" of type \"%s\" is marked platform unsupported.",
+                         target->name, entry->name, entry->type->name)
+                new_status = RESOURCE_STATUS_UNAVAILABLE;
+                break;
+
+            case RESOURCE_STATUS_OUT_OF_SCOPE:
+                KAN_ASSERT_FORMATTED (false,
+                                      "Internal error, producer entry has out of scope status, which shouldn't be "
+                                      "possible due to target visibility rules.", )
+                break;
+            }
+
+            if (new_status != RESOURCE_STATUS_AVAILABLE)
+            {
+                // Changed the status inside switch, break from the check.
+                break;
+            }
+        }
+        else
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                     "[Target \"%s\"] Marking secondary built resource \"%s\" of type \"%s\" as unavailable "
+                     "because its producer \"%s\" of type \"%s\" can no longer be found.",
+                     target->name, entry->name, entry->type->name)
+            new_status = RESOURCE_STATUS_UNAVAILABLE;
+            break;
+        }
+
+        if (new_status != RESOURCE_STATUS_AVAILABLE)
+        {
+            break;
+        }
+
+        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                 "[Target \"%s\"] Marking built resource \"%s\" of type \"%s\" as up to date.", target->name,
+                 entry->name, entry->type->name)
+        break;
+    }
+    }
+
+    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->header.lock)
+    if (entry->header.status != RESOURCE_STATUS_UNCONFIRMED)
+    {
+        // We've calculated status for this entry two times.
+        // It is possible due to absence of locking and should be fine as it won't change the result of the execution.
+        return;
+    }
+
+    entry->header.status = new_status;
+    switch (entry->header.status)
+    {
+    case RESOURCE_STATUS_UNCONFIRMED:
+    case RESOURCE_STATUS_OUT_OF_SCOPE:
+        KAN_ASSERT (false)
+        break;
+
+    case RESOURCE_STATUS_UNAVAILABLE:
+        // Nothing special to do.
+        break;
+
+    case RESOURCE_STATUS_BUILDING:
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->build.lock)
+        entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START;
+        struct build_queue_item_t *item = build_queue_item_create (state, entry);
+
+        KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
+        add_to_build_queue_new_unsafe (state, item);
+        break;
+    }
+
+    case RESOURCE_STATUS_AVAILABLE:
+    case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
+        entry->header.available_version = available_version;
+        break;
+    }
+}
+
+static void print_circular_reference_backtrace (const struct resource_request_backtrace_t *backtrace)
+{
+    char chain_buffer[KAN_RESOURCE_PIPELINE_BUILD_CR_MESSAGE_BUFFER];
+    kan_instance_size_t chain_size = 0u;
+
+    while (backtrace)
+    {
 #define ADD_TO_CHAIN(STRING)                                                                                           \
     {                                                                                                                  \
         const char *cursor = STRING;                                                                                   \
@@ -2533,840 +3457,2116 @@ static void print_circular_reference_backtrace (const struct resource_request_ba
         }                                                                                                              \
     }
 
-        ADD_TO_CHAIN (backtrace->type)
-        ADD_TO_CHAIN ("::")
-        ADD_TO_CHAIN (backtrace->name)
+        ADD_TO_CHAIN (backtrace->type)
+        ADD_TO_CHAIN ("::")
+        ADD_TO_CHAIN (backtrace->name)
+
+        if (backtrace->previous)
+        {
+            ADD_TO_CHAIN (" <= ")
+        }
+
+#undef ADD_TO_CHAIN
+        backtrace = backtrace->previous;
+    }
+
+    chain_buffer[chain_size] = '\0';
+    KAN_LOG_WITH_BUFFER (KAN_RESOURCE_PIPELINE_BUILD_CR_MESSAGE_BUFFER * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                         "Caught circular reference while executing resource request with build operation or status "
+                         "confirmation mode. It usually means that there is a circular dependency between build rules. "
+                         "Printing reference chain (left is the deepest): %s.",
+                         chain_buffer)
+}
+
+/// \details Needs external write access to build state of blocking entry, therefore marked unsafe.
+static inline void block_entry_build_by_entry_unsafe (struct resource_entry_t *entry_to_build,
+                                                      struct resource_entry_t *blocking_entry)
+{
+    kan_atomic_int_add (&entry_to_build->build.atomic_next_build_task_block_counter, 1);
+    struct resource_entry_build_blocked_t *blocked =
+        kan_allocate_batched (blocking_entry->allocation_group, sizeof (struct resource_entry_build_blocked_t));
+    blocked->blocked_entry = entry_to_build;
+
+    blocked->next = blocking_entry->build.blocked_other_first;
+    blocking_entry->build.blocked_other_first = blocked;
+}
+
+static void *load_resource_entry_data (struct build_state_t *state, struct resource_entry_t *entry);
+
+static bool process_resource_as_build_dependency (struct build_state_t *state,
+                                                  struct resource_entry_t *entry,
+                                                  bool required,
+                                                  struct resource_entry_t *needed_to_build_entry)
+{
+    KAN_ATOMIC_INT_SCOPED_LOCK_READ (&entry->header.lock)
+    switch (entry->header.status)
+    {
+    case RESOURCE_STATUS_UNCONFIRMED:
+    {
+        // If other logic works as expected, it can never happen.
+        KAN_ASSERT (false)
+        return false;
+    }
+
+    case RESOURCE_STATUS_UNAVAILABLE:
+    {
+        // Not available, there is not a valid build dependency.
+        return false;
+    }
+
+    case RESOURCE_STATUS_BUILDING:
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->build.lock)
+        ++entry->build.loaded_data_request_count;
+        block_entry_build_by_entry_unsafe (needed_to_build_entry, entry);
+        return true;
+    }
+
+    case RESOURCE_STATUS_AVAILABLE:
+    {
+        // Can trigger loading, therefore a write lock.
+        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->build.lock)
+        ++entry->build.loaded_data_request_count;
+
+        if (!entry->build.loaded_data)
+        {
+            if (entry->build.loaded_data_request_count == 1u)
+            {
+                // First request, we need to properly start the build.
+                entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_LOAD;
+                struct build_queue_item_t *item = build_queue_item_create (state, entry);
+
+                KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
+                add_to_build_queue_new_unsafe (state, item);
+            }
+
+            block_entry_build_by_entry_unsafe (needed_to_build_entry, entry);
+        }
+
+        return true;
+    }
+
+    case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
+    {
+        // Platform unsupported are treated as valid dependencies unless required flag is set.
+        return !required;
+    }
+
+    case RESOURCE_STATUS_OUT_OF_SCOPE:
+    {
+        // Should never be a build dependency if target visibility works as expected.
+        KAN_ASSERT (false)
+        return false;
+    }
+    }
+
+    return false;
+}
+
+static inline const struct kan_dynamic_array_t *get_references_from_resource_entry_unsafe (
+    struct resource_entry_t *entry)
+{
+    // If assert fails, then caller didn't ensure that build is finished prior to accessing references.
+    KAN_ASSERT (entry->header.status == RESOURCE_STATUS_AVAILABLE ||
+                entry->header.status == RESOURCE_STATUS_PLATFORM_UNSUPPORTED ||
+                entry->header.status == RESOURCE_STATUS_OUT_OF_SCOPE)
+
+    if (entry->header.status == RESOURCE_STATUS_OUT_OF_SCOPE ||
+        (entry->initial_log_built_entry && !entry->header.passed_build_routine_mark))
+    {
+        switch (entry->class)
+        {
+        case RESOURCE_PRODUCTION_CLASS_RAW:
+            return &entry->initial_log_raw_entry->references;
+
+        case RESOURCE_PRODUCTION_CLASS_PRIMARY:
+            return &entry->initial_log_built_entry->references;
+
+        case RESOURCE_PRODUCTION_CLASS_SECONDARY:
+            return &entry->initial_log_secondary_entry->references;
+        }
+    }
+
+    return &entry->new_references;
+}
+
+static bool mark_resource_references_for_deployment (struct build_state_t *state,
+                                                     struct resource_entry_t *entry,
+                                                     const struct resource_request_backtrace_t *backtrace)
+{
+    const struct kan_dynamic_array_t *source_array;
+    kan_atomic_int_lock_read (&entry->header.lock);
+    source_array = get_references_from_resource_entry_unsafe (entry);
+    kan_atomic_int_unlock_read (&entry->header.lock);
+
+    // We don't need full locking here as `new_references` should not be changed after build and function
+    // caller should ensure that this function is only being called after the build.
+
+    for (kan_loop_size_t index = 0u; index < source_array->size; ++index)
+    {
+        const struct kan_resource_log_reference_t *reference =
+            &((struct kan_resource_log_reference_t *) source_array->data)[index];
+
+        if (!reference->type)
+        {
+            struct raw_third_party_entry_t *third_party =
+                target_search_visible_third_party (entry->target, reference->name);
+
+            if (!third_party)
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                         "[Target \"%s\"] Failed to mark \"%s\" third party resource for deployment (it needs to be "
+                         "deployed as it is referenced from \"%s\" of type \"%s\" which is deployed).",
+                         entry->target->name, reference->name, entry->name, entry->type->name);
+                return false;
+            }
+
+            third_party->deployment_mark = true;
+            continue;
+        }
+
+        struct resource_request_t reference_request = {
+            .from_target = entry->target,
+            .type = reference->type,
+            .name = reference->name,
+            .mode = (reference->flags & KAN_RESOURCE_REFERENCE_REQUIRED) ?
+                        RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT :
+                        RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT_PLATFORM_OPTIONAL,
+            .needed_to_build_entry = NULL,
+        };
+
+        struct resource_response_t reference_response =
+            execute_resource_request_internal (state, reference_request, backtrace);
+
+        if (!reference_response.success)
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for deployment (it needs to be deployed as "
+                     "it is referenced from \"%s\" of type \"%s\" which is deployed).",
+                     entry->target->name, reference->name, reference->type, entry->name, entry->type->name);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool mark_resource_build_dependencies_for_cache (struct build_state_t *state,
+                                                        struct resource_entry_t *entry,
+                                                        const struct resource_request_backtrace_t *backtrace)
+{
+    if (entry->class != RESOURCE_PRODUCTION_CLASS_PRIMARY)
+    {
+        // No dependencies to mark.
+        return true;
+    }
+
+    const struct kan_dynamic_array_t *source_array;
+    bool new_build;
+
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&entry->header.lock)
+        // If assert fails, then caller didn't ensure that build is finished prior to marking dependencies for cache.
+        KAN_ASSERT (entry->header.status == RESOURCE_STATUS_AVAILABLE ||
+                    entry->header.status == RESOURCE_STATUS_PLATFORM_UNSUPPORTED ||
+                    entry->header.status == RESOURCE_STATUS_OUT_OF_SCOPE)
+
+        if (entry->initial_log_built_entry && !entry->header.passed_build_routine_mark)
+        {
+            source_array = &entry->initial_log_built_entry->secondary_inputs;
+            new_build = false;
+        }
+        else
+        {
+            source_array = &entry->new_build_secondary_inputs;
+            new_build = true;
+        }
+    }
+
+    // We don't need full locking here as `new_build_secondary_inputs` should not be changed after build and function
+    // caller should ensure that this function is only being called after the build.
+
+    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+
+    if (reflected_type->build_rule_primary_input_type)
+    {
+        struct resource_request_t primary_input_request = {
+            .from_target = entry->target,
+            .type = reflected_type->build_rule_primary_input_type,
+            .name = entry->name,
+            .mode = RESOURCE_REQUEST_MODE_MARK_CACHE,
+            .needed_to_build_entry = NULL,
+        };
+
+        struct resource_response_t primary_input_response =
+            execute_resource_request_internal (state, primary_input_request, backtrace);
+
+        if (!primary_input_response.success)
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for cache (it needs to be cached as build "
+                     "dependency of \"%s\" of type \"%s\").",
+                     entry->target->name, entry->name, reflected_type->build_rule_primary_input_type, entry->name,
+                     entry->type->name);
+            return false;
+        }
+    }
+
+    for (kan_loop_size_t index = 0u; index < source_array->size; ++index)
+    {
+        struct resource_request_t secondary_input_request = {
+            .from_target = entry->target,
+            .type = NULL,
+            .name = NULL,
+            .mode = RESOURCE_REQUEST_MODE_MARK_CACHE,
+            .needed_to_build_entry = NULL,
+        };
+
+        if (new_build)
+        {
+            struct new_build_secondary_input_t *secondary =
+                &((struct new_build_secondary_input_t *) source_array->data)[index];
+
+            if (!secondary->entry)
+            {
+                // Third party resources cannot be cached and cannot be marked for cache.
+                continue;
+            }
+
+            secondary_input_request.type = secondary->entry->type->name;
+            secondary_input_request.name = secondary->entry->name;
+        }
+        else
+        {
+            const struct kan_resource_log_secondary_input_t *secondary =
+                &((struct kan_resource_log_secondary_input_t *) source_array->data)[index];
+
+            if (!secondary->type)
+            {
+                // Third party resources cannot be cached and cannot be marked for cache.
+                continue;
+            }
+
+            secondary_input_request.type = secondary->type;
+            secondary_input_request.name = secondary->name;
+        }
+
+        struct resource_response_t secondary_input_response =
+            execute_resource_request_internal (state, secondary_input_request, backtrace);
+
+        if (!secondary_input_response.success)
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for cache (it needs to be cached as build "
+                     "dependency of \"%s\" of type \"%s\").",
+                     entry->target->name, secondary_input_request.name, secondary_input_request.type, entry->name,
+                     entry->type->name);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool mark_resource_for_deployment (struct build_state_t *state,
+                                          struct resource_entry_t *entry,
+                                          bool required,
+                                          const struct resource_request_backtrace_t *backtrace)
+{
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->header.lock)
+        if (entry->header.deployment_mark)
+        {
+            // Already marked, no need to mark referenced resources for deployment and dependencies for the cache.
+            return true;
+        }
+
+        entry->header.deployment_mark = true;
+        switch (entry->header.status)
+        {
+        case RESOURCE_STATUS_UNCONFIRMED:
+        case RESOURCE_STATUS_UNAVAILABLE:
+        case RESOURCE_STATUS_BUILDING:
+            // Neither references nor dependency list are ready, so there is nothing more to mark right now.
+            // It also means that these marks will be applied in the end of build operation as deployment mark will be
+            // visible as already applied to the build operation when it ends.
+            return true;
+
+        case RESOURCE_STATUS_AVAILABLE:
+        case RESOURCE_STATUS_OUT_OF_SCOPE:
+            // Cannot return right now, we also need to mark references and dependencies properly.
+            break;
+
+        case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
+            if (!required)
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                         "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for deployment as it is unsupported on "
+                         "this platform, but reference field meta does not allow platform unsupported resources.",
+                         entry->target->name, entry->name, entry->type->name);
+                return false;
+            }
+
+            break;
+        }
+    }
+
+    return mark_resource_references_for_deployment (state, entry, backtrace) &&
+           mark_resource_build_dependencies_for_cache (state, entry, backtrace);
+}
+
+static bool mark_resource_for_cache (struct build_state_t *state,
+                                     struct resource_entry_t *entry,
+                                     const struct resource_request_backtrace_t *backtrace)
+{
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->header.lock)
+        switch (entry->header.status)
+        {
+        case RESOURCE_STATUS_UNCONFIRMED:
+        case RESOURCE_STATUS_UNAVAILABLE:
+        case RESOURCE_STATUS_BUILDING:
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for cache as it is neither available "
+                     "nor platform unsupported.",
+                     entry->target->name, entry->name, entry->type->name);
+            return false;
+
+        case RESOURCE_STATUS_AVAILABLE:
+        case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
+        case RESOURCE_STATUS_OUT_OF_SCOPE:
+            // It is okay to have that status while marking for the cache.
+            break;
+        }
+
+        if (entry->header.cache_mark)
+        {
+            // Already marked, no need to mark dependencies for the cache.
+            return true;
+        }
+
+        entry->header.cache_mark = true;
+    }
+
+    return mark_resource_build_dependencies_for_cache (state, entry, backtrace);
+}
+
+static struct resource_response_t execute_resource_request_internal (
+    struct build_state_t *state,
+    struct resource_request_t request,
+    const struct resource_request_backtrace_t *backtrace)
+{
+    KAN_ASSERT_FORMATTED (request.type,
+                          "Caught attempt to use execute_resource_request to get third party resource, which is not "
+                          "supported, it is an internal error.", )
+
+    struct resource_response_t response = {
+        .success = false,
+        .entry = NULL,
+    };
+
+    struct resource_request_backtrace_t trace = {
+        .previous = backtrace,
+        .type = request.type,
+        .name = request.name,
+    };
+
+    switch (request.mode)
+    {
+    case RESOURCE_REQUEST_MODE_BUILD_REQUIRED:
+    case RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL:
+    case RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION:
+    {
+        // Check for circular request dependency, so we don't end up in a deadlock.
+        const struct resource_request_backtrace_t *circular_check = backtrace;
+
+        while (circular_check)
+        {
+            if (circular_check->type == request.type && circular_check->name == request.name)
+            {
+                print_circular_reference_backtrace (&trace);
+                return response;
+            }
+
+            circular_check = circular_check->previous;
+        }
+
+        break;
+    }
+
+    case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT:
+    case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT_PLATFORM_OPTIONAL:
+    case RESOURCE_REQUEST_MODE_MARK_CACHE:
+        // Not a circular-dependent mode, so we reset our part of backtrace
+        // to avoid false positive circular reference failures.
+        trace.previous = NULL;
+        break;
+    }
+
+    // First pass: try to find among the ones that already exist in shared read-only mode.
+    kan_atomic_int_lock_read (&state->resource_entries_lock);
+    response.entry = target_search_visible_resource_unsafe (request.from_target, request.type, request.name);
+    kan_atomic_int_unlock_read (&state->resource_entries_lock);
+
+    if (!response.entry)
+    {
+        // Resource is nowhere to be found. Decide what could be done next depending on the mode.
+        switch (request.mode)
+        {
+        case RESOURCE_REQUEST_MODE_BUILD_REQUIRED:
+        case RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL:
+        case RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION:
+        case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT:
+        case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT_PLATFORM_OPTIONAL:
+        {
+            // Resource can be produced by build rule. Let's check if it exists.
+            const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+                kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, request.type);
+
+            if (!reflected_type->produced_from_build_rule)
+            {
+                // Not produced by build rule, return default unavailable response.
+                return response;
+            }
+
+            // Built resource should always be created in the same target as its primary input.
+            struct target_t *primary_target = NULL;
+
+            if (reflected_type->build_rule_primary_input_type)
+            {
+                struct resource_response_t primary_input_response =
+                    execute_resource_request_internal (state,
+                                                       (struct resource_request_t) {
+                                                           .from_target = request.from_target,
+                                                           .type = reflected_type->build_rule_primary_input_type,
+                                                           .name = request.name,
+                                                           .mode = RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION,
+                                                           .needed_to_build_entry = NULL,
+                                                       },
+                                                       &trace);
+
+                if (!primary_input_response.success)
+                {
+                    // No primary input to build entry, return default unavailable response.
+                    return response;
+                }
+
+                primary_target = primary_input_response.entry->target;
+            }
+            else
+            {
+                struct raw_third_party_entry_t *entry =
+                    target_search_visible_third_party (request.from_target, request.name);
+
+                if (!entry)
+                {
+                    // No primary input to build entry, return default unavailable response.
+                    return response;
+                }
+
+                primary_target = entry->target;
+            }
+
+            // Resource can be built using a rule, so let's create an entry and try to build it.
+            // Lock for write as we're creating new entry.
+            KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&state->resource_entries_lock)
+
+            // While we were waiting for write access, somebody else might've already got write access and
+            // create this node too. Let's check it.
+            response.entry = target_search_local_resource_unsafe (primary_target, request.type, request.name);
+
+            if (!response.entry)
+            {
+                struct resource_type_container_t *container =
+                    target_search_resource_type_container_unsafe (primary_target, request.type);
+
+                if (!container)
+                {
+                    container = resource_type_container_create (primary_target, reflected_type->struct_type);
+                }
+
+                response.entry = resource_entry_create (container, request.name);
+                response.entry->class = RESOURCE_PRODUCTION_CLASS_PRIMARY;
+
+                KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&response.entry->header.lock)
+                KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&response.entry->build.lock)
+
+                response.entry->header.status = RESOURCE_STATUS_BUILDING;
+                response.entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START;
+                struct build_queue_item_t *item = build_queue_item_create (state, response.entry);
+
+                KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
+                add_to_build_queue_new_unsafe (state, item);
+            }
+            else if (response.entry->target != primary_target)
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                         "[Target \"%s\"] Failed to create \"%s\" of type \"%s\" from build rule as resource with that "
+                         "name already exists in target \"%s\" visible from primary input target \"%s\".",
+                         request.from_target->name, request.name, request.type, response.entry->target->name,
+                         primary_target->name);
+                return response;
+            }
+
+            break;
+        }
+
+        case RESOURCE_REQUEST_MODE_MARK_CACHE:
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for cache as it does not exist.",
+                     request.from_target->name, request.name, request.type);
+            return response;
+        }
+    }
+
+    KAN_ASSERT (response.entry)
+    confirm_resource_status (state, response.entry, &trace);
+
+    switch (request.mode)
+    {
+    case RESOURCE_REQUEST_MODE_BUILD_REQUIRED:
+        response.success =
+            process_resource_as_build_dependency (state, response.entry, true, request.needed_to_build_entry);
+        break;
+
+    case RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL:
+        response.success =
+            process_resource_as_build_dependency (state, response.entry, false, request.needed_to_build_entry);
+        break;
+
+    case RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION:
+        // No additional tasks, confirmation is executed, so we can just mark response as successful and that's all.
+        response.success = true;
+        break;
+
+    case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT:
+        response.success = mark_resource_for_deployment (state, response.entry, true, &trace);
+        break;
+
+    case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT_PLATFORM_OPTIONAL:
+        response.success = mark_resource_for_deployment (state, response.entry, false, &trace);
+        break;
+
+    case RESOURCE_REQUEST_MODE_MARK_CACHE:
+        response.success = mark_resource_for_cache (state, response.entry, &trace);
+        break;
+    }
+
+    return response;
+}
+
+// Build task feature section which implements core routine of building resources.
+
+static const char *get_resource_entry_next_build_task_name (enum resource_entry_next_build_task_t task)
+{
+    switch (task)
+    {
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_NONE:
+        return "<none>";
+
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START:
+        return "build: start";
+
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_PROCESS_PRIMARY:
+        return "build: process primary input";
+
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_EXECUTE_BUILD_RULE:
+        return "build: execute build rule";
+
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_LOAD:
+        return "load";
+    }
+
+    return "<unknown>";
+}
+
+/// \brief Tasks that can be executed after main build operation for helper causes (like loading built entry that is
+///        already unloaded) are called repeated tasks.
+static bool is_resource_entry_next_build_task_repeated (enum resource_entry_next_build_task_t task)
+{
+    switch (task)
+    {
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_NONE:
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START:
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_PROCESS_PRIMARY:
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_EXECUTE_BUILD_RULE:
+        return false;
+
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_LOAD:
+        return true;
+    }
+
+    return false;
+}
+
+enum build_step_result_t
+{
+    BUILD_STEP_RESULT_SUCCESSFUL = 0u,
+    BUILD_STEP_RESULT_FAILED,
+    BUILD_STEP_RESULT_PAUSED,
+};
+
+static void *load_resource_entry_data (struct build_state_t *state, struct resource_entry_t *entry)
+{
+    if (!entry->current_file_location)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" as there is no path provided for it due to "
+                 "internal error.",
+                 entry->target->name, entry->name, entry->type->name);
+        return NULL;
+    }
+
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_read (entry->current_file_location, true);
+    if (!stream)
+    {
+        KAN_LOG (
+            resource_pipeline_build, KAN_LOG_ERROR,
+            "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" as it wasn't possible to open file at path \"%s\".",
+            entry->target->name, entry->name, entry->type->name, entry->current_file_location);
+        return NULL;
+    }
+
+    stream = kan_random_access_stream_buffer_open_for_read (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
+    CUSHION_DEFER { stream->operations->close (stream); }
+
+    void *loaded_data = kan_allocate_general (entry->allocation_group, entry->type->size, entry->type->alignment);
+    if (entry->type->init)
+    {
+        kan_allocation_group_stack_push (entry->allocation_group);
+        entry->type->init (entry->type->functor_user_data, loaded_data);
+        kan_allocation_group_stack_pop ();
+    }
+
+    kan_instance_size_t location_length = (kan_instance_size_t) strlen (entry->current_file_location);
+    enum kan_serialization_state_t serialization_state = KAN_SERIALIZATION_FAILED;
+
+    if (location_length >= 4u && entry->current_file_location[location_length - 4u] == '.' &&
+        entry->current_file_location[location_length - 3u] == 'b' &&
+        entry->current_file_location[location_length - 2u] == 'i' &&
+        entry->current_file_location[location_length - 1u] == 'n')
+    {
+        kan_interned_string_t read_type_name;
+        if (!kan_serialization_binary_read_type_header (
+                stream, &read_type_name, KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t)))
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" due to error while reading type header.",
+                     entry->target->name, entry->name, entry->type->name);
+            serialization_state = KAN_SERIALIZATION_FAILED;
+            goto serialization_done;
+        }
+
+        if (read_type_name != entry->type->name)
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" as its type header specifies unexpected "
+                     "type \"%s\".",
+                     entry->target->name, entry->name, entry->type->name, read_type_name);
+            serialization_state = KAN_SERIALIZATION_FAILED;
+            goto serialization_done;
+        }
+
+        kan_serialization_binary_reader_t reader = kan_serialization_binary_reader_create (
+            stream, loaded_data, entry->type->name, state->binary_script_storage,
+            KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t), entry->allocation_group);
+
+        while ((serialization_state = kan_serialization_binary_reader_step (reader)) == KAN_SERIALIZATION_IN_PROGRESS)
+        {
+        }
+
+        if (serialization_state == KAN_SERIALIZATION_FAILED)
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" due to binary serialization error.",
+                     entry->target->name, entry->name, entry->type->name);
+        }
+
+        kan_serialization_binary_reader_destroy (reader);
+    }
+    else if (location_length >= 3u && entry->current_file_location[location_length - 3u] == '.' &&
+             entry->current_file_location[location_length - 2u] == 'r' &&
+             entry->current_file_location[location_length - 1u] == 'd')
+    {
+        kan_serialization_rd_reader_t reader = kan_serialization_rd_reader_create (
+            stream, loaded_data, entry->type->name, state->setup->reflected_data->registry, entry->allocation_group);
+
+        while ((serialization_state = kan_serialization_rd_reader_step (reader)) == KAN_SERIALIZATION_IN_PROGRESS)
+        {
+        }
+
+        if (serialization_state == KAN_SERIALIZATION_FAILED)
+        {
+            KAN_LOG (
+                resource_pipeline_build, KAN_LOG_ERROR,
+                "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" as due to readable data serialization error.",
+                entry->target->name, entry->name, entry->type->name, entry->current_file_location);
+        }
+
+        kan_serialization_rd_reader_destroy (reader);
+    }
+    else
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" as it wasn't possible to guess the serialized "
+                 "format from path \"%s\".",
+                 entry->target->name, entry->name, entry->type->name, entry->current_file_location);
+    }
+
+serialization_done:
+    if (serialization_state != KAN_SERIALIZATION_FINISHED)
+    {
+        if (entry->type->shutdown)
+        {
+            entry->type->shutdown (entry->type->functor_user_data, loaded_data);
+        }
+
+        kan_free_general (entry->allocation_group, loaded_data, entry->type->size);
+        loaded_data = NULL;
+    }
+
+    return loaded_data;
+}
+
+struct build_step_output_t
+{
+    enum build_step_result_t result;
+    enum resource_status_t status;
+    struct kan_resource_log_version_t available_version;
+    void *loaded_data_to_manage;
+};
+
+static void build_step_output_unload_data (struct build_step_output_t *output, struct resource_entry_t *entry)
+{
+    if (output->loaded_data_to_manage)
+    {
+        if (entry->type->shutdown)
+        {
+            entry->type->shutdown (entry->type->functor_user_data, output->loaded_data_to_manage);
+        }
+
+        kan_free_general (entry->allocation_group, output->loaded_data_to_manage, entry->type->size);
+    }
+}
+
+static struct build_step_output_t execute_build_raw_start (struct build_state_t *state, struct resource_entry_t *entry)
+{
+    struct build_step_output_t output = {
+        .result = BUILD_STEP_RESULT_FAILED,
+        .status = RESOURCE_STATUS_UNAVAILABLE,
+        .available_version = {.type_version = 0u, .last_modification_time = 0u},
+        .loaded_data_to_manage = NULL,
+    };
+
+    if (!entry->current_file_location)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to process build start for \"%s\" of type \"%s\" as there is no path provided "
+                 "for it due to internal error.",
+                 entry->target->name, entry->name, entry->type->name);
+        return output;
+    }
+
+    struct kan_file_system_entry_status_t status;
+    if (!kan_file_system_query_entry (entry->current_file_location, &status))
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to process build start for \"%s\" of type \"%s\" as it wasn't possible to "
+                 "query file status at \"%s\".",
+                 entry->target->name, entry->name, entry->type->name, entry->current_file_location);
+        return output;
+    }
+
+    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+
+    output.available_version.type_version = reflected_type->resource_type_meta->version;
+    output.available_version.last_modification_time = status.last_modification_time_ns;
+    output.available_version.content_hash = calculate_file_content_hash (entry->current_file_location);
+
+    if (!(output.loaded_data_to_manage = load_resource_entry_data (state, entry)))
+    {
+        return output;
+    }
+
+    // Should not be able to start build twice for one resource.
+    KAN_ASSERT (entry->new_references.size == 0u)
+
+    struct kan_resource_reference_detection_error_context_t error_context = {
+        .resource_target = entry->target->name,
+        .resource_type = entry->type->name,
+        .resource_name = entry->name,
+    };
+
+    if (!kan_resource_reflected_data_storage_detect_references (state->setup->reflected_data, entry->type->name,
+                                                                output.loaded_data_to_manage, &entry->new_references,
+                                                                &error_context))
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Verification failed while detection references from \"%s\" of type \"%s\".",
+                 entry->target->name, entry->name, entry->type->name);
+        return output;
+    }
+
+    entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_NONE;
+    output.result = BUILD_STEP_RESULT_SUCCESSFUL;
+    output.status = RESOURCE_STATUS_AVAILABLE;
+    return output;
+}
+
+static struct build_step_output_t execute_build_primary_process_primary (struct build_state_t *state,
+                                                                         struct resource_entry_t *entry);
+
+static struct build_step_output_t execute_build_execute_build_rule (struct build_state_t *state,
+                                                                    struct resource_entry_t *entry);
+
+static struct build_step_output_t execute_build_primary_start (struct build_state_t *state,
+                                                               struct resource_entry_t *entry)
+{
+    struct build_step_output_t output = {
+        .result = BUILD_STEP_RESULT_FAILED,
+        .status = RESOURCE_STATUS_UNAVAILABLE,
+        .available_version = {.type_version = 0u, .last_modification_time = 0u},
+        .loaded_data_to_manage = NULL,
+    };
+
+    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+    KAN_ASSERT (reflected_type->produced_from_build_rule)
+
+    if (!reflected_type->build_rule_primary_input_type)
+    {
+        return execute_build_execute_build_rule (state, entry);
+    }
+
+    struct resource_response_t response =
+        execute_resource_request (state, (struct resource_request_t) {
+                                             .from_target = entry->target,
+                                             .type = reflected_type->build_rule_primary_input_type,
+                                             .name = entry->name,
+                                             .mode = RESOURCE_REQUEST_MODE_BUILD_REQUIRED,
+                                             .needed_to_build_entry = entry,
+                                         });
+
+    if (!response.success)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to process build start for \"%s\" of type \"%s\" as it wasn't possible to "
+                 "request build rule primary input of type \"%s\".",
+                 entry->target->name, entry->name, entry->type->name, reflected_type->build_rule_primary_input_type);
+        return output;
+    }
+
+    entry->build.internal_primary_input_entry = response.entry;
+    if (kan_atomic_int_get (&entry->build.atomic_next_build_task_block_counter) > 0)
+    {
+        entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_PROCESS_PRIMARY;
+        output.result = BUILD_STEP_RESULT_PAUSED;
+        return output;
+    }
+
+    return execute_build_primary_process_primary (state, entry);
+}
 
-        if (backtrace->previous)
+static struct build_step_output_t execute_build_primary_process_primary (struct build_state_t *state,
+                                                                         struct resource_entry_t *entry)
+{
+    struct build_step_output_t output = {
+        .result = BUILD_STEP_RESULT_FAILED,
+        .status = RESOURCE_STATUS_UNAVAILABLE,
+        .available_version = {.type_version = 0u, .last_modification_time = 0u},
+        .loaded_data_to_manage = NULL,
+    };
+
+    const struct kan_dynamic_array_t *primary_reference_array = NULL;
+    {
+        struct resource_entry_t *primary = entry->build.internal_primary_input_entry;
+        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&primary->header.lock)
+
+        if (primary->header.status != RESOURCE_STATUS_AVAILABLE)
         {
-            ADD_TO_CHAIN (" <= ")
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as build rule primary input of type \"%s\" "
+                     "is not available.",
+                     entry->target->name, entry->name, entry->type->name, primary->type->name);
+            return output;
         }
 
-#undef ADD_TO_CHAIN
-        backtrace = backtrace->previous;
+        primary_reference_array = get_references_from_resource_entry_unsafe (primary);
     }
 
-    chain_buffer[chain_size] = '\0';
-    KAN_LOG_WITH_BUFFER (KAN_RESOURCE_PIPELINE_BUILD_CR_MESSAGE_BUFFER * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                         "Caught circular reference while executing resource request with build operation or status "
-                         "confirmation mode. It usually means that there is a circular dependency between build rules. "
-                         "Printing reference chain (left is the deepest): %s.",
-                         chain_buffer)
+    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+    KAN_ASSERT (reflected_type->produced_from_build_rule)
+
+    kan_dynamic_array_set_capacity (&entry->new_build_secondary_inputs, primary_reference_array->size);
+    bool has_failed_secondary_inputs = false;
+
+    for (kan_loop_size_t reference_index = 0u; reference_index < primary_reference_array->size; ++reference_index)
+    {
+        struct kan_resource_log_reference_t *reference =
+            &((struct kan_resource_log_reference_t *) primary_reference_array->data)[reference_index];
+
+        if (reference->type)
+        {
+            bool used_for_build = false;
+            for (kan_loop_size_t type_index = 0u; type_index < reflected_type->build_rule_secondary_types.size;
+                 ++type_index)
+            {
+                if (reference->type ==
+                    ((kan_interned_string_t *) reflected_type->build_rule_secondary_types.data)[type_index])
+                {
+                    used_for_build = true;
+                    break;
+                }
+            }
+
+            if (!used_for_build)
+            {
+                // Not used for build, skip.
+                continue;
+            }
+
+            struct resource_response_t response =
+                execute_resource_request (state, (struct resource_request_t) {
+                                                     .from_target = entry->target,
+                                                     .type = reference->type,
+                                                     .name = reference->name,
+                                                     .mode = (reference->flags & KAN_RESOURCE_REFERENCE_REQUIRED) ?
+                                                                 RESOURCE_REQUEST_MODE_BUILD_REQUIRED :
+                                                                 RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL,
+                                                     .needed_to_build_entry = entry,
+                                                 });
+
+            if (!response.success)
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                         "[Target \"%s\"] Failed to find secondary input \"%s\" of type \"%s\" to build \"%s\" of type "
+                         "\"%s\".",
+                         entry->target->name, reference->name, reference->type, entry->name, entry->type->name);
+
+                has_failed_secondary_inputs = true;
+                continue;
+            }
+
+            struct new_build_secondary_input_t *new_input =
+                kan_dynamic_array_add_last (&entry->new_build_secondary_inputs);
+            new_input->entry = response.entry;
+            new_input->third_party_entry = NULL;
+            new_input->reference_flags = reference->flags;
+        }
+        else
+        {
+            struct raw_third_party_entry_t *third_party_entry =
+                target_search_visible_third_party (entry->target, reference->name);
+
+            if (!third_party_entry)
+            {
+                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                         "[Target \"%s\"] Failed to find third party input \"%s\" to build \"%s\" of type \"%s\".",
+                         entry->target->name, reference->name, entry->name, entry->type->name);
+
+                has_failed_secondary_inputs = true;
+                continue;
+            }
+
+            struct new_build_secondary_input_t *new_input =
+                kan_dynamic_array_add_last (&entry->new_build_secondary_inputs);
+            new_input->entry = NULL;
+            new_input->third_party_entry = third_party_entry;
+            new_input->reference_flags = reference->flags;
+        }
+    }
+
+    kan_dynamic_array_set_capacity (&entry->new_build_secondary_inputs, entry->new_build_secondary_inputs.size);
+    if (has_failed_secondary_inputs)
+    {
+        KAN_LOG (
+            resource_pipeline_build, KAN_LOG_ERROR,
+            "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as it wasn't possible to request secondary inputs.",
+            entry->target->name, entry->name, entry->type->name);
+        return output;
+    }
+
+    if (kan_atomic_int_get (&entry->build.atomic_next_build_task_block_counter) > 0)
+    {
+        entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_EXECUTE_BUILD_RULE;
+        output.result = BUILD_STEP_RESULT_PAUSED;
+        return output;
+    }
+
+    return execute_build_execute_build_rule (state, entry);
 }
 
-/// \details Needs external write access to build state of blocking entry, therefore marked unsafe.
-static inline void block_entry_build_by_entry_unsafe (struct resource_entry_t *entry_to_build,
-                                                      struct resource_entry_t *blocking_entry)
+struct build_rule_interface_data_t
 {
-    kan_atomic_int_add (&entry_to_build->build.atomic_next_build_task_block_counter, 1);
-    struct resource_entry_build_blocked_t *blocked =
-        kan_allocate_batched (blocking_entry->allocation_group, sizeof (struct resource_entry_build_blocked_t));
-    blocked->blocked_entry = entry_to_build;
+    struct build_state_t *state;
+    struct resource_entry_t *entry;
+
+    /// \brief Count of secondary outputs successfully produced during build rule execution.
+    /// \details Build rule results with secondary outputs are not stored in artifact cache as artifact cache only
+    ///          stores primary output and therefore cannot restore secondary outputs.
+    kan_instance_size_t secondary_outputs_produced;
+};
+
+static bool save_entry_data (struct build_state_t *state, struct resource_entry_t *entry, const void *entry_data)
+{
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_write (entry->current_file_location, true);
+    if (!stream)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to save \"%s\" of type \"%s\" as it wasn't possible to open file at path "
+                 "\"%s\" for write.",
+                 entry->target->name, entry->name, entry->type->name, entry->current_file_location);
+        return false;
+    }
+
+    stream = kan_random_access_stream_buffer_open_for_write (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
+    CUSHION_DEFER { stream->operations->close (stream); }
+
+    if (!kan_serialization_binary_write_type_header (
+            stream, entry->type->name, KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t)))
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to save \"%s\" of type \"%s\" due to failure while writing type header.",
+                 entry->target->name, entry->name, entry->type->name);
+        return false;
+    }
+
+    kan_serialization_binary_writer_t writer =
+        kan_serialization_binary_writer_create (stream, entry_data, entry->type->name, state->binary_script_storage,
+                                                KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
+    CUSHION_DEFER { kan_serialization_binary_writer_destroy (writer); }
+
+    enum kan_serialization_state_t serialization_state;
+    while ((serialization_state = kan_serialization_binary_writer_step (writer)) == KAN_SERIALIZATION_IN_PROGRESS)
+    {
+    }
+
+    if (serialization_state == KAN_SERIALIZATION_FAILED)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to save \"%s\" of type \"%s\" due to serialization error.",
+                 entry->target->name, entry->name, entry->type->name, entry->current_file_location);
+        return false;
+    }
+
+    return true;
+}
+
+static void move_secondary_output_data_to_entry (struct build_state_t *state,
+                                                 const struct kan_resource_reflected_data_resource_type_t *type_data,
+                                                 struct resource_entry_t *entry,
+                                                 void *data)
+{
+    KAN_ASSERT (!entry->build.internal_transient_secondary_output)
+    entry->build.internal_transient_secondary_output =
+        kan_allocate_general (entry->allocation_group, type_data->struct_type->size, type_data->struct_type->alignment);
+
+    if (type_data->struct_type->init)
+    {
+        kan_allocation_group_stack_push (entry->allocation_group);
+        type_data->struct_type->init (type_data->struct_type->functor_user_data,
+                                      entry->build.internal_transient_secondary_output);
+    }
+
+    if (type_data->resource_type_meta->move)
+    {
+        type_data->resource_type_meta->move (entry->build.internal_transient_secondary_output, data);
+    }
+    else
+    {
+        kan_reflection_move_struct (state->setup->reflected_data->registry, type_data->struct_type,
+                                    entry->build.internal_transient_secondary_output, data);
+    }
+}
+
+static inline void reset_secondary_output_data (struct build_state_t *state,
+                                                const struct kan_resource_reflected_data_resource_type_t *type_data,
+                                                void *data)
+{
+    if (type_data->resource_type_meta->reset)
+    {
+        type_data->resource_type_meta->reset (data);
+    }
+    else
+    {
+        kan_reflection_reset_struct (state->setup->reflected_data->registry, type_data->struct_type, data);
+    }
+}
+
+enum subroutine_result_t
+{
+    SUBROUTINE_RESULT_SUCCESSFUL = 0u,
+    SUBROUTINE_RESULT_FAILED,
+    SUBROUTINE_RESULT_SKIPPED,
+};
+
+static void add_to_build_queue_unblocked_unsafe (struct build_state_t *state, struct build_queue_item_t *item);
+
+static enum subroutine_result_t interface_produce_secondary_output_check_reproduction (
+    struct build_state_t *state,
+    struct resource_entry_t *parent_entry,
+    const struct kan_resource_reflected_data_resource_type_t *type_data,
+    kan_interned_string_t name,
+    void *data)
+{
+    KAN_ATOMIC_INT_SCOPED_LOCK_READ (&state->resource_entries_lock)
+    struct resource_entry_t *reproduced =
+        target_search_local_resource_unsafe (parent_entry->target, type_data->struct_type->name, name);
 
-    blocked->next = blocking_entry->build.blocked_other_first;
-    blocking_entry->build.blocked_other_first = blocked;
-}
+    if (!reproduced)
+    {
+        return SUBROUTINE_RESULT_SKIPPED;
+    }
 
-static void *load_resource_entry_data (struct build_state_t *state, struct resource_entry_t *entry);
+    if (reproduced->class != RESOURCE_PRODUCTION_CLASS_SECONDARY || !reproduced->initial_log_secondary_entry ||
+        reproduced->initial_log_secondary_entry->producer_type != parent_entry->type->name ||
+        reproduced->initial_log_secondary_entry->producer_name != parent_entry->name)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to produce secondary \"%s\" of type \"%s\" from \"%s\" of type \"%s\" as "
+                 "resource with produced name and type already exists and does not acknowledge the same producer.",
+                 parent_entry->target->name, reproduced->name, reproduced->type->name, parent_entry->type->name,
+                 parent_entry->name);
+        return SUBROUTINE_RESULT_FAILED;
+    }
 
-static bool process_resource_as_build_dependency (struct build_state_t *state,
-                                                  struct resource_entry_t *entry,
-                                                  bool required,
-                                                  struct resource_entry_t *needed_to_build_entry)
-{
-    KAN_ATOMIC_INT_SCOPED_LOCK_READ (&entry->header.lock)
-    switch (entry->header.status)
+    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&reproduced->header.lock)
+    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&reproduced->build.lock)
+
+    switch (reproduced->header.status)
     {
     case RESOURCE_STATUS_UNCONFIRMED:
     {
-        // If other logic works as expected, it can never happen.
-        KAN_ASSERT (false)
-        return false;
+        KAN_ASSERT (!reproduced->build.internal_transient_secondary_output)
+        move_secondary_output_data_to_entry (state, type_data, reproduced, data);
+
+        reproduced->header.status = RESOURCE_STATUS_BUILDING;
+        reproduced->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START;
+        struct build_queue_item_t *item = build_queue_item_create (state, reproduced);
+
+        KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
+        // Use unblocked order as we'd like to save and unload reproduced secondary as soon as possible.
+        add_to_build_queue_unblocked_unsafe (state, item);
+        return SUBROUTINE_RESULT_SUCCESSFUL;
     }
 
     case RESOURCE_STATUS_UNAVAILABLE:
+    case RESOURCE_STATUS_AVAILABLE:
+    case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
     {
-        // Not available, there is not a valid build dependency.
-        return false;
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to produce secondary \"%s\" of type \"%s\" from \"%s\" of type \"%s\" as "
+                 "target reproduced entry is already in unavailable/available/platform_unsupported state. Most likely "
+                 "an internal error.",
+                 parent_entry->target->name, reproduced->name, reproduced->type->name, parent_entry->type->name,
+                 parent_entry->name);
+        return SUBROUTINE_RESULT_FAILED;
     }
 
     case RESOURCE_STATUS_BUILDING:
     {
-        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->build.lock)
-        ++entry->build.loaded_data_request_count;
-        block_entry_build_by_entry_unsafe (needed_to_build_entry, entry);
-        return true;
-    }
-
-    case RESOURCE_STATUS_AVAILABLE:
-    {
-        // Can trigger loading, therefore a write lock.
-        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->build.lock)
-        ++entry->build.loaded_data_request_count;
-
-        if (!entry->build.loaded_data)
+        if (reproduced->build.internal_transient_secondary_output)
         {
-            if (entry->build.loaded_data_request_count == 1u)
-            {
-                // First request, we need to properly start the build.
-                entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_LOAD;
-
-                KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
-                add_to_build_queue_new_unsafe (state, entry);
-            }
-
-            block_entry_build_by_entry_unsafe (needed_to_build_entry, entry);
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to produce secondary \"%s\" of type \"%s\" from \"%s\" of type \"%s\" as "
+                     "it was already produced from the same producer during current execution.",
+                     parent_entry->target->name, reproduced->name, reproduced->type->name, parent_entry->type->name,
+                     parent_entry->name);
+            return SUBROUTINE_RESULT_FAILED;
         }
 
-        return true;
-    }
-
-    case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
-    {
-        // Platform unsupported are treated as valid dependencies unless required flag is set.
-        return !required;
+        move_secondary_output_data_to_entry (state, type_data, reproduced, data);
+        return SUBROUTINE_RESULT_SUCCESSFUL;
     }
 
     case RESOURCE_STATUS_OUT_OF_SCOPE:
-    {
-        // Should never be a build dependency if target visibility works as expected.
+        // Should never be possible.
         KAN_ASSERT (false)
-        return false;
-    }
+        break;
     }
 
-    return false;
+    KAN_ASSERT (false)
+    return SUBROUTINE_RESULT_FAILED;
 }
 
-static inline const struct kan_dynamic_array_t *get_references_from_resource_entry_unsafe (
-    struct resource_entry_t *entry)
+static bool interface_produce_secondary_output (kan_resource_build_rule_interface_t interface,
+                                                kan_interned_string_t type,
+                                                kan_interned_string_t name,
+                                                void *data)
 {
-    // If assert fails, then caller didn't ensure that build is finished prior to accessing references.
-    KAN_ASSERT (entry->header.status == RESOURCE_STATUS_AVAILABLE ||
-                entry->header.status == RESOURCE_STATUS_PLATFORM_UNSUPPORTED ||
-                entry->header.status == RESOURCE_STATUS_OUT_OF_SCOPE)
+    struct build_rule_interface_data_t *interface_data = KAN_HANDLE_GET (interface);
+    struct build_state_t *state = interface_data->state;
+    struct resource_entry_t *parent_entry = interface_data->entry;
 
-    if (entry->header.status == RESOURCE_STATUS_OUT_OF_SCOPE ||
-        (entry->initial_log_built_entry &&
-         kan_resource_log_version_is_up_to_date (entry->initial_log_built_entry->version,
-                                                 entry->header.available_version)))
-    {
-        switch (entry->class)
-        {
-        case RESOURCE_PRODUCTION_CLASS_RAW:
-            return &entry->initial_log_raw_entry->references;
+    const struct kan_resource_reflected_data_resource_type_t *type_data =
+        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, type);
 
-        case RESOURCE_PRODUCTION_CLASS_PRIMARY:
-            return &entry->initial_log_built_entry->references;
+    KAN_ASSERT_FORMATTED (
+        type_data, "Received secondary production of type \"%s\", but unable to query that resource type reflection.",
+        type)
 
-        case RESOURCE_PRODUCTION_CLASS_SECONDARY:
-            return &entry->initial_log_secondary_entry->references;
-        }
-    }
+    switch (interface_produce_secondary_output_check_reproduction (state, parent_entry, type_data, name, data))
+    {
+    case SUBROUTINE_RESULT_SUCCESSFUL:
+        ++interface_data->secondary_outputs_produced;
+        return name;
 
-    return &entry->new_references;
-}
+    case SUBROUTINE_RESULT_FAILED:
+        reset_secondary_output_data (state, type_data, data);
+        return false;
 
-static bool mark_resource_references_for_deployment (struct build_state_t *state,
-                                                     struct resource_entry_t *entry,
-                                                     const struct resource_request_backtrace_t *backtrace)
-{
-    const struct kan_dynamic_array_t *source_array;
-    kan_atomic_int_lock_read (&entry->header.lock);
-    source_array = get_references_from_resource_entry_unsafe (entry);
-    kan_atomic_int_unlock_read (&entry->header.lock);
+    case SUBROUTINE_RESULT_SKIPPED:
+        break;
+    }
 
-    // We don't need full locking here as `new_references` should not be changed after build and function
-    // caller should ensure that this function is only being called after the build.
+    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&state->resource_entries_lock)
+    struct resource_entry_t *entry =
+        target_search_local_resource_unsafe (parent_entry->target, type_data->struct_type->name, name);
 
-    for (kan_loop_size_t index = 0u; index < source_array->size; ++index)
+    if (entry)
     {
-        const struct kan_resource_log_reference_t *reference =
-            &((struct kan_resource_log_reference_t *) source_array->data)[index];
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to produce secondary \"%s\" of type \"%s\" from \"%s\" of type \"%s\" as it "
+                 "is already produced from some other producer.",
+                 parent_entry->target->name, entry->name, entry->type->name, parent_entry->type->name,
+                 parent_entry->name);
 
-        if (!reference->type)
-        {
-            struct raw_third_party_entry_t *third_party =
-                target_search_visible_third_party (entry->target, reference->name);
+        reset_secondary_output_data (state, type_data, data);
+        return false;
+    }
 
-            if (!third_party)
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "[Target \"%s\"] Failed to mark \"%s\" third party resource for deployment (it needs to be "
-                         "deployed as it is referenced from \"%s\" of type \"%s\" which is deployed).",
-                         entry->target->name, reference->name, entry->name, entry->type->name);
-                return false;
-            }
+    struct resource_type_container_t *container =
+        target_search_resource_type_container_unsafe (parent_entry->target, type_data->name);
 
-            third_party->deployment_mark = true;
-            continue;
-        }
+    if (!container)
+    {
+        container = resource_type_container_create (parent_entry->target, type_data->struct_type);
+    }
 
-        struct resource_request_t reference_request = {
-            .from_target = entry->target,
-            .type = reference->type,
-            .name = reference->name,
-            .mode = (reference->flags & KAN_RESOURCE_REFERENCE_REQUIRED) ?
-                        RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT :
-                        RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT_PLATFORM_OPTIONAL,
-            .needed_to_build_entry = NULL,
-        };
+    entry = resource_entry_create (container, name);
+    entry->class = RESOURCE_PRODUCTION_CLASS_SECONDARY;
 
-        struct resource_response_t reference_response =
-            execute_resource_request_internal (state, reference_request, backtrace);
+    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->header.lock)
+    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->build.lock)
 
-        if (!reference_response.success)
-        {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for deployment (it needs to be deployed as "
-                     "it is referenced from \"%s\" of type \"%s\" which is deployed).",
-                     entry->target->name, reference->name, reference->type, entry->name, entry->type->name);
-            return false;
-        }
-    }
+    entry->header.status = RESOURCE_STATUS_BUILDING;
+    entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START;
+    entry->build.internal_producer_entry = parent_entry;
+    move_secondary_output_data_to_entry (state, type_data, entry, data);
+    struct build_queue_item_t *item = build_queue_item_create (state, entry);
 
+    KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
+    // Use unblocked order as we'd like to save and unload reproduced secondary as soon as possible.
+    add_to_build_queue_unblocked_unsafe (state, item);
+    ++interface_data->secondary_outputs_produced;
     return true;
 }
 
-static bool mark_resource_build_dependencies_for_cache (struct build_state_t *state,
-                                                        struct resource_entry_t *entry,
-                                                        const struct resource_request_backtrace_t *backtrace)
+static void form_rule_cache_path (struct build_state_t *state,
+                                  const struct kan_resource_reflected_data_resource_type_t *type_data,
+                                  kan_file_size_t key,
+                                  const char *suffix,
+                                  struct kan_file_system_path_container_t *output)
 {
-    if (entry->class != RESOURCE_PRODUCTION_CLASS_PRIMARY)
-    {
-        // No dependencies to mark.
-        return true;
-    }
-
-    const struct kan_dynamic_array_t *source_array;
-    bool new_build;
-
-    {
-        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&entry->header.lock)
-        // If assert fails, then caller didn't ensure that build is finished prior to marking dependencies for cache.
-        KAN_ASSERT (entry->header.status == RESOURCE_STATUS_AVAILABLE ||
-                    entry->header.status == RESOURCE_STATUS_PLATFORM_UNSUPPORTED ||
-                    entry->header.status == RESOURCE_STATUS_OUT_OF_SCOPE)
-
-        if (entry->initial_log_built_entry &&
-            kan_resource_log_version_is_up_to_date (entry->initial_log_built_entry->version,
-                                                    entry->header.available_version))
-        {
-            source_array = &entry->initial_log_built_entry->secondary_inputs;
-            new_build = false;
-        }
-        else
-        {
-            source_array = &entry->new_build_secondary_inputs;
-            new_build = true;
-        }
-    }
+    kan_file_system_path_container_copy_string (output, state->setup->project->workspace_directory);
+    kan_file_system_path_container_append (output, KAN_RESOURCE_PROJECT_WORKSPACE_RULE_CACHE_DIRECTORY);
+    kan_file_system_path_container_append (output, type_data->struct_type->name);
+
+    // Type version is a part of the name, so data is never loaded with incompatible type version.
+    char name_suffix[48u];
+    snprintf (name_suffix, sizeof (name_suffix), "_%016llx_%016llx",
+              (unsigned long long) type_data->resource_type_meta->version, (unsigned long long) key);
+    kan_file_system_path_container_add_suffix (output, name_suffix);
+    kan_file_system_path_container_add_suffix (output, suffix);
+}
 
-    // We don't need full locking here as `new_build_secondary_inputs` should not be changed after build and function
-    // caller should ensure that this function is only being called after the build.
+static bool interface_load_cached (kan_resource_build_rule_interface_t interface,
+                                   kan_interned_string_t type,
+                                   kan_file_size_t key,
+                                   void *output)
+{
+    struct build_rule_interface_data_t *interface_data = KAN_HANDLE_GET (interface);
+    struct build_state_t *state = interface_data->state;
+    struct resource_entry_t *entry = interface_data->entry;
 
-    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
-        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+    const struct kan_resource_reflected_data_resource_type_t *type_data =
+        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, type);
 
-    if (reflected_type->build_rule_primary_input_type)
-    {
-        struct resource_request_t primary_input_request = {
-            .from_target = entry->target,
-            .type = reflected_type->build_rule_primary_input_type,
-            .name = entry->name,
-            .mode = RESOURCE_REQUEST_MODE_MARK_CACHE,
-            .needed_to_build_entry = NULL,
-        };
+    KAN_ASSERT_FORMATTED (
+        type_data, "Received rule cache load of type \"%s\", but unable to query that resource type reflection.", type)
 
-        struct resource_response_t primary_input_response =
-            execute_resource_request_internal (state, primary_input_request, backtrace);
+    struct kan_file_system_path_container_t path;
+    form_rule_cache_path (state, type_data, key, ".bin", &path);
 
-        if (!primary_input_response.success)
-        {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for cache (it needs to be cached as build "
-                     "dependency of \"%s\" of type \"%s\").",
-                     entry->target->name, entry->name, reflected_type->build_rule_primary_input_type, entry->name,
-                     entry->type->name);
-            return false;
-        }
+    if (!kan_file_system_check_existence (path.path))
+    {
+        return false;
     }
 
-    for (kan_loop_size_t index = 0u; index < source_array->size; ++index)
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_read (path.path, true);
+    if (!stream)
     {
-        struct resource_request_t secondary_input_request = {
-            .from_target = entry->target,
-            .type = NULL,
-            .name = NULL,
-            .mode = RESOURCE_REQUEST_MODE_MARK_CACHE,
-            .needed_to_build_entry = NULL,
-        };
-
-        if (new_build)
-        {
-            struct new_build_secondary_input_t *secondary =
-                &((struct new_build_secondary_input_t *) source_array->data)[index];
+        return false;
+    }
 
-            if (!secondary->entry)
-            {
-                // Third party resources cannot be cached and cannot be marked for cache.
-                continue;
-            }
+    stream = kan_random_access_stream_buffer_open_for_read (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
+    CUSHION_DEFER { stream->operations->close (stream); }
 
-            secondary_input_request.type = secondary->entry->type->name;
-            secondary_input_request.name = secondary->entry->name;
-        }
-        else
-        {
-            const struct kan_resource_log_secondary_input_t *secondary =
-                &((struct kan_resource_log_secondary_input_t *) source_array->data)[index];
+    kan_interned_string_t read_type_name;
+    enum kan_serialization_state_t serialization_state = KAN_SERIALIZATION_FAILED;
 
-            if (!secondary->type)
-            {
-                // Third party resources cannot be cached and cannot be marked for cache.
-                continue;
-            }
+    if (kan_serialization_binary_read_type_header (
+            stream, &read_type_name, KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t)) &&
+        read_type_name == type)
+    {
+        kan_serialization_binary_reader_t reader = kan_serialization_binary_reader_create (
+            stream, output, type, state->binary_script_storage,
+            KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t), entry->allocation_group);
 
-            secondary_input_request.type = secondary->type;
-            secondary_input_request.name = secondary->name;
+        while ((serialization_state = kan_serialization_binary_reader_step (reader)) == KAN_SERIALIZATION_IN_PROGRESS)
+        {
         }
 
-        struct resource_response_t secondary_input_response =
-            execute_resource_request_internal (state, secondary_input_request, backtrace);
+        kan_serialization_binary_reader_destroy (reader);
+    }
 
-        if (!secondary_input_response.success)
-        {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for cache (it needs to be cached as build "
-                     "dependency of \"%s\" of type \"%s\").",
-                     entry->target->name, secondary_input_request.name, secondary_input_request.type, entry->name,
-                     entry->type->name);
-            return false;
-        }
+    if (serialization_state == KAN_SERIALIZATION_FAILED)
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_WARNING,
+                             "[Target \"%s\"] Failed to load rule cache data of type \"%s\" for \"%s\" from \"%s\", "
+                             "removing it from rule cache.",
+                             entry->target->name, type, entry->name, path.path);
+        kan_file_system_remove_file (path.path);
+        return false;
     }
 
+    // Touch data so it is treated as recently used during rule cache trimming.
+    kan_file_system_touch_file (path.path);
+
+    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+             "[Target \"%s\"] Loaded rule cache data of type \"%s\" while building \"%s\" of type \"%s\".",
+             entry->target->name, type, entry->name, entry->type->name);
     return true;
 }
 
-static bool mark_resource_for_deployment (struct build_state_t *state,
-                                          struct resource_entry_t *entry,
-                                          bool required,
-                                          const struct resource_request_backtrace_t *backtrace)
+static void interface_store_cached (kan_resource_build_rule_interface_t interface,
+                                    kan_interned_string_t type,
+                                    kan_file_size_t key,
+                                    const void *data)
 {
-    {
-        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->header.lock)
-        if (entry->header.deployment_mark)
-        {
-            // Already marked, no need to mark referenced resources for deployment and dependencies for the cache.
-            return true;
-        }
+    struct build_rule_interface_data_t *interface_data = KAN_HANDLE_GET (interface);
+    struct build_state_t *state = interface_data->state;
+    struct resource_entry_t *entry = interface_data->entry;
 
-        entry->header.deployment_mark = true;
-        switch (entry->header.status)
-        {
-        case RESOURCE_STATUS_UNCONFIRMED:
-        case RESOURCE_STATUS_UNAVAILABLE:
-        case RESOURCE_STATUS_BUILDING:
-            // Neither references nor dependency list are ready, so there is nothing more to mark right now.
-            // It also means that these marks will be applied in the end of build operation as deployment mark will be
-            // visible as already applied to the build operation when it ends.
-            return true;
+    const struct kan_resource_reflected_data_resource_type_t *type_data =
+        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, type);
 
-        case RESOURCE_STATUS_AVAILABLE:
-        case RESOURCE_STATUS_OUT_OF_SCOPE:
-            // Cannot return right now, we also need to mark references and dependencies properly.
-            break;
+    KAN_ASSERT_FORMATTED (
+        type_data, "Received rule cache store of type \"%s\", but unable to query that resource type reflection.",
+        type)
 
-        case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
-            if (!required)
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for deployment as it is unsupported on "
-                         "this platform, but reference field meta does not allow platform unsupported resources.",
-                         entry->target->name, entry->name, entry->type->name);
-                return false;
-            }
+    struct kan_file_system_path_container_t path;
+    form_rule_cache_path (state, type_data, key, ".bin", &path);
 
-            break;
-        }
+    if (kan_file_system_check_existence (path.path))
+    {
+        // Already stored by other build rule execution.
+        return;
     }
 
-    return mark_resource_references_for_deployment (state, entry, backtrace) &&
-           mark_resource_build_dependencies_for_cache (state, entry, backtrace);
-}
+    // Write to unique temporary file first in order to make data appear atomically for other build rule executions.
+    char unique_suffix[48u];
+    snprintf (unique_suffix, sizeof (unique_suffix), ".%016llx.tmp", (unsigned long long) (kan_memory_size_t) entry);
 
-static bool mark_resource_for_cache (struct build_state_t *state,
-                                     struct resource_entry_t *entry,
-                                     const struct resource_request_backtrace_t *backtrace)
-{
+    struct kan_file_system_path_container_t temporary_path;
+    form_rule_cache_path (state, type_data, key, unique_suffix, &temporary_path);
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_write (temporary_path.path, true);
+
+    if (!stream)
     {
-        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->header.lock)
-        switch (entry->header.status)
-        {
-        case RESOURCE_STATUS_UNCONFIRMED:
-        case RESOURCE_STATUS_UNAVAILABLE:
-        case RESOURCE_STATUS_BUILDING:
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for cache as it is neither available "
-                     "nor platform unsupported.",
-                     entry->target->name, entry->name, entry->type->name);
-            return false;
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_WARNING,
+                             "[Target \"%s\"] Failed to open \"%s\" for write in order to store rule cache data.",
+                             entry->target->name, temporary_path.path);
+        return;
+    }
 
-        case RESOURCE_STATUS_AVAILABLE:
-        case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
-        case RESOURCE_STATUS_OUT_OF_SCOPE:
-            // It is okay to have that status while marking for the cache.
-            break;
-        }
+    stream = kan_random_access_stream_buffer_open_for_write (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
+    bool successful = kan_serialization_binary_write_type_header (
+        stream, type, KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
 
-        if (entry->header.cache_mark)
+    if (successful)
+    {
+        kan_serialization_binary_writer_t writer = kan_serialization_binary_writer_create (
+            stream, data, type, state->binary_script_storage,
+            KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
+
+        enum kan_serialization_state_t serialization_state;
+        while ((serialization_state = kan_serialization_binary_writer_step (writer)) ==
+               KAN_SERIALIZATION_IN_PROGRESS)
         {
-            // Already marked, no need to mark dependencies for the cache.
-            return true;
         }
 
-        entry->header.cache_mark = true;
+        kan_serialization_binary_writer_destroy (writer);
+        successful = serialization_state == KAN_SERIALIZATION_FINISHED;
     }
 
-    return mark_resource_build_dependencies_for_cache (state, entry, backtrace);
+    stream->operations->close (stream);
+    if (!successful)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_WARNING,
+                 "[Target \"%s\"] Failed to store rule cache data of type \"%s\" while building \"%s\" of type "
+                 "\"%s\".",
+                 entry->target->name, type, entry->name, entry->type->name);
+        kan_file_system_remove_file (temporary_path.path);
+        return;
+    }
+
+    // Other build rule execution might've stored the same data in the meantime, then we just drop ours.
+    if (kan_file_system_check_existence (path.path) || !kan_file_system_move_file (temporary_path.path, path.path))
+    {
+        kan_file_system_remove_file (temporary_path.path);
+    }
 }
 
-static struct resource_response_t execute_resource_request_internal (
-    struct build_state_t *state,
-    struct resource_request_t request,
-    const struct resource_request_backtrace_t *backtrace)
+static void remove_entry_loaded_data_usage (struct resource_entry_t *entry)
 {
-    KAN_ASSERT_FORMATTED (request.type,
-                          "Caught attempt to use execute_resource_request to get third party resource, which is not "
-                          "supported, it is an internal error.", )
-
-    struct resource_response_t response = {
-        .success = false,
-        .entry = NULL,
-    };
+    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->build.lock)
+    --entry->build.loaded_data_request_count;
 
-    struct resource_request_backtrace_t trace = {
-        .previous = backtrace,
-        .type = request.type,
-        .name = request.name,
-    };
+    if (entry->build.loaded_data_request_count == 0u)
+    {
+        resource_entry_unload_data_unsafe (entry);
+    }
+}
 
-    switch (request.mode)
+static void cleanup_build_rule_context (struct kan_resource_build_rule_context_t *build_context,
+                                        struct resource_entry_t *entry,
+                                        struct resource_entry_t *primary)
+{
+    if (primary)
     {
-    case RESOURCE_REQUEST_MODE_BUILD_REQUIRED:
-    case RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL:
-    case RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION:
+        remove_entry_loaded_data_usage (primary);
+    }
+
+    for (kan_loop_size_t index = 0u; index < entry->new_build_secondary_inputs.size; ++index)
     {
-        // Check for circular request dependency, so we don't end up in a deadlock.
-        const struct resource_request_backtrace_t *circular_check = backtrace;
+        struct new_build_secondary_input_t *input =
+            &((struct new_build_secondary_input_t *) entry->new_build_secondary_inputs.data)[index];
 
-        while (circular_check)
+        if (input->entry)
         {
-            if (circular_check->type == request.type && circular_check->name == request.name)
-            {
-                print_circular_reference_backtrace (&trace);
-                return response;
-            }
-
-            circular_check = circular_check->previous;
+            remove_entry_loaded_data_usage (input->entry);
         }
+    }
 
-        break;
+    struct kan_resource_build_rule_secondary_node_t *node_to_cleanup = build_context->secondary_input_first;
+    while (node_to_cleanup)
+    {
+        struct kan_resource_build_rule_secondary_node_t *next = node_to_cleanup->next;
+        kan_free_batched (temporary_allocation_group, node_to_cleanup);
+        node_to_cleanup = next;
     }
 
-    case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT:
-    case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT_PLATFORM_OPTIONAL:
-    case RESOURCE_REQUEST_MODE_MARK_CACHE:
-        // Not a circular-dependent mode, so we reset our part of backtrace
-        // to avoid false positive circular reference failures.
-        trace.previous = NULL;
-        break;
+    build_context->secondary_input_first = NULL;
+}
+
+static void replace_entry_current_file_location (struct resource_entry_t *entry,
+                                                 const struct kan_file_system_path_container_t *path)
+{
+    if (entry->current_file_location)
+    {
+        kan_free_general (entry->allocation_group, entry->current_file_location,
+                          strlen (entry->current_file_location) + 1u);
     }
 
-    // First pass: try to find among the ones that already exist in shared read-only mode.
-    kan_atomic_int_lock_read (&state->resource_entries_lock);
-    response.entry = target_search_visible_resource_unsafe (request.from_target, request.type, request.name);
-    kan_atomic_int_unlock_read (&state->resource_entries_lock);
+    entry->current_file_location = kan_allocate_general (entry->allocation_group, path->length + 1u, alignof (char));
+    memcpy (entry->current_file_location, path->path, path->length);
+    entry->current_file_location[path->length] = '\0';
+}
 
-    if (!response.entry)
+/// \brief Appends content hash of build rule input to artifact cache key checksum.
+/// \details Returns false if content hash is unknown and therefore artifact cache cannot be used.
+static inline bool artifact_cache_key_append_hash (kan_checksum_state_t checksum, kan_file_size_t hash)
+{
+    if (hash == KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN)
     {
-        // Resource is nowhere to be found. Decide what could be done next depending on the mode.
-        switch (request.mode)
-        {
-        case RESOURCE_REQUEST_MODE_BUILD_REQUIRED:
-        case RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL:
-        case RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION:
-        case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT:
-        case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT_PLATFORM_OPTIONAL:
-        {
-            // Resource can be produced by build rule. Let's check if it exists.
-            const struct kan_resource_reflected_data_resource_type_t *reflected_type =
-                kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, request.type);
-
-            if (!reflected_type->produced_from_build_rule)
-            {
-                // Not produced by build rule, return default unavailable response.
-                return response;
-            }
-
-            // Built resource should always be created in the same target as its primary input.
-            struct target_t *primary_target = NULL;
+        return false;
+    }
 
-            if (reflected_type->build_rule_primary_input_type)
-            {
-                struct resource_response_t primary_input_response =
-                    execute_resource_request_internal (state,
-                                                       (struct resource_request_t) {
-                                                           .from_target = request.from_target,
-                                                           .type = reflected_type->build_rule_primary_input_type,
-                                                           .name = request.name,
-                                                           .mode = RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION,
-                                                           .needed_to_build_entry = NULL,
-                                                       },
-                                                       &trace);
+    kan_checksum_append (checksum, sizeof (hash), &hash);
+    return true;
+}
 
-                if (!primary_input_response.success)
-                {
-                    // No primary input to build entry, return default unavailable response.
-                    return response;
-                }
+static inline void artifact_cache_key_append_string (kan_checksum_state_t checksum, const char *string)
+{
+    // Include terminator so sequences of strings cannot produce the same data.
+    kan_checksum_append (checksum, strlen (string) + 1u, (void *) string);
+}
 
-                primary_target = primary_input_response.entry->target;
-            }
-            else
-            {
-                struct raw_third_party_entry_t *entry =
-                    target_search_visible_third_party (request.from_target, request.name);
+/// \brief Appends resource type version of build rule input, so format changes of inputs invalidate cached artifacts.
+static inline void artifact_cache_key_append_type_version (kan_checksum_state_t checksum,
+                                                           struct build_state_t *state,
+                                                           kan_interned_string_t type_name)
+{
+    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, type_name);
+    kan_resource_version_t version = 0u;
 
-                if (!entry)
-                {
-                    // No primary input to build entry, return default unavailable response.
-                    return response;
-                }
+    if (reflected_type && reflected_type->resource_type_meta)
+    {
+        version = reflected_type->resource_type_meta->version;
+    }
 
-                primary_target = entry->target;
-            }
+    kan_checksum_append (checksum, sizeof (version), &version);
+}
 
-            // Resource can be built using a rule, so let's create an entry and try to build it.
-            // Lock for write as we're creating new entry.
-            KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&state->resource_entries_lock)
+/// \brief Calculates key for build rule execution results in artifact cache.
+/// \details Key only depends on data that defines build rule result: resource type and name, build rule and type
+///          versions, content hashes of primary and secondary inputs and content hash of platform configuration.
+///          Returns KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN if any of the content hashes is unknown, which means that
+///          artifact cache cannot be used for this execution.
+static kan_file_size_t calculate_artifact_cache_key (
+    struct resource_entry_t *entry,
+    const struct kan_resource_reflected_data_resource_type_t *reflected_type,
+    struct resource_entry_t *primary,
+    struct raw_third_party_entry_t *primary_third_party,
+    const struct platform_configuration_entry_t *platform_configuration)
+{
+    kan_checksum_state_t checksum = kan_checksum_create ();
+    bool key_valid = true;
 
-            // While we were waiting for write access, somebody else might've already got write access and
-            // create this node too. Let's check it.
-            response.entry = target_search_local_resource_unsafe (primary_target, request.type, request.name);
+    artifact_cache_key_append_string (checksum, entry->type->name);
+    artifact_cache_key_append_string (checksum, entry->name);
+    kan_checksum_append (checksum, sizeof (reflected_type->resource_type_meta->version),
+                         (void *) &reflected_type->resource_type_meta->version);
+    kan_checksum_append (checksum, sizeof (reflected_type->build_rule_version),
+                         (void *) &reflected_type->build_rule_version);
 
-            if (!response.entry)
-            {
-                struct resource_type_container_t *container =
-                    target_search_resource_type_container_unsafe (primary_target, request.type);
+    if (primary)
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&primary->header.lock)
+        artifact_cache_key_append_string (checksum, primary->type->name);
+        artifact_cache_key_append_type_version (checksum, entry->target->state, primary->type->name);
+        key_valid &= artifact_cache_key_append_hash (checksum, primary->header.available_version.content_hash);
+    }
+    else
+    {
+        KAN_ASSERT (primary_third_party)
+        key_valid &=
+            artifact_cache_key_append_hash (checksum, calculate_file_content_hash (primary_third_party->file_location));
+    }
 
-                if (!container)
-                {
-                    container = resource_type_container_create (primary_target, reflected_type->struct_type);
-                }
+    if (platform_configuration)
+    {
+        key_valid &= artifact_cache_key_append_hash (checksum, platform_configuration->content_hash);
+    }
 
-                response.entry = resource_entry_create (container, request.name);
-                response.entry->class = RESOURCE_PRODUCTION_CLASS_PRIMARY;
+    for (kan_loop_size_t index = 0u; key_valid && index < entry->new_build_secondary_inputs.size; ++index)
+    {
+        struct new_build_secondary_input_t *input =
+            &((struct new_build_secondary_input_t *) entry->new_build_secondary_inputs.data)[index];
 
-                KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&response.entry->header.lock)
-                KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&response.entry->build.lock)
+        if (input->entry)
+        {
+            KAN_ATOMIC_INT_SCOPED_LOCK_READ (&input->entry->header.lock)
+            artifact_cache_key_append_string (checksum, input->entry->type->name);
+            artifact_cache_key_append_string (checksum, input->entry->name);
+            artifact_cache_key_append_type_version (checksum, entry->target->state, input->entry->type->name);
 
-                response.entry->header.status = RESOURCE_STATUS_BUILDING;
-                response.entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START;
+            const enum resource_status_t status = input->entry->header.status;
+            kan_checksum_append (checksum, sizeof (status), (void *) &status);
 
-                KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
-                add_to_build_queue_new_unsafe (state, response.entry);
-            }
-            else if (response.entry->target != primary_target)
+            if (status == RESOURCE_STATUS_AVAILABLE)
             {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "[Target \"%s\"] Failed to create \"%s\" of type \"%s\" from build rule as resource with that "
-                         "name already exists in target \"%s\" visible from primary input target \"%s\".",
-                         request.from_target->name, request.name, request.type, response.entry->target->name,
-                         primary_target->name);
-                return response;
+                key_valid &=
+                    artifact_cache_key_append_hash (checksum, input->entry->header.available_version.content_hash);
             }
-
-            break;
         }
-
-        case RESOURCE_REQUEST_MODE_MARK_CACHE:
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Failed to mark \"%s\" of type \"%s\" for cache as it does not exist.",
-                     request.from_target->name, request.name, request.type);
-            return response;
+        else
+        {
+            artifact_cache_key_append_string (checksum, input->third_party_entry->name);
+            key_valid &= artifact_cache_key_append_hash (
+                checksum, calculate_file_content_hash (input->third_party_entry->file_location));
         }
     }
 
-    KAN_ASSERT (response.entry)
-    confirm_resource_status (state, response.entry, &trace);
+    const kan_file_size_t key = kan_checksum_finalize (checksum);
+    if (!key_valid)
+    {
+        return KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
+    }
 
-    switch (request.mode)
+    return key == KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN ? 1u : key;
+}
+
+static inline void append_artifact_cache_file_name (struct kan_file_system_path_container_t *container,
+                                                    kan_file_size_t key,
+                                                    const char *suffix)
+{
+    char name[32u];
+    snprintf (name, sizeof (name), "%016llx", (unsigned long long) key);
+    kan_file_system_path_container_append (container, name);
+    kan_file_system_path_container_add_suffix (container, suffix);
+}
+
+/// \brief Copies file from one path to another and calculates its content hash along the way.
+/// \details Returns KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN on failure.
+static kan_file_size_t copy_file_with_content_hash (const char *from, const char *to)
+{
+    struct kan_stream_t *input = kan_direct_file_stream_open_for_read (from, true);
+    if (!input)
     {
-    case RESOURCE_REQUEST_MODE_BUILD_REQUIRED:
-        response.success =
-            process_resource_as_build_dependency (state, response.entry, true, request.needed_to_build_entry);
-        break;
+        return KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
+    }
 
-    case RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL:
-        response.success =
-            process_resource_as_build_dependency (state, response.entry, false, request.needed_to_build_entry);
-        break;
+    CUSHION_DEFER { input->operations->close (input); }
+    struct kan_stream_t *output = kan_direct_file_stream_open_for_write (to, true);
 
-    case RESOURCE_REQUEST_MODE_STATUS_CONFIRMATION:
-        // No additional tasks, confirmation is executed, so we can just mark response as successful and that's all.
-        response.success = true;
-        break;
+    if (!output)
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "Unable to open \"%s\" for write in order to copy \"%s\" into it.", to, from);
+        return KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
+    }
 
-    case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT:
-        response.success = mark_resource_for_deployment (state, response.entry, true, &trace);
-        break;
+    CUSHION_DEFER { output->operations->close (output); }
+    uint8_t buffer[KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER];
+    kan_checksum_state_t checksum = kan_checksum_create ();
+    kan_file_size_t read;
+    bool successful = true;
 
-    case RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT_PLATFORM_OPTIONAL:
-        response.success = mark_resource_for_deployment (state, response.entry, false, &trace);
-        break;
+    while ((read = input->operations->read (input, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER, buffer)) > 0u)
+    {
+        kan_checksum_append (checksum, read, buffer);
+        if (output->operations->write (output, read, buffer) != read)
+        {
+            KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                                 "Failed to write data while copying \"%s\" to \"%s\".", from, to);
+            successful = false;
+            break;
+        }
+    }
 
-    case RESOURCE_REQUEST_MODE_MARK_CACHE:
-        response.success = mark_resource_for_cache (state, response.entry, &trace);
-        break;
+    const kan_file_size_t hash = kan_checksum_finalize (checksum);
+    if (!successful)
+    {
+        return KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
     }
 
-    return response;
+    // Must be consistent with calculate_file_content_hash.
+    return hash == KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN ? 1u : hash;
 }
 
-// Build task feature section which implements core routine of building resources.
-
-static const char *get_resource_entry_next_build_task_name (enum resource_entry_next_build_task_t task)
+/// \brief Attempts to load build rule result for given key from artifact cache.
+/// \details On success, artifact is copied to the given saved path, entry file location is updated, loaded data is
+///          returned and content hash of loaded file is written to the output. Returns NULL on cache miss or failure.
+static void *artifact_cache_load (struct build_state_t *state,
+                                  struct resource_entry_t *entry,
+                                  kan_file_size_t key,
+                                  const struct kan_file_system_path_container_t *saved_path,
+                                  kan_file_size_t *output_content_hash)
 {
-    switch (task)
-    {
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_NONE:
-        return "<none>";
+    struct kan_file_system_path_container_t artifact_path;
+    kan_file_system_path_container_copy_string (&artifact_path, state->setup->artifact_cache_directory);
+    append_artifact_cache_file_name (&artifact_path, key, ".bin");
 
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START:
-        return "build: start";
+    if (!kan_file_system_check_existence (artifact_path.path))
+    {
+        return NULL;
+    }
 
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_PROCESS_PRIMARY:
-        return "build: process primary input";
+    const kan_file_size_t content_hash = copy_file_with_content_hash (artifact_path.path, saved_path->path);
+    if (content_hash == KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN)
+    {
+        // Might've been evicted by other build right after existence check, it is okay to just build it then.
+        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                 "[Target \"%s\"] Failed to copy artifact for \"%s\" of type \"%s\" from artifact cache.",
+                 entry->target->name, entry->name, entry->type->name);
+        return NULL;
+    }
 
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_EXECUTE_BUILD_RULE:
-        return "build: execute build rule";
+    replace_entry_current_file_location (entry, saved_path);
+    void *loaded_data = load_resource_entry_data (state, entry);
 
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_LOAD:
-        return "load";
+    if (!loaded_data)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to load artifact for \"%s\" of type \"%s\" from artifact cache, removing it "
+                 "from artifact cache.",
+                 entry->target->name, entry->name, entry->type->name);
+        kan_file_system_remove_file (artifact_path.path);
+        return NULL;
     }
 
-    return "<unknown>";
+    // Touch artifact so it is treated as recently used during eviction.
+    kan_file_system_touch_file (artifact_path.path);
+    *output_content_hash = content_hash;
+
+    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+             "[Target \"%s\"] Loaded \"%s\" of type \"%s\" from artifact cache instead of executing build rule.",
+             entry->target->name, entry->name, entry->type->name);
+    return loaded_data;
 }
 
-/// \brief Tasks that can be executed after main build operation for helper causes (like loading built entry that is
-///        already unloaded) are called repeated tasks.
-static bool is_resource_entry_next_build_task_repeated (enum resource_entry_next_build_task_t task)
+/// \brief Stores saved build rule result of given entry in artifact cache under given key.
+static void artifact_cache_store (struct build_state_t *state, struct resource_entry_t *entry, kan_file_size_t key)
 {
-    switch (task)
+    struct kan_file_system_path_container_t artifact_path;
+    kan_file_system_path_container_copy_string (&artifact_path, state->setup->artifact_cache_directory);
+    append_artifact_cache_file_name (&artifact_path, key, ".bin");
+
+    if (kan_file_system_check_existence (artifact_path.path))
     {
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_NONE:
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START:
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_PROCESS_PRIMARY:
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_EXECUTE_BUILD_RULE:
-        return false;
+        // Already stored by other build.
+        return;
+    }
 
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_LOAD:
-        return true;
+    // Write to unique temporary file first in order to make artifact appear atomically for other builds.
+    struct kan_file_system_path_container_t temporary_path;
+    kan_file_system_path_container_copy_string (&temporary_path, state->setup->artifact_cache_directory);
+    append_artifact_cache_file_name (&temporary_path, key, "");
+
+    char unique_suffix[48u];
+    snprintf (unique_suffix, sizeof (unique_suffix), ".%016llx_%016llx.tmp",
+              (unsigned long long) kan_precise_time_get_epoch_nanoseconds_utc (),
+              (unsigned long long) (kan_memory_size_t) entry);
+    kan_file_system_path_container_add_suffix (&temporary_path, unique_suffix);
+
+    if (copy_file_with_content_hash (entry->current_file_location, temporary_path.path) ==
+        KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to store \"%s\" of type \"%s\" in artifact cache.", entry->target->name,
+                 entry->name, entry->type->name);
+        kan_file_system_remove_file (temporary_path.path);
+        return;
     }
 
-    return false;
+    // Other build might've stored the same artifact in the meantime, then we just drop ours.
+    if (kan_file_system_check_existence (artifact_path.path) ||
+        !kan_file_system_move_file (temporary_path.path, artifact_path.path))
+    {
+        kan_file_system_remove_file (temporary_path.path);
+    }
 }
 
-enum build_step_result_t
-{
-    BUILD_STEP_RESULT_SUCCESSFUL = 0u,
-    BUILD_STEP_RESULT_FAILED,
-    BUILD_STEP_RESULT_PAUSED,
-};
+/// \details In case of import build rules, can be executed right away from start task call.
+static struct build_step_output_t execute_build_execute_build_rule (struct build_state_t *state,
+                                                                    struct resource_entry_t *entry)
+{
+    struct build_step_output_t output = {
+        .result = BUILD_STEP_RESULT_FAILED,
+        .status = RESOURCE_STATUS_UNAVAILABLE,
+        .available_version = {.type_version = 0u, .last_modification_time = 0u},
+        .loaded_data_to_manage = NULL,
+    };
+
+    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+    KAN_ASSERT (reflected_type->produced_from_build_rule)
+
+    struct build_rule_interface_data_t interface_data = {
+        .state = state,
+        .entry = entry,
+        .secondary_outputs_produced = 0u,
+    };
+
+    struct kan_resource_build_rule_context_t build_context = {
+        .primary_name = entry->name,
+        .primary_input = NULL,
+        .secondary_input_first = NULL,
+        .primary_output = NULL,
+        .platform_configuration = NULL,
+        .temporary_workspace = NULL,
+        .interface = KAN_HANDLE_SET (kan_resource_build_rule_interface_t, &interface_data),
+        .produce_secondary_output = interface_produce_secondary_output,
+        .load_cached = interface_load_cached,
+        .store_cached = interface_store_cached,
+    };
+
+    struct kan_resource_build_rule_secondary_node_t *context_secondary_input_last = NULL;
+    struct resource_entry_t *primary = NULL;
+    struct raw_third_party_entry_t *primary_third_party = NULL;
+    bool build_context_cleaned_up = false;
 
-static void *load_resource_entry_data (struct build_state_t *state, struct resource_entry_t *entry)
-{
-    if (!entry->current_file_location)
+    CUSHION_DEFER
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" as there is no path provided for it due to "
-                 "internal error.",
-                 entry->target->name, entry->name, entry->type->name);
-        return NULL;
+        if (!build_context_cleaned_up)
+        {
+            cleanup_build_rule_context (&build_context, entry, primary);
+        }
     }
 
-    struct kan_stream_t *stream = kan_direct_file_stream_open_for_read (entry->current_file_location, true);
-    if (!stream)
+    if (reflected_type->build_rule_primary_input_type)
     {
-        KAN_LOG (
-            resource_pipeline_build, KAN_LOG_ERROR,
-            "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" as it wasn't possible to open file at path \"%s\".",
-            entry->target->name, entry->name, entry->type->name, entry->current_file_location);
-        return NULL;
-    }
+        primary = entry->build.internal_primary_input_entry;
+        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&primary->header.lock)
+        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&primary->build.lock)
 
-    stream = kan_random_access_stream_buffer_open_for_read (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
-    CUSHION_DEFER { stream->operations->close (stream); }
+        // Shouldn't be able to enter that function if it is not the case.
+        KAN_ASSERT (primary->header.status == RESOURCE_STATUS_AVAILABLE)
 
-    void *loaded_data = kan_allocate_general (entry->allocation_group, entry->type->size, entry->type->alignment);
-    if (entry->type->init)
-    {
-        kan_allocation_group_stack_push (entry->allocation_group);
-        entry->type->init (entry->type->functor_user_data, loaded_data);
-        kan_allocation_group_stack_pop ();
+        build_context.primary_input = primary->build.loaded_data;
+        KAN_ASSERT (build_context.primary_input)
     }
-
-    kan_instance_size_t location_length = (kan_instance_size_t) strlen (entry->current_file_location);
-    enum kan_serialization_state_t serialization_state = KAN_SERIALIZATION_FAILED;
-
-    if (location_length >= 4u && entry->current_file_location[location_length - 4u] == '.' &&
-        entry->current_file_location[location_length - 3u] == 'b' &&
-        entry->current_file_location[location_length - 2u] == 'i' &&
-        entry->current_file_location[location_length - 1u] == 'n')
+    else
     {
-        kan_interned_string_t read_type_name;
-        if (!kan_serialization_binary_read_type_header (
-                stream, &read_type_name, KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t)))
-        {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" due to error while reading type header.",
-                     entry->target->name, entry->name, entry->type->name);
-            serialization_state = KAN_SERIALIZATION_FAILED;
-            goto serialization_done;
-        }
-
-        if (read_type_name != entry->type->name)
+        primary_third_party = target_search_visible_third_party (entry->target, entry->name);
+        if (!primary_third_party)
         {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" as its type header specifies unexpected "
-                     "type \"%s\".",
-                     entry->target->name, entry->name, entry->type->name, read_type_name);
-            serialization_state = KAN_SERIALIZATION_FAILED;
-            goto serialization_done;
+            KAN_LOG (
+                resource_pipeline_build, KAN_LOG_ERROR,
+                "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as its primary third party input is not found.",
+                entry->target->name, entry->name, entry->type->name);
+            return output;
         }
 
-        kan_serialization_binary_reader_t reader = kan_serialization_binary_reader_create (
-            stream, loaded_data, entry->type->name, state->binary_script_storage,
-            KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t), entry->allocation_group);
+        entry->build.internal_primary_input_third_party = primary_third_party;
+        build_context.primary_third_party_path = primary_third_party->file_location;
+    }
 
-        while ((serialization_state = kan_serialization_binary_reader_step (reader)) == KAN_SERIALIZATION_IN_PROGRESS)
-        {
-        }
+    struct platform_configuration_entry_t *configuration_entry = NULL;
+    if (reflected_type->build_rule_platform_configuration_type)
+    {
+        configuration_entry =
+            build_state_find_platform_configuration (state, reflected_type->build_rule_platform_configuration_type);
 
-        if (serialization_state == KAN_SERIALIZATION_FAILED)
+        if (!configuration_entry)
         {
             KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" due to binary serialization error.",
-                     entry->target->name, entry->name, entry->type->name);
+                     "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as platform configuration entry \"%s\" is "
+                     "not found.",
+                     entry->target->name, entry->name, entry->type->name,
+                     reflected_type->build_rule_platform_configuration_type);
+            return output;
         }
 
-        kan_serialization_binary_reader_destroy (reader);
+        build_context.platform_configuration = configuration_entry->data;
     }
-    else if (location_length >= 3u && entry->current_file_location[location_length - 3u] == '.' &&
-             entry->current_file_location[location_length - 2u] == 'r' &&
-             entry->current_file_location[location_length - 1u] == 'd')
+
+    bool secondary_inputs_ready = true;
+    for (kan_loop_size_t index = 0u; index < entry->new_build_secondary_inputs.size; ++index)
     {
-        kan_serialization_rd_reader_t reader = kan_serialization_rd_reader_create (
-            stream, loaded_data, entry->type->name, state->setup->reflected_data->registry, entry->allocation_group);
+        struct new_build_secondary_input_t *input =
+            &((struct new_build_secondary_input_t *) entry->new_build_secondary_inputs.data)[index];
 
-        while ((serialization_state = kan_serialization_rd_reader_step (reader)) == KAN_SERIALIZATION_IN_PROGRESS)
+        if (input->entry)
         {
-        }
+            KAN_ATOMIC_INT_SCOPED_LOCK_READ (&input->entry->header.lock)
+            KAN_ATOMIC_INT_SCOPED_LOCK_READ (&input->entry->build.lock)
 
-        if (serialization_state == KAN_SERIALIZATION_FAILED)
-        {
-            KAN_LOG (
-                resource_pipeline_build, KAN_LOG_ERROR,
-                "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" as due to readable data serialization error.",
-                entry->target->name, entry->name, entry->type->name, entry->current_file_location);
+            switch (input->entry->header.status)
+            {
+            case RESOURCE_STATUS_UNCONFIRMED:
+            case RESOURCE_STATUS_BUILDING:
+                // Must never happen if requests work properly.
+                KAN_ASSERT (false)
+                break;
+
+            case RESOURCE_STATUS_UNAVAILABLE:
+                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                         "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as build rule secondary input \"%s\" "
+                         "of type \"%s\" is not available.",
+                         entry->target->name, entry->name, entry->type->name, input->entry->name,
+                         input->entry->type->name);
+                secondary_inputs_ready = false;
+                break;
+
+            case RESOURCE_STATUS_AVAILABLE:
+            {
+                struct kan_resource_build_rule_secondary_node_t *node = kan_allocate_batched (
+                    temporary_allocation_group, sizeof (struct kan_resource_build_rule_secondary_node_t));
+
+                node->next = NULL;
+                node->type = input->entry->type->name;
+                node->name = input->entry->name;
+                node->data = input->entry->build.loaded_data;
+                KAN_ASSERT (node->data)
+
+                if (context_secondary_input_last)
+                {
+                    context_secondary_input_last->next = node;
+                }
+                else
+                {
+                    build_context.secondary_input_first = node;
+                }
+
+                context_secondary_input_last = node;
+                break;
+            }
+
+            case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
+                if (input->reference_flags & KAN_RESOURCE_REFERENCE_REQUIRED)
+                {
+                    KAN_LOG (
+                        resource_pipeline_build, KAN_LOG_ERROR,
+                        "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as build rule secondary input \"%s\" "
+                        "of type \"%s\" is unsupported on this platform, but reference is configured as required.",
+                        entry->target->name, entry->name, entry->type->name, input->entry->name,
+                        input->entry->type->name);
+                    secondary_inputs_ready = false;
+                }
+
+                break;
+
+            case RESOURCE_STATUS_OUT_OF_SCOPE:
+                KAN_ASSERT_FORMATTED (false,
+                                      "Internal error, secondary input entry has out of scope status, which shouldn't "
+                                      "be possible due to target visibility rules.", )
+                break;
+            }
         }
+        else
+        {
+            struct kan_resource_build_rule_secondary_node_t *node = kan_allocate_batched (
+                temporary_allocation_group, sizeof (struct kan_resource_build_rule_secondary_node_t));
 
-        kan_serialization_rd_reader_destroy (reader);
+            node->next = NULL;
+            node->type = NULL;
+            node->name = input->third_party_entry->name;
+            node->third_party_path = input->third_party_entry->file_location;
+
+            if (context_secondary_input_last)
+            {
+                context_secondary_input_last->next = node;
+            }
+            else
+            {
+                build_context.secondary_input_first = node;
+            }
+
+            context_secondary_input_last = node;
+        }
     }
-    else
+
+    if (!secondary_inputs_ready)
     {
         KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to load \"%s\" of type \"%s\" as it wasn't possible to guess the serialized "
-                 "format from path \"%s\".",
-                 entry->target->name, entry->name, entry->type->name, entry->current_file_location);
+                 "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as inputs are not available.",
+                 entry->target->name, entry->name, entry->type->name);
+        return output;
     }
 
-serialization_done:
-    if (serialization_state != KAN_SERIALIZATION_FINISHED)
-    {
-        if (entry->type->shutdown)
-        {
-            entry->type->shutdown (entry->type->functor_user_data, loaded_data);
-        }
+    struct kan_file_system_path_container_t temporary_workspace;
+    kan_file_system_path_container_copy_string (&temporary_workspace, state->setup->project->workspace_directory);
+    kan_file_system_path_container_append (&temporary_workspace, KAN_RESOURCE_PROJECT_WORKSPACE_TEMPORARY_DIRECTORY);
 
-        kan_free_general (entry->allocation_group, loaded_data, entry->type->size);
-        loaded_data = NULL;
+    kan_file_system_path_container_append (&temporary_workspace, entry->target->name);
+    kan_file_system_make_directory (temporary_workspace.path);
+
+    kan_file_system_path_container_append (&temporary_workspace, entry->type->name);
+    kan_file_system_make_directory (temporary_workspace.path);
+
+    kan_file_system_path_container_append (&temporary_workspace, entry->name);
+    if (!kan_file_system_make_directory (temporary_workspace.path))
+    {
+        KAN_LOG (
+            resource_pipeline_build, KAN_LOG_ERROR,
+            "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" due to failure during temporary workspace creation.",
+            entry->target->name, entry->name, entry->type->name);
+        return output;
     }
 
-    return loaded_data;
-}
+    build_context.temporary_workspace = temporary_workspace.path;
+    kan_file_size_t artifact_cache_key = KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
+    kan_file_size_t artifact_content_hash = KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN;
+    void *loaded_data = NULL;
 
-struct build_step_output_t
-{
-    enum build_step_result_t result;
-    enum resource_status_t status;
-    struct kan_resource_log_version_t available_version;
-    void *loaded_data_to_manage;
-};
+    if (state->setup->artifact_cache_directory)
+    {
+        artifact_cache_key =
+            calculate_artifact_cache_key (entry, reflected_type, primary, primary_third_party, configuration_entry);
+
+        if (artifact_cache_key != KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN)
+        {
+            struct kan_file_system_path_container_t saved_path = temporary_workspace;
+            kan_file_system_path_container_append (&saved_path, "__saved__");
+            kan_file_system_path_container_add_suffix (&saved_path, ".bin");
+            loaded_data = artifact_cache_load (state, entry, artifact_cache_key, &saved_path, &artifact_content_hash);
+        }
+    }
 
-static void build_step_output_unload_data (struct build_step_output_t *output, struct resource_entry_t *entry)
-{
-    if (output->loaded_data_to_manage)
+    const bool loaded_from_artifact_cache = loaded_data != NULL;
+    if (!loaded_from_artifact_cache)
     {
-        if (entry->type->shutdown)
+        loaded_data = kan_allocate_general (entry->allocation_group, entry->type->size, entry->type->alignment);
+        build_context.primary_output = loaded_data;
+
+        if (entry->type->init)
         {
-            entry->type->shutdown (entry->type->functor_user_data, output->loaded_data_to_manage);
+            kan_allocation_group_stack_push (entry->allocation_group);
+            entry->type->init (entry->type->functor_user_data, loaded_data);
+            kan_allocation_group_stack_pop ();
         }
 
-        kan_free_general (entry->allocation_group, output->loaded_data_to_manage, entry->type->size);
-    }
-}
+        const kan_time_size_t rule_wall_start = kan_precise_time_get_elapsed_nanoseconds ();
+        const kan_time_size_t rule_cpu_start = kan_precise_time_get_thread_cpu_nanoseconds ();
+        const enum kan_resource_build_rule_result_t result = reflected_type->build_rule_functor (&build_context);
 
-static struct build_step_output_t execute_build_raw_start (struct build_state_t *state, struct resource_entry_t *entry)
-{
-    struct build_step_output_t output = {
-        .result = BUILD_STEP_RESULT_FAILED,
-        .status = RESOURCE_STATUS_UNAVAILABLE,
-        .available_version = {.type_version = 0u, .last_modification_time = 0u},
-        .loaded_data_to_manage = NULL,
-    };
+        entry->build_rule_wall_ns = kan_precise_time_get_elapsed_nanoseconds () - rule_wall_start;
+        entry->build_rule_cpu_ns = kan_precise_time_get_thread_cpu_nanoseconds () - rule_cpu_start;
+        entry->build_rule_executed = true;
+        switch (result)
+        {
+        case KAN_RESOURCE_BUILD_RULE_SUCCESS:
+            // Processed below.
+            break;
 
-    if (!entry->current_file_location)
-    {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to process build start for \"%s\" of type \"%s\" as there is no path provided "
-                 "for it due to internal error.",
-                 entry->target->name, entry->name, entry->type->name);
-        return output;
-    }
+        case KAN_RESOURCE_BUILD_RULE_FAILURE:
+        case KAN_RESOURCE_BUILD_RULE_UNSUPPORTED:
+            if (entry->type->shutdown)
+            {
+                entry->type->shutdown (entry->type->functor_user_data, loaded_data);
+            }
 
-    struct kan_file_system_entry_status_t status;
-    if (!kan_file_system_query_entry (entry->current_file_location, &status))
-    {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to process build start for \"%s\" of type \"%s\" as it wasn't possible to "
-                 "query file status at \"%s\".",
-                 entry->target->name, entry->name, entry->type->name, entry->current_file_location);
-        return output;
-    }
+            kan_free_general (entry->allocation_group, loaded_data, entry->type->size);
+            loaded_data = NULL;
+            break;
+        }
 
-    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
-        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+        switch (result)
+        {
+        case KAN_RESOURCE_BUILD_RULE_SUCCESS:
+            // Processed below.
+            break;
 
-    output.available_version.type_version = reflected_type->resource_type_meta->version;
-    output.available_version.last_modification_time = status.last_modification_time_ns;
+        case KAN_RESOURCE_BUILD_RULE_FAILURE:
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" due to build rule failure.",
+                     entry->target->name, entry->name, entry->type->name);
+            return output;
+        }
 
-    if (!(output.loaded_data_to_manage = load_resource_entry_data (state, entry)))
-    {
-        return output;
+        case KAN_RESOURCE_BUILD_RULE_UNSUPPORTED:
+        {
+            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                     "[Target \"%s\"] Resource \"%s\" of type \"%s\" is marked as platform unsupported by build rule.",
+                     entry->target->name, entry->name, entry->type->name);
+
+            output.result = BUILD_STEP_RESULT_SUCCESSFUL;
+            output.status = RESOURCE_STATUS_PLATFORM_UNSUPPORTED;
+            output.available_version.type_version = reflected_type->resource_type_meta->version;
+
+            // As result is unsupported, we do not have a file for the timestamp, so we just use current time.
+            output.available_version.last_modification_time = kan_precise_time_get_epoch_nanoseconds_utc ();
+
+            // Unsupported, so now loaded data.
+            output.loaded_data_to_manage = NULL;
+            return output;
+        }
+        }
     }
 
+    // Inputs are no longer needed, therefore we release them right away instead of keeping them loaded while
+    // references are detected and result is saved. It makes their memory available to other build tasks sooner.
+    cleanup_build_rule_context (&build_context, entry, primary);
+    build_context_cleaned_up = true;
+
     // Should not be able to start build twice for one resource.
     KAN_ASSERT (entry->new_references.size == 0u)
 
@@ -3377,8 +5577,7 @@ static struct build_step_output_t execute_build_raw_start (struct build_state_t
     };
 
     if (!kan_resource_reflected_data_storage_detect_references (state->setup->reflected_data, entry->type->name,
-                                                                output.loaded_data_to_manage, &entry->new_references,
-                                                                &error_context))
+                                                                loaded_data, &entry->new_references, &error_context))
     {
         KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
                  "[Target \"%s\"] Verification failed while detection references from \"%s\" of type \"%s\".",
@@ -3386,1556 +5585,1731 @@ static struct build_step_output_t execute_build_raw_start (struct build_state_t
         return output;
     }
 
-    entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_NONE;
-    output.result = BUILD_STEP_RESULT_SUCCESSFUL;
-    output.status = RESOURCE_STATUS_AVAILABLE;
-    return output;
-}
-
-static struct build_step_output_t execute_build_primary_process_primary (struct build_state_t *state,
-                                                                         struct resource_entry_t *entry);
-
-static struct build_step_output_t execute_build_execute_build_rule (struct build_state_t *state,
-                                                                    struct resource_entry_t *entry);
-
-static struct build_step_output_t execute_build_primary_start (struct build_state_t *state,
-                                                               struct resource_entry_t *entry)
-{
-    struct build_step_output_t output = {
-        .result = BUILD_STEP_RESULT_FAILED,
-        .status = RESOURCE_STATUS_UNAVAILABLE,
-        .available_version = {.type_version = 0u, .last_modification_time = 0u},
-        .loaded_data_to_manage = NULL,
-    };
-
-    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
-        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
-    KAN_ASSERT (reflected_type->produced_from_build_rule)
-
-    if (!reflected_type->build_rule_primary_input_type)
+    if (!loaded_from_artifact_cache)
     {
-        return execute_build_execute_build_rule (state, entry);
+        // We no longer use temporary workspace path container, so may as well use it for saving.
+        // Also, we should not use entry name for file name as it might be long and cause path overflow on Windows.
+        kan_file_system_path_container_append (&temporary_workspace, "__saved__");
+        kan_file_system_path_container_add_suffix (&temporary_workspace, ".bin");
+        replace_entry_current_file_location (entry, &temporary_workspace);
     }
 
-    struct resource_response_t response =
-        execute_resource_request (state, (struct resource_request_t) {
-                                             .from_target = entry->target,
-                                             .type = reflected_type->build_rule_primary_input_type,
-                                             .name = entry->name,
-                                             .mode = RESOURCE_REQUEST_MODE_BUILD_REQUIRED,
-                                             .needed_to_build_entry = entry,
-                                         });
+    CUSHION_DEFER
+    {
+        if (output.result != BUILD_STEP_RESULT_SUCCESSFUL)
+        {
+            if (entry->type->shutdown)
+            {
+                entry->type->shutdown (entry->type->functor_user_data, loaded_data);
+            }
 
-    if (!response.success)
+            kan_free_general (entry->allocation_group, loaded_data, entry->type->size);
+            loaded_data = NULL;
+        }
+    }
+
+    if (!loaded_from_artifact_cache && !save_entry_data (state, entry, loaded_data))
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to process build start for \"%s\" of type \"%s\" as it wasn't possible to "
-                 "request build rule primary input of type \"%s\".",
-                 entry->target->name, entry->name, entry->type->name, reflected_type->build_rule_primary_input_type);
         return output;
     }
 
-    entry->build.internal_primary_input_entry = response.entry;
-    if (kan_atomic_int_get (&entry->build.atomic_next_build_task_block_counter) > 0)
+    struct kan_file_system_entry_status_t status;
+    if (!kan_file_system_query_entry (entry->current_file_location, &status))
     {
-        entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_PROCESS_PRIMARY;
-        output.result = BUILD_STEP_RESULT_PAUSED;
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to properly save \"%s\" of type \"%s\" as it wasn't possible to query file "
+                 "status at \"%s\" after the save operation.",
+                 entry->target->name, entry->name, entry->type->name, entry->current_file_location);
         return output;
     }
 
-    return execute_build_primary_process_primary (state, entry);
-}
-
-static struct build_step_output_t execute_build_primary_process_primary (struct build_state_t *state,
-                                                                         struct resource_entry_t *entry)
-{
-    struct build_step_output_t output = {
-        .result = BUILD_STEP_RESULT_FAILED,
-        .status = RESOURCE_STATUS_UNAVAILABLE,
-        .available_version = {.type_version = 0u, .last_modification_time = 0u},
-        .loaded_data_to_manage = NULL,
-    };
+    output.result = BUILD_STEP_RESULT_SUCCESSFUL;
+    output.status = RESOURCE_STATUS_AVAILABLE;
+    output.available_version.type_version = reflected_type->resource_type_meta->version;
+    output.available_version.last_modification_time = status.last_modification_time_ns;
+    output.loaded_data_to_manage = loaded_data;
 
-    const struct kan_dynamic_array_t *primary_reference_array = NULL;
+    if (loaded_from_artifact_cache)
     {
-        struct resource_entry_t *primary = entry->build.internal_primary_input_entry;
-        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&primary->header.lock)
-
-        if (primary->header.status != RESOURCE_STATUS_AVAILABLE)
-        {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as build rule primary input of type \"%s\" "
-                     "is not available.",
-                     entry->target->name, entry->name, entry->type->name, primary->type->name);
-            return output;
-        }
-
-        primary_reference_array = get_references_from_resource_entry_unsafe (primary);
+        // Already calculated while copying from artifact cache.
+        output.available_version.content_hash = artifact_content_hash;
     }
-
-    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
-        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
-    KAN_ASSERT (reflected_type->produced_from_build_rule)
-
-    kan_dynamic_array_set_capacity (&entry->new_build_secondary_inputs, primary_reference_array->size);
-    bool has_failed_secondary_inputs = false;
-
-    for (kan_loop_size_t reference_index = 0u; reference_index < primary_reference_array->size; ++reference_index)
+    else
     {
-        struct kan_resource_log_reference_t *reference =
-            &((struct kan_resource_log_reference_t *) primary_reference_array->data)[reference_index];
+        // Content hash makes it possible to avoid rebuilding dependant resources if rebuild produced the same result.
+        output.available_version.content_hash = calculate_file_content_hash (entry->current_file_location);
 
-        if (reference->type)
+        if (artifact_cache_key != KAN_RESOURCE_LOG_CONTENT_HASH_UNKNOWN &&
+            interface_data.secondary_outputs_produced == 0u)
         {
-            bool used_for_build = false;
-            for (kan_loop_size_t type_index = 0u; type_index < reflected_type->build_rule_secondary_types.size;
-                 ++type_index)
-            {
-                if (reference->type ==
-                    ((kan_interned_string_t *) reflected_type->build_rule_secondary_types.data)[type_index])
-                {
-                    used_for_build = true;
-                    break;
-                }
-            }
-
-            if (!used_for_build)
-            {
-                // Not used for build, skip.
-                continue;
-            }
-
-            struct resource_response_t response =
-                execute_resource_request (state, (struct resource_request_t) {
-                                                     .from_target = entry->target,
-                                                     .type = reference->type,
-                                                     .name = reference->name,
-                                                     .mode = (reference->flags & KAN_RESOURCE_REFERENCE_REQUIRED) ?
-                                                                 RESOURCE_REQUEST_MODE_BUILD_REQUIRED :
-                                                                 RESOURCE_REQUEST_MODE_BUILD_PLATFORM_OPTIONAL,
-                                                     .needed_to_build_entry = entry,
-                                                 });
-
-            if (!response.success)
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "[Target \"%s\"] Failed to find secondary input \"%s\" of type \"%s\" to build \"%s\" of type "
-                         "\"%s\".",
-                         entry->target->name, reference->name, reference->type, entry->name, entry->type->name);
-
-                has_failed_secondary_inputs = true;
-                continue;
-            }
-
-            struct new_build_secondary_input_t *new_input =
-                kan_dynamic_array_add_last (&entry->new_build_secondary_inputs);
-            new_input->entry = response.entry;
-            new_input->third_party_entry = NULL;
-            new_input->reference_flags = reference->flags;
+            artifact_cache_store (state, entry, artifact_cache_key);
         }
-        else
-        {
-            struct raw_third_party_entry_t *third_party_entry =
-                target_search_visible_third_party (entry->target, reference->name);
+    }
 
-            if (!third_party_entry)
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "[Target \"%s\"] Failed to find third party input \"%s\" to build \"%s\" of type \"%s\".",
-                         entry->target->name, reference->name, entry->name, entry->type->name);
+    return output;
+}
 
-                has_failed_secondary_inputs = true;
-                continue;
-            }
+static struct build_step_output_t execute_build_secondary_process_primary (struct build_state_t *state,
+                                                                           struct resource_entry_t *entry);
 
-            struct new_build_secondary_input_t *new_input =
-                kan_dynamic_array_add_last (&entry->new_build_secondary_inputs);
-            new_input->entry = NULL;
-            new_input->third_party_entry = third_party_entry;
-            new_input->reference_flags = reference->flags;
-        }
+static struct build_step_output_t execute_build_secondary_start (struct build_state_t *state,
+                                                                 struct resource_entry_t *entry)
+{
+    struct build_step_output_t output = {
+        .result = BUILD_STEP_RESULT_FAILED,
+        .status = RESOURCE_STATUS_UNAVAILABLE,
+        .available_version = {.type_version = 0u, .last_modification_time = 0u},
+        .loaded_data_to_manage = NULL,
+    };
+
+    struct resource_request_t request;
+    if (entry->build.internal_producer_entry)
+    {
+        // Produced during this build, create request in order to wait for primary build.
+        request = (struct resource_request_t) {
+            .from_target = entry->target,
+            .type = entry->build.internal_producer_entry->type->name,
+            .name = entry->build.internal_producer_entry->name,
+            .mode = RESOURCE_REQUEST_MODE_BUILD_REQUIRED,
+            .needed_to_build_entry = entry,
+        };
+    }
+    else
+    {
+        // Must've been produced earlier, check if producer is up-to-date.
+        KAN_ASSERT (entry->initial_log_secondary_entry)
+        request = (struct resource_request_t) {
+            .from_target = entry->target,
+            .type = entry->initial_log_secondary_entry->producer_type,
+            .name = entry->initial_log_secondary_entry->producer_name,
+            .mode = RESOURCE_REQUEST_MODE_BUILD_REQUIRED,
+            .needed_to_build_entry = entry,
+        };
     }
 
-    kan_dynamic_array_set_capacity (&entry->new_build_secondary_inputs, entry->new_build_secondary_inputs.size);
-    if (has_failed_secondary_inputs)
+    struct resource_response_t response = execute_resource_request (state, request);
+    if (!response.success)
     {
-        KAN_LOG (
-            resource_pipeline_build, KAN_LOG_ERROR,
-            "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as it wasn't possible to request secondary inputs.",
-            entry->target->name, entry->name, entry->type->name);
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to process build start for \"%s\" of type \"%s\" as it wasn't possible to "
+                 "request producer resource \"%s\" of type \"%s\".",
+                 entry->target->name, entry->name, entry->type->name, entry->initial_log_secondary_entry->producer_type,
+                 entry->initial_log_secondary_entry->producer_name);
         return output;
     }
 
+    entry->build.internal_producer_entry = response.entry;
     if (kan_atomic_int_get (&entry->build.atomic_next_build_task_block_counter) > 0)
     {
-        entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_EXECUTE_BUILD_RULE;
+        entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_PROCESS_PRIMARY;
         output.result = BUILD_STEP_RESULT_PAUSED;
         return output;
     }
 
-    return execute_build_execute_build_rule (state, entry);
+    return execute_build_secondary_process_primary (state, entry);
 }
 
-struct build_rule_interface_data_t
+static void cleanup_secondary_process_context (struct build_state_t *state, struct resource_entry_t *entry)
 {
-    struct build_state_t *state;
-    struct resource_entry_t *entry;
-};
+    if (entry->build.internal_producer_entry)
+    {
+        remove_entry_loaded_data_usage (entry->build.internal_producer_entry);
+    }
 
-static bool save_entry_data (struct build_state_t *state, struct resource_entry_t *entry, const void *entry_data)
+    // It is only not NULL on cleanup if processing has failed.
+    resource_entry_unload_secondary_transient_data (entry);
+}
+
+static struct build_step_output_t execute_build_secondary_process_primary (struct build_state_t *state,
+                                                                           struct resource_entry_t *entry)
 {
-    struct kan_stream_t *stream = kan_direct_file_stream_open_for_write (entry->current_file_location, true);
-    if (!stream)
+    struct build_step_output_t output = {
+        .result = BUILD_STEP_RESULT_FAILED,
+        .status = RESOURCE_STATUS_UNAVAILABLE,
+        .available_version = {.type_version = 0u, .last_modification_time = 0u},
+        .loaded_data_to_manage = NULL,
+    };
+
+    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
+    CUSHION_DEFER { cleanup_secondary_process_context (state, entry); }
+
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to save \"%s\" of type \"%s\" as it wasn't possible to open file at path "
-                 "\"%s\" for write.",
-                 entry->target->name, entry->name, entry->type->name, entry->current_file_location);
-        return false;
+        struct resource_entry_t *producer = entry->build.internal_producer_entry;
+        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&producer->header.lock)
+
+        switch (producer->header.status)
+        {
+        case RESOURCE_STATUS_UNCONFIRMED:
+        case RESOURCE_STATUS_BUILDING:
+        case RESOURCE_STATUS_OUT_OF_SCOPE:
+            KAN_ASSERT (false)
+            break;
+
+        case RESOURCE_STATUS_UNAVAILABLE:
+        case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
+        {
+            // Technically not a failure, it is just that this secondary resource is no longer produced.
+            // If it is still needed somewhere it will be a failure there, but it is a different story.
+            output.result = BUILD_STEP_RESULT_SUCCESSFUL;
+            output.status = RESOURCE_STATUS_UNAVAILABLE;
+
+            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                     "[Target \"%s\"] Marking secondary \"%s\" of type \"%s\" as unavailable, because its producer "
+                     "\"%s\" of type \"%s\" is %s.",
+                     entry->target->name, entry->name, entry->type->name, producer->name, producer->type->name,
+                     producer->header.status == RESOURCE_STATUS_UNAVAILABLE ? "no longer available" :
+                                                                              "not supported on this platform");
+
+            return output;
+        }
+
+        case RESOURCE_STATUS_AVAILABLE:
+            // Further processing is made below as we don't need locks for that.
+            break;
+        }
     }
 
-    stream = kan_random_access_stream_buffer_open_for_write (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
-    CUSHION_DEFER { stream->operations->close (stream); }
+    if (!entry->build.internal_transient_secondary_output)
+    {
+        output.result = BUILD_STEP_RESULT_SUCCESSFUL;
+        output.status = RESOURCE_STATUS_UNAVAILABLE;
 
-    if (!kan_serialization_binary_write_type_header (
-            stream, entry->type->name, KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t)))
+        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                 "[Target \"%s\"] Marking secondary \"%s\" of type \"%s\" as unavailable, because its producer "
+                 "\"%s\" of type \"%s\" didn't reproduce it during its build time.");
+        return output;
+    }
+
+    // Should not be able to start build twice for one resource.
+    KAN_ASSERT (entry->new_references.size == 0u)
+
+    struct kan_resource_reference_detection_error_context_t error_context = {
+        .resource_target = entry->target->name,
+        .resource_type = entry->type->name,
+        .resource_name = entry->name,
+    };
+
+    if (!kan_resource_reflected_data_storage_detect_references (state->setup->reflected_data, entry->type->name,
+                                                                entry->build.internal_transient_secondary_output,
+                                                                &entry->new_references, &error_context))
     {
         KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to save \"%s\" of type \"%s\" due to failure while writing type header.",
+                 "[Target \"%s\"] Verification failed while detection references from \"%s\" of type \"%s\".",
                  entry->target->name, entry->name, entry->type->name);
-        return false;
+        return output;
     }
 
-    kan_serialization_binary_writer_t writer =
-        kan_serialization_binary_writer_create (stream, entry_data, entry->type->name, state->binary_script_storage,
-                                                KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
-    CUSHION_DEFER { kan_serialization_binary_writer_destroy (writer); }
+    struct kan_file_system_path_container_t temporary_save_path;
+    kan_file_system_path_container_copy_string (&temporary_save_path, state->setup->project->workspace_directory);
+    kan_file_system_path_container_append (&temporary_save_path, KAN_RESOURCE_PROJECT_WORKSPACE_TEMPORARY_DIRECTORY);
 
-    enum kan_serialization_state_t serialization_state;
-    while ((serialization_state = kan_serialization_binary_writer_step (writer)) == KAN_SERIALIZATION_IN_PROGRESS)
-    {
-    }
+    kan_file_system_path_container_append (&temporary_save_path, entry->target->name);
+    kan_file_system_make_directory (temporary_save_path.path);
 
-    if (serialization_state == KAN_SERIALIZATION_FAILED)
+    kan_file_system_path_container_append (&temporary_save_path, entry->type->name);
+    kan_file_system_make_directory (temporary_save_path.path);
+
+    kan_file_system_path_container_append (&temporary_save_path, entry->name);
+    kan_file_system_path_container_add_suffix (&temporary_save_path, ".bin");
+    replace_entry_current_file_location (entry, &temporary_save_path);
+
+    const bool saved = save_entry_data (state, entry, entry->build.internal_transient_secondary_output);
+    struct kan_file_system_entry_status_t status;
+    const bool proper_version = kan_file_system_query_entry (entry->current_file_location, &status);
+
+    if (!saved || !proper_version)
     {
         KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to save \"%s\" of type \"%s\" due to serialization error.",
+                 "[Target \"%s\"] Failed to properly save \"%s\" of type \"%s\" as it wasn't possible to query "
+                 "file status at \"%s\" after the save operation.",
                  entry->target->name, entry->name, entry->type->name, entry->current_file_location);
-        return false;
+        return output;
     }
 
-    return true;
+    output.result = BUILD_STEP_RESULT_SUCCESSFUL;
+    output.status = RESOURCE_STATUS_AVAILABLE;
+    output.available_version.type_version = reflected_type->resource_type_meta->version;
+    output.available_version.last_modification_time = status.last_modification_time_ns;
+    // Content hash makes it possible to avoid rebuilding dependant resources if rebuild produced the same result.
+    output.available_version.content_hash = calculate_file_content_hash (entry->current_file_location);
+    output.loaded_data_to_manage = entry->build.internal_transient_secondary_output;
+    entry->build.internal_transient_secondary_output = NULL;
+    return output;
 }
 
-static void move_secondary_output_data_to_entry (struct build_state_t *state,
-                                                 const struct kan_resource_reflected_data_resource_type_t *type_data,
-                                                 struct resource_entry_t *entry,
-                                                 void *data)
+static struct build_step_output_t execute_build_step (struct build_state_t *state, struct resource_entry_t *entry)
 {
-    KAN_ASSERT (!entry->build.internal_transient_secondary_output)
-    entry->build.internal_transient_secondary_output =
-        kan_allocate_general (entry->allocation_group, type_data->struct_type->size, type_data->struct_type->alignment);
+    struct build_step_output_t output = {
+        .result = BUILD_STEP_RESULT_FAILED,
+        .status = RESOURCE_STATUS_UNAVAILABLE,
+        .available_version = {.type_version = 0u, .last_modification_time = 0u},
+        .loaded_data_to_manage = NULL,
+    };
 
-    if (type_data->struct_type->init)
+    switch (entry->build.internal_next_build_task)
     {
-        kan_allocation_group_stack_push (entry->allocation_group);
-        type_data->struct_type->init (type_data->struct_type->functor_user_data,
-                                      entry->build.internal_transient_secondary_output);
-    }
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_NONE:
+        break;
+
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START:
+        switch (entry->class)
+        {
+        case RESOURCE_PRODUCTION_CLASS_RAW:
+            output = execute_build_raw_start (state, entry);
+            break;
+
+        case RESOURCE_PRODUCTION_CLASS_PRIMARY:
+            output = execute_build_primary_start (state, entry);
+            break;
+
+        case RESOURCE_PRODUCTION_CLASS_SECONDARY:
+            output = execute_build_secondary_start (state, entry);
+            break;
+        }
+
+        break;
+
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_PROCESS_PRIMARY:
+
+        switch (entry->class)
+        {
+        case RESOURCE_PRODUCTION_CLASS_RAW:
+            KAN_ASSERT_FORMATTED (false,
+                                  "[Target \"%s\"] Got process primary input task for resource \"%s\" of type \"%s\" "
+                                  "which is raw and therefore cannot get this task. It is an internal error.",
+                                  entry->target->name, entry->name, entry->type->name)
+            break;
+
+        case RESOURCE_PRODUCTION_CLASS_PRIMARY:
+            output = execute_build_primary_process_primary (state, entry);
+            break;
+
+        case RESOURCE_PRODUCTION_CLASS_SECONDARY:
+            output = execute_build_secondary_process_primary (state, entry);
+            break;
+        }
+
+        break;
+
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_EXECUTE_BUILD_RULE:
+        output = execute_build_execute_build_rule (state, entry);
+        break;
+
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_LOAD:
+        if ((output.loaded_data_to_manage = load_resource_entry_data (state, entry)))
+        {
+            output.result = BUILD_STEP_RESULT_SUCCESSFUL;
+            KAN_ATOMIC_INT_SCOPED_LOCK_READ (&entry->header.lock)
+            output.status = entry->header.status;
+            output.available_version = entry->header.available_version;
+        }
+        else
+        {
+            output.result = BUILD_STEP_RESULT_FAILED;
+        }
 
-    if (type_data->resource_type_meta->move)
-    {
-        type_data->resource_type_meta->move (entry->build.internal_transient_secondary_output, data);
-    }
-    else
-    {
-        kan_reflection_move_struct (state->setup->reflected_data->registry, type_data->struct_type,
-                                    entry->build.internal_transient_secondary_output, data);
+        break;
     }
+
+    return output;
 }
 
-static inline void reset_secondary_output_data (struct build_state_t *state,
-                                                const struct kan_resource_reflected_data_resource_type_t *type_data,
-                                                void *data)
+static inline kan_file_size_t query_file_size_or_zero (const char *path)
 {
-    if (type_data->resource_type_meta->reset)
-    {
-        type_data->resource_type_meta->reset (data);
-    }
-    else
+    struct kan_file_system_entry_status_t status;
+    if (path && kan_file_system_query_entry (path, &status) && status.type == KAN_FILE_SYSTEM_ENTRY_TYPE_FILE)
     {
-        kan_reflection_reset_struct (state->setup->reflected_data->registry, type_data->struct_type, data);
+        return status.size;
     }
-}
-
-enum subroutine_result_t
-{
-    SUBROUTINE_RESULT_SUCCESSFUL = 0u,
-    SUBROUTINE_RESULT_FAILED,
-    SUBROUTINE_RESULT_SKIPPED,
-};
 
-static void add_to_build_queue_unblocked_unsafe (struct build_state_t *state, struct resource_entry_t *entry);
+    return 0u;
+}
 
-static enum subroutine_result_t interface_produce_secondary_output_check_reproduction (
-    struct build_state_t *state,
-    struct resource_entry_t *parent_entry,
-    const struct kan_resource_reflected_data_resource_type_t *type_data,
-    kan_interned_string_t name,
-    void *data)
+/// \brief Estimates how much memory will be used by the next build task of given entry.
+/// \details Estimation is based on the sizes of files that are going to be loaded by the task and is scaled to account
+///          for the difference between serialized and loaded sizes. It only uses data that cannot be changed while
+///          the task is waiting in the queue, therefore it is safe to calculate it before adding task to the queue.
+///          It queries file system, therefore it should never be called under build queue lock.
+static kan_memory_size_t estimate_build_task_memory (struct build_state_t *state, struct resource_entry_t *entry)
 {
-    KAN_ATOMIC_INT_SCOPED_LOCK_READ (&state->resource_entries_lock)
-    struct resource_entry_t *reproduced =
-        target_search_local_resource_unsafe (parent_entry->target, type_data->struct_type->name, name);
+    // Current file is either raw resource that is going to be loaded or previous build result that might be loaded
+    // for comparison or would be replaced by the new one of the comparable size.
+    kan_memory_size_t estimate = (kan_memory_size_t) query_file_size_or_zero (entry->current_file_location);
 
-    if (!reproduced)
+    switch (entry->build.internal_next_build_task)
     {
-        return SUBROUTINE_RESULT_SKIPPED;
-    }
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_NONE:
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_LOAD:
+        break;
 
-    if (reproduced->class != RESOURCE_PRODUCTION_CLASS_SECONDARY || !reproduced->initial_log_secondary_entry ||
-        reproduced->initial_log_secondary_entry->producer_type != parent_entry->type->name ||
-        reproduced->initial_log_secondary_entry->producer_name != parent_entry->name)
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START:
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to produce secondary \"%s\" of type \"%s\" from \"%s\" of type \"%s\" as "
-                 "resource with produced name and type already exists and does not acknowledge the same producer.",
-                 parent_entry->target->name, reproduced->name, reproduced->type->name, parent_entry->type->name,
-                 parent_entry->name);
-        return SUBROUTINE_RESULT_FAILED;
-    }
+        if (entry->class != RESOURCE_PRODUCTION_CLASS_PRIMARY)
+        {
+            break;
+        }
 
-    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&reproduced->header.lock)
-    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&reproduced->build.lock)
+        const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+            kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
 
-    switch (reproduced->header.status)
-    {
-    case RESOURCE_STATUS_UNCONFIRMED:
-    {
-        KAN_ASSERT (!reproduced->build.internal_transient_secondary_output)
-        move_secondary_output_data_to_entry (state, type_data, reproduced, data);
+        if (reflected_type && !reflected_type->build_rule_primary_input_type)
+        {
+            // Import rule is executed right away and reads third party file.
+            struct raw_third_party_entry_t *third_party =
+                target_search_visible_third_party (entry->target, entry->name);
 
-        reproduced->header.status = RESOURCE_STATUS_BUILDING;
-        reproduced->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START;
+            if (third_party)
+            {
+                estimate += query_file_size_or_zero (third_party->file_location);
+            }
+        }
 
-        KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
-        // Use unblocked order as we'd like to save and unload reproduced secondary as soon as possible.
-        add_to_build_queue_unblocked_unsafe (state, reproduced);
-        return SUBROUTINE_RESULT_SUCCESSFUL;
+        break;
     }
 
-    case RESOURCE_STATUS_UNAVAILABLE:
-    case RESOURCE_STATUS_AVAILABLE:
-    case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
-    {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to produce secondary \"%s\" of type \"%s\" from \"%s\" of type \"%s\" as "
-                 "target reproduced entry is already in unavailable/available/platform_unsupported state. Most likely "
-                 "an internal error.",
-                 parent_entry->target->name, reproduced->name, reproduced->type->name, parent_entry->type->name,
-                 parent_entry->name);
-        return SUBROUTINE_RESULT_FAILED;
-    }
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_PROCESS_PRIMARY:
+        estimate += query_file_size_or_zero (entry->build.internal_primary_input_entry->current_file_location);
+        break;
 
-    case RESOURCE_STATUS_BUILDING:
+    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_EXECUTE_BUILD_RULE:
     {
-        if (reproduced->build.internal_transient_secondary_output)
+        if (entry->build.internal_primary_input_entry)
         {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Failed to produce secondary \"%s\" of type \"%s\" from \"%s\" of type \"%s\" as "
-                     "it was already produced from the same producer during current execution.",
-                     parent_entry->target->name, reproduced->name, reproduced->type->name, parent_entry->type->name,
-                     parent_entry->name);
-            return SUBROUTINE_RESULT_FAILED;
+            estimate += query_file_size_or_zero (entry->build.internal_primary_input_entry->current_file_location);
         }
 
-        move_secondary_output_data_to_entry (state, type_data, reproduced, data);
-        return SUBROUTINE_RESULT_SUCCESSFUL;
-    }
+        for (kan_loop_size_t index = 0u; index < entry->new_build_secondary_inputs.size; ++index)
+        {
+            struct new_build_secondary_input_t *input =
+                &((struct new_build_secondary_input_t *) entry->new_build_secondary_inputs.data)[index];
+
+            if (input->entry)
+            {
+                estimate += query_file_size_or_zero (input->entry->current_file_location);
+            }
+            else if (input->third_party_entry)
+            {
+                estimate += query_file_size_or_zero (input->third_party_entry->file_location);
+            }
+        }
 
-    case RESOURCE_STATUS_OUT_OF_SCOPE:
-        // Should never be possible.
-        KAN_ASSERT (false)
         break;
     }
+    }
 
-    KAN_ASSERT (false)
-    return SUBROUTINE_RESULT_FAILED;
+    estimate *= KAN_RESOURCE_PIPELINE_BUILD_MEMORY_ESTIMATE_SCALE;
+    return KAN_MAX (estimate, (kan_memory_size_t) KAN_RESOURCE_PIPELINE_BUILD_MEMORY_ESTIMATE_MIN);
 }
 
-static bool interface_produce_secondary_output (kan_resource_build_rule_interface_t interface,
-                                                kan_interned_string_t type,
-                                                kan_interned_string_t name,
-                                                void *data)
+static struct build_queue_item_t *build_queue_item_create (struct build_state_t *state, struct resource_entry_t *entry)
 {
-    struct build_rule_interface_data_t *interface_data = KAN_HANDLE_GET (interface);
-    struct build_state_t *state = interface_data->state;
-    struct resource_entry_t *parent_entry = interface_data->entry;
+    struct build_queue_item_t *item =
+        kan_allocate_batched (build_queue_allocation_group, sizeof (struct build_queue_item_t));
 
-    const struct kan_resource_reflected_data_resource_type_t *type_data =
-        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, type);
+    item->entry = entry;
+    item->state = state;
+    item->memory_estimate = state->setup->memory_budget > 0u ? estimate_build_task_memory (state, entry) : 0u;
+    item->admission_skips = 0u;
+    return item;
+}
 
-    KAN_ASSERT_FORMATTED (
-        type_data, "Received secondary production of type \"%s\", but unable to query that resource type reflection.",
-        type)
+/// \details Has no inbuilt locking, must be externally synchronized (therefore _unsafe suffix).
+///          New entries are ordered by build priority, so entries with longer dependant build chains are started
+///          first. Search starts from the end of the queue, therefore it is constant time when priorities are unknown.
+static void add_to_build_queue_new_unsafe (struct build_state_t *state, struct build_queue_item_t *item)
+{
+    struct build_queue_item_t *insert_before = NULL;
+    struct build_queue_item_t *candidate = (struct build_queue_item_t *) state->build_queue.last;
 
-    switch (interface_produce_secondary_output_check_reproduction (state, parent_entry, type_data, name, data))
+    while (candidate && candidate->entry->build_priority_ns < item->entry->build_priority_ns)
     {
-    case SUBROUTINE_RESULT_SUCCESSFUL:
-        return name;
+        insert_before = candidate;
+        candidate = (struct build_queue_item_t *) candidate->node.previous;
+    }
 
-    case SUBROUTINE_RESULT_FAILED:
-        reset_secondary_output_data (state, type_data, data);
-        return false;
+    kan_bd_list_add (&state->build_queue, insert_before ? &insert_before->node : NULL, &item->node);
+}
 
-    case SUBROUTINE_RESULT_SKIPPED:
-        break;
-    }
+/// \details Has no inbuilt locking, must be externally synchronized (therefore _unsafe suffix).
+static void add_to_build_queue_unblocked_unsafe (struct build_state_t *state, struct build_queue_item_t *item)
+{
+    kan_bd_list_add (&state->build_queue, state->build_queue.first, &item->node);
+}
 
-    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&state->resource_entries_lock)
-    struct resource_entry_t *entry =
-        target_search_local_resource_unsafe (parent_entry->target, type_data->struct_type->name, name);
+static void unblock_dependant_entries (struct build_state_t *state, struct resource_entry_t *entry)
+{
+    // Unblocked entries are only collected under the lock, because memory estimation for their build queue items
+    // queries file system and therefore should not be executed under build queue lock.
+    struct kan_bd_list_t unblocked_list;
+    kan_bd_list_init (&unblocked_list);
 
-    if (entry)
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to produce secondary \"%s\" of type \"%s\" from \"%s\" of type \"%s\" as it "
-                 "is already produced from some other producer.",
-                 parent_entry->target->name, entry->name, entry->type->name, parent_entry->type->name,
-                 parent_entry->name);
+        KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
+        struct resource_entry_build_blocked_t *blocked = entry->build.blocked_other_first;
 
-        reset_secondary_output_data (state, type_data, data);
-        return false;
-    }
+        while (blocked)
+        {
+            struct resource_entry_build_blocked_t *next = blocked->next;
+            if (kan_atomic_int_add (&blocked->blocked_entry->build.atomic_next_build_task_block_counter, -1) == 1 &&
+                blocked->blocked_entry->build.internal_paused_list_item)
+            {
+                // Last block, move out of paused list in order to push it to a build queue.
+                struct build_info_list_item_t *info = blocked->blocked_entry->build.internal_paused_list_item;
+                kan_bd_list_remove (&state->paused_list, &info->node);
+                kan_bd_list_add (&unblocked_list, NULL, &info->node);
+                blocked->blocked_entry->build.internal_paused_list_item = NULL;
+            }
 
-    struct resource_type_container_t *container =
-        target_search_resource_type_container_unsafe (parent_entry->target, type_data->name);
+            kan_free_batched (entry->allocation_group, blocked);
+            blocked = next;
+        }
 
-    if (!container)
-    {
-        container = resource_type_container_create (parent_entry->target, type_data->struct_type);
+        entry->build.blocked_other_first = NULL;
     }
 
-    entry = resource_entry_create (container, name);
-    entry->class = RESOURCE_PRODUCTION_CLASS_SECONDARY;
+    if (!unblocked_list.first)
+    {
+        return;
+    }
 
-    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->header.lock)
-    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->build.lock)
+    struct kan_bd_list_t items_list;
+    kan_bd_list_init (&items_list);
+    struct build_info_list_item_t *info = (struct build_info_list_item_t *) unblocked_list.first;
 
-    entry->header.status = RESOURCE_STATUS_BUILDING;
-    entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START;
-    entry->build.internal_producer_entry = parent_entry;
-    move_secondary_output_data_to_entry (state, type_data, entry, data);
+    while (info)
+    {
+        struct build_info_list_item_t *next = (struct build_info_list_item_t *) info->node.next;
+        struct build_queue_item_t *item = build_queue_item_create (state, info->entry);
+        kan_bd_list_add (&items_list, NULL, &item->node);
+        kan_free_batched (build_queue_allocation_group, info);
+        info = next;
+    }
 
     KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
-    // Use unblocked order as we'd like to save and unload reproduced secondary as soon as possible.
-    add_to_build_queue_unblocked_unsafe (state, entry);
-    return true;
-}
-
-static void remove_entry_loaded_data_usage (struct resource_entry_t *entry)
-{
-    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&entry->build.lock)
-    --entry->build.loaded_data_request_count;
+    struct build_queue_item_t *item = (struct build_queue_item_t *) items_list.first;
 
-    if (entry->build.loaded_data_request_count == 0u)
+    while (item)
     {
-        resource_entry_unload_data_unsafe (entry);
+        struct build_queue_item_t *next = (struct build_queue_item_t *) item->node.next;
+        add_to_build_queue_unblocked_unsafe (state, item);
+        item = next;
     }
 }
 
-static void cleanup_build_rule_context (struct kan_resource_build_rule_context_t *build_context,
-                                        struct resource_entry_t *entry,
-                                        struct resource_entry_t *primary)
+static void build_task (kan_functor_user_data_t user_data);
+
+static void dispatch_new_tasks_from_queue_unsafe (struct build_state_t *state)
 {
-    if (primary)
-    {
-        remove_entry_loaded_data_usage (primary);
-    }
+    struct build_queue_item_t *item = (struct build_queue_item_t *) state->build_queue.first;
+    kan_loop_size_t items_skipped = 0u;
 
-    for (kan_loop_size_t index = 0u; index < entry->new_build_secondary_inputs.size; ++index)
+    while (item && state->currently_scheduled_build_operations < state->max_simultaneous_build_operations &&
+           items_skipped < KAN_RESOURCE_PIPELINE_BUILD_ADMISSION_SCAN_LIMIT)
     {
-        struct new_build_secondary_input_t *input =
-            &((struct new_build_secondary_input_t *) entry->new_build_secondary_inputs.data)[index];
-
-        if (input->entry)
+        struct build_queue_item_t *next = (struct build_queue_item_t *) item->node.next;
+        // Task is always admitted when nothing else is scheduled,
+        // otherwise entries that are bigger than the whole budget would never be built.
+        if (state->setup->memory_budget > 0u && state->currently_scheduled_build_operations > 0u &&
+            state->currently_scheduled_memory_estimate + item->memory_estimate > state->setup->memory_budget)
         {
-            remove_entry_loaded_data_usage (input->entry);
-        }
-    }
+            if (++item->admission_skips >= KAN_RESOURCE_PIPELINE_BUILD_ADMISSION_MAX_SKIPS)
+            {
+                // Task was skipped too many times: stop admitting other tasks, so scheduled memory drains and
+                // this task is admitted as soon as it fits or nothing else is scheduled. Otherwise, stream of
+                // small tasks could starve big one forever.
+                break;
+            }
 
-    struct kan_resource_build_rule_secondary_node_t *node_to_cleanup = build_context->secondary_input_first;
-    while (node_to_cleanup)
-    {
-        struct kan_resource_build_rule_secondary_node_t *next = node_to_cleanup->next;
-        kan_free_batched (temporary_allocation_group, node_to_cleanup);
-        node_to_cleanup = next;
-    }
+            // Try to find smaller task that fits into the remaining budget.
+            ++items_skipped;
+            item = next;
+            continue;
+        }
 
-    build_context->secondary_input_first = NULL;
-}
+        kan_bd_list_remove (&state->build_queue, &item->node);
+        ++state->currently_scheduled_build_operations;
+        state->currently_scheduled_memory_estimate += item->memory_estimate;
 
-static void replace_entry_current_file_location (struct resource_entry_t *entry,
-                                                 const struct kan_file_system_path_container_t *path)
-{
-    if (entry->current_file_location)
-    {
-        kan_free_general (entry->allocation_group, entry->current_file_location,
-                          strlen (entry->current_file_location) + 1u);
-    }
+        // There is no need to improve performance with task lists and precached sections here,
+        // because total amount of tasks should not be that big.
+        kan_cpu_task_dispatch ((struct kan_cpu_task_t) {
+            .function = build_task,
+            .user_data = (kan_functor_user_data_t) item,
+            .profiler_section = kan_cpu_section_get (item->entry->name),
+        });
 
-    entry->current_file_location = kan_allocate_general (entry->allocation_group, path->length + 1u, alignof (char));
-    memcpy (entry->current_file_location, path->path, path->length);
-    entry->current_file_location[path->length] = '\0';
+        item = next;
+    }
 }
 
-/// \details In case of import build rules, can be executed right away from start task call.
-static struct build_step_output_t execute_build_execute_build_rule (struct build_state_t *state,
-                                                                    struct resource_entry_t *entry)
+static void build_task (kan_functor_user_data_t user_data)
 {
-    struct build_step_output_t output = {
-        .result = BUILD_STEP_RESULT_FAILED,
-        .status = RESOURCE_STATUS_UNAVAILABLE,
-        .available_version = {.type_version = 0u, .last_modification_time = 0u},
-        .loaded_data_to_manage = NULL,
-    };
+    struct build_queue_item_t *item = (struct build_queue_item_t *) user_data;
+    enum resource_entry_next_build_task_t task_to_execute;
+    task_to_execute = item->entry->build.internal_next_build_task;
 
-    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
-        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
-    KAN_ASSERT (reflected_type->produced_from_build_rule)
+    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+             "[Target \"%s\"] Start build task \"%s\" execution for resource \"%s\" of type \"%s\".",
+             item->entry->target->name, get_resource_entry_next_build_task_name (task_to_execute), item->entry->name,
+             item->entry->type->name)
 
-    struct build_rule_interface_data_t interface_data = {
-        .state = state,
-        .entry = entry,
-    };
+    struct build_step_output_t output = execute_build_step (item->state, item->entry);
+    switch (output.result)
+    {
+    case BUILD_STEP_RESULT_SUCCESSFUL:
+    {
+        const bool repeated_task = is_resource_entry_next_build_task_repeated (task_to_execute);
+        bool should_propagate_deployment = false;
+        bool should_propagate_cache = false;
 
-    struct kan_resource_build_rule_context_t build_context = {
-        .primary_name = entry->name,
-        .primary_input = NULL,
-        .secondary_input_first = NULL,
-        .primary_output = NULL,
-        .platform_configuration = NULL,
-        .temporary_workspace = NULL,
-        .interface = KAN_HANDLE_SET (kan_resource_build_rule_interface_t, &interface_data),
-        .produce_secondary_output = interface_produce_secondary_output,
-    };
+        {
+            KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&item->entry->header.lock)
+            KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&item->entry->build.lock)
 
-    struct kan_resource_build_rule_secondary_node_t *context_secondary_input_last = NULL;
-    struct resource_entry_t *primary = NULL;
-    struct raw_third_party_entry_t *primary_third_party = NULL;
-    CUSHION_DEFER { cleanup_build_rule_context (&build_context, entry, primary); }
+            // Make sure that repeated tasks will not override build state.
+            KAN_ASSERT (!repeated_task || item->entry->header.status == output.status)
+            KAN_ASSERT (!repeated_task ||
+                        (item->entry->header.available_version.type_version == output.available_version.type_version &&
+                         item->entry->header.available_version.last_modification_time ==
+                             output.available_version.last_modification_time))
 
-    if (reflected_type->build_rule_primary_input_type)
-    {
-        primary = entry->build.internal_primary_input_entry;
-        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&primary->header.lock)
-        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&primary->build.lock)
+            item->entry->header.status = output.status;
+            item->entry->header.available_version = output.available_version;
+            item->entry->header.passed_build_routine_mark |= !repeated_task;
 
-        // Shouldn't be able to enter that function if it is not the case.
-        KAN_ASSERT (primary->header.status == RESOURCE_STATUS_AVAILABLE)
+            // Sanity check. We cannot end up with available entry and no resource after successful build.
+            KAN_ASSERT (output.loaded_data_to_manage || output.status != RESOURCE_STATUS_AVAILABLE)
 
-        build_context.primary_input = primary->build.loaded_data;
-        KAN_ASSERT (build_context.primary_input)
-    }
-    else
-    {
-        primary_third_party = target_search_visible_third_party (entry->target, entry->name);
-        if (!primary_third_party)
+            if (item->entry->build.loaded_data_request_count > 0u)
+            {
+                item->entry->build.loaded_data = output.loaded_data_to_manage;
+            }
+            else
+            {
+                build_step_output_unload_data (&output, item->entry);
+            }
+
+            unblock_dependant_entries (item->state, item->entry);
+            should_propagate_deployment = item->entry->header.deployment_mark;
+            should_propagate_cache = item->entry->header.cache_mark;
+        }
+
+        if (!repeated_task && output.status != RESOURCE_STATUS_UNAVAILABLE)
         {
-            KAN_LOG (
-                resource_pipeline_build, KAN_LOG_ERROR,
-                "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as its primary third party input is not found.",
-                entry->target->name, entry->name, entry->type->name);
-            return output;
+            if (should_propagate_deployment)
+            {
+                mark_resource_references_for_deployment (item->state, item->entry, NULL);
+            }
+
+            if (should_propagate_deployment || should_propagate_cache)
+            {
+                mark_resource_build_dependencies_for_cache (item->state, item->entry, NULL);
+            }
         }
 
-        entry->build.internal_primary_input_third_party = primary_third_party;
-        build_context.primary_third_party_path = primary_third_party->file_location;
+        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                 "[Target \"%s\"] Finished build task \"%s\" execution for resource \"%s\" of type \"%s\" with "
+                 "successful build exit.",
+                 item->entry->target->name, get_resource_entry_next_build_task_name (task_to_execute),
+                 item->entry->name, item->entry->type->name)
+        break;
     }
 
-    if (reflected_type->build_rule_platform_configuration_type)
+    case BUILD_STEP_RESULT_FAILED:
     {
-        struct platform_configuration_entry_t *configuration_entry =
-            build_state_find_platform_configuration (state, reflected_type->build_rule_platform_configuration_type);
+        build_step_output_unload_data (&output, item->entry);
+        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&item->entry->header.lock)
+        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&item->entry->build.lock)
 
-        if (!configuration_entry)
-        {
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as platform configuration entry \"%s\" is "
-                     "not found.",
-                     entry->target->name, entry->name, entry->type->name,
-                     reflected_type->build_rule_platform_configuration_type);
-            return output;
-        }
+        item->entry->header.status = RESOURCE_STATUS_UNAVAILABLE;
+        item->entry->header.passed_build_routine_mark = true;
 
-        build_context.platform_configuration = configuration_entry->data;
+        struct build_info_list_item_t *info =
+            kan_allocate_batched (build_queue_allocation_group, sizeof (struct build_info_list_item_t));
+
+        info->entry = item->entry;
+        kan_bd_list_add (&item->state->failed_list, NULL, &info->node);
+        unblock_dependant_entries (item->state, item->entry);
+
+        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                 "[Target \"%s\"] Finished build task \"%s\" execution for resource \"%s\" of type \"%s\" with "
+                 "failed build exit.",
+                 item->entry->target->name, get_resource_entry_next_build_task_name (task_to_execute),
+                 item->entry->name, item->entry->type->name)
+
+        break;
     }
 
-    bool secondary_inputs_ready = true;
-    for (kan_loop_size_t index = 0u; index < entry->new_build_secondary_inputs.size; ++index)
+    case BUILD_STEP_RESULT_PAUSED:
     {
-        struct new_build_secondary_input_t *input =
-            &((struct new_build_secondary_input_t *) entry->new_build_secondary_inputs.data)[index];
+        build_step_output_unload_data (&output, item->entry);
+        // Externally visible state should not be changed,
+        // therefore we do not need to lock anything other than build queue.
+
+        bool already_unblocked = false;
 
-        if (input->entry)
         {
-            KAN_ATOMIC_INT_SCOPED_LOCK_READ (&input->entry->header.lock)
-            KAN_ATOMIC_INT_SCOPED_LOCK_READ (&input->entry->build.lock)
+            KAN_ATOMIC_INT_SCOPED_LOCK (&item->state->build_queue_lock)
+            if (kan_atomic_int_get (&item->entry->build.atomic_next_build_task_block_counter) > 0)
+            {
+                struct build_info_list_item_t *info =
+                    kan_allocate_batched (build_queue_allocation_group, sizeof (struct build_info_list_item_t));
 
-            switch (input->entry->header.status)
+                info->entry = item->entry;
+                kan_bd_list_add (&item->state->paused_list, NULL, &info->node);
+                item->entry->build.internal_paused_list_item = info;
+            }
+            else
             {
-            case RESOURCE_STATUS_UNCONFIRMED:
-            case RESOURCE_STATUS_BUILDING:
-                // Must never happen if requests work properly.
-                KAN_ASSERT (false)
-                break;
+                already_unblocked = true;
+            }
+        }
 
-            case RESOURCE_STATUS_UNAVAILABLE:
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as build rule secondary input \"%s\" "
-                         "of type \"%s\" is not available.",
-                         entry->target->name, entry->name, entry->type->name, input->entry->name,
-                         input->entry->type->name);
-                secondary_inputs_ready = false;
-                break;
+        if (already_unblocked)
+        {
+            // Already got unblocked, recycle it into build queue again. Entry is not in paused list, therefore nobody
+            // else can push it to the queue and it is safe to estimate its memory outside of the lock.
+            struct build_queue_item_t *recycled_item = build_queue_item_create (item->state, item->entry);
+            KAN_ATOMIC_INT_SCOPED_LOCK (&item->state->build_queue_lock)
+            add_to_build_queue_new_unsafe (item->state, recycled_item);
+        }
 
-            case RESOURCE_STATUS_AVAILABLE:
-            {
-                struct kan_resource_build_rule_secondary_node_t *node = kan_allocate_batched (
-                    temporary_allocation_group, sizeof (struct kan_resource_build_rule_secondary_node_t));
+        break;
+    }
+    }
 
-                node->next = NULL;
-                node->type = input->entry->type->name;
-                node->name = input->entry->name;
-                node->data = input->entry->build.loaded_data;
-                KAN_ASSERT (node->data)
+    {
+        KAN_ATOMIC_INT_SCOPED_LOCK (&item->state->build_queue_lock)
+        --item->state->currently_scheduled_build_operations;
+        item->state->currently_scheduled_memory_estimate -= item->memory_estimate;
+        dispatch_new_tasks_from_queue_unsafe (item->state);
+    }
 
-                if (context_secondary_input_last)
-                {
-                    context_secondary_input_last->next = node;
-                }
-                else
-                {
-                    build_context.secondary_input_first = node;
-                }
+    kan_free_batched (build_queue_allocation_group, item);
+}
 
-                context_secondary_input_last = node;
-                break;
-            }
+// Build step implementation section.
 
-            case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
-                if (input->reference_flags & KAN_RESOURCE_REFERENCE_REQUIRED)
-                {
-                    KAN_LOG (
-                        resource_pipeline_build, KAN_LOG_ERROR,
-                        "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as build rule secondary input \"%s\" "
-                        "of type \"%s\" is unsupported on this platform, but reference is configured as required.",
-                        entry->target->name, entry->name, entry->type->name, input->entry->name,
-                        input->entry->type->name);
-                    secondary_inputs_ready = false;
-                }
+static bool mark_root_for_deployment (struct build_state_t *state)
+{
+    // Deployment mark application also results in status confirmation checks for most of the build tree, which could
+    // take significant time. However, just executing every deployment mark request in separate thread would not change
+    // a lot: in most cases there are very little count of root resources that reference everything else, so marking
+    // one of that resources would still result in checking most of the build tree.
+    //
+    // It is a good thing to change in the future, but we should prioritize overall implementation before trying to
+    // optimize this part.
 
-                break;
+    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Marking root resources for deployment.")
+    const kan_time_size_t start = kan_precise_time_get_elapsed_nanoseconds ();
+    struct target_t *target = state->targets_first;
 
-            case RESOURCE_STATUS_OUT_OF_SCOPE:
-                KAN_ASSERT_FORMATTED (false,
-                                      "Internal error, secondary input entry has out of scope status, which shouldn't "
-                                      "be possible due to target visibility rules.", )
-                break;
-            }
-        }
-        else
+    struct kan_dynamic_array_t resources_to_mark;
+    kan_dynamic_array_init (&resources_to_mark, KAN_RESOURCE_PIPELINE_BUILD_RRDM_INITIAL,
+                            sizeof (struct resource_entry_t *), alignof (struct resource_entry_t *),
+                            temporary_allocation_group);
+
+    while (target)
+    {
+        // We actually need to mark deployment from out of scope targets to make sure that we will not lose resources
+        // that are only referenced for deployment from out of scope targets. Therefore, `!target->marked_for_build`
+        // check is not needed here.
+
+        for (kan_loop_size_t index = 0u; index < state->setup->reflected_data->root_resource_type_names.size; ++index)
         {
-            struct kan_resource_build_rule_secondary_node_t *node = kan_allocate_batched (
-                temporary_allocation_group, sizeof (struct kan_resource_build_rule_secondary_node_t));
+            kan_interned_string_t type_name =
+                ((kan_interned_string_t *) state->setup->reflected_data->root_resource_type_names.data)[index];
+
+            struct resource_type_container_t *container =
+                target_search_resource_type_container_unsafe (target, type_name);
 
-            node->next = NULL;
-            node->type = NULL;
-            node->name = input->third_party_entry->name;
-            node->third_party_path = input->third_party_entry->file_location;
+            if (!container)
+            {
+                continue;
+            }
 
-            if (context_secondary_input_last)
+            if (resources_to_mark.size + container->entries.items.size > resources_to_mark.capacity)
             {
-                context_secondary_input_last->next = node;
+                kan_dynamic_array_set_capacity (
+                    &resources_to_mark,
+                    KAN_MAX (resources_to_mark.size * 2u, resources_to_mark.size + container->entries.items.size));
             }
-            else
+
+            struct resource_entry_t *entry = (struct resource_entry_t *) container->entries.items.first;
+            while (entry)
             {
-                build_context.secondary_input_first = node;
+                *(struct resource_entry_t **) kan_dynamic_array_add_last (&resources_to_mark) = entry;
+                entry = (struct resource_entry_t *) entry->node.list_node.next;
             }
+        }
 
-            context_secondary_input_last = node;
+        target = target->next;
+    }
+
+    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Gathered %u root resources to mark for deployment.",
+             (unsigned int) resources_to_mark.size)
+    bool successful = true;
+
+    for (kan_loop_size_t index = 0u; index < resources_to_mark.size; ++index)
+    {
+        struct resource_entry_t *entry = ((struct resource_entry_t **) resources_to_mark.data)[index];
+        struct resource_response_t response =
+            execute_resource_request (state, (struct resource_request_t) {
+                                                 .from_target = entry->target,
+                                                 .type = entry->type->name,
+                                                 .name = entry->name,
+                                                 .mode = RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT,
+                                                 .needed_to_build_entry = NULL,
+                                             });
+
+        if (!response.success)
+        {
+            successful = false;
+            KAN_LOG (resource_pipeline_build, KAN_LOG_INFO,
+                     "Failed to mark root resource \"%s\" of type \"%s\" in target \"%s\" for deployment.", entry->name,
+                     entry->type->name, entry->target->name)
         }
     }
 
-    if (!secondary_inputs_ready)
+    kan_dynamic_array_shutdown (&resources_to_mark);
+    kan_atomic_int_lock (&state->build_queue_lock);
+    dispatch_new_tasks_from_queue_unsafe (state);
+    kan_atomic_int_unlock (&state->build_queue_lock);
+
+    const kan_time_size_t end = kan_precise_time_get_elapsed_nanoseconds ();
+    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Done marking root resources for deployment in %.3f ms.",
+             1e-6f * (float) (end - start))
+    return successful;
+}
+
+static void append_entry_target_location_to_path_container (struct resource_entry_t *entry,
+                                                            enum deployment_step_target_location_t location,
+                                                            struct kan_file_system_path_container_t *path)
+{
+    switch (location)
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" as inputs are not available.",
-                 entry->target->name, entry->name, entry->type->name);
-        return output;
+    case DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY:
+        kan_resource_build_append_deploy_path_in_workspace (path, entry->target->name, entry->type->name, entry->name);
+        break;
+
+    case DEPLOYMENT_STEP_TARGET_LOCATION_CACHE:
+        kan_resource_build_append_cache_path_in_workspace (path, entry->target->name, entry->type->name, entry->name);
+        break;
+
+    case DEPLOYMENT_STEP_TARGET_LOCATION_NONE:
+        KAN_ASSERT (false)
+        break;
     }
+}
 
-    struct kan_file_system_path_container_t temporary_workspace;
-    kan_file_system_path_container_copy_string (&temporary_workspace, state->setup->project->workspace_directory);
-    kan_file_system_path_container_append (&temporary_workspace, KAN_RESOURCE_PROJECT_WORKSPACE_TEMPORARY_DIRECTORY);
+static bool move_unchanged_resource_for_deployment (struct resource_entry_t *entry,
+                                                    enum deployment_step_target_location_t location,
+                                                    struct kan_file_system_path_container_t *reused_path)
+{
+    const kan_instance_size_t base_path_length = reused_path->length;
+    CUSHION_DEFER { kan_file_system_path_container_reset_length (reused_path, base_path_length); }
+    append_entry_target_location_to_path_container (entry, location, reused_path);
 
-    kan_file_system_path_container_append (&temporary_workspace, entry->target->name);
-    kan_file_system_make_directory (temporary_workspace.path);
+    if (!kan_file_system_move_file (entry->current_file_location, reused_path->path))
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "[Target \"%s\"] Unable to move file for resource \"%s\" of type \"%s\" to path \"%s\" "
+                             "during deployment/caching.",
+                             entry->target->name, entry->name, entry->type->name, reused_path->path);
+        return false;
+    }
 
-    kan_file_system_path_container_append (&temporary_workspace, entry->type->name);
-    kan_file_system_make_directory (temporary_workspace.path);
+    replace_entry_current_file_location (entry, reused_path);
+    // We must update version as some OSes will change file modification timestamp when moving file.
+    struct kan_file_system_entry_status_t status;
 
-    kan_file_system_path_container_append (&temporary_workspace, entry->name);
-    if (!kan_file_system_make_directory (temporary_workspace.path))
+    if (!kan_file_system_query_entry (reused_path->path, &status))
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "[Target \"%s\"] Unable to query file status for resource \"%s\" of type \"%s\" at path "
+                             "\"%s\" during deployment/caching.",
+                             entry->target->name, entry->name, entry->type->name, reused_path->path);
+        return false;
+    }
+
+    entry->header.available_version.last_modification_time = status.last_modification_time_ns;
+    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+             "[Target \"%s\"] Done moving deployed/cached file for \"%s\" of type \"%s\".", entry->target->name,
+             entry->name, entry->type->name);
+    return true;
+}
+
+static bool remove_unchanged_resource_from_deployment_or_cache (struct resource_entry_t *entry,
+                                                                struct kan_file_system_path_container_t *reused_path)
+{
+    if (!kan_file_system_remove_file (entry->current_file_location))
     {
         KAN_LOG (
             resource_pipeline_build, KAN_LOG_ERROR,
-            "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" due to failure during temporary workspace creation.",
+            "[Target \"%s\"] Failed to remove file for \"%s\" of type \"%s\" that is no longer deployed nor cached.",
             entry->target->name, entry->name, entry->type->name);
-        return output;
+        return false;
     }
 
-    build_context.temporary_workspace = temporary_workspace.path;
-    void *loaded_data = kan_allocate_general (entry->allocation_group, entry->type->size, entry->type->alignment);
-    build_context.primary_output = loaded_data;
+    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+             "[Target \"%s\"] Done removing file for \"%s\" of type \"%s\" that is no longer deployed nor cached.",
+             entry->target->name, entry->name, entry->type->name);
+    return true;
+}
 
-    if (entry->type->init)
+static bool remove_changed_resource_from_old_location (struct resource_entry_t *entry,
+                                                       enum deployment_step_target_location_t old_location,
+                                                       struct kan_file_system_path_container_t *reused_path)
+{
+    if (old_location == DEPLOYMENT_STEP_TARGET_LOCATION_NONE)
     {
-        kan_allocation_group_stack_push (entry->allocation_group);
-        entry->type->init (entry->type->functor_user_data, loaded_data);
-        kan_allocation_group_stack_pop ();
+        return true;
     }
 
-    const enum kan_resource_build_rule_result_t result = reflected_type->build_rule_functor (&build_context);
-    switch (result)
+    const kan_instance_size_t base_path_length = reused_path->length;
+    CUSHION_DEFER { kan_file_system_path_container_reset_length (reused_path, base_path_length); }
+    append_entry_target_location_to_path_container (entry, old_location, reused_path);
+
+    if (!kan_file_system_remove_file (reused_path->path))
     {
-    case KAN_RESOURCE_BUILD_RULE_SUCCESS:
-        // Processed below.
-        break;
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to remove old deployed/cached file for \"%s\" of type \"%s\" after resource "
+                 "is changed.",
+                 entry->target->name, entry->name, entry->type->name);
+        return false;
+    }
+
+    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+             "[Target \"%s\"] Done removing old deployed/cached file for \"%s\" of type \"%s\" (resource is changed).",
+             entry->target->name, entry->name, entry->type->name);
+    return true;
+}
+
+static inline bool deploy_raw_resource (struct build_state_t *state,
+                                        struct resource_entry_t *entry,
+                                        struct kan_file_system_path_container_t *reused_path)
+{
+    void *loaded_data = load_resource_entry_data (state, entry);
+    if (!entry)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to deploy raw resource \"%s\" of type \"%s\" as it wasn't possible to load "
+                 "its data.",
+                 entry->target->name, entry->name, entry->type->name);
+        return false;
+    }
 
-    case KAN_RESOURCE_BUILD_RULE_FAILURE:
-    case KAN_RESOURCE_BUILD_RULE_UNSUPPORTED:
+    CUSHION_DEFER
+    {
         if (entry->type->shutdown)
         {
             entry->type->shutdown (entry->type->functor_user_data, loaded_data);
         }
 
         kan_free_general (entry->allocation_group, loaded_data, entry->type->size);
-        loaded_data = NULL;
-        break;
     }
 
-    switch (result)
-    {
-    case KAN_RESOURCE_BUILD_RULE_SUCCESS:
-        // Processed below.
-        break;
+    const kan_instance_size_t base_path_length = reused_path->length;
+    CUSHION_DEFER { kan_file_system_path_container_reset_length (reused_path, base_path_length); }
+    append_entry_target_location_to_path_container (entry, DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY, reused_path);
 
-    case KAN_RESOURCE_BUILD_RULE_FAILURE:
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_write (reused_path->path, true);
+    if (!stream)
     {
         KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to build \"%s\" of type \"%s\" due to build rule failure.",
+                 "[Target \"%s\"] Failed to deploy raw resource \"%s\" of type \"%s\" as it wasn't possible to open "
+                 "file write stream.",
                  entry->target->name, entry->name, entry->type->name);
-        return output;
+        return false;
     }
 
-    case KAN_RESOURCE_BUILD_RULE_UNSUPPORTED:
+    stream = kan_random_access_stream_buffer_open_for_write (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
+    CUSHION_DEFER { stream->operations->close (stream); }
+
+    if (!kan_serialization_binary_write_type_header (
+            stream, entry->type->name, KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t)))
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                 "[Target \"%s\"] Resource \"%s\" of type \"%s\" is marked as platform unsupported by build rule.",
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to deploy raw resource \"%s\" of type \"%s\" due to failure while writing "
+                 "type header.",
                  entry->target->name, entry->name, entry->type->name);
+        return false;
+    }
 
-        output.result = BUILD_STEP_RESULT_SUCCESSFUL;
-        output.status = RESOURCE_STATUS_PLATFORM_UNSUPPORTED;
-        output.available_version.type_version = reflected_type->resource_type_meta->version;
-
-        // As result is unsupported, we do not have a file for the timestamp, so we just use current time.
-        output.available_version.last_modification_time = kan_precise_time_get_epoch_nanoseconds_utc ();
+    kan_serialization_binary_writer_t writer =
+        kan_serialization_binary_writer_create (stream, loaded_data, entry->type->name, state->binary_script_storage,
+                                                KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
+    CUSHION_DEFER { kan_serialization_binary_writer_destroy (writer); }
 
-        // Unsupported, so now loaded data.
-        output.loaded_data_to_manage = NULL;
-        return output;
+    enum kan_serialization_state_t serialization_state;
+    while ((serialization_state = kan_serialization_binary_writer_step (writer)) == KAN_SERIALIZATION_IN_PROGRESS)
+    {
     }
+
+    if (serialization_state == KAN_SERIALIZATION_FAILED)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to deploy raw resource \"%s\" of type \"%s\" due to serialization error.",
+                 entry->target->name, entry->name, entry->type->name);
+        return false;
     }
 
-    // Should not be able to start build twice for one resource.
-    KAN_ASSERT (entry->new_references.size == 0u)
+    // We do not update version as for deployed raw resources version of raw file is used instead of deployed file.
+    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+             "[Target \"%s\"] Done deploying raw resource file for \"%s\" of type \"%s\".", entry->target->name,
+             entry->name, entry->type->name);
+    return true;
+}
 
-    struct kan_resource_reference_detection_error_context_t error_context = {
-        .resource_target = entry->target->name,
-        .resource_type = entry->type->name,
-        .resource_name = entry->name,
-    };
+static inline bool move_produced_file_for_cache_or_deployment (struct resource_entry_t *entry,
+                                                               enum deployment_step_target_location_t location,
+                                                               struct kan_file_system_path_container_t *reused_path)
+{
+    const kan_instance_size_t base_path_length = reused_path->length;
+    CUSHION_DEFER { kan_file_system_path_container_reset_length (reused_path, base_path_length); }
+    append_entry_target_location_to_path_container (entry, location, reused_path);
+
+    KAN_ASSERT (entry->current_file_location)
+    if (!kan_file_system_move_file (entry->current_file_location, reused_path->path))
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Unable to deploy/cache \"%s\" of type \"%s\" as file move operation failed.",
+                 entry->target->name, entry->name, entry->type->name);
+        return false;
+    }
+
+    replace_entry_current_file_location (entry, reused_path);
+    // We must update version as some OSes will change file modification timestamp when moving file.
+    struct kan_file_system_entry_status_t status;
 
-    if (!kan_resource_reflected_data_storage_detect_references (state->setup->reflected_data, entry->type->name,
-                                                                loaded_data, &entry->new_references, &error_context))
+    if (!kan_file_system_query_entry (reused_path->path, &status))
     {
         KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Verification failed while detection references from \"%s\" of type \"%s\".",
+                 "[Target \"%s\"] Unable to deploy/cache \"%s\" of type \"%s\" as file status query after move failed.",
                  entry->target->name, entry->name, entry->type->name);
-        return output;
+        return false;
     }
 
-    // We no longer use temporary workspace path container, so may as well use it for saving.
-    // Also, we should not use entry name for file name as it might be long and cause path overflow on Windows.
-    kan_file_system_path_container_append (&temporary_workspace, "__saved__");
-    kan_file_system_path_container_add_suffix (&temporary_workspace, ".bin");
-    replace_entry_current_file_location (entry, &temporary_workspace);
+    entry->header.available_version.last_modification_time = status.last_modification_time_ns;
+    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+             "[Target \"%s\"] Done deploying/caching file for \"%s\" of type \"%s\".", entry->target->name, entry->name,
+             entry->type->name);
+    return true;
+}
 
-    CUSHION_DEFER
+static bool execute_deployment_caching_step_for_entry (struct build_state_t *state,
+                                                       struct resource_entry_t *entry,
+                                                       struct kan_file_system_path_container_t *reused_path)
+{
+    enum deployment_step_target_location_t old_location = DEPLOYMENT_STEP_TARGET_LOCATION_NONE;
+    switch (entry->class)
     {
-        if (output.result != BUILD_STEP_RESULT_SUCCESSFUL)
+    case RESOURCE_PRODUCTION_CLASS_RAW:
+        if (entry->initial_log_raw_entry && entry->initial_log_raw_entry->deployed)
         {
-            if (entry->type->shutdown)
+            old_location = DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY;
+        }
+
+        break;
+
+    case RESOURCE_PRODUCTION_CLASS_PRIMARY:
+        if (entry->initial_log_built_entry)
+        {
+            switch (entry->initial_log_built_entry->saved_directory)
             {
-                entry->type->shutdown (entry->type->functor_user_data, loaded_data);
-            }
+            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY:
+                old_location = DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY;
+                break;
 
-            kan_free_general (entry->allocation_group, loaded_data, entry->type->size);
-            loaded_data = NULL;
+            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE:
+                old_location = DEPLOYMENT_STEP_TARGET_LOCATION_CACHE;
+                break;
+
+            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_UNSUPPORTED:
+                break;
+            }
         }
-    }
 
-    if (!save_entry_data (state, entry, loaded_data))
-    {
-        return output;
-    }
+        break;
 
-    struct kan_file_system_entry_status_t status;
-    if (!kan_file_system_query_entry (entry->current_file_location, &status))
-    {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to properly save \"%s\" of type \"%s\" as it wasn't possible to query file "
-                 "status at \"%s\" after the save operation.",
-                 entry->target->name, entry->name, entry->type->name, entry->current_file_location);
-        return output;
-    }
+    case RESOURCE_PRODUCTION_CLASS_SECONDARY:
+        if (entry->initial_log_secondary_entry)
+        {
+            switch (entry->initial_log_secondary_entry->saved_directory)
+            {
+            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY:
+                old_location = DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY;
+                break;
 
-    output.result = BUILD_STEP_RESULT_SUCCESSFUL;
-    output.status = RESOURCE_STATUS_AVAILABLE;
-    output.available_version.type_version = reflected_type->resource_type_meta->version;
-    output.available_version.last_modification_time = status.last_modification_time_ns;
-    output.loaded_data_to_manage = loaded_data;
-    return output;
-}
+            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE:
+                old_location = DEPLOYMENT_STEP_TARGET_LOCATION_CACHE;
+                break;
 
-static struct build_step_output_t execute_build_secondary_process_primary (struct build_state_t *state,
-                                                                           struct resource_entry_t *entry);
+            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_UNSUPPORTED:
+                break;
+            }
+        }
 
-static struct build_step_output_t execute_build_secondary_start (struct build_state_t *state,
-                                                                 struct resource_entry_t *entry)
-{
-    struct build_step_output_t output = {
-        .result = BUILD_STEP_RESULT_FAILED,
-        .status = RESOURCE_STATUS_UNAVAILABLE,
-        .available_version = {.type_version = 0u, .last_modification_time = 0u},
-        .loaded_data_to_manage = NULL,
-    };
+        break;
+    }
 
-    struct resource_request_t request;
-    if (entry->build.internal_producer_entry)
+    enum deployment_step_target_location_t new_location = DEPLOYMENT_STEP_TARGET_LOCATION_NONE;
+    if (entry->header.deployment_mark)
     {
-        // Produced during this build, create request in order to wait for primary build.
-        request = (struct resource_request_t) {
-            .from_target = entry->target,
-            .type = entry->build.internal_producer_entry->type->name,
-            .name = entry->build.internal_producer_entry->name,
-            .mode = RESOURCE_REQUEST_MODE_BUILD_REQUIRED,
-            .needed_to_build_entry = entry,
-        };
+        new_location = DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY;
     }
-    else
+    else if (entry->header.cache_mark &&
+             // Platform unsupported resources have no output and therefore there ios no physical file to cache.
+             entry->header.status != RESOURCE_STATUS_PLATFORM_UNSUPPORTED &&
+             // Raw files are preserved as raw files, so there is no sense to physically cache them.
+             // Cache mark is only needed on them to check whether they were used in build at all.
+             entry->class != RESOURCE_PRODUCTION_CLASS_RAW)
     {
-        // Must've been produced earlier, check if producer is up-to-date.
-        KAN_ASSERT (entry->initial_log_secondary_entry)
-        request = (struct resource_request_t) {
-            .from_target = entry->target,
-            .type = entry->initial_log_secondary_entry->producer_type,
-            .name = entry->initial_log_secondary_entry->producer_name,
-            .mode = RESOURCE_REQUEST_MODE_BUILD_REQUIRED,
-            .needed_to_build_entry = entry,
-        };
+        new_location = DEPLOYMENT_STEP_TARGET_LOCATION_CACHE;
     }
 
-    struct resource_response_t response = execute_resource_request (state, request);
-    if (!response.success)
+    if (!entry->header.passed_build_routine_mark)
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to process build start for \"%s\" of type \"%s\" as it wasn't possible to "
-                 "request producer resource \"%s\" of type \"%s\".",
-                 entry->target->name, entry->name, entry->type->name, entry->initial_log_secondary_entry->producer_type,
-                 entry->initial_log_secondary_entry->producer_name);
-        return output;
-    }
+        if (old_location != new_location)
+        {
+            switch (old_location)
+            {
+            case DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY:
+            case DEPLOYMENT_STEP_TARGET_LOCATION_CACHE:
+                switch (new_location)
+                {
+                case DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY:
+                case DEPLOYMENT_STEP_TARGET_LOCATION_CACHE:
+                    return move_unchanged_resource_for_deployment (entry, new_location, reused_path);
 
-    entry->build.internal_producer_entry = response.entry;
-    if (kan_atomic_int_get (&entry->build.atomic_next_build_task_block_counter) > 0)
-    {
-        entry->build.internal_next_build_task = RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_PROCESS_PRIMARY;
-        output.result = BUILD_STEP_RESULT_PAUSED;
-        return output;
-    }
+                case DEPLOYMENT_STEP_TARGET_LOCATION_NONE:
+                    return remove_unchanged_resource_from_deployment_or_cache (entry, reused_path);
+                }
 
-    return execute_build_secondary_process_primary (state, entry);
-}
+                break;
 
-static void cleanup_secondary_process_context (struct build_state_t *state, struct resource_entry_t *entry)
-{
-    if (entry->build.internal_producer_entry)
-    {
-        remove_entry_loaded_data_usage (entry->build.internal_producer_entry);
-    }
+            case DEPLOYMENT_STEP_TARGET_LOCATION_NONE:
+                switch (new_location)
+                {
+                case DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY:
+                case DEPLOYMENT_STEP_TARGET_LOCATION_CACHE:
+                    KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                             "[Target \"%s\"] Unable to deploy/cache \"%s\" of type \"%s\" as its version was not "
+                             "changed, but there is no previous deployed/cached version.",
+                             entry->target->name, entry->name, entry->type->name);
+                    return false;
 
-    // It is only not NULL on cleanup if processing has failed.
-    resource_entry_unload_secondary_transient_data (entry);
-}
+                case DEPLOYMENT_STEP_TARGET_LOCATION_NONE:
+                    break;
+                }
 
-static struct build_step_output_t execute_build_secondary_process_primary (struct build_state_t *state,
-                                                                           struct resource_entry_t *entry)
-{
-    struct build_step_output_t output = {
-        .result = BUILD_STEP_RESULT_FAILED,
-        .status = RESOURCE_STATUS_UNAVAILABLE,
-        .available_version = {.type_version = 0u, .last_modification_time = 0u},
-        .loaded_data_to_manage = NULL,
-    };
+                break;
+            }
+        }
 
-    const struct kan_resource_reflected_data_resource_type_t *reflected_type =
-        kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data, entry->type->name);
-    CUSHION_DEFER { cleanup_secondary_process_context (state, entry); }
+        return true;
+    }
 
+    remove_changed_resource_from_old_location (entry, old_location, reused_path);
+    switch (new_location)
     {
-        struct resource_entry_t *producer = entry->build.internal_producer_entry;
-        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&producer->header.lock)
-
-        switch (producer->header.status)
+    case DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY:
+    case DEPLOYMENT_STEP_TARGET_LOCATION_CACHE:
+        switch (entry->header.status)
         {
         case RESOURCE_STATUS_UNCONFIRMED:
-        case RESOURCE_STATUS_BUILDING:
-        case RESOURCE_STATUS_OUT_OF_SCOPE:
+            // Should not be able to get the mark and still be unconfirmed.
             KAN_ASSERT (false)
             break;
 
         case RESOURCE_STATUS_UNAVAILABLE:
-        case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
-        {
-            // Technically not a failure, it is just that this secondary resource is no longer produced.
-            // If it is still needed somewhere it will be a failure there, but it is a different story.
-            output.result = BUILD_STEP_RESULT_SUCCESSFUL;
-            output.status = RESOURCE_STATUS_UNAVAILABLE;
-
-            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                     "[Target \"%s\"] Marking secondary \"%s\" of type \"%s\" as unavailable, because its producer "
-                     "\"%s\" of type \"%s\" is %s.",
-                     entry->target->name, entry->name, entry->type->name, producer->name, producer->type->name,
-                     producer->header.status == RESOURCE_STATUS_UNAVAILABLE ? "no longer available" :
-                                                                              "not supported on this platform");
-
-            return output;
-        }
-
-        case RESOURCE_STATUS_AVAILABLE:
-            // Further processing is made below as we don't need locks for that.
-            break;
-        }
-    }
-
-    if (!entry->build.internal_transient_secondary_output)
-    {
-        output.result = BUILD_STEP_RESULT_SUCCESSFUL;
-        output.status = RESOURCE_STATUS_UNAVAILABLE;
-
-        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                 "[Target \"%s\"] Marking secondary \"%s\" of type \"%s\" as unavailable, because its producer "
-                 "\"%s\" of type \"%s\" didn't reproduce it during its build time.");
-        return output;
-    }
-
-    // Should not be able to start build twice for one resource.
-    KAN_ASSERT (entry->new_references.size == 0u)
-
-    struct kan_resource_reference_detection_error_context_t error_context = {
-        .resource_target = entry->target->name,
-        .resource_type = entry->type->name,
-        .resource_name = entry->name,
-    };
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Unable to deploy/cache \"%s\" of type \"%s\" as it is unavailable due to build "
+                     "failure.",
+                     entry->target->name, entry->name, entry->type->name);
+            return false;
 
-    if (!kan_resource_reflected_data_storage_detect_references (state->setup->reflected_data, entry->type->name,
-                                                                entry->build.internal_transient_secondary_output,
-                                                                &entry->new_references, &error_context))
-    {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Verification failed while detection references from \"%s\" of type \"%s\".",
-                 entry->target->name, entry->name, entry->type->name);
-        return output;
-    }
+        case RESOURCE_STATUS_BUILDING:
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Unable to deploy/cache \"%s\" of type \"%s\" as it is somehow in building "
+                     "status, usually it happens due to deadlock.",
+                     entry->target->name, entry->name, entry->type->name);
+            return false;
 
-    struct kan_file_system_path_container_t temporary_save_path;
-    kan_file_system_path_container_copy_string (&temporary_save_path, state->setup->project->workspace_directory);
-    kan_file_system_path_container_append (&temporary_save_path, KAN_RESOURCE_PROJECT_WORKSPACE_TEMPORARY_DIRECTORY);
+        case RESOURCE_STATUS_AVAILABLE:
+            switch (entry->class)
+            {
+            case RESOURCE_PRODUCTION_CLASS_RAW:
+                return deploy_raw_resource (state, entry, reused_path);
 
-    kan_file_system_path_container_append (&temporary_save_path, entry->target->name);
-    kan_file_system_make_directory (temporary_save_path.path);
+            case RESOURCE_PRODUCTION_CLASS_PRIMARY:
+            case RESOURCE_PRODUCTION_CLASS_SECONDARY:
+                return move_produced_file_for_cache_or_deployment (entry, new_location, reused_path);
+            }
 
-    kan_file_system_path_container_append (&temporary_save_path, entry->type->name);
-    kan_file_system_make_directory (temporary_save_path.path);
+            break;
 
-    kan_file_system_path_container_append (&temporary_save_path, entry->name);
-    kan_file_system_path_container_add_suffix (&temporary_save_path, ".bin");
-    replace_entry_current_file_location (entry, &temporary_save_path);
+        case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
+        case RESOURCE_STATUS_OUT_OF_SCOPE:
+            // Should never get not-none build location.
+            KAN_ASSERT (false)
+            break;
+        }
 
-    const bool saved = save_entry_data (state, entry, entry->build.internal_transient_secondary_output);
-    struct kan_file_system_entry_status_t status;
-    const bool proper_version = kan_file_system_query_entry (entry->current_file_location, &status);
+        break;
 
-    if (!saved || !proper_version)
-    {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to properly save \"%s\" of type \"%s\" as it wasn't possible to query "
-                 "file status at \"%s\" after the save operation.",
-                 entry->target->name, entry->name, entry->type->name, entry->current_file_location);
-        return output;
+    case DEPLOYMENT_STEP_TARGET_LOCATION_NONE:
+        // Nothing to do, we've just cleared old deployment and that is all we need to do.
+        break;
     }
 
-    output.result = BUILD_STEP_RESULT_SUCCESSFUL;
-    output.status = RESOURCE_STATUS_AVAILABLE;
-    output.available_version.type_version = reflected_type->resource_type_meta->version;
-    output.available_version.last_modification_time = status.last_modification_time_ns;
-    output.loaded_data_to_manage = entry->build.internal_transient_secondary_output;
-    entry->build.internal_transient_secondary_output = NULL;
-    return output;
+    return true;
 }
 
-static struct build_step_output_t execute_build_step (struct build_state_t *state, struct resource_entry_t *entry)
+static void execute_deployment_caching_step_for_target (kan_functor_user_data_t user_data)
 {
-    struct build_step_output_t output = {
-        .result = BUILD_STEP_RESULT_FAILED,
-        .status = RESOURCE_STATUS_UNAVAILABLE,
-        .available_version = {.type_version = 0u, .last_modification_time = 0u},
-        .loaded_data_to_manage = NULL,
-    };
+    struct target_t *target = (struct target_t *) user_data;
+    struct build_state_t *state = target->state;
+    target->deployment_step_successful = true;
 
-    switch (entry->build.internal_next_build_task)
-    {
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_NONE:
-        break;
+    struct kan_file_system_path_container_t reused_path;
+    kan_file_system_path_container_copy_string (&reused_path, state->setup->project->workspace_directory);
+    const kan_instance_size_t reused_path_base_length = reused_path.length;
 
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_START:
-        switch (entry->class)
-        {
-        case RESOURCE_PRODUCTION_CLASS_RAW:
-            output = execute_build_raw_start (state, entry);
-            break;
+    // Ensure deploy directory for this target is created.
+    kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_WORKSPACE_DEPLOY_DIRECTORY);
+    kan_file_system_make_directory (reused_path.path);
 
-        case RESOURCE_PRODUCTION_CLASS_PRIMARY:
-            output = execute_build_primary_start (state, entry);
-            break;
+    kan_file_system_path_container_append (&reused_path, target->name);
+    kan_file_system_make_directory (reused_path.path);
+    kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
 
-        case RESOURCE_PRODUCTION_CLASS_SECONDARY:
-            output = execute_build_secondary_start (state, entry);
-            break;
-        }
+    // Ensure cache directory for this target is created.
+    kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_WORKSPACE_CACHE_DIRECTORY);
+    kan_file_system_make_directory (reused_path.path);
 
-        break;
+    kan_file_system_path_container_append (&reused_path, target->name);
+    kan_file_system_make_directory (reused_path.path);
+    kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
 
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_PROCESS_PRIMARY:
+    struct resource_type_container_t *container =
+        (struct resource_type_container_t *) target->resource_types.items.first;
 
-        switch (entry->class)
-        {
-        case RESOURCE_PRODUCTION_CLASS_RAW:
-            KAN_ASSERT_FORMATTED (false,
-                                  "[Target \"%s\"] Got process primary input task for resource \"%s\" of type \"%s\" "
-                                  "which is raw and therefore cannot get this task. It is an internal error.",
-                                  entry->target->name, entry->name, entry->type->name)
-            break;
+    while (container)
+    {
+        // Ensure deploy directory for this resource type is created.
+        kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_WORKSPACE_DEPLOY_DIRECTORY);
+        kan_file_system_path_container_append (&reused_path, target->name);
+        kan_file_system_path_container_append (&reused_path, container->type->name);
+        kan_file_system_make_directory (reused_path.path);
+        kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
 
-        case RESOURCE_PRODUCTION_CLASS_PRIMARY:
-            output = execute_build_primary_process_primary (state, entry);
-            break;
+        // Ensure cache directory for this resource type is created.
+        kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_WORKSPACE_CACHE_DIRECTORY);
+        kan_file_system_path_container_append (&reused_path, target->name);
+        kan_file_system_path_container_append (&reused_path, container->type->name);
+        kan_file_system_make_directory (reused_path.path);
+        kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
 
-        case RESOURCE_PRODUCTION_CLASS_SECONDARY:
-            output = execute_build_secondary_process_primary (state, entry);
-            break;
+        struct resource_entry_t *entry = (struct resource_entry_t *) container->entries.items.first;
+        while (entry)
+        {
+            target->deployment_step_successful &=
+                execute_deployment_caching_step_for_entry (state, entry, &reused_path);
+            kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
+            entry = (struct resource_entry_t *) entry->node.list_node.next;
         }
 
-        break;
+        container = (struct resource_type_container_t *) container->node.list_node.next;
+    }
 
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_BUILD_EXECUTE_BUILD_RULE:
-        output = execute_build_execute_build_rule (state, entry);
-        break;
+    // File status queries in Kan always follow symlinks, so we can just delete all symlinks for third party resources
+    // and create new ones -- timestamps will be taken from linked resources anyway.
 
-    case RESOURCE_ENTRY_NEXT_BUILD_TASK_LOAD:
-        if ((output.loaded_data_to_manage = load_resource_entry_data (state, entry)))
-        {
-            output.result = BUILD_STEP_RESULT_SUCCESSFUL;
-            KAN_ATOMIC_INT_SCOPED_LOCK_READ (&entry->header.lock)
-            output.status = entry->header.status;
-            output.available_version = entry->header.available_version;
-        }
-        else
+    // Ensure third party deploy directory for this resource type is created.
+    kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
+    kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_WORKSPACE_DEPLOY_DIRECTORY);
+    kan_file_system_path_container_append (&reused_path, target->name);
+    kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_DEPLOY_THIRD_PARTY_SUBDIRECTORY);
+    const kan_instance_size_t third_party_base_length = reused_path.length;
+
+    if (kan_file_system_check_existence (reused_path.path))
+    {
+        if (!kan_file_system_remove_directory_with_content (reused_path.path))
         {
-            output.result = BUILD_STEP_RESULT_FAILED;
+            KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                                 "[Target \"%s\"] Failed to remove third party resources deployment directory.",
+                                 target->name)
+            target->deployment_step_successful = false;
+            return;
         }
-
-        break;
     }
 
-    return output;
-}
+    kan_file_system_make_directory (reused_path.path);
+    struct raw_third_party_entry_t *entry = (struct raw_third_party_entry_t *) target->raw_third_party.items.first;
 
-/// \details Has no inbuilt locking, must be externally synchronized (therefore _unsafe suffix).
-static void add_to_build_queue_new_unsafe (struct build_state_t *state, struct resource_entry_t *entry)
-{
-    struct build_queue_item_t *item =
-        kan_allocate_batched (build_queue_allocation_group, sizeof (struct build_queue_item_t));
+    while (entry)
+    {
+        if (entry->deployment_mark)
+        {
+            kan_file_system_path_container_append (&reused_path, entry->name);
+            CUSHION_DEFER { kan_file_system_path_container_reset_length (&reused_path, third_party_base_length); }
 
-    item->entry = entry;
-    item->state = state;
-    kan_bd_list_add (&state->build_queue, NULL, &item->node);
-}
+            if (!kan_file_system_create_symbolic_link (reused_path.path, entry->file_location))
+            {
+                KAN_LOG_WITH_BUFFER (
+                    KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                    "[Target \"%s\"] Failed to create deployment symbolic link for third party resource \"%s\".",
+                    target->name, entry->name)
+                target->deployment_step_successful = false;
+            }
 
-/// \details Has no inbuilt locking, must be externally synchronized (therefore _unsafe suffix).
-static void add_to_build_queue_unblocked_unsafe (struct build_state_t *state, struct resource_entry_t *entry)
-{
-    struct build_queue_item_t *item =
-        kan_allocate_batched (build_queue_allocation_group, sizeof (struct build_queue_item_t));
+            kan_file_system_path_container_reset_length (&reused_path, third_party_base_length);
+        }
 
-    item->entry = entry;
-    item->state = state;
-    kan_bd_list_add (&state->build_queue, state->build_queue.first, &item->node);
+        entry = (struct raw_third_party_entry_t *) entry->node.list_node.next;
+    }
 }
 
-static void unblock_dependant_entries (struct build_state_t *state, struct resource_entry_t *entry)
+static bool execute_deployment_caching_step (struct build_state_t *state)
 {
-    KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
-    struct resource_entry_build_blocked_t *blocked = entry->build.blocked_other_first;
+    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Executing resource deployment and caching passes.")
+    KAN_CPU_SCOPED_STATIC_SECTION (execute_deployment_and_caching)
+    const kan_time_size_t start = kan_precise_time_get_elapsed_nanoseconds ();
 
-    while (blocked)
+    struct target_t *target = state->targets_first;
+    kan_cpu_job_t job = kan_cpu_job_create ();
+
+    while (target)
     {
-        struct resource_entry_build_blocked_t *next = blocked->next;
-        if (kan_atomic_int_add (&blocked->blocked_entry->build.atomic_next_build_task_block_counter, -1) == 1 &&
-            blocked->blocked_entry->build.internal_paused_list_item)
+        CUSHION_DEFER { target = target->next; }
+        if (!target->marked_for_build)
         {
-            // Last block, push to a build queue.
-            add_to_build_queue_unblocked_unsafe (state, blocked->blocked_entry);
-
-            kan_bd_list_remove (&state->paused_list, &blocked->blocked_entry->build.internal_paused_list_item->node);
-            kan_free_batched (build_queue_allocation_group, blocked->blocked_entry->build.internal_paused_list_item);
-            blocked->blocked_entry->build.internal_paused_list_item = NULL;
+            continue;
         }
 
-        kan_free_batched (entry->allocation_group, blocked);
-        blocked = next;
+        // There is not that many targets, so we can just post tasks one by one instead of using task list.
+        kan_cpu_job_dispatch_task (job, (struct kan_cpu_task_t) {
+                                            .function = execute_deployment_caching_step_for_target,
+                                            .user_data = (kan_functor_user_data_t) target,
+                                            .profiler_section = kan_cpu_section_get (target->name),
+                                        });
+    }
+
+    kan_cpu_job_release (job);
+    kan_cpu_job_wait (job);
+
+    bool successful = true;
+    target = state->targets_first;
+
+    while (target)
+    {
+        successful &= target->deployment_step_successful;
+        target = target->next;
     }
 
-    entry->build.blocked_other_first = NULL;
+    const kan_time_size_t end = kan_precise_time_get_elapsed_nanoseconds ();
+    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Done moving resource files for deployment and caching in %.3f ms.",
+             1e-6f * (float) (end - start))
+    return successful;
 }
 
-static void build_task (kan_functor_user_data_t user_data);
-
-static void dispatch_new_tasks_from_queue_unsafe (struct build_state_t *state)
+static void add_entry_to_build_log (struct build_state_t *state,
+                                    struct kan_resource_log_target_t *log_target,
+                                    struct resource_entry_t *entry)
 {
-    while (state->currently_scheduled_build_operations < state->max_simultaneous_build_operations &&
-           state->build_queue.first)
+    // Unless entry is marked as available or platform unsupported, it is not added to log.
+    switch (entry->header.status)
     {
-        struct build_queue_item_t *item = (struct build_queue_item_t *) state->build_queue.first;
-        kan_bd_list_remove (&state->build_queue, &item->node);
-        ++state->currently_scheduled_build_operations;
-
-        // There is no need to improve performance with task lists and precached sections here,
-        // because total amount of tasks should not be that big.
-        kan_cpu_task_dispatch ((struct kan_cpu_task_t) {
-            .function = build_task,
-            .user_data = (kan_functor_user_data_t) item,
-            .profiler_section = kan_cpu_section_get (item->entry->name),
-        });
-    }
-}
+    case RESOURCE_STATUS_UNCONFIRMED:
+    case RESOURCE_STATUS_UNAVAILABLE:
+    case RESOURCE_STATUS_BUILDING:
+        return;
 
-static void build_task (kan_functor_user_data_t user_data)
-{
-    struct build_queue_item_t *item = (struct build_queue_item_t *) user_data;
-    enum resource_entry_next_build_task_t task_to_execute;
-    task_to_execute = item->entry->build.internal_next_build_task;
+    case RESOURCE_STATUS_AVAILABLE:
+    case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
+        break;
 
-    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-             "[Target \"%s\"] Start build task \"%s\" execution for resource \"%s\" of type \"%s\".",
-             item->entry->target->name, get_resource_entry_next_build_task_name (task_to_execute), item->entry->name,
-             item->entry->type->name)
+    case RESOURCE_STATUS_OUT_OF_SCOPE:
+        // Must be processed separately on target log generation level.
+        KAN_ASSERT (false)
+        return;
+    }
 
-    struct build_step_output_t output = execute_build_step (item->state, item->entry);
-    switch (output.result)
-    {
-    case BUILD_STEP_RESULT_SUCCESSFUL:
+    // Unless entry is either deployed or cached, it is not added to log.
+    if (!entry->header.deployment_mark && !entry->header.cache_mark)
     {
-        const bool repeated_task = is_resource_entry_next_build_task_repeated (task_to_execute);
-        bool should_propagate_deployment = false;
-        bool should_propagate_cache = false;
+        return;
+    }
 
+    if (entry->header.passed_build_routine_mark)
+    {
+        switch (entry->class)
         {
-            KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&item->entry->header.lock)
-            KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&item->entry->build.lock)
+        case RESOURCE_PRODUCTION_CLASS_RAW:
+        {
+            struct kan_resource_log_raw_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->raw);
+            if (!log_entry)
+            {
+                kan_dynamic_array_set_capacity (&log_target->raw, log_target->raw.size * 2u);
+                log_entry = kan_dynamic_array_add_last (&log_target->raw);
+                KAN_ASSERT (entry)
+            }
 
-            // Make sure that repeated tasks will not override build state.
-            KAN_ASSERT (!repeated_task || item->entry->header.status == output.status)
-            KAN_ASSERT (!repeated_task ||
-                        (item->entry->header.available_version.type_version == output.available_version.type_version &&
-                         item->entry->header.available_version.last_modification_time ==
-                             output.available_version.last_modification_time))
+            kan_resource_log_raw_entry_init (log_entry);
+            log_entry->type = entry->type->name;
+            log_entry->name = entry->name;
+            log_entry->version = entry->header.available_version;
+            log_entry->deployed = entry->header.deployment_mark;
 
-            item->entry->header.status = output.status;
-            item->entry->header.available_version = output.available_version;
-            item->entry->header.passed_build_routine_mark |= !repeated_task;
+            kan_dynamic_array_set_capacity (&log_entry->references, entry->new_references.size);
+            log_entry->references.size = entry->new_references.size;
+            memcpy (log_entry->references.data, entry->new_references.data,
+                    sizeof (struct kan_resource_log_reference_t) * log_entry->references.size);
+            break;
+        }
 
-            // Sanity check. We cannot end up with available entry and no resource after successful build.
-            KAN_ASSERT (output.loaded_data_to_manage || output.status != RESOURCE_STATUS_AVAILABLE)
+        case RESOURCE_PRODUCTION_CLASS_PRIMARY:
+        {
+            struct kan_resource_log_built_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->built);
+            if (!log_entry)
+            {
+                kan_dynamic_array_set_capacity (&log_target->built, log_target->built.size * 2u);
+                log_entry = kan_dynamic_array_add_last (&log_target->built);
+                KAN_ASSERT (entry)
+            }
 
-            if (item->entry->build.loaded_data_request_count > 0u)
+            kan_resource_log_built_entry_init (log_entry);
+            log_entry->type = entry->type->name;
+            log_entry->name = entry->name;
+            log_entry->version = entry->header.available_version;
+
+            const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+                kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data,
+                                                                         entry->type->name);
+
+            if (reflected_type->build_rule_platform_configuration_type)
             {
-                item->entry->build.loaded_data = output.loaded_data_to_manage;
+                const struct platform_configuration_entry_t *platform_configuration =
+                    build_state_find_platform_configuration (state,
+                                                             reflected_type->build_rule_platform_configuration_type);
+
+                // If we've successfully built this entry, then configuration is here.
+                KAN_ASSERT (platform_configuration)
+                log_entry->platform_configuration_time = platform_configuration->file_time;
             }
             else
             {
-                build_step_output_unload_data (&output, item->entry);
+                log_entry->platform_configuration_time = 0u;
             }
 
-            unblock_dependant_entries (item->state, item->entry);
-            should_propagate_deployment = item->entry->header.deployment_mark;
-            should_propagate_cache = item->entry->header.cache_mark;
-        }
-
-        if (!repeated_task && output.status != RESOURCE_STATUS_UNAVAILABLE)
-        {
-            if (should_propagate_deployment)
+            log_entry->rule_version = reflected_type->build_rule_version;
+            if (entry->build_rule_executed)
             {
-                mark_resource_references_for_deployment (item->state, item->entry, NULL);
+                log_entry->build_rule_duration_ns = entry->build_rule_wall_ns;
             }
-
-            if (should_propagate_deployment || should_propagate_cache)
+            else if (entry->initial_log_built_entry)
             {
-                mark_resource_build_dependencies_for_cache (item->state, item->entry, NULL);
+                // Loaded from artifact cache, keep the last known duration.
+                log_entry->build_rule_duration_ns = entry->initial_log_built_entry->build_rule_duration_ns;
             }
-        }
-
-        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                 "[Target \"%s\"] Finished build task \"%s\" execution for resource \"%s\" of type \"%s\" with "
-                 "successful build exit.",
-                 item->entry->target->name, get_resource_entry_next_build_task_name (task_to_execute),
-                 item->entry->name, item->entry->type->name)
-        break;
-    }
-
-    case BUILD_STEP_RESULT_FAILED:
-    {
-        build_step_output_unload_data (&output, item->entry);
-        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&item->entry->header.lock)
-        KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&item->entry->build.lock)
-
-        item->entry->header.status = RESOURCE_STATUS_UNAVAILABLE;
-        item->entry->header.passed_build_routine_mark = true;
-
-        struct build_info_list_item_t *info =
-            kan_allocate_batched (build_queue_allocation_group, sizeof (struct build_info_list_item_t));
-
-        info->entry = item->entry;
-        kan_bd_list_add (&item->state->failed_list, NULL, &info->node);
-        unblock_dependant_entries (item->state, item->entry);
 
-        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                 "[Target \"%s\"] Finished build task \"%s\" execution for resource \"%s\" of type \"%s\" with "
-                 "failed build exit.",
-                 item->entry->target->name, get_resource_entry_next_build_task_name (task_to_execute),
-                 item->entry->name, item->entry->type->name)
-
-        break;
-    }
-
-    case BUILD_STEP_RESULT_PAUSED:
-    {
-        build_step_output_unload_data (&output, item->entry);
-        // Externally visible state should not be changed,
-        // therefore we do not need to lock anything other than build queue.
-
-        KAN_ATOMIC_INT_SCOPED_LOCK (&item->state->build_queue_lock)
-        if (kan_atomic_int_get (&item->entry->build.atomic_next_build_task_block_counter) > 0)
-        {
-            struct build_info_list_item_t *info =
-                kan_allocate_batched (build_queue_allocation_group, sizeof (struct build_info_list_item_t));
-
-            info->entry = item->entry;
-            kan_bd_list_add (&item->state->paused_list, NULL, &info->node);
-            item->entry->build.internal_paused_list_item = info;
-        }
-        else
-        {
-            // Already got unblocked, recycle it into build queue again.
-            add_to_build_queue_new_unsafe (item->state, item->entry);
-        }
-
-        break;
-    }
-    }
+            if (reflected_type->build_rule_primary_input_type)
+            {
+                // If we've successfully built this entry, then primary input is here.
+                KAN_ASSERT (entry->build.internal_primary_input_entry)
+                log_entry->primary_input_version = entry->build.internal_primary_input_entry->header.available_version;
+            }
+            else
+            {
+                // If we've successfully built this entry, then primary input is here.
+                KAN_ASSERT (entry->build.internal_primary_input_third_party)
+                log_entry->primary_input_version =
+                    raw_third_party_entry_get_log_version (entry->build.internal_primary_input_third_party);
+            }
 
-    {
-        KAN_ATOMIC_INT_SCOPED_LOCK (&item->state->build_queue_lock)
-        --item->state->currently_scheduled_build_operations;
-        dispatch_new_tasks_from_queue_unsafe (item->state);
-    }
+            if (entry->header.status == RESOURCE_STATUS_PLATFORM_UNSUPPORTED)
+            {
+                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_UNSUPPORTED;
+            }
+            else if (entry->header.deployment_mark)
+            {
+                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY;
+            }
+            else if (entry->header.cache_mark)
+            {
+                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE;
+            }
 
-    kan_free_batched (build_queue_allocation_group, item);
-}
+            kan_dynamic_array_set_capacity (&log_entry->references, entry->new_references.size);
+            log_entry->references.size = entry->new_references.size;
 
-// Build step implementation section.
+            memcpy (log_entry->references.data, entry->new_references.data,
+                    sizeof (struct kan_resource_log_reference_t) * log_entry->references.size);
+            kan_dynamic_array_set_capacity (&log_entry->secondary_inputs, entry->new_build_secondary_inputs.size);
 
-static bool mark_root_for_deployment (struct build_state_t *state)
-{
-    // Deployment mark application also results in status confirmation checks for most of the build tree, which could
-    // take significant time. However, just executing every deployment mark request in separate thread would not change
-    // a lot: in most cases there are very little count of root resources that reference everything else, so marking
-    // one of that resources would still result in checking most of the build tree.
-    //
-    // It is a good thing to change in the future, but we should prioritize overall implementation before trying to
-    // optimize this part.
+            for (kan_loop_size_t index = 0u; index < entry->new_build_secondary_inputs.size; ++index)
+            {
+                struct new_build_secondary_input_t *input =
+                    &((struct new_build_secondary_input_t *) entry->new_build_secondary_inputs.data)[index];
 
-    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Marking root resources for deployment.")
-    const kan_time_size_t start = kan_precise_time_get_elapsed_nanoseconds ();
-    struct target_t *target = state->targets_first;
+                struct kan_resource_log_secondary_input_t *output =
+                    kan_dynamic_array_add_last (&log_entry->secondary_inputs);
+                KAN_ASSERT (output)
 
-    struct kan_dynamic_array_t resources_to_mark;
-    kan_dynamic_array_init (&resources_to_mark, KAN_RESOURCE_PIPELINE_BUILD_RRDM_INITIAL,
-                            sizeof (struct resource_entry_t *), alignof (struct resource_entry_t *),
-                            temporary_allocation_group);
+                if (input->entry)
+                {
+                    output->type = input->entry->type->name;
+                    output->name = input->entry->name;
+                    output->version = input->entry->header.available_version;
+                }
+                else
+                {
+                    output->type = NULL;
+                    output->name = input->third_party_entry->name;
+                    output->version = raw_third_party_entry_get_log_version (input->third_party_entry);
+                }
+            }
 
-    while (target)
-    {
-        // We actually need to mark deployment from out of scope targets to make sure that we will not lose resources
-        // that are only referenced for deployment from out of scope targets. Therefore, `!target->marked_for_build`
-        // check is not needed here.
+            break;
+        }
 
-        for (kan_loop_size_t index = 0u; index < state->setup->reflected_data->root_resource_type_names.size; ++index)
+        case RESOURCE_PRODUCTION_CLASS_SECONDARY:
         {
-            kan_interned_string_t type_name =
-                ((kan_interned_string_t *) state->setup->reflected_data->root_resource_type_names.data)[index];
-
-            struct resource_type_container_t *container =
-                target_search_resource_type_container_unsafe (target, type_name);
-
-            if (!container)
+            struct kan_resource_log_secondary_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->secondary);
+            if (!log_entry)
             {
-                continue;
+                kan_dynamic_array_set_capacity (&log_target->secondary, log_target->secondary.size * 2u);
+                log_entry = kan_dynamic_array_add_last (&log_target->secondary);
+                KAN_ASSERT (entry)
             }
 
-            if (resources_to_mark.size + container->entries.items.size > resources_to_mark.capacity)
+            kan_resource_log_secondary_entry_init (log_entry);
+            log_entry->type = entry->type->name;
+            log_entry->name = entry->name;
+            log_entry->version = entry->header.available_version;
+
+            KAN_ASSERT (entry->header.status != RESOURCE_STATUS_PLATFORM_UNSUPPORTED)
+            if (entry->header.deployment_mark)
             {
-                kan_dynamic_array_set_capacity (
-                    &resources_to_mark,
-                    KAN_MAX (resources_to_mark.size * 2u, resources_to_mark.size + container->entries.items.size));
+                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY;
             }
-
-            struct resource_entry_t *entry = (struct resource_entry_t *) container->entries.items.first;
-            while (entry)
+            else if (entry->header.cache_mark)
             {
-                *(struct resource_entry_t **) kan_dynamic_array_add_last (&resources_to_mark) = entry;
-                entry = (struct resource_entry_t *) entry->node.list_node.next;
+                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE;
             }
-        }
-
-        target = target->next;
-    }
-
-    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Gathered %u root resources to mark for deployment.",
-             (unsigned int) resources_to_mark.size)
-    bool successful = true;
 
-    for (kan_loop_size_t index = 0u; index < resources_to_mark.size; ++index)
-    {
-        struct resource_entry_t *entry = ((struct resource_entry_t **) resources_to_mark.data)[index];
-        struct resource_response_t response =
-            execute_resource_request (state, (struct resource_request_t) {
-                                                 .from_target = entry->target,
-                                                 .type = entry->type->name,
-                                                 .name = entry->name,
-                                                 .mode = RESOURCE_REQUEST_MODE_MARK_DEPLOYMENT,
-                                                 .needed_to_build_entry = NULL,
-                                             });
+            // If we've successfully built this entry, then producer is here.
+            KAN_ASSERT (entry->build.internal_producer_entry)
+            log_entry->producer_type = entry->build.internal_producer_entry->type->name;
+            log_entry->producer_name = entry->build.internal_producer_entry->name;
+            log_entry->producer_version = entry->build.internal_producer_entry->header.available_version;
 
-        if (!response.success)
-        {
-            successful = false;
-            KAN_LOG (resource_pipeline_build, KAN_LOG_INFO,
-                     "Failed to mark root resource \"%s\" of type \"%s\" in target \"%s\" for deployment.", entry->name,
-                     entry->type->name, entry->target->name)
+            kan_dynamic_array_set_capacity (&log_entry->references, entry->new_references.size);
+            log_entry->references.size = entry->new_references.size;
+            memcpy (log_entry->references.data, entry->new_references.data,
+                    sizeof (struct kan_resource_log_reference_t) * log_entry->references.size);
+            break;
+        }
         }
     }
+    else
+    {
+        switch (entry->class)
+        {
+        case RESOURCE_PRODUCTION_CLASS_RAW:
+        {
+            struct kan_resource_log_raw_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->raw);
+            if (!log_entry)
+            {
+                kan_dynamic_array_set_capacity (&log_target->raw, log_target->raw.size * 2u);
+                log_entry = kan_dynamic_array_add_last (&log_target->raw);
+                KAN_ASSERT (entry)
+            }
 
-    kan_dynamic_array_shutdown (&resources_to_mark);
-    kan_atomic_int_lock (&state->build_queue_lock);
-    dispatch_new_tasks_from_queue_unsafe (state);
-    kan_atomic_int_unlock (&state->build_queue_lock);
-
-    const kan_time_size_t end = kan_precise_time_get_elapsed_nanoseconds ();
-    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Done marking root resources for deployment in %.3f ms.",
-             1e-6f * (float) (end - start))
-    return successful;
-}
+            // Should never get that status, only primary resources can get it.
+            KAN_ASSERT (entry->header.status != RESOURCE_STATUS_PLATFORM_UNSUPPORTED)
+            KAN_ASSERT (entry->initial_log_raw_entry)
+            kan_resource_log_raw_entry_init_copy (log_entry, entry->initial_log_raw_entry);
 
-static void append_entry_target_location_to_path_container (struct resource_entry_t *entry,
-                                                            enum deployment_step_target_location_t location,
-                                                            struct kan_file_system_path_container_t *path)
-{
-    switch (location)
-    {
-    case DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY:
-        kan_resource_build_append_deploy_path_in_workspace (path, entry->target->name, entry->type->name, entry->name);
-        break;
+            log_entry->version = entry->header.available_version;
+            log_entry->deployed = entry->header.deployment_mark;
+            break;
+        }
 
-    case DEPLOYMENT_STEP_TARGET_LOCATION_CACHE:
-        kan_resource_build_append_cache_path_in_workspace (path, entry->target->name, entry->type->name, entry->name);
-        break;
+        case RESOURCE_PRODUCTION_CLASS_PRIMARY:
+        {
+            struct kan_resource_log_built_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->built);
+            if (!log_entry)
+            {
+                kan_dynamic_array_set_capacity (&log_target->built, log_target->built.size * 2u);
+                log_entry = kan_dynamic_array_add_last (&log_target->built);
+                KAN_ASSERT (entry)
+            }
 
-    case DEPLOYMENT_STEP_TARGET_LOCATION_NONE:
-        KAN_ASSERT (false)
-        break;
-    }
-}
+            KAN_ASSERT (entry->initial_log_built_entry)
+            kan_resource_log_built_entry_init_copy (log_entry, entry->initial_log_built_entry);
+            log_entry->version = entry->header.available_version;
 
-static bool move_unchanged_resource_for_deployment (struct resource_entry_t *entry,
-                                                    enum deployment_step_target_location_t location,
-                                                    struct kan_file_system_path_container_t *reused_path)
-{
-    const kan_instance_size_t base_path_length = reused_path->length;
-    CUSHION_DEFER { kan_file_system_path_container_reset_length (reused_path, base_path_length); }
-    append_entry_target_location_to_path_container (entry, location, reused_path);
+            const struct kan_resource_reflected_data_resource_type_t *reflected_type =
+                kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data,
+                                                                         entry->type->name);
 
-    if (!kan_file_system_move_file (entry->current_file_location, reused_path->path))
-    {
-        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                             "[Target \"%s\"] Unable to move file for resource \"%s\" of type \"%s\" to path \"%s\" "
-                             "during deployment/caching.",
-                             entry->target->name, entry->name, entry->type->name, reused_path->path);
-        return false;
-    }
+            if (!reflected_type->build_rule_primary_input_type)
+            {
+                raw_third_party_entry_refresh_log_version (
+                    target_search_visible_third_party (entry->target, entry->name), &log_entry->primary_input_version);
+            }
 
-    replace_entry_current_file_location (entry, reused_path);
-    // We must update version as some OSes will change file modification timestamp when moving file.
-    struct kan_file_system_entry_status_t status;
+            for (kan_loop_size_t index = 0u; index < log_entry->secondary_inputs.size; ++index)
+            {
+                struct kan_resource_log_secondary_input_t *secondary =
+                    &((struct kan_resource_log_secondary_input_t *) log_entry->secondary_inputs.data)[index];
 
-    if (!kan_file_system_query_entry (reused_path->path, &status))
-    {
-        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                             "[Target \"%s\"] Unable to query file status for resource \"%s\" of type \"%s\" at path "
-                             "\"%s\" during deployment/caching.",
-                             entry->target->name, entry->name, entry->type->name, reused_path->path);
-        return false;
-    }
+                if (!secondary->type)
+                {
+                    raw_third_party_entry_refresh_log_version (
+                        target_search_visible_third_party (entry->target, secondary->name), &secondary->version);
+                }
+            }
 
-    entry->header.available_version.last_modification_time = status.last_modification_time_ns;
-    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-             "[Target \"%s\"] Done moving deployed/cached file for \"%s\" of type \"%s\".", entry->target->name,
-             entry->name, entry->type->name);
-    return true;
-}
+            if (entry->header.status == RESOURCE_STATUS_PLATFORM_UNSUPPORTED)
+            {
+                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_UNSUPPORTED;
+            }
+            else if (entry->header.deployment_mark)
+            {
+                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY;
+            }
+            else if (entry->header.cache_mark)
+            {
+                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE;
+            }
 
-static bool remove_unchanged_resource_from_deployment_or_cache (struct resource_entry_t *entry,
-                                                                struct kan_file_system_path_container_t *reused_path)
-{
-    if (!kan_file_system_remove_file (entry->current_file_location))
-    {
-        KAN_LOG (
-            resource_pipeline_build, KAN_LOG_ERROR,
-            "[Target \"%s\"] Failed to remove file for \"%s\" of type \"%s\" that is no longer deployed nor cached.",
-            entry->target->name, entry->name, entry->type->name);
-        return false;
-    }
+            break;
+        }
 
-    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-             "[Target \"%s\"] Done removing file for \"%s\" of type \"%s\" that is no longer deployed nor cached.",
-             entry->target->name, entry->name, entry->type->name);
-    return true;
-}
+        case RESOURCE_PRODUCTION_CLASS_SECONDARY:
+        {
+            struct kan_resource_log_secondary_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->secondary);
+            if (!log_entry)
+            {
+                kan_dynamic_array_set_capacity (&log_target->secondary, log_target->secondary.size * 2u);
+                log_entry = kan_dynamic_array_add_last (&log_target->secondary);
+                KAN_ASSERT (entry)
+            }
 
-static bool remove_changed_resource_from_old_location (struct resource_entry_t *entry,
-                                                       enum deployment_step_target_location_t old_location,
-                                                       struct kan_file_system_path_container_t *reused_path)
-{
-    if (old_location == DEPLOYMENT_STEP_TARGET_LOCATION_NONE)
-    {
-        return true;
-    }
+            // Should never get that status, only primary resources can get it.
+            KAN_ASSERT (entry->header.status != RESOURCE_STATUS_PLATFORM_UNSUPPORTED)
+            KAN_ASSERT (entry->initial_log_secondary_entry)
 
-    const kan_instance_size_t base_path_length = reused_path->length;
-    CUSHION_DEFER { kan_file_system_path_container_reset_length (reused_path, base_path_length); }
-    append_entry_target_location_to_path_container (entry, old_location, reused_path);
+            kan_resource_log_secondary_entry_init_copy (log_entry, entry->initial_log_secondary_entry);
+            log_entry->version = entry->header.available_version;
 
-    if (!kan_file_system_remove_file (reused_path->path))
-    {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to remove old deployed/cached file for \"%s\" of type \"%s\" after resource "
-                 "is changed.",
-                 entry->target->name, entry->name, entry->type->name);
-        return false;
-    }
+            if (entry->header.deployment_mark)
+            {
+                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY;
+            }
+            else if (entry->header.cache_mark)
+            {
+                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE;
+            }
 
-    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-             "[Target \"%s\"] Done removing old deployed/cached file for \"%s\" of type \"%s\" (resource is changed).",
-             entry->target->name, entry->name, entry->type->name);
-    return true;
+            break;
+        }
+        }
+    }
 }
 
-static inline bool deploy_raw_resource (struct build_state_t *state,
-                                        struct resource_entry_t *entry,
-                                        struct kan_file_system_path_container_t *reused_path)
+static bool generate_and_save_build_log (struct build_state_t *state)
 {
-    void *loaded_data = load_resource_entry_data (state, entry);
-    if (!entry)
+    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Generating and saving build log.")
+    KAN_CPU_SCOPED_STATIC_SECTION (generate_and_save_build_log)
+
+    const kan_time_size_t start = kan_precise_time_get_elapsed_nanoseconds ();
+    CUSHION_DEFER
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to deploy raw resource \"%s\" of type \"%s\" as it wasn't possible to load "
-                 "its data.",
-                 entry->target->name, entry->name, entry->type->name);
-        return false;
+        const kan_time_size_t end = kan_precise_time_get_elapsed_nanoseconds ();
+        KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Finished build log generation and saving step in %.3f ms.",
+                 1e-6f * (float) (end - start))
     }
 
-    CUSHION_DEFER
+    struct kan_resource_log_t new_log;
+    kan_resource_log_init (&new_log);
+    CUSHION_DEFER { kan_resource_log_shutdown (&new_log); }
+
+    kan_dynamic_array_set_capacity (&new_log.targets, state->setup->project->targets.size);
+    struct target_t *target = state->targets_first;
+
+    while (target)
     {
-        if (entry->type->shutdown)
+        CUSHION_DEFER { target = target->next; }
+        if (!target->marked_for_build)
         {
-            entry->type->shutdown (entry->type->functor_user_data, loaded_data);
+            if (target->initial)
+            {
+                struct kan_resource_log_target_t *log_target = kan_dynamic_array_add_last (&new_log.targets);
+                KAN_ASSERT (log_target)
+                kan_resource_log_target_init_copy (log_target, target->initial);
+            }
+
+            continue;
         }
 
-        kan_free_general (entry->allocation_group, loaded_data, entry->type->size);
+        struct kan_resource_log_target_t *log_target = kan_dynamic_array_add_last (&new_log.targets);
+        KAN_ASSERT (log_target)
+
+        kan_resource_log_target_init (log_target);
+        log_target->name = target->name;
+
+        kan_dynamic_array_set_capacity (&log_target->raw, KAN_RESOURCE_PIPELINE_BUILD_LOG_ENTRIES_CAPACITY);
+        kan_dynamic_array_set_capacity (&log_target->built, KAN_RESOURCE_PIPELINE_BUILD_LOG_ENTRIES_CAPACITY);
+        kan_dynamic_array_set_capacity (&log_target->secondary, KAN_RESOURCE_PIPELINE_BUILD_LOG_ENTRIES_CAPACITY);
+
+        struct resource_type_container_t *container =
+            (struct resource_type_container_t *) target->resource_types.items.first;
+
+        while (container)
+        {
+            struct resource_entry_t *entry = (struct resource_entry_t *) container->entries.items.first;
+            while (entry)
+            {
+                add_entry_to_build_log (state, log_target, entry);
+                entry = (struct resource_entry_t *) entry->node.list_node.next;
+            }
+
+            container = (struct resource_type_container_t *) container->node.list_node.next;
+        }
     }
 
-    const kan_instance_size_t base_path_length = reused_path->length;
-    CUSHION_DEFER { kan_file_system_path_container_reset_length (reused_path, base_path_length); }
-    append_entry_target_location_to_path_container (entry, DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY, reused_path);
+    struct kan_file_system_path_container_t resource_log_path;
+    kan_file_system_path_container_copy_string (&resource_log_path, state->setup->project->workspace_directory);
+    kan_file_system_path_container_append (&resource_log_path, KAN_RESOURCE_LOG_DEFAULT_NAME);
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_write (resource_log_path.path, true);
 
-    struct kan_stream_t *stream = kan_direct_file_stream_open_for_write (reused_path->path, true);
     if (!stream)
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to deploy raw resource \"%s\" of type \"%s\" as it wasn't possible to open "
-                 "file write stream.",
-                 entry->target->name, entry->name, entry->type->name);
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "Failed to save build log at \"%s\": unable to open write stream.",
+                             resource_log_path.path);
         return false;
     }
 
     stream = kan_random_access_stream_buffer_open_for_write (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
     CUSHION_DEFER { stream->operations->close (stream); }
 
-    if (!kan_serialization_binary_write_type_header (
-            stream, entry->type->name, KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t)))
+    if (stream->operations->write (stream, sizeof (resource_build_version), &resource_build_version) !=
+        sizeof (resource_build_version))
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to deploy raw resource \"%s\" of type \"%s\" due to failure while writing "
-                 "type header.",
-                 entry->target->name, entry->name, entry->type->name);
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "Failed to write resource build version into \"%s\".", resource_log_path.path);
         return false;
     }
 
-    kan_serialization_binary_writer_t writer =
-        kan_serialization_binary_writer_create (stream, loaded_data, entry->type->name, state->binary_script_storage,
-                                                KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
+    kan_serialization_binary_writer_t writer = kan_serialization_binary_writer_create (
+        stream, &new_log, KAN_STATIC_INTERNED_ID_GET (kan_resource_log_t), state->binary_script_storage,
+        KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
     CUSHION_DEFER { kan_serialization_binary_writer_destroy (writer); }
 
     enum kan_serialization_state_t serialization_state;
@@ -4945,737 +7319,648 @@ static inline bool deploy_raw_resource (struct build_state_t *state,
 
     if (serialization_state == KAN_SERIALIZATION_FAILED)
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Failed to deploy raw resource \"%s\" of type \"%s\" due to serialization error.",
-                 entry->target->name, entry->name, entry->type->name);
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "Failed to save build log at \"%s\": serialization error encountered.",
+                             resource_log_path.path);
         return false;
     }
 
-    // We do not update version as for deployed raw resources version of raw file is used instead of deployed file.
-    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-             "[Target \"%s\"] Done deploying raw resource file for \"%s\" of type \"%s\".", entry->target->name,
-             entry->name, entry->type->name);
     return true;
 }
 
-static inline bool move_produced_file_for_cache_or_deployment (struct resource_entry_t *entry,
-                                                               enum deployment_step_target_location_t location,
-                                                               struct kan_file_system_path_container_t *reused_path)
+static enum kan_resource_build_result_t execute_build (struct build_state_t *state)
 {
-    const kan_instance_size_t base_path_length = reused_path->length;
-    CUSHION_DEFER { kan_file_system_path_container_reset_length (reused_path, base_path_length); }
-    append_entry_target_location_to_path_container (entry, location, reused_path);
-
-    KAN_ASSERT (entry->current_file_location)
-    if (!kan_file_system_move_file (entry->current_file_location, reused_path->path))
-    {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Unable to deploy/cache \"%s\" of type \"%s\" as file move operation failed.",
-                 entry->target->name, entry->name, entry->type->name);
-        return false;
-    }
-
-    replace_entry_current_file_location (entry, reused_path);
-    // We must update version as some OSes will change file modification timestamp when moving file.
-    struct kan_file_system_entry_status_t status;
-
-    if (!kan_file_system_query_entry (reused_path->path, &status))
-    {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "[Target \"%s\"] Unable to deploy/cache \"%s\" of type \"%s\" as file status query after move failed.",
-                 entry->target->name, entry->name, entry->type->name);
-        return false;
-    }
+    const kan_time_size_t build_start = kan_precise_time_get_elapsed_nanoseconds ();
+    struct kan_file_system_path_container_t temporary_workspace;
+    kan_file_system_path_container_copy_string (&temporary_workspace, state->setup->project->workspace_directory);
+    kan_file_system_path_container_append (&temporary_workspace, KAN_RESOURCE_PROJECT_WORKSPACE_TEMPORARY_DIRECTORY);
 
-    entry->header.available_version.last_modification_time = status.last_modification_time_ns;
-    KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-             "[Target \"%s\"] Done deploying/caching file for \"%s\" of type \"%s\".", entry->target->name, entry->name,
-             entry->type->name);
-    return true;
-}
+    KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_DEBUG,
+                         "Cleaning temporary directory \"%s\".", temporary_workspace.path);
 
-static bool execute_deployment_caching_step_for_entry (struct build_state_t *state,
-                                                       struct resource_entry_t *entry,
-                                                       struct kan_file_system_path_container_t *reused_path)
-{
-    enum deployment_step_target_location_t old_location = DEPLOYMENT_STEP_TARGET_LOCATION_NONE;
-    switch (entry->class)
+    if (kan_file_system_check_existence (temporary_workspace.path))
     {
-    case RESOURCE_PRODUCTION_CLASS_RAW:
-        if (entry->initial_log_raw_entry && entry->initial_log_raw_entry->deployed)
-        {
-            old_location = DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY;
-        }
-
-        break;
-
-    case RESOURCE_PRODUCTION_CLASS_PRIMARY:
-        if (entry->initial_log_built_entry)
-        {
-            switch (entry->initial_log_built_entry->saved_directory)
-            {
-            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY:
-                old_location = DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY;
-                break;
-
-            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE:
-                old_location = DEPLOYMENT_STEP_TARGET_LOCATION_CACHE;
-                break;
-
-            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_UNSUPPORTED:
-                break;
-            }
-        }
-
-        break;
-
-    case RESOURCE_PRODUCTION_CLASS_SECONDARY:
-        if (entry->initial_log_secondary_entry)
+        if (!kan_file_system_remove_directory_with_content (temporary_workspace.path))
         {
-            switch (entry->initial_log_secondary_entry->saved_directory)
-            {
-            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY:
-                old_location = DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY;
-                break;
-
-            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE:
-                old_location = DEPLOYMENT_STEP_TARGET_LOCATION_CACHE;
-                break;
-
-            case KAN_RESOURCE_LOG_SAVED_DIRECTORY_UNSUPPORTED:
-                break;
-            }
+            KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                                 "Failed to clean temporary directory \"%s\".", temporary_workspace.path);
+            return KAN_RESOURCE_BUILD_RESULT_ERROR_BUILD_FAILED;
         }
-
-        break;
     }
 
-    enum deployment_step_target_location_t new_location = DEPLOYMENT_STEP_TARGET_LOCATION_NONE;
-    if (entry->header.deployment_mark)
+    if (!kan_file_system_make_directory (temporary_workspace.path))
     {
-        new_location = DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY;
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "Failed to create temporary directory \"%s\".", temporary_workspace.path);
+        return KAN_RESOURCE_BUILD_RESULT_ERROR_BUILD_FAILED;
     }
-    else if (entry->header.cache_mark &&
-             // Platform unsupported resources have no output and therefore there ios no physical file to cache.
-             entry->header.status != RESOURCE_STATUS_PLATFORM_UNSUPPORTED &&
-             // Raw files are preserved as raw files, so there is no sense to physically cache them.
-             // Cache mark is only needed on them to check whether they were used in build at all.
-             entry->class != RESOURCE_PRODUCTION_CLASS_RAW)
+
+    struct kan_file_system_path_container_t rule_cache_directory;
+    kan_file_system_path_container_copy_string (&rule_cache_directory, state->setup->project->workspace_directory);
+    kan_file_system_path_container_append (&rule_cache_directory, KAN_RESOURCE_PROJECT_WORKSPACE_RULE_CACHE_DIRECTORY);
+
+    if (!kan_file_system_check_existence (rule_cache_directory.path) &&
+        !kan_file_system_make_directory (rule_cache_directory.path))
     {
-        new_location = DEPLOYMENT_STEP_TARGET_LOCATION_CACHE;
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "Failed to create rule cache directory \"%s\".", rule_cache_directory.path);
+        return KAN_RESOURCE_BUILD_RESULT_ERROR_BUILD_FAILED;
     }
 
-    if (!entry->header.passed_build_routine_mark)
+    const bool marked_root_for_deployment = mark_root_for_deployment (state);
+    if (!marked_root_for_deployment)
     {
-        if (old_location != new_location)
-        {
-            switch (old_location)
-            {
-            case DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY:
-            case DEPLOYMENT_STEP_TARGET_LOCATION_CACHE:
-                switch (new_location)
-                {
-                case DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY:
-                case DEPLOYMENT_STEP_TARGET_LOCATION_CACHE:
-                    return move_unchanged_resource_for_deployment (entry, new_location, reused_path);
-
-                case DEPLOYMENT_STEP_TARGET_LOCATION_NONE:
-                    return remove_unchanged_resource_from_deployment_or_cache (entry, reused_path);
-                }
-
-                break;
-
-            case DEPLOYMENT_STEP_TARGET_LOCATION_NONE:
-                switch (new_location)
-                {
-                case DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY:
-                case DEPLOYMENT_STEP_TARGET_LOCATION_CACHE:
-                    KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                             "[Target \"%s\"] Unable to deploy/cache \"%s\" of type \"%s\" as its version was not "
-                             "changed, but there is no previous deployed/cached version.",
-                             entry->target->name, entry->name, entry->type->name);
-                    return false;
-
-                case DEPLOYMENT_STEP_TARGET_LOCATION_NONE:
-                    break;
-                }
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "Failed to mark some root resources for deployment, build result will be incomplete.")
+    }
 
+    while (true)
+    {
+        {
+            KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
+            if (state->build_queue.size == 0u && state->currently_scheduled_build_operations == 0u)
+            {
+                // Finished building, check the results.
                 break;
             }
         }
 
-        return true;
+        kan_precise_time_sleep (KAN_RESOURCE_PIPELINE_BUILD_WORKING_CHECK_DELAY_NS);
     }
 
-    remove_changed_resource_from_old_location (entry, old_location, reused_path);
-    switch (new_location)
+    const bool not_in_deadlock = state->paused_list.size == 0u;
+    if (!not_in_deadlock)
     {
-    case DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY:
-    case DEPLOYMENT_STEP_TARGET_LOCATION_CACHE:
-        switch (entry->header.status)
-        {
-        case RESOURCE_STATUS_UNCONFIRMED:
-            // Should not be able to get the mark and still be unconfirmed.
-            KAN_ASSERT (false)
-            break;
-
-        case RESOURCE_STATUS_UNAVAILABLE:
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Unable to deploy/cache \"%s\" of type \"%s\" as it is unavailable due to build "
-                     "failure.",
-                     entry->target->name, entry->name, entry->type->name);
-            return false;
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "Build finished in deadlock state. Printing locked resources and their locks.")
 
-        case RESOURCE_STATUS_BUILDING:
+        struct build_info_list_item_t *paused_list_item = (struct build_info_list_item_t *) state->paused_list.first;
+        while (paused_list_item)
+        {
+            struct resource_entry_t *entry = paused_list_item->entry;
             KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "[Target \"%s\"] Unable to deploy/cache \"%s\" of type \"%s\" as it is somehow in building "
-                     "status, usually it happens due to deadlock.",
-                     entry->target->name, entry->name, entry->type->name);
-            return false;
+                     "Entry \"%s\" of type \"%s\" from target \"%s\" is inside deadlock list.", entry->name,
+                     entry->type->name, entry->target->name)
 
-        case RESOURCE_STATUS_AVAILABLE:
-            switch (entry->class)
+            struct resource_entry_build_blocked_t *blocked = entry->build.blocked_other_first;
+            while (blocked)
             {
-            case RESOURCE_PRODUCTION_CLASS_RAW:
-                return deploy_raw_resource (state, entry, reused_path);
-
-            case RESOURCE_PRODUCTION_CLASS_PRIMARY:
-            case RESOURCE_PRODUCTION_CLASS_SECONDARY:
-                return move_produced_file_for_cache_or_deployment (entry, new_location, reused_path);
+                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                         "Entry \"%s\" of type \"%s\" from target \"%s\" blocks building of entry \"%s\" of type "
+                         "\"%s\" from target \"%s\".",
+                         entry->name, entry->type->name, entry->target->name, blocked->blocked_entry->name,
+                         blocked->blocked_entry->type->name, blocked->blocked_entry->target->name)
+                blocked = blocked->next;
             }
 
-            break;
-
-        case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
-        case RESOURCE_STATUS_OUT_OF_SCOPE:
-            // Should never get not-none build location.
-            KAN_ASSERT (false)
-            break;
+            paused_list_item = (struct build_info_list_item_t *) paused_list_item->node.next;
         }
-
-        break;
-
-    case DEPLOYMENT_STEP_TARGET_LOCATION_NONE:
-        // Nothing to do, we've just cleared old deployment and that is all we need to do.
-        break;
     }
 
-    return true;
-}
-
-static void execute_deployment_caching_step_for_target (kan_functor_user_data_t user_data)
-{
-    struct target_t *target = (struct target_t *) user_data;
-    struct build_state_t *state = target->state;
-    target->deployment_step_successful = true;
+    const bool has_no_failed_tasks = state->failed_list.size == 0u;
+    if (!has_no_failed_tasks)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR, "Build finished with failed resource build tasks.")
+        struct build_info_list_item_t *failed_list_item = (struct build_info_list_item_t *) state->failed_list.first;
 
-    struct kan_file_system_path_container_t reused_path;
-    kan_file_system_path_container_copy_string (&reused_path, state->setup->project->workspace_directory);
-    const kan_instance_size_t reused_path_base_length = reused_path.length;
+        while (failed_list_item)
+        {
+            struct resource_entry_t *entry = failed_list_item->entry;
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "Entry \"%s\" of type \"%s\" from target \"%s\" build task has failed.", entry->name,
+                     entry->type->name, entry->target->name)
+            failed_list_item = (struct build_info_list_item_t *) failed_list_item->node.next;
+        }
+    }
 
-    // Ensure deploy directory for this target is created.
-    kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_WORKSPACE_DEPLOY_DIRECTORY);
-    kan_file_system_make_directory (reused_path.path);
+    const bool deployment_successful = execute_deployment_caching_step (state);
+    const bool post_clean_done = kan_file_system_remove_directory_with_content (temporary_workspace.path);
 
-    kan_file_system_path_container_append (&reused_path, target->name);
-    kan_file_system_make_directory (reused_path.path);
-    kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
+    if (!post_clean_done)
+    {
+        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
+                             "Failed to clean temporary directory \"%s\".", temporary_workspace.path);
+    }
 
-    // Ensure cache directory for this target is created.
-    kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_WORKSPACE_CACHE_DIRECTORY);
-    kan_file_system_make_directory (reused_path.path);
+    const bool log_update_successful = generate_and_save_build_log (state);
+    state->build_wall_ns = kan_precise_time_get_elapsed_nanoseconds () - build_start;
 
-    kan_file_system_path_container_append (&reused_path, target->name);
-    kan_file_system_make_directory (reused_path.path);
-    kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
+    return marked_root_for_deployment && not_in_deadlock && has_no_failed_tasks && deployment_successful &&
+                   log_update_successful ?
+               KAN_RESOURCE_BUILD_RESULT_SUCCESS :
+               KAN_RESOURCE_BUILD_RESULT_ERROR_BUILD_FAILED;
+}
 
-    struct resource_type_container_t *container =
-        (struct resource_type_container_t *) target->resource_types.items.first;
+// Timing report step section.
 
-    while (container)
+static void add_entry_to_timing_report (struct kan_resource_timing_report_t *report, struct resource_entry_t *entry)
+{
+    struct kan_resource_timing_report_entry_t *report_entry = kan_dynamic_array_add_last (&report->entries);
+    if (!report_entry)
     {
-        // Ensure deploy directory for this resource type is created.
-        kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_WORKSPACE_DEPLOY_DIRECTORY);
-        kan_file_system_path_container_append (&reused_path, target->name);
-        kan_file_system_path_container_append (&reused_path, container->type->name);
-        kan_file_system_make_directory (reused_path.path);
-        kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
-
-        // Ensure cache directory for this resource type is created.
-        kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_WORKSPACE_CACHE_DIRECTORY);
-        kan_file_system_path_container_append (&reused_path, target->name);
-        kan_file_system_path_container_append (&reused_path, container->type->name);
-        kan_file_system_make_directory (reused_path.path);
-        kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
-
-        struct resource_entry_t *entry = (struct resource_entry_t *) container->entries.items.first;
-        while (entry)
-        {
-            target->deployment_step_successful &=
-                execute_deployment_caching_step_for_entry (state, entry, &reused_path);
-            kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
-            entry = (struct resource_entry_t *) entry->node.list_node.next;
-        }
-
-        container = (struct resource_type_container_t *) container->node.list_node.next;
+        kan_dynamic_array_set_capacity (&report->entries, KAN_MAX (1u, report->entries.size * 2u));
+        report_entry = kan_dynamic_array_add_last (&report->entries);
+        KAN_ASSERT (report_entry)
     }
 
-    // File status queries in Kan always follow symlinks, so we can just delete all symlinks for third party resources
-    // and create new ones -- timestamps will be taken from linked resources anyway.
+    report_entry->target = entry->target->name;
+    report_entry->type = entry->type->name;
+    report_entry->name = entry->name;
+    report_entry->wall_ns = entry->build_rule_wall_ns;
+    report_entry->cpu_ns = entry->build_rule_cpu_ns;
 
-    // Ensure third party deploy directory for this resource type is created.
-    kan_file_system_path_container_reset_length (&reused_path, reused_path_base_length);
-    kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_WORKSPACE_DEPLOY_DIRECTORY);
-    kan_file_system_path_container_append (&reused_path, target->name);
-    kan_file_system_path_container_append (&reused_path, KAN_RESOURCE_PROJECT_DEPLOY_THIRD_PARTY_SUBDIRECTORY);
-    const kan_instance_size_t third_party_base_length = reused_path.length;
+    report->rules_wall_ns += entry->build_rule_wall_ns;
+    report->rules_cpu_ns += entry->build_rule_cpu_ns;
+    struct kan_resource_timing_report_rule_t *rule = NULL;
 
-    if (kan_file_system_check_existence (reused_path.path))
+    // There are not that many build rules, so linear search is okay here.
+    for (kan_loop_size_t index = 0u; index < report->rules.size; ++index)
     {
-        if (!kan_file_system_remove_directory_with_content (reused_path.path))
+        struct kan_resource_timing_report_rule_t *candidate =
+            &((struct kan_resource_timing_report_rule_t *) report->rules.data)[index];
+
+        if (candidate->type == entry->type->name)
         {
-            KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                                 "[Target \"%s\"] Failed to remove third party resources deployment directory.",
-                                 target->name)
-            target->deployment_step_successful = false;
-            return;
+            rule = candidate;
+            break;
         }
     }
 
-    kan_file_system_make_directory (reused_path.path);
-    struct raw_third_party_entry_t *entry = (struct raw_third_party_entry_t *) target->raw_third_party.items.first;
-
-    while (entry)
+    if (!rule)
     {
-        if (entry->deployment_mark)
+        rule = kan_dynamic_array_add_last (&report->rules);
+        if (!rule)
         {
-            kan_file_system_path_container_append (&reused_path, entry->name);
-            CUSHION_DEFER { kan_file_system_path_container_reset_length (&reused_path, third_party_base_length); }
-
-            if (!kan_file_system_create_symbolic_link (reused_path.path, entry->file_location))
-            {
-                KAN_LOG_WITH_BUFFER (
-                    KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                    "[Target \"%s\"] Failed to create deployment symbolic link for third party resource \"%s\".",
-                    target->name, entry->name)
-                target->deployment_step_successful = false;
-            }
-
-            kan_file_system_path_container_reset_length (&reused_path, third_party_base_length);
+            kan_dynamic_array_set_capacity (&report->rules, KAN_MAX (1u, report->rules.size * 2u));
+            rule = kan_dynamic_array_add_last (&report->rules);
+            KAN_ASSERT (rule)
         }
 
-        entry = (struct raw_third_party_entry_t *) entry->node.list_node.next;
+        rule->type = entry->type->name;
+        rule->executions = 0u;
+        rule->wall_ns_total = 0u;
+        rule->wall_ns_max = 0u;
+        rule->cpu_ns_total = 0u;
     }
+
+    ++rule->executions;
+    rule->wall_ns_total += entry->build_rule_wall_ns;
+    rule->wall_ns_max = KAN_MAX (rule->wall_ns_max, entry->build_rule_wall_ns);
+    rule->cpu_ns_total += entry->build_rule_cpu_ns;
 }
 
-static bool execute_deployment_caching_step (struct build_state_t *state)
+static enum kan_resource_build_result_t save_timing_report (struct build_state_t *state)
 {
-    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Executing resource deployment and caching passes.")
-    KAN_CPU_SCOPED_STATIC_SECTION (execute_deployment_and_caching)
-    const kan_time_size_t start = kan_precise_time_get_elapsed_nanoseconds ();
+    struct kan_resource_timing_report_t report;
+    kan_resource_timing_report_init (&report);
+    CUSHION_DEFER { kan_resource_timing_report_shutdown (&report); }
 
+    report.build_wall_ns = state->build_wall_ns;
     struct target_t *target = state->targets_first;
-    kan_cpu_job_t job = kan_cpu_job_create ();
 
     while (target)
     {
-        CUSHION_DEFER { target = target->next; }
-        if (!target->marked_for_build)
-        {
-            continue;
-        }
+        struct resource_type_container_t *container =
+            (struct resource_type_container_t *) target->resource_types.items.first;
 
-        // There is not that many targets, so we can just post tasks one by one instead of using task list.
-        kan_cpu_job_dispatch_task (job, (struct kan_cpu_task_t) {
-                                            .function = execute_deployment_caching_step_for_target,
-                                            .user_data = (kan_functor_user_data_t) target,
-                                            .profiler_section = kan_cpu_section_get (target->name),
-                                        });
-    }
+        while (container)
+        {
+            struct resource_entry_t *entry = (struct resource_entry_t *) container->entries.items.first;
+            while (entry)
+            {
+                if (entry->build_rule_executed)
+                {
+                    add_entry_to_timing_report (&report, entry);
+                }
 
-    kan_cpu_job_release (job);
-    kan_cpu_job_wait (job);
+                entry = (struct resource_entry_t *) entry->node.list_node.next;
+            }
 
-    bool successful = true;
-    target = state->targets_first;
+            container = (struct resource_type_container_t *) container->node.list_node.next;
+        }
 
-    while (target)
-    {
-        successful &= target->deployment_step_successful;
         target = target->next;
     }
 
-    const kan_time_size_t end = kan_precise_time_get_elapsed_nanoseconds ();
-    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Done moving resource files for deployment and caching in %.3f ms.",
-             1e-6f * (float) (end - start))
-    return successful;
-}
-
-static void add_entry_to_build_log (struct build_state_t *state,
-                                    struct kan_resource_log_target_t *log_target,
-                                    struct resource_entry_t *entry)
-{
-    // Unless entry is marked as available or platform unsupported, it is not added to log.
-    switch (entry->header.status)
     {
-    case RESOURCE_STATUS_UNCONFIRMED:
-    case RESOURCE_STATUS_UNAVAILABLE:
-    case RESOURCE_STATUS_BUILDING:
-        return;
+        struct kan_resource_timing_report_rule_t temporary;
 
-    case RESOURCE_STATUS_AVAILABLE:
-    case RESOURCE_STATUS_PLATFORM_UNSUPPORTED:
-        break;
+#define AT_INDEX(INDEX) (((struct kan_resource_timing_report_rule_t *) report.rules.data)[INDEX])
+#define LESS(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__ AT_INDEX (first_index).wall_ns_total > AT_INDEX (second_index).wall_ns_total
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = AT_INDEX (first_index), AT_INDEX (first_index) = AT_INDEX (second_index),                              \
+    AT_INDEX (second_index) = temporary
 
-    case RESOURCE_STATUS_OUT_OF_SCOPE:
-        // Must be processed separately on target log generation level.
-        KAN_ASSERT (false)
-        return;
+        QSORT (report.rules.size, LESS, SWAP);
+#undef LESS
+#undef SWAP
+#undef AT_INDEX
     }
 
-    // Unless entry is either deployed or cached, it is not added to log.
-    if (!entry->header.deployment_mark && !entry->header.cache_mark)
     {
-        return;
+        struct kan_resource_timing_report_entry_t temporary;
+
+#define AT_INDEX(INDEX) (((struct kan_resource_timing_report_entry_t *) report.entries.data)[INDEX])
+#define LESS(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__ AT_INDEX (first_index).wall_ns > AT_INDEX (second_index).wall_ns
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = AT_INDEX (first_index), AT_INDEX (first_index) = AT_INDEX (second_index),                              \
+    AT_INDEX (second_index) = temporary
+
+        QSORT (report.entries.size, LESS, SWAP);
+#undef LESS
+#undef SWAP
+#undef AT_INDEX
     }
 
-    if (entry->header.passed_build_routine_mark)
+    struct kan_stream_t *stream = kan_direct_file_stream_open_for_write (state->setup->timing_report_path, true);
+    if (!stream)
     {
-        switch (entry->class)
-        {
-        case RESOURCE_PRODUCTION_CLASS_RAW:
-        {
-            struct kan_resource_log_raw_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->raw);
-            if (!log_entry)
-            {
-                kan_dynamic_array_set_capacity (&log_target->raw, log_target->raw.size * 2u);
-                log_entry = kan_dynamic_array_add_last (&log_target->raw);
-                KAN_ASSERT (entry)
-            }
+        // Timing report is a diagnostic output, so we do not fail the build if it cannot be saved.
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "Failed to save timing report at \"%s\": unable to open write stream.",
+                 state->setup->timing_report_path);
+        return KAN_RESOURCE_BUILD_RESULT_SUCCESS;
+    }
 
-            kan_resource_log_raw_entry_init (log_entry);
-            log_entry->type = entry->type->name;
-            log_entry->name = entry->name;
-            log_entry->version = entry->header.available_version;
-            log_entry->deployed = entry->header.deployment_mark;
+    stream = kan_random_access_stream_buffer_open_for_write (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
+    CUSHION_DEFER { stream->operations->close (stream); }
 
-            kan_dynamic_array_set_capacity (&log_entry->references, entry->new_references.size);
-            log_entry->references.size = entry->new_references.size;
-            memcpy (log_entry->references.data, entry->new_references.data,
-                    sizeof (struct kan_resource_log_reference_t) * log_entry->references.size);
-            break;
-        }
+    // Report types are part of resource pipeline unit, so we can always use its local reflection for saving.
+    kan_reflection_registry_t local_registry = kan_reflection_registry_create ();
+    CUSHION_DEFER { kan_reflection_registry_destroy (local_registry); }
+    KAN_REFLECTION_UNIT_REGISTRAR_NAME (resource_pipeline) (local_registry);
 
-        case RESOURCE_PRODUCTION_CLASS_PRIMARY:
-        {
-            struct kan_resource_log_built_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->built);
-            if (!log_entry)
-            {
-                kan_dynamic_array_set_capacity (&log_target->built, log_target->built.size * 2u);
-                log_entry = kan_dynamic_array_add_last (&log_target->built);
-                KAN_ASSERT (entry)
-            }
+    kan_serialization_rd_writer_t writer = kan_serialization_rd_writer_create (
+        stream, &report, KAN_STATIC_INTERNED_ID_GET (kan_resource_timing_report_t), local_registry);
+    CUSHION_DEFER { kan_serialization_rd_writer_destroy (writer); }
 
-            kan_resource_log_built_entry_init (log_entry);
-            log_entry->type = entry->type->name;
-            log_entry->name = entry->name;
-            log_entry->version = entry->header.available_version;
+    enum kan_serialization_state_t serialization_state;
+    while ((serialization_state = kan_serialization_rd_writer_step (writer)) == KAN_SERIALIZATION_IN_PROGRESS)
+    {
+    }
 
-            const struct kan_resource_reflected_data_resource_type_t *reflected_type =
-                kan_resource_reflected_data_storage_query_resource_type (state->setup->reflected_data,
-                                                                         entry->type->name);
+    if (serialization_state == KAN_SERIALIZATION_FAILED)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "Failed to save timing report at \"%s\": serialization error encountered.",
+                 state->setup->timing_report_path);
+        return KAN_RESOURCE_BUILD_RESULT_SUCCESS;
+    }
 
-            if (reflected_type->build_rule_platform_configuration_type)
-            {
-                const struct platform_configuration_entry_t *platform_configuration =
-                    build_state_find_platform_configuration (state,
-                                                             reflected_type->build_rule_platform_configuration_type);
+    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO,
+             "Saved timing report for %lu build rule executions with %.3f ms wall time and %.3f ms CPU time in total "
+             "to \"%s\".",
+             (unsigned long) report.entries.size, 1e-6 * (double) report.rules_wall_ns,
+             1e-6 * (double) report.rules_cpu_ns, state->setup->timing_report_path)
+    return KAN_RESOURCE_BUILD_RESULT_SUCCESS;
+}
 
-                // If we've successfully built this entry, then configuration is here.
-                KAN_ASSERT (platform_configuration)
-                log_entry->platform_configuration_time = platform_configuration->file_time;
-            }
-            else
-            {
-                log_entry->platform_configuration_time = 0u;
-            }
+// Artifact and rule cache step section.
 
-            log_entry->rule_version = reflected_type->build_rule_version;
-            if (reflected_type->build_rule_primary_input_type)
-            {
-                // If we've successfully built this entry, then primary input is here.
-                KAN_ASSERT (entry->build.internal_primary_input_entry)
-                log_entry->primary_input_version = entry->build.internal_primary_input_entry->header.available_version;
-            }
-            else
-            {
-                // If we've successfully built this entry, then primary input is here.
-                KAN_ASSERT (entry->build.internal_primary_input_third_party)
-                log_entry->primary_input_version.type_version = 0u;
-                log_entry->primary_input_version.last_modification_time =
-                    entry->build.internal_primary_input_third_party->last_modification_time;
-            }
+static enum kan_resource_build_result_t prepare_artifact_cache (struct build_state_t *state)
+{
+    if (!kan_file_system_make_directory (state->setup->artifact_cache_directory))
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR, "Failed to make artifact cache directory at \"%s\".",
+                 state->setup->artifact_cache_directory);
+        return KAN_RESOURCE_BUILD_RESULT_ERROR_ARTIFACT_CACHE_CANNOT_MAKE_DIRECTORY;
+    }
 
-            if (entry->header.status == RESOURCE_STATUS_PLATFORM_UNSUPPORTED)
-            {
-                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_UNSUPPORTED;
-            }
-            else if (entry->header.deployment_mark)
-            {
-                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY;
-            }
-            else if (entry->header.cache_mark)
-            {
-                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE;
-            }
+    return KAN_RESOURCE_BUILD_RESULT_SUCCESS;
+}
 
-            kan_dynamic_array_set_capacity (&log_entry->references, entry->new_references.size);
-            log_entry->references.size = entry->new_references.size;
+/// \brief Artifact and rule cache file names are generated by us and are short, so we can store them inline.
+/// \details Rule cache file names include type names, therefore limit is bigger than needed for artifact cache.
+#define CACHE_FILE_NAME_MAX_LENGTH 128u
 
-            memcpy (log_entry->references.data, entry->new_references.data,
-                    sizeof (struct kan_resource_log_reference_t) * log_entry->references.size);
-            kan_dynamic_array_set_capacity (&log_entry->secondary_inputs, entry->new_build_secondary_inputs.size);
+struct cache_file_t
+{
+    char name[CACHE_FILE_NAME_MAX_LENGTH];
+    kan_file_size_t size;
+    kan_time_size_t last_modification_time;
+};
 
-            for (kan_loop_size_t index = 0u; index < entry->new_build_secondary_inputs.size; ++index)
-            {
-                struct new_build_secondary_input_t *input =
-                    &((struct new_build_secondary_input_t *) entry->new_build_secondary_inputs.data)[index];
+static inline bool is_cache_file_name (const char *name, kan_instance_size_t length)
+{
+    return length < CACHE_FILE_NAME_MAX_LENGTH && length > 4u && strcmp (name + length - 4u, ".bin") == 0;
+}
 
-                struct kan_resource_log_secondary_input_t *output =
-                    kan_dynamic_array_add_last (&log_entry->secondary_inputs);
-                KAN_ASSERT (output)
+static inline bool is_cache_temporary_file_name (const char *name, kan_instance_size_t length)
+{
+    return length < CACHE_FILE_NAME_MAX_LENGTH && length > 4u && strcmp (name + length - 4u, ".tmp") == 0;
+}
 
-                if (input->entry)
-                {
-                    output->type = input->entry->type->name;
-                    output->name = input->entry->name;
-                    output->version = input->entry->header.available_version;
-                }
-                else
-                {
-                    output->type = NULL;
-                    output->name = input->third_party_entry->name;
-                    output->version.type_version = 0u;
-                    output->version.last_modification_time = input->third_party_entry->last_modification_time;
-                }
-            }
+/// \brief Evicts least recently used files from cache directory until it fits into the size limit.
+/// \details Used for both artifact cache and rule cache, as they have the same flat layout of `.bin` files with
+///          temporary `.tmp` files used for atomic stores. Never fails the build as cache trimming is an optional
+///          maintenance operation. If other build is already trimming the same cache, trimming is skipped. Temporary
+///          files might belong to builds that are storing data right now, therefore they are only removed when they
+///          are stale, which means that build that has written them has most likely crashed.
+static void trim_cache_directory (const char *directory, kan_file_size_t size_limit, const char *cache_name)
+{
+    if (!kan_file_system_lock_file_create (directory, KAN_FILE_SYSTEM_LOCK_FILE_QUIET))
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Skipping %s trimming as it is locked by other build.",
+                 cache_name);
+        return;
+    }
 
-            break;
-        }
+    CUSHION_DEFER { kan_file_system_lock_file_destroy (directory, KAN_FILE_SYSTEM_LOCK_FILE_QUIET); }
+    kan_file_system_directory_iterator_t iterator = kan_file_system_directory_iterator_create (directory);
 
-        case RESOURCE_PRODUCTION_CLASS_SECONDARY:
-        {
-            struct kan_resource_log_secondary_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->secondary);
-            if (!log_entry)
-            {
-                kan_dynamic_array_set_capacity (&log_target->secondary, log_target->secondary.size * 2u);
-                log_entry = kan_dynamic_array_add_last (&log_target->secondary);
-                KAN_ASSERT (entry)
-            }
+    if (!KAN_HANDLE_IS_VALID (iterator))
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "Skipping %s trimming as it is not possible to iterate its directory \"%s\".", cache_name, directory);
+        return;
+    }
 
-            kan_resource_log_secondary_entry_init (log_entry);
-            log_entry->type = entry->type->name;
-            log_entry->name = entry->name;
-            log_entry->version = entry->header.available_version;
+    struct kan_dynamic_array_t files;
+    kan_dynamic_array_init (&files, KAN_RESOURCE_PIPELINE_BUILD_ARTIFACT_CACHE_FILES_CAPACITY,
+                            sizeof (struct cache_file_t), alignof (struct cache_file_t), temporary_allocation_group);
+    CUSHION_DEFER { kan_dynamic_array_shutdown (&files); }
 
-            KAN_ASSERT (entry->header.status != RESOURCE_STATUS_PLATFORM_UNSUPPORTED)
-            if (entry->header.deployment_mark)
-            {
-                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY;
-            }
-            else if (entry->header.cache_mark)
-            {
-                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE;
-            }
+    struct kan_file_system_path_container_t path_container;
+    kan_file_system_path_container_copy_string (&path_container, directory);
+    const kan_instance_size_t base_length = path_container.length;
 
-            // If we've successfully built this entry, then producer is here.
-            KAN_ASSERT (entry->build.internal_producer_entry)
-            log_entry->producer_type = entry->build.internal_producer_entry->type->name;
-            log_entry->producer_name = entry->build.internal_producer_entry->name;
-            log_entry->producer_version = entry->build.internal_producer_entry->header.available_version;
+    const kan_time_size_t current_time = kan_precise_time_get_epoch_nanoseconds_utc ();
+    kan_file_size_t total_size = 0u;
+    const char *name;
 
-            kan_dynamic_array_set_capacity (&log_entry->references, entry->new_references.size);
-            log_entry->references.size = entry->new_references.size;
-            memcpy (log_entry->references.data, entry->new_references.data,
-                    sizeof (struct kan_resource_log_reference_t) * log_entry->references.size);
-            break;
-        }
-        }
-    }
-    else
+    while ((name = kan_file_system_directory_iterator_advance (iterator)))
     {
-        switch (entry->class)
-        {
-        case RESOURCE_PRODUCTION_CLASS_RAW:
+        const kan_instance_size_t name_length = (kan_instance_size_t) strlen (name);
+        const bool temporary = is_cache_temporary_file_name (name, name_length);
+
+        if (!temporary && !is_cache_file_name (name, name_length))
         {
-            struct kan_resource_log_raw_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->raw);
-            if (!log_entry)
-            {
-                kan_dynamic_array_set_capacity (&log_target->raw, log_target->raw.size * 2u);
-                log_entry = kan_dynamic_array_add_last (&log_target->raw);
-                KAN_ASSERT (entry)
-            }
+            continue;
+        }
 
-            // Should never get that status, only primary resources can get it.
-            KAN_ASSERT (entry->header.status != RESOURCE_STATUS_PLATFORM_UNSUPPORTED)
-            KAN_ASSERT (entry->initial_log_raw_entry)
-            kan_resource_log_raw_entry_init_copy (log_entry, entry->initial_log_raw_entry);
+        kan_file_system_path_container_reset_length (&path_container, base_length);
+        kan_file_system_path_container_append (&path_container, name);
+        struct kan_file_system_entry_status_t status;
 
-            log_entry->version = entry->header.available_version;
-            log_entry->deployed = entry->header.deployment_mark;
-            break;
+        if (!kan_file_system_query_entry (path_container.path, &status) ||
+            status.type != KAN_FILE_SYSTEM_ENTRY_TYPE_FILE)
+        {
+            continue;
         }
 
-        case RESOURCE_PRODUCTION_CLASS_PRIMARY:
+        if (temporary)
         {
-            struct kan_resource_log_built_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->built);
-            if (!log_entry)
-            {
-                kan_dynamic_array_set_capacity (&log_target->built, log_target->built.size * 2u);
-                log_entry = kan_dynamic_array_add_last (&log_target->built);
-                KAN_ASSERT (entry)
-            }
-
-            KAN_ASSERT (entry->initial_log_built_entry)
-            kan_resource_log_built_entry_init_copy (log_entry, entry->initial_log_built_entry);
-            log_entry->version = entry->header.available_version;
-
-            if (entry->header.status == RESOURCE_STATUS_PLATFORM_UNSUPPORTED)
-            {
-                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_UNSUPPORTED;
-            }
-            else if (entry->header.deployment_mark)
-            {
-                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY;
-            }
-            else if (entry->header.cache_mark)
+            if (current_time > status.last_modification_time_ns &&
+                current_time - status.last_modification_time_ns > KAN_RESOURCE_PIPELINE_BUILD_ARTIFACT_CACHE_STALE_NS)
             {
-                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE;
+                KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Removing stale temporary %s file \"%s\".", cache_name,
+                         name);
+                kan_file_system_remove_file (path_container.path);
             }
 
-            break;
+            continue;
         }
 
-        case RESOURCE_PRODUCTION_CLASS_SECONDARY:
+        struct cache_file_t *file = kan_dynamic_array_add_last (&files);
+        if (!file)
         {
-            struct kan_resource_log_secondary_entry_t *log_entry = kan_dynamic_array_add_last (&log_target->secondary);
-            if (!log_entry)
-            {
-                kan_dynamic_array_set_capacity (&log_target->secondary, log_target->secondary.size * 2u);
-                log_entry = kan_dynamic_array_add_last (&log_target->secondary);
-                KAN_ASSERT (entry)
-            }
+            kan_dynamic_array_set_capacity (&files, files.size * 2u);
+            file = kan_dynamic_array_add_last (&files);
+            KAN_ASSERT (file)
+        }
+
+        memcpy (file->name, name, name_length + 1u);
+        file->size = status.size;
+        file->last_modification_time = status.last_modification_time_ns;
+        total_size += status.size;
+    }
+
+    kan_file_system_directory_iterator_destroy (iterator);
+    if (total_size <= size_limit)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_INFO,
+                 "Cache \"%s\" contains %lu files with total size %llu bytes, no need to evict anything.", cache_name,
+                 (unsigned long) files.size, (unsigned long long) total_size);
+        return;
+    }
+
+    {
+        struct cache_file_t temporary;
 
-            // Should never get that status, only primary resources can get it.
-            KAN_ASSERT (entry->header.status != RESOURCE_STATUS_PLATFORM_UNSUPPORTED)
-            KAN_ASSERT (entry->initial_log_secondary_entry)
+#define AT_INDEX(INDEX) (((struct cache_file_t *) files.data)[INDEX])
+#define LESS(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__ AT_INDEX (first_index).last_modification_time < AT_INDEX (second_index).last_modification_time
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = AT_INDEX (first_index), AT_INDEX (first_index) = AT_INDEX (second_index),                              \
+    AT_INDEX (second_index) = temporary
 
-            kan_resource_log_secondary_entry_init_copy (log_entry, entry->initial_log_secondary_entry);
-            log_entry->version = entry->header.available_version;
+        QSORT (files.size, LESS, SWAP);
+#undef LESS
+#undef SWAP
+#undef AT_INDEX
+    }
 
-            if (entry->header.deployment_mark)
-            {
-                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_DEPLOY;
-            }
-            else if (entry->header.cache_mark)
-            {
-                log_entry->saved_directory = KAN_RESOURCE_LOG_SAVED_DIRECTORY_CACHE;
-            }
+    kan_instance_size_t evicted_count = 0u;
+    for (kan_loop_size_t index = 0u; index < files.size && total_size > size_limit; ++index)
+    {
+        const struct cache_file_t *file = &((struct cache_file_t *) files.data)[index];
+        kan_file_system_path_container_reset_length (&path_container, base_length);
+        kan_file_system_path_container_append (&path_container, file->name);
 
-            break;
-        }
+        if (kan_file_system_remove_file (path_container.path))
+        {
+            total_size -= file->size;
+            ++evicted_count;
         }
     }
+
+    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO,
+             "Evicted %lu least recently used files from %s, its total size is now %llu bytes.",
+             (unsigned long) evicted_count, cache_name, (unsigned long long) total_size);
 }
 
-static bool generate_and_save_build_log (struct build_state_t *state)
+static enum kan_resource_build_result_t trim_artifact_cache (struct build_state_t *state)
 {
-    KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Generating and saving build log.")
-    KAN_CPU_SCOPED_STATIC_SECTION (generate_and_save_build_log)
+    trim_cache_directory (state->setup->artifact_cache_directory, state->setup->artifact_cache_size_limit,
+                          "artifact cache");
+    return KAN_RESOURCE_BUILD_RESULT_SUCCESS;
+}
 
-    const kan_time_size_t start = kan_precise_time_get_elapsed_nanoseconds ();
-    CUSHION_DEFER
+static enum kan_resource_build_result_t trim_rule_cache (struct build_state_t *state)
+{
+    struct kan_file_system_path_container_t rule_cache_directory;
+    kan_file_system_path_container_copy_string (&rule_cache_directory, state->setup->project->workspace_directory);
+    kan_file_system_path_container_append (&rule_cache_directory, KAN_RESOURCE_PROJECT_WORKSPACE_RULE_CACHE_DIRECTORY);
+
+    if (kan_file_system_check_existence (rule_cache_directory.path))
     {
-        const kan_time_size_t end = kan_precise_time_get_elapsed_nanoseconds ();
-        KAN_LOG (resource_pipeline_build, KAN_LOG_INFO, "Finished build log generation and saving step in %.3f ms.",
-                 1e-6f * (float) (end - start))
+        trim_cache_directory (rule_cache_directory.path, state->setup->rule_cache_size_limit, "rule cache");
     }
 
-    struct kan_resource_log_t new_log;
-    kan_resource_log_init (&new_log);
-    CUSHION_DEFER { kan_resource_log_shutdown (&new_log); }
+    return KAN_RESOURCE_BUILD_RESULT_SUCCESS;
+}
 
-    kan_dynamic_array_set_capacity (&new_log.targets, state->setup->project->targets.size);
-    struct target_t *target = state->targets_first;
+#undef CACHE_FILE_NAME_MAX_LENGTH
 
-    while (target)
-    {
-        CUSHION_DEFER { target = target->next; }
-        if (!target->marked_for_build)
-        {
-            if (target->initial)
-            {
-                struct kan_resource_log_target_t *log_target = kan_dynamic_array_add_last (&new_log.targets);
-                KAN_ASSERT (log_target)
-                kan_resource_log_target_init_copy (log_target, target->initial);
-            }
+// Pack step implementation section.
 
-            continue;
-        }
+/// \brief Pack generation context for one target.
+/// \details Packing is split into several phases: preparation, staging, appending and finalization. Staging is done in
+///          parallel for batches of entries from all targets: entries are encoded into staging buffers without touching
+///          the pack. Then staged batches are appended to packs in the same order in which entries were sorted, so
+///          pack layout does not depend on how staging tasks were scheduled. Staging is done in windows of limited
+///          size, so staging buffers are reused and memory usage does not grow with the target size.
+struct pack_target_context_t
+{
+    struct target_t *target;
+    struct kan_dynamic_array_t entries_to_pack;
+    struct kan_dynamic_array_t third_party_to_pack;
+    kan_loop_size_t entry_types_count;
+    kan_loop_size_t next_entry_to_stage;
 
-        struct kan_resource_log_target_t *log_target = kan_dynamic_array_add_last (&new_log.targets);
-        KAN_ASSERT (log_target)
+    struct kan_stream_t *output_stream;
+    kan_virtual_file_system_read_only_pack_builder_t builder;
 
-        kan_resource_log_target_init (log_target);
-        log_target->name = target->name;
+    /// \brief Interned string registry for interned pack mode.
+    /// \details String indices depend on the order in which strings were first added. In order to keep pack output
+    ///          deterministic, staging tasks never add new strings to this registry: strings are collected by batches
+    ///          into their local registries first and then merged into this registry in entry order.
+    kan_serialization_interned_string_registry_t interned_string_registry;
 
-        kan_dynamic_array_set_capacity (&log_target->raw, KAN_RESOURCE_PIPELINE_BUILD_LOG_ENTRIES_CAPACITY);
-        kan_dynamic_array_set_capacity (&log_target->built, KAN_RESOURCE_PIPELINE_BUILD_LOG_ENTRIES_CAPACITY);
-        kan_dynamic_array_set_capacity (&log_target->secondary, KAN_RESOURCE_PIPELINE_BUILD_LOG_ENTRIES_CAPACITY);
+    struct kan_resource_index_t resource_index;
+    const struct kan_reflection_struct_t *last_addition_type;
+    struct kan_resource_index_container_t *last_addition_container;
 
-        struct resource_type_container_t *container =
-            (struct resource_type_container_t *) target->resource_types.items.first;
+    struct pack_staging_batch_t *first_batch_in_window;
+    kan_loop_size_t batches_in_window;
+};
 
-        while (container)
-        {
-            struct resource_entry_t *entry = (struct resource_entry_t *) container->entries.items.first;
-            while (entry)
-            {
-                add_entry_to_build_log (state, log_target, entry);
-                entry = (struct resource_entry_t *) entry->node.list_node.next;
-            }
+/// \brief Staging batch of sequential entries from one pack target context.
+struct pack_staging_batch_t
+{
+    struct pack_target_context_t *context;
+    kan_loop_size_t first_entry_index;
+    kan_loop_size_t entries_count;
 
-            container = (struct resource_type_container_t *) container->node.list_node.next;
-        }
+    /// \brief Data of all batch entries, written one after another.
+    struct kan_dynamic_array_t data;
+
+    /// \brief Sizes of entries data in ::data, in the same order as entries.
+    struct kan_dynamic_array_t sizes;
+
+    /// \brief Registry for collecting strings of batch entries in interned pack mode before merging them.
+    kan_serialization_interned_string_registry_t local_registry;
+
+    bool successful;
+};
+
+/// \brief Write-only stream that appends everything to staging batch data.
+struct pack_staging_stream_t
+{
+    struct kan_stream_t stream;
+    struct kan_dynamic_array_t *output;
+};
+
+static bool pack_entry_sort_comparator (struct resource_entry_t *left, struct resource_entry_t *right)
+{
+    if (left->type == right->type)
+    {
+        return strcmp (left->name, right->name) < 0;
     }
 
-    struct kan_file_system_path_container_t resource_log_path;
-    kan_file_system_path_container_copy_string (&resource_log_path, state->setup->project->workspace_directory);
-    kan_file_system_path_container_append (&resource_log_path, KAN_RESOURCE_LOG_DEFAULT_NAME);
-    struct kan_stream_t *stream = kan_direct_file_stream_open_for_write (resource_log_path.path, true);
+    return strcmp (left->type->name, right->type->name) < 0;
+}
 
-    if (!stream)
+static inline void pack_staging_ensure_capacity (struct kan_dynamic_array_t *output, kan_instance_size_t required)
+{
+    if (required > output->capacity)
     {
-        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                             "Failed to save build log at \"%s\": unable to open write stream.",
-                             resource_log_path.path);
+        kan_dynamic_array_set_capacity (output, KAN_MAX (required, output->capacity * 2u));
+    }
+}
+
+static kan_file_size_t pack_staging_stream_write (struct kan_stream_t *stream,
+                                                  kan_file_size_t amount,
+                                                  const void *input_buffer)
+{
+    struct pack_staging_stream_t *staging_stream = (struct pack_staging_stream_t *) stream;
+    struct kan_dynamic_array_t *output = staging_stream->output;
+
+    pack_staging_ensure_capacity (output, output->size + (kan_instance_size_t) amount);
+    memcpy (output->data + output->size, input_buffer, amount);
+    output->size += (kan_instance_size_t) amount;
+    return amount;
+}
+
+static bool pack_staging_stream_flush (struct kan_stream_t *stream)
+{
+    // Everything is already in memory, nothing to flush.
+    return true;
+}
+
+static void pack_staging_stream_close (struct kan_stream_t *stream)
+{
+    // Staging stream is always allocated on stack and does not own the output.
+}
+
+static struct kan_stream_operations_t pack_staging_stream_operations = {
+    .read = NULL,
+    .write = pack_staging_stream_write,
+    .flush = pack_staging_stream_flush,
+    .tell = NULL,
+    .seek = NULL,
+    .close = pack_staging_stream_close,
+};
+
+static bool pack_stage_interned_entry (struct pack_staging_batch_t *batch,
+                                       struct resource_entry_t *entry,
+                                       kan_serialization_interned_string_registry_t registry)
+{
+    struct pack_target_context_t *context = batch->context;
+    struct build_state_t *state = context->target->state;
+    void *loaded_data = load_resource_entry_data (state, entry);
+
+    if (!loaded_data)
+    {
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to load resource \"%s\" of type \"%s\" in order to do string interning and "
+                 "pack it.",
+                 context->target->name, entry->name, entry->type->name)
         return false;
     }
 
-    stream = kan_random_access_stream_buffer_open_for_write (stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
-    CUSHION_DEFER { stream->operations->close (stream); }
+    CUSHION_DEFER
+    {
+        if (entry->type->shutdown)
+        {
+            entry->type->shutdown (entry->type->functor_user_data, loaded_data);
+        }
 
-    if (stream->operations->write (stream, sizeof (resource_build_version), &resource_build_version) !=
-        sizeof (resource_build_version))
+        kan_free_general (entry->allocation_group, loaded_data, entry->type->size);
+    }
+
+    struct pack_staging_stream_t staging_stream = {
+        .stream = {.operations = &pack_staging_stream_operations},
+        .output = &batch->data,
+    };
+
+    if (!kan_serialization_binary_write_type_header (&staging_stream.stream, entry->type->name, registry))
     {
-        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                             "Failed to write resource build version into \"%s\".", resource_log_path.path);
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to stage resource \"%s\" of type \"%s\" due to failure while writing type "
+                 "header.",
+                 context->target->name, entry->name, entry->type->name)
         return false;
     }
 
-    kan_serialization_binary_writer_t writer = kan_serialization_binary_writer_create (
-        stream, &new_log, KAN_STATIC_INTERNED_ID_GET (kan_resource_log_t), state->binary_script_storage,
-        KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
+    kan_serialization_binary_writer_t writer =
+        kan_serialization_binary_writer_create (&staging_stream.stream, loaded_data, entry->type->name,
+                                                state->binary_script_storage, registry);
     CUSHION_DEFER { kan_serialization_binary_writer_destroy (writer); }
 
     enum kan_serialization_state_t serialization_state;
@@ -5685,150 +7970,244 @@ static bool generate_and_save_build_log (struct build_state_t *state)
 
     if (serialization_state == KAN_SERIALIZATION_FAILED)
     {
-        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                             "Failed to save build log at \"%s\": serialization error encountered.",
-                             resource_log_path.path);
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to stage resource \"%s\" of type \"%s\" due to serialization error while "
+                 "resaving with string registry.",
+                 context->target->name, entry->name, entry->type->name)
         return false;
     }
 
     return true;
 }
 
-static enum kan_resource_build_result_t execute_build (struct build_state_t *state)
+static bool pack_stage_regular_entry (struct pack_staging_batch_t *batch, struct resource_entry_t *entry)
 {
-    struct kan_file_system_path_container_t temporary_workspace;
-    kan_file_system_path_container_copy_string (&temporary_workspace, state->setup->project->workspace_directory);
-    kan_file_system_path_container_append (&temporary_workspace, KAN_RESOURCE_PROJECT_WORKSPACE_TEMPORARY_DIRECTORY);
-
-    KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_DEBUG,
-                         "Cleaning temporary directory \"%s\".", temporary_workspace.path);
+    struct pack_target_context_t *context = batch->context;
+    struct build_state_t *state = context->target->state;
+    struct kan_file_system_path_container_t input_path;
 
-    if (kan_file_system_check_existence (temporary_workspace.path))
+    switch (entry->class)
     {
-        if (!kan_file_system_remove_directory_with_content (temporary_workspace.path))
-        {
-            KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                                 "Failed to clean temporary directory \"%s\".", temporary_workspace.path);
-            return KAN_RESOURCE_BUILD_RESULT_ERROR_BUILD_FAILED;
-        }
+    case RESOURCE_PRODUCTION_CLASS_RAW:
+        kan_file_system_path_container_copy_string (&input_path, state->setup->project->workspace_directory);
+        append_entry_target_location_to_path_container (entry, DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY, &input_path);
+        break;
+
+    case RESOURCE_PRODUCTION_CLASS_PRIMARY:
+    case RESOURCE_PRODUCTION_CLASS_SECONDARY:
+        kan_file_system_path_container_copy_string (&input_path, entry->current_file_location);
+        break;
     }
 
-    if (!kan_file_system_make_directory (temporary_workspace.path))
+    struct kan_stream_t *entry_stream = kan_direct_file_stream_open_for_read (input_path.path, true);
+    if (!entry_stream)
     {
-        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                             "Failed to create temporary directory \"%s\".", temporary_workspace.path);
-        return KAN_RESOURCE_BUILD_RESULT_ERROR_BUILD_FAILED;
+        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                 "[Target \"%s\"] Failed to open input stream to resource \"%s\" of type \"%s\" in order to pack it.",
+                 context->target->name, entry->name, entry->type->name)
+        return false;
     }
 
-    const bool marked_root_for_deployment = mark_root_for_deployment (state);
-    if (!marked_root_for_deployment)
+    CUSHION_DEFER { entry_stream->operations->close (entry_stream); }
+    struct kan_file_system_entry_status_t status;
+
+    if (!kan_file_system_query_entry (input_path.path, &status))
     {
         KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "Failed to mark some root resources for deployment, build result will be incomplete.")
+                 "[Target \"%s\"] Failed to query size of resource \"%s\" of type \"%s\" in order to pack it.",
+                 context->target->name, entry->name, entry->type->name)
+        return false;
     }
 
-    while (true)
+    struct kan_dynamic_array_t *output = &batch->data;
+    pack_staging_ensure_capacity (output, output->size + (kan_instance_size_t) status.size);
+    kan_file_size_t left_to_read = status.size;
+
+    while (left_to_read > 0u)
     {
+        const kan_file_size_t read =
+            entry_stream->operations->read (entry_stream, left_to_read, output->data + output->size);
+
+        if (read == 0u)
         {
-            KAN_ATOMIC_INT_SCOPED_LOCK (&state->build_queue_lock)
-            if (state->build_queue.size == 0u && state->currently_scheduled_build_operations == 0u)
-            {
-                // Finished building, check the results.
-                break;
-            }
+            // Short read is an error, as file size is already known: it is either an IO error or file was modified
+            // during packing. In both cases we cannot produce a correct pack.
+            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
+                     "[Target \"%s\"] Failed to read resource \"%s\" of type \"%s\" in order to pack it: expected "
+                     "%llu more bytes.",
+                     context->target->name, entry->name, entry->type->name, (unsigned long long) left_to_read)
+            return false;
         }
 
-        kan_precise_time_sleep (KAN_RESOURCE_PIPELINE_BUILD_WORKING_CHECK_DELAY_NS);
+        output->size += (kan_instance_size_t) read;
+        left_to_read -= read;
     }
 
-    const bool not_in_deadlock = state->paused_list.size == 0u;
-    if (!not_in_deadlock)
+    uint8_t excess_byte;
+    if (entry_stream->operations->read (entry_stream, 1u, &excess_byte) != 0u)
     {
         KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                 "Build finished in deadlock state. Printing locked resources and their locks.")
+                 "[Target \"%s\"] Failed to pack resource \"%s\" of type \"%s\" as it has grown while being read.",
+                 context->target->name, entry->name, entry->type->name)
+        return false;
+    }
 
-        struct build_info_list_item_t *paused_list_item = (struct build_info_list_item_t *) state->paused_list.first;
-        while (paused_list_item)
+    return true;
+}
+
+static void execute_pack_stage_batch (kan_functor_user_data_t user_data)
+{
+    struct pack_staging_batch_t *batch = (struct pack_staging_batch_t *) user_data;
+    struct pack_target_context_t *context = batch->context;
+    batch->successful = true;
+
+    for (kan_loop_size_t index = 0u; index < batch->entries_count; ++index)
+    {
+        struct resource_entry_t *entry =
+            ((struct resource_entry_t **) context->entries_to_pack.data)[batch->first_entry_index + index];
+        const kan_instance_size_t size_before = batch->data.size;
+
+        if (KAN_HANDLE_IS_VALID (context->interned_string_registry))
         {
-            struct resource_entry_t *entry = paused_list_item->entry;
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "Entry \"%s\" of type \"%s\" from target \"%s\" is inside deadlock list.", entry->name,
-                     entry->type->name, entry->target->name)
+            batch->successful = pack_stage_interned_entry (batch, entry, context->interned_string_registry);
+        }
+        else
+        {
+            batch->successful = pack_stage_regular_entry (batch, entry);
+        }
 
-            struct resource_entry_build_blocked_t *blocked = entry->build.blocked_other_first;
-            while (blocked)
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "Entry \"%s\" of type \"%s\" from target \"%s\" blocks building of entry \"%s\" of type "
-                         "\"%s\" from target \"%s\".",
-                         entry->name, entry->type->name, entry->target->name, blocked->blocked_entry->name,
-                         blocked->blocked_entry->type->name, blocked->blocked_entry->target->name)
-                blocked = blocked->next;
+        if (!batch->successful)
+        {
+            return;
+        }
+
+        kan_file_size_t *size = kan_dynamic_array_add_last (&batch->sizes);
+        if (!size)
+        {
+            kan_dynamic_array_set_capacity (&batch->sizes, batch->sizes.size * 2u);
+            size = kan_dynamic_array_add_last (&batch->sizes);
+        }
+
+        *size = (kan_file_size_t) (batch->data.size - size_before);
+    }
+}
+
+static void execute_pack_collect_strings_batch (kan_functor_user_data_t user_data)
+{
+    struct pack_staging_batch_t *batch = (struct pack_staging_batch_t *) user_data;
+    struct pack_target_context_t *context = batch->context;
+    batch->successful = true;
+
+    for (kan_loop_size_t index = 0u; index < batch->entries_count; ++index)
+    {
+        struct resource_entry_t *entry =
+            ((struct resource_entry_t **) context->entries_to_pack.data)[batch->first_entry_index + index];
+
+        // Staged data is only needed to collect strings, it will be staged again once strings are merged.
+        batch->successful = pack_stage_interned_entry (batch, entry, batch->local_registry);
+        batch->data.size = 0u;
+
+        if (!batch->successful)
+        {
+            return;
+        }
+    }
+}
+
+/// \brief Merges strings collected by batches into target registries in entry order and destroys local registries.
+static void execute_pack_merge_collected_strings (struct kan_dynamic_array_t *contexts)
+{
+    for (kan_loop_size_t context_index = 0u; context_index < contexts->size; ++context_index)
+    {
+        struct pack_target_context_t *context = &((struct pack_target_context_t *) contexts->data)[context_index];
+        for (kan_loop_size_t batch_index = 0u; batch_index < context->batches_in_window; ++batch_index)
+        {
+            struct pack_staging_batch_t *batch = &context->first_batch_in_window[batch_index];
+            if (!batch->successful)
+            {
+                context->target->pack_step_successful = false;
+            }
+            else if (context->target->pack_step_successful)
+            {
+                kan_serialization_interned_string_registry_merge (context->interned_string_registry,
+                                                                  batch->local_registry);
             }
 
-            paused_list_item = (struct build_info_list_item_t *) paused_list_item->node.next;
+            kan_serialization_interned_string_registry_destroy (batch->local_registry);
+            batch->local_registry = KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t);
         }
     }
+}
 
-    const bool has_no_failed_tasks = state->failed_list.size == 0u;
-    if (!has_no_failed_tasks)
+/// \brief Dispatches given function for every batch in window that belongs to successful target and waits for them.
+static void execute_pack_for_every_batch (struct kan_dynamic_array_t *batches,
+                                          kan_instance_size_t batches_used,
+                                          kan_cpu_task_function_t function)
+{
+    kan_cpu_job_t job = kan_cpu_job_create ();
+    for (kan_loop_size_t index = 0u; index < batches_used; ++index)
     {
-        KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR, "Build finished with failed resource build tasks.")
-        struct build_info_list_item_t *failed_list_item = (struct build_info_list_item_t *) state->failed_list.first;
-
-        while (failed_list_item)
+        struct pack_staging_batch_t *batch = &((struct pack_staging_batch_t *) batches->data)[index];
+        if (!batch->context->target->pack_step_successful)
         {
-            struct resource_entry_t *entry = failed_list_item->entry;
-            KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                     "Entry \"%s\" of type \"%s\" from target \"%s\" build task has failed.", entry->name,
-                     entry->type->name, entry->target->name)
-            failed_list_item = (struct build_info_list_item_t *) failed_list_item->node.next;
+            continue;
         }
-    }
-
-    const bool deployment_successful = execute_deployment_caching_step (state);
-    const bool post_clean_done = kan_file_system_remove_directory_with_content (temporary_workspace.path);
 
-    if (!post_clean_done)
-    {
-        KAN_LOG_WITH_BUFFER (KAN_FILE_SYSTEM_MAX_PATH_LENGTH * 2u, resource_pipeline_build, KAN_LOG_ERROR,
-                             "Failed to clean temporary directory \"%s\".", temporary_workspace.path);
+        // Window size is limited, so we can just post tasks one by one instead of using task list.
+        kan_cpu_job_dispatch_task (job, (struct kan_cpu_task_t) {
+                                            .function = function,
+                                            .user_data = (kan_functor_user_data_t) batch,
+                                            .profiler_section = kan_cpu_section_get (batch->context->target->name),
+                                        });
     }
 
-    const bool log_update_successful = generate_and_save_build_log (state);
-    return marked_root_for_deployment && not_in_deadlock && has_no_failed_tasks && deployment_successful &&
-                   log_update_successful ?
-               KAN_RESOURCE_BUILD_RESULT_SUCCESS :
-               KAN_RESOURCE_BUILD_RESULT_ERROR_BUILD_FAILED;
+    kan_cpu_job_release (job);
+    kan_cpu_job_wait (job);
 }
 
-// Pack step implementation section.
-
-static bool pack_entry_sort_comparator (struct resource_entry_t *left, struct resource_entry_t *right)
+static void pack_add_to_index (struct pack_target_context_t *context,
+                               struct resource_entry_t *entry,
+                               struct kan_file_system_path_container_t *path_container,
+                               kan_file_size_t size)
 {
-    if (left->type == right->type)
+    // Entries must be sorted by types first, so we do not need to search anything.
+    if (context->last_addition_type != entry->type)
     {
-        return strcmp (left->name, right->name) < 0;
+        context->last_addition_type = entry->type;
+        context->last_addition_container = kan_dynamic_array_add_last (&context->resource_index.containers);
+
+        kan_resource_index_container_init (context->last_addition_container);
+        context->last_addition_container->type = entry->type->name;
+        kan_dynamic_array_set_capacity (&context->last_addition_container->items,
+                                        KAN_RESOURCE_PIPELINE_BUILD_PACK_INDEX_ITEM_CAPACITY);
     }
 
-    return strcmp (left->type->name, right->type->name) < 0;
+    struct kan_resource_index_item_t *item = kan_dynamic_array_add_last (&context->last_addition_container->items);
+    if (!item)
+    {
+        kan_dynamic_array_set_capacity (&context->last_addition_container->items,
+                                        context->last_addition_container->items.size * 2u);
+        item = kan_dynamic_array_add_last (&context->last_addition_container->items);
+    }
+
+    kan_resource_index_item_init (item);
+    item->name = entry->name;
+    item->size = size;
+
+    item->path = kan_allocate_general (kan_resource_index_get_allocation_group (), path_container->length + 1u,
+                                       alignof (char));
+    memcpy (item->path, path_container->path, path_container->length + 1u);
 }
 
-static void execute_pack_for_target (kan_functor_user_data_t user_data)
+static void execute_pack_prepare_target (kan_functor_user_data_t user_data)
 {
-    struct target_t *target = (struct target_t *) user_data;
+    struct pack_target_context_t *context = (struct pack_target_context_t *) user_data;
+    struct target_t *target = context->target;
     struct build_state_t *state = target->state;
     target->pack_step_successful = true;
 
-    struct kan_dynamic_array_t entries_to_pack;
-    kan_dynamic_array_init (&entries_to_pack, KAN_RESOURCE_PIPELINE_BUILD_PACK_ENTRIES_CAPACITY,
-                            sizeof (struct resource_entry_t *), alignof (struct resource_entry_t *),
-                            temporary_allocation_group);
-    CUSHION_DEFER { kan_dynamic_array_shutdown (&entries_to_pack); }
-
     struct resource_type_container_t *container =
         (struct resource_type_container_t *) target->resource_types.items.first;
-    kan_loop_size_t entry_types_count = 0u;
 
     while (container)
     {
@@ -5839,11 +8218,11 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
         {
             if (entry->header.deployment_mark)
             {
-                struct resource_entry_t **spot = kan_dynamic_array_add_last (&entries_to_pack);
+                struct resource_entry_t **spot = kan_dynamic_array_add_last (&context->entries_to_pack);
                 if (!spot)
                 {
-                    kan_dynamic_array_set_capacity (&entries_to_pack, entries_to_pack.size * 2u);
-                    spot = kan_dynamic_array_add_last (&entries_to_pack);
+                    kan_dynamic_array_set_capacity (&context->entries_to_pack, context->entries_to_pack.size * 2u);
+                    spot = kan_dynamic_array_add_last (&context->entries_to_pack);
                 }
 
                 *spot = entry;
@@ -5855,7 +8234,7 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
 
         if (any_added)
         {
-            ++entry_types_count;
+            ++context->entry_types_count;
         }
 
         container = (struct resource_type_container_t *) container->node.list_node.next;
@@ -5864,7 +8243,7 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
     {
         struct resource_entry_t *temporary;
 
-#define AT_INDEX(INDEX) (((struct resource_entry_t **) entries_to_pack.data)[INDEX])
+#define AT_INDEX(INDEX) (((struct resource_entry_t **) context->entries_to_pack.data)[INDEX])
 #define LESS(first_index, second_index)                                                                                \
     __CUSHION_PRESERVE__ pack_entry_sort_comparator (AT_INDEX (first_index), AT_INDEX (second_index))
 #define SWAP(first_index, second_index)                                                                                \
@@ -5872,18 +8251,12 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
     temporary = AT_INDEX (first_index), AT_INDEX (first_index) = AT_INDEX (second_index),                              \
     AT_INDEX (second_index) = temporary
 
-        QSORT (entries_to_pack.size, LESS, SWAP);
+        QSORT (context->entries_to_pack.size, LESS, SWAP);
 #undef LESS
 #undef SWAP
 #undef AT_INDEX
     }
 
-    struct kan_dynamic_array_t third_party_to_pack;
-    kan_dynamic_array_init (&third_party_to_pack, KAN_RESOURCE_PIPELINE_BUILD_PACK_THIRD_PARTY_CAPACITY,
-                            sizeof (struct raw_third_party_entry_t *), alignof (struct raw_third_party_entry_t *),
-                            temporary_allocation_group);
-
-    CUSHION_DEFER { kan_dynamic_array_shutdown (&third_party_to_pack); }
     struct raw_third_party_entry_t *third_party_entry =
         (struct raw_third_party_entry_t *) target->raw_third_party.items.first;
 
@@ -5891,11 +8264,11 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
     {
         if (third_party_entry->deployment_mark)
         {
-            struct raw_third_party_entry_t **spot = kan_dynamic_array_add_last (&third_party_to_pack);
+            struct raw_third_party_entry_t **spot = kan_dynamic_array_add_last (&context->third_party_to_pack);
             if (!spot)
             {
-                kan_dynamic_array_set_capacity (&third_party_to_pack, third_party_to_pack.size * 2u);
-                spot = kan_dynamic_array_add_last (&third_party_to_pack);
+                kan_dynamic_array_set_capacity (&context->third_party_to_pack, context->third_party_to_pack.size * 2u);
+                spot = kan_dynamic_array_add_last (&context->third_party_to_pack);
             }
 
             *spot = third_party_entry;
@@ -5907,7 +8280,7 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
     {
         struct raw_third_party_entry_t *temporary;
 
-#define AT_INDEX(INDEX) (((struct raw_third_party_entry_t **) entries_to_pack.data)[INDEX])
+#define AT_INDEX(INDEX) (((struct raw_third_party_entry_t **) context->third_party_to_pack.data)[INDEX])
 #define LESS(first_index, second_index)                                                                                \
     __CUSHION_PRESERVE__ strcmp (AT_INDEX (first_index)->name, AT_INDEX (second_index)->name) < 0
 #define SWAP(first_index, second_index)                                                                                \
@@ -5915,7 +8288,7 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
     temporary = AT_INDEX (first_index), AT_INDEX (first_index) = AT_INDEX (second_index),                              \
     AT_INDEX (second_index) = temporary
 
-        QSORT (entries_to_pack.size, LESS, SWAP);
+        QSORT (context->third_party_to_pack.size, LESS, SWAP);
 #undef LESS
 #undef SWAP
 #undef AT_INDEX
@@ -5935,30 +8308,17 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
         return;
     }
 
-    pack_output_stream =
+    context->output_stream =
         kan_random_access_stream_buffer_open_for_write (pack_output_stream, KAN_RESOURCE_PIPELINE_BUILD_IO_BUFFER);
-    CUSHION_DEFER { pack_output_stream->operations->close (pack_output_stream); }
+    context->builder = kan_virtual_file_system_read_only_pack_builder_create ();
 
-    kan_virtual_file_system_read_only_pack_builder_t pack_builder =
-        kan_virtual_file_system_read_only_pack_builder_create ();
-    CUSHION_DEFER { kan_virtual_file_system_read_only_pack_builder_destroy (pack_builder); }
-
-    if (!kan_virtual_file_system_read_only_pack_builder_begin (pack_builder, pack_output_stream))
+    if (!kan_virtual_file_system_read_only_pack_builder_begin (context->builder, context->output_stream))
     {
         KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR, "[Target \"%s\"] Pack builder start failure.", target->name);
         target->pack_step_successful = false;
         return;
     }
 
-    kan_serialization_interned_string_registry_t interned_string_registry = KAN_HANDLE_INITIALIZE_INVALID;
-    CUSHION_DEFER
-    {
-        if (KAN_HANDLE_IS_VALID (interned_string_registry))
-        {
-            kan_serialization_interned_string_registry_destroy (interned_string_registry);
-        }
-    }
-
     switch (state->setup->pack_mode)
     {
     case KAN_RESOURCE_BUILD_PACK_MODE_NONE:
@@ -5970,136 +8330,50 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
         break;
 
     case KAN_RESOURCE_BUILD_PACK_MODE_INTERNED:
-        interned_string_registry = kan_serialization_interned_string_registry_create_empty ();
+        context->interned_string_registry = kan_serialization_interned_string_registry_create_empty ();
         break;
     }
 
+    kan_dynamic_array_set_capacity (&context->resource_index.containers, context->entry_types_count);
     KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG, "[Target \"%s\"] Going to pack %lu resources.", target->name,
-             (unsigned long) entries_to_pack.size)
-
-    struct kan_resource_index_t resource_index;
-    kan_resource_index_init (&resource_index);
-    kan_dynamic_array_set_capacity (&resource_index.containers, entry_types_count);
-    CUSHION_DEFER { kan_resource_index_shutdown (&resource_index); }
+             (unsigned long) context->entries_to_pack.size)
+}
 
-    const struct kan_reflection_struct_t *last_addition_type = NULL;
-    struct kan_resource_index_container_t *last_addition_container = NULL;
+static void execute_pack_append_staged (kan_functor_user_data_t user_data)
+{
+    struct pack_target_context_t *context = (struct pack_target_context_t *) user_data;
+    struct target_t *target = context->target;
+    struct kan_file_system_path_container_t path_container;
 
-    for (kan_loop_size_t index = 0u; index < entries_to_pack.size; ++index)
+    for (kan_loop_size_t batch_index = 0u; batch_index < context->batches_in_window; ++batch_index)
     {
-        struct resource_entry_t *entry = ((struct resource_entry_t **) entries_to_pack.data)[index];
-        KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
-                 "[Target \"%s\"] (%lu/%lu) Adding entry \"%s\" of type \"%s\" to pack.", target->name,
-                 (unsigned long) (index + 1u), (unsigned long) entries_to_pack.size, entry->name, entry->type->name)
-
-        kan_file_system_path_container_copy_string (&path_container, entry->type->name);
-        kan_file_system_path_container_append (&path_container, entry->name);
-        kan_file_system_path_container_add_suffix (&path_container, ".bin");
-
-        if (KAN_HANDLE_IS_VALID (interned_string_registry))
+        struct pack_staging_batch_t *batch = &context->first_batch_in_window[batch_index];
+        if (!batch->successful)
         {
-            void *loaded_data = load_resource_entry_data (state, entry);
-            if (!entry)
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "[Target \"%s\"] Failed to load resource \"%s\" of type \"%s\" in order to do string "
-                         "interning and pack it.",
-                         target->name, entry->name, entry->type->name)
-
-                target->pack_step_successful = false;
-                return;
-            }
-
-            CUSHION_DEFER
-            {
-                if (entry->type->shutdown)
-                {
-                    entry->type->shutdown (entry->type->functor_user_data, loaded_data);
-                }
-
-                kan_free_general (entry->allocation_group, loaded_data, entry->type->size);
-            }
-
-            struct kan_stream_t *entry_stream =
-                kan_virtual_file_system_read_only_pack_builder_add_streamed (pack_builder, path_container.path);
-
-            if (!entry_stream)
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "[Target \"%s\"] Failed to add resource \"%s\" of type \"%s\" to pack.", target->name,
-                         entry->name, entry->type->name)
-
-                target->pack_step_successful = false;
-                return;
-            }
-
-            CUSHION_DEFER { entry_stream->operations->close (entry_stream); }
-            if (!kan_serialization_binary_write_type_header (entry_stream, entry->type->name, interned_string_registry))
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "[Target \"%s\"] Failed to add resource \"%s\" of type \"%s\" due to failure while writing "
-                         "type header.",
-                         target->name, entry->name, entry->type->name)
-
-                target->pack_step_successful = false;
-                return;
-            }
-
-            kan_serialization_binary_writer_t writer = kan_serialization_binary_writer_create (
-                entry_stream, loaded_data, entry->type->name, state->binary_script_storage, interned_string_registry);
-            CUSHION_DEFER { kan_serialization_binary_writer_destroy (writer); }
-
-            enum kan_serialization_state_t serialization_state;
-            while ((serialization_state = kan_serialization_binary_writer_step (writer)) ==
-                   KAN_SERIALIZATION_IN_PROGRESS)
-            {
-            }
+            target->pack_step_successful = false;
+            return;
+        }
 
-            if (serialization_state == KAN_SERIALIZATION_FAILED)
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "[Target \"%s\"] Failed to add resource \"%s\" of type \"%s\" due to serialization error "
-                         "while resaving with string registry.",
-                         target->name, entry->name, entry->type->name)
+        KAN_ASSERT (batch->sizes.size == batch->entries_count)
+        const uint8_t *data = batch->data.data;
 
-                target->pack_step_successful = false;
-                return;
-            }
-        }
-        else
+        for (kan_loop_size_t index = 0u; index < batch->entries_count; ++index)
         {
-            struct kan_stream_t *entry_stream = NULL;
-            switch (entry->class)
-            {
-            case RESOURCE_PRODUCTION_CLASS_RAW:
-            {
-                struct kan_file_system_path_container_t deploy_path;
-                kan_file_system_path_container_copy_string (&deploy_path, state->setup->project->workspace_directory);
-                append_entry_target_location_to_path_container (entry, DEPLOYMENT_STEP_TARGET_LOCATION_DEPLOY,
-                                                                &deploy_path);
-                entry_stream = kan_direct_file_stream_open_for_read (deploy_path.path, true);
-                break;
-            }
-
-            case RESOURCE_PRODUCTION_CLASS_PRIMARY:
-            case RESOURCE_PRODUCTION_CLASS_SECONDARY:
-                entry_stream = kan_direct_file_stream_open_for_read (entry->current_file_location, true);
-                break;
-            }
+            const kan_loop_size_t entry_index = batch->first_entry_index + index;
+            struct resource_entry_t *entry = ((struct resource_entry_t **) context->entries_to_pack.data)[entry_index];
+            const kan_file_size_t size = ((kan_file_size_t *) batch->sizes.data)[index];
 
-            if (!entry_stream)
-            {
-                KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
-                         "[Target \"%s\"] Failed to open input stream to resource \"%s\" of type \"%s\" in order to "
-                         "pack it.",
-                         target->name, entry->name, entry->type->name)
+            KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
+                     "[Target \"%s\"] (%lu/%lu) Adding entry \"%s\" of type \"%s\" to pack.", target->name,
+                     (unsigned long) (entry_index + 1u), (unsigned long) context->entries_to_pack.size, entry->name,
+                     entry->type->name)
 
-                target->pack_step_successful = false;
-                return;
-            }
+            kan_file_system_path_container_copy_string (&path_container, entry->type->name);
+            kan_file_system_path_container_append (&path_container, entry->name);
+            kan_file_system_path_container_add_suffix (&path_container, ".bin");
 
-            CUSHION_DEFER { entry_stream->operations->close (entry_stream); }
-            if (!kan_virtual_file_system_read_only_pack_builder_add (pack_builder, entry_stream, path_container.path))
+            if (!kan_virtual_file_system_read_only_pack_builder_add_blob (context->builder, data, size,
+                                                                          path_container.path))
             {
                 KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
                          "[Target \"%s\"] Failed to add resource \"%s\" of type \"%s\" to pack.", target->name,
@@ -6107,49 +8381,33 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
                 target->pack_step_successful = false;
                 return;
             }
-        }
-
-        // Now add entry to the index too.
-
-        // Entries must be sorted by types first, so we do not need to search anything.
-        if (last_addition_type != entry->type)
-        {
-            last_addition_type = entry->type;
-            last_addition_container = kan_dynamic_array_add_last (&resource_index.containers);
 
-            kan_resource_index_container_init (last_addition_container);
-            last_addition_container->type = entry->type->name;
-            kan_dynamic_array_set_capacity (&last_addition_container->items,
-                                            KAN_RESOURCE_PIPELINE_BUILD_PACK_INDEX_ITEM_CAPACITY);
-        }
-
-        struct kan_resource_index_item_t *item = kan_dynamic_array_add_last (&last_addition_container->items);
-        if (!item)
-        {
-            kan_dynamic_array_set_capacity (&last_addition_container->items, last_addition_container->items.size * 2u);
-            item = kan_dynamic_array_add_last (&last_addition_container->items);
+            data += size;
+            pack_add_to_index (context, entry, &path_container, size);
         }
-
-        kan_resource_index_item_init (item);
-        item->name = entry->name;
-
-        item->path = kan_allocate_general (kan_resource_index_get_allocation_group (), path_container.length + 1u,
-                                           alignof (char));
-        memcpy (item->path, path_container.path, path_container.length + 1u);
     }
+}
 
-    if (third_party_to_pack.size > 0u)
+static void execute_pack_finalize_target (kan_functor_user_data_t user_data)
+{
+    struct pack_target_context_t *context = (struct pack_target_context_t *) user_data;
+    struct target_t *target = context->target;
+    struct build_state_t *state = target->state;
+    struct kan_file_system_path_container_t path_container;
+
+    if (context->third_party_to_pack.size > 0u)
     {
-        kan_dynamic_array_set_capacity (&resource_index.third_party_items,
+        kan_dynamic_array_set_capacity (&context->resource_index.third_party_items,
                                         KAN_RESOURCE_PIPELINE_BUILD_PACK_INDEX_TPI_CAPACITY);
     }
 
-    for (kan_loop_size_t index = 0u; index < third_party_to_pack.size; ++index)
+    for (kan_loop_size_t index = 0u; index < context->third_party_to_pack.size; ++index)
     {
-        struct raw_third_party_entry_t *entry = ((struct raw_third_party_entry_t **) third_party_to_pack.data)[index];
+        struct raw_third_party_entry_t *entry =
+            ((struct raw_third_party_entry_t **) context->third_party_to_pack.data)[index];
         KAN_LOG (resource_pipeline_build, KAN_LOG_DEBUG,
                  "[Target \"%s\"] (%lu/%lu) Adding third party entry \"%s\" to pack.", target->name,
-                 (unsigned long) (index + 1u), (unsigned long) entries_to_pack.size, entry->name)
+                 (unsigned long) (index + 1u), (unsigned long) context->third_party_to_pack.size, entry->name)
 
         kan_file_system_path_container_copy_string (&path_container,
                                                     KAN_RESOURCE_PROJECT_DEPLOY_THIRD_PARTY_SUBDIRECTORY);
@@ -6167,7 +8425,7 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
             return;
         }
 
-        if (!kan_virtual_file_system_read_only_pack_builder_add (pack_builder, entry_stream, path_container.path))
+        if (!kan_virtual_file_system_read_only_pack_builder_add (context->builder, entry_stream, path_container.path))
         {
             KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR,
                      "[Target \"%s\"] Failed to add third party resource \"%s\" to pack.", target->name, entry->name)
@@ -6177,17 +8435,24 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
         }
 
         entry_stream->operations->close (entry_stream);
-        struct kan_resource_index_item_t *item = kan_dynamic_array_add_last (&resource_index.third_party_items);
+        struct kan_resource_index_item_t *item =
+            kan_dynamic_array_add_last (&context->resource_index.third_party_items);
 
         if (!item)
         {
-            kan_dynamic_array_set_capacity (&resource_index.third_party_items,
-                                            resource_index.third_party_items.size * 2u);
-            item = kan_dynamic_array_add_last (&resource_index.third_party_items);
+            kan_dynamic_array_set_capacity (&context->resource_index.third_party_items,
+                                            context->resource_index.third_party_items.size * 2u);
+            item = kan_dynamic_array_add_last (&context->resource_index.third_party_items);
         }
 
         kan_resource_index_item_init (item);
         item->name = entry->name;
+        struct kan_file_system_entry_status_t status;
+
+        if (kan_file_system_query_entry (entry->file_location, &status))
+        {
+            item->size = status.size;
+        }
 
         item->path = kan_allocate_general (kan_resource_index_get_allocation_group (), path_container.length + 1u,
                                            alignof (char));
@@ -6196,8 +8461,8 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
 
     // In scope to always close the addition stream properly.
     {
-        struct kan_stream_t *index_stream =
-            kan_virtual_file_system_read_only_pack_builder_add_streamed (pack_builder, KAN_RESOURCE_INDEX_DEFAULT_NAME);
+        struct kan_stream_t *index_stream = kan_virtual_file_system_read_only_pack_builder_add_streamed (
+            context->builder, KAN_RESOURCE_INDEX_DEFAULT_NAME);
 
         if (!index_stream)
         {
@@ -6209,8 +8474,8 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
 
         CUSHION_DEFER { index_stream->operations->close (index_stream); }
         kan_serialization_binary_writer_t writer = kan_serialization_binary_writer_create (
-            index_stream, &resource_index, KAN_STATIC_INTERNED_ID_GET (kan_resource_index_t),
-            state->binary_script_storage, interned_string_registry);
+            index_stream, &context->resource_index, KAN_STATIC_INTERNED_ID_GET (kan_resource_index_t),
+            state->binary_script_storage, context->interned_string_registry);
         CUSHION_DEFER { kan_serialization_binary_writer_destroy (writer); }
 
         enum kan_serialization_state_t serialization_state;
@@ -6228,10 +8493,10 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
     }
 
     // If registry exists, it must be packed after the index as index might add strings to it.
-    if (KAN_HANDLE_IS_VALID (interned_string_registry))
+    if (KAN_HANDLE_IS_VALID (context->interned_string_registry))
     {
         struct kan_stream_t *registry_stream = kan_virtual_file_system_read_only_pack_builder_add_streamed (
-            pack_builder, KAN_RESOURCE_INDEX_ACCOMPANYING_STRING_REGISTRY_DEFAULT_NAME);
+            context->builder, KAN_RESOURCE_INDEX_ACCOMPANYING_STRING_REGISTRY_DEFAULT_NAME);
 
         if (!registry_stream)
         {
@@ -6244,7 +8509,8 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
 
         CUSHION_DEFER { registry_stream->operations->close (registry_stream); }
         kan_serialization_interned_string_registry_writer_t writer =
-            kan_serialization_interned_string_registry_writer_create (registry_stream, interned_string_registry);
+            kan_serialization_interned_string_registry_writer_create (registry_stream,
+                                                                      context->interned_string_registry);
         CUSHION_DEFER { kan_serialization_interned_string_registry_writer_destroy (writer); }
 
         enum kan_serialization_state_t serialization_state;
@@ -6264,7 +8530,7 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
         }
     }
 
-    if (!kan_virtual_file_system_read_only_pack_builder_finalize (pack_builder))
+    if (!kan_virtual_file_system_read_only_pack_builder_finalize (context->builder))
     {
         KAN_LOG (resource_pipeline_build, KAN_LOG_ERROR, "[Target \"%s\"] Failed to finalize pack building procedure.",
                  target->name)
@@ -6272,37 +8538,202 @@ static void execute_pack_for_target (kan_functor_user_data_t user_data)
     }
 }
 
-static enum kan_resource_build_result_t execute_pack (struct build_state_t *state)
+/// \brief Dispatches given function for every pack target context that is still successful and waits for completion.
+/// \details Waiting is always done from the build procedure thread, so pack tasks never wait for other tasks.
+static void execute_pack_for_every_context (struct kan_dynamic_array_t *contexts,
+                                            kan_cpu_task_function_t function,
+                                            bool only_with_staged_batches)
 {
-    struct target_t *target = state->targets_first;
     kan_cpu_job_t job = kan_cpu_job_create ();
-
-    while (target)
+    for (kan_loop_size_t index = 0u; index < contexts->size; ++index)
     {
-        CUSHION_DEFER { target = target->next; }
-        if (!target->marked_for_build)
+        struct pack_target_context_t *context = &((struct pack_target_context_t *) contexts->data)[index];
+        if (!context->target->pack_step_successful || (only_with_staged_batches && context->batches_in_window == 0u))
         {
             continue;
         }
 
         // There is not that many targets, so we can just post tasks one by one instead of using task list.
         kan_cpu_job_dispatch_task (job, (struct kan_cpu_task_t) {
-                                            .function = execute_pack_for_target,
-                                            .user_data = (kan_functor_user_data_t) target,
-                                            .profiler_section = kan_cpu_section_get (target->name),
+                                            .function = function,
+                                            .user_data = (kan_functor_user_data_t) context,
+                                            .profiler_section = kan_cpu_section_get (context->target->name),
                                         });
     }
 
     kan_cpu_job_release (job);
     kan_cpu_job_wait (job);
+}
+
+static enum kan_resource_build_result_t execute_pack (struct build_state_t *state)
+{
+    struct kan_dynamic_array_t contexts;
+    kan_dynamic_array_init (&contexts, 0u, sizeof (struct pack_target_context_t),
+                            alignof (struct pack_target_context_t), temporary_allocation_group);
+    CUSHION_DEFER { kan_dynamic_array_shutdown (&contexts); }
+
+    kan_instance_size_t marked_targets = 0u;
+    for (struct target_t *target = state->targets_first; target; target = target->next)
+    {
+        marked_targets += target->marked_for_build ? 1u : 0u;
+    }
+
+    kan_dynamic_array_set_capacity (&contexts, marked_targets);
+    for (struct target_t *target = state->targets_first; target; target = target->next)
+    {
+        if (!target->marked_for_build)
+        {
+            continue;
+        }
+
+        struct pack_target_context_t *context = kan_dynamic_array_add_last (&contexts);
+        context->target = target;
+
+        kan_dynamic_array_init (&context->entries_to_pack, KAN_RESOURCE_PIPELINE_BUILD_PACK_ENTRIES_CAPACITY,
+                                sizeof (struct resource_entry_t *), alignof (struct resource_entry_t *),
+                                temporary_allocation_group);
+
+        kan_dynamic_array_init (&context->third_party_to_pack, KAN_RESOURCE_PIPELINE_BUILD_PACK_THIRD_PARTY_CAPACITY,
+                                sizeof (struct raw_third_party_entry_t *), alignof (struct raw_third_party_entry_t *),
+                                temporary_allocation_group);
+
+        context->entry_types_count = 0u;
+        context->next_entry_to_stage = 0u;
+        context->output_stream = NULL;
+        context->builder = KAN_HANDLE_SET_INVALID (kan_virtual_file_system_read_only_pack_builder_t);
+        context->interned_string_registry = KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t);
+        kan_resource_index_init (&context->resource_index);
+        context->last_addition_type = NULL;
+        context->last_addition_container = NULL;
+        context->first_batch_in_window = NULL;
+        context->batches_in_window = 0u;
+    }
+
+    CUSHION_DEFER
+    {
+        for (kan_loop_size_t index = 0u; index < contexts.size; ++index)
+        {
+            struct pack_target_context_t *context = &((struct pack_target_context_t *) contexts.data)[index];
+            kan_dynamic_array_shutdown (&context->entries_to_pack);
+            kan_dynamic_array_shutdown (&context->third_party_to_pack);
+            kan_resource_index_shutdown (&context->resource_index);
+
+            if (KAN_HANDLE_IS_VALID (context->interned_string_registry))
+            {
+                kan_serialization_interned_string_registry_destroy (context->interned_string_registry);
+            }
+
+            if (KAN_HANDLE_IS_VALID (context->builder))
+            {
+                kan_virtual_file_system_read_only_pack_builder_destroy (context->builder);
+            }
+
+            if (context->output_stream)
+            {
+                context->output_stream->operations->close (context->output_stream);
+            }
+        }
+    }
+
+    execute_pack_for_every_context (&contexts, execute_pack_prepare_target, false);
+
+    // Staging buffers are reused between windows, so their capacity quickly settles at the size of the biggest batch.
+    const kan_instance_size_t window_batches =
+        KAN_MAX (1u, state->max_simultaneous_build_operations * KAN_RESOURCE_PIPELINE_BUILD_PACK_BATCHES_PER_CORE);
+
+    struct kan_dynamic_array_t batches;
+    kan_dynamic_array_init (&batches, window_batches, sizeof (struct pack_staging_batch_t),
+                            alignof (struct pack_staging_batch_t), temporary_allocation_group);
+
+    CUSHION_DEFER
+    {
+        for (kan_loop_size_t index = 0u; index < batches.size; ++index)
+        {
+            struct pack_staging_batch_t *batch = &((struct pack_staging_batch_t *) batches.data)[index];
+            kan_dynamic_array_shutdown (&batch->data);
+            kan_dynamic_array_shutdown (&batch->sizes);
+
+            if (KAN_HANDLE_IS_VALID (batch->local_registry))
+            {
+                kan_serialization_interned_string_registry_destroy (batch->local_registry);
+            }
+        }
+
+        kan_dynamic_array_shutdown (&batches);
+    }
+
+    for (kan_loop_size_t index = 0u; index < window_batches; ++index)
+    {
+        struct pack_staging_batch_t *batch = kan_dynamic_array_add_last (&batches);
+        kan_dynamic_array_init (&batch->data, KAN_RESOURCE_PIPELINE_BUILD_PACK_STAGING_CAPACITY, sizeof (uint8_t),
+                                alignof (uint8_t), temporary_allocation_group);
+        kan_dynamic_array_init (&batch->sizes, KAN_RESOURCE_PIPELINE_BUILD_PACK_BATCH_ENTRIES, sizeof (kan_file_size_t),
+                                alignof (kan_file_size_t), temporary_allocation_group);
+        batch->local_registry = KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t);
+    }
+
+    while (true)
+    {
+        kan_instance_size_t batches_used = 0u;
+        bool interned_batches_used = false;
+
+        for (kan_loop_size_t index = 0u; index < contexts.size; ++index)
+        {
+            struct pack_target_context_t *context = &((struct pack_target_context_t *) contexts.data)[index];
+            context->first_batch_in_window = &((struct pack_staging_batch_t *) batches.data)[batches_used];
+            context->batches_in_window = 0u;
+
+            if (!context->target->pack_step_successful)
+            {
+                continue;
+            }
+
+            while (context->next_entry_to_stage < context->entries_to_pack.size && batches_used < window_batches)
+            {
+                struct pack_staging_batch_t *batch = &((struct pack_staging_batch_t *) batches.data)[batches_used];
+                ++batches_used;
+                ++context->batches_in_window;
+
+                batch->context = context;
+                batch->first_entry_index = context->next_entry_to_stage;
+                batch->entries_count = KAN_MIN (KAN_RESOURCE_PIPELINE_BUILD_PACK_BATCH_ENTRIES,
+                                                context->entries_to_pack.size - context->next_entry_to_stage);
+                batch->data.size = 0u;
+                batch->sizes.size = 0u;
+                batch->successful = false;
+                context->next_entry_to_stage += batch->entries_count;
+
+                if (KAN_HANDLE_IS_VALID (context->interned_string_registry))
+                {
+                    batch->local_registry = kan_serialization_interned_string_registry_create_empty ();
+                    interned_batches_used = true;
+                }
+            }
+        }
+
+        if (batches_used == 0u)
+        {
+            break;
+        }
+
+        if (interned_batches_used)
+        {
+            // Strings are collected in parallel and merged serially in entry order, so string indices are always the
+            // same for the same input. After that, staging only queries existing strings from target registries.
+            execute_pack_for_every_batch (&batches, batches_used, execute_pack_collect_strings_batch);
+            execute_pack_merge_collected_strings (&contexts);
+        }
+
+        execute_pack_for_every_batch (&batches, batches_used, execute_pack_stage_batch);
+        execute_pack_for_every_context (&contexts, execute_pack_append_staged, true);
+    }
 
+    execute_pack_for_every_context (&contexts, execute_pack_finalize_target, false);
     bool successful = true;
-    target = state->targets_first;
 
-    while (target)
+    for (kan_loop_size_t index = 0u; index < contexts.size; ++index)
     {
-        successful &= target->pack_step_successful;
-        target = target->next;
+        successful &= ((struct pack_target_context_t *) contexts.data)[index].target->pack_step_successful;
     }
 
     return successful ? KAN_RESOURCE_BUILD_RESULT_SUCCESS : KAN_RESOURCE_BUILD_RESULT_ERROR_PACK_FAILED;
@@ -6344,12 +8775,30 @@ enum kan_resource_build_result_t kan_resource_build (struct kan_resource_build_s
     CHECKED_STEP (create_targets)
     CHECKED_STEP (link_visible_targets)
     CHECKED_STEP (linearize_visible_targets)
+    if (setup->artifact_cache_directory)
+    {
+        CHECKED_STEP (prepare_artifact_cache)
+    }
+
     CHECKED_STEP (load_platform_configuration)
     CHECKED_STEP (load_resource_log_if_exists)
     CHECKED_STEP (instantiate_initial_resource_log)
+    CHECKED_STEP (calculate_build_priorities)
     CHECKED_STEP (scan_for_raw_resources)
     CHECKED_STEP (execute_build)
 
+    if (setup->timing_report_path)
+    {
+        CHECKED_STEP (save_timing_report)
+    }
+
+    if (setup->artifact_cache_directory)
+    {
+        CHECKED_STEP (trim_artifact_cache)
+    }
+
+    CHECKED_STEP (trim_rule_cache)
+
     if (setup->pack_mode != KAN_RESOURCE_BUILD_PACK_MODE_NONE)
     {
         CHECKED_STEP (execute_pack)
@@ -6359,8 +8808,6 @@ enum kan_resource_build_result_t kan_resource_build (struct kan_resource_build_s
     return result;
 }
 
-KAN_REFLECTION_EXPECT_UNIT_REGISTRAR (resource_pipeline);
-
 bool kan_resource_project_load (struct kan_resource_project_t *project, const char *from_path)
 {
     ensure_statics_initialized ();
@@ -23,6 +23,18 @@
 /// tool. `kan_resource_build_setup_t` is used to configure tool execution and `kan_resource_build` is an actual
 /// function that executes resource build routine.
 ///
+/// Optionally, shared artifact cache directory can be provided through `kan_resource_build_setup_t`. Results of build
+/// rules are stored there under keys calculated from build rule, its versions, content of its inputs and content of
+/// platform configuration. When build rule needs to be executed, artifact cache is checked first and build rule
+/// execution is skipped if artifact with the same key is found. As keys do not depend on workspace paths or timestamps,
+/// one artifact cache directory can be shared between several workspaces (for example, different branch checkouts) on
+/// the same machine. When artifact cache size exceeds configured limit, least recently used artifacts are evicted.
+///
+/// Build rule execution times are recorded in resource log. On subsequent builds they are used to estimate the length
+/// of the build chain that starts from every logged resource, and resources with longer chains are scheduled first.
+/// When `kan_resource_build_setup_t::timing_report_path` is set, timing report with wall and CPU times of build rules
+/// is saved after the build.
+///
 /// Optionally, deployed resources can be packed into read only pack for virtual file system when
 /// `kan_resource_build_pack_mode_t` is provided. When packing is done, resource index is automatically generated with
 /// accompanying interned string registry if pack mode requires it.
@@ -63,6 +75,33 @@ struct kan_resource_build_setup_t
     ///          Set this value to KAN_LOG_ERROR of you want only errors to be printed.
     enum kan_log_verbosity_t log_verbosity;
 
+    /// \brief Path to the shared artifact cache directory or NULL if artifact cache should not be used.
+    /// \details Directory is created if it does not exist. Path is not owned by setup.
+    const char *artifact_cache_directory;
+
+    /// \brief Total size of artifact cache in bytes after which least recently used artifacts are evicted.
+    kan_file_size_t artifact_cache_size_limit;
+
+    /// \brief Total size of workspace rule cache in bytes after which least recently used rule cache data is evicted.
+    kan_file_size_t rule_cache_size_limit;
+
+    /// \brief Approximate memory budget in bytes for simultaneously executed build tasks. Zero means no limit.
+    /// \details Build tasks are admitted for execution only when both free cores and enough of memory budget are
+    ///          available. Memory usage of the task is estimated from the sizes of the files it is going to load.
+    ///          Task is always admitted if nothing else is executed, therefore big resources can still be built.
+    ///          By default, percentage of random access memory is used.
+    kan_memory_size_t memory_budget;
+
+    /// \brief Path to save build timing report to or NULL if timing report should not be saved.
+    /// \details Timing report is saved in readable data format, see `kan_resource_timing_report_t`.
+    ///          Path is not owned by setup.
+    const char *timing_report_path;
+
+    /// \brief Whether scan snapshot from previous build should be used to skip unchanged directories.
+    /// \details Scan snapshot is always saved to workspace, this flag only controls whether it is used.
+    ///          See `kan_resource_scan_snapshot_t` for the details.
+    bool use_scan_snapshot;
+
     /// \brief List of targets to build. Targets that are transitively visible from them will also be built.
     KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (kan_interned_string_t)
     struct kan_dynamic_array_t targets;
@@ -125,6 +164,9 @@ enum kan_resource_build_result_t
 
     /// \brief Encountered failure while packing resource targets.
     KAN_RESOURCE_BUILD_RESULT_ERROR_PACK_FAILED,
+
+    /// \brief Failed to create artifact cache directory.
+    KAN_RESOURCE_BUILD_RESULT_ERROR_ARTIFACT_CACHE_CANNOT_MAKE_DIRECTORY,
 };
 
 /// \brief Executes resource build routine, returns only after execution is done.
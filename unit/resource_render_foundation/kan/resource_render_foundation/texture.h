@@ -37,7 +37,25 @@ enum kan_resource_texture_format_t
     KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_D16,
     KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_D32,
 
-    // TODO: Compressed formats like BCn, ETC2 and ASTC will be added in the future on demand.
+    /// \brief BC1 without alpha, 8 bytes per 4x4 block.
+    KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_SRGB,
+    KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_UNORM,
+
+    /// \brief BC3 with interpolated alpha, 16 bytes per 4x4 block.
+    KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_SRGB,
+    KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_UNORM,
+
+    /// \brief BC4 with one channel, 8 bytes per 4x4 block.
+    KAN_RESOURCE_TEXTURE_FORMAT_BC4_R_UNORM,
+
+    /// \brief BC5 with two channels, 16 bytes per 4x4 block. Usually used for normal maps.
+    KAN_RESOURCE_TEXTURE_FORMAT_BC5_RG_UNORM,
+
+    /// \brief BC7 with alpha, 16 bytes per 4x4 block. Best quality among supported block compressed formats.
+    KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_SRGB,
+    KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_UNORM,
+
+    // TODO: Compressed formats like ETC2 and ASTC will be added in the future on demand.
 };
 
 /// \brief Contains data for particular mip in particular format for some texture.
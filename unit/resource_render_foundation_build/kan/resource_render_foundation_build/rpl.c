@@ -2,6 +2,7 @@
 
 #include <string.h>
 
+#include <kan/checksum/checksum.h>
 #include <kan/file_system/stream.h>
 #include <kan/log/logging.h>
 #include <kan/memory/allocation.h>
@@ -16,6 +17,7 @@ void kan_resource_render_code_platform_configuration_init (
     struct kan_resource_render_code_platform_configuration_t *instance)
 {
     instance->code_format = KAN_RENDER_CODE_FORMAT_SPIRV;
+    instance->code_optimization_flags = KAN_RPL_OPTIMIZATION_NONE;
     kan_dynamic_array_init (&instance->supported_pass_tags, 0u, sizeof (kan_interned_string_t),
                             alignof (kan_interned_string_t), kan_allocation_group_stack_get ());
 }
@@ -68,6 +70,7 @@ RESOURCE_RENDER_FOUNDATION_BUILD_API struct kan_resource_type_meta_t kan_resourc
 void kan_resource_rpl_source_init (struct kan_resource_rpl_source_t *instance)
 {
     kan_rpl_intermediate_init (&instance->intermediate);
+    instance->content_hash = 0u;
 }
 
 void kan_resource_rpl_source_shutdown (struct kan_resource_rpl_source_t *instance)
@@ -360,6 +363,16 @@ static enum kan_resource_build_rule_result_t rpl_source_build (struct kan_resour
     }
 
     file_data[file_size] = '\0';
+    kan_checksum_state_t checksum = kan_checksum_create ();
+    kan_checksum_append (checksum, file_size, file_data);
+    output->content_hash = kan_checksum_finalize (checksum);
+
+    // Zero is reserved for unknown content hash.
+    if (output->content_hash == 0u)
+    {
+        output->content_hash = 1u;
+    }
+
     kan_rpl_parser_t parser = kan_rpl_parser_create (context->primary_name);
     CUSHION_DEFER { kan_rpl_parser_destroy (parser); }
 
@@ -393,12 +406,140 @@ RESOURCE_RENDER_FOUNDATION_BUILD_API struct kan_resource_build_rule_t kan_resour
     .version = CUSHION_START_NS_X64,
 };
 
+static inline void rpl_pipeline_cache_key_append_string (kan_checksum_state_t checksum, const char *string)
+{
+    // Include terminator so sequences of strings cannot produce the same data.
+    kan_checksum_append (checksum, strlen (string) + 1u, (void *) string);
+}
+
+static void rpl_pipeline_cache_key_append_options (kan_checksum_state_t checksum,
+                                                   const struct kan_resource_rpl_options_t *options)
+{
+    // Options are appended field by field as option structures might have padding.
+    kan_checksum_append (checksum, sizeof (options->flags.size), (void *) &options->flags.size);
+    for (kan_loop_size_t index = 0u; index < (kan_loop_size_t) options->flags.size; ++index)
+    {
+        struct kan_resource_rpl_flag_option_t *option =
+            &((struct kan_resource_rpl_flag_option_t *) options->flags.data)[index];
+        rpl_pipeline_cache_key_append_string (checksum, option->name);
+
+        const uint8_t value = option->value ? 1u : 0u;
+        kan_checksum_append (checksum, sizeof (value), (void *) &value);
+    }
+
+    kan_checksum_append (checksum, sizeof (options->uints.size), (void *) &options->uints.size);
+    for (kan_loop_size_t index = 0u; index < (kan_loop_size_t) options->uints.size; ++index)
+    {
+        struct kan_resource_rpl_uint_option_t *option =
+            &((struct kan_resource_rpl_uint_option_t *) options->uints.data)[index];
+        rpl_pipeline_cache_key_append_string (checksum, option->name);
+        kan_checksum_append (checksum, sizeof (option->value), &option->value);
+    }
+
+    kan_checksum_append (checksum, sizeof (options->sints.size), (void *) &options->sints.size);
+    for (kan_loop_size_t index = 0u; index < (kan_loop_size_t) options->sints.size; ++index)
+    {
+        struct kan_resource_rpl_sint_option_t *option =
+            &((struct kan_resource_rpl_sint_option_t *) options->sints.data)[index];
+        rpl_pipeline_cache_key_append_string (checksum, option->name);
+        kan_checksum_append (checksum, sizeof (option->value), &option->value);
+    }
+
+    kan_checksum_append (checksum, sizeof (options->floats.size), (void *) &options->floats.size);
+    for (kan_loop_size_t index = 0u; index < (kan_loop_size_t) options->floats.size; ++index)
+    {
+        struct kan_resource_rpl_float_option_t *option =
+            &((struct kan_resource_rpl_float_option_t *) options->floats.data)[index];
+        rpl_pipeline_cache_key_append_string (checksum, option->name);
+        kan_checksum_append (checksum, sizeof (option->value), &option->value);
+    }
+
+    kan_checksum_append (checksum, sizeof (options->enums.size), (void *) &options->enums.size);
+    for (kan_loop_size_t index = 0u; index < (kan_loop_size_t) options->enums.size; ++index)
+    {
+        struct kan_resource_rpl_enum_option_t *option =
+            &((struct kan_resource_rpl_enum_option_t *) options->enums.data)[index];
+        rpl_pipeline_cache_key_append_string (checksum, option->name);
+        rpl_pipeline_cache_key_append_string (checksum, option->value);
+    }
+}
+
+/// \brief Calculates key for compiled pipeline in build rule cache.
+/// \details Resource names are intentionally not the part of the key, so pipelines with the same sources and the same
+///          setup share compiled data. Returns false if key cannot be calculated due to unknown source content.
+static bool rpl_pipeline_calculate_cache_key (struct kan_resource_build_rule_context_t *context,
+                                              kan_file_size_t *output_key)
+{
+    const struct kan_resource_rpl_pipeline_header_t *input = context->primary_input;
+    const struct kan_resource_render_code_platform_configuration_t *configuration = context->platform_configuration;
+    kan_checksum_state_t checksum = kan_checksum_create ();
+    bool key_valid = true;
+
+    const kan_resource_version_t rule_version = kan_resource_rpl_pipeline_build_rule.version;
+    kan_checksum_append (checksum, sizeof (rule_version), (void *) &rule_version);
+
+    const uint32_t compiler_version = KAN_RPL_COMPILER_VERSION;
+    kan_checksum_append (checksum, sizeof (compiler_version), (void *) &compiler_version);
+
+    const uint32_t pipeline_type = (uint32_t) input->type;
+    kan_checksum_append (checksum, sizeof (pipeline_type), (void *) &pipeline_type);
+
+    const uint32_t code_format = (uint32_t) configuration->code_format;
+    kan_checksum_append (checksum, sizeof (code_format), (void *) &code_format);
+
+    const uint32_t code_optimization_flags = (uint32_t) configuration->code_optimization_flags;
+    kan_checksum_append (checksum, sizeof (code_optimization_flags), (void *) &code_optimization_flags);
+
+    kan_checksum_append (checksum, sizeof (input->entry_points.size), (void *) &input->entry_points.size);
+    for (kan_loop_size_t index = 0u; index < (kan_loop_size_t) input->entry_points.size; ++index)
+    {
+        struct kan_rpl_entry_point_t *entry_point = &((struct kan_rpl_entry_point_t *) input->entry_points.data)[index];
+        const uint32_t stage = (uint32_t) entry_point->stage;
+        kan_checksum_append (checksum, sizeof (stage), (void *) &stage);
+        rpl_pipeline_cache_key_append_string (checksum, entry_point->function_name);
+    }
+
+    // Order of sources matters as it is the order in which modules are used.
+    struct kan_resource_build_rule_secondary_node_t *secondary = context->secondary_input_first;
+    while (secondary)
+    {
+        const struct kan_resource_rpl_source_t *source = secondary->data;
+        key_valid &= source->content_hash != 0u;
+        kan_checksum_append (checksum, sizeof (source->content_hash), (void *) &source->content_hash);
+        secondary = secondary->next;
+    }
+
+    rpl_pipeline_cache_key_append_options (checksum, &input->global_options);
+    rpl_pipeline_cache_key_append_options (checksum, &input->instance_options);
+    *output_key = kan_checksum_finalize (checksum);
+    return key_valid;
+}
+
 static enum kan_resource_build_rule_result_t rpl_pipeline_build (struct kan_resource_build_rule_context_t *context)
 {
+    kan_static_interned_ids_ensure_initialized ();
     const struct kan_resource_rpl_pipeline_header_t *input = context->primary_input;
     struct kan_resource_rpl_pipeline_t *output = context->primary_output;
     const struct kan_resource_render_code_platform_configuration_t *configuration = context->platform_configuration;
 
+    kan_file_size_t cache_key = 0u;
+    const bool cache_key_valid = rpl_pipeline_calculate_cache_key (context, &cache_key);
+
+    if (cache_key_valid)
+    {
+        if (context->load_cached (context->interface, KAN_STATIC_INTERNED_ID_GET (kan_resource_rpl_pipeline_t),
+                                  cache_key, output))
+        {
+            return KAN_RESOURCE_BUILD_RULE_SUCCESS;
+        }
+
+        // Output might've been partially filled during failed load, therefore we need to reset it.
+        kan_allocation_group_stack_push (output->code.allocation_group);
+        kan_resource_rpl_pipeline_shutdown (output);
+        kan_resource_rpl_pipeline_init (output);
+        kan_allocation_group_stack_pop ();
+    }
+
     kan_dynamic_array_set_capacity (&output->entry_points, input->entry_points.size);
     output->entry_points.size = output->entry_points.capacity;
     memcpy (output->entry_points.data, input->entry_points.data,
@@ -455,6 +596,8 @@ static enum kan_resource_build_rule_result_t rpl_pipeline_build (struct kan_reso
     }
 
     CUSHION_DEFER { kan_rpl_compiler_instance_destroy (compiler_instance); }
+    kan_rpl_compiler_instance_optimize (compiler_instance, configuration->code_optimization_flags);
+
     if (!kan_rpl_compiler_instance_emit_meta (compiler_instance, &output->meta, KAN_RPL_META_EMISSION_FULL))
     {
         KAN_LOG (resource_render_foundation_rpl, KAN_LOG_ERROR,
@@ -480,5 +623,11 @@ static enum kan_resource_build_rule_result_t rpl_pipeline_build (struct kan_reso
     }
     }
 
+    if (cache_key_valid)
+    {
+        context->store_cached (context->interface, KAN_STATIC_INTERNED_ID_GET (kan_resource_rpl_pipeline_t), cache_key,
+                               output);
+    }
+
     return KAN_RESOURCE_BUILD_RULE_SUCCESS;
 }
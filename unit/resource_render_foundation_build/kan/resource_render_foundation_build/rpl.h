@@ -7,6 +7,7 @@
 #include <kan/context/render_backend_system.h>
 #include <kan/error/critical.h>
 #include <kan/reflection/markup.h>
+#include <kan/render_pipeline_language/compiler.h>
 #include <kan/render_pipeline_language/parser.h>
 
 /// \file
@@ -30,6 +31,11 @@
 /// `kan_resource_rpl_pipeline_header_t` provides generic way for building render pipelines with their code and meta for
 /// target platform. `kan_resource_rpl_pipeline_header_t` contains all the data needed to compile and arbitrary pipeline
 /// and `kan_resource_rpl_pipeline_t` with compiled data is produced through build rule.
+///
+/// Compiled pipelines are stored in build rule cache under keys calculated from content of source code, options,
+/// entry points, target code format and compiler version. Therefore, pipelines with the same setup are compiled only
+/// once even if they're declared by different resources, for example by different materials that use the same
+/// sources, and rebuilding pipeline that was already compiled before with the same setup is fast.
 /// \endparblock
 
 KAN_C_HEADER_BEGIN
@@ -40,6 +46,10 @@ struct kan_resource_render_code_platform_configuration_t
     /// \brief Intermediate format to which pipelines should be compiled.
     enum kan_render_code_format_t code_format;
 
+    /// \brief Optimizations applied to pipeline code before emission, see `kan_rpl_compiler_instance_optimize`.
+    /// \details Nothing is applied by default, platform configuration needs to enable optimizations explicitly.
+    enum kan_rpl_optimization_flags_t code_optimization_flags;
+
     /// \brief List of render pass tags that can be used to decide whether pass is supported on this platform.
     /// \details Main goal of support tags is to exclude excessive passes like editor-only passes from build, but
     ///          it can be used to customize passes for different platforms too.
@@ -64,6 +74,9 @@ RESOURCE_RENDER_FOUNDATION_BUILD_API void kan_resource_render_code_platform_conf
 struct kan_resource_rpl_source_t
 {
     struct kan_rpl_intermediate_t intermediate;
+
+    /// \brief Checksum of source code text, used to calculate keys for compiled pipeline cache.
+    kan_file_size_t content_hash;
 };
 
 RESOURCE_RENDER_FOUNDATION_BUILD_API void kan_resource_rpl_source_init (struct kan_resource_rpl_source_t *instance);
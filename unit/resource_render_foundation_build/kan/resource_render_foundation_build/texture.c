@@ -1,8 +1,11 @@
 #define _CRT_SECURE_NO_WARNINGS __CUSHION_PRESERVE__
 
+#include <float.h>
+#include <math.h>
 #include <string.h>
 
 #include <kan/api_common/min_max.h>
+#include <kan/cpu_dispatch/parallel_for.h>
 #include <kan/file_system/stream.h>
 #include <kan/image/image.h>
 #include <kan/inline_math/inline_math.h>
@@ -12,6 +15,21 @@
 #include <kan/resource_render_foundation_build/texture.h>
 #include <kan/stream/random_access_stream_buffer.h>
 
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#    include <immintrin.h>
+
+#    if defined(__SSE2__)
+#        define TEXTURE_MIP_USE_SSE2
+#    endif
+
+// AVX2 kernels are compiled using target attribute and selected at runtime, therefore they are available even when
+// build does not target AVX2. Runtime detection relies on compiler runtime, which is not guaranteed for MSVC ABI.
+#    if !defined(_MSC_VER)
+#        define TEXTURE_MIP_USE_AVX2
+#        define TEXTURE_MIP_AVX2_ATTRIBUTES __attribute__ ((target ("avx2")))
+#    endif
+#endif
+
 KAN_LOG_DEFINE_CATEGORY (resource_render_foundation_texture);
 KAN_USE_STATIC_INTERNED_IDS
 
@@ -39,6 +57,7 @@ void kan_resource_texture_build_preset_init (struct kan_resource_texture_build_p
 {
     instance->mip_generation = KAN_RESOURCE_TEXTURE_MIP_GENERATION_AVERAGE;
     instance->target_mips = 1u;
+    instance->compression_quality = KAN_RESOURCE_TEXTURE_COMPRESSION_QUALITY_NORMAL;
     kan_dynamic_array_init (&instance->supported_target_formats, 0u, sizeof (enum kan_resource_texture_format_t),
                             alignof (enum kan_resource_texture_format_t), kan_allocation_group_stack_get ());
 }
@@ -104,6 +123,1219 @@ static void free_transitive_mip_data (float **image_mips,
     kan_free_general (mips_allocation_group, image_mips, sizeof (float *) * output->mips);
 }
 
+// Mip generation is done using specialized kernels that process one target row at once. Rows are stored in row-major
+// order, the same way as in decoded image, so kernels read both source rows sequentially. Every target pixel is
+// produced from 2x2 source pixels: when source size is odd, the last row or column is skipped, as mip size is rounded
+// down.
+
+typedef void (*mip_row_kernel_t) (const float *source_row_0,
+                                  const float *source_row_1,
+                                  float *target_row,
+                                  kan_instance_size_t target_width);
+
+#define MIP_SCALAR_AVERAGE(A, B, C, D) ((((A) + (B)) + ((C) + (D))) * 0.25f)
+#define MIP_SCALAR_MIN(A, B, C, D) KAN_MIN (KAN_MIN (A, B), KAN_MIN (C, D))
+#define MIP_SCALAR_MAX(A, B, C, D) KAN_MAX (KAN_MAX (A, B), KAN_MAX (C, D))
+
+#if defined(TEXTURE_MIP_USE_SSE2)
+#    define MIP_SSE_AVERAGE(A, B, C, D)                                                                                \
+        _mm_mul_ps (_mm_add_ps (_mm_add_ps (A, B), _mm_add_ps (C, D)), _mm_set1_ps (0.25f))
+#    define MIP_SSE_MIN(A, B, C, D) _mm_min_ps (_mm_min_ps (A, B), _mm_min_ps (C, D))
+#    define MIP_SSE_MAX(A, B, C, D) _mm_max_ps (_mm_max_ps (A, B), _mm_max_ps (C, D))
+#endif
+
+#if defined(TEXTURE_MIP_USE_AVX2)
+#    define MIP_AVX_AVERAGE(A, B, C, D)                                                                                \
+        _mm256_mul_ps (_mm256_add_ps (_mm256_add_ps (A, B), _mm256_add_ps (C, D)), _mm256_set1_ps (0.25f))
+#    define MIP_AVX_MIN(A, B, C, D) _mm256_min_ps (_mm256_min_ps (A, B), _mm256_min_ps (C, D))
+#    define MIP_AVX_MAX(A, B, C, D) _mm256_max_ps (_mm256_max_ps (A, B), _mm256_max_ps (C, D))
+#endif
+
+// Every kernel consists of wide loop, if it is available, and scalar loop for the remaining pixels.
+// Wide loops are intentionally written in the same order as scalar ones, so all paths produce the same results.
+
+#define MIP_KERNEL_NO_WIDE(MODE)
+#define MIP_KERNEL_NO_ATTRIBUTES
+
+#if defined(TEXTURE_MIP_USE_SSE2)
+#    define MIP_KERNEL_RGBA_SSE2(MODE)                                                                                 \
+        /* One target pixel per iteration, but all channels at once. */                                               \
+        for (; x < target_width; ++x)                                                                                  \
+        {                                                                                                              \
+            _mm_storeu_ps (target_row + x * 4u,                                                                        \
+                           MIP_SSE_##MODE (_mm_loadu_ps (source_row_0 + x * 8u),                                       \
+                                           _mm_loadu_ps (source_row_0 + x * 8u + 4u),                                  \
+                                           _mm_loadu_ps (source_row_1 + x * 8u),                                       \
+                                           _mm_loadu_ps (source_row_1 + x * 8u + 4u)));                                \
+        }
+
+#    define MIP_KERNEL_R_SSE2(MODE)                                                                                    \
+        /* Four target pixels per iteration: separate even and odd source pixels using shuffles. */                   \
+        for (; x + 4u <= target_width; x += 4u)                                                                        \
+        {                                                                                                              \
+            const __m128 row_0_first = _mm_loadu_ps (source_row_0 + x * 2u);                                           \
+            const __m128 row_0_second = _mm_loadu_ps (source_row_0 + x * 2u + 4u);                                     \
+            const __m128 row_1_first = _mm_loadu_ps (source_row_1 + x * 2u);                                           \
+            const __m128 row_1_second = _mm_loadu_ps (source_row_1 + x * 2u + 4u);                                     \
+                                                                                                                       \
+            _mm_storeu_ps (target_row + x,                                                                             \
+                           MIP_SSE_##MODE (_mm_shuffle_ps (row_0_first, row_0_second, _MM_SHUFFLE (2, 0, 2, 0)),       \
+                                           _mm_shuffle_ps (row_0_first, row_0_second, _MM_SHUFFLE (3, 1, 3, 1)),       \
+                                           _mm_shuffle_ps (row_1_first, row_1_second, _MM_SHUFFLE (2, 0, 2, 0)),       \
+                                           _mm_shuffle_ps (row_1_first, row_1_second, _MM_SHUFFLE (3, 1, 3, 1))));     \
+        }
+#endif
+
+#if defined(TEXTURE_MIP_USE_AVX2)
+#    define MIP_KERNEL_RGBA_AVX2(MODE)                                                                                 \
+        /* Two target pixels per iteration: swizzle 128-bit lanes so that every vector contains pixels for the same */ \
+        /* position of 2x2 block for both target pixels. */                                                            \
+        for (; x + 2u <= target_width; x += 2u)                                                                        \
+        {                                                                                                              \
+            const __m256 row_0_left = _mm256_loadu_ps (source_row_0 + x * 8u);                                         \
+            const __m256 row_0_right = _mm256_loadu_ps (source_row_0 + x * 8u + 8u);                                   \
+            const __m256 row_1_left = _mm256_loadu_ps (source_row_1 + x * 8u);                                         \
+            const __m256 row_1_right = _mm256_loadu_ps (source_row_1 + x * 8u + 8u);                                   \
+                                                                                                                       \
+            _mm256_storeu_ps (target_row + x * 4u,                                                                     \
+                              MIP_AVX_##MODE (_mm256_permute2f128_ps (row_0_left, row_0_right, 0x20),                  \
+                                              _mm256_permute2f128_ps (row_0_left, row_0_right, 0x31),                  \
+                                              _mm256_permute2f128_ps (row_1_left, row_1_right, 0x20),                  \
+                                              _mm256_permute2f128_ps (row_1_left, row_1_right, 0x31)));                \
+        }
+
+#    define MIP_KERNEL_R_AVX2(MODE)                                                                                    \
+        /* Eight target pixels per iteration. In-lane shuffle mixes 64-bit parts of the lanes, */                      \
+        /* but the same way for every input, so we can fix the order once for the result. */                          \
+        for (; x + 8u <= target_width; x += 8u)                                                                        \
+        {                                                                                                              \
+            const __m256 row_0_first = _mm256_loadu_ps (source_row_0 + x * 2u);                                       \
+            const __m256 row_0_second = _mm256_loadu_ps (source_row_0 + x * 2u + 8u);                                  \
+            const __m256 row_1_first = _mm256_loadu_ps (source_row_1 + x * 2u);                                        \
+            const __m256 row_1_second = _mm256_loadu_ps (source_row_1 + x * 2u + 8u);                                  \
+                                                                                                                       \
+            const __m256 result = MIP_AVX_##MODE (                                                                     \
+                _mm256_shuffle_ps (row_0_first, row_0_second, _MM_SHUFFLE (2, 0, 2, 0)),                               \
+                _mm256_shuffle_ps (row_0_first, row_0_second, _MM_SHUFFLE (3, 1, 3, 1)),                               \
+                _mm256_shuffle_ps (row_1_first, row_1_second, _MM_SHUFFLE (2, 0, 2, 0)),                               \
+                _mm256_shuffle_ps (row_1_first, row_1_second, _MM_SHUFFLE (3, 1, 3, 1)));                              \
+                                                                                                                       \
+            _mm256_storeu_ps (target_row + x, _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (result),      \
+                                                                                       _MM_SHUFFLE (3, 1, 2, 0))));    \
+        }
+#endif
+
+#define MIP_KERNEL_RGBA(MODE, NAME, WIDE, ATTRIBUTES)                                                                  \
+    static ATTRIBUTES void NAME (const float *source_row_0, const float *source_row_1, float *target_row,              \
+                                 kan_instance_size_t target_width)                                                     \
+    {                                                                                                                  \
+        kan_loop_size_t x = 0u;                                                                                        \
+        WIDE (MODE)                                                                                                    \
+                                                                                                                       \
+        for (; x < target_width; ++x)                                                                                  \
+        {                                                                                                              \
+            const float *left_0 = source_row_0 + x * 8u;                                                               \
+            const float *left_1 = source_row_1 + x * 8u;                                                               \
+            float *target = target_row + x * 4u;                                                                       \
+                                                                                                                       \
+            for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)                                                \
+            {                                                                                                          \
+                target[channel] = MIP_SCALAR_##MODE (left_0[channel], left_0[channel + 4u], left_1[channel],           \
+                                                     left_1[channel + 4u]);                                            \
+            }                                                                                                          \
+        }                                                                                                              \
+    }
+
+#define MIP_KERNEL_R(MODE, NAME, WIDE, ATTRIBUTES)                                                                     \
+    static ATTRIBUTES void NAME (const float *source_row_0, const float *source_row_1, float *target_row,              \
+                                 kan_instance_size_t target_width)                                                     \
+    {                                                                                                                  \
+        kan_loop_size_t x = 0u;                                                                                        \
+        WIDE (MODE)                                                                                                    \
+                                                                                                                       \
+        for (; x < target_width; ++x)                                                                                  \
+        {                                                                                                              \
+            target_row[x] = MIP_SCALAR_##MODE (source_row_0[x * 2u], source_row_0[x * 2u + 1u], source_row_1[x * 2u],  \
+                                               source_row_1[x * 2u + 1u]);                                             \
+        }                                                                                                              \
+    }
+
+/// \brief Kernels for one instruction set, indexed by mip generation mode.
+struct mip_row_kernel_set_t
+{
+    mip_row_kernel_t rgba[KAN_RESOURCE_TEXTURE_MIP_GENERATION_MAX + 1u];
+    mip_row_kernel_t r[KAN_RESOURCE_TEXTURE_MIP_GENERATION_MAX + 1u];
+};
+
+#define MIP_KERNEL_SET(SET, RGBA_WIDE, R_WIDE, ATTRIBUTES)                                                             \
+    MIP_KERNEL_RGBA (AVERAGE, mip_row_kernel_##SET##_rgba_average, RGBA_WIDE, ATTRIBUTES)                              \
+    MIP_KERNEL_RGBA (MIN, mip_row_kernel_##SET##_rgba_min, RGBA_WIDE, ATTRIBUTES)                                      \
+    MIP_KERNEL_RGBA (MAX, mip_row_kernel_##SET##_rgba_max, RGBA_WIDE, ATTRIBUTES)                                      \
+    MIP_KERNEL_R (AVERAGE, mip_row_kernel_##SET##_r_average, R_WIDE, ATTRIBUTES)                                       \
+    MIP_KERNEL_R (MIN, mip_row_kernel_##SET##_r_min, R_WIDE, ATTRIBUTES)                                               \
+    MIP_KERNEL_R (MAX, mip_row_kernel_##SET##_r_max, R_WIDE, ATTRIBUTES)                                               \
+                                                                                                                       \
+    static const struct mip_row_kernel_set_t mip_row_kernel_set_##SET = {                                              \
+        .rgba =                                                                                                        \
+            {                                                                                                          \
+                [KAN_RESOURCE_TEXTURE_MIP_GENERATION_AVERAGE] = mip_row_kernel_##SET##_rgba_average,                   \
+                [KAN_RESOURCE_TEXTURE_MIP_GENERATION_MIN] = mip_row_kernel_##SET##_rgba_min,                           \
+                [KAN_RESOURCE_TEXTURE_MIP_GENERATION_MAX] = mip_row_kernel_##SET##_rgba_max,                           \
+            },                                                                                                         \
+        .r =                                                                                                           \
+            {                                                                                                          \
+                [KAN_RESOURCE_TEXTURE_MIP_GENERATION_AVERAGE] = mip_row_kernel_##SET##_r_average,                      \
+                [KAN_RESOURCE_TEXTURE_MIP_GENERATION_MIN] = mip_row_kernel_##SET##_r_min,                              \
+                [KAN_RESOURCE_TEXTURE_MIP_GENERATION_MAX] = mip_row_kernel_##SET##_r_max,                              \
+            },                                                                                                         \
+    };
+
+MIP_KERNEL_SET (scalar, MIP_KERNEL_NO_WIDE, MIP_KERNEL_NO_WIDE, MIP_KERNEL_NO_ATTRIBUTES)
+
+#if defined(TEXTURE_MIP_USE_SSE2)
+MIP_KERNEL_SET (sse2, MIP_KERNEL_RGBA_SSE2, MIP_KERNEL_R_SSE2, MIP_KERNEL_NO_ATTRIBUTES)
+#endif
+
+#if defined(TEXTURE_MIP_USE_AVX2)
+MIP_KERNEL_SET (avx2, MIP_KERNEL_RGBA_AVX2, MIP_KERNEL_R_AVX2, TEXTURE_MIP_AVX2_ATTRIBUTES)
+#endif
+
+#undef MIP_KERNEL_SET
+#undef MIP_KERNEL_R
+#undef MIP_KERNEL_RGBA
+#undef MIP_KERNEL_R_AVX2
+#undef MIP_KERNEL_RGBA_AVX2
+#undef MIP_KERNEL_R_SSE2
+#undef MIP_KERNEL_RGBA_SSE2
+#undef MIP_KERNEL_NO_ATTRIBUTES
+#undef MIP_KERNEL_NO_WIDE
+#undef MIP_AVX_MAX
+#undef MIP_AVX_MIN
+#undef MIP_AVX_AVERAGE
+#undef MIP_SSE_MAX
+#undef MIP_SSE_MIN
+#undef MIP_SSE_AVERAGE
+#undef MIP_SCALAR_MAX
+#undef MIP_SCALAR_MIN
+#undef MIP_SCALAR_AVERAGE
+
+bool kan_resource_texture_mip_instruction_set_is_supported (
+    enum kan_resource_texture_mip_instruction_set_t instruction_set)
+{
+    switch (instruction_set)
+    {
+    case KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_SCALAR:
+        return true;
+
+    case KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_SSE2:
+#if defined(TEXTURE_MIP_USE_SSE2)
+        return true;
+#else
+        return false;
+#endif
+
+    case KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_AVX2:
+#if defined(TEXTURE_MIP_USE_AVX2)
+        return __builtin_cpu_supports ("avx2");
+#else
+        return false;
+#endif
+    }
+
+    return false;
+}
+
+enum kan_resource_texture_mip_instruction_set_t kan_resource_texture_mip_instruction_set_select_best (void)
+{
+    if (kan_resource_texture_mip_instruction_set_is_supported (KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_AVX2))
+    {
+        return KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_AVX2;
+    }
+
+    if (kan_resource_texture_mip_instruction_set_is_supported (KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_SSE2))
+    {
+        return KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_SSE2;
+    }
+
+    return KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_SCALAR;
+}
+
+static mip_row_kernel_t select_mip_row_kernel (enum kan_resource_texture_mip_generation_t mode,
+                                               enum kan_resource_texture_mip_instruction_set_t instruction_set,
+                                               kan_instance_size_t channels)
+{
+    KAN_ASSERT (channels == 1u || channels == 4u)
+    KAN_ASSERT (kan_resource_texture_mip_instruction_set_is_supported (instruction_set))
+    const struct mip_row_kernel_set_t *set = &mip_row_kernel_set_scalar;
+
+    switch (instruction_set)
+    {
+    case KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_SCALAR:
+        break;
+
+    case KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_SSE2:
+#if defined(TEXTURE_MIP_USE_SSE2)
+        set = &mip_row_kernel_set_sse2;
+#endif
+        break;
+
+    case KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_AVX2:
+#if defined(TEXTURE_MIP_USE_AVX2)
+        set = &mip_row_kernel_set_avx2;
+#endif
+        break;
+    }
+
+    return channels == 4u ? set->rgba[mode] : set->r[mode];
+}
+
+/// \brief Parallel for user data for generating one mip level by row bands.
+struct mip_band_generation_t
+{
+    kan_instance_size_t rows_per_band;
+    mip_row_kernel_t kernel;
+    const float *source_data;
+    float *target_data;
+    kan_instance_size_t source_width;
+    kan_instance_size_t target_width;
+    kan_instance_size_t target_height;
+    kan_instance_size_t channels;
+};
+
+static void mip_band_generation_process_rows (struct mip_band_generation_t *generation,
+                                              kan_instance_size_t row_begin,
+                                              kan_instance_size_t row_end)
+{
+    const kan_instance_size_t source_row_stride = generation->source_width * generation->channels;
+    const kan_instance_size_t target_row_stride = generation->target_width * generation->channels;
+
+    for (kan_loop_size_t y = row_begin; y < row_end; ++y)
+    {
+        const float *source_row_0 = generation->source_data + source_row_stride * y * 2u;
+        generation->kernel (source_row_0, source_row_0 + source_row_stride,
+                            generation->target_data + target_row_stride * y, generation->target_width);
+    }
+}
+
+static void mip_band_generation_process_band (kan_functor_user_data_t user_data,
+                                              kan_instance_size_t worker_index,
+                                              kan_instance_size_t band)
+{
+    struct mip_band_generation_t *generation = (struct mip_band_generation_t *) user_data;
+    const kan_instance_size_t row_begin = band * generation->rows_per_band;
+    const kan_instance_size_t row_end = KAN_MIN (row_begin + generation->rows_per_band, generation->target_height);
+    mip_band_generation_process_rows (generation, row_begin, row_end);
+}
+
+void kan_resource_texture_generate_mip (enum kan_resource_texture_mip_generation_t mode,
+                                        enum kan_resource_texture_mip_instruction_set_t instruction_set,
+                                        kan_instance_size_t channels,
+                                        const float *source_data,
+                                        kan_instance_size_t source_width,
+                                        float *target_data,
+                                        kan_instance_size_t target_width,
+                                        kan_instance_size_t target_height)
+{
+    const kan_instance_size_t rows_per_band =
+        KAN_MAX (1u, KAN_RESOURCE_RF_TEXTURE_MIP_BAND_PIXELS / KAN_MAX (1u, target_width));
+    const kan_instance_size_t bands_count = (target_height + rows_per_band - 1u) / rows_per_band;
+
+    struct mip_band_generation_t generation = {
+        .rows_per_band = rows_per_band,
+        .kernel = select_mip_row_kernel (mode, instruction_set, channels),
+        .source_data = source_data,
+        .target_data = target_data,
+        .source_width = source_width,
+        .target_width = target_width,
+        .target_height = target_height,
+        .channels = channels,
+    };
+
+    if (bands_count <= 1u)
+    {
+        mip_band_generation_process_rows (&generation, 0u, target_height);
+        return;
+    }
+
+    // Build rule is already executed inside cpu task, parallel for takes care of it.
+    kan_cpu_parallel_for_execute ((struct kan_cpu_parallel_for_t) {
+        .function = mip_band_generation_process_band,
+        .user_data = (kan_functor_user_data_t) &generation,
+        .items_count = bands_count,
+        .max_helpers = KAN_INT_MAX (kan_instance_size_t),
+        .helper_profiler_section = kan_cpu_section_get ("texture_mip_band"),
+    });
+}
+
+// Block compression section.
+
+// Block encoders work with 4x4 blocks of 8 bit per channel texels, because this is the precision of all supported
+// block compressed formats. Endpoints are selected in floating point and then quantized to format precision.
+// Quality presets change endpoint selection strategy and amount of tried encoding variants, but never block layout.
+
+#define TEXTURE_BLOCK_TEXELS 16u
+
+/// \brief Maximum count of least squares endpoint refinement iterations for high quality preset.
+#define TEXTURE_BLOCK_REFINE_ITERATIONS 2u
+
+/// \brief Count of power iterations for finding block principal axis.
+#define TEXTURE_BLOCK_POWER_ITERATIONS 8u
+
+struct texture_block_t
+{
+    uint8_t texels[TEXTURE_BLOCK_TEXELS][4u];
+};
+
+struct texture_bit_writer_t
+{
+    uint8_t *output;
+    kan_instance_size_t position;
+};
+
+static inline void texture_bit_writer_write (struct texture_bit_writer_t *writer,
+                                             uint32_t value,
+                                             kan_instance_size_t bits)
+{
+    for (kan_loop_size_t bit = 0u; bit < bits; ++bit, ++writer->position)
+    {
+        if ((value >> bit) & 1u)
+        {
+            writer->output[writer->position >> 3u] |= (uint8_t) (1u << (writer->position & 7u));
+        }
+    }
+}
+
+static inline float texture_block_clamp_channel (float value) { return KAN_CLAMP (value, 0.0f, 255.0f); }
+
+/// \brief Finds float endpoints for given block channels that are used as starting point by encoders.
+/// \details Fast quality uses bounding box of the block, which is cheap but might be far from the actual color line.
+///          Other qualities use principal axis of the block colors found through power iteration.
+static void texture_block_find_endpoints (const struct texture_block_t *block,
+                                          kan_instance_size_t channels,
+                                          enum kan_resource_texture_compression_quality_t quality,
+                                          float *output_first,
+                                          float *output_second)
+{
+    float min[4u] = {255.0f, 255.0f, 255.0f, 255.0f};
+    float max[4u] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float mean[4u] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    for (kan_loop_size_t texel = 0u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+    {
+        for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+        {
+            const float value = (float) block->texels[texel][channel];
+            min[channel] = KAN_MIN (min[channel], value);
+            max[channel] = KAN_MAX (max[channel], value);
+            mean[channel] += value;
+        }
+    }
+
+    if (quality == KAN_RESOURCE_TEXTURE_COMPRESSION_QUALITY_FAST)
+    {
+        for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+        {
+            output_first[channel] = min[channel];
+            output_second[channel] = max[channel];
+        }
+
+        return;
+    }
+
+    float covariance[4u][4u];
+    for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+    {
+        mean[channel] /= (float) TEXTURE_BLOCK_TEXELS;
+        for (kan_loop_size_t other = 0u; other < channels; ++other)
+        {
+            covariance[channel][other] = 0.0f;
+        }
+    }
+
+    for (kan_loop_size_t texel = 0u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+    {
+        float offset[4u];
+        for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+        {
+            offset[channel] = (float) block->texels[texel][channel] - mean[channel];
+        }
+
+        for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+        {
+            for (kan_loop_size_t other = channel; other < channels; ++other)
+            {
+                covariance[channel][other] += offset[channel] * offset[other];
+            }
+        }
+    }
+
+    // Bounding box diagonal is a good enough initial guess for the principal axis.
+    float axis[4u];
+    for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+    {
+        axis[channel] = max[channel] - min[channel];
+        for (kan_loop_size_t other = 0u; other < channel; ++other)
+        {
+            covariance[channel][other] = covariance[other][channel];
+        }
+    }
+
+    for (kan_loop_size_t iteration = 0u; iteration < TEXTURE_BLOCK_POWER_ITERATIONS; ++iteration)
+    {
+        float next_axis[4u];
+        float length = 0.0f;
+
+        for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+        {
+            next_axis[channel] = 0.0f;
+            for (kan_loop_size_t other = 0u; other < channels; ++other)
+            {
+                next_axis[channel] += covariance[channel][other] * axis[other];
+            }
+
+            length = KAN_MAX (length, fabsf (next_axis[channel]));
+        }
+
+        if (length < 1e-6f)
+        {
+            break;
+        }
+
+        for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+        {
+            axis[channel] = next_axis[channel] / length;
+        }
+    }
+
+    float axis_length_squared = 0.0f;
+    for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+    {
+        axis_length_squared += axis[channel] * axis[channel];
+    }
+
+    if (axis_length_squared < 1e-6f)
+    {
+        // Block is solid.
+        for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+        {
+            output_first[channel] = mean[channel];
+            output_second[channel] = mean[channel];
+        }
+
+        return;
+    }
+
+    float min_projection = FLT_MAX;
+    float max_projection = -FLT_MAX;
+
+    for (kan_loop_size_t texel = 0u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+    {
+        float projection = 0.0f;
+        for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+        {
+            projection += ((float) block->texels[texel][channel] - mean[channel]) * axis[channel];
+        }
+
+        min_projection = KAN_MIN (min_projection, projection);
+        max_projection = KAN_MAX (max_projection, projection);
+    }
+
+    min_projection /= axis_length_squared;
+    max_projection /= axis_length_squared;
+
+    for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+    {
+        output_first[channel] = texture_block_clamp_channel (mean[channel] + axis[channel] * min_projection);
+        output_second[channel] = texture_block_clamp_channel (mean[channel] + axis[channel] * max_projection);
+    }
+}
+
+/// \brief Refines endpoints using least squares fit for given interpolation weights of selected indices.
+/// \return False if fit is degenerate and endpoints were left unchanged.
+static bool texture_block_refine_endpoints (const struct texture_block_t *block,
+                                            kan_instance_size_t channels,
+                                            const float *weights,
+                                            float *first,
+                                            float *second)
+{
+    float first_first = 0.0f;
+    float first_second = 0.0f;
+    float second_second = 0.0f;
+    float first_value[4u] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float second_value[4u] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    for (kan_loop_size_t texel = 0u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+    {
+        const float second_weight = weights[texel];
+        const float first_weight = 1.0f - second_weight;
+
+        first_first += first_weight * first_weight;
+        first_second += first_weight * second_weight;
+        second_second += second_weight * second_weight;
+
+        for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+        {
+            first_value[channel] += first_weight * (float) block->texels[texel][channel];
+            second_value[channel] += second_weight * (float) block->texels[texel][channel];
+        }
+    }
+
+    const float determinant = first_first * second_second - first_second * first_second;
+    if (fabsf (determinant) < 1e-6f)
+    {
+        return false;
+    }
+
+    const float inverse_determinant = 1.0f / determinant;
+    for (kan_loop_size_t channel = 0u; channel < channels; ++channel)
+    {
+        first[channel] = texture_block_clamp_channel (
+            (second_second * first_value[channel] - first_second * second_value[channel]) * inverse_determinant);
+        second[channel] = texture_block_clamp_channel (
+            (first_first * second_value[channel] - first_second * first_value[channel]) * inverse_determinant);
+    }
+
+    return true;
+}
+
+static inline uint16_t texture_block_pack_565 (const float *color)
+{
+    const uint32_t red = (uint32_t) (color[0u] * 31.0f / 255.0f + 0.5f);
+    const uint32_t green = (uint32_t) (color[1u] * 63.0f / 255.0f + 0.5f);
+    const uint32_t blue = (uint32_t) (color[2u] * 31.0f / 255.0f + 0.5f);
+    return (uint16_t) ((red << 11u) | (green << 5u) | blue);
+}
+
+static inline void texture_block_unpack_565 (uint16_t packed, int32_t *output)
+{
+    const int32_t red = (packed >> 11u) & 31u;
+    const int32_t green = (packed >> 5u) & 63u;
+    const int32_t blue = packed & 31u;
+
+    output[0u] = (red << 3u) | (red >> 2u);
+    output[1u] = (green << 2u) | (green >> 4u);
+    output[2u] = (blue << 3u) | (blue >> 2u);
+}
+
+/// \brief Encodes 8 byte BC1 color block in 4 color mode, which is also used as color part of BC3.
+static void texture_block_encode_bc1_color (const struct texture_block_t *block,
+                                            enum kan_resource_texture_compression_quality_t quality,
+                                            uint8_t *output)
+{
+    // Weights of the second endpoint for every index in 4 color mode.
+    static const float index_weights[4u] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+    float first[3u];
+    float second[3u];
+    texture_block_find_endpoints (block, 3u, quality, first, second);
+
+    const kan_instance_size_t iterations =
+        quality == KAN_RESOURCE_TEXTURE_COMPRESSION_QUALITY_HIGH ? TEXTURE_BLOCK_REFINE_ITERATIONS : 0u;
+
+    uint16_t best_colors[2u] = {0u, 0u};
+    uint32_t best_indices = 0u;
+    int32_t best_error = INT32_MAX;
+
+    for (kan_loop_size_t iteration = 0u; iteration <= iterations; ++iteration)
+    {
+        // In 4 color mode the first color must be strictly bigger. Brighter endpoint is usually the second one.
+        uint16_t color_0 = texture_block_pack_565 (second);
+        uint16_t color_1 = texture_block_pack_565 (first);
+
+        if (color_0 < color_1)
+        {
+            const uint16_t temporary = color_0;
+            color_0 = color_1;
+            color_1 = temporary;
+        }
+
+        int32_t palette[4u][3u];
+        texture_block_unpack_565 (color_0, palette[0u]);
+        texture_block_unpack_565 (color_1, palette[1u]);
+
+        for (kan_loop_size_t channel = 0u; channel < 3u; ++channel)
+        {
+            palette[2u][channel] = (2 * palette[0u][channel] + palette[1u][channel] + 1) / 3;
+            palette[3u][channel] = (palette[0u][channel] + 2 * palette[1u][channel] + 1) / 3;
+        }
+
+        uint32_t indices = 0u;
+        int32_t error = 0;
+        float weights[TEXTURE_BLOCK_TEXELS];
+
+        for (kan_loop_size_t texel = 0u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+        {
+            uint32_t best_index = 0u;
+            int32_t best_texel_error = INT32_MAX;
+
+            // When colors are equal, only the first index is valid in 4 color mode.
+            const uint32_t indices_count = color_0 == color_1 ? 1u : 4u;
+            for (uint32_t index = 0u; index < indices_count; ++index)
+            {
+                int32_t texel_error = 0;
+                for (kan_loop_size_t channel = 0u; channel < 3u; ++channel)
+                {
+                    const int32_t difference = (int32_t) block->texels[texel][channel] - palette[index][channel];
+                    texel_error += difference * difference;
+                }
+
+                if (texel_error < best_texel_error)
+                {
+                    best_texel_error = texel_error;
+                    best_index = index;
+                }
+            }
+
+            indices |= best_index << (texel * 2u);
+            error += best_texel_error;
+            weights[texel] = index_weights[best_index];
+        }
+
+        if (error < best_error)
+        {
+            best_error = error;
+            best_colors[0u] = color_0;
+            best_colors[1u] = color_1;
+            best_indices = indices;
+        }
+
+        if (iteration == iterations || error == 0)
+        {
+            break;
+        }
+
+        // Weights are relative to the unpacked endpoints, so refinement produces new first and second colors.
+        float refined_first[3u];
+        float refined_second[3u];
+
+        if (!texture_block_refine_endpoints (block, 3u, weights, refined_first, refined_second))
+        {
+            break;
+        }
+
+        // Index 0 is color_0 and index 1 is color_1, so refined "first" corresponds to color_0.
+        for (kan_loop_size_t channel = 0u; channel < 3u; ++channel)
+        {
+            second[channel] = refined_first[channel];
+            first[channel] = refined_second[channel];
+        }
+    }
+
+    output[0u] = (uint8_t) (best_colors[0u] & 0xFFu);
+    output[1u] = (uint8_t) (best_colors[0u] >> 8u);
+    output[2u] = (uint8_t) (best_colors[1u] & 0xFFu);
+    output[3u] = (uint8_t) (best_colors[1u] >> 8u);
+    output[4u] = (uint8_t) (best_indices & 0xFFu);
+    output[5u] = (uint8_t) ((best_indices >> 8u) & 0xFFu);
+    output[6u] = (uint8_t) ((best_indices >> 16u) & 0xFFu);
+    output[7u] = (uint8_t) (best_indices >> 24u);
+}
+
+/// \brief Selects BC4 indices for given endpoints and mode and returns resulting error.
+static int32_t texture_block_select_bc4_indices (const uint8_t *values,
+                                                 int32_t endpoint_0,
+                                                 int32_t endpoint_1,
+                                                 uint64_t *output_indices)
+{
+    int32_t palette[8u];
+    palette[0u] = endpoint_0;
+    palette[1u] = endpoint_1;
+
+    if (endpoint_0 > endpoint_1)
+    {
+        for (int32_t index = 1; index < 7; ++index)
+        {
+            palette[index + 1] = ((7 - index) * endpoint_0 + index * endpoint_1 + 3) / 7;
+        }
+    }
+    else
+    {
+        for (int32_t index = 1; index < 5; ++index)
+        {
+            palette[index + 1] = ((5 - index) * endpoint_0 + index * endpoint_1 + 2) / 5;
+        }
+
+        palette[6u] = 0;
+        palette[7u] = 255;
+    }
+
+    uint64_t indices = 0u;
+    int32_t error = 0;
+
+    for (kan_loop_size_t texel = 0u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+    {
+        uint64_t best_index = 0u;
+        int32_t best_texel_error = INT32_MAX;
+
+        for (uint64_t index = 0u; index < 8u; ++index)
+        {
+            const int32_t difference = (int32_t) values[texel] - palette[index];
+            const int32_t texel_error = difference * difference;
+
+            if (texel_error < best_texel_error)
+            {
+                best_texel_error = texel_error;
+                best_index = index;
+            }
+        }
+
+        indices |= best_index << (texel * 3u);
+        error += best_texel_error;
+    }
+
+    *output_indices = indices;
+    return error;
+}
+
+/// \brief Encodes 8 byte BC4 block for one channel, which is also used as alpha part of BC3 and as channels of BC5.
+static void texture_block_encode_bc4 (const struct texture_block_t *block,
+                                      kan_instance_size_t channel,
+                                      enum kan_resource_texture_compression_quality_t quality,
+                                      uint8_t *output)
+{
+    uint8_t values[TEXTURE_BLOCK_TEXELS];
+    int32_t min = 255;
+    int32_t max = 0;
+
+    for (kan_loop_size_t texel = 0u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+    {
+        values[texel] = block->texels[texel][channel];
+        min = KAN_MIN (min, (int32_t) values[texel]);
+        max = KAN_MAX (max, (int32_t) values[texel]);
+    }
+
+    // 8 value mode requires first endpoint to be bigger, solid blocks naturally fall into 6 value mode.
+    int32_t endpoint_0 = max;
+    int32_t endpoint_1 = min;
+    uint64_t indices;
+    int32_t error = texture_block_select_bc4_indices (values, endpoint_0, endpoint_1, &indices);
+
+    if (quality == KAN_RESOURCE_TEXTURE_COMPRESSION_QUALITY_HIGH && error > 0)
+    {
+        // 6 value mode has exact 0 and 255, therefore its endpoints only need to cover other values.
+        int32_t inner_min = 255;
+        int32_t inner_max = 0;
+
+        for (kan_loop_size_t texel = 0u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+        {
+            if (values[texel] != 0u && values[texel] != 255u)
+            {
+                inner_min = KAN_MIN (inner_min, (int32_t) values[texel]);
+                inner_max = KAN_MAX (inner_max, (int32_t) values[texel]);
+            }
+        }
+
+        if (inner_min > inner_max)
+        {
+            inner_min = 0;
+            inner_max = 0;
+        }
+
+        uint64_t alternative_indices;
+        const int32_t alternative_error =
+            texture_block_select_bc4_indices (values, inner_min, inner_max, &alternative_indices);
+
+        if (alternative_error < error)
+        {
+            endpoint_0 = inner_min;
+            endpoint_1 = inner_max;
+            indices = alternative_indices;
+        }
+    }
+
+    output[0u] = (uint8_t) endpoint_0;
+    output[1u] = (uint8_t) endpoint_1;
+
+    for (kan_loop_size_t byte = 0u; byte < 6u; ++byte)
+    {
+        output[2u + byte] = (uint8_t) ((indices >> (byte * 8u)) & 0xFFu);
+    }
+}
+
+/// \brief Encodes 16 byte BC7 block using mode 6: one subset, RGBA endpoints with 7 bits per channel plus unique
+///        p-bit per endpoint and 4 bit indices.
+/// \details Mode 6 alone provides good quality for most color textures and is much simpler to search than
+///          multi-subset modes.
+static void texture_block_encode_bc7_mode_6 (const struct texture_block_t *block,
+                                             enum kan_resource_texture_compression_quality_t quality,
+                                             uint8_t *output)
+{
+    static const int32_t index_weights[16u] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    float endpoints[2u][4u];
+    texture_block_find_endpoints (block, 4u, quality, endpoints[0u], endpoints[1u]);
+
+    const bool high_quality = quality == KAN_RESOURCE_TEXTURE_COMPRESSION_QUALITY_HIGH;
+    const kan_instance_size_t iterations = high_quality ? TEXTURE_BLOCK_REFINE_ITERATIONS : 0u;
+
+    int32_t best_error = INT32_MAX;
+    uint32_t best_quantized[2u][4u] = {{0u, 0u, 0u, 0u}, {0u, 0u, 0u, 0u}};
+    uint32_t best_p_bits[2u] = {0u, 0u};
+    uint8_t best_indices[TEXTURE_BLOCK_TEXELS] = {0u};
+
+    for (kan_loop_size_t iteration = 0u; iteration <= iterations; ++iteration)
+    {
+        // High quality tries every p-bit combination, others select p-bit with the least quantization error.
+        uint32_t p_bit_candidates[4u][2u];
+        kan_instance_size_t p_bit_candidates_count = 0u;
+
+        if (high_quality)
+        {
+            for (uint32_t combination = 0u; combination < 4u; ++combination)
+            {
+                p_bit_candidates[combination][0u] = combination & 1u;
+                p_bit_candidates[combination][1u] = combination >> 1u;
+            }
+
+            p_bit_candidates_count = 4u;
+        }
+        else
+        {
+            for (kan_loop_size_t endpoint = 0u; endpoint < 2u; ++endpoint)
+            {
+                float errors[2u] = {0.0f, 0.0f};
+                for (uint32_t p_bit = 0u; p_bit < 2u; ++p_bit)
+                {
+                    for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+                    {
+                        const float quantized =
+                            KAN_CLAMP (floorf ((endpoints[endpoint][channel] - (float) p_bit) * 0.5f + 0.5f), 0.0f,
+                                       127.0f);
+                        const float difference = quantized * 2.0f + (float) p_bit - endpoints[endpoint][channel];
+                        errors[p_bit] += difference * difference;
+                    }
+                }
+
+                p_bit_candidates[0u][endpoint] = errors[1u] < errors[0u] ? 1u : 0u;
+            }
+
+            p_bit_candidates_count = 1u;
+        }
+
+        float weights[TEXTURE_BLOCK_TEXELS];
+        for (kan_loop_size_t candidate = 0u; candidate < p_bit_candidates_count; ++candidate)
+        {
+            uint32_t quantized[2u][4u];
+            int32_t palette_endpoints[2u][4u];
+
+            for (kan_loop_size_t endpoint = 0u; endpoint < 2u; ++endpoint)
+            {
+                const uint32_t p_bit = p_bit_candidates[candidate][endpoint];
+                for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+                {
+                    quantized[endpoint][channel] = (uint32_t) KAN_CLAMP (
+                        floorf ((endpoints[endpoint][channel] - (float) p_bit) * 0.5f + 0.5f), 0.0f, 127.0f);
+                    palette_endpoints[endpoint][channel] = (int32_t) ((quantized[endpoint][channel] << 1u) | p_bit);
+                }
+            }
+
+            int32_t palette[16u][4u];
+            for (kan_loop_size_t index = 0u; index < 16u; ++index)
+            {
+                for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+                {
+                    palette[index][channel] = ((64 - index_weights[index]) * palette_endpoints[0u][channel] +
+                                               index_weights[index] * palette_endpoints[1u][channel] + 32) >>
+                                              6;
+                }
+            }
+
+            uint8_t indices[TEXTURE_BLOCK_TEXELS];
+            int32_t error = 0;
+
+            for (kan_loop_size_t texel = 0u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+            {
+                uint8_t best_index = 0u;
+                int32_t best_texel_error = INT32_MAX;
+
+                for (uint8_t index = 0u; index < 16u; ++index)
+                {
+                    int32_t texel_error = 0;
+                    for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+                    {
+                        const int32_t difference = (int32_t) block->texels[texel][channel] - palette[index][channel];
+                        texel_error += difference * difference;
+                    }
+
+                    if (texel_error < best_texel_error)
+                    {
+                        best_texel_error = texel_error;
+                        best_index = index;
+                    }
+                }
+
+                indices[texel] = best_index;
+                error += best_texel_error;
+            }
+
+            if (error < best_error)
+            {
+                best_error = error;
+                memcpy (best_quantized, quantized, sizeof (quantized));
+                best_p_bits[0u] = p_bit_candidates[candidate][0u];
+                best_p_bits[1u] = p_bit_candidates[candidate][1u];
+                memcpy (best_indices, indices, sizeof (indices));
+            }
+        }
+
+        if (iteration == iterations || best_error == 0)
+        {
+            break;
+        }
+
+        for (kan_loop_size_t texel = 0u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+        {
+            weights[texel] = (float) index_weights[best_indices[texel]] / 64.0f;
+        }
+
+        if (!texture_block_refine_endpoints (block, 4u, weights, endpoints[0u], endpoints[1u]))
+        {
+            break;
+        }
+    }
+
+    // Most significant bit of the first index is implicitly zero, so endpoints are swapped when needed.
+    if (best_indices[0u] & 8u)
+    {
+        for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+        {
+            const uint32_t temporary = best_quantized[0u][channel];
+            best_quantized[0u][channel] = best_quantized[1u][channel];
+            best_quantized[1u][channel] = temporary;
+        }
+
+        const uint32_t temporary = best_p_bits[0u];
+        best_p_bits[0u] = best_p_bits[1u];
+        best_p_bits[1u] = temporary;
+
+        for (kan_loop_size_t texel = 0u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+        {
+            best_indices[texel] = (uint8_t) (15u - best_indices[texel]);
+        }
+    }
+
+    memset (output, 0, 16u);
+    struct texture_bit_writer_t writer = {
+        .output = output,
+        .position = 0u,
+    };
+
+    // Mode 6 is encoded as 6 zero bits followed by one.
+    texture_bit_writer_write (&writer, 1u << 6u, 7u);
+
+    for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+    {
+        texture_bit_writer_write (&writer, best_quantized[0u][channel], 7u);
+        texture_bit_writer_write (&writer, best_quantized[1u][channel], 7u);
+    }
+
+    texture_bit_writer_write (&writer, best_p_bits[0u], 1u);
+    texture_bit_writer_write (&writer, best_p_bits[1u], 1u);
+    texture_bit_writer_write (&writer, best_indices[0u], 3u);
+
+    for (kan_loop_size_t texel = 1u; texel < TEXTURE_BLOCK_TEXELS; ++texel)
+    {
+        texture_bit_writer_write (&writer, best_indices[texel], 4u);
+    }
+
+    KAN_ASSERT (writer.position == 128u)
+}
+
+/// \brief Parallel for user data for compressing texture data by bands of block rows.
+struct texture_block_compression_t
+{
+    kan_instance_size_t rows_per_band;
+    kan_instance_size_t blocks_y;
+
+    enum kan_resource_texture_format_t format;
+    enum kan_resource_texture_compression_quality_t quality;
+    const float *source_data;
+    kan_instance_size_t width;
+    kan_instance_size_t height;
+    kan_instance_size_t blocks_x;
+    kan_instance_size_t block_size;
+    bool srgb;
+    uint8_t *output;
+};
+
+static void texture_block_compression_process_rows (struct texture_block_compression_t *compression,
+                                                    kan_instance_size_t row_begin,
+                                                    kan_instance_size_t row_end)
+{
+    for (kan_loop_size_t block_y = row_begin; block_y < row_end; ++block_y)
+    {
+        for (kan_loop_size_t block_x = 0u; block_x < compression->blocks_x; ++block_x)
+        {
+            // Edge blocks of images with sizes that are not multiple of 4 repeat edge texels.
+            struct texture_block_t block;
+            for (kan_loop_size_t texel_y = 0u; texel_y < 4u; ++texel_y)
+            {
+                const kan_instance_size_t source_y = KAN_MIN (block_y * 4u + texel_y, compression->height - 1u);
+                for (kan_loop_size_t texel_x = 0u; texel_x < 4u; ++texel_x)
+                {
+                    const kan_instance_size_t source_x = KAN_MIN (block_x * 4u + texel_x, compression->width - 1u);
+                    const float *source_pixel =
+                        compression->source_data + (source_y * compression->width + source_x) * 4u;
+                    uint8_t *texel = block.texels[texel_y * 4u + texel_x];
+
+                    for (kan_loop_size_t channel = 0u; channel < 4u; ++channel)
+                    {
+                        const float value = compression->srgb ? kan_color_transfer_rgb_to_srgb (source_pixel[channel]) :
+                                                                source_pixel[channel];
+                        texel[channel] = (uint8_t) (255.0f * KAN_CLAMP (value, 0.0f, 1.0f));
+                    }
+                }
+            }
+
+            uint8_t *output =
+                compression->output + (block_y * compression->blocks_x + block_x) * compression->block_size;
+
+            switch (compression->format)
+            {
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_SRGB:
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_UNORM:
+                texture_block_encode_bc1_color (&block, compression->quality, output);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_SRGB:
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_UNORM:
+                texture_block_encode_bc4 (&block, 3u, compression->quality, output);
+                texture_block_encode_bc1_color (&block, compression->quality, output + 8u);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC4_R_UNORM:
+                texture_block_encode_bc4 (&block, 0u, compression->quality, output);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC5_RG_UNORM:
+                texture_block_encode_bc4 (&block, 0u, compression->quality, output);
+                texture_block_encode_bc4 (&block, 1u, compression->quality, output + 8u);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_SRGB:
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_UNORM:
+                texture_block_encode_bc7_mode_6 (&block, compression->quality, output);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_R8_SRGB:
+            case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_RG16_SRGB:
+            case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_RGBA32_SRGB:
+            case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_R8_UNORM:
+            case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_RG16_UNORM:
+            case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_RGBA32_UNORM:
+            case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_D16:
+            case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_D32:
+                KAN_ASSERT (false)
+                break;
+            }
+        }
+    }
+}
+
+static void texture_block_compression_process_band (kan_functor_user_data_t user_data,
+                                                    kan_instance_size_t worker_index,
+                                                    kan_instance_size_t band)
+{
+    struct texture_block_compression_t *compression = (struct texture_block_compression_t *) user_data;
+    const kan_instance_size_t row_begin = band * compression->rows_per_band;
+    const kan_instance_size_t row_end = KAN_MIN (row_begin + compression->rows_per_band, compression->blocks_y);
+    texture_block_compression_process_rows (compression, row_begin, row_end);
+}
+
+kan_instance_size_t kan_resource_texture_format_block_size (enum kan_resource_texture_format_t format)
+{
+    switch (format)
+    {
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_SRGB:
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_UNORM:
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC4_R_UNORM:
+        return 8u;
+
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_SRGB:
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_UNORM:
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC5_RG_UNORM:
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_SRGB:
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_UNORM:
+        return 16u;
+
+    case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_R8_SRGB:
+    case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_RG16_SRGB:
+    case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_RGBA32_SRGB:
+    case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_R8_UNORM:
+    case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_RG16_UNORM:
+    case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_RGBA32_UNORM:
+    case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_D16:
+    case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_D32:
+        break;
+    }
+
+    return 0u;
+}
+
+void kan_resource_texture_compress_blocks (enum kan_resource_texture_format_t format,
+                                           enum kan_resource_texture_compression_quality_t quality,
+                                           const float *source_data,
+                                           kan_instance_size_t width,
+                                           kan_instance_size_t height,
+                                           uint8_t *output)
+{
+    const kan_instance_size_t block_size = kan_resource_texture_format_block_size (format);
+    KAN_ASSERT (block_size > 0u)
+
+    const bool srgb = format == KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_SRGB ||
+                      format == KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_SRGB ||
+                      format == KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_SRGB;
+
+    const kan_instance_size_t blocks_x = (width + 3u) / 4u;
+    const kan_instance_size_t blocks_y = (height + 3u) / 4u;
+
+    const kan_instance_size_t rows_per_band = KAN_MAX (1u, KAN_RESOURCE_RF_TEXTURE_COMPRESSION_BAND_BLOCKS / blocks_x);
+    const kan_instance_size_t bands_count = (blocks_y + rows_per_band - 1u) / rows_per_band;
+
+    struct texture_block_compression_t compression = {
+        .rows_per_band = rows_per_band,
+        .blocks_y = blocks_y,
+        .format = format,
+        .quality = quality,
+        .source_data = source_data,
+        .width = width,
+        .height = height,
+        .blocks_x = blocks_x,
+        .block_size = block_size,
+        .srgb = srgb,
+        .output = output,
+    };
+
+    if (bands_count <= 1u)
+    {
+        texture_block_compression_process_rows (&compression, 0u, blocks_y);
+        return;
+    }
+
+    kan_cpu_parallel_for_execute ((struct kan_cpu_parallel_for_t) {
+        .function = texture_block_compression_process_band,
+        .user_data = (kan_functor_user_data_t) &compression,
+        .items_count = bands_count,
+        .max_helpers = KAN_INT_MAX (kan_instance_size_t),
+        .helper_profiler_section = kan_cpu_section_get ("texture_compression_band"),
+    });
+}
+
+/// \brief Compresses given mip data in RGBA floating point format into given block compressed format.
+static void compress_texture_blocks (struct kan_resource_texture_data_t *texture_data,
+                                     enum kan_resource_texture_format_t format,
+                                     enum kan_resource_texture_compression_quality_t quality,
+                                     const float *source_data,
+                                     kan_instance_size_t width,
+                                     kan_instance_size_t height)
+{
+    const kan_instance_size_t blocks_count = ((width + 3u) / 4u) * ((height + 3u) / 4u);
+    const kan_instance_size_t block_size = kan_resource_texture_format_block_size (format);
+    kan_dynamic_array_set_capacity (&texture_data->data, blocks_count * block_size);
+    texture_data->data.size = texture_data->data.capacity;
+    kan_resource_texture_compress_blocks (format, quality, source_data, width, height, texture_data->data.data);
+}
+
 static enum kan_resource_build_rule_result_t texture_build (struct kan_resource_build_rule_context_t *context)
 {
     const struct kan_resource_texture_header_t *input = context->primary_input;
@@ -287,99 +1519,22 @@ static enum kan_resource_build_rule_result_t texture_build (struct kan_resource_
     }
 
     CUSHION_DEFER { free_transitive_mip_data (image_mips, image_channels, output, mips_allocation_group); };
+    const enum kan_resource_texture_mip_instruction_set_t mip_instruction_set =
+        kan_resource_texture_mip_instruction_set_select_best ();
+
     for (kan_loop_size_t next_mip = 1u; next_mip < output->mips; ++next_mip)
     {
         const kan_instance_size_t source_width = output->width >> (next_mip - 1u);
         KAN_ASSERT (source_width > 0u)
-        const kan_instance_size_t source_height = output->height >> (next_mip - 1u);
-        KAN_ASSERT (source_height > 0u)
 
         const kan_instance_size_t mip_width = output->width >> next_mip;
         KAN_ASSERT (mip_width > 0u)
         const kan_instance_size_t mip_height = output->height >> next_mip;
         KAN_ASSERT (mip_height > 0u)
 
-        const float *source_data = image_mips[next_mip - 1u];
-        float *target_data = image_mips[next_mip];
-
-        for (kan_loop_size_t x = 0u; x < (kan_loop_size_t) mip_width; ++x)
-        {
-            for (kan_loop_size_t y = 0u; y < (kan_loop_size_t) mip_height; ++y)
-            {
-                float *mip_pixel = target_data + image_channels * (x * mip_height + y);
-                for (kan_loop_size_t channel = 0u; channel < image_channels; ++channel)
-                {
-                    switch (preset->mip_generation)
-                    {
-                    case KAN_RESOURCE_TEXTURE_MIP_GENERATION_AVERAGE:
-                        mip_pixel[channel] = 0.0f;
-                        break;
-
-                    case KAN_RESOURCE_TEXTURE_MIP_GENERATION_MIN:
-                        mip_pixel[channel] = FLT_MAX;
-                        break;
-
-                    case KAN_RESOURCE_TEXTURE_MIP_GENERATION_MAX:
-                        mip_pixel[channel] = FLT_MIN;
-                        break;
-                    }
-                }
-
-                kan_loop_size_t average_samples = 0u;
-                for (kan_loop_size_t offset_x = 0u; offset_x < 2u; ++offset_x)
-                {
-                    for (kan_loop_size_t offset_y = 0u; offset_y < 2u; ++offset_y)
-                    {
-                        const kan_loop_size_t sample_x = x * 2u + offset_x;
-                        const kan_loop_size_t sample_y = y * 2u + offset_y;
-
-                        if (sample_x < source_width && sample_y < source_height)
-                        {
-                            const float *sample_pixel =
-                                source_data + image_channels * (sample_x * source_height + sample_y);
-                            ++average_samples;
-
-                            for (kan_loop_size_t channel = 0u; channel < image_channels; ++channel)
-                            {
-                                switch (preset->mip_generation)
-                                {
-                                case KAN_RESOURCE_TEXTURE_MIP_GENERATION_AVERAGE:
-                                    mip_pixel[channel] += sample_pixel[channel];
-                                    break;
-
-                                case KAN_RESOURCE_TEXTURE_MIP_GENERATION_MIN:
-                                    mip_pixel[channel] = KAN_MIN (mip_pixel[channel], sample_pixel[channel]);
-                                    break;
-
-                                case KAN_RESOURCE_TEXTURE_MIP_GENERATION_MAX:
-                                    mip_pixel[channel] = KAN_MAX (mip_pixel[channel], sample_pixel[channel]);
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-
-                switch (preset->mip_generation)
-                {
-                case KAN_RESOURCE_TEXTURE_MIP_GENERATION_AVERAGE:
-                {
-                    KAN_ASSERT (average_samples > 0u)
-                    const float average_modifier = 1.0f / (float) average_samples;
-                    for (kan_loop_size_t channel = 0u; channel < image_channels; ++channel)
-                    {
-                        mip_pixel[channel] *= average_modifier;
-                    }
-
-                    break;
-                }
-
-                case KAN_RESOURCE_TEXTURE_MIP_GENERATION_MIN:
-                case KAN_RESOURCE_TEXTURE_MIP_GENERATION_MAX:
-                    break;
-                }
-            }
-        }
+        kan_resource_texture_generate_mip (preset->mip_generation, mip_instruction_set, image_channels,
+                                           image_mips[next_mip - 1u], source_width, image_mips[next_mip], mip_width,
+                                           mip_height);
     }
 
     struct kan_resource_texture_data_t texture_data;
@@ -424,6 +1579,14 @@ static enum kan_resource_build_rule_result_t texture_build (struct kan_resource_
         case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_R8_UNORM:
         case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_RG16_UNORM:
         case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_RGBA32_UNORM:
+        case KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_SRGB:
+        case KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_UNORM:
+        case KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_SRGB:
+        case KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_UNORM:
+        case KAN_RESOURCE_TEXTURE_FORMAT_BC4_R_UNORM:
+        case KAN_RESOURCE_TEXTURE_FORMAT_BC5_RG_UNORM:
+        case KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_SRGB:
+        case KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_UNORM:
             switch (input->image_class)
             {
             case KAN_RESOURCE_TEXTURE_IMAGE_CLASS_COLOR_SRGB:
@@ -626,8 +1789,56 @@ static enum kan_resource_build_rule_result_t texture_build (struct kan_resource_
                 memcpy (texture_data.data.data, image_mips[mip], sizeof (float) * width * height);
                 break;
             }
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_SRGB:
+                target_format_name = "bc1_srgb";
+                compress_texture_blocks (&texture_data, format, preset->compression_quality, image_mips[mip], width,
+                                         height);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_UNORM:
+                target_format_name = "bc1_unorm";
+                compress_texture_blocks (&texture_data, format, preset->compression_quality, image_mips[mip], width,
+                                         height);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_SRGB:
+                target_format_name = "bc3_srgb";
+                compress_texture_blocks (&texture_data, format, preset->compression_quality, image_mips[mip], width,
+                                         height);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_UNORM:
+                target_format_name = "bc3_unorm";
+                compress_texture_blocks (&texture_data, format, preset->compression_quality, image_mips[mip], width,
+                                         height);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC4_R_UNORM:
+                target_format_name = "bc4_unorm";
+                compress_texture_blocks (&texture_data, format, preset->compression_quality, image_mips[mip], width,
+                                         height);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC5_RG_UNORM:
+                target_format_name = "bc5_unorm";
+                compress_texture_blocks (&texture_data, format, preset->compression_quality, image_mips[mip], width,
+                                         height);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_SRGB:
+                target_format_name = "bc7_srgb";
+                compress_texture_blocks (&texture_data, format, preset->compression_quality, image_mips[mip], width,
+                                         height);
+                break;
+
+            case KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_UNORM:
+                target_format_name = "bc7_unorm";
+                compress_texture_blocks (&texture_data, format, preset->compression_quality, image_mips[mip], width,
+                                         height);
+                break;
             }
-#undef CLAMPED_COLOR
+#undef CLAMPED_UINT_COLOR
 
             char name_buffer[KAN_RESOURCE_RF_TEXTURE_DATA_MAX_NAME_LENGTH];
             snprintf (name_buffer, sizeof (name_buffer), "%s_%s_mip_%u", context->primary_name, target_format_name,
@@ -53,6 +53,33 @@ enum kan_resource_texture_mip_generation_t
     KAN_RESOURCE_TEXTURE_MIP_GENERATION_MAX,
 };
 
+/// \brief Enumerates instruction sets that can be used by mip generation kernels.
+enum kan_resource_texture_mip_instruction_set_t
+{
+    /// \brief Plain scalar code, always supported.
+    KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_SCALAR = 0u,
+
+    /// \brief SSE2 kernels, supported when build targets SSE2.
+    KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_SSE2,
+
+    /// \brief AVX2 kernels, compiled for every x86 build and selected only if CPU supports AVX2.
+    KAN_RESOURCE_TEXTURE_MIP_INSTRUCTION_SET_AVX2,
+};
+
+/// \brief Enumerates quality presets for block compressed texture formats.
+/// \details Quality preset only affects encoding speed and precision, block layout is always the same.
+enum kan_resource_texture_compression_quality_t
+{
+    /// \brief Endpoints are selected using block bounding box. Fastest, but gradients lose precision.
+    KAN_RESOURCE_TEXTURE_COMPRESSION_QUALITY_FAST = 0u,
+
+    /// \brief Endpoints are selected along principal axis of block colors.
+    KAN_RESOURCE_TEXTURE_COMPRESSION_QUALITY_NORMAL,
+
+    /// \brief Principal axis endpoints are refined using least squares and more encoding variants are tried.
+    KAN_RESOURCE_TEXTURE_COMPRESSION_QUALITY_HIGH,
+};
+
 /// \brief Describes common configuration for building a category of textures.
 struct kan_resource_texture_build_preset_t
 {
@@ -64,6 +91,9 @@ struct kan_resource_texture_build_preset_t
     /// \brief Formats in which this texture can be built and stored.
     KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (enum kan_resource_texture_format_t)
     struct kan_dynamic_array_t supported_target_formats;
+
+    /// \brief Quality of block compression for block compressed target formats.
+    enum kan_resource_texture_compression_quality_t compression_quality;
 };
 
 RESOURCE_RENDER_FOUNDATION_BUILD_API void kan_resource_texture_build_preset_init (
@@ -101,4 +131,44 @@ struct kan_resource_texture_header_t
 RESOURCE_RENDER_FOUNDATION_BUILD_API void kan_resource_texture_header_init (
     struct kan_resource_texture_header_t *instance);
 
+/// \brief Returns size of one 4x4 block in bytes for block compressed formats and zero for other formats.
+RESOURCE_RENDER_FOUNDATION_BUILD_API kan_instance_size_t
+kan_resource_texture_format_block_size (enum kan_resource_texture_format_t format);
+
+/// \brief Returns whether mip kernels for given instruction set are compiled in and supported by current CPU.
+RESOURCE_RENDER_FOUNDATION_BUILD_API bool kan_resource_texture_mip_instruction_set_is_supported (
+    enum kan_resource_texture_mip_instruction_set_t instruction_set);
+
+/// \brief Returns the best instruction set for mip kernels that is supported by current CPU.
+RESOURCE_RENDER_FOUNDATION_BUILD_API enum kan_resource_texture_mip_instruction_set_t
+kan_resource_texture_mip_instruction_set_select_best (void);
+
+/// \brief Generates next mip from given image in floating point format with 1 or 4 channels.
+/// \details Used by texture build rule, but exposed in order to make it possible to test kernels for every supported
+///          instruction set against scalar ones. Target size must be equal to source size divided by two and rounded
+///          down, last row and column of odd sized source is skipped. Large mips are split into row bands that are
+///          processed in parallel, therefore it is safe and beneficial to call it from cpu tasks.
+RESOURCE_RENDER_FOUNDATION_BUILD_API void kan_resource_texture_generate_mip (
+    enum kan_resource_texture_mip_generation_t mode,
+    enum kan_resource_texture_mip_instruction_set_t instruction_set,
+    kan_instance_size_t channels,
+    const float *source_data,
+    kan_instance_size_t source_width,
+    float *target_data,
+    kan_instance_size_t target_width,
+    kan_instance_size_t target_height);
+
+/// \brief Compresses image in RGBA floating point format into given block compressed format.
+/// \details Used by texture build rule, but exposed in order to make it possible to test and reuse block encoders.
+///          Output must be able to store `ceil(width / 4) * ceil(height / 4)` blocks of
+///          `kan_resource_texture_format_block_size` bytes each. Large images are split into bands of block rows that
+///          are compressed in parallel.
+RESOURCE_RENDER_FOUNDATION_BUILD_API void kan_resource_texture_compress_blocks (
+    enum kan_resource_texture_format_t format,
+    enum kan_resource_texture_compression_quality_t quality,
+    const float *source_data,
+    kan_instance_size_t width,
+    kan_instance_size_t height,
+    uint8_t *output);
+
 KAN_C_HEADER_END
@@ -1546,6 +1546,19 @@ void kan_serialization_interned_string_registry_destroy (kan_serialization_inter
     kan_free_general (interned_string_registry_allocation_group, data, sizeof (struct interned_string_registry_t));
 }
 
+void kan_serialization_interned_string_registry_merge (kan_serialization_interned_string_registry_t target,
+                                                       kan_serialization_interned_string_registry_t source)
+{
+    struct interned_string_registry_t *target_data = KAN_HANDLE_GET (target);
+    struct interned_string_registry_t *source_data = KAN_HANDLE_GET (source);
+
+    for (kan_loop_size_t index = 0u; index < source_data->index_to_value.size; ++index)
+    {
+        interned_string_registry_store_string (target_data,
+                                               ((kan_interned_string_t *) source_data->index_to_value.data)[index]);
+    }
+}
+
 kan_serialization_interned_string_registry_reader_t kan_serialization_interned_string_registry_reader_create (
     struct kan_stream_t *stream, bool load_only_registry)
 {
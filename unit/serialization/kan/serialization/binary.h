@@ -90,6 +90,12 @@ kan_serialization_interned_string_registry_create_empty (void);
 SERIALIZATION_API void kan_serialization_interned_string_registry_destroy (
     kan_serialization_interned_string_registry_t registry);
 
+/// \brief Stores all strings from source registry in target registry, preserving their order from source registry.
+/// \details Strings that are already present in target registry keep their indices. Useful for collecting strings in
+///          separate registries in parallel and then merging them in deterministic order.
+SERIALIZATION_API void kan_serialization_interned_string_registry_merge (
+    kan_serialization_interned_string_registry_t target, kan_serialization_interned_string_registry_t source);
+
 #define KAN_INVALID_SERIALIZATION_INTERNED_STRING_REGISTRY_READER 0u
 
 KAN_HANDLE_DEFINE (kan_serialization_interned_string_registry_reader_t);
@@ -13,6 +13,17 @@
 /// Random access stream buffers are wrappers for random access read and write streams that use buffering to reduce
 /// count of low level IO operations.
 /// \endparblock
+///
+/// \par Read ahead
+/// \parblock
+/// Read ahead stream buffers use two blocks: while user reads data from the current block, the next block is read from
+/// the source stream on background IO thread. It makes it possible to overlap IO with data processing, for example
+/// with deserialization. Block size is adapted to the source stream size: streams that fit into one block are read
+/// once into exactly sized buffer without any background reading.
+///
+/// Source stream is accessed from background thread, therefore it must not be used by anyone else until proxy stream
+/// is closed, which is already true for all the proxy streams.
+/// \endparblock
 
 KAN_C_HEADER_BEGIN
 
@@ -20,6 +31,12 @@ KAN_C_HEADER_BEGIN
 STREAM_API struct kan_stream_t *kan_random_access_stream_buffer_open_for_read (struct kan_stream_t *source_stream,
                                                                                kan_file_size_t buffer_size);
 
+/// \brief Wraps given source read stream into double buffer with read ahead. Returns buffered proxy stream.
+/// \details Block size is calculated from the source stream size and is clamped to given minimum and maximum.
+STREAM_API struct kan_stream_t *kan_random_access_stream_buffer_open_for_read_ahead (struct kan_stream_t *source_stream,
+                                                                                     kan_file_size_t min_block_size,
+                                                                                     kan_file_size_t max_block_size);
+
 /// \brief Wraps given source write stream into buffer with given size. Returns buffered proxy stream.
 STREAM_API struct kan_stream_t *kan_random_access_stream_buffer_open_for_write (struct kan_stream_t *source_stream,
                                                                                 kan_file_size_t buffer_size);
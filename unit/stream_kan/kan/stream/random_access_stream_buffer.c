@@ -1,5 +1,6 @@
 #define _CRT_SECURE_NO_WARNINGS __CUSHION_PRESERVE__
 
+#include <stdlib.h>
 #include <string.h>
 
 #include <kan/api_common/alignment.h>
@@ -7,6 +8,10 @@
 #include <kan/error/critical.h>
 #include <kan/memory/allocation.h>
 #include <kan/stream/random_access_stream_buffer.h>
+#include <kan/threading/atomic.h>
+#include <kan/threading/conditional_variable.h>
+#include <kan/threading/mutex.h>
+#include <kan/threading/thread.h>
 
 static bool allocation_group_ready = false;
 static kan_allocation_group_t allocation_group;
@@ -227,64 +232,49 @@ static kan_file_size_t buffered_tell (struct kan_stream_t *stream)
     return data->stream_position;
 }
 
-static bool buffered_seek (struct kan_stream_t *stream, enum kan_stream_seek_pivot pivot, kan_file_offset_t offset)
+static inline kan_file_size_t calculate_seek_position (kan_file_size_t position,
+                                                       kan_file_size_t size,
+                                                       enum kan_stream_seek_pivot pivot,
+                                                       kan_file_offset_t offset)
 {
-    struct random_access_stream_buffer_t *data = (struct random_access_stream_buffer_t *) stream;
-    if (data->as_stream.operations->write)
-    {
-        buffered_flush (stream);
-    }
-
     switch (pivot)
     {
     case KAN_STREAM_SEEK_START:
         KAN_ASSERT (offset >= 0)
-        data->stream_position = (kan_file_size_t) offset;
-
-        if (data->stream_position > data->stream_size)
-        {
-            data->stream_position = data->stream_size;
-        }
-
-        break;
+        return KAN_MIN ((kan_file_size_t) offset, size);
 
     case KAN_STREAM_SEEK_CURRENT:
+    case KAN_STREAM_SEEK_END:
     {
-        kan_file_offset_t position_signed = (kan_file_offset_t) data->stream_position;
-        position_signed += offset;
+        kan_file_offset_t position_signed =
+            (kan_file_offset_t) (pivot == KAN_STREAM_SEEK_CURRENT ? position : size) + offset;
 
         if (position_signed < 0)
         {
             position_signed = 0;
         }
-        else if (position_signed > (kan_file_offset_t) data->stream_size)
+        else if (position_signed > (kan_file_offset_t) size)
         {
-            position_signed = (kan_file_offset_t) data->stream_size;
+            position_signed = (kan_file_offset_t) size;
         }
 
-        data->stream_position = (kan_file_size_t) position_signed;
-        break;
+        return (kan_file_size_t) position_signed;
+    }
     }
 
-    case KAN_STREAM_SEEK_END:
-    {
-        kan_file_offset_t position_signed = (kan_file_offset_t) data->stream_size;
-        position_signed += offset;
-
-        if (position_signed < 0)
-        {
-            position_signed = 0;
-        }
-        else if (position_signed > (kan_file_offset_t) data->stream_size)
-        {
-            position_signed = (kan_file_offset_t) data->stream_size;
-        }
+    KAN_ASSERT (false)
+    return position;
+}
 
-        data->stream_position = (kan_file_size_t) position_signed;
-        break;
-    }
+static bool buffered_seek (struct kan_stream_t *stream, enum kan_stream_seek_pivot pivot, kan_file_offset_t offset)
+{
+    struct random_access_stream_buffer_t *data = (struct random_access_stream_buffer_t *) stream;
+    if (data->as_stream.operations->write)
+    {
+        buffered_flush (stream);
     }
 
+    data->stream_position = calculate_seek_position (data->stream_position, data->stream_size, pivot, offset);
     if (data->as_stream.operations->write)
     {
         data->buffer_position = data->stream_position;
@@ -323,6 +313,294 @@ static struct kan_stream_operations_t random_access_stream_buffer_write_operatio
     .close = buffered_close,
 };
 
+#define READ_AHEAD_STATE_NONE 0u
+#define READ_AHEAD_STATE_QUEUED 1u
+#define READ_AHEAD_STATE_READY 2u
+#define READ_AHEAD_STATE_FAILED 3u
+
+struct read_ahead_stream_buffer_t
+{
+    struct kan_stream_t as_stream;
+    struct kan_stream_t *source_stream;
+    kan_file_size_t stream_position;
+    kan_file_size_t stream_size;
+    kan_file_size_t block_size;
+
+    kan_file_size_t current_position;
+    kan_file_size_t current_size;
+    uint8_t *current_block;
+
+    /// \brief Read ahead state is protected by read ahead context mutex.
+    /// \details While read ahead is queued, source stream and read ahead block belong to the read ahead thread.
+    unsigned int read_ahead_state;
+    struct read_ahead_stream_buffer_t *read_ahead_next;
+    kan_file_size_t read_ahead_position;
+    kan_file_size_t read_ahead_size;
+    uint8_t *read_ahead_block;
+
+    uint8_t blocks[];
+};
+
+struct read_ahead_context_t
+{
+    kan_mutex_t mutex;
+    kan_conditional_variable_t queue_signal;
+    kan_conditional_variable_t finish_signal;
+    struct read_ahead_stream_buffer_t *queue_first;
+    struct read_ahead_stream_buffer_t *queue_last;
+    bool shutting_down;
+    kan_thread_t threads[KAN_STREAM_READ_AHEAD_THREADS];
+};
+
+static bool read_ahead_context_ready = false;
+static struct kan_atomic_int_t read_ahead_context_init_lock = {.value = 0};
+static struct read_ahead_context_t read_ahead_context;
+
+static kan_thread_result_t read_ahead_thread_function (kan_thread_user_data_t user_data)
+{
+    kan_mutex_lock (read_ahead_context.mutex);
+    while (true)
+    {
+        while (!read_ahead_context.queue_first && !read_ahead_context.shutting_down)
+        {
+            kan_conditional_variable_wait (read_ahead_context.queue_signal, read_ahead_context.mutex);
+        }
+
+        if (read_ahead_context.shutting_down)
+        {
+            kan_mutex_unlock (read_ahead_context.mutex);
+            return 0;
+        }
+
+        struct read_ahead_stream_buffer_t *data = read_ahead_context.queue_first;
+        read_ahead_context.queue_first = data->read_ahead_next;
+
+        if (!read_ahead_context.queue_first)
+        {
+            read_ahead_context.queue_last = NULL;
+        }
+
+        kan_mutex_unlock (read_ahead_context.mutex);
+        const bool successful =
+            data->source_stream->operations->seek (data->source_stream, KAN_STREAM_SEEK_START,
+                                                   (kan_file_offset_t) data->read_ahead_position) &&
+            data->source_stream->operations->read (data->source_stream, data->read_ahead_size,
+                                                   data->read_ahead_block) == data->read_ahead_size;
+
+        kan_mutex_lock (read_ahead_context.mutex);
+        data->read_ahead_state = successful ? READ_AHEAD_STATE_READY : READ_AHEAD_STATE_FAILED;
+        kan_conditional_variable_signal_all (read_ahead_context.finish_signal);
+    }
+}
+
+static void shutdown_read_ahead_context (void)
+{
+    kan_mutex_lock (read_ahead_context.mutex);
+    read_ahead_context.shutting_down = true;
+    kan_conditional_variable_signal_all (read_ahead_context.queue_signal);
+    kan_mutex_unlock (read_ahead_context.mutex);
+
+    for (kan_loop_size_t index = 0u; index < KAN_STREAM_READ_AHEAD_THREADS; ++index)
+    {
+        kan_thread_wait (read_ahead_context.threads[index]);
+    }
+}
+
+static void ensure_read_ahead_context_ready (void)
+{
+    if (!read_ahead_context_ready)
+    {
+        // Initialization clash is a really rare situation, but must be checked any way.
+        KAN_ATOMIC_INT_SCOPED_LOCK (&read_ahead_context_init_lock)
+
+        if (!read_ahead_context_ready)
+        {
+            read_ahead_context.mutex = kan_mutex_create ();
+            read_ahead_context.queue_signal = kan_conditional_variable_create ();
+            read_ahead_context.finish_signal = kan_conditional_variable_create ();
+            read_ahead_context.queue_first = NULL;
+            read_ahead_context.queue_last = NULL;
+            read_ahead_context.shutting_down = false;
+
+            for (kan_loop_size_t index = 0u; index < KAN_STREAM_READ_AHEAD_THREADS; ++index)
+            {
+                read_ahead_context.threads[index] =
+                    kan_thread_create ("stream_read_ahead", read_ahead_thread_function, NULL);
+                KAN_ASSERT (KAN_HANDLE_IS_VALID (read_ahead_context.threads[index]))
+            }
+
+            atexit (shutdown_read_ahead_context);
+            read_ahead_context_ready = true;
+        }
+    }
+}
+
+/// \brief Waits until queued read ahead, if any, is finished. Source stream can be safely used after that.
+static inline void read_ahead_wait (struct read_ahead_stream_buffer_t *data)
+{
+    kan_mutex_lock (read_ahead_context.mutex);
+    while (data->read_ahead_state == READ_AHEAD_STATE_QUEUED)
+    {
+        kan_conditional_variable_wait (read_ahead_context.finish_signal, read_ahead_context.mutex);
+    }
+
+    kan_mutex_unlock (read_ahead_context.mutex);
+}
+
+/// \brief Queues read of the block right after the current one. Source stream must not be in use.
+static inline void read_ahead_schedule (struct read_ahead_stream_buffer_t *data)
+{
+    const kan_file_size_t position = data->current_position + data->current_size;
+    if (position >= data->stream_size)
+    {
+        return;
+    }
+
+    data->read_ahead_position = position;
+    data->read_ahead_size = KAN_MIN (data->stream_size - position, data->block_size);
+    data->read_ahead_next = NULL;
+
+    kan_mutex_lock (read_ahead_context.mutex);
+    data->read_ahead_state = READ_AHEAD_STATE_QUEUED;
+
+    if (read_ahead_context.queue_last)
+    {
+        read_ahead_context.queue_last->read_ahead_next = data;
+    }
+    else
+    {
+        read_ahead_context.queue_first = data;
+    }
+
+    read_ahead_context.queue_last = data;
+    kan_conditional_variable_signal_one (read_ahead_context.queue_signal);
+    kan_mutex_unlock (read_ahead_context.mutex);
+}
+
+/// \brief Synchronously reads block at given position into current block. Source stream must not be in use.
+static inline bool read_ahead_fill_current (struct read_ahead_stream_buffer_t *data, kan_file_size_t position)
+{
+    data->current_position = position;
+    data->current_size = KAN_MIN (data->stream_size - position, data->block_size);
+
+    if (!data->source_stream->operations->seek (data->source_stream, KAN_STREAM_SEEK_START,
+                                                (kan_file_offset_t) position) ||
+        data->source_stream->operations->read (data->source_stream, data->current_size, data->current_block) !=
+            data->current_size)
+    {
+        data->current_size = 0u;
+        return false;
+    }
+
+    return true;
+}
+
+static kan_file_size_t read_ahead_read (struct kan_stream_t *stream, kan_file_size_t amount, void *output_buffer)
+{
+    struct read_ahead_stream_buffer_t *data = (struct read_ahead_stream_buffer_t *) stream;
+    uint8_t *output = (uint8_t *) output_buffer;
+    amount = KAN_MIN (amount, data->stream_size - data->stream_position);
+    kan_file_size_t total_read = 0u;
+
+    while (total_read < amount)
+    {
+        if (data->stream_position >= data->current_position &&
+            data->stream_position < data->current_position + data->current_size)
+        {
+            const kan_file_size_t block_offset = data->stream_position - data->current_position;
+            const kan_file_size_t to_copy = KAN_MIN (amount - total_read, data->current_size - block_offset);
+            memcpy (output + total_read, data->current_block + block_offset, to_copy);
+
+            total_read += to_copy;
+            data->stream_position += to_copy;
+            continue;
+        }
+
+        // Current block cannot serve the request, therefore we need to switch to read ahead block or to the source.
+        read_ahead_wait (data);
+        const bool read_ahead_usable = data->read_ahead_state == READ_AHEAD_STATE_READY &&
+                                       data->stream_position >= data->read_ahead_position &&
+                                       data->stream_position < data->read_ahead_position + data->read_ahead_size;
+        data->read_ahead_state = READ_AHEAD_STATE_NONE;
+
+        if (read_ahead_usable)
+        {
+            uint8_t *old_current_block = data->current_block;
+            data->current_block = data->read_ahead_block;
+            data->current_position = data->read_ahead_position;
+            data->current_size = data->read_ahead_size;
+            data->read_ahead_block = old_current_block;
+        }
+        else if (amount - total_read >= data->block_size)
+        {
+            // Very big request, no sense to invalidate blocks.
+            data->source_stream->operations->seek (data->source_stream, KAN_STREAM_SEEK_START,
+                                                   (kan_file_offset_t) data->stream_position);
+
+            const kan_file_size_t to_read = amount - total_read;
+            const kan_file_size_t read =
+                data->source_stream->operations->read (data->source_stream, to_read, output + total_read);
+
+            total_read += read;
+            data->stream_position += read;
+
+            if (read != to_read)
+            {
+                break;
+            }
+
+            continue;
+        }
+        else if (!read_ahead_fill_current (data, data->stream_position))
+        {
+            // Unable to fill block, exiting.
+            break;
+        }
+
+        read_ahead_schedule (data);
+    }
+
+    return total_read;
+}
+
+static kan_file_size_t read_ahead_tell (struct kan_stream_t *stream)
+{
+    struct read_ahead_stream_buffer_t *data = (struct read_ahead_stream_buffer_t *) stream;
+    return data->stream_position;
+}
+
+static bool read_ahead_seek (struct kan_stream_t *stream, enum kan_stream_seek_pivot pivot, kan_file_offset_t offset)
+{
+    struct read_ahead_stream_buffer_t *data = (struct read_ahead_stream_buffer_t *) stream;
+    // Blocks are left as is, as it is quite common to seek around inside current block.
+    data->stream_position = calculate_seek_position (data->stream_position, data->stream_size, pivot, offset);
+    return true;
+}
+
+static inline kan_memory_size_t read_ahead_calculate_allocation_size (kan_file_size_t block_size)
+{
+    return kan_apply_alignment (sizeof (struct read_ahead_stream_buffer_t) + 2u * block_size,
+                                alignof (struct read_ahead_stream_buffer_t));
+}
+
+static void read_ahead_close (struct kan_stream_t *stream)
+{
+    struct read_ahead_stream_buffer_t *data = (struct read_ahead_stream_buffer_t *) stream;
+    read_ahead_wait (data);
+
+    data->source_stream->operations->close (data->source_stream);
+    kan_free_general (get_allocation_group (), data, read_ahead_calculate_allocation_size (data->block_size));
+}
+
+static struct kan_stream_operations_t read_ahead_stream_buffer_read_operations = {
+    .read = read_ahead_read,
+    .write = NULL,
+    .flush = NULL,
+    .tell = read_ahead_tell,
+    .seek = read_ahead_seek,
+    .close = read_ahead_close,
+};
+
 struct kan_stream_t *kan_random_access_stream_buffer_open_for_read (struct kan_stream_t *source_stream,
                                                                     kan_file_size_t buffer_size)
 {
@@ -349,6 +627,54 @@ struct kan_stream_t *kan_random_access_stream_buffer_open_for_read (struct kan_s
     return (struct kan_stream_t *) stream;
 }
 
+struct kan_stream_t *kan_random_access_stream_buffer_open_for_read_ahead (struct kan_stream_t *source_stream,
+                                                                          kan_file_size_t min_block_size,
+                                                                          kan_file_size_t max_block_size)
+{
+    KAN_ASSERT (kan_stream_is_readable (source_stream))
+    KAN_ASSERT (kan_stream_is_random_access (source_stream))
+    KAN_ASSERT (min_block_size > 0u)
+    KAN_ASSERT (min_block_size <= max_block_size)
+
+    source_stream->operations->seek (source_stream, KAN_STREAM_SEEK_END, 0u);
+    const kan_file_size_t stream_size = source_stream->operations->tell (source_stream);
+    source_stream->operations->seek (source_stream, KAN_STREAM_SEEK_START, 0u);
+
+    if (stream_size <= max_block_size)
+    {
+        // Whole stream fits into one block, therefore it is read at once and read ahead is not needed.
+        return kan_random_access_stream_buffer_open_for_read (source_stream, KAN_MAX (stream_size, 1u));
+    }
+
+    const kan_file_size_t block_size =
+        KAN_MAX (min_block_size, KAN_MIN (max_block_size, stream_size / KAN_STREAM_READ_AHEAD_TARGET_BLOCKS));
+    ensure_read_ahead_context_ready ();
+
+    struct read_ahead_stream_buffer_t *stream = kan_allocate_general (
+        get_allocation_group (), read_ahead_calculate_allocation_size (block_size),
+        alignof (struct read_ahead_stream_buffer_t));
+
+    stream->as_stream.operations = &read_ahead_stream_buffer_read_operations;
+    stream->source_stream = source_stream;
+    stream->stream_position = 0u;
+    stream->stream_size = stream_size;
+    stream->block_size = block_size;
+
+    stream->current_block = stream->blocks;
+    stream->read_ahead_state = READ_AHEAD_STATE_NONE;
+    stream->read_ahead_next = NULL;
+    stream->read_ahead_position = 0u;
+    stream->read_ahead_size = 0u;
+    stream->read_ahead_block = stream->blocks + block_size;
+
+    if (read_ahead_fill_current (stream, 0u))
+    {
+        read_ahead_schedule (stream);
+    }
+
+    return (struct kan_stream_t *) stream;
+}
+
 struct kan_stream_t *kan_random_access_stream_buffer_open_for_write (struct kan_stream_t *source_stream,
                                                                      kan_file_size_t buffer_size)
 {
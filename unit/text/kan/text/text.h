@@ -283,11 +283,46 @@ struct kan_text_shaping_request_t
 /// \details Should be quite fast and okay for every-frame execution (if it is really needed) as long as all glyphs
 ///          are already cached. Glyphs are cached the first time they are encountered or using precache request.
 ///          When glyphs are not cached, can result in noticeable hitch, sometimes up to 100ms when there are no cached
-///          glyphs at all.
+///          glyphs at all. To make it less noticeable, glyphs that are not cached are collected for the whole text,
+///          rendered in parallel when there is enough of them and uploaded to the atlas in batches.
+///
+///          Harfbuzz shaping results are cached inside font library per text run, keyed by font category, font size,
+///          script, direction and run text, and evicted in least recently used order. Therefore, when text is
+///          reshaped after small change, like updated counter value, only changed runs are actually passed to
+///          harfbuzz, while line breaking and layout are still recalculated for the whole text.
 TEXT_API bool kan_font_library_shape (kan_font_library_t instance,
                                       struct kan_text_shaping_request_t *request,
                                       struct kan_text_shaped_data_t *output);
 
+/// \brief Describes current state of font library shape cache.
+struct kan_font_library_shape_cache_statistics_t
+{
+    /// \brief Count of text runs that were taken from the cache since library creation.
+    kan_instance_size_t hits;
+
+    /// \brief Count of text runs that were not found in the cache and were passed to harfbuzz.
+    /// \details Runs are not counted as misses when cache is disabled.
+    kan_instance_size_t misses;
+
+    /// \brief Count of text runs that were evicted from the cache due to its max size.
+    kan_instance_size_t evictions;
+
+    /// \brief Count of text runs that are cached right now.
+    kan_instance_size_t entries;
+
+    /// \brief Memory used by cached text runs right now.
+    kan_memory_size_t size;
+};
+
+/// \brief Queries statistics of font library shape cache, mostly useful for tuning and testing.
+TEXT_API void kan_font_library_get_shape_cache_statistics (kan_font_library_t instance,
+                                                           struct kan_font_library_shape_cache_statistics_t *output);
+
+/// \brief Changes max size of font library shape cache in bytes, zero disables the cache.
+/// \details Least recently used runs are evicted right away if cache no longer fits into the new size. Initial max
+///          size is selected by implementation. Must not be called while library is used for shaping.
+TEXT_API void kan_font_library_set_shape_cache_max_size (kan_font_library_t instance, kan_memory_size_t max_size);
+
 /// \brief Describes which glyphs need to be precached.
 struct kan_text_precache_request_t
 {
@@ -310,8 +345,14 @@ struct kan_text_precache_request_t
 };
 
 /// \brief Precaches glyph data on atlas for nominal glyphs specified by codepoints from given utf8 string.
+/// \details Uses the same batched parallel render as shaping, so precaching big sets of glyphs is preferable to
+///          precaching them one by one.
 TEXT_API bool kan_font_library_precache (kan_font_library_t instance, struct kan_text_precache_request_t *request);
 
+/// \brief Returns count of glyphs that were rendered by font library since its creation.
+/// \details Mostly useful for testing: shaping text which glyphs were already rendered or precached renders nothing.
+TEXT_API kan_instance_size_t kan_font_library_get_rendered_glyphs_count (kan_font_library_t instance);
+
 /// \brief Destroys given text library.
 TEXT_API void kan_font_library_destroy (kan_font_library_t instance);
 
@@ -12,12 +12,16 @@
 
 #include <hb.h>
 
+#include <qsort.h>
+
 #include <kan/api_common/alignment.h>
 #include <kan/api_common/min_max.h>
 #include <kan/container/hash_storage.h>
 #include <kan/container/stack_group_allocator.h>
+#include <kan/cpu_dispatch/parallel_for.h>
 #include <kan/cpu_profiler/markup.h>
 #include <kan/error/critical.h>
+#include <kan/hash/hash.h>
 #include <kan/log/logging.h>
 #include <kan/memory/allocation.h>
 #include <kan/text/text.h>
@@ -39,8 +43,7 @@ static kan_allocation_group_t freetype_allocation_group;
 static kan_allocation_group_t harfbuzz_allocation_group;
 static kan_allocation_group_t font_library_allocation_group;
 static kan_allocation_group_t shaping_temporary_allocation_group;
-
-static FT_Library freetype_library = NULL;
+static kan_allocation_group_t shape_cache_allocation_group;
 
 #if defined(KAN_TEXT_FT_HB_PROFILE_MEMORY)
 void *freetype_alloc (FT_Memory memory, long size)
@@ -113,6 +116,7 @@ static void ensure_statics_initialized (void)
         font_library_allocation_group = kan_allocation_group_get_child (main_allocation_group, "font_library");
         shaping_temporary_allocation_group =
             kan_allocation_group_get_child (main_allocation_group, "shaping_temporary");
+        shape_cache_allocation_group = kan_allocation_group_get_child (main_allocation_group, "shape_cache");
         statics_initialized = true;
     }
 }
@@ -717,6 +721,31 @@ struct font_glyph_node_t
     struct font_rendered_glyph_node_t *rendered_first;
 };
 
+/// \brief Cached harfbuzz shaping result for one utf8 text run.
+/// \details Harfbuzz output only depends on font category, font size, script, direction and run text, therefore it
+///          can be reused across different texts and frames. Clusters are byte offsets inside run text, so they are
+///          valid for any text node with the same run text. Glyph infos, glyph positions and run text are allocated
+///          right after the entry in the same allocation.
+struct font_shape_cache_entry_t
+{
+    struct kan_hash_storage_node_t node;
+    struct font_shape_cache_entry_t *more_recent;
+    struct font_shape_cache_entry_t *less_recent;
+
+    const struct font_library_category_t *category;
+    uint32_t font_size;
+    hb_script_t script;
+    hb_direction_t direction;
+
+    kan_instance_size_t glyph_count;
+    kan_instance_size_t text_length;
+    kan_memory_size_t allocation_size;
+
+    hb_glyph_info_t *glyph_infos;
+    hb_glyph_position_t *glyph_positions;
+    char *text;
+};
+
 struct font_library_category_t
 {
     kan_interned_string_t style;
@@ -728,11 +757,20 @@ struct font_library_category_t
 
     FT_Face freetype_face;
 
+    /// \brief Additional freetype faces for helper tasks of parallel glyph render.
+    /// \details Freetype face cannot be used from several threads at once, therefore every render helper needs its
+    ///          own face. They're created on demand and are only used under library freetype lock.
+    struct kan_dynamic_array_t helper_freetype_faces;
+
     hb_blob_t *harfbuzz_face_blob;
     hb_face_t *harfbuzz_face;
 
+    kan_memory_size_t data_size;
+    const void *data;
+
     kan_instance_size_t variable_axis_count;
     float *variable_axis;
+    FT_Fixed *freetype_variable_axis;
 
     struct kan_atomic_int_t glyphs_read_write_lock;
     struct kan_hash_storage_t glyphs;
@@ -765,9 +803,22 @@ struct font_library_t
 
     struct font_library_sdf_atlas_t sdf_atlas;
 
+    /// \brief Count of glyphs rendered since library creation, guarded by freetype lock.
+    kan_instance_size_t rendered_glyphs_count;
+
     struct kan_atomic_int_t allocator_lock;
     struct kan_stack_group_allocator_t allocator;
 
+    /// \details Shape cache is accessed from every shaping thread, but only for lookups, insertions and copying out
+    ///          data, therefore simple lock is enough for it.
+    struct kan_atomic_int_t shape_cache_lock;
+    struct kan_hash_storage_t shape_cache;
+    struct font_shape_cache_entry_t *shape_cache_most_recent;
+    struct font_shape_cache_entry_t *shape_cache_least_recent;
+    kan_memory_size_t shape_cache_size;
+    kan_memory_size_t shape_cache_max_size;
+    struct kan_font_library_shape_cache_statistics_t shape_cache_statistics;
+
     kan_instance_size_t categories_count;
     struct font_library_category_t categories[];
 };
@@ -797,11 +848,11 @@ kan_font_library_t kan_font_library_create (kan_render_context_t render_context,
 
     FT_Error freetype_error;
 #if defined(KAN_TEXT_FT_HB_PROFILE_MEMORY)
-    freetype_error = FT_New_Library (&freetype_memory, &freetype_library);
-    FT_Add_Default_Modules (freetype_library);
-    FT_Set_Default_Properties (freetype_library);
+    freetype_error = FT_New_Library (&freetype_memory, &library->freetype_library);
+    FT_Add_Default_Modules (library->freetype_library);
+    FT_Set_Default_Properties (library->freetype_library);
 #else
-    freetype_error = FT_Init_FreeType (&freetype_library);
+    freetype_error = FT_Init_FreeType (&library->freetype_library);
 #endif
 
     if (freetype_error != FT_Err_Ok)
@@ -847,6 +898,22 @@ kan_font_library_t kan_font_library_create (kan_render_context_t render_context,
     library->allocator_lock = kan_atomic_int_init (0);
     kan_stack_group_allocator_init (&library->allocator, font_library_allocation_group,
                                     KAN_TEXT_FT_HB_FONT_LIBRARY_STACK);
+
+    library->shape_cache_lock = kan_atomic_int_init (0);
+    kan_hash_storage_init (&library->shape_cache, shape_cache_allocation_group,
+                           KAN_TEXT_FT_HB_FONT_SHAPE_CACHE_BUCKETS);
+    library->shape_cache_most_recent = NULL;
+    library->shape_cache_least_recent = NULL;
+    library->shape_cache_size = 0u;
+    library->shape_cache_max_size = KAN_TEXT_FT_HB_FONT_SHAPE_CACHE_SIZE;
+    library->shape_cache_statistics = (struct kan_font_library_shape_cache_statistics_t) {
+        .hits = 0u,
+        .misses = 0u,
+        .evictions = 0u,
+        .entries = 0u,
+        .size = 0u,
+    };
+    library->rendered_glyphs_count = 0u;
     library->categories_count = categories_count;
 
     struct kan_font_library_category_t *source = categories;
@@ -859,12 +926,20 @@ kan_font_library_t kan_font_library_create (kan_render_context_t render_context,
         target->script = hb_script_from_string (source->script, -1);
 
         target->freetype_face = NULL;
+        kan_dynamic_array_init (&target->helper_freetype_faces, 0u, sizeof (FT_Face), alignof (FT_Face),
+                                font_library_allocation_group);
+
         target->harfbuzz_face_blob = NULL;
         target->harfbuzz_face = NULL;
+        target->data_size = source->data_size;
+        target->data = source->data;
+        target->variable_axis_count = 0u;
+        target->variable_axis = NULL;
+        target->freetype_variable_axis = NULL;
         target->glyphs_read_write_lock = kan_atomic_int_init (0);
         kan_hash_storage_init (&target->glyphs, font_library_allocation_group, KAN_TEXT_FT_HB_FONT_LIBRARY_BUCKETS);
 
-        freetype_error = FT_New_Memory_Face (freetype_library, source->data, (FT_Long) source->data_size, 0u,
+        freetype_error = FT_New_Memory_Face (library->freetype_library, source->data, (FT_Long) source->data_size, 0u,
                                              &target->freetype_face);
 
         if (freetype_error != FT_Err_Ok)
@@ -901,6 +976,7 @@ kan_font_library_t kan_font_library_create (kan_render_context_t render_context,
             }
 
             FT_Set_Var_Design_Coordinates (target->freetype_face, (FT_UInt) target->variable_axis_count, freetype_axis);
+            target->freetype_variable_axis = freetype_axis;
         }
         else
         {
@@ -955,6 +1031,90 @@ static inline struct font_rendered_glyph_node_t *font_glyph_node_find_rendered (
     return NULL;
 }
 
+static inline void font_library_shape_cache_unlink_unsafe (struct font_library_t *library,
+                                                           struct font_shape_cache_entry_t *entry)
+{
+    if (entry->more_recent)
+    {
+        entry->more_recent->less_recent = entry->less_recent;
+    }
+    else
+    {
+        library->shape_cache_most_recent = entry->less_recent;
+    }
+
+    if (entry->less_recent)
+    {
+        entry->less_recent->more_recent = entry->more_recent;
+    }
+    else
+    {
+        library->shape_cache_least_recent = entry->more_recent;
+    }
+}
+
+static inline void font_library_shape_cache_push_most_recent_unsafe (struct font_library_t *library,
+                                                                    struct font_shape_cache_entry_t *entry)
+{
+    entry->more_recent = NULL;
+    entry->less_recent = library->shape_cache_most_recent;
+
+    if (library->shape_cache_most_recent)
+    {
+        library->shape_cache_most_recent->more_recent = entry;
+    }
+    else
+    {
+        library->shape_cache_least_recent = entry;
+    }
+
+    library->shape_cache_most_recent = entry;
+}
+
+static inline struct font_shape_cache_entry_t *font_library_shape_cache_find_unsafe (
+    struct font_library_t *library,
+    kan_hash_t hash,
+    const struct font_library_category_t *category,
+    uint32_t font_size,
+    hb_script_t script,
+    hb_direction_t direction,
+    const char *text,
+    kan_instance_size_t text_length)
+{
+    const struct kan_hash_storage_bucket_t *bucket = kan_hash_storage_query (&library->shape_cache, hash);
+    struct font_shape_cache_entry_t *entry = (struct font_shape_cache_entry_t *) bucket->first;
+    const struct font_shape_cache_entry_t *entry_end =
+        (struct font_shape_cache_entry_t *) (bucket->last ? bucket->last->next : NULL);
+
+    while (entry != entry_end)
+    {
+        if (entry->node.hash == hash && entry->category == category && entry->font_size == font_size &&
+            entry->script == script && entry->direction == direction && entry->text_length == text_length &&
+            memcmp (entry->text, text, text_length) == 0)
+        {
+            return entry;
+        }
+
+        entry = (struct font_shape_cache_entry_t *) entry->node.list_node.next;
+    }
+
+    return NULL;
+}
+
+static inline void font_library_shape_cache_evict_unsafe (struct font_library_t *library, kan_memory_size_t max_size)
+{
+    while (library->shape_cache_size > max_size && library->shape_cache_least_recent)
+    {
+        struct font_shape_cache_entry_t *entry = library->shape_cache_least_recent;
+        font_library_shape_cache_unlink_unsafe (library, entry);
+        kan_hash_storage_remove (&library->shape_cache, &entry->node);
+        library->shape_cache_size -= entry->allocation_size;
+        --library->shape_cache_statistics.entries;
+        ++library->shape_cache_statistics.evictions;
+        kan_free_general (shape_cache_allocation_group, entry, entry->allocation_size);
+    }
+}
+
 struct line_break_t
 {
     kan_instance_size_t cluster;
@@ -971,6 +1131,7 @@ struct shape_sequence_t
 
 struct shape_render_delayed_reminder_t
 {
+    struct font_library_category_t *category;
     kan_instance_size_t font_glyph_index;
     kan_instance_size_t shaped_glyph_index;
 };
@@ -995,6 +1156,12 @@ struct shape_context_t
     struct kan_dynamic_array_t line_breaks;
     struct kan_dynamic_array_t sequences;
     struct kan_dynamic_array_t render_delayed;
+
+    /// \brief Glyph infos copied out of shape cache, as cache entry might be evicted by other thread at any time.
+    struct kan_dynamic_array_t cached_glyph_infos;
+
+    /// \brief Glyph positions copied out of shape cache, as cache entry might be evicted by other thread at any time.
+    struct kan_dynamic_array_t cached_glyph_positions;
 };
 
 static bool shape_choose_category (struct shape_context_t *context)
@@ -1133,12 +1300,12 @@ static inline void shape_apply_rendered_data_to_glyph (struct shape_context_t *c
 
 static inline bool shape_extract_render_data_for_glyph_concurrently (
     struct shape_context_t *context,
+    struct font_library_category_t *category,
     kan_instance_size_t glyph_index,
     struct kan_text_shaped_glyph_instance_data_t *glyph)
 {
-    KAN_ATOMIC_INT_SCOPED_LOCK_READ (&context->current_category->glyphs_read_write_lock)
-    struct font_glyph_node_t *glyph_node =
-        font_library_category_find_glyph_unsafe (context->current_category, glyph_index);
+    KAN_ATOMIC_INT_SCOPED_LOCK_READ (&category->glyphs_read_write_lock)
+    struct font_glyph_node_t *glyph_node = font_library_category_find_glyph_unsafe (category, glyph_index);
 
     if (glyph_node)
     {
@@ -1228,7 +1395,7 @@ static inline void shape_append_to_sequence (struct shape_context_t *context,
     max_26_6->x = origin_x;
     max_26_6->y = origin_y;
 
-    if (!shape_extract_render_data_for_glyph_concurrently (context, glyph_index, shaped))
+    if (!shape_extract_render_data_for_glyph_concurrently (context, context->current_category, glyph_index, shaped))
     {
         struct shape_render_delayed_reminder_t *render_delayed = kan_dynamic_array_add_last (&context->render_delayed);
         if (!render_delayed)
@@ -1239,161 +1406,210 @@ static inline void shape_append_to_sequence (struct shape_context_t *context,
             render_delayed = kan_dynamic_array_add_last (&context->render_delayed);
         }
 
+        render_delayed->category = context->current_category;
         render_delayed->font_glyph_index = glyph_index;
         render_delayed->shaped_glyph_index = context->output->glyphs.size - 1u;
     }
 }
 
-static inline void font_library_category_prepare_for_render_unsafe (struct font_library_category_t *category,
-                                                                    enum kan_font_glyph_render_format_t format)
+static inline void font_library_prepare_face_for_render_unsafe (FT_Face face,
+                                                                enum kan_font_glyph_render_format_t format)
 {
     switch (format)
     {
     case KAN_FONT_GLYPH_RENDER_FORMAT_SDF:
-        FT_Set_Char_Size (category->freetype_face, TO_26_6 (KAN_TEXT_FT_HB_SDF_ATLAS_FONT_SIZE),
+        FT_Set_Char_Size (face, TO_26_6 (KAN_TEXT_FT_HB_SDF_ATLAS_FONT_SIZE),
                           TO_26_6 (KAN_TEXT_FT_HB_SDF_ATLAS_FONT_SIZE), 0u, 0u);
         break;
     }
 }
 
-static void font_library_render_sdf_unsafe (struct font_library_t *library,
-                                            struct font_library_category_t *category,
-                                            struct font_rendered_glyph_node_t *rendered,
-                                            kan_instance_size_t font_glyph_index)
+/// \brief Glyph bitmap that was rasterized, but not yet packed into the atlas.
+struct font_rasterized_glyph_t
+{
+    kan_instance_size_t glyph_index;
+    struct kan_int32_vector_2_t bitmap_bearing;
+    kan_instance_size_t width;
+    kan_instance_size_t height;
+
+    /// \details NULL if glyph has failed to render or is represented by empty bitmap.
+    uint8_t *bitmap;
+
+    kan_instance_size_t atlas_x;
+    kan_instance_size_t atlas_y;
+};
+
+/// \brief Parallel for user data for glyph rasterization.
+/// \details Freetype faces cannot be used from several threads at once, so calling thread uses category face and
+///          every helper uses its own helper face selected by worker index.
+struct font_rasterization_batch_t
+{
+    enum kan_font_glyph_render_format_t format;
+    FT_Int32 load_flags;
+
+    FT_Face caller_face;
+    FT_Face *helper_faces;
+    struct font_rasterized_glyph_t *glyphs;
+};
+
+static void font_rasterize_glyph (FT_Face face,
+                                  enum kan_font_glyph_render_format_t format,
+                                  FT_Int32 load_flags,
+                                  struct font_rasterized_glyph_t *glyph)
 {
-    FT_GlyphSlot slot = category->freetype_face->glyph;
-    FT_Error freetype_error = FT_Render_Glyph (slot, FT_RENDER_MODE_SDF);
+    FT_Error freetype_error = FT_Load_Glyph (face, (FT_UInt) glyph->glyph_index, load_flags);
+    if (freetype_error)
+    {
+        KAN_LOG (text, KAN_LOG_ERROR, "Failed to load glyph at index %lu for rendering.\n",
+                 (unsigned long) glyph->glyph_index)
+        return;
+    }
+
+    FT_GlyphSlot slot = face->glyph;
+    switch (format)
+    {
+    case KAN_FONT_GLYPH_RENDER_FORMAT_SDF:
+        freetype_error = FT_Render_Glyph (slot, FT_RENDER_MODE_SDF);
+        break;
+    }
 
     if (freetype_error)
     {
         KAN_LOG (text, KAN_LOG_ERROR, "Failed to render glyph at index %lu with freetype.\n",
-                 (unsigned long) font_glyph_index)
+                 (unsigned long) glyph->glyph_index)
         return;
     }
 
     if (slot->bitmap.rows == 0u)
     {
         KAN_LOG (text, KAN_LOG_DEBUG, "Glyph at index %lu is represented by empty bitmap.\n",
-                 (unsigned long) font_glyph_index)
+                 (unsigned long) glyph->glyph_index)
         return;
     }
 
     KAN_ASSERT ((int) slot->bitmap.width == slot->bitmap.pitch)
-    struct font_library_sdf_atlas_t *atlas = &library->sdf_atlas;
-
-    kan_instance_size_t atlas_width;
-    kan_instance_size_t atlas_height;
-    kan_instance_size_t atlas_depth;
-    kan_instance_size_t atlas_layers;
-    kan_render_image_get_sizes (atlas->image, &atlas_width, &atlas_height, &atlas_depth, &atlas_layers);
-
-    const kan_instance_size_t glyph_width = (kan_instance_size_t) slot->bitmap.width;
-    const kan_instance_size_t glyph_height = (kan_instance_size_t) slot->bitmap.rows;
-    KAN_ASSERT (glyph_width < atlas_width)
-    KAN_ASSERT (glyph_height < atlas_height)
-
-    if (atlas->current_row_x + glyph_width >= atlas_width)
-    {
-        // Start new row.
-        atlas->current_row_x = 0u;
-        atlas->current_row_y += atlas->current_row_max_height + KAN_TEXT_FT_HB_SDF_ATLAS_GLYPH_BORDER;
-        atlas->current_row_max_height = 0u;
-    }
+    glyph->bitmap_bearing.x = (int32_t) slot->bitmap_left;
+    glyph->bitmap_bearing.y = (int32_t) slot->bitmap_top;
+    glyph->width = (kan_instance_size_t) slot->bitmap.width;
+    glyph->height = (kan_instance_size_t) slot->bitmap.rows;
+
+    glyph->bitmap =
+        kan_allocate_general (shaping_temporary_allocation_group, glyph->width * glyph->height, alignof (uint8_t));
+    memcpy (glyph->bitmap, slot->bitmap.buffer, glyph->width * glyph->height);
+}
 
-    if (atlas->current_row_y + glyph_height >= atlas_height)
-    {
-        // Layer overflow, start new layer.
-        atlas->current_row_x = 0u;
-        atlas->current_row_y = 0u;
-        atlas->current_row_max_height = 0u;
-        ++atlas->current_layer;
-    }
+static void font_rasterization_batch_item (kan_functor_user_data_t user_data,
+                                           kan_instance_size_t worker_index,
+                                           kan_instance_size_t item_index)
+{
+    struct font_rasterization_batch_t *batch = (struct font_rasterization_batch_t *) user_data;
+    FT_Face face = worker_index == 0u ? batch->caller_face : batch->helper_faces[worker_index - 1u];
+    font_rasterize_glyph (face, batch->format, batch->load_flags, &batch->glyphs[item_index]);
+}
 
-    if (atlas->current_layer >= atlas_layers)
+/// \brief Makes sure that category has enough helper faces for parallel render and returns usable count of helpers.
+static kan_instance_size_t font_library_category_ensure_helper_faces_unsafe (struct font_library_t *library,
+                                                                            struct font_library_category_t *category,
+                                                                            kan_instance_size_t helpers_count)
+{
+    while (category->helper_freetype_faces.size < helpers_count)
     {
-        // Atlas overflow. Reallocate it and copy data from old atlas properly.
-        struct kan_render_image_description_t sdf_atlas_description = {
-            .format = KAN_RENDER_IMAGE_FORMAT_R8_UNORM,
-            .width = atlas_width,
-            .height = atlas_height,
-            .depth = atlas_depth,
-            .layers = atlas_layers + KAN_TEXT_FT_HB_SDF_ATLAS_LAYER_STEP,
-            .mips = 1u,
-            .render_target = false,
-            .supports_sampling = true,
-            .always_treat_as_layered = true,
-            .tracking_name = kan_string_intern ("font_library_atlas"),
-        };
+        FT_Face face;
+        FT_Error freetype_error =
+            FT_New_Memory_Face (library->freetype_library, category->data, (FT_Long) category->data_size, 0u, &face);
 
-        kan_render_image_t new_atlas = kan_render_image_create (library->render_context, &sdf_atlas_description);
-        if (!KAN_HANDLE_IS_VALID (new_atlas))
+        if (freetype_error != FT_Err_Ok)
         {
-            kan_error_critical ("Failed to allocate new atlas for font data, cannot recover properly from that.",
-                                __FILE__, __LINE__);
+            KAN_LOG (text, KAN_LOG_ERROR, "Failed to create helper freetype face for parallel glyph render: %s",
+                     FT_Error_String (freetype_error))
+            break;
         }
 
-        for (kan_instance_size_t old_layer_index = 0u; old_layer_index < atlas_layers; ++old_layer_index)
+        if (category->freetype_variable_axis)
         {
-            kan_render_image_copy_data (atlas->image, old_layer_index, 0u, new_atlas, old_layer_index, 0u);
+            FT_Set_Var_Design_Coordinates (face, (FT_UInt) category->variable_axis_count,
+                                           category->freetype_variable_axis);
         }
 
-        for (kan_loop_size_t layer = atlas_layers; layer < sdf_atlas_description.layers; ++layer)
+        FT_Face *slot = kan_dynamic_array_add_last (&category->helper_freetype_faces);
+        if (!slot)
         {
-            kan_render_image_clear_color (atlas->image, (kan_instance_size_t) layer, 0u, &sdf_atlas_clear_color);
+            kan_dynamic_array_set_capacity (&category->helper_freetype_faces, helpers_count);
+            slot = kan_dynamic_array_add_last (&category->helper_freetype_faces);
         }
 
-        kan_render_image_destroy (atlas->image);
-        atlas->image = new_atlas;
+        *slot = face;
     }
 
-    const struct kan_render_integer_region_3d_t region = {
-        .x = (kan_instance_offset_t) atlas->current_row_x,
-        .y = (kan_instance_offset_t) atlas->current_row_y,
-        .z = 0u,
-        .width = glyph_width,
-        .height = glyph_height,
-        .depth = 1u,
+    return KAN_MIN (helpers_count, category->helper_freetype_faces.size);
+}
+
+static void font_library_rasterize_glyphs_unsafe (struct font_library_t *library,
+                                                  struct font_library_category_t *category,
+                                                  enum kan_font_glyph_render_format_t format,
+                                                  enum kan_text_orientation_t orientation,
+                                                  kan_instance_size_t glyph_count,
+                                                  struct font_rasterized_glyph_t *glyphs)
+{
+    KAN_CPU_SCOPED_STATIC_SECTION (kan_font_library_rasterize_glyphs)
+    FT_Int32 load_flags = FT_LOAD_DEFAULT;
+
+    switch (orientation)
+    {
+    case KAN_TEXT_ORIENTATION_HORIZONTAL:
+        break;
+
+    case KAN_TEXT_ORIENTATION_VERTICAL:
+        load_flags |= FT_LOAD_VERTICAL_LAYOUT;
+        break;
+    }
+
+    kan_instance_size_t helpers_count = 0u;
+    if (glyph_count >= KAN_TEXT_FT_HB_SDF_RENDER_PARALLEL_THRESHOLD)
+    {
+        helpers_count = kan_cpu_parallel_for_get_helpers_count (glyph_count, KAN_TEXT_FT_HB_SDF_RENDER_MAX_HELPERS);
+        helpers_count = font_library_category_ensure_helper_faces_unsafe (library, category, helpers_count);
+    }
+
+    font_library_prepare_face_for_render_unsafe (category->freetype_face, format);
+    for (kan_loop_size_t index = 0u; index < helpers_count; ++index)
+    {
+        font_library_prepare_face_for_render_unsafe (((FT_Face *) category->helper_freetype_faces.data)[index],
+                                                     format);
+    }
+
+    struct font_rasterization_batch_t batch = {
+        .format = format,
+        .load_flags = load_flags,
+        .caller_face = category->freetype_face,
+        .helper_faces = (FT_Face *) category->helper_freetype_faces.data,
+        .glyphs = glyphs,
     };
 
-    kan_render_image_upload_data_region (atlas->image, (kan_instance_size_t) atlas->current_layer, 0u, region,
-                                         glyph_width * glyph_height, slot->bitmap.buffer);
-
-    rendered->layer = atlas->current_layer;
-    rendered->bitmap_bearing.x = TO_26_6 ((int32_t) slot->bitmap_left);
-    rendered->bitmap_bearing.y = TO_26_6 ((int32_t) slot->bitmap_top);
-    rendered->bitmap_size.x = TO_26_6 ((int32_t) glyph_width);
-    rendered->bitmap_size.y = TO_26_6 ((int32_t) glyph_height);
-    rendered->uv_min.x = (float) atlas->current_row_x / (float) atlas_width;
-    rendered->uv_min.y = (float) atlas->current_row_y / (float) atlas_height;
-    rendered->uv_max.x = ((float) atlas->current_row_x + (float) glyph_width) / (float) atlas_width;
-    rendered->uv_max.y = ((float) atlas->current_row_y + (float) glyph_height) / (float) atlas_height;
-
-    // Update cursor. Overflows will be handled during next glyph render.
-    atlas->current_row_x += glyph_width + KAN_TEXT_FT_HB_SDF_ATLAS_GLYPH_BORDER;
-    atlas->current_row_max_height = KAN_MAX (atlas->current_row_max_height, glyph_height);
+    // Helpers never take freetype lock, so holding it while waiting for glyphs rendered by helpers is safe. Faces
+    // count is already accounted for in helpers count, therefore every helper gets its own face.
+    kan_cpu_parallel_for_execute ((struct kan_cpu_parallel_for_t) {
+        .function = font_rasterization_batch_item,
+        .user_data = (kan_functor_user_data_t) &batch,
+        .items_count = glyph_count,
+        .max_helpers = helpers_count,
+        .helper_profiler_section = kan_cpu_section_get ("font_library_rasterize_glyphs_helper"),
+    });
 }
 
-static struct font_rendered_glyph_node_t *font_library_get_or_render_glyph_unsafe (
+static struct font_rendered_glyph_node_t *font_library_category_add_rendered_unsafe (
     struct font_library_t *library,
     struct font_library_category_t *category,
-    hb_codepoint_t glyph_index,
+    kan_instance_size_t glyph_index,
     enum kan_font_glyph_render_format_t render_format,
     enum kan_text_orientation_t orientation)
 {
     struct font_glyph_node_t *glyph_node = font_library_category_find_glyph_unsafe (category, glyph_index);
     struct font_rendered_glyph_node_t *rendered = NULL;
-
-    if (glyph_node)
-    {
-        if ((rendered = font_glyph_node_find_rendered (glyph_node, render_format, orientation)))
-        {
-            return rendered;
-        }
-    }
+    KAN_ATOMIC_INT_SCOPED_LOCK (&library->allocator_lock)
 
     if (!glyph_node)
     {
-        KAN_ATOMIC_INT_SCOPED_LOCK (&library->allocator_lock)
         glyph_node = kan_stack_group_allocator_allocate (&library->allocator, sizeof (struct font_glyph_node_t),
                                                          alignof (struct font_glyph_node_t));
 
@@ -1405,11 +1621,8 @@ static struct font_rendered_glyph_node_t *font_library_get_or_render_glyph_unsaf
         kan_hash_storage_update_bucket_count_default (&category->glyphs, KAN_TEXT_FT_HB_FONT_LIBRARY_BUCKETS);
     }
 
-    {
-        KAN_ATOMIC_INT_SCOPED_LOCK (&library->allocator_lock)
-        rendered = kan_stack_group_allocator_allocate (&library->allocator, sizeof (struct font_rendered_glyph_node_t),
-                                                       alignof (struct font_rendered_glyph_node_t));
-    }
+    rendered = kan_stack_group_allocator_allocate (&library->allocator, sizeof (struct font_rendered_glyph_node_t),
+                                                   alignof (struct font_rendered_glyph_node_t));
 
     rendered->next = glyph_node->rendered_first;
     glyph_node->rendered_first = rendered;
@@ -1425,33 +1638,412 @@ static struct font_rendered_glyph_node_t *font_library_get_or_render_glyph_unsaf
     rendered->uv_min.y = 0.0f;
     rendered->uv_max.x = 0.0f;
     rendered->uv_max.y = 0.0f;
+    return rendered;
+}
 
-    FT_Int32 load_flags = FT_LOAD_DEFAULT;
-    switch (orientation)
+/// \brief Adds layers to the SDF atlas, preserving already uploaded data. Returns new count of layers.
+static kan_instance_size_t font_library_sdf_atlas_grow_unsafe (struct font_library_t *library,
+                                                               kan_instance_size_t atlas_width,
+                                                               kan_instance_size_t atlas_height,
+                                                               kan_instance_size_t atlas_depth,
+                                                               kan_instance_size_t atlas_layers)
+{
+    struct font_library_sdf_atlas_t *atlas = &library->sdf_atlas;
+    struct kan_render_image_description_t sdf_atlas_description = {
+        .format = KAN_RENDER_IMAGE_FORMAT_R8_UNORM,
+        .width = atlas_width,
+        .height = atlas_height,
+        .depth = atlas_depth,
+        .layers = atlas_layers + KAN_TEXT_FT_HB_SDF_ATLAS_LAYER_STEP,
+        .mips = 1u,
+        .render_target = false,
+        .supports_sampling = true,
+        .always_treat_as_layered = true,
+        .tracking_name = kan_string_intern ("font_library_atlas"),
+    };
+
+    kan_render_image_t new_atlas = kan_render_image_create (library->render_context, &sdf_atlas_description);
+    if (!KAN_HANDLE_IS_VALID (new_atlas))
     {
-    case KAN_TEXT_ORIENTATION_HORIZONTAL:
-        break;
+        kan_error_critical ("Failed to allocate new atlas for font data, cannot recover properly from that.", __FILE__,
+                            __LINE__);
+    }
 
-    case KAN_TEXT_ORIENTATION_VERTICAL:
-        load_flags |= FT_LOAD_VERTICAL_LAYOUT;
-        break;
+    for (kan_instance_size_t old_layer_index = 0u; old_layer_index < atlas_layers; ++old_layer_index)
+    {
+        kan_render_image_copy_data (atlas->image, old_layer_index, 0u, new_atlas, old_layer_index, 0u);
     }
 
-    FT_Error freetype_error = FT_Load_Glyph (category->freetype_face, (FT_UInt) glyph_index, load_flags);
-    if (freetype_error)
+    for (kan_loop_size_t layer = atlas_layers; layer < sdf_atlas_description.layers; ++layer)
     {
-        KAN_LOG (text, KAN_LOG_ERROR, "Failed to load glyph at index %lu for rendering.\n", (unsigned long) glyph_index)
-        return NULL;
+        kan_render_image_clear_color (new_atlas, (kan_instance_size_t) layer, 0u, &sdf_atlas_clear_color);
+    }
+
+    kan_render_image_destroy (atlas->image);
+    atlas->image = new_atlas;
+    return sdf_atlas_description.layers;
+}
+
+/// \brief Part of atlas row that consists of consecutively packed glyphs and can be uploaded as one region.
+struct font_sdf_atlas_strip_t
+{
+    kan_instance_size_t layer;
+    kan_instance_size_t x;
+    kan_instance_size_t y;
+    kan_instance_size_t width;
+    kan_instance_size_t height;
+    kan_instance_size_t first_glyph;
+    kan_instance_size_t glyph_end;
+};
+
+static void font_library_sdf_atlas_flush_strip_unsafe (struct font_library_t *library,
+                                                       struct font_sdf_atlas_strip_t *strip,
+                                                       struct font_rasterized_glyph_t *glyphs)
+{
+    if (strip->width == 0u)
+    {
+        return;
+    }
+
+    // Space between glyphs and under the lower glyphs is not used by anything else, so we can safely fill it with
+    // zeros as the atlas was cleared with zeros anyway.
+    const kan_memory_size_t data_size = (kan_memory_size_t) strip->width * strip->height;
+    uint8_t *data = kan_allocate_general (shaping_temporary_allocation_group, data_size, alignof (uint8_t));
+    memset (data, 0, data_size);
+
+    for (kan_loop_size_t index = strip->first_glyph; index < strip->glyph_end; ++index)
+    {
+        const struct font_rasterized_glyph_t *glyph = &glyphs[index];
+        if (!glyph->bitmap)
+        {
+            continue;
+        }
+
+        KAN_ASSERT (glyph->atlas_y == strip->y)
+        for (kan_loop_size_t row = 0u; row < glyph->height; ++row)
+        {
+            memcpy (data + row * strip->width + (glyph->atlas_x - strip->x), glyph->bitmap + row * glyph->width,
+                    glyph->width);
+        }
+    }
+
+    const struct kan_render_integer_region_3d_t region = {
+        .x = (kan_instance_offset_t) strip->x,
+        .y = (kan_instance_offset_t) strip->y,
+        .z = 0u,
+        .width = strip->width,
+        .height = strip->height,
+        .depth = 1u,
+    };
+
+    kan_render_image_upload_data_region (library->sdf_atlas.image, strip->layer, 0u, region,
+                                         (kan_instance_size_t) data_size, data);
+    kan_free_general (shaping_temporary_allocation_group, data, data_size);
+
+    strip->width = 0u;
+    strip->height = 0u;
+}
+
+static void font_library_upload_sdf_glyphs_unsafe (struct font_library_t *library,
+                                                   struct font_library_category_t *category,
+                                                   enum kan_text_orientation_t orientation,
+                                                   kan_instance_size_t glyph_count,
+                                                   struct font_rasterized_glyph_t *glyphs)
+{
+    KAN_CPU_SCOPED_STATIC_SECTION (kan_font_library_upload_sdf_glyphs)
+    struct font_library_sdf_atlas_t *atlas = &library->sdf_atlas;
+
+    kan_instance_size_t atlas_width;
+    kan_instance_size_t atlas_height;
+    kan_instance_size_t atlas_depth;
+    kan_instance_size_t atlas_layers;
+    kan_render_image_get_sizes (atlas->image, &atlas_width, &atlas_height, &atlas_depth, &atlas_layers);
+
+    struct font_sdf_atlas_strip_t strip = {
+        .layer = 0u,
+        .x = 0u,
+        .y = 0u,
+        .width = 0u,
+        .height = 0u,
+        .first_glyph = 0u,
+        .glyph_end = 0u,
+    };
+
+    for (kan_loop_size_t index = 0u; index < glyph_count; ++index)
+    {
+        struct font_rasterized_glyph_t *glyph = &glyphs[index];
+        struct font_rendered_glyph_node_t *rendered = font_library_category_add_rendered_unsafe (
+            library, category, glyph->glyph_index, KAN_FONT_GLYPH_RENDER_FORMAT_SDF, orientation);
+
+        if (!glyph->bitmap)
+        {
+            continue;
+        }
+
+        KAN_ASSERT (glyph->width < atlas_width)
+        KAN_ASSERT (glyph->height < atlas_height)
+
+        if (atlas->current_row_x + glyph->width >= atlas_width)
+        {
+            // Start new row.
+            font_library_sdf_atlas_flush_strip_unsafe (library, &strip, glyphs);
+            atlas->current_row_x = 0u;
+            atlas->current_row_y += atlas->current_row_max_height + KAN_TEXT_FT_HB_SDF_ATLAS_GLYPH_BORDER;
+            atlas->current_row_max_height = 0u;
+        }
+
+        if (atlas->current_row_y + glyph->height >= atlas_height)
+        {
+            // Layer overflow, start new layer.
+            font_library_sdf_atlas_flush_strip_unsafe (library, &strip, glyphs);
+            atlas->current_row_x = 0u;
+            atlas->current_row_y = 0u;
+            atlas->current_row_max_height = 0u;
+            ++atlas->current_layer;
+        }
+
+        if (atlas->current_layer >= atlas_layers)
+        {
+            // Atlas overflow. Strip is always flushed at this point as we've just started new layer.
+            atlas_layers = font_library_sdf_atlas_grow_unsafe (library, atlas_width, atlas_height, atlas_depth,
+                                                               atlas_layers);
+        }
+
+        glyph->atlas_x = atlas->current_row_x;
+        glyph->atlas_y = atlas->current_row_y;
+
+        if (strip.width == 0u)
+        {
+            strip.layer = atlas->current_layer;
+            strip.x = glyph->atlas_x;
+            strip.y = glyph->atlas_y;
+            strip.first_glyph = (kan_instance_size_t) index;
+        }
+
+        strip.width = glyph->atlas_x + glyph->width - strip.x;
+        strip.height = KAN_MAX (strip.height, glyph->height);
+        strip.glyph_end = (kan_instance_size_t) index + 1u;
+
+        rendered->layer = atlas->current_layer;
+        rendered->bitmap_bearing.x = TO_26_6 (glyph->bitmap_bearing.x);
+        rendered->bitmap_bearing.y = TO_26_6 (glyph->bitmap_bearing.y);
+        rendered->bitmap_size.x = TO_26_6 ((int32_t) glyph->width);
+        rendered->bitmap_size.y = TO_26_6 ((int32_t) glyph->height);
+        rendered->uv_min.x = (float) glyph->atlas_x / (float) atlas_width;
+        rendered->uv_min.y = (float) glyph->atlas_y / (float) atlas_height;
+        rendered->uv_max.x = ((float) glyph->atlas_x + (float) glyph->width) / (float) atlas_width;
+        rendered->uv_max.y = ((float) glyph->atlas_y + (float) glyph->height) / (float) atlas_height;
+
+        // Update cursor. Overflows will be handled during next glyph placement.
+        atlas->current_row_x += glyph->width + KAN_TEXT_FT_HB_SDF_ATLAS_GLYPH_BORDER;
+        atlas->current_row_max_height = KAN_MAX (atlas->current_row_max_height, glyph->height);
+    }
+
+    font_library_sdf_atlas_flush_strip_unsafe (library, &strip, glyphs);
+}
+
+/// \brief Renders all given glyphs that are not rendered yet in given format and orientation.
+/// \details Glyphs are rasterized in parallel when there is enough of them, then packed into the atlas in one pass
+///          and uploaded by row strips instead of one upload per glyph. Glyph indices must be unique.
+static void font_library_render_glyphs (struct font_library_t *library,
+                                        struct font_library_category_t *category,
+                                        enum kan_font_glyph_render_format_t render_format,
+                                        enum kan_text_orientation_t orientation,
+                                        kan_instance_size_t glyph_count,
+                                        const kan_instance_size_t *glyph_indices)
+{
+    KAN_CPU_SCOPED_STATIC_SECTION (kan_font_library_render_glyphs)
+    KAN_ATOMIC_INT_SCOPED_LOCK (&library->freetype_lock)
+
+    struct kan_dynamic_array_t glyphs;
+    kan_dynamic_array_init (&glyphs, glyph_count, sizeof (struct font_rasterized_glyph_t),
+                            alignof (struct font_rasterized_glyph_t), shaping_temporary_allocation_group);
+
+    CUSHION_DEFER
+    {
+        for (kan_loop_size_t index = 0u; index < glyphs.size; ++index)
+        {
+            struct font_rasterized_glyph_t *glyph = &((struct font_rasterized_glyph_t *) glyphs.data)[index];
+            if (glyph->bitmap)
+            {
+                kan_free_general (shaping_temporary_allocation_group, glyph->bitmap, glyph->width * glyph->height);
+            }
+        }
+
+        kan_dynamic_array_shutdown (&glyphs);
     }
 
-    switch (rendered->format)
+    {
+        // Every render goes through freetype lock, so glyphs that are not rendered now will not be rendered by
+        // anyone else until we're done.
+        KAN_ATOMIC_INT_SCOPED_LOCK_READ (&category->glyphs_read_write_lock)
+        for (kan_loop_size_t index = 0u; index < glyph_count; ++index)
+        {
+            struct font_glyph_node_t *glyph_node =
+                font_library_category_find_glyph_unsafe (category, glyph_indices[index]);
+
+            if (glyph_node && font_glyph_node_find_rendered (glyph_node, render_format, orientation))
+            {
+                continue;
+            }
+
+            struct font_rasterized_glyph_t *glyph = kan_dynamic_array_add_last (&glyphs);
+            KAN_ASSERT (glyph)
+            glyph->glyph_index = glyph_indices[index];
+            glyph->bitmap_bearing.x = 0;
+            glyph->bitmap_bearing.y = 0;
+            glyph->width = 0u;
+            glyph->height = 0u;
+            glyph->bitmap = NULL;
+            glyph->atlas_x = 0u;
+            glyph->atlas_y = 0u;
+        }
+    }
+
+    if (glyphs.size == 0u)
+    {
+        return;
+    }
+
+    // Rasterization only needs freetype faces and can be done while other threads are reading already rendered glyphs.
+    font_library_rasterize_glyphs_unsafe (library, category, render_format, orientation, glyphs.size,
+                                          (struct font_rasterized_glyph_t *) glyphs.data);
+    library->rendered_glyphs_count += (kan_instance_size_t) glyphs.size;
+
+    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&category->glyphs_read_write_lock)
+    switch (render_format)
     {
     case KAN_FONT_GLYPH_RENDER_FORMAT_SDF:
-        font_library_render_sdf_unsafe (library, category, rendered, glyph_index);
+        font_library_upload_sdf_glyphs_unsafe (library, category, orientation, glyphs.size,
+                                               (struct font_rasterized_glyph_t *) glyphs.data);
         break;
     }
+}
 
-    return rendered;
+/// \brief Retrieves harfbuzz shaping result for given utf8 node either from shape cache or by shaping it.
+/// \details Returned data is either stored in context cache arrays or in harfbuzz buffer, that needs to be cleared
+///          after usage in any case.
+static void shape_text_node_utf8_run (struct shape_context_t *context,
+                                      struct text_node_t *node,
+                                      hb_direction_t harfbuzz_direction,
+                                      unsigned int *output_glyph_count,
+                                      const hb_glyph_info_t **output_glyph_infos,
+                                      const hb_glyph_position_t **output_glyph_positions)
+{
+    struct font_library_t *library = context->library;
+    const uint32_t font_size = context->request->font_size;
+    kan_hash_t hash = 0u;
+
+    if (library->shape_cache_max_size > 0u)
+    {
+        hash = kan_char_sequence_hash (node->utf8.data, node->utf8.data + node->utf8.length);
+        hash = kan_hash_combine (hash, (kan_hash_t) (uintptr_t) context->current_category);
+        hash = kan_hash_combine (hash, (kan_hash_t) font_size);
+        hash = kan_hash_combine (hash, (kan_hash_t) node->utf8.script);
+        hash = kan_hash_combine (hash, (kan_hash_t) harfbuzz_direction);
+
+        KAN_ATOMIC_INT_SCOPED_LOCK (&library->shape_cache_lock)
+        struct font_shape_cache_entry_t *entry =
+            font_library_shape_cache_find_unsafe (library, hash, context->current_category, font_size,
+                                                  node->utf8.script, harfbuzz_direction, node->utf8.data,
+                                                  node->utf8.length);
+
+        if (!entry)
+        {
+            ++library->shape_cache_statistics.misses;
+        }
+        else
+        {
+            ++library->shape_cache_statistics.hits;
+            font_library_shape_cache_unlink_unsafe (library, entry);
+            font_library_shape_cache_push_most_recent_unsafe (library, entry);
+
+            if (context->cached_glyph_infos.capacity < entry->glyph_count)
+            {
+                kan_dynamic_array_set_capacity (&context->cached_glyph_infos, entry->glyph_count);
+                kan_dynamic_array_set_capacity (&context->cached_glyph_positions, entry->glyph_count);
+            }
+
+            context->cached_glyph_infos.size = entry->glyph_count;
+            context->cached_glyph_positions.size = entry->glyph_count;
+            memcpy (context->cached_glyph_infos.data, entry->glyph_infos,
+                    sizeof (hb_glyph_info_t) * entry->glyph_count);
+            memcpy (context->cached_glyph_positions.data, entry->glyph_positions,
+                    sizeof (hb_glyph_position_t) * entry->glyph_count);
+
+            *output_glyph_count = (unsigned int) entry->glyph_count;
+            *output_glyph_infos = (const hb_glyph_info_t *) context->cached_glyph_infos.data;
+            *output_glyph_positions = (const hb_glyph_position_t *) context->cached_glyph_positions.data;
+            return;
+        }
+    }
+
+    {
+        KAN_CPU_SCOPED_STATIC_SECTION (kan_font_library_shape_harfbuzz)
+        hb_buffer_set_script (context->harfbuzz_buffer, node->utf8.script);
+        hb_buffer_set_direction (context->harfbuzz_buffer, harfbuzz_direction);
+        hb_buffer_set_cluster_level (context->harfbuzz_buffer, HB_BUFFER_CLUSTER_LEVEL_MONOTONE_CHARACTERS);
+        hb_buffer_add_utf8 (context->harfbuzz_buffer, node->utf8.data, -1, 0u, -1);
+        hb_shape (context->harfbuzz_font, context->harfbuzz_buffer, NULL, 0u);
+    }
+
+    unsigned int glyph_count;
+    const hb_glyph_info_t *glyph_infos = hb_buffer_get_glyph_infos (context->harfbuzz_buffer, &glyph_count);
+    const hb_glyph_position_t *glyph_positions = hb_buffer_get_glyph_positions (context->harfbuzz_buffer, &glyph_count);
+
+    *output_glyph_count = glyph_count;
+    *output_glyph_infos = glyph_infos;
+    *output_glyph_positions = glyph_positions;
+
+    const kan_memory_size_t allocation_size = kan_apply_alignment (
+        sizeof (struct font_shape_cache_entry_t) +
+            (sizeof (hb_glyph_info_t) + sizeof (hb_glyph_position_t)) * (kan_memory_size_t) glyph_count +
+            node->utf8.length,
+        alignof (struct font_shape_cache_entry_t));
+
+    if (allocation_size > library->shape_cache_max_size)
+    {
+        // Cache is either disabled or this run is too big to be cached.
+        return;
+    }
+
+    struct font_shape_cache_entry_t *entry = kan_allocate_general (shape_cache_allocation_group, allocation_size,
+                                                                   alignof (struct font_shape_cache_entry_t));
+
+    entry->node.hash = hash;
+    entry->more_recent = NULL;
+    entry->less_recent = NULL;
+    entry->category = context->current_category;
+    entry->font_size = font_size;
+    entry->script = node->utf8.script;
+    entry->direction = harfbuzz_direction;
+    entry->glyph_count = (kan_instance_size_t) glyph_count;
+    entry->text_length = node->utf8.length;
+    entry->allocation_size = allocation_size;
+
+    entry->glyph_infos = (hb_glyph_info_t *) (entry + 1u);
+    entry->glyph_positions = (hb_glyph_position_t *) (entry->glyph_infos + glyph_count);
+    entry->text = (char *) (entry->glyph_positions + glyph_count);
+
+    memcpy (entry->glyph_infos, glyph_infos, sizeof (hb_glyph_info_t) * glyph_count);
+    memcpy (entry->glyph_positions, glyph_positions, sizeof (hb_glyph_position_t) * glyph_count);
+    memcpy (entry->text, node->utf8.data, node->utf8.length);
+
+    KAN_ATOMIC_INT_SCOPED_LOCK (&library->shape_cache_lock)
+    if (font_library_shape_cache_find_unsafe (library, hash, context->current_category, font_size, node->utf8.script,
+                                              harfbuzz_direction, node->utf8.data, node->utf8.length))
+    {
+        // Other thread has already shaped and cached the same run.
+        kan_free_general (shape_cache_allocation_group, entry, allocation_size);
+        return;
+    }
+
+    kan_hash_storage_add (&library->shape_cache, &entry->node);
+    kan_hash_storage_update_bucket_count_default (&library->shape_cache, KAN_TEXT_FT_HB_FONT_SHAPE_CACHE_BUCKETS);
+    font_library_shape_cache_push_most_recent_unsafe (library, entry);
+    library->shape_cache_size += allocation_size;
+    ++library->shape_cache_statistics.entries;
+    font_library_shape_cache_evict_unsafe (library, library->shape_cache_max_size);
 }
 
 static void shape_text_node_utf8 (struct shape_context_t *context, struct text_node_t *node)
@@ -1500,16 +2092,11 @@ static void shape_text_node_utf8 (struct shape_context_t *context, struct text_n
         break;
     }
 
-    hb_buffer_set_script (context->harfbuzz_buffer, node->utf8.script);
-    hb_buffer_set_direction (context->harfbuzz_buffer, harfbuzz_direction);
-    hb_buffer_set_cluster_level (context->harfbuzz_buffer, HB_BUFFER_CLUSTER_LEVEL_MONOTONE_CHARACTERS);
-    hb_buffer_add_utf8 (context->harfbuzz_buffer, node->utf8.data, -1, 0u, -1);
-    hb_shape (context->harfbuzz_font, context->harfbuzz_buffer, NULL, 0u);
-    CUSHION_DEFER { hb_buffer_clear_contents (context->harfbuzz_buffer); }
-
     unsigned int glyph_count;
-    const hb_glyph_info_t *glyph_infos = hb_buffer_get_glyph_infos (context->harfbuzz_buffer, &glyph_count);
-    const hb_glyph_position_t *glyph_positions = hb_buffer_get_glyph_positions (context->harfbuzz_buffer, &glyph_count);
+    const hb_glyph_info_t *glyph_infos;
+    const hb_glyph_position_t *glyph_positions;
+    shape_text_node_utf8_run (context, node, harfbuzz_direction, &glyph_count, &glyph_infos, &glyph_positions);
+    CUSHION_DEFER { hb_buffer_clear_contents (context->harfbuzz_buffer); }
 
     struct hb_font_extents_t font_extents;
     hb_font_get_extents_for_direction (context->harfbuzz_font, harfbuzz_direction, &font_extents);
@@ -1704,40 +2291,6 @@ static void shape_text_node_utf8 (struct shape_context_t *context, struct text_n
     }
 
 #undef NEW_SEQUENCE
-    if (context->render_delayed.size > 0u)
-    {
-        KAN_CPU_SCOPED_STATIC_SECTION (kan_font_library_shape_glyph_render)
-        KAN_ATOMIC_INT_SCOPED_LOCK (&context->library->freetype_lock)
-        font_library_category_prepare_for_render_unsafe (context->current_category, context->request->render_format);
-
-        for (kan_loop_size_t index = 0u; index < context->render_delayed.size; ++index)
-        {
-            struct shape_render_delayed_reminder_t *render_delayed =
-                &((struct shape_render_delayed_reminder_t *) context->render_delayed.data)[index];
-
-            struct kan_text_shaped_glyph_instance_data_t *glyph =
-                &((struct kan_text_shaped_glyph_instance_data_t *)
-                      context->output->glyphs.data)[render_delayed->shaped_glyph_index];
-
-            // Check if anyone else already rendered this glyph while we were shaping other glyphs.
-            if (shape_extract_render_data_for_glyph_concurrently (context, render_delayed->font_glyph_index, glyph))
-            {
-                continue;
-            }
-
-            KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&context->current_category->glyphs_read_write_lock)
-            // Now check again under write access and render if necessary.
-
-            struct font_rendered_glyph_node_t *rendered = font_library_get_or_render_glyph_unsafe (
-                context->library, context->current_category, render_delayed->font_glyph_index,
-                context->request->render_format, context->request->orientation);
-
-            if (rendered)
-            {
-                shape_apply_rendered_data_to_glyph (context, glyph, rendered);
-            }
-        }
-    }
 }
 
 static void shape_text_node_icon (struct shape_context_t *context, struct text_node_t *node)
@@ -1863,6 +2416,79 @@ static void shape_text_node_icon (struct shape_context_t *context, struct text_n
     max_26_6->y = origin_y + scaled_y_bearing_26_6 + scaled_height_26_6;
 }
 
+/// \brief Renders glyphs that were not rendered during shaping for the whole text at once and applies render data.
+static void shape_render_delayed_glyphs (struct shape_context_t *context)
+{
+    if (context->render_delayed.size == 0u)
+    {
+        return;
+    }
+
+    KAN_CPU_SCOPED_STATIC_SECTION (kan_font_library_shape_glyph_render)
+    struct shape_render_delayed_reminder_t *reminders =
+        (struct shape_render_delayed_reminder_t *) context->render_delayed.data;
+
+    // Sort reminders by category and glyph index, so every category can be rendered in one batch of unique glyphs.
+    if (context->render_delayed.size > 1u)
+    {
+        struct shape_render_delayed_reminder_t temporary;
+
+#define LESS(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__ (                                                                                             \
+        (uintptr_t) reminders[first_index].category < (uintptr_t) reminders[second_index].category ||                  \
+        (reminders[first_index].category == reminders[second_index].category &&                                       \
+         reminders[first_index].font_glyph_index < reminders[second_index].font_glyph_index))
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = reminders[first_index], reminders[first_index] = reminders[second_index],                              \
+    reminders[second_index] = temporary
+
+        QSORT (context->render_delayed.size, LESS, SWAP);
+#undef LESS
+#undef SWAP
+    }
+
+    struct kan_dynamic_array_t glyph_indices;
+    kan_dynamic_array_init (&glyph_indices, context->render_delayed.size, sizeof (kan_instance_size_t),
+                            alignof (kan_instance_size_t), shaping_temporary_allocation_group);
+    CUSHION_DEFER { kan_dynamic_array_shutdown (&glyph_indices); }
+    kan_loop_size_t group_begin = 0u;
+
+    while (group_begin < context->render_delayed.size)
+    {
+        struct font_library_category_t *category = reminders[group_begin].category;
+        kan_loop_size_t group_end = group_begin;
+        glyph_indices.size = 0u;
+
+        while (group_end < context->render_delayed.size && reminders[group_end].category == category)
+        {
+            const kan_instance_size_t font_glyph_index = reminders[group_end].font_glyph_index;
+            if (glyph_indices.size == 0u ||
+                ((kan_instance_size_t *) glyph_indices.data)[glyph_indices.size - 1u] != font_glyph_index)
+            {
+                *(kan_instance_size_t *) kan_dynamic_array_add_last (&glyph_indices) = font_glyph_index;
+            }
+
+            ++group_end;
+        }
+
+        font_library_render_glyphs (context->library, category, context->request->render_format,
+                                    context->request->orientation, glyph_indices.size,
+                                    (kan_instance_size_t *) glyph_indices.data);
+
+        for (kan_loop_size_t index = group_begin; index < group_end; ++index)
+        {
+            struct kan_text_shaped_glyph_instance_data_t *glyph =
+                &((struct kan_text_shaped_glyph_instance_data_t *)
+                      context->output->glyphs.data)[reminders[index].shaped_glyph_index];
+            shape_extract_render_data_for_glyph_concurrently (context, category, reminders[index].font_glyph_index,
+                                                              glyph);
+        }
+
+        group_begin = group_end;
+    }
+}
+
 static void shape_post_process_sequences (struct shape_context_t *context)
 {
     context->output->min.x = 0;
@@ -2006,6 +2632,8 @@ static void shape_context_shutdown (struct shape_context_t *context)
     kan_dynamic_array_shutdown (&context->line_breaks);
     kan_dynamic_array_shutdown (&context->sequences);
     kan_dynamic_array_shutdown (&context->render_delayed);
+    kan_dynamic_array_shutdown (&context->cached_glyph_infos);
+    kan_dynamic_array_shutdown (&context->cached_glyph_positions);
 }
 
 bool kan_font_library_shape (kan_font_library_t instance,
@@ -2047,6 +2675,12 @@ bool kan_font_library_shape (kan_font_library_t instance,
                             sizeof (struct shape_render_delayed_reminder_t),
                             alignof (struct shape_render_delayed_reminder_t), shaping_temporary_allocation_group);
 
+    kan_dynamic_array_init (&context.cached_glyph_infos, 0u, sizeof (hb_glyph_info_t), alignof (hb_glyph_info_t),
+                            shaping_temporary_allocation_group);
+
+    kan_dynamic_array_init (&context.cached_glyph_positions, 0u, sizeof (hb_glyph_position_t),
+                            alignof (hb_glyph_position_t), shaping_temporary_allocation_group);
+
     CUSHION_DEFER { shape_context_shutdown (&context); }
     kan_dynamic_array_set_capacity (&output->glyphs, KAN_TEXT_FT_HB_FONT_SHAPED_GLYPHS_INITIAL);
     struct text_node_t *text_node = KAN_HANDLE_GET (request->text);
@@ -2069,7 +2703,6 @@ bool kan_font_library_shape (kan_font_library_t instance,
 
             shape_text_node_utf8 (&context, text_node);
             context.line_breaks.size = 0u;
-            context.render_delayed.size = 0u;
             break;
 
         case TEXT_NODE_TYPE_ICON:
@@ -2101,6 +2734,7 @@ bool kan_font_library_shape (kan_font_library_t instance,
         text_node = text_node->next;
     }
 
+    shape_render_delayed_glyphs (&context);
     shape_post_process_sequences (&context);
     kan_dynamic_array_set_capacity (&output->glyphs, output->glyphs.size);
     return true;
@@ -2136,18 +2770,18 @@ bool kan_font_library_precache (kan_font_library_t instance, struct kan_text_pre
         return false;
     }
 
-    KAN_CPU_SCOPED_STATIC_SECTION (kan_font_library_precache)
-    KAN_ATOMIC_INT_SCOPED_LOCK (&library->freetype_lock)
-
-    font_library_category_prepare_for_render_unsafe (selected_category, request->render_format);
     // Current, we use harfbuzz font only to get nominal glyphs, therefore we do not need proper size and axis.
     // Although, it can be an overkill to create font for that.
     // However, precaching usually takes some time due to costly render, therefore it should not be noticeable.
     hb_font_t *harfbuzz_font = hb_font_create (selected_category->harfbuzz_face);
     CUSHION_DEFER { hb_font_destroy (harfbuzz_font); }
 
-    // Write-lock right away, because we do not expect anyone to already do shaping while we're precaching.
-    KAN_ATOMIC_INT_SCOPED_LOCK_WRITE (&selected_category->glyphs_read_write_lock)
+    struct kan_dynamic_array_t glyph_indices;
+    kan_dynamic_array_init (&glyph_indices, KAN_TEXT_FT_HB_FONT_SHAPE_DELAYED_RENDER_BASE,
+                            sizeof (kan_instance_size_t), alignof (kan_instance_size_t),
+                            shaping_temporary_allocation_group);
+    CUSHION_DEFER { kan_dynamic_array_shutdown (&glyph_indices); }
+
     kan_unicode_codepoint_t codepoint;
     const uint8_t *utf8 = (uint8_t *) request->utf8;
 
@@ -2166,20 +2800,74 @@ bool kan_font_library_precache (kan_font_library_t instance, struct kan_text_pre
             continue;
         }
 
-        struct font_rendered_glyph_node_t *rendered = font_library_get_or_render_glyph_unsafe (
-            library, selected_category, harfbuzz_glyph_index, request->render_format, request->orientation);
+        kan_instance_size_t *glyph_index = kan_dynamic_array_add_last (&glyph_indices);
+        if (!glyph_index)
+        {
+            kan_dynamic_array_set_capacity (&glyph_indices, glyph_indices.size * 2u);
+            glyph_index = kan_dynamic_array_add_last (&glyph_indices);
+        }
+
+        *glyph_index = (kan_instance_size_t) harfbuzz_glyph_index;
+    }
+
+    if (glyph_indices.size == 0u)
+    {
+        return true;
+    }
+
+    // Render batch expects unique glyph indices.
+    kan_instance_size_t *indices = (kan_instance_size_t *) glyph_indices.data;
+    {
+        kan_instance_size_t temporary;
+#define LESS(first_index, second_index) __CUSHION_PRESERVE__ (indices[first_index] < indices[second_index])
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = indices[first_index], indices[first_index] = indices[second_index], indices[second_index] = temporary
+
+        QSORT (glyph_indices.size, LESS, SWAP);
+#undef LESS
+#undef SWAP
+    }
 
-        if (!rendered)
+    kan_instance_size_t unique_count = 1u;
+    for (kan_loop_size_t index = 1u; index < glyph_indices.size; ++index)
+    {
+        if (indices[index] != indices[unique_count - 1u])
         {
-            KAN_LOG (text, KAN_LOG_WARNING, "Failed to precache codepoint %u as render has failed.",
-                     (unsigned int) codepoint)
-            continue;
+            indices[unique_count] = indices[index];
+            ++unique_count;
         }
     }
 
+    font_library_render_glyphs (library, selected_category, request->render_format, request->orientation,
+                                unique_count, indices);
     return true;
 }
 
+kan_instance_size_t kan_font_library_get_rendered_glyphs_count (kan_font_library_t instance)
+{
+    struct font_library_t *library = KAN_HANDLE_GET (instance);
+    KAN_ATOMIC_INT_SCOPED_LOCK (&library->freetype_lock)
+    return library->rendered_glyphs_count;
+}
+
+void kan_font_library_get_shape_cache_statistics (kan_font_library_t instance,
+                                                  struct kan_font_library_shape_cache_statistics_t *output)
+{
+    struct font_library_t *library = KAN_HANDLE_GET (instance);
+    KAN_ATOMIC_INT_SCOPED_LOCK (&library->shape_cache_lock)
+    *output = library->shape_cache_statistics;
+    output->size = library->shape_cache_size;
+}
+
+void kan_font_library_set_shape_cache_max_size (kan_font_library_t instance, kan_memory_size_t max_size)
+{
+    struct font_library_t *library = KAN_HANDLE_GET (instance);
+    KAN_ATOMIC_INT_SCOPED_LOCK (&library->shape_cache_lock)
+    library->shape_cache_max_size = max_size;
+    font_library_shape_cache_evict_unsafe (library, max_size);
+}
+
 void kan_font_library_destroy (kan_font_library_t instance)
 {
     struct font_library_t *library = KAN_HANDLE_GET (instance);
@@ -2201,10 +2889,20 @@ void kan_font_library_destroy (kan_font_library_t instance)
             FT_Done_Face (category->freetype_face);
         }
 
+        for (kan_loop_size_t face_index = 0u; face_index < category->helper_freetype_faces.size; ++face_index)
+        {
+            FT_Done_Face (((FT_Face *) category->helper_freetype_faces.data)[face_index]);
+        }
+
+        kan_dynamic_array_shutdown (&category->helper_freetype_faces);
+
         // Glyph nodes are allocated through stack group, so we don't need to deallocate them manually.
         kan_hash_storage_shutdown (&category->glyphs);
     }
 
+    font_library_shape_cache_evict_unsafe (library, 0u);
+    kan_hash_storage_shutdown (&library->shape_cache);
+
     kan_render_image_destroy (library->sdf_atlas.image);
     FT_Done_Library (library->freetype_library);
     kan_stack_group_allocator_shutdown (&library->allocator);
@@ -410,6 +410,30 @@ static inline enum kan_render_image_format_t texture_format_to_render_format (en
 
     case KAN_RESOURCE_TEXTURE_FORMAT_UNCOMPRESSED_D32:
         return KAN_RENDER_IMAGE_FORMAT_D32_SFLOAT;
+
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_SRGB:
+        return KAN_RENDER_IMAGE_FORMAT_BC1_RGB_SRGB_BLOCK;
+
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC1_RGB_UNORM:
+        return KAN_RENDER_IMAGE_FORMAT_BC1_RGB_UNORM_BLOCK;
+
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_SRGB:
+        return KAN_RENDER_IMAGE_FORMAT_BC3_SRGB_BLOCK;
+
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC3_RGBA_UNORM:
+        return KAN_RENDER_IMAGE_FORMAT_BC3_UNORM_BLOCK;
+
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC4_R_UNORM:
+        return KAN_RENDER_IMAGE_FORMAT_BC4_UNORM_BLOCK;
+
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC5_RG_UNORM:
+        return KAN_RENDER_IMAGE_FORMAT_BC5_UNORM_BLOCK;
+
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_SRGB:
+        return KAN_RENDER_IMAGE_FORMAT_BC7_SRGB_BLOCK;
+
+    case KAN_RESOURCE_TEXTURE_FORMAT_BC7_RGBA_UNORM:
+        return KAN_RENDER_IMAGE_FORMAT_BC7_UNORM_BLOCK;
     }
 
     KAN_ASSERT (false)
@@ -7,6 +7,7 @@
 #include <kan/context/hot_reload_coordination_system.h>
 #include <kan/context/reflection_system.h>
 #include <kan/context/virtual_file_system.h>
+#include <kan/cpu_dispatch/task.h>
 #include <kan/log/logging.h>
 #include <kan/platform/hardware.h>
 #include <kan/precise_time/precise_time.h>
@@ -130,6 +131,27 @@ UNIVERSE_RESOURCE_PROVIDER_API struct kan_repository_meta_automatic_on_insert_ev
             },
 };
 
+/// \brief Native resource loading that is executed by background task outside of frame pipeline.
+/// \details Shared between background task and loading operation through reference counter, so operation can be
+///          safely deleted while background task is still executing.
+KAN_REFLECTION_IGNORE
+struct resource_provider_background_load_t
+{
+    struct kan_atomic_int_t references;
+    struct kan_atomic_int_t finished;
+    bool successful;
+
+    struct resource_provider_state_t *state;
+    const struct kan_reflection_struct_t *type;
+    kan_serialization_interned_string_registry_t string_registry;
+
+    /// \brief Deserialized resource data. Ownership is moved to resource container when loading is committed.
+    void *data;
+
+    kan_instance_size_t path_length;
+    char path[];
+};
+
 struct resource_provider_operation_native_t
 {
     /// \details We don't need generic entry access and we could go to typed entry from loading function right away.
@@ -139,6 +161,7 @@ struct resource_provider_operation_native_t
     struct kan_stream_t *stream;
     kan_reflection_registry_t used_registry;
     kan_serialization_binary_reader_t binary_reader;
+    struct resource_provider_background_load_t *background_load;
 };
 
 struct resource_provider_operation_third_party_t
@@ -154,6 +177,12 @@ struct resource_provider_operation_t
     kan_instance_size_t priority;
     kan_instance_size_t priority_frame_id;
 
+    /// \brief Size of resource file that is used to estimate operation cost.
+    kan_file_size_t estimated_size;
+
+    /// \brief Time that was already spent executing this operation.
+    kan_time_size_t spent_ns;
+
     bool native_operation;
 
     /// \details Native entry id is only used for native entries,
@@ -173,6 +202,8 @@ UNIVERSE_RESOURCE_PROVIDER_API void resource_provider_operation_init (struct res
 {
     instance->priority = 0u;
     instance->priority_frame_id = 0u;
+    instance->estimated_size = 0u;
+    instance->spent_ns = 0u;
 
     instance->native_operation = true;
     instance->native_entry_id = KAN_TYPED_ID_32_SET_INVALID (kan_resource_entry_id_t);
@@ -180,13 +211,21 @@ UNIVERSE_RESOURCE_PROVIDER_API void resource_provider_operation_init (struct res
     instance->native.stream = NULL;
     instance->native.used_registry = KAN_HANDLE_SET_INVALID (kan_reflection_registry_t);
     instance->native.binary_reader = KAN_HANDLE_SET_INVALID (kan_serialization_binary_reader_t);
+    instance->native.background_load = NULL;
 }
 
+static void background_load_release (struct resource_provider_background_load_t *load);
+
 UNIVERSE_RESOURCE_PROVIDER_API void resource_provider_operation_shutdown (
     struct resource_provider_operation_t *instance)
 {
     if (instance->native_operation)
     {
+        if (instance->native.background_load)
+        {
+            background_load_release (instance->native.background_load);
+        }
+
         if (KAN_HANDLE_IS_VALID (instance->native.binary_reader))
         {
             kan_serialization_binary_reader_destroy (instance->native.binary_reader);
@@ -264,6 +303,18 @@ struct resource_provider_execution_shared_state_t
     struct kan_repository_indexed_interval_descending_write_cursor_t operation_cursor;
     kan_time_size_t end_time_ns;
 
+    /// \brief Whether any operation was already taken for execution during this serve.
+    /// \details Guarded by concurrency lock. The first operation is never postponed by cost estimation, so the most
+    ///          prioritized operation is always served, while the others compete for the shared budget.
+    bool any_operation_taken;
+
+    /// \brief Sum of estimated sizes of operations that were finished during this serve.
+    /// \details Guarded by concurrency lock along with spent time, used to update throughput estimation.
+    kan_file_size_t finished_size;
+
+    /// \brief Sum of time spent on operations that were finished during this serve.
+    kan_time_size_t finished_spent_ns;
+
     /// \brief Private and private write access are shared between everyone exclusively for id counter usage.
     struct kan_repository_singleton_write_access_t private_access;
 
@@ -274,8 +325,22 @@ struct resource_provider_execution_shared_state_t
 struct resource_provider_state_t
 {
     kan_allocation_group_t my_allocation_group;
-    kan_time_offset_t serve_budget_ns;
+    kan_allocation_group_t background_load_allocation_group;
+    struct kan_resource_provider_configuration_t budget_configuration;
     kan_interned_string_t resource_directory_path;
+    bool background_deserialization;
+
+    /// \brief Count of background loading tasks that are not finished yet.
+    struct kan_atomic_int_t background_loads_in_flight;
+
+    /// \brief Begin time of the previous frame or zero if it cannot be used for frame time measurement.
+    kan_time_size_t last_frame_begin_time_ns;
+
+    /// \brief Serve budget that was used during the previous frame.
+    kan_time_offset_t last_serve_budget_ns;
+
+    /// \brief Estimated time in nanoseconds needed to load one kibibyte of resource data.
+    kan_time_size_t serve_ns_per_kib;
 
     kan_reflection_registry_t reflection_registry;
     kan_serialization_binary_script_storage_t shared_script_storage;
@@ -302,8 +367,18 @@ struct resource_provider_state_t
 UNIVERSE_RESOURCE_PROVIDER_API void resource_provider_state_init (struct resource_provider_state_t *instance)
 {
     instance->my_allocation_group = kan_allocation_group_stack_get ();
-    instance->serve_budget_ns = 0u;
+    instance->background_load_allocation_group =
+        kan_allocation_group_get_child (instance->my_allocation_group, "background_load");
+    kan_resource_provider_configuration_init (&instance->budget_configuration);
     instance->resource_directory_path = NULL;
+    instance->background_deserialization = false;
+    instance->background_loads_in_flight = kan_atomic_int_init (0);
+
+    instance->last_frame_begin_time_ns = 0u;
+    instance->last_serve_budget_ns = 0u;
+    instance->serve_ns_per_kib = KAN_UNIVERSE_RESOURCE_PROVIDER_INITIAL_NS_PER_KIB;
+    instance->execution_shared_state.finished_size = 0u;
+    instance->execution_shared_state.finished_spent_ns = 0u;
 
     kan_stack_group_allocator_init (&instance->temporary_allocator,
                                     kan_allocation_group_get_child (instance->my_allocation_group, "temporary"),
@@ -366,7 +441,8 @@ UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_DEPLOY_SIGNATURE (mutator_template
         kan_universe_world_query_configuration (world, kan_string_intern (KAN_RESOURCE_PROVIDER_CONFIGURATION));
     KAN_ASSERT (configuration)
 
-    state->serve_budget_ns = configuration->serve_budget_ns;
+    state->budget_configuration = *configuration;
+    state->background_deserialization = configuration->background_deserialization;
     state->resource_directory_path = configuration->resource_directory_path;
 
     state->reflection_registry = kan_universe_get_reflection_registry (universe);
@@ -388,6 +464,7 @@ static kan_resource_entry_id_t register_new_native_entry (struct resource_provid
                                                           kan_interned_string_t type,
                                                           kan_interned_string_t name,
                                                           const char *path,
+                                                          kan_file_size_t size,
                                                           kan_serialization_interned_string_registry_t string_registry)
 {
     struct resource_provider_resource_type_interface_t *interface = query_resource_type_interface (state, type);
@@ -411,6 +488,7 @@ static kan_resource_entry_id_t register_new_native_entry (struct resource_provid
         generic->path = kan_allocate_general (generic->my_allocation_group, path_length + 1u, alignof (char));
         memcpy (generic->path, path, path_length + 1u);
         generic->path_hash = kan_string_hash (generic->path);
+        generic->size = size;
     }
 
     struct kan_repository_indexed_insertion_package_t insert_typed =
@@ -446,6 +524,7 @@ static void register_new_native_entry_with_duplication_check (
     kan_interned_string_t type,
     kan_interned_string_t name,
     const char *path,
+    kan_file_size_t size,
     kan_serialization_interned_string_registry_t string_registry)
 {
     KAN_UML_VALUE_READ (potential_duplicate, kan_resource_generic_entry_t, name, &name)
@@ -459,13 +538,14 @@ static void register_new_native_entry_with_duplication_check (
         }
     }
 
-    register_new_native_entry (state, private, type, name, path, string_registry);
+    register_new_native_entry (state, private, type, name, path, size, string_registry);
 }
 
 static kan_resource_entry_id_t register_new_third_party_entry (struct resource_provider_state_t *state,
                                                                struct resource_provider_private_singleton_t *private,
                                                                kan_interned_string_t name,
-                                                               const char *path)
+                                                               const char *path,
+                                                               kan_file_size_t size)
 {
     kan_resource_entry_id_t entry_id = KAN_TYPED_ID_32_SET (kan_resource_entry_id_t, ++private->entry_id_counter);
     KAN_UMO_INDEXED_INSERT (entry, kan_resource_third_party_entry_t)
@@ -477,6 +557,7 @@ static kan_resource_entry_id_t register_new_third_party_entry (struct resource_p
         entry->path = kan_allocate_general (entry->my_allocation_group, path_length + 1u, alignof (char));
         memcpy (entry->path, path, path_length + 1u);
         entry->path_hash = kan_string_hash (entry->path);
+        entry->size = size;
     }
 
     return entry_id;
@@ -486,7 +567,8 @@ static void register_new_third_party_entry_with_duplication_check (
     struct resource_provider_state_t *state,
     struct resource_provider_private_singleton_t *private,
     kan_interned_string_t name,
-    const char *path)
+    const char *path,
+    kan_file_size_t size)
 {
     KAN_UMI_VALUE_READ_OPTIONAL (duplicate, kan_resource_third_party_entry_t, name, &name)
     if (duplicate)
@@ -496,7 +578,7 @@ static void register_new_third_party_entry_with_duplication_check (
         return;
     }
 
-    register_new_third_party_entry (state, private, name, path);
+    register_new_third_party_entry (state, private, name, path, size);
 }
 
 static bool load_directory_resource_index_if_any (struct resource_provider_state_t *state,
@@ -623,7 +705,7 @@ static bool load_directory_resource_index_if_any (struct resource_provider_state
             kan_file_system_path_container_reset_length (path_container, base_length);
             kan_file_system_path_container_append (path_container, item->path);
             register_new_native_entry_with_duplication_check (state, private, container->type, item->name,
-                                                              path_container->path, string_registry);
+                                                              path_container->path, item->size, string_registry);
         }
     }
 
@@ -634,7 +716,8 @@ static bool load_directory_resource_index_if_any (struct resource_provider_state
 
         kan_file_system_path_container_reset_length (path_container, base_length);
         kan_file_system_path_container_append (path_container, item->path);
-        register_new_third_party_entry_with_duplication_check (state, private, item->name, path_container->path);
+        register_new_third_party_entry_with_duplication_check (state, private, item->name, path_container->path,
+                                                               item->size);
     }
 
     return true;
@@ -718,7 +801,8 @@ static struct scan_file_internal_result_t scan_file_internal (struct resource_pr
 static void scan_file (struct resource_provider_state_t *state,
                        struct resource_provider_private_singleton_t *private,
                        kan_virtual_file_system_volume_t volume,
-                       struct kan_file_system_path_container_t *container)
+                       struct kan_file_system_path_container_t *container,
+                       kan_file_size_t size)
 {
     struct scan_file_internal_result_t scan_result =
         scan_file_internal (state, private, volume, container->length, container->path);
@@ -728,12 +812,13 @@ static void scan_file (struct resource_provider_state_t *state,
         if (scan_result.type)
         {
             register_new_native_entry_with_duplication_check (
-                state, private, scan_result.type, scan_result.name, container->path,
+                state, private, scan_result.type, scan_result.name, container->path, size,
                 KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
         }
         else
         {
-            register_new_third_party_entry_with_duplication_check (state, private, scan_result.name, container->path);
+            register_new_third_party_entry_with_duplication_check (state, private, scan_result.name, container->path,
+                                                                   size);
         }
     }
 }
@@ -781,7 +866,7 @@ static void scan_directory (struct resource_provider_state_t *state,
             break;
 
         case KAN_VIRTUAL_FILE_SYSTEM_ENTRY_TYPE_FILE:
-            scan_file (state, private, volume, container);
+            scan_file (state, private, volume, container, status.size);
             break;
 
         case KAN_VIRTUAL_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY:
@@ -832,6 +917,7 @@ static void process_usage_insert (struct resource_provider_state_t *state,
                     {
                         operation->priority = calculate_usage_priority (state, type, name);
                         operation->priority_frame_id = public->logic_deduplication_frame_id;
+                        operation->estimated_size = generic->size;
                         operation->native_operation = true;
                         operation->native_entry_id = generic->entry_id;
                         operation->native.type = generic->type;
@@ -967,6 +1053,7 @@ static void process_blob_insert (struct resource_provider_state_t *state,
     {
         operation->priority = blob->priority;
         operation->priority_frame_id = public->logic_deduplication_frame_id;
+        operation->estimated_size = entry->size;
         operation->native_operation = false;
         operation->third_party.blob_id = blob_id;
         operation->third_party.stream = NULL;
@@ -1028,6 +1115,7 @@ static void reload_entry (struct resource_provider_state_t *state,
     {
         operation->priority = calculate_usage_priority (state, generic->type, generic->name);
         operation->priority_frame_id = public->logic_deduplication_frame_id;
+        operation->estimated_size = generic->size;
         operation->native_entry_id = generic->entry_id;
         operation->native_operation = true;
         operation->native.type = generic->type;
@@ -1039,6 +1127,7 @@ static inline void process_file_added_native (struct resource_provider_state_t *
                                               struct resource_provider_private_singleton_t *private,
                                               const char *path,
                                               const kan_instance_size_t path_length,
+                                              kan_file_size_t size,
                                               struct scan_file_internal_result_t scan_result)
 {
     kan_resource_entry_id_t entry_id = KAN_TYPED_ID_32_INITIALIZE_INVALID;
@@ -1069,6 +1158,7 @@ static inline void process_file_added_native (struct resource_provider_state_t *
                 existing_generic->path_hash = kan_string_hash (existing_generic->path);
             }
 
+            existing_generic->size = size;
             existing_generic->removal_mark = false;
             break;
         }
@@ -1077,7 +1167,7 @@ static inline void process_file_added_native (struct resource_provider_state_t *
     if (!KAN_TYPED_ID_32_IS_VALID (entry_id))
     {
         new_entry = true;
-        entry_id = register_new_native_entry (state, private, scan_result.type, scan_result.name, path,
+        entry_id = register_new_native_entry (state, private, scan_result.type, scan_result.name, path, size,
                                               KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
 
         if (!KAN_TYPED_ID_32_IS_VALID (entry_id))
@@ -1113,6 +1203,7 @@ static inline void process_file_added_third_party (struct resource_provider_stat
                                                    struct resource_provider_private_singleton_t *private,
                                                    const char *path,
                                                    const kan_instance_size_t path_length,
+                                                   kan_file_size_t size,
                                                    struct scan_file_internal_result_t scan_result)
 {
     KAN_UML_VALUE_UPDATE (existing, kan_resource_third_party_entry_t, name, &scan_result.name)
@@ -1136,6 +1227,7 @@ static inline void process_file_added_third_party (struct resource_provider_stat
             existing->path_hash = kan_string_hash (existing->path);
         }
 
+        existing->size = size;
         existing->removal_mark = false;
         KAN_UMO_EVENT_INSERT (event, kan_resource_third_party_updated_event_t) { event->name = scan_result.name; }
 
@@ -1143,7 +1235,7 @@ static inline void process_file_added_third_party (struct resource_provider_stat
         return;
     }
 
-    if (!KAN_TYPED_ID_32_IS_VALID (register_new_third_party_entry (state, private, scan_result.name, path)))
+    if (!KAN_TYPED_ID_32_IS_VALID (register_new_third_party_entry (state, private, scan_result.name, path, size)))
     {
         KAN_LOG (universe_resource_provider, KAN_LOG_ERROR,
                  "Failed to process addition at virtual path \"%s\" due to entry registration failure.", path)
@@ -1151,6 +1243,22 @@ static inline void process_file_added_third_party (struct resource_provider_stat
     }
 }
 
+static kan_file_size_t query_file_size_for_estimation (struct resource_provider_state_t *state, const char *path)
+{
+    kan_virtual_file_system_volume_t volume =
+        kan_virtual_file_system_get_context_volume_for_read (state->virtual_file_system);
+    CUSHION_DEFER { kan_virtual_file_system_close_context_read_access (state->virtual_file_system); }
+    struct kan_virtual_file_system_entry_status_t status;
+
+    if (!kan_virtual_file_system_query_entry (volume, path, &status))
+    {
+        // Size is only used for cost estimation, therefore we can continue without it.
+        return 0u;
+    }
+
+    return status.size;
+}
+
 static void process_file_added (struct resource_provider_state_t *state,
                                 struct kan_resource_provider_singleton_t *public,
                                 struct resource_provider_private_singleton_t *private,
@@ -1172,11 +1280,13 @@ static void process_file_added (struct resource_provider_state_t *state,
 
     if (scan_result.type)
     {
-        process_file_added_native (state, public, private, path, path_length, scan_result);
+        process_file_added_native (state, public, private, path, path_length,
+                                   query_file_size_for_estimation (state, path), scan_result);
     }
     else
     {
-        process_file_added_third_party (state, public, private, path, path_length, scan_result);
+        process_file_added_third_party (state, public, private, path, path_length,
+                                        query_file_size_for_estimation (state, path), scan_result);
     }
 }
 
@@ -1236,6 +1346,7 @@ static void process_file_modified (struct resource_provider_state_t *state,
                 }
             }
 
+            generic->size = query_file_size_for_estimation (state, generic->path);
             reload_entry (state, public, generic);
             return;
         }
@@ -1245,6 +1356,7 @@ static void process_file_modified (struct resource_provider_state_t *state,
     {
         if (strcmp (third_party->path, path) == 0)
         {
+            third_party->size = query_file_size_for_estimation (state, third_party->path);
             KAN_UMO_EVENT_INSERT (event, kan_resource_third_party_updated_event_t) { event->name = third_party->name; }
 
             return;
@@ -1283,6 +1395,29 @@ enum resource_provider_serve_operation_status_t
     RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_FAILED,
 };
 
+static void finish_native_loading (struct resource_provider_resource_type_interface_t *interface,
+                                   struct kan_resource_typed_entry_view_t *typed)
+{
+    if (KAN_TYPED_ID_32_IS_VALID (typed->loaded_container_id))
+    {
+        delete_container_by_id (interface, typed->loaded_container_id);
+    }
+
+    typed->loaded_container_id = typed->loading_container_id;
+    typed->loading_container_id = KAN_TYPED_ID_32_SET_INVALID (kan_resource_container_id_t);
+
+    struct kan_repository_event_insertion_package_t insert_event =
+        kan_repository_event_insert_query_execute (&interface->insert_loaded_event);
+    struct kan_resource_loaded_event_view_t *event = kan_repository_event_insertion_package_get (&insert_event);
+
+    if (event)
+    {
+        event->entry_id = typed->entry_id;
+        event->name = typed->name;
+        kan_repository_event_insertion_package_submit (&insert_event);
+    }
+}
+
 static inline enum resource_provider_serve_operation_status_t execute_shared_serve_load_native (
     struct resource_provider_state_t *state,
     struct resource_provider_resource_type_interface_t *interface,
@@ -1313,6 +1448,8 @@ static inline enum resource_provider_serve_operation_status_t execute_shared_ser
             operation->native.stream->operations->close (operation->native.stream);
             operation->native.stream = NULL;
         }
+
+        operation->native.used_registry = state->reflection_registry;
     }
 
     if (!operation->native.stream)
@@ -1333,8 +1470,11 @@ static inline enum resource_provider_serve_operation_status_t execute_shared_ser
             return RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_FAILED;
         }
 
-        operation->native.stream = kan_random_access_stream_buffer_open_for_read (
-            operation->native.stream, KAN_UNIVERSE_RESOURCE_PROVIDER_IO_BUFFER);
+        // Native resources are deserialized through several serve steps, therefore read ahead makes it possible to
+        // read next data block while current one is being deserialized.
+        operation->native.stream = kan_random_access_stream_buffer_open_for_read_ahead (
+            operation->native.stream, KAN_UNIVERSE_RESOURCE_PROVIDER_IO_BUFFER,
+            KAN_UNIVERSE_RESOURCE_PROVIDER_IO_READ_AHEAD_MAX_BLOCK);
         kan_interned_string_t type;
 
         if (!kan_serialization_binary_read_type_header (operation->native.stream, &type,
@@ -1422,25 +1562,208 @@ static inline enum resource_provider_serve_operation_status_t execute_shared_ser
         return RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_FAILED;
     }
 
-    if (KAN_TYPED_ID_32_IS_VALID (typed->loaded_container_id))
+    finish_native_loading (interface, typed);
+    return RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_FINISHED;
+}
+
+static void background_load_release (struct resource_provider_background_load_t *load)
+{
+    if (kan_atomic_int_add (&load->references, -1) == 1)
     {
-        delete_container_by_id (interface, typed->loaded_container_id);
+        kan_allocation_group_t allocation_group = load->state->background_load_allocation_group;
+        if (load->data)
+        {
+            if (load->type->shutdown)
+            {
+                load->type->shutdown (load->type->functor_user_data, load->data);
+            }
+
+            kan_free_general (allocation_group, load->data, load->type->size);
+        }
+
+        kan_free_general (allocation_group, load,
+                          sizeof (struct resource_provider_background_load_t) + load->path_length + 1u);
     }
+}
 
-    typed->loaded_container_id = typed->loading_container_id;
-    typed->loading_container_id = KAN_TYPED_ID_32_SET_INVALID (kan_resource_container_id_t);
+static bool background_load_deserialize (struct resource_provider_background_load_t *load)
+{
+    struct resource_provider_state_t *state = load->state;
+    kan_virtual_file_system_volume_t volume =
+        kan_virtual_file_system_get_context_volume_for_read (state->virtual_file_system);
+    struct kan_stream_t *stream = kan_virtual_file_stream_open_for_read (volume, load->path);
+    kan_virtual_file_system_close_context_read_access (state->virtual_file_system);
 
-    struct kan_repository_event_insertion_package_t insert_event =
-        kan_repository_event_insert_query_execute (&interface->insert_loaded_event);
-    struct kan_resource_loaded_event_view_t *event = kan_repository_event_insertion_package_get (&insert_event);
+    if (!stream)
+    {
+        KAN_LOG (universe_resource_provider, KAN_LOG_ERROR,
+                 "Failed to open file at virtual path \"%s\" to read resource of type \"%s\" in background.",
+                 load->path, load->type->name)
+        return false;
+    }
 
-    if (event)
+    // Background task reads the whole resource at once, therefore there is no need for read ahead.
+    stream = kan_random_access_stream_buffer_open_for_read (stream, KAN_UNIVERSE_RESOURCE_PROVIDER_IO_BUFFER);
+    CUSHION_DEFER { stream->operations->close (stream); }
+    kan_interned_string_t type;
+
+    if (!kan_serialization_binary_read_type_header (stream, &type, load->string_registry))
     {
-        event->entry_id = typed->entry_id;
-        event->name = typed->name;
-        kan_repository_event_insertion_package_submit (&insert_event);
+        KAN_LOG (universe_resource_provider, KAN_LOG_ERROR,
+                 "Failed to check type header while loading resource at virtual path \"%s\" of type \"%s\" in "
+                 "background: serialization error.",
+                 load->path, load->type->name)
+        return false;
     }
 
+    if (type != load->type->name)
+    {
+        KAN_LOG (universe_resource_provider, KAN_LOG_ERROR,
+                 "Failed to check type header while loading resource at virtual path \"%s\" of type \"%s\" in "
+                 "background: type header has type \"%s\".",
+                 load->path, load->type->name, type)
+        return false;
+    }
+
+    load->data = kan_allocate_general (state->background_load_allocation_group, load->type->size,
+                                       load->type->alignment);
+
+    if (load->type->init)
+    {
+        load->type->init (load->type->functor_user_data, load->data);
+    }
+
+    kan_serialization_binary_reader_t reader =
+        kan_serialization_binary_reader_create (stream, load->data, load->type->name, state->shared_script_storage,
+                                                load->string_registry, state->background_load_allocation_group);
+    CUSHION_DEFER { kan_serialization_binary_reader_destroy (reader); }
+    enum kan_serialization_state_t serialization_state;
+
+    while ((serialization_state = kan_serialization_binary_reader_step (reader)) == KAN_SERIALIZATION_IN_PROGRESS)
+    {
+    }
+
+    if (serialization_state != KAN_SERIALIZATION_FINISHED)
+    {
+        KAN_LOG (universe_resource_provider, KAN_LOG_ERROR,
+                 "Failed to load resource at virtual path \"%s\" of type \"%s\" in background: serialization error.",
+                 load->path, load->type->name)
+        return false;
+    }
+
+    return true;
+}
+
+static void execute_background_load (kan_functor_user_data_t user_data)
+{
+    struct resource_provider_background_load_t *load = (struct resource_provider_background_load_t *) user_data;
+    struct resource_provider_state_t *state = load->state;
+
+    load->successful = background_load_deserialize (load);
+    kan_atomic_int_set (&load->finished, 1);
+
+    // Load might be already orphaned, therefore we release it before marking task as no longer in flight: it makes
+    // sure that data shutdown is never executed when reflection registry might be already changed by hot reload.
+    background_load_release (load);
+    kan_atomic_int_add (&state->background_loads_in_flight, -1);
+}
+
+static inline enum resource_provider_serve_operation_status_t execute_shared_serve_load_native_background (
+    struct resource_provider_state_t *state,
+    struct resource_provider_resource_type_interface_t *interface,
+    struct resource_provider_operation_t *operation,
+    struct kan_resource_typed_entry_view_t *typed)
+{
+    if (operation->native.background_load &&
+        !KAN_HANDLE_IS_EQUAL (operation->native.used_registry, state->reflection_registry))
+    {
+        // Registry has changed, restart loading. Hot reload is delayed while there are background loads in flight,
+        // therefore we can be sure that background task is already finished.
+        background_load_release (operation->native.background_load);
+        operation->native.background_load = NULL;
+    }
+
+    struct resource_provider_background_load_t *load = operation->native.background_load;
+    if (!load)
+    {
+        if (kan_atomic_int_add (&state->background_loads_in_flight, 1) >=
+            KAN_UNIVERSE_RESOURCE_PROVIDER_BACKGROUND_LOADS_MAX)
+        {
+            // Too many background loads, operation will be started when some of them are finished.
+            kan_atomic_int_add (&state->background_loads_in_flight, -1);
+            return RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_IN_PROGRESS;
+        }
+
+        KAN_UMI_VALUE_READ_REQUIRED (generic, kan_resource_generic_entry_t, entry_id, &operation->native_entry_id)
+        const kan_instance_size_t path_length = (kan_instance_size_t) strlen (generic->path);
+
+        load = kan_allocate_general (state->background_load_allocation_group,
+                                     sizeof (struct resource_provider_background_load_t) + path_length + 1u,
+                                     alignof (struct resource_provider_background_load_t));
+
+        // One reference for the operation and one for the background task.
+        load->references = kan_atomic_int_init (2);
+        load->finished = kan_atomic_int_init (0);
+        load->successful = false;
+
+        load->state = state;
+        load->type = interface->source_node->source_resource_type;
+        load->string_registry = typed->bound_to_string_registry;
+        load->data = NULL;
+
+        load->path_length = path_length;
+        memcpy (load->path, generic->path, path_length + 1u);
+
+        operation->native.used_registry = state->reflection_registry;
+        operation->native.background_load = load;
+
+        kan_cpu_task_detach (kan_cpu_task_dispatch ((struct kan_cpu_task_t) {
+            .function = execute_background_load,
+            .user_data = (kan_functor_user_data_t) load,
+            .profiler_section = KAN_CPU_STATIC_SECTION_GET (resource_provider_background_load),
+        }));
+
+        return RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_IN_PROGRESS;
+    }
+
+    if (!kan_atomic_int_get (&load->finished))
+    {
+        return RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_IN_PROGRESS;
+    }
+
+    if (!load->successful)
+    {
+        // Error is already logged by background task.
+        return RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_FAILED;
+    }
+
+    // Loading is finished, commit deserialized data into new container.
+    KAN_ASSERT (!KAN_TYPED_ID_32_IS_VALID (typed->loading_container_id))
+    struct kan_repository_indexed_insertion_package_t package =
+        kan_repository_indexed_insert_query_execute (&interface->insert_container);
+
+    struct kan_resource_container_view_t *container_view = kan_repository_indexed_insertion_package_get (&package);
+    container_view->container_id =
+        KAN_TYPED_ID_32_SET (kan_resource_container_id_t,
+                             kan_atomic_int_add (&state->execution_shared_state.private->container_id_counter, 1));
+
+    void *contained_data = (void *) kan_apply_alignment ((kan_memory_size_t) container_view->data_begin,
+                                                         load->type->alignment);
+
+    // Container data is already initialized by container init, so we need to shut it down before moving loaded data.
+    if (load->type->shutdown)
+    {
+        load->type->shutdown (load->type->functor_user_data, contained_data);
+    }
+
+    memcpy (contained_data, load->data, load->type->size);
+    kan_free_general (state->background_load_allocation_group, load->data, load->type->size);
+    load->data = NULL;
+
+    typed->loading_container_id = container_view->container_id;
+    kan_repository_indexed_insertion_package_submit (&package);
+
+    finish_native_loading (interface, typed);
     return RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_FINISHED;
 }
 
@@ -1556,6 +1879,9 @@ static void execute_shared_serve (kan_functor_user_data_t user_data)
         struct kan_repository_indexed_interval_write_access_t operation_access =
             kan_repository_indexed_interval_descending_write_cursor_next (
                 &state->execution_shared_state.operation_cursor);
+
+        const bool first_operation = !state->execution_shared_state.any_operation_taken;
+        state->execution_shared_state.any_operation_taken = true;
         kan_atomic_int_unlock (&state->execution_shared_state.concurrency_lock);
 
         struct resource_provider_operation_t *operation =
@@ -1567,6 +1893,30 @@ static void execute_shared_serve (kan_functor_user_data_t user_data)
             break;
         }
 
+        // Background loading only commits finished data during frame, therefore its cost is not limited by budget.
+        const bool background = operation->native_operation && state->background_deserialization;
+        const kan_time_size_t operation_begin_time_ns = kan_precise_time_get_elapsed_nanoseconds ();
+
+        if (!background && !first_operation && operation->spent_ns == 0u)
+        {
+            // Operation is not started yet, check whether it fits into the remaining budget. If it doesn't, we leave
+            // it for the next frame and try to pack smaller operations with lower priority instead. We always allow
+            // the first operation of the serve, so the most prioritized operation is never postponed.
+            const kan_time_size_t estimated_cost_ns =
+                (kan_time_size_t) operation->estimated_size * state->serve_ns_per_kib / 1024u;
+
+            if (operation_begin_time_ns + estimated_cost_ns > state->execution_shared_state.end_time_ns)
+            {
+                if (hot_reload_scheduled)
+                {
+                    kan_hot_reload_coordination_system_delay (state->hot_reload_system);
+                }
+
+                kan_repository_indexed_interval_write_access_close (&operation_access);
+                continue;
+            }
+        }
+
         enum resource_provider_serve_operation_status_t status = RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_IN_PROGRESS;
         if (operation->native_operation)
         {
@@ -1581,7 +1931,9 @@ static void execute_shared_serve (kan_functor_user_data_t user_data)
                 kan_repository_indexed_value_update_access_resolve (&access);
 
             KAN_ASSERT (typed)
-            status = execute_shared_serve_load_native (state, interface, operation, typed);
+            status = background ?
+                         execute_shared_serve_load_native_background (state, interface, operation, typed) :
+                         execute_shared_serve_load_native (state, interface, operation, typed);
 
             // Ensure that if loading is not in progress, loading container is cleaned up.
             if (status != RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_IN_PROGRESS)
@@ -1608,6 +1960,9 @@ static void execute_shared_serve (kan_functor_user_data_t user_data)
             }
         }
 
+        // Zero is reserved for not started operations, therefore spent time is always at least one nanosecond.
+        operation->spent_ns += KAN_MAX (1u, kan_precise_time_get_elapsed_nanoseconds () - operation_begin_time_ns);
+
         switch (status)
         {
         case RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_IN_PROGRESS:
@@ -1620,6 +1975,17 @@ static void execute_shared_serve (kan_functor_user_data_t user_data)
             break;
 
         case RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_FINISHED:
+            if (!background && operation->estimated_size > 0u)
+            {
+                kan_atomic_int_lock (&state->execution_shared_state.concurrency_lock);
+                state->execution_shared_state.finished_size += operation->estimated_size;
+                state->execution_shared_state.finished_spent_ns += operation->spent_ns;
+                kan_atomic_int_unlock (&state->execution_shared_state.concurrency_lock);
+            }
+
+            kan_repository_indexed_interval_write_access_delete (&operation_access);
+            break;
+
         case RESOURCE_PROVIDER_SERVE_OPERATION_STATUS_FAILED:
             // No matter the result, operation execution is done, therefore it should be deleted.
             kan_repository_indexed_interval_write_access_delete (&operation_access);
@@ -1634,6 +2000,21 @@ static void execute_shared_serve (kan_functor_user_data_t user_data)
     }
 }
 
+static void update_serve_throughput_estimation (struct resource_provider_state_t *state)
+{
+    // Execution shared state is only modified by serve tasks and they are guaranteed to be finished by now.
+    if (state->execution_shared_state.finished_size >= KAN_UNIVERSE_RESOURCE_PROVIDER_THROUGHPUT_MIN_SAMPLE)
+    {
+        const kan_time_size_t measured_ns_per_kib = KAN_MAX (
+            1u, state->execution_shared_state.finished_spent_ns * 1024u / state->execution_shared_state.finished_size);
+
+        // Smooth out the estimation as loading time of separate resources can vary a lot.
+        state->serve_ns_per_kib = (state->serve_ns_per_kib * 3u + measured_ns_per_kib) / 4u;
+        state->execution_shared_state.finished_size = 0u;
+        state->execution_shared_state.finished_spent_ns = 0u;
+    }
+}
+
 UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_EXECUTE_SIGNATURE (mutator_template_execute_resource_provider,
                                                                  resource_provider_state_t)
 {
@@ -1736,6 +2117,7 @@ UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_EXECUTE_SIGNATURE (mutator_templat
     {
         // Hot reload is going on, do not start any operation until it is done. All operations prior to hot reload
         // execution would delay it, so we cannot have any ongoing operation if it is already executing.
+        state->last_frame_begin_time_ns = 0u;
         return;
     }
 
@@ -1744,10 +2126,37 @@ UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_EXECUTE_SIGNATURE (mutator_templat
     struct kan_cpu_task_list_node_t *task_list_node = NULL;
 
     state->execution_shared_state.job = job;
-    state->execution_shared_state.end_time_ns = frame_begin_time_ns + state->serve_budget_ns;
+    update_serve_throughput_estimation (state);
+
+    if (KAN_HANDLE_IS_VALID (state->hot_reload_system) &&
+        kan_hot_reload_coordination_system_is_scheduled (state->hot_reload_system) &&
+        kan_atomic_int_get (&state->background_loads_in_flight) > 0)
+    {
+        // Background loads might belong to already deleted operations, but they still use current reflection data.
+        kan_hot_reload_coordination_system_delay (state->hot_reload_system);
+    }
+
+    if (public->serve_unbounded)
+    {
+        state->execution_shared_state.end_time_ns = KAN_INT_MAX (kan_time_size_t);
+
+        // Unbounded frames are not representative for the frame time measurement.
+        state->last_frame_begin_time_ns = 0u;
+    }
+    else
+    {
+        const kan_time_offset_t serve_budget_ns = kan_resource_provider_calculate_serve_budget (
+            &state->budget_configuration,
+            state->last_frame_begin_time_ns == 0u ? 0u : frame_begin_time_ns - state->last_frame_begin_time_ns,
+            state->last_serve_budget_ns);
+        state->execution_shared_state.end_time_ns = frame_begin_time_ns + serve_budget_ns;
+        state->last_frame_begin_time_ns = frame_begin_time_ns;
+        state->last_serve_budget_ns = serve_budget_ns;
+    }
 
     state->execution_shared_state.workers_left = kan_atomic_int_init ((int) cpu_count);
     state->execution_shared_state.concurrency_lock = kan_atomic_int_init (0);
+    state->execution_shared_state.any_operation_taken = false;
 
     state->execution_shared_state.private = private;
     KAN_UM_ACCESS_ESCAPE (state->execution_shared_state.private_access, private)
@@ -1767,6 +2176,12 @@ UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_EXECUTE_SIGNATURE (mutator_templat
 UNIVERSE_RESOURCE_PROVIDER_API KAN_UM_MUTATOR_UNDEPLOY_SIGNATURE (mutator_template_undeploy_resource_provider,
                                                                   resource_provider_state_t)
 {
+    // Background loads use shared script storage, therefore we need to wait for them.
+    while (kan_atomic_int_get (&state->background_loads_in_flight) > 0)
+    {
+        kan_precise_time_sleep (KAN_UNIVERSE_RESOURCE_PROVIDER_BACKGROUND_LOADS_WAIT_NS);
+    }
+
     kan_serialization_binary_script_storage_destroy (state->shared_script_storage);
     kan_stack_group_allocator_reset (&state->temporary_allocator);
 }
@@ -2256,14 +2671,45 @@ UNIVERSE_RESOURCE_PROVIDER_API void kan_reflection_generator_universe_resource_p
 void kan_resource_provider_configuration_init (struct kan_resource_provider_configuration_t *instance)
 {
     instance->serve_budget_ns = 2000000u;
+    instance->serve_budget_max_ns = instance->serve_budget_ns;
+    instance->target_frame_time_ns = 0u;
+    instance->background_deserialization = false;
     instance->resource_directory_path = kan_string_intern ("resources");
 }
 
+kan_time_offset_t kan_resource_provider_calculate_serve_budget (
+    const struct kan_resource_provider_configuration_t *configuration,
+    kan_time_size_t last_frame_time_ns,
+    kan_time_offset_t last_serve_budget_ns)
+{
+    const kan_time_size_t min_budget_ns = (kan_time_size_t) configuration->serve_budget_ns;
+    if (configuration->target_frame_time_ns == 0u || last_frame_time_ns == 0u)
+    {
+        return configuration->serve_budget_ns;
+    }
+
+    // Serving is done in parallel with other mutators, therefore we cannot measure time spent on other work directly.
+    // Instead, we treat the whole previous budget as spent on serving, which gives lower bound for other work time.
+    const kan_time_size_t other_work_ns = last_frame_time_ns > (kan_time_size_t) last_serve_budget_ns ?
+                                              last_frame_time_ns - (kan_time_size_t) last_serve_budget_ns :
+                                              0u;
+
+    if (other_work_ns >= (kan_time_size_t) configuration->target_frame_time_ns)
+    {
+        return configuration->serve_budget_ns;
+    }
+
+    const kan_time_size_t max_budget_ns = KAN_MAX (min_budget_ns, (kan_time_size_t) configuration->serve_budget_max_ns);
+    const kan_time_size_t headroom_ns = (kan_time_size_t) configuration->target_frame_time_ns - other_work_ns;
+    return (kan_time_offset_t) KAN_CLAMP (headroom_ns, min_budget_ns, max_budget_ns);
+}
+
 void kan_resource_provider_singleton_init (struct kan_resource_provider_singleton_t *instance)
 {
     instance->usage_id_counter = kan_atomic_int_init (1);
     instance->third_party_blob_id_counter = kan_atomic_int_init (1);
     instance->scan_done = false;
+    instance->serve_unbounded = false;
     instance->logic_deduplication_frame_id = 0u;
 }
 
@@ -2277,6 +2723,7 @@ void kan_resource_generic_entry_init (struct kan_resource_generic_entry_t *insta
     instance->removal_mark = false;
     instance->path_hash = 0u;
     instance->path = NULL;
+    instance->size = 0u;
     instance->my_allocation_group = kan_allocation_group_stack_get ();
 }
 
@@ -2296,6 +2743,7 @@ void kan_resource_third_party_entry_init (struct kan_resource_third_party_entry_
     instance->removal_mark = false;
     instance->path_hash = 0u;
     instance->path = NULL;
+    instance->size = 0u;
     instance->my_allocation_group = kan_allocation_group_stack_get ();
 }
 
@@ -129,6 +129,22 @@
 /// `kan_resource_third_party_blob_failed_t` is fired when third party resource loading into blob has failed.
 /// \endparblock
 ///
+/// \par Serving
+/// \parblock
+/// Loading operations are served in priority order within time budget that is either fixed or adapted to the frame
+/// headroom when `target_frame_time_ns` is specified in configuration. Budget can be disabled altogether through
+/// `serve_unbounded` flag in singleton, which is advised for loading screens.
+///
+/// Every operation has cost estimation that is calculated from resource file size and measured loading throughput.
+/// When operation that was not started yet would not fit into the remaining budget, it is postponed to the next frame
+/// and smaller operations with lower priority are served instead, so big resources do not cause frame time spikes
+/// when they are requested in the middle of the frame budget.
+///
+/// When `background_deserialization` is enabled in configuration, native resources are read and deserialized by
+/// separate tasks that are not bound to frame and provider only commits finished resources into repository during
+/// update. Third party blobs are always loaded within the serve budget.
+/// \endparblock
+///
 /// \par Hot reload
 /// \parblock
 /// When `kan_hot_reload_coordination_system_is_possible` is `true` and hot reload coordination system is present,
@@ -195,8 +211,24 @@ KAN_TYPED_ID_32_DEFINE (kan_resource_usage_id_t);
 struct kan_resource_provider_configuration_t
 {
     /// \brief How much time in nanoseconds should be spent loading resources during update.
+    /// \details When adaptive budgeting is enabled, it is the minimal budget that is always given to loading.
     kan_time_offset_t serve_budget_ns;
 
+    /// \brief Maximum time in nanoseconds that can be spent loading resources during update when adaptive budgeting
+    ///        decides that frame has enough headroom.
+    kan_time_offset_t serve_budget_max_ns;
+
+    /// \brief Frame time in nanoseconds that adaptive budgeting is aiming at. Zero disables adaptive budgeting.
+    /// \details When adaptive budgeting is enabled, time that was spent on everything except resource loading during
+    ///          previous frame is subtracted from target frame time and the result, clamped between `serve_budget_ns`
+    ///          and `serve_budget_max_ns`, is used as loading budget for the current frame.
+    kan_time_offset_t target_frame_time_ns;
+
+    /// \brief If true, native resources are read and deserialized by background tasks that are not bound to frame.
+    /// \details In this mode, serve budget is only used to commit already loaded resources into repository, so
+    ///          streaming of big resources does not compete with other frame work for the serve budget.
+    bool background_deserialization;
+
     /// \brief Path to virtual directory with resources, that is used as resource root directory.
     kan_interned_string_t resource_directory_path;
 };
@@ -204,6 +236,14 @@ struct kan_resource_provider_configuration_t
 UNIVERSE_RESOURCE_PROVIDER_API void kan_resource_provider_configuration_init (
     struct kan_resource_provider_configuration_t *instance);
 
+/// \brief Calculates serve budget for the current frame using adaptive budgeting rules from configuration.
+/// \param last_frame_time_ns Duration of the previous frame or zero if it cannot be used for measurement.
+/// \param last_serve_budget_ns Serve budget that was used during the previous frame.
+UNIVERSE_RESOURCE_PROVIDER_API kan_time_offset_t
+kan_resource_provider_calculate_serve_budget (const struct kan_resource_provider_configuration_t *configuration,
+                                              kan_time_size_t last_frame_time_ns,
+                                              kan_time_offset_t last_serve_budget_ns);
+
 /// \brief Contains counter for usage ids and flag that tells whether resource scan is done.
 struct kan_resource_provider_singleton_t
 {
@@ -216,6 +256,11 @@ struct kan_resource_provider_singleton_t
     /// \brief Whether resource provider finished scanning for resources and is able to provide full list of entries.
     bool scan_done;
 
+    /// \brief If true, resource provider ignores serve budget and loads everything that is requested during update.
+    /// \details Designed for loading screens and similar cases when frame time is not important and it is better to
+    ///          load resources as fast as possible. Can be freely changed by user logic.
+    bool serve_unbounded;
+
     /// \brief Frame id that can be used by resources to avoid recalculating the
     ///        same values several times during one frame.
     /// \invariant Guaranteed to be different every frame. Guaranteed to have the same value for the whole frame.
@@ -266,6 +311,10 @@ struct kan_resource_generic_entry_t
 
     kan_hash_t path_hash;
     char *path;
+
+    /// \brief Size of resource file in bytes or zero if unknown. Used to estimate loading cost.
+    kan_file_size_t size;
+
     kan_allocation_group_t my_allocation_group;
 };
 
@@ -312,6 +361,10 @@ struct kan_resource_third_party_entry_t
 
     kan_hash_t path_hash;
     char *path;
+
+    /// \brief Size of resource file in bytes or zero if unknown. Used to estimate loading cost.
+    kan_file_size_t size;
+
     kan_allocation_group_t my_allocation_group;
 };
 
@@ -1,6 +1,21 @@
+#include <qsort.h>
+
+#include <kan/api_common/min_max.h>
+#include <kan/container/dynamic_array.h>
+#include <kan/cpu_dispatch/job.h>
+#include <kan/cpu_dispatch/task.h>
+#include <kan/cpu_profiler/markup.h>
+#include <kan/memory/allocation.h>
+#include <kan/platform/hardware.h>
 #include <kan/universe/macro.h>
 #include <kan/universe_transform/universe_transform.h>
 
+KAN_USE_STATIC_CPU_SECTIONS
+
+KAN_UM_ADD_MUTATOR_TO_FOLLOWING_GROUP (transform_update_2)
+KAN_UM_ADD_MUTATOR_TO_FOLLOWING_GROUP (transform_update_3)
+UNIVERSE_TRANSFORM_API KAN_UM_MUTATOR_GROUP_META (transform_update, KAN_TRANSFORM_UPDATE_MUTATOR_GROUP);
+
 #define TRANSFORM_COMPONENT_META(DIMENSIONS, DIMENSIONS_STRING)                                                        \
     KAN_REFLECTION_STRUCT_META (kan_transform_##DIMENSIONS##_component_t)                                              \
     UNIVERSE_TRANSFORM_API struct kan_repository_meta_automatic_cascade_deletion_t                                     \
@@ -172,5 +187,516 @@ TRANSFORM_SET_LOCAL (3)
 
 TRANSFORM_SET_GLOBAL (2, 3x3, kan_float_matrix_3x3_multiply)
 TRANSFORM_SET_GLOBAL (3, 4x4, kan_float_matrix_4x4_multiply_for_transform)
+#undef TRANSFORM_SET_GLOBAL
+
+#define TRANSFORM_UPDATE_INVALID_INDEX KAN_INT_MAX (kan_instance_size_t)
+
+/// \brief Dirty transform component that was found during batched update gathering.
+KAN_REFLECTION_IGNORE
+struct transform_update_node_t
+{
+    struct kan_repository_indexed_sequence_read_access_t access;
+    void *component;
+    kan_universe_object_id_t object_id;
+    kan_universe_object_id_t parent_object_id;
+
+    /// \brief Index of parent node if parent is also updated in this batch.
+    kan_instance_size_t parent_index;
+
+    kan_instance_size_t level;
+    kan_instance_size_t position;
+};
+
+struct transform_update_batch_t;
+
+/// \brief Describes one hierarchy level as a range in ordered batch arrays.
+/// \details Level is split into chunks that are claimed through atomic counter by the thread that started the level
+///          and by helper tasks. Whoever finishes the last chunk continues with the next level.
+KAN_REFLECTION_IGNORE
+struct transform_update_level_t
+{
+    struct transform_update_batch_t *batch;
+    kan_instance_size_t index;
+    kan_instance_size_t begin;
+    kan_instance_size_t end;
+    kan_instance_size_t chunk_count;
+    struct kan_atomic_int_t next_chunk;
+    struct kan_atomic_int_t chunks_done;
+};
+
+/// \brief Calculates global transforms for given range of ordered batch arrays.
+typedef void (*transform_update_compute_function_t) (struct transform_update_batch_t *batch,
+                                                     kan_instance_size_t begin,
+                                                     kan_instance_size_t end);
+
+/// \brief Dimension independent part of batched transform update, its buffers are reused between frames.
+/// \details Ordered arrays store nodes sorted by hierarchy level, therefore every level is a contiguous range and
+///          parents are always processed before their children.
+KAN_REFLECTION_IGNORE
+struct transform_update_batch_t
+{
+    kan_allocation_group_t allocation_group;
+    kan_instance_size_t matrix_size;
+    kan_instance_size_t matrix_alignment;
+    transform_update_compute_function_t compute;
+    void *compute_user_data;
+    kan_cpu_job_t job;
+
+    struct kan_dynamic_array_t nodes;
+    struct kan_dynamic_array_t levels;
+
+    kan_instance_size_t ordered_capacity;
+    void **ordered_components;
+    kan_instance_size_t *ordered_parents;
+    void *ordered_global_matrices;
+};
+
+static void transform_update_batch_init (struct transform_update_batch_t *batch,
+                                         kan_instance_size_t matrix_size,
+                                         kan_instance_size_t matrix_alignment,
+                                         transform_update_compute_function_t compute,
+                                         void *compute_user_data)
+{
+    batch->allocation_group = kan_allocation_group_get_child (kan_allocation_group_stack_get (), "transform_update");
+    batch->matrix_size = matrix_size;
+    batch->matrix_alignment = matrix_alignment;
+    batch->compute = compute;
+    batch->compute_user_data = compute_user_data;
+    batch->job = KAN_HANDLE_SET_INVALID (kan_cpu_job_t);
+
+    kan_dynamic_array_init (&batch->nodes, KAN_UNIVERSE_TRANSFORM_UPDATE_INITIAL_NODES,
+                            sizeof (struct transform_update_node_t), alignof (struct transform_update_node_t),
+                            batch->allocation_group);
+    kan_dynamic_array_init (&batch->levels, KAN_UNIVERSE_TRANSFORM_UPDATE_INITIAL_LEVELS,
+                            sizeof (struct transform_update_level_t), alignof (struct transform_update_level_t),
+                            batch->allocation_group);
+
+    batch->ordered_capacity = 0u;
+    batch->ordered_components = NULL;
+    batch->ordered_parents = NULL;
+    batch->ordered_global_matrices = NULL;
+}
+
+static void transform_update_batch_free_ordered (struct transform_update_batch_t *batch)
+{
+    if (batch->ordered_capacity > 0u)
+    {
+        kan_free_general (batch->allocation_group, batch->ordered_components,
+                          sizeof (void *) * batch->ordered_capacity);
+        kan_free_general (batch->allocation_group, batch->ordered_parents,
+                          sizeof (kan_instance_size_t) * batch->ordered_capacity);
+        kan_free_general (batch->allocation_group, batch->ordered_global_matrices,
+                          batch->matrix_size * batch->ordered_capacity);
+    }
+}
+
+static void transform_update_batch_shutdown (struct transform_update_batch_t *batch)
+{
+    transform_update_batch_free_ordered (batch);
+    kan_dynamic_array_shutdown (&batch->nodes);
+    kan_dynamic_array_shutdown (&batch->levels);
+}
+
+static struct transform_update_node_t *transform_update_batch_add_node (struct transform_update_batch_t *batch)
+{
+    if (batch->nodes.size == batch->nodes.capacity)
+    {
+        kan_dynamic_array_set_capacity (&batch->nodes, KAN_MAX (1u, batch->nodes.capacity * 2u));
+    }
+
+    return kan_dynamic_array_add_last (&batch->nodes);
+}
+
+static void transform_update_batch_ensure_ordered_capacity (struct transform_update_batch_t *batch,
+                                                            kan_instance_size_t capacity)
+{
+    if (batch->ordered_capacity >= capacity)
+    {
+        return;
+    }
+
+    transform_update_batch_free_ordered (batch);
+    batch->ordered_capacity = KAN_MAX (capacity, batch->ordered_capacity * 2u);
+
+    batch->ordered_components = kan_allocate_general (
+        batch->allocation_group, sizeof (void *) * batch->ordered_capacity, alignof (void *));
+    batch->ordered_parents =
+        kan_allocate_general (batch->allocation_group, sizeof (kan_instance_size_t) * batch->ordered_capacity,
+                              alignof (kan_instance_size_t));
+    batch->ordered_global_matrices = kan_allocate_general (
+        batch->allocation_group, batch->matrix_size * batch->ordered_capacity, batch->matrix_alignment);
+}
+
+static kan_instance_size_t transform_update_batch_find_node (struct transform_update_batch_t *batch,
+                                                             kan_universe_object_id_t object_id)
+{
+    const struct transform_update_node_t *nodes = batch->nodes.data;
+    kan_instance_size_t begin = 0u;
+    kan_instance_size_t end = batch->nodes.size;
+
+    while (begin < end)
+    {
+        const kan_instance_size_t middle = begin + (end - begin) / 2u;
+        if (KAN_TYPED_ID_32_GET (nodes[middle].object_id) < KAN_TYPED_ID_32_GET (object_id))
+        {
+            begin = middle + 1u;
+        }
+        else
+        {
+            end = middle;
+        }
+    }
+
+    return begin < batch->nodes.size && KAN_TYPED_ID_32_IS_EQUAL (nodes[begin].object_id, object_id) ?
+               begin :
+               TRANSFORM_UPDATE_INVALID_INDEX;
+}
+
+/// \brief Links gathered nodes with their parents and sorts them into levels in ordered arrays.
+static void transform_update_batch_prepare (struct transform_update_batch_t *batch)
+{
+    KAN_CPU_SCOPED_STATIC_SECTION (transform_update_prepare)
+    struct transform_update_node_t *nodes = batch->nodes.data;
+    const kan_instance_size_t count = batch->nodes.size;
+
+    {
+        struct transform_update_node_t temporary;
+#define LESS(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__ (KAN_TYPED_ID_32_GET (nodes[first_index].object_id) <                                         \
+                          KAN_TYPED_ID_32_GET (nodes[second_index].object_id))
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = nodes[first_index], nodes[first_index] = nodes[second_index], nodes[second_index] = temporary
+
+        QSORT (count, LESS, SWAP);
+#undef LESS
+#undef SWAP
+    }
+
+    for (kan_loop_size_t index = 0u; index < count; ++index)
+    {
+        nodes[index].parent_index = transform_update_batch_find_node (batch, nodes[index].parent_object_id);
+        nodes[index].level = TRANSFORM_UPDATE_INVALID_INDEX;
+    }
+
+    kan_instance_size_t level_count = 0u;
+    for (kan_loop_size_t index = 0u; index < count; ++index)
+    {
+        if (nodes[index].level != TRANSFORM_UPDATE_INVALID_INDEX)
+        {
+            continue;
+        }
+
+        // Walk up until we reach node with known level or node which parent is not updated in this batch,
+        // then walk again to assign levels to the whole visited chain.
+        kan_instance_size_t depth = 0u;
+        kan_instance_size_t top_index = index;
+
+        while (nodes[top_index].level == TRANSFORM_UPDATE_INVALID_INDEX &&
+               nodes[top_index].parent_index != TRANSFORM_UPDATE_INVALID_INDEX)
+        {
+            top_index = nodes[top_index].parent_index;
+            ++depth;
+        }
+
+        if (nodes[top_index].level == TRANSFORM_UPDATE_INVALID_INDEX)
+        {
+            nodes[top_index].level = 0u;
+        }
+
+        const kan_instance_size_t top_level = nodes[top_index].level;
+        kan_instance_size_t chain_index = index;
+
+        for (kan_loop_size_t step = depth; step > 0u; --step)
+        {
+            nodes[chain_index].level = top_level + step;
+            chain_index = nodes[chain_index].parent_index;
+        }
+
+        level_count = KAN_MAX (level_count, top_level + depth + 1u);
+    }
+
+    if (batch->levels.capacity < level_count)
+    {
+        kan_dynamic_array_set_capacity (&batch->levels, level_count);
+    }
+
+    batch->levels.size = level_count;
+    struct transform_update_level_t *levels = batch->levels.data;
+
+    for (kan_loop_size_t index = 0u; index < level_count; ++index)
+    {
+        levels[index].batch = batch;
+        levels[index].index = index;
+        levels[index].begin = 0u;
+        levels[index].end = 0u;
+    }
+
+    for (kan_loop_size_t index = 0u; index < count; ++index)
+    {
+        ++levels[nodes[index].level].end;
+    }
+
+    kan_instance_size_t level_begin = 0u;
+    for (kan_loop_size_t index = 0u; index < level_count; ++index)
+    {
+        const kan_instance_size_t level_size = levels[index].end;
+        levels[index].begin = level_begin;
+        levels[index].end = level_begin;
+        level_begin += level_size;
+    }
+
+    transform_update_batch_ensure_ordered_capacity (batch, count);
+    for (kan_loop_size_t index = 0u; index < count; ++index)
+    {
+        const kan_instance_size_t position = levels[nodes[index].level].end++;
+        nodes[index].position = position;
+        batch->ordered_components[position] = nodes[index].component;
+    }
+
+    for (kan_loop_size_t index = 0u; index < count; ++index)
+    {
+        batch->ordered_parents[nodes[index].position] = nodes[index].parent_index == TRANSFORM_UPDATE_INVALID_INDEX ?
+                                                            TRANSFORM_UPDATE_INVALID_INDEX :
+                                                            nodes[nodes[index].parent_index].position;
+    }
+
+    for (kan_loop_size_t index = 0u; index < level_count; ++index)
+    {
+        const kan_instance_size_t level_size = levels[index].end - levels[index].begin;
+        levels[index].chunk_count =
+            (level_size + KAN_UNIVERSE_TRANSFORM_UPDATE_CHUNK_SIZE - 1u) / KAN_UNIVERSE_TRANSFORM_UPDATE_CHUNK_SIZE;
+        levels[index].next_chunk = kan_atomic_int_init (0);
+        levels[index].chunks_done = kan_atomic_int_init (0);
+    }
+}
+
+static void transform_update_batch_finish (struct transform_update_batch_t *batch)
+{
+    struct transform_update_node_t *nodes = batch->nodes.data;
+    for (kan_loop_size_t index = 0u; index < batch->nodes.size; ++index)
+    {
+        kan_repository_indexed_sequence_read_access_close (&nodes[index].access);
+    }
+
+    batch->nodes.size = 0u;
+    batch->levels.size = 0u;
+}
+
+/// \brief Processes level chunks until there is nothing to claim.
+/// \return True if this thread has finished the last chunk of the level and should continue with the next one.
+static bool transform_update_level_process (struct transform_update_level_t *level)
+{
+    while (true)
+    {
+        const kan_instance_size_t chunk = (kan_instance_size_t) kan_atomic_int_add (&level->next_chunk, 1);
+        if (chunk >= level->chunk_count)
+        {
+            return false;
+        }
+
+        const kan_instance_size_t begin = level->begin + chunk * KAN_UNIVERSE_TRANSFORM_UPDATE_CHUNK_SIZE;
+        const kan_instance_size_t end = KAN_MIN (begin + KAN_UNIVERSE_TRANSFORM_UPDATE_CHUNK_SIZE, level->end);
+        level->batch->compute (level->batch, begin, end);
+
+        if ((kan_instance_size_t) kan_atomic_int_add (&level->chunks_done, 1) + 1u == level->chunk_count)
+        {
+            return true;
+        }
+    }
+}
+
+static void transform_update_batch_execute_from_level (struct transform_update_batch_t *batch,
+                                                       kan_instance_size_t level_index);
+
+static void transform_update_level_helper (kan_functor_user_data_t user_data)
+{
+    struct transform_update_level_t *level = (struct transform_update_level_t *) user_data;
+    if (transform_update_level_process (level))
+    {
+        transform_update_batch_execute_from_level (level->batch, level->index + 1u);
+    }
+}
+
+/// \brief Executes levels one by one starting from given one, helper tasks are dispatched into mutator job.
+/// \details Mutator job is not finished until all its tasks are finished, therefore escaped accesses are guaranteed
+///          to be closed before anyone else can access transform components with update or write access.
+static void transform_update_batch_execute_from_level (struct transform_update_batch_t *batch,
+                                                       kan_instance_size_t level_index)
+{
+    while (level_index < batch->levels.size)
+    {
+        struct transform_update_level_t *level = &((struct transform_update_level_t *) batch->levels.data)[level_index];
+        const kan_instance_size_t helpers_count =
+            KAN_MIN (level->chunk_count - 1u, KAN_MAX (1u, kan_platform_get_cpu_logical_core_count ()) - 1u);
+
+        for (kan_loop_size_t index = 0u; index < helpers_count; ++index)
+        {
+            kan_cpu_task_detach (kan_cpu_job_dispatch_task (batch->job, (struct kan_cpu_task_t) {
+                                                                .function = transform_update_level_helper,
+                                                                .user_data = (kan_functor_user_data_t) level,
+                                                                .profiler_section =
+                                                                    KAN_CPU_STATIC_SECTION_GET (transform_update_level),
+                                                            }));
+        }
+
+        if (!transform_update_level_process (level))
+        {
+            // Last chunk is finished by other thread, it will continue execution.
+            return;
+        }
+
+        ++level_index;
+    }
+
+    transform_update_batch_finish (batch);
+}
+
+static void transform_update_batch_execute (struct transform_update_batch_t *batch, kan_cpu_job_t job)
+{
+    if (batch->nodes.size == 0u)
+    {
+        return;
+    }
+
+    batch->job = job;
+    transform_update_batch_prepare (batch);
+    transform_update_batch_execute_from_level (batch, 0u);
+}
+
+#define TRANSFORM_UPDATE_FUNCTIONS(TRANSFORM_DIMENSION, MATRIX_DIMENSION, MULTIPLIER)                                  \
+    static void transform_update_##TRANSFORM_DIMENSION##_gather (                                                      \
+        struct transform_update_##TRANSFORM_DIMENSION##_state_t *state)                                                \
+    {                                                                                                                  \
+        KAN_CPU_SCOPED_STATIC_SECTION (transform_update_gather)                                                        \
+        KAN_UM_BIND_STATE (transform_update_##TRANSFORM_DIMENSION, state)                                              \
+                                                                                                                       \
+        KAN_UML_SEQUENCE_READ (component, kan_transform_##TRANSFORM_DIMENSION##_component_t)                           \
+        {                                                                                                              \
+            /* Roots always use local transform as global one. Dirty flag can only be raised under update access,      \
+             * therefore it is safe to check it without lock here. */                                                  \
+            if (!KAN_TYPED_ID_32_IS_VALID (component->parent_object_id) || !component->global_dirty)                   \
+            {                                                                                                          \
+                continue;                                                                                              \
+            }                                                                                                          \
+                                                                                                                       \
+            struct transform_update_node_t *node = transform_update_batch_add_node (&state->batch);                    \
+            node->component = (void *) component;                                                                      \
+            node->object_id = component->object_id;                                                                    \
+            node->parent_object_id = component->parent_object_id;                                                      \
+            KAN_UM_ACCESS_ESCAPE (node->access, component)                                                             \
+        }                                                                                                              \
+    }                                                                                                                  \
+                                                                                                                       \
+    static inline struct kan_float_matrix_##MATRIX_DIMENSION##_t                                                       \
+        transform_update_##TRANSFORM_DIMENSION##_query_parent_matrix (                                                 \
+            struct kan_transform_##TRANSFORM_DIMENSION##_queries_t *queries,                                           \
+            const struct kan_transform_##TRANSFORM_DIMENSION##_component_t *component)                                 \
+    {                                                                                                                  \
+        KAN_UM_BIND_STATE_FIELDLESS (kan_transform_##TRANSFORM_DIMENSION##_queries_t, queries)                         \
+        KAN_UMI_VALUE_READ_REQUIRED (parent_component, kan_transform_##TRANSFORM_DIMENSION##_component_t, object_id,   \
+                                     &component->parent_object_id)                                                     \
+                                                                                                                       \
+        /* Parent is either root or is not dirty, therefore lazy getter does not go up the hierarchy. */               \
+        struct kan_transform_##TRANSFORM_DIMENSION##_t parent_transform =                                              \
+            kan_transform_##TRANSFORM_DIMENSION##_component_get_global (queries, parent_component);                    \
+        return kan_transform_##TRANSFORM_DIMENSION##_to_float_matrix_##MATRIX_DIMENSION (&parent_transform);           \
+    }                                                                                                                  \
+                                                                                                                       \
+    static void transform_update_##TRANSFORM_DIMENSION##_compute (                                                     \
+        struct transform_update_batch_t *batch, kan_instance_size_t begin, kan_instance_size_t end)                    \
+    {                                                                                                                  \
+        struct kan_transform_##TRANSFORM_DIMENSION##_queries_t *queries = batch->compute_user_data;                    \
+        struct kan_float_matrix_##MATRIX_DIMENSION##_t *global_matrices = batch->ordered_global_matrices;              \
+                                                                                                                       \
+        for (kan_loop_size_t position = begin; position < end; ++position)                                             \
+        {                                                                                                              \
+            struct kan_transform_##TRANSFORM_DIMENSION##_component_t *component =                                      \
+                batch->ordered_components[position];                                                                   \
+            const kan_instance_size_t parent_position = batch->ordered_parents[position];                              \
+                                                                                                                       \
+            const struct kan_float_matrix_##MATRIX_DIMENSION##_t local_matrix =                                        \
+                kan_transform_##TRANSFORM_DIMENSION##_to_float_matrix_##MATRIX_DIMENSION (&component->local);          \
+                                                                                                                       \
+            if (parent_position == TRANSFORM_UPDATE_INVALID_INDEX)                                                     \
+            {                                                                                                          \
+                const struct kan_float_matrix_##MATRIX_DIMENSION##_t parent_matrix =                                   \
+                    transform_update_##TRANSFORM_DIMENSION##_query_parent_matrix (queries, component);                 \
+                global_matrices[position] = MULTIPLIER (&parent_matrix, &local_matrix);                                \
+            }                                                                                                          \
+            else                                                                                                       \
+            {                                                                                                          \
+                global_matrices[position] =                                                                            \
+                    MULTIPLIER (&global_matrices[parent_position], &local_matrix);                                     \
+            }                                                                                                          \
+                                                                                                                       \
+            const struct kan_transform_##TRANSFORM_DIMENSION##_t global =                                              \
+                kan_float_matrix_##MATRIX_DIMENSION##_to_transform_##TRANSFORM_DIMENSION (&global_matrices[position]); \
+                                                                                                                       \
+            /* Conversion to transform is lossy, so children must use the same matrix as lazy getter would build. */   \
+            global_matrices[position] =                                                                                \
+                kan_transform_##TRANSFORM_DIMENSION##_to_float_matrix_##MATRIX_DIMENSION (&global);                    \
+                                                                                                                       \
+            KAN_ATOMIC_INT_SCOPED_LOCK (&component->global_lock)                                                       \
+            component->global = global;                                                                                \
+            component->global_dirty = false;                                                                           \
+        }                                                                                                              \
+    }
+
+struct transform_update_2_state_t
+{
+    KAN_UM_GENERATE_STATE_QUERIES (transform_update_2)
+    KAN_UM_BIND_STATE (transform_update_2, state)
+
+    struct kan_transform_2_queries_t transform_queries;
+
+    KAN_REFLECTION_IGNORE
+    struct transform_update_batch_t batch;
+};
+
+struct transform_update_3_state_t
+{
+    KAN_UM_GENERATE_STATE_QUERIES (transform_update_3)
+    KAN_UM_BIND_STATE (transform_update_3, state)
+
+    struct kan_transform_3_queries_t transform_queries;
+
+    KAN_REFLECTION_IGNORE
+    struct transform_update_batch_t batch;
+};
+
+TRANSFORM_UPDATE_FUNCTIONS (2, 3x3, kan_float_matrix_3x3_multiply)
+TRANSFORM_UPDATE_FUNCTIONS (3, 4x4, kan_float_matrix_4x4_multiply_for_transform)
+#undef TRANSFORM_UPDATE_FUNCTIONS
+
+#define TRANSFORM_UPDATE_MUTATOR(TRANSFORM_DIMENSION, MATRIX_DIMENSION)                                                \
+    UNIVERSE_TRANSFORM_API void transform_update_##TRANSFORM_DIMENSION##_state_init (                                  \
+        struct transform_update_##TRANSFORM_DIMENSION##_state_t *instance)                                             \
+    {                                                                                                                  \
+        transform_update_batch_init (&instance->batch, sizeof (struct kan_float_matrix_##MATRIX_DIMENSION##_t),        \
+                                     alignof (struct kan_float_matrix_##MATRIX_DIMENSION##_t),                         \
+                                     transform_update_##TRANSFORM_DIMENSION##_compute, &instance->transform_queries);  \
+    }                                                                                                                  \
+                                                                                                                       \
+    UNIVERSE_TRANSFORM_API void transform_update_##TRANSFORM_DIMENSION##_state_shutdown (                              \
+        struct transform_update_##TRANSFORM_DIMENSION##_state_t *instance)                                             \
+    {                                                                                                                  \
+        transform_update_batch_shutdown (&instance->batch);                                                            \
+    }                                                                                                                  \
+                                                                                                                       \
+    UNIVERSE_TRANSFORM_API KAN_UM_MUTATOR_DEPLOY (transform_update_##TRANSFORM_DIMENSION)                              \
+    {                                                                                                                  \
+        kan_cpu_static_sections_ensure_initialized ();                                                                 \
+        kan_workflow_graph_node_depend_on (workflow_node, KAN_TRANSFORM_UPDATE_BEGIN_CHECKPOINT);                      \
+        kan_workflow_graph_node_make_dependency_of (workflow_node, KAN_TRANSFORM_UPDATE_END_CHECKPOINT);               \
+    }                                                                                                                  \
+                                                                                                                       \
+    UNIVERSE_TRANSFORM_API KAN_UM_MUTATOR_EXECUTE (transform_update_##TRANSFORM_DIMENSION)                             \
+    {                                                                                                                  \
+        transform_update_##TRANSFORM_DIMENSION##_gather (state);                                                       \
+        transform_update_batch_execute (&state->batch, job);                                                           \
+    }
 
-#undef VISUAL_TRANSFORM_SYNC_CALCULATE_MUTATOR
+TRANSFORM_UPDATE_MUTATOR (2, 3x3)
+TRANSFORM_UPDATE_MUTATOR (3, 4x4)
+#undef TRANSFORM_UPDATE_MUTATOR
@@ -19,9 +19,27 @@
 /// functions, which is crucial to properly move through the hierarchies. Also, it utilizes custom lock for properly
 /// updating global transform cache without requiring update/write access to do so.
 /// \endparblock
+///
+/// \par Batched update
+/// \parblock
+/// Transform update mutator group contains mutators that recalculate all dirty global transforms once per frame.
+/// Dirty transforms are sorted by their hierarchy level, so every level can be processed as a contiguous batch of
+/// matrix multiplications, split between several cpu tasks when it is big enough. Lazy global transform getter is
+/// still used for transforms that are requested before this group or that were invalidated after it, so adding this
+/// group is optional and only affects performance, not the results.
+/// \endparblock
 
 KAN_C_HEADER_BEGIN
 
+/// \brief Group that is used to add all batched transform update mutators.
+#define KAN_TRANSFORM_UPDATE_MUTATOR_GROUP "transform_update"
+
+/// \brief Checkpoint, after which batched transform update mutators are executed.
+#define KAN_TRANSFORM_UPDATE_BEGIN_CHECKPOINT "transform_update_begin"
+
+/// \brief Checkpoint, that is hit after all batched transform update mutators have finished execution.
+#define KAN_TRANSFORM_UPDATE_END_CHECKPOINT "transform_update_end"
+
 #define KAN_TRANSFORM_INTERFACE(DIMENSIONS)                                                                            \
     struct kan_transform_##DIMENSIONS##_component_t                                                                    \
     {                                                                                                                  \
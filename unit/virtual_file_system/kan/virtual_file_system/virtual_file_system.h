@@ -4,6 +4,7 @@
 
 #include <kan/api_common/c_header.h>
 #include <kan/api_common/core_types.h>
+#include <kan/file_system/async_read.h>
 #include <kan/file_system/path_container.h>
 
 /// \file
@@ -60,6 +61,10 @@
 /// Read only pack can be mounted as mount point, but data under that mount point cannot be modified. Therefore
 /// directory creation and file open for write operations will fail.
 ///
+/// Read only pack registry is stored as precomputed directory table with path hash lookup and string blob. It is
+/// loaded as single block during mount and used in place, therefore mounting does not depend on item count in terms of
+/// allocations and entry lookups are done through binary search by full path hash.
+///
 /// Read only packs can be created using `kan_virtual_file_system_read_only_pack_builder_t`. For example:
 ///
 /// ```c
@@ -222,6 +227,13 @@ VIRTUAL_FILE_SYSTEM_API bool kan_virtual_file_system_remove_empty_directory (kan
 VIRTUAL_FILE_SYSTEM_API struct kan_stream_t *kan_virtual_file_stream_open_for_read (
     kan_virtual_file_system_volume_t volume, const char *path);
 
+/// \brief Submits asynchronous read of the range inside file at given virtual path.
+/// \details Request path is treated as virtual path. Files inside read only packs are supported: range is converted
+///          to the range inside pack file and clamped to the file size. Returns invalid handle if read cannot be
+///          submitted.
+VIRTUAL_FILE_SYSTEM_API kan_file_system_async_read_t kan_virtual_file_system_read_async (
+    kan_virtual_file_system_volume_t volume, const struct kan_file_system_async_read_request_t *request);
+
 /// \brief Attempts to open file at given virtual path for writing.
 VIRTUAL_FILE_SYSTEM_API struct kan_stream_t *kan_virtual_file_stream_open_for_write (
     kan_virtual_file_system_volume_t volume, const char *path);
@@ -240,6 +252,15 @@ VIRTUAL_FILE_SYSTEM_API bool kan_virtual_file_system_read_only_pack_builder_add
     struct kan_stream_t *input_stream,
     const char *path_in_pack);
 
+/// \brief Adds new entry to the pack with given data that is already fully loaded into memory.
+/// \details Data is written with one write operation, which makes it the fastest way to add entries that were
+///          prepared in advance, for example encoded in parallel into staging buffers.
+VIRTUAL_FILE_SYSTEM_API bool kan_virtual_file_system_read_only_pack_builder_add_blob (
+    kan_virtual_file_system_read_only_pack_builder_t builder,
+    const void *data,
+    kan_file_size_t size,
+    const char *path_in_pack);
+
 /// \brief Adds new entry to the pack and lets user fill it using returned stream.
 /// \details Entry addition is finished when stream is closed. If stream write returned zero, then addition has failed
 ///          the same way as if `false` is returned from `kan_virtual_file_system_read_only_pack_builder_add`.
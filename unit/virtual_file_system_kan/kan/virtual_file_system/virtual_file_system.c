@@ -1,5 +1,8 @@
 #include <stdlib.h>
 
+#include <qsort.h>
+
+#include <kan/api_common/alignment.h>
 #include <kan/api_common/min_max.h>
 #include <kan/api_common/type_punning.h>
 #include <kan/container/dynamic_array.h>
@@ -13,16 +16,11 @@
 #include <kan/hash/hash.h>
 #include <kan/log/logging.h>
 #include <kan/memory/allocation.h>
-#include <kan/reflection/generated_reflection.h>
-#include <kan/reflection/markup.h>
-#include <kan/serialization/binary.h>
 #include <kan/threading/atomic.h>
 #include <kan/virtual_file_system/virtual_file_system.h>
 
 KAN_LOG_DEFINE_CATEGORY (virtual_file_system);
 
-KAN_REFLECTION_EXPECT_UNIT_REGISTRAR_LOCAL (virtual_file_system_kan);
-
 struct mount_point_real_t
 {
     kan_interned_string_t name;
@@ -32,29 +30,70 @@ struct mount_point_real_t
     struct virtual_directory_t *owner_directory;
 };
 
-struct read_only_pack_file_node_t
+/// \brief Magic number that is written at the beginning of read only pack registry.
+#define READ_ONLY_PACK_REGISTRY_MAGIC 0x4B4E5250u
+
+/// \brief Version of read only pack registry format. Bump it when registry layout changes.
+#define READ_ONLY_PACK_REGISTRY_VERSION 1u
+
+/// \brief Header of read only pack registry.
+/// \details Registry is a single block that is loaded as is and used without any parsing. Its layout:
+///          header, directory records, file records, lookup records and string blob. Records reference strings
+///          through offsets in string blob, therefore registry can be used directly from memory.
+struct read_only_pack_registry_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t directories_count;
+    uint32_t files_count;
+    uint32_t lookup_count;
+    uint32_t strings_size;
+};
+
+/// \brief Directory record inside read only pack registry.
+/// \details Directories are sorted by depth and path, therefore children of one directory are always contiguous.
+///          Root directory is always the first one. Files of one directory are contiguous too.
+struct read_only_pack_directory_t
+{
+    uint32_t path_offset;
+    uint32_t name_offset;
+    uint32_t first_child;
+    uint32_t children_count;
+    uint32_t first_file;
+    uint32_t files_count;
+};
+
+/// \brief File record inside read only pack registry.
+struct read_only_pack_file_t
 {
-    struct kan_hash_storage_node_t node;
-    kan_interned_string_t name;
-    kan_interned_string_t extension;
     kan_file_size_t offset;
     kan_file_size_t size;
+    uint32_t path_offset;
+    uint32_t name_offset;
 };
 
-struct read_only_pack_directory_t
+/// \brief Lookup record for hashed path probing. Lookup records are sorted by hash.
+struct read_only_pack_lookup_t
 {
-    kan_interned_string_t name;
-    struct read_only_pack_directory_t *next_on_level;
-    struct read_only_pack_directory_t *first_child;
-    struct kan_hash_storage_t files;
+    kan_hash_t path_hash;
+    uint32_t index;
+    uint32_t is_directory;
 };
 
 struct mount_point_read_only_pack_t
 {
-    struct read_only_pack_directory_t root_directory;
+    kan_interned_string_t name;
     char *real_file_path;
     struct mount_point_read_only_pack_t *next;
     struct mount_point_read_only_pack_t *previous;
+
+    void *registry_data;
+    kan_instance_size_t registry_size;
+    const struct read_only_pack_directory_t *directories;
+    const struct read_only_pack_file_t *files;
+    const struct read_only_pack_lookup_t *lookup;
+    uint32_t lookup_count;
+    const char *strings;
 };
 
 struct virtual_directory_t
@@ -100,7 +139,7 @@ struct read_only_pack_registry_item_t
 
 struct read_only_pack_registry_t
 {
-    KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (struct read_only_pack_registry_item_t)
+    /// \brief Builder-only array of added items, lowered into read only pack registry during finalization.
     struct kan_dynamic_array_t items;
 };
 
@@ -140,15 +179,10 @@ enum read_only_pack_directory_iterator_stage_t
 
 struct read_only_pack_directory_iterator_suffix_t
 {
-    struct read_only_pack_directory_t *directory;
-    char *file_name_buffer;
+    struct mount_point_read_only_pack_t *mount_point;
+    const struct read_only_pack_directory_t *directory;
     enum read_only_pack_directory_iterator_stage_t stage;
-
-    union
-    {
-        struct read_only_pack_directory_t *next_directory;
-        struct read_only_pack_file_node_t *next_file;
-    };
+    uint32_t next_index;
 };
 
 struct directory_iterator_t
@@ -210,7 +244,7 @@ struct file_system_watcher_t
 
     struct virtual_directory_t *attached_to_virtual_directory;
 
-    KAN_REFLECTION_DYNAMIC_ARRAY_TYPE (struct real_file_system_watcher_attachment_t)
+    /// \brief Array of `struct real_file_system_watcher_attachment_t`.
     struct kan_dynamic_array_t real_file_system_attachments;
 
     struct kan_atomic_int_t event_queue_lock;
@@ -220,24 +254,13 @@ struct file_system_watcher_t
 static bool statics_initialized = false;
 static struct kan_atomic_int_t statics_initialization_lock = {.value = 0};
 
-static kan_reflection_registry_t serialization_registry;
-static kan_serialization_binary_script_storage_t serialization_script_storage;
-KAN_USE_STATIC_INTERNED_IDS
-
 static kan_allocation_group_t root_allocation_group;
 static kan_allocation_group_t hierarchy_allocation_group;
-static kan_allocation_group_t read_only_pack_files_allocation_group;
+static kan_allocation_group_t read_only_pack_registry_allocation_group;
 static kan_allocation_group_t read_only_pack_operation_allocation_group;
-static kan_allocation_group_t read_only_pack_directory_iterator_allocation_group;
 static kan_allocation_group_t file_system_watcher_allocation_group;
 static kan_allocation_group_t file_system_watcher_events_allocation_group;
 
-static void shutdown_statics (void)
-{
-    kan_serialization_binary_script_storage_destroy (serialization_script_storage);
-    kan_reflection_registry_destroy (serialization_registry);
-}
-
 static void ensure_statics_initialized (void)
 {
     if (!statics_initialized)
@@ -245,83 +268,23 @@ static void ensure_statics_initialized (void)
         KAN_ATOMIC_INT_SCOPED_LOCK (&statics_initialization_lock)
         if (!statics_initialized)
         {
-            serialization_registry = kan_reflection_registry_create ();
-            KAN_REFLECTION_UNIT_REGISTRAR_NAME (virtual_file_system_kan) (serialization_registry);
-            serialization_script_storage = kan_serialization_binary_script_storage_create (serialization_registry);
-            kan_static_interned_ids_ensure_initialized ();
-
             root_allocation_group =
                 kan_allocation_group_get_child (kan_allocation_group_root (), "virtual_file_system");
             hierarchy_allocation_group = kan_allocation_group_get_child (root_allocation_group, "hierarchy");
-            read_only_pack_files_allocation_group =
-                kan_allocation_group_get_child (hierarchy_allocation_group, "read_only_pack_files");
+            read_only_pack_registry_allocation_group =
+                kan_allocation_group_get_child (hierarchy_allocation_group, "read_only_pack_registry");
             read_only_pack_operation_allocation_group =
                 kan_allocation_group_get_child (root_allocation_group, "read_only_pack_operation");
-            read_only_pack_directory_iterator_allocation_group =
-                kan_allocation_group_get_child (root_allocation_group, "read_only_pack_directory_iterator");
             file_system_watcher_allocation_group =
                 kan_allocation_group_get_child (root_allocation_group, "file_system_watcher");
             file_system_watcher_events_allocation_group =
                 kan_allocation_group_get_child (file_system_watcher_allocation_group, "events");
 
-            atexit (shutdown_statics);
             statics_initialized = true;
         }
     }
 }
 
-static const char *read_only_pack_file_find_name_separator (const char *name_begin, const char *name_end)
-{
-    if (name_begin == name_end)
-    {
-        return NULL;
-    }
-
-    --name_end;
-    while (name_end > name_begin)
-    {
-        if (*name_end == '.')
-        {
-            return name_end;
-        }
-
-        --name_end;
-    }
-
-    return *name_begin == '.' ? name_begin : NULL;
-}
-
-static void read_only_pack_directory_init (struct read_only_pack_directory_t *directory)
-{
-    directory->name = NULL;
-    directory->next_on_level = NULL;
-    directory->first_child = NULL;
-    kan_hash_storage_init (&directory->files, read_only_pack_files_allocation_group,
-                           KAN_VIRTUAL_FILE_SYSTEM_ROPACK_DIRECTORY_INITIAL_ITEMS);
-}
-
-static void read_only_pack_directory_shutdown (struct read_only_pack_directory_t *directory)
-{
-    struct read_only_pack_directory_t *child = directory->first_child;
-    while (child)
-    {
-        struct read_only_pack_directory_t *next = child->next_on_level;
-        read_only_pack_directory_shutdown (child);
-        kan_free_batched (hierarchy_allocation_group, child);
-        child = next;
-    }
-
-    struct read_only_pack_file_node_t *file_node = (struct read_only_pack_file_node_t *) directory->files.items.first;
-    while (file_node)
-    {
-        struct read_only_pack_file_node_t *next = (struct read_only_pack_file_node_t *) file_node->node.list_node.next;
-        kan_free_batched (read_only_pack_files_allocation_group, file_node);
-        file_node = next;
-    }
-
-    kan_hash_storage_shutdown (&directory->files);
-}
-
 static void mount_point_read_only_pack_shutdown (struct mount_point_read_only_pack_t *mount_point)
 {
     if (mount_point->real_file_path)
@@ -330,7 +293,11 @@ static void mount_point_read_only_pack_shutdown (struct mount_point_read_only_pa
                           strlen (mount_point->real_file_path) + 1u);
     }
 
-    read_only_pack_directory_shutdown (&mount_point->root_directory);
+    if (mount_point->registry_data)
+    {
+        kan_free_general (read_only_pack_registry_allocation_group, mount_point->registry_data,
+                          mount_point->registry_size);
+    }
 }
 
 static void mount_point_real_shutdown (struct mount_point_real_t *mount_point)
@@ -510,8 +477,7 @@ static inline struct mount_point_read_only_pack_t *virtual_directory_find_mount_
 
     while (mount_point)
     {
-        if (strncmp (mount_point->root_directory.name, name_begin, length) == 0 &&
-            mount_point->root_directory.name[length] == '\0')
+        if (strncmp (mount_point->name, name_begin, length) == 0 && mount_point->name[length] == '\0')
         {
             return mount_point;
         }
@@ -1070,32 +1036,21 @@ static void inform_mount_point_real_removed (struct volume_t *volume,
     }
 }
 
-static inline void append_read_only_pack_file_name (struct kan_file_system_path_container_t *container,
-                                                    struct read_only_pack_file_node_t *file_node)
+static inline const char *read_only_pack_directory_get_name (struct mount_point_read_only_pack_t *mount_point,
+                                                             const struct read_only_pack_directory_t *directory)
 {
-    if (file_node->name)
-    {
-        kan_file_system_path_container_append (container, file_node->name);
-        if (file_node->extension)
-        {
-            kan_file_system_path_container_add_suffix (container, ".");
-            kan_file_system_path_container_add_suffix (container, file_node->extension);
-        }
-    }
-    else
-    {
-        KAN_ASSERT (file_node->extension)
-        kan_file_system_path_container_append (container, ".");
-        kan_file_system_path_container_add_suffix (container, file_node->extension);
-    }
+    // Root directory name is not stored in registry as it is determined by mount point name.
+    return directory == mount_point->directories ? mount_point->name : mount_point->strings + directory->name_offset;
 }
 
 static void inform_read_only_pack_directory_added (struct file_system_watcher_t *watcher,
-                                                   struct read_only_pack_directory_t *directory,
+                                                   struct mount_point_read_only_pack_t *mount_point,
+                                                   const struct read_only_pack_directory_t *directory,
                                                    struct kan_file_system_path_container_t *recursive_path)
 {
     const kan_instance_size_t length_backup = recursive_path->length;
-    kan_file_system_path_container_append (recursive_path, directory->name);
+    kan_file_system_path_container_append (recursive_path,
+                                           read_only_pack_directory_get_name (mount_point, directory));
 
     {
         KAN_ATOMIC_INT_SCOPED_LOCK (&watcher->event_queue_lock)
@@ -1111,9 +1066,9 @@ static void inform_read_only_pack_directory_added (struct file_system_watcher_t
         }
     }
 
-    struct read_only_pack_file_node_t *file_node = (struct read_only_pack_file_node_t *) directory->files.items.first;
-    while (file_node)
+    for (uint32_t index = 0u; index < directory->files_count; ++index)
     {
+        const struct read_only_pack_file_t *file = &mount_point->files[directory->first_file + index];
         KAN_ATOMIC_INT_SCOPED_LOCK (&watcher->event_queue_lock)
         struct file_system_watcher_event_node_t *event =
             (struct file_system_watcher_event_node_t *) kan_event_queue_submit_begin (&watcher->event_queue);
@@ -1123,18 +1078,17 @@ static void inform_read_only_pack_directory_added (struct file_system_watcher_t
             event->event.event_type = KAN_VIRTUAL_FILE_SYSTEM_EVENT_TYPE_ADDED;
             event->event.entry_type = KAN_VIRTUAL_FILE_SYSTEM_ENTRY_TYPE_FILE;
             kan_file_system_path_container_copy (&event->event.path_container, recursive_path);
-            append_read_only_pack_file_name (&event->event.path_container, file_node);
+            kan_file_system_path_container_append (&event->event.path_container,
+                                                   mount_point->strings + file->name_offset);
             kan_event_queue_submit_end (&watcher->event_queue, &file_system_watcher_event_node_allocate ()->node);
         }
-
-        file_node = (struct read_only_pack_file_node_t *) file_node->node.list_node.next;
     }
 
-    struct read_only_pack_directory_t *child_directory = directory->first_child;
-    while (child_directory)
+    for (uint32_t index = 0u; index < directory->children_count; ++index)
     {
-        inform_read_only_pack_directory_added (watcher, child_directory, recursive_path);
-        child_directory = child_directory->next_on_level;
+        inform_read_only_pack_directory_added (watcher, mount_point,
+                                               &mount_point->directories[directory->first_child + index],
+                                               recursive_path);
     }
 
     kan_file_system_path_container_reset_length (recursive_path, length_backup);
@@ -1153,7 +1107,8 @@ static void inform_mount_point_read_only_pack_added (struct volume_t *volume,
         {
             struct kan_file_system_path_container_t recursive_path;
             virtual_directory_form_path (owner_directory, &recursive_path);
-            inform_read_only_pack_directory_added (file_system_watcher, &mount_point->root_directory, &recursive_path);
+            inform_read_only_pack_directory_added (file_system_watcher, mount_point, &mount_point->directories[0u],
+                                                   &recursive_path);
         }
 
         file_system_watcher = file_system_watcher->next;
@@ -1161,15 +1116,17 @@ static void inform_mount_point_read_only_pack_added (struct volume_t *volume,
 }
 
 static void inform_read_only_pack_directory_removed (struct file_system_watcher_t *watcher,
-                                                     struct read_only_pack_directory_t *directory,
+                                                     struct mount_point_read_only_pack_t *mount_point,
+                                                     const struct read_only_pack_directory_t *directory,
                                                      struct kan_file_system_path_container_t *recursive_path)
 {
     const kan_instance_size_t length_backup = recursive_path->length;
-    kan_file_system_path_container_append (recursive_path, directory->name);
-    struct read_only_pack_file_node_t *file_node = (struct read_only_pack_file_node_t *) directory->files.items.first;
+    kan_file_system_path_container_append (recursive_path,
+                                           read_only_pack_directory_get_name (mount_point, directory));
 
-    while (file_node)
+    for (uint32_t index = 0u; index < directory->files_count; ++index)
     {
+        const struct read_only_pack_file_t *file = &mount_point->files[directory->first_file + index];
         KAN_ATOMIC_INT_SCOPED_LOCK (&watcher->event_queue_lock)
         struct file_system_watcher_event_node_t *event =
             (struct file_system_watcher_event_node_t *) kan_event_queue_submit_begin (&watcher->event_queue);
@@ -1179,18 +1136,17 @@ static void inform_read_only_pack_directory_removed (struct file_system_watcher_
             event->event.event_type = KAN_VIRTUAL_FILE_SYSTEM_EVENT_TYPE_REMOVED;
             event->event.entry_type = KAN_VIRTUAL_FILE_SYSTEM_ENTRY_TYPE_FILE;
             kan_file_system_path_container_copy (&event->event.path_container, recursive_path);
-            append_read_only_pack_file_name (&event->event.path_container, file_node);
+            kan_file_system_path_container_append (&event->event.path_container,
+                                                   mount_point->strings + file->name_offset);
             kan_event_queue_submit_end (&watcher->event_queue, &file_system_watcher_event_node_allocate ()->node);
         }
-
-        file_node = (struct read_only_pack_file_node_t *) file_node->node.list_node.next;
     }
 
-    struct read_only_pack_directory_t *child_directory = directory->first_child;
-    while (child_directory)
+    for (uint32_t index = 0u; index < directory->children_count; ++index)
     {
-        inform_read_only_pack_directory_removed (watcher, child_directory, recursive_path);
-        child_directory = child_directory->next_on_level;
+        inform_read_only_pack_directory_removed (watcher, mount_point,
+                                                 &mount_point->directories[directory->first_child + index],
+                                                 recursive_path);
     }
 
     KAN_ATOMIC_INT_SCOPED_LOCK (&watcher->event_queue_lock)
@@ -1221,7 +1177,7 @@ static void inform_mount_point_read_only_pack_removed (struct volume_t *volume,
         {
             struct kan_file_system_path_container_t recursive_path;
             virtual_directory_form_path (owner_directory, &recursive_path);
-            inform_read_only_pack_directory_removed (file_system_watcher, &mount_point->root_directory,
+            inform_read_only_pack_directory_removed (file_system_watcher, mount_point, &mount_point->directories[0u],
                                                      &recursive_path);
         }
 
@@ -1347,207 +1303,225 @@ static inline void mount_point_real_fill_path (struct mount_point_real_t *mount_
     }
 }
 
-static struct read_only_pack_directory_t *read_only_pack_directory_find_child (
-    struct read_only_pack_directory_t *directory, const char *name_begin, const char *name_end)
+struct read_only_pack_registry_layout_t
 {
-    const kan_instance_size_t length = (kan_instance_size_t) (name_end - name_begin);
-    struct read_only_pack_directory_t *child = directory->first_child;
+    kan_instance_size_t directories_offset;
+    kan_instance_size_t files_offset;
+    kan_instance_size_t lookup_offset;
+    kan_instance_size_t strings_offset;
+    kan_instance_size_t total_size;
+};
 
-    while (child)
-    {
-        if (strncmp (child->name, name_begin, length) == 0 && child->name[length] == '\0')
-        {
-            return child;
-        }
+static inline struct read_only_pack_registry_layout_t read_only_pack_registry_calculate_layout (
+    const struct read_only_pack_registry_header_t *header)
+{
+    struct read_only_pack_registry_layout_t layout;
+    layout.directories_offset = 0u;
+    layout.files_offset = (kan_instance_size_t) kan_apply_alignment (
+        layout.directories_offset + header->directories_count * sizeof (struct read_only_pack_directory_t),
+        alignof (struct read_only_pack_file_t));
+    layout.lookup_offset = (kan_instance_size_t) kan_apply_alignment (
+        layout.files_offset + header->files_count * sizeof (struct read_only_pack_file_t),
+        alignof (struct read_only_pack_lookup_t));
+    layout.strings_offset =
+        layout.lookup_offset + header->lookup_count * (kan_instance_size_t) sizeof (struct read_only_pack_lookup_t);
+    layout.total_size = layout.strings_offset + header->strings_size;
+    return layout;
+}
 
-        child = child->next_on_level;
-    }
+#define READ_ONLY_PACK_REGISTRY_ALIGNMENT                                                                              \
+    KAN_MAX (alignof (struct read_only_pack_directory_t),                                                              \
+             KAN_MAX (alignof (struct read_only_pack_file_t), alignof (struct read_only_pack_lookup_t)))
 
-    return NULL;
-}
+static const char read_only_pack_path_separator = '/';
 
-static inline enum follow_path_result_t follow_read_only_pack_directory_path (
-    struct read_only_pack_directory_t **current_read_only_pack_directory,
-    const char **current_path_iterator,
-    const char **current_part_begin,
-    const char **current_part_end)
+/// \brief Calculates hash of the path inside read only pack.
+/// \details Path is hashed part by part with single separator between parts, so redundant separators in user paths
+///          do not affect the hash and it always matches the hash of normalized path stored in registry.
+static inline bool read_only_pack_path_hash (const char *path, kan_hash_t *output)
 {
+    const char *path_iterator = path;
+    const char *part_begin;
+    const char *part_end;
+    bool first = true;
+
     while (true)
     {
-        switch (path_extract_next_part (current_path_iterator, current_part_begin, current_part_end))
-        {
-        case PATH_EXTRACTION_RESULT_HAS_MORE_COMPONENTS_AFTER:
-        {
-            struct read_only_pack_directory_t *next_read_only_pack_directory = read_only_pack_directory_find_child (
-                *current_read_only_pack_directory, *current_part_begin, *current_part_end);
-
-            if (!next_read_only_pack_directory)
-            {
-                return FOLLOW_PATH_RESULT_STOPPED;
-            }
+        const enum path_extraction_result_t extraction =
+            path_extract_next_part (&path_iterator, &part_begin, &part_end);
 
-            *current_read_only_pack_directory = next_read_only_pack_directory;
-            break;
+        if (extraction == PATH_EXTRACTION_RESULT_FAILED)
+        {
+            return false;
         }
 
-        case PATH_EXTRACTION_RESULT_LAST_COMPONENT:
+        if (first)
         {
-            struct read_only_pack_directory_t *next_read_only_pack_directory = read_only_pack_directory_find_child (
-                *current_read_only_pack_directory, *current_part_begin, *current_part_end);
-
-            if (!next_read_only_pack_directory)
-            {
-                return FOLLOW_PATH_RESULT_STOPPED;
-            }
-
-            *current_read_only_pack_directory = next_read_only_pack_directory;
-            return FOLLOW_PATH_RESULT_REACHED_END;
+            *output = kan_char_sequence_hash (part_begin, part_end);
+            first = false;
+        }
+        else
+        {
+            *output = kan_char_sequence_hash_append (*output, &read_only_pack_path_separator,
+                                                     &read_only_pack_path_separator + 1u);
+            *output = kan_char_sequence_hash_append (*output, part_begin, part_end);
         }
 
-        case PATH_EXTRACTION_RESULT_FAILED:
-            return FOLLOW_PATH_RESULT_FAILED;
+        if (extraction == PATH_EXTRACTION_RESULT_LAST_COMPONENT)
+        {
+            return true;
         }
     }
-
-    KAN_ASSERT (false)
-    return FOLLOW_PATH_RESULT_FAILED;
 }
 
-static struct read_only_pack_file_node_t *read_only_pack_directory_find_file (
-    struct read_only_pack_directory_t *directory, const char *name_begin, const char *name_end)
+/// \brief Checks whether given user path is equal to normalized path stored in registry.
+static inline bool read_only_pack_path_equals (const char *stored_path, const char *path)
 {
-    const char *separator = read_only_pack_file_find_name_separator (name_begin, name_end);
-    const char *file_name_begin = name_begin;
-    const char *file_name_end = separator ? separator : name_end;
-    const char *extension_begin = separator ? separator + 1u : name_end;
-    const char *extension_end = name_end;
+    const char *path_iterator = path;
+    const char *part_begin;
+    const char *part_end;
 
-    const kan_instance_size_t file_name_length = (kan_instance_size_t) (file_name_end - file_name_begin);
-    const kan_instance_size_t extension_length = (kan_instance_size_t) (extension_end - extension_begin);
-    kan_hash_t hash = kan_char_sequence_hash (name_begin, name_end);
+    while (true)
+    {
+        const enum path_extraction_result_t extraction =
+            path_extract_next_part (&path_iterator, &part_begin, &part_end);
 
-    const struct kan_hash_storage_bucket_t *bucket = kan_hash_storage_query (&directory->files, hash);
-    struct read_only_pack_file_node_t *node = (struct read_only_pack_file_node_t *) bucket->first;
-    const struct read_only_pack_file_node_t *node_end =
-        (struct read_only_pack_file_node_t *) (bucket->last ? bucket->last->next : NULL);
+        if (extraction == PATH_EXTRACTION_RESULT_FAILED)
+        {
+            return false;
+        }
 
-    while (node != node_end)
-    {
-        if (node->node.hash == hash &&
-            ((file_name_length == 0u && node->name == NULL) ||
-             (file_name_length > 0u && node->name != NULL &&
-              strncmp (file_name_begin, node->name, file_name_length) == 0 && node->name[file_name_length] == '\0')) &&
-            ((extension_length == 0u && node->extension == NULL) ||
-             (extension_length > 0u && node->extension != NULL &&
-              strncmp (extension_begin, node->extension, extension_length) == 0 &&
-              node->extension[extension_length] == '\0')))
+        const kan_instance_size_t length = (kan_instance_size_t) (part_end - part_begin);
+        if (strncmp (stored_path, part_begin, length) != 0)
         {
-            return node;
+            return false;
         }
 
-        node = (struct read_only_pack_file_node_t *) node->node.list_node.next;
-    }
+        stored_path += length;
+        if (extraction == PATH_EXTRACTION_RESULT_LAST_COMPONENT)
+        {
+            return *stored_path == '\0';
+        }
 
-    return NULL;
+        if (*stored_path != read_only_pack_path_separator)
+        {
+            return false;
+        }
+
+        ++stored_path;
+    }
 }
 
-static struct read_only_pack_directory_t *read_only_pack_directory_find_or_create_child (
-    struct read_only_pack_directory_t *directory, const char *name_begin, const char *name_end)
+enum read_only_pack_lookup_result_t
+{
+    READ_ONLY_PACK_LOOKUP_RESULT_NOT_FOUND = 0u,
+    READ_ONLY_PACK_LOOKUP_RESULT_DIRECTORY,
+    READ_ONLY_PACK_LOOKUP_RESULT_FILE,
+};
+
+/// \brief Finds entry inside read only pack using hashed path probe.
+/// \details Path is expected to be relative to the pack root. Empty path points to the root directory.
+static enum read_only_pack_lookup_result_t read_only_pack_lookup (struct mount_point_read_only_pack_t *mount_point,
+                                                                  const char *path,
+                                                                  uint32_t *index_output)
 {
-    struct read_only_pack_directory_t *child = read_only_pack_directory_find_child (directory, name_begin, name_end);
-    if (child)
+    if (*path == '\0')
     {
-        return child;
+        *index_output = 0u;
+        return READ_ONLY_PACK_LOOKUP_RESULT_DIRECTORY;
     }
 
-    if (read_only_pack_directory_find_file (directory, name_begin, name_end))
+    kan_hash_t hash;
+    if (!read_only_pack_path_hash (path, &hash))
     {
-        KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
-                 "Failed to create directory for read only pack path: file with the same name already exists.")
-        return NULL;
+        return READ_ONLY_PACK_LOOKUP_RESULT_NOT_FOUND;
     }
 
-    struct read_only_pack_directory_t *new_directory =
-        kan_allocate_batched (hierarchy_allocation_group, sizeof (struct read_only_pack_directory_t));
-    read_only_pack_directory_init (new_directory);
-    new_directory->name = kan_char_sequence_intern (name_begin, name_end);
-    new_directory->next_on_level = directory->first_child;
-    directory->first_child = new_directory;
-    return new_directory;
-}
-
-static bool mount_point_read_only_pack_load_item (struct mount_point_read_only_pack_t *mount_point,
-                                                  struct read_only_pack_registry_item_t *item)
-{
-    const char *path_iterator = item->path;
-    struct read_only_pack_directory_t *current_directory = &mount_point->root_directory;
+    uint32_t low = 0u;
+    uint32_t high = mount_point->lookup_count;
 
-    while (true)
+    while (low < high)
     {
-        const char *parse_start = path_iterator;
-        const char *part_begin;
-        const char *part_end;
-
-        switch (path_extract_next_part (&path_iterator, &part_begin, &part_end))
+        const uint32_t middle = low + (high - low) / 2u;
+        if (mount_point->lookup[middle].path_hash < hash)
         {
-        case PATH_EXTRACTION_RESULT_HAS_MORE_COMPONENTS_AFTER:
-            current_directory = read_only_pack_directory_find_or_create_child (current_directory, part_begin, part_end);
-
-            if (!current_directory)
-            {
-                KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
-                         "Failed to continue follow path (inside read only pack) \"%s\" at \"%s\", child virtual "
-                         "directory cannot be created.",
-                         item->path, part_begin)
-                return false;
-            }
+            low = middle + 1u;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
 
-            break;
+    while (low < mount_point->lookup_count && mount_point->lookup[low].path_hash == hash)
+    {
+        const struct read_only_pack_lookup_t *lookup = &mount_point->lookup[low];
+        const uint32_t path_offset = lookup->is_directory ? mount_point->directories[lookup->index].path_offset :
+                                                            mount_point->files[lookup->index].path_offset;
 
-        case PATH_EXTRACTION_RESULT_LAST_COMPONENT:
+        if (read_only_pack_path_equals (mount_point->strings + path_offset, path))
         {
-            if (read_only_pack_directory_find_child (current_directory, part_begin, part_end) ||
-                read_only_pack_directory_find_file (current_directory, part_begin, part_end))
-            {
-                KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
-                         "Failed to add file inside read only pack \"%s\", file with this name already exists!",
-                         item->path)
-                return false;
-            }
+            *index_output = lookup->index;
+            return lookup->is_directory ? READ_ONLY_PACK_LOOKUP_RESULT_DIRECTORY : READ_ONLY_PACK_LOOKUP_RESULT_FILE;
+        }
 
-            const char *separator = read_only_pack_file_find_name_separator (part_begin, part_end);
-            const char *name_begin = part_begin;
-            const char *name_end = separator ? separator : part_end;
-            const char *extension_begin = separator ? separator + 1u : part_end;
-            const char *extension_end = part_end;
+        ++low;
+    }
 
-            struct read_only_pack_file_node_t *file_node = (struct read_only_pack_file_node_t *) kan_allocate_batched (
-                read_only_pack_files_allocation_group, sizeof (struct read_only_pack_file_node_t));
+    return READ_ONLY_PACK_LOOKUP_RESULT_NOT_FOUND;
+}
 
-            file_node->node.hash = kan_char_sequence_hash (part_begin, part_end);
-            file_node->name = name_begin != name_end ? kan_char_sequence_intern (name_begin, name_end) : NULL;
-            file_node->extension =
-                extension_begin != extension_end ? kan_char_sequence_intern (extension_begin, extension_end) : NULL;
+static inline bool read_only_pack_registry_range_is_valid (uint32_t first, uint32_t count, uint32_t total)
+{
+    return count <= total && first <= total - count;
+}
 
-            file_node->offset = item->offset;
-            file_node->size = item->size;
+/// \brief Checks that all offsets and indices inside loaded registry point inside registry data.
+/// \details Registry is used in place without any parsing, so it must be validated once on mount in order to make
+///          sure that malformed pack cannot cause out of bounds access later. Children of every directory must be
+///          placed after it, which is guaranteed by depth sorting and protects hierarchy traversal from cycles.
+static bool read_only_pack_registry_validate (const struct read_only_pack_registry_header_t *header,
+                                              const struct read_only_pack_registry_layout_t *layout,
+                                              const void *registry_data)
+{
+    const struct read_only_pack_directory_t *directories =
+        (const struct read_only_pack_directory_t *) ((const uint8_t *) registry_data + layout->directories_offset);
+    const struct read_only_pack_file_t *files =
+        (const struct read_only_pack_file_t *) ((const uint8_t *) registry_data + layout->files_offset);
+    const struct read_only_pack_lookup_t *lookup =
+        (const struct read_only_pack_lookup_t *) ((const uint8_t *) registry_data + layout->lookup_offset);
 
-            kan_hash_storage_update_bucket_count_default (&current_directory->files,
-                                                          KAN_VIRTUAL_FILE_SYSTEM_ROPACK_DIRECTORY_INITIAL_ITEMS);
-            kan_hash_storage_add (&current_directory->files, &file_node->node);
-            return true;
+    for (uint32_t index = 0u; index < header->directories_count; ++index)
+    {
+        const struct read_only_pack_directory_t *directory = &directories[index];
+        if (directory->path_offset >= header->strings_size || directory->name_offset >= header->strings_size ||
+            !read_only_pack_registry_range_is_valid (directory->first_child, directory->children_count,
+                                                     header->directories_count) ||
+            (directory->children_count > 0u && directory->first_child <= index) ||
+            !read_only_pack_registry_range_is_valid (directory->first_file, directory->files_count,
+                                                     header->files_count))
+        {
+            return false;
         }
+    }
 
-        case PATH_EXTRACTION_RESULT_FAILED:
-            KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
-                     "Failed to continue parsing path (inside read only pack) \"%s\" at \"%s\".", item->path,
-                     parse_start)
+    for (uint32_t index = 0u; index < header->files_count; ++index)
+    {
+        if (files[index].path_offset >= header->strings_size || files[index].name_offset >= header->strings_size)
+        {
             return false;
         }
     }
 
-    KAN_ASSERT (false)
-    return false;
+    for (uint32_t index = 0u; index < header->lookup_count; ++index)
+    {
+        if (lookup[index].index >= (lookup[index].is_directory ? header->directories_count : header->files_count))
+        {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 static bool mount_read_only_pack (struct volume_t *volume,
@@ -1565,6 +1539,7 @@ static bool mount_read_only_pack (struct volume_t *volume,
     kan_file_size_t registry_offset;
     if (stream->operations->read (stream, sizeof (kan_file_size_t), &registry_offset) != sizeof (kan_file_size_t))
     {
+        stream->operations->close (stream);
         KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to read registry offset of read only pack at \"%s\".",
                  pack_real_path)
         return false;
@@ -1574,65 +1549,90 @@ static bool mount_read_only_pack (struct volume_t *volume,
             stream, KAN_STREAM_SEEK_CURRENT,
             ((kan_file_offset_t) registry_offset) - (kan_file_offset_t) sizeof (kan_file_size_t)))
     {
+        stream->operations->close (stream);
         KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to seek to registry of read only pack at \"%s\".",
                  pack_real_path)
         return false;
     }
 
-    struct read_only_pack_registry_t registry;
-    read_only_pack_registry_init (&registry);
-
-    kan_serialization_binary_reader_t reader = kan_serialization_binary_reader_create (
-        stream, &registry, KAN_STATIC_INTERNED_ID_GET (read_only_pack_registry_t), serialization_script_storage,
-        KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t),
-        read_only_pack_operation_allocation_group);
+    struct read_only_pack_registry_header_t header;
+    if (stream->operations->read (stream, sizeof (header), &header) != sizeof (header))
+    {
+        stream->operations->close (stream);
+        KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to read registry header of read only pack at \"%s\".",
+                 pack_real_path)
+        return false;
+    }
 
-    enum kan_serialization_state_t state = KAN_SERIALIZATION_IN_PROGRESS;
-    while (state != KAN_SERIALIZATION_FINISHED)
+    if (header.magic != READ_ONLY_PACK_REGISTRY_MAGIC || header.version != READ_ONLY_PACK_REGISTRY_VERSION)
     {
-        switch ((state = kan_serialization_binary_reader_step (reader)))
-        {
-        case KAN_SERIALIZATION_IN_PROGRESS:
-        case KAN_SERIALIZATION_FINISHED:
-            break;
+        stream->operations->close (stream);
+        KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
+                 "Read only pack at \"%s\" has unsupported registry format, it should be rebuilt.", pack_real_path)
+        return false;
+    }
 
-        case KAN_SERIALIZATION_FAILED:
-            kan_serialization_binary_reader_destroy (reader);
-            read_only_pack_registry_shutdown (&registry);
-            stream->operations->close (stream);
-            KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to read registry of read only pack at \"%s\".",
-                     pack_real_path)
-            return false;
-        }
+    if (header.directories_count == 0u || header.strings_size == 0u)
+    {
+        stream->operations->close (stream);
+        KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Read only pack at \"%s\" has malformed registry.",
+                 pack_real_path)
+        return false;
     }
 
-    kan_serialization_binary_reader_destroy (reader);
+    // Registry is read in one block and used in place, so mount does constant amount of allocations.
+    const struct read_only_pack_registry_layout_t layout = read_only_pack_registry_calculate_layout (&header);
+    void *registry_data = kan_allocate_general (read_only_pack_registry_allocation_group, layout.total_size,
+                                                READ_ONLY_PACK_REGISTRY_ALIGNMENT);
+
+    const bool registry_read =
+        stream->operations->read (stream, layout.total_size, registry_data) == (kan_file_size_t) layout.total_size;
     stream->operations->close (stream);
 
+    if (!registry_read || ((const char *) registry_data)[layout.total_size - 1u] != '\0')
+    {
+        kan_free_general (read_only_pack_registry_allocation_group, registry_data, layout.total_size);
+        KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to read registry of read only pack at \"%s\".",
+                 pack_real_path)
+        return false;
+    }
+
+    if (!read_only_pack_registry_validate (&header, &layout, registry_data))
+    {
+        kan_free_general (read_only_pack_registry_allocation_group, registry_data, layout.total_size);
+        KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Read only pack at \"%s\" has malformed registry.",
+                 pack_real_path)
+        return false;
+    }
+
     struct mount_point_read_only_pack_t *mount_point =
         kan_allocate_batched (hierarchy_allocation_group, sizeof (struct mount_point_read_only_pack_t));
+    mount_point->name = pack_name;
     mount_point->next = owner_directory->first_mount_point_read_only_pack;
     mount_point->previous = NULL;
-    owner_directory->first_mount_point_read_only_pack = mount_point;
 
+    if (owner_directory->first_mount_point_read_only_pack)
+    {
+        owner_directory->first_mount_point_read_only_pack->previous = mount_point;
+    }
+
+    owner_directory->first_mount_point_read_only_pack = mount_point;
     const kan_instance_size_t real_path_length = (kan_instance_size_t) strlen (pack_real_path);
     mount_point->real_file_path =
         kan_allocate_general (hierarchy_allocation_group, real_path_length + 1u, alignof (char));
     memcpy (mount_point->real_file_path, pack_real_path, real_path_length + 1u);
-    read_only_pack_directory_init (&mount_point->root_directory);
-    mount_point->root_directory.name = pack_name;
-    bool result = true;
 
-    for (kan_loop_size_t index = 0u; index < registry.items.size; ++index)
-    {
-        struct read_only_pack_registry_item_t *item =
-            &((struct read_only_pack_registry_item_t *) registry.items.data)[index];
-        result &= mount_point_read_only_pack_load_item (mount_point, item);
-    }
+    mount_point->registry_data = registry_data;
+    mount_point->registry_size = layout.total_size;
+    mount_point->directories =
+        (const struct read_only_pack_directory_t *) ((uint8_t *) registry_data + layout.directories_offset);
+    mount_point->files = (const struct read_only_pack_file_t *) ((uint8_t *) registry_data + layout.files_offset);
+    mount_point->lookup = (const struct read_only_pack_lookup_t *) ((uint8_t *) registry_data + layout.lookup_offset);
+    mount_point->lookup_count = header.lookup_count;
+    mount_point->strings = (const char *) registry_data + layout.strings_offset;
 
-    read_only_pack_registry_shutdown (&registry);
     inform_mount_point_read_only_pack_added (volume, owner_directory, mount_point);
-    return result;
+    return true;
 }
 
 kan_virtual_file_system_volume_t kan_virtual_file_system_volume_create (void)
@@ -1923,34 +1923,25 @@ struct kan_virtual_file_system_directory_iterator_t kan_virtual_file_system_dire
 
         if (mount_point_read_only_pack)
         {
-            struct read_only_pack_directory_t *read_only_pack_directory = &mount_point_read_only_pack->root_directory;
-            switch (follow_read_only_pack_directory_path (&read_only_pack_directory, &path_iterator, &part_begin,
-                                                          &part_end))
+            uint32_t directory_index;
+            if (read_only_pack_lookup (mount_point_read_only_pack, path_iterator, &directory_index) ==
+                READ_ONLY_PACK_LOOKUP_RESULT_DIRECTORY)
             {
-            case FOLLOW_PATH_RESULT_REACHED_END:
                 iterator.type = DIRECTORY_ITERATOR_TYPE_READ_ONLY_PACK_DIRECTORY;
                 iterator.read_only_pack_suffix = (struct read_only_pack_directory_iterator_suffix_t) {
-                    .directory = read_only_pack_directory,
-                    .file_name_buffer =
-                        kan_allocate_general (read_only_pack_directory_iterator_allocation_group,
-                                              KAN_VIRTUAL_FILE_SYSTEM_ROPACK_MAX_FILE_NAME_LENGTH, alignof (char)),
+                    .mount_point = mount_point_read_only_pack,
+                    .directory = &mount_point_read_only_pack->directories[directory_index],
                     .stage = READ_ONLY_PACK_DIRECTORY_ITERATOR_STAGE_CHILDREN,
-                    .next_directory = read_only_pack_directory->first_child,
+                    .next_index = 0u,
                 };
-                break;
-
-            case FOLLOW_PATH_RESULT_STOPPED:
+            }
+            else
+            {
                 KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
-                         "Failed to create virtual file system iterator for virtual path \"%s\": unable to follow path "
-                         "since \"%s\".",
-                         directory_path, part_begin)
-                iterator.type = DIRECTORY_ITERATOR_TYPE_INVALID;
-
-            case FOLLOW_PATH_RESULT_FAILED:
-                KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to continue parsing path \"%s\" at \"%s\".",
-                         directory_path, part_begin)
+                         "Failed to create virtual file system iterator for virtual path \"%s\": there is no directory "
+                         "\"%s\" inside read only pack.",
+                         directory_path, path_iterator)
                 iterator.type = DIRECTORY_ITERATOR_TYPE_INVALID;
-                break;
             }
 
             break;
@@ -2021,7 +2012,7 @@ const char *kan_virtual_file_system_directory_iterator_advance (
                 if (iterator_data->virtual_directory_suffix.next_mount_point_read_only_pack)
                 {
                     const char *name =
-                        iterator_data->virtual_directory_suffix.next_mount_point_read_only_pack->root_directory.name;
+                        iterator_data->virtual_directory_suffix.next_mount_point_read_only_pack->name;
                     iterator_data->virtual_directory_suffix.next_mount_point_read_only_pack =
                         iterator_data->virtual_directory_suffix.next_mount_point_read_only_pack->next;
                     return name;
@@ -2037,66 +2028,32 @@ const char *kan_virtual_file_system_directory_iterator_advance (
         return kan_file_system_directory_iterator_advance (iterator_data->real_file_system_iterator);
 
     case DIRECTORY_ITERATOR_TYPE_READ_ONLY_PACK_DIRECTORY:
+    {
+        struct read_only_pack_directory_iterator_suffix_t *suffix = &iterator_data->read_only_pack_suffix;
         while (true)
         {
-            switch (iterator_data->read_only_pack_suffix.stage)
+            switch (suffix->stage)
             {
             case READ_ONLY_PACK_DIRECTORY_ITERATOR_STAGE_CHILDREN:
-                if (iterator_data->read_only_pack_suffix.next_directory)
+                if (suffix->next_index < suffix->directory->children_count)
                 {
-                    const char *name = iterator_data->read_only_pack_suffix.next_directory->name;
-                    iterator_data->read_only_pack_suffix.next_directory =
-                        iterator_data->read_only_pack_suffix.next_directory->next_on_level;
-                    return name;
+                    const struct read_only_pack_directory_t *child =
+                        &suffix->mount_point->directories[suffix->directory->first_child + suffix->next_index];
+                    ++suffix->next_index;
+                    return suffix->mount_point->strings + child->name_offset;
                 }
 
-                iterator_data->read_only_pack_suffix.stage = READ_ONLY_PACK_DIRECTORY_ITERATOR_STAGE_FILES;
-                iterator_data->read_only_pack_suffix.next_file =
-                    (struct read_only_pack_file_node_t *)
-                        iterator_data->read_only_pack_suffix.directory->files.items.first;
+                suffix->stage = READ_ONLY_PACK_DIRECTORY_ITERATOR_STAGE_FILES;
+                suffix->next_index = 0u;
                 break;
 
             case READ_ONLY_PACK_DIRECTORY_ITERATOR_STAGE_FILES:
-                if (iterator_data->read_only_pack_suffix.next_file)
+                if (suffix->next_index < suffix->directory->files_count)
                 {
-                    const kan_instance_size_t name_length =
-                        iterator_data->read_only_pack_suffix.next_file->name ?
-                            (kan_instance_size_t) strlen (iterator_data->read_only_pack_suffix.next_file->name) :
-                            0u;
-
-                    const kan_instance_size_t extension_length =
-                        iterator_data->read_only_pack_suffix.next_file->extension ?
-                            (kan_instance_size_t) strlen (iterator_data->read_only_pack_suffix.next_file->extension) :
-                            0u;
-
-                    if (name_length > 0u)
-                    {
-                        memcpy (iterator_data->read_only_pack_suffix.file_name_buffer,
-                                iterator_data->read_only_pack_suffix.next_file->name,
-                                KAN_MIN (name_length, KAN_VIRTUAL_FILE_SYSTEM_ROPACK_MAX_FILE_NAME_LENGTH - 1u));
-                    }
-
-                    if (name_length < KAN_VIRTUAL_FILE_SYSTEM_ROPACK_MAX_FILE_NAME_LENGTH && extension_length > 0u)
-                    {
-                        iterator_data->read_only_pack_suffix.file_name_buffer[name_length] = '.';
-                        if (name_length + 1u < KAN_VIRTUAL_FILE_SYSTEM_ROPACK_MAX_FILE_NAME_LENGTH)
-                        {
-                            memcpy (iterator_data->read_only_pack_suffix.file_name_buffer + name_length + 1u,
-                                    iterator_data->read_only_pack_suffix.next_file->extension,
-                                    KAN_MIN (extension_length,
-                                             KAN_VIRTUAL_FILE_SYSTEM_ROPACK_MAX_FILE_NAME_LENGTH - name_length - 1u));
-                        }
-                    }
-
-                    iterator_data->read_only_pack_suffix
-                        .file_name_buffer[KAN_MIN (name_length + 1u + extension_length,
-                                                   KAN_VIRTUAL_FILE_SYSTEM_ROPACK_MAX_FILE_NAME_LENGTH - 1u)] = '\0';
-
-                    iterator_data->read_only_pack_suffix.next_file =
-                        (struct read_only_pack_file_node_t *)
-                            iterator_data->read_only_pack_suffix.next_file->node.list_node.next;
-
-                    return iterator_data->read_only_pack_suffix.file_name_buffer;
+                    const struct read_only_pack_file_t *file =
+                        &suffix->mount_point->files[suffix->directory->first_file + suffix->next_index];
+                    ++suffix->next_index;
+                    return suffix->mount_point->strings + file->name_offset;
                 }
 
                 return NULL;
@@ -2105,6 +2062,7 @@ const char *kan_virtual_file_system_directory_iterator_advance (
 
         break;
     }
+    }
 
     KAN_ASSERT (false)
     return NULL;
@@ -2117,17 +2075,13 @@ void kan_virtual_file_system_directory_iterator_destroy (struct kan_virtual_file
     {
     case DIRECTORY_ITERATOR_TYPE_INVALID:
     case DIRECTORY_ITERATOR_TYPE_VIRTUAL_DIRECTORY:
+    case DIRECTORY_ITERATOR_TYPE_READ_ONLY_PACK_DIRECTORY:
         break;
 
     case DIRECTORY_ITERATOR_TYPE_REAL_DIRECTORY:
         kan_file_system_directory_iterator_destroy (iterator_data->real_file_system_iterator);
         break;
 
-    case DIRECTORY_ITERATOR_TYPE_READ_ONLY_PACK_DIRECTORY:
-        kan_free_general (read_only_pack_directory_iterator_allocation_group,
-                          iterator_data->read_only_pack_suffix.file_name_buffer,
-                          KAN_VIRTUAL_FILE_SYSTEM_ROPACK_MAX_FILE_NAME_LENGTH);
-        break;
     }
 }
 
@@ -2188,48 +2142,28 @@ bool kan_virtual_file_system_query_entry (kan_virtual_file_system_volume_t volum
 
         if (mount_point_read_only_pack)
         {
-            struct read_only_pack_directory_t *read_only_pack_directory = &mount_point_read_only_pack->root_directory;
-            if (!*path_iterator)
+            uint32_t index;
+            switch (read_only_pack_lookup (mount_point_read_only_pack, path_iterator, &index))
             {
+            case READ_ONLY_PACK_LOOKUP_RESULT_NOT_FOUND:
+                KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
+                         "Failed to query status for virtual path \"%s\": there is no entry \"%s\" inside read only "
+                         "pack.",
+                         path, path_iterator)
+                return false;
+
+            case READ_ONLY_PACK_LOOKUP_RESULT_DIRECTORY:
                 status->type = KAN_VIRTUAL_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY;
                 return true;
-            }
 
-            switch (follow_read_only_pack_directory_path (&read_only_pack_directory, &path_iterator, &part_begin,
-                                                          &part_end))
-            {
-            case FOLLOW_PATH_RESULT_REACHED_END:
-                status->type = KAN_VIRTUAL_FILE_SYSTEM_ENTRY_TYPE_DIRECTORY;
+            case READ_ONLY_PACK_LOOKUP_RESULT_FILE:
+                status->type = KAN_VIRTUAL_FILE_SYSTEM_ENTRY_TYPE_FILE;
+                status->size = mount_point_read_only_pack->files[index].size;
+                // We treat read only pack files as never modified.
+                status->last_modification_time_ns = 0u;
+                status->read_only = true;
                 return true;
-
-            case FOLLOW_PATH_RESULT_STOPPED:
-                if (*path_iterator == '\0')
-                {
-                    struct read_only_pack_file_node_t *file_node =
-                        read_only_pack_directory_find_file (read_only_pack_directory, part_begin, part_end);
-
-                    if (file_node)
-                    {
-                        status->type = KAN_VIRTUAL_FILE_SYSTEM_ENTRY_TYPE_FILE;
-                        status->size = file_node->size;
-                        // We treat read only pack files as never modified.
-                        status->last_modification_time_ns = 0u;
-                        status->read_only = true;
-                        return 0u;
-                    }
-                }
-
-                KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
-                         "Failed to query status for virtual path \"%s\": unable to follow path "
-                         "since \"%s\".",
-                         path, part_begin)
-                return false;
-
-            case FOLLOW_PATH_RESULT_FAILED:
-                KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to continue parsing path \"%s\" at \"%s\".", path,
-                         part_begin)
-                return false;
-            }
+            }
 
             break;
         }
@@ -2281,34 +2215,9 @@ bool kan_virtual_file_system_check_existence (kan_virtual_file_system_volume_t v
 
         if (mount_point_read_only_pack)
         {
-            struct read_only_pack_directory_t *read_only_pack_directory = &mount_point_read_only_pack->root_directory;
-            switch (follow_read_only_pack_directory_path (&read_only_pack_directory, &path_iterator, &part_begin,
-                                                          &part_end))
-            {
-            case FOLLOW_PATH_RESULT_REACHED_END:
-                return true;
-
-            case FOLLOW_PATH_RESULT_STOPPED:
-                if (*path_iterator == '\0')
-                {
-                    struct read_only_pack_file_node_t *file_node =
-                        read_only_pack_directory_find_file (read_only_pack_directory, part_begin, part_end);
-
-                    if (file_node)
-                    {
-                        return true;
-                    }
-                }
-
-                return false;
-
-            case FOLLOW_PATH_RESULT_FAILED:
-                KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to continue parsing path \"%s\" at \"%s\".", path,
-                         part_begin)
-                return false;
-            }
-
-            break;
+            uint32_t index;
+            return read_only_pack_lookup (mount_point_read_only_pack, path_iterator, &index) !=
+                   READ_ONLY_PACK_LOOKUP_RESULT_NOT_FOUND;
         }
 
         return false;
@@ -2652,57 +2561,45 @@ struct kan_stream_t *kan_virtual_file_stream_open_for_read (kan_virtual_file_sys
 
         if (mount_point_read_only_pack)
         {
-            struct read_only_pack_directory_t *read_only_pack_directory = &mount_point_read_only_pack->root_directory;
-            switch (follow_read_only_pack_directory_path (&read_only_pack_directory, &path_iterator, &part_begin,
-                                                          &part_end))
+            uint32_t index;
+            switch (read_only_pack_lookup (mount_point_read_only_pack, path_iterator, &index))
             {
-            case FOLLOW_PATH_RESULT_REACHED_END:
+            case READ_ONLY_PACK_LOOKUP_RESULT_NOT_FOUND:
+                KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to open file for read \"%s\": does not exists.",
+                         path)
+                return NULL;
+
+            case READ_ONLY_PACK_LOOKUP_RESULT_DIRECTORY:
                 KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to open file for read \"%s\": it is a directory.",
                          path)
                 return NULL;
 
-            case FOLLOW_PATH_RESULT_STOPPED:
-                if (*path_iterator == '\0')
-                {
-                    struct read_only_pack_file_node_t *file_node =
-                        read_only_pack_directory_find_file (read_only_pack_directory, part_begin, part_end);
+            case READ_ONLY_PACK_LOOKUP_RESULT_FILE:
+            {
+                struct kan_stream_t *real_stream =
+                    kan_direct_file_stream_open_for_read (mount_point_read_only_pack->real_file_path, true);
 
-                    if (file_node)
-                    {
-                        struct kan_stream_t *real_stream =
-                            kan_direct_file_stream_open_for_read (mount_point_read_only_pack->real_file_path, true);
-
-                        if (!real_stream)
-                        {
-                            KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
-                                     "Failed to open file for read \"%s\": failed to open read only pack \"%s\".", path,
-                                     mount_point_read_only_pack->real_file_path)
-                            return NULL;
-                        }
-
-                        struct read_only_pack_file_read_stream_t *stream =
-                            (struct read_only_pack_file_read_stream_t *) kan_allocate_batched (
-                                read_only_pack_operation_allocation_group,
-                                sizeof (struct read_only_pack_file_read_stream_t));
-
-                        stream->stream.operations = &read_only_pack_file_read_operations;
-                        stream->base_stream = real_stream;
-                        stream->offset = file_node->offset;
-                        stream->size = file_node->size;
-                        stream->position = 0u;
-                        read_only_pack_file_seek (&stream->stream, KAN_STREAM_SEEK_START, 0);
-                        return &stream->stream;
-                    }
+                if (!real_stream)
+                {
+                    KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
+                             "Failed to open file for read \"%s\": failed to open read only pack \"%s\".", path,
+                             mount_point_read_only_pack->real_file_path)
+                    return NULL;
                 }
 
-                KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to open file for read \"%s\": does not exists.",
-                         path)
-                return NULL;
-
-            case FOLLOW_PATH_RESULT_FAILED:
-                KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to continue parsing path \"%s\" at \"%s\".", path,
-                         part_begin)
-                return NULL;
+                const struct read_only_pack_file_t *file = &mount_point_read_only_pack->files[index];
+                struct read_only_pack_file_read_stream_t *stream =
+                    (struct read_only_pack_file_read_stream_t *) kan_allocate_batched (
+                        read_only_pack_operation_allocation_group, sizeof (struct read_only_pack_file_read_stream_t));
+
+                stream->stream.operations = &read_only_pack_file_read_operations;
+                stream->base_stream = real_stream;
+                stream->offset = file->offset;
+                stream->size = file->size;
+                stream->position = 0u;
+                read_only_pack_file_seek (&stream->stream, KAN_STREAM_SEEK_START, 0);
+                return &stream->stream;
+            }
             }
 
             break;
@@ -2722,6 +2619,84 @@ struct kan_stream_t *kan_virtual_file_stream_open_for_read (kan_virtual_file_sys
     return NULL;
 }
 
+kan_file_system_async_read_t kan_virtual_file_system_read_async (
+    kan_virtual_file_system_volume_t volume, const struct kan_file_system_async_read_request_t *request)
+{
+    struct volume_t *volume_data = KAN_HANDLE_GET (volume);
+    const char *path_iterator = request->path;
+    struct virtual_directory_t *current_directory = &volume_data->root_directory;
+    const char *part_begin = "silence_not_initialized_warnings";
+    const char *part_end;
+
+    switch (follow_virtual_directory_path (&current_directory, &path_iterator, &part_begin, &part_end))
+    {
+    case FOLLOW_PATH_RESULT_REACHED_END:
+        KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to submit async read \"%s\": it is a directory.",
+                 request->path)
+        return KAN_HANDLE_SET_INVALID (kan_file_system_async_read_t);
+
+    case FOLLOW_PATH_RESULT_STOPPED:
+    {
+        struct mount_point_real_t *mount_point_real =
+            virtual_directory_find_mount_point_real_by_raw_name (current_directory, part_begin, part_end);
+
+        if (mount_point_real)
+        {
+            struct kan_file_system_path_container_t path_container;
+            mount_point_real_fill_path (mount_point_real, path_iterator, &path_container);
+
+            struct kan_file_system_async_read_request_t real_request = *request;
+            real_request.path = path_container.path;
+            return kan_file_system_async_read_submit (&real_request);
+        }
+
+        struct mount_point_read_only_pack_t *mount_point_read_only_pack =
+            virtual_directory_find_mount_point_read_only_pack_by_raw_name (current_directory, part_begin, part_end);
+
+        if (mount_point_read_only_pack)
+        {
+            uint32_t index;
+            switch (read_only_pack_lookup (mount_point_read_only_pack, path_iterator, &index))
+            {
+            case READ_ONLY_PACK_LOOKUP_RESULT_NOT_FOUND:
+                KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to submit async read \"%s\": does not exists.",
+                         request->path)
+                return KAN_HANDLE_SET_INVALID (kan_file_system_async_read_t);
+
+            case READ_ONLY_PACK_LOOKUP_RESULT_DIRECTORY:
+                KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to submit async read \"%s\": it is a directory.",
+                         request->path)
+                return KAN_HANDLE_SET_INVALID (kan_file_system_async_read_t);
+
+            case READ_ONLY_PACK_LOOKUP_RESULT_FILE:
+            {
+                const struct read_only_pack_file_t *file = &mount_point_read_only_pack->files[index];
+                struct kan_file_system_async_read_request_t pack_request = *request;
+                pack_request.path = mount_point_read_only_pack->real_file_path;
+                pack_request.offset = file->offset + KAN_MIN (request->offset, file->size);
+                pack_request.size = KAN_MIN (request->size, file->size + file->offset - pack_request.offset);
+                return kan_file_system_async_read_submit (&pack_request);
+            }
+            }
+
+            break;
+        }
+
+        KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to submit async read \"%s\": does not exists.",
+                 request->path)
+        return KAN_HANDLE_SET_INVALID (kan_file_system_async_read_t);
+    }
+
+    case FOLLOW_PATH_RESULT_FAILED:
+        KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to continue parsing path \"%s\" at \"%s\".",
+                 request->path, part_begin)
+        return KAN_HANDLE_SET_INVALID (kan_file_system_async_read_t);
+    }
+
+    KAN_ASSERT (false)
+    return KAN_HANDLE_SET_INVALID (kan_file_system_async_read_t);
+}
+
 struct kan_stream_t *kan_virtual_file_stream_open_for_write (kan_virtual_file_system_volume_t volume, const char *path)
 {
     struct volume_t *volume_data = KAN_HANDLE_GET (volume);
@@ -2924,6 +2899,32 @@ bool kan_virtual_file_system_read_only_pack_builder_begin (kan_virtual_file_syst
 static struct read_only_pack_registry_item_t *read_only_pack_builder_add_item (struct read_only_pack_builder_t *builder,
                                                                                const char *path_in_pack)
 {
+    // Paths are normalized on addition, so registry always has single separator between path parts.
+    kan_instance_size_t path_length = 0u;
+    const char *path_iterator = path_in_pack;
+    const char *part_begin;
+    const char *part_end;
+    enum path_extraction_result_t extraction;
+
+    do
+    {
+        extraction = path_extract_next_part (&path_iterator, &part_begin, &part_end);
+        if (extraction == PATH_EXTRACTION_RESULT_FAILED)
+        {
+            break;
+        }
+
+        path_length += (kan_instance_size_t) (part_end - part_begin) + (path_length > 0u ? 1u : 0u);
+
+    } while (extraction == PATH_EXTRACTION_RESULT_HAS_MORE_COMPONENTS_AFTER);
+
+    if (path_length == 0u)
+    {
+        KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Unable to add \"%s\" to read only pack: path is empty.",
+                 path_in_pack)
+        return NULL;
+    }
+
     struct read_only_pack_registry_item_t *item =
         (struct read_only_pack_registry_item_t *) kan_dynamic_array_add_last (&builder->registry.items);
 
@@ -2934,10 +2935,25 @@ static struct read_only_pack_registry_item_t *read_only_pack_builder_add_item (s
         KAN_ASSERT (item)
     }
 
-    const kan_instance_size_t path_length = (kan_instance_size_t) strlen (path_in_pack);
     item->path = kan_allocate_general (read_only_pack_operation_allocation_group, path_length + 1u, alignof (char));
-    memcpy (item->path, path_in_pack, path_length + 1u);
+    char *output = item->path;
+    path_iterator = path_in_pack;
+
+    do
+    {
+        extraction = path_extract_next_part (&path_iterator, &part_begin, &part_end);
+        if (output != item->path)
+        {
+            *output = read_only_pack_path_separator;
+            ++output;
+        }
+
+        memcpy (output, part_begin, part_end - part_begin);
+        output += part_end - part_begin;
 
+    } while (extraction == PATH_EXTRACTION_RESULT_HAS_MORE_COMPONENTS_AFTER);
+
+    *output = '\0';
     item->size = 0u;
     item->offset =
         builder->output_stream->operations->tell (builder->output_stream) - builder->beginning_offset_in_stream;
@@ -2954,6 +2970,11 @@ bool kan_virtual_file_system_read_only_pack_builder_add (kan_virtual_file_system
     KAN_ASSERT (!builder_data->streamed_add_item)
 
     struct read_only_pack_registry_item_t *item = read_only_pack_builder_add_item (builder_data, path_in_pack);
+    if (!item)
+    {
+        return false;
+    }
+
     char buffer[KAN_VIRTUAL_FILE_SYSTEM_ROPACK_BUILDER_CHUNK_SIZE];
 
     while (true)
@@ -2989,6 +3010,33 @@ bool kan_virtual_file_system_read_only_pack_builder_add (kan_virtual_file_system
     return true;
 }
 
+bool kan_virtual_file_system_read_only_pack_builder_add_blob (kan_virtual_file_system_read_only_pack_builder_t builder,
+                                                              const void *data,
+                                                              kan_file_size_t size,
+                                                              const char *path_in_pack)
+{
+    struct read_only_pack_builder_t *builder_data = KAN_HANDLE_GET (builder);
+    KAN_ASSERT (builder_data->output_stream)
+    KAN_ASSERT (!builder_data->streamed_add_item)
+
+    struct read_only_pack_registry_item_t *item = read_only_pack_builder_add_item (builder_data, path_in_pack);
+    if (!item)
+    {
+        return false;
+    }
+
+    item->size = size;
+    if (size > 0u && builder_data->output_stream->operations->write (builder_data->output_stream, size, data) != size)
+    {
+        builder_data->output_stream = NULL;
+        read_only_pack_registry_reset (&builder_data->registry);
+        KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to write registry item at path \"%s\".", path_in_pack)
+        return false;
+    }
+
+    return true;
+}
+
 struct kan_stream_t *kan_virtual_file_system_read_only_pack_builder_add_streamed (
     kan_virtual_file_system_read_only_pack_builder_t builder, const char *path_in_pack)
 {
@@ -2997,12 +3045,405 @@ struct kan_stream_t *kan_virtual_file_system_read_only_pack_builder_add_streamed
     KAN_ASSERT (!builder_data->streamed_add_item)
 
     struct read_only_pack_registry_item_t *item = read_only_pack_builder_add_item (builder_data, path_in_pack);
+    if (!item)
+    {
+        return NULL;
+    }
+
     builder_data->streamed_add_item = item;
     builder_data->streamed_add_start_position =
         builder_data->output_stream->operations->tell (builder_data->output_stream);
     return &builder_data->streamed_add_proxy_stream;
 }
 
+struct read_only_pack_builder_directory_t
+{
+    const char *path;
+    kan_instance_size_t length;
+    kan_instance_size_t depth;
+    uint32_t parent;
+};
+
+struct read_only_pack_builder_file_t
+{
+    struct read_only_pack_registry_item_t *item;
+    uint32_t directory;
+};
+
+static inline kan_instance_size_t read_only_pack_builder_count_depth (const char *path, kan_instance_size_t length)
+{
+    kan_instance_size_t depth = 1u;
+    for (kan_loop_size_t index = 0u; index < length; ++index)
+    {
+        if (path[index] == read_only_pack_path_separator)
+        {
+            ++depth;
+        }
+    }
+
+    return depth;
+}
+
+static inline int read_only_pack_builder_compare_paths (const char *first_path,
+                                                        kan_instance_size_t first_length,
+                                                        const char *second_path,
+                                                        kan_instance_size_t second_length)
+{
+    const int result = memcmp (first_path, second_path, KAN_MIN (first_length, second_length));
+    if (result != 0)
+    {
+        return result;
+    }
+
+    return first_length < second_length ? -1 : (first_length > second_length ? 1 : 0);
+}
+
+static inline int read_only_pack_builder_compare_directories (const struct read_only_pack_builder_directory_t *first,
+                                                              const struct read_only_pack_builder_directory_t *second)
+{
+    // Sorting by depth first guarantees that children of one directory are contiguous, because paths of children
+    // of one directory share the same prefix and there are no other paths of the same depth between them.
+    if (first->depth != second->depth)
+    {
+        return first->depth < second->depth ? -1 : 1;
+    }
+
+    return read_only_pack_builder_compare_paths (first->path, first->length, second->path, second->length);
+}
+
+static uint32_t read_only_pack_builder_find_directory (const struct read_only_pack_builder_directory_t *directories,
+                                                       uint32_t directories_count,
+                                                       const char *path,
+                                                       kan_instance_size_t length)
+{
+    const struct read_only_pack_builder_directory_t query = {
+        .path = path,
+        .length = length,
+        .depth = length > 0u ? read_only_pack_builder_count_depth (path, length) : 0u,
+    };
+
+    uint32_t low = 0u;
+    uint32_t high = directories_count;
+
+    while (low < high)
+    {
+        const uint32_t middle = low + (high - low) / 2u;
+        const int comparison = read_only_pack_builder_compare_directories (&directories[middle], &query);
+
+        if (comparison == 0)
+        {
+            return middle;
+        }
+
+        if (comparison < 0)
+        {
+            low = middle + 1u;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return KAN_INT_MAX (uint32_t);
+}
+
+static inline kan_instance_size_t read_only_pack_builder_parent_length (const char *path, kan_instance_size_t length)
+{
+    while (length > 0u)
+    {
+        --length;
+        if (path[length] == read_only_pack_path_separator)
+        {
+            return length;
+        }
+    }
+
+    return 0u;
+}
+
+/// \brief Lowers added items into read only pack registry and writes it into output stream.
+static bool read_only_pack_builder_write_registry (struct read_only_pack_builder_t *builder)
+{
+    struct read_only_pack_registry_item_t *items = (struct read_only_pack_registry_item_t *) builder->registry.items.data;
+    const uint32_t items_count = (uint32_t) builder->registry.items.size;
+
+    // Gather all directory paths as prefixes of item paths. Root is represented by empty path.
+    kan_instance_size_t directory_candidates_count = 1u;
+    for (uint32_t index = 0u; index < items_count; ++index)
+    {
+        directory_candidates_count +=
+            read_only_pack_builder_count_depth (items[index].path, (kan_instance_size_t) strlen (items[index].path)) -
+            1u;
+    }
+
+    struct read_only_pack_builder_directory_t *directories = kan_allocate_general (
+        read_only_pack_operation_allocation_group,
+        sizeof (struct read_only_pack_builder_directory_t) * directory_candidates_count,
+        alignof (struct read_only_pack_builder_directory_t));
+
+    CUSHION_DEFER
+    {
+        kan_free_general (read_only_pack_operation_allocation_group, directories,
+                          sizeof (struct read_only_pack_builder_directory_t) * directory_candidates_count);
+    }
+
+    uint32_t directories_count = 0u;
+    directories[directories_count++] = (struct read_only_pack_builder_directory_t) {
+        .path = "",
+        .length = 0u,
+        .depth = 0u,
+        .parent = KAN_INT_MAX (uint32_t),
+    };
+
+    for (uint32_t index = 0u; index < items_count; ++index)
+    {
+        kan_instance_size_t depth = 0u;
+        for (const char *symbol = items[index].path; *symbol; ++symbol)
+        {
+            if (*symbol == read_only_pack_path_separator)
+            {
+                directories[directories_count++] = (struct read_only_pack_builder_directory_t) {
+                    .path = items[index].path,
+                    .length = (kan_instance_size_t) (symbol - items[index].path),
+                    .depth = ++depth,
+                    .parent = KAN_INT_MAX (uint32_t),
+                };
+            }
+        }
+    }
+
+    {
+        struct read_only_pack_builder_directory_t temporary;
+
+#define AT_INDEX(INDEX) (directories[INDEX])
+#define LESS(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__ read_only_pack_builder_compare_directories (&AT_INDEX (first_index), &AT_INDEX (second_index)) < 0
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = AT_INDEX (first_index), AT_INDEX (first_index) = AT_INDEX (second_index),                              \
+    AT_INDEX (second_index) = temporary
+
+        QSORT ((unsigned long) directories_count, LESS, SWAP);
+#undef LESS
+#undef SWAP
+#undef AT_INDEX
+    }
+
+    uint32_t unique_count = 1u;
+    for (uint32_t index = 1u; index < directories_count; ++index)
+    {
+        if (read_only_pack_builder_compare_directories (&directories[unique_count - 1u], &directories[index]) != 0)
+        {
+            directories[unique_count++] = directories[index];
+        }
+    }
+
+    directories_count = unique_count;
+    struct read_only_pack_builder_file_t *files =
+        items_count > 0u ?
+            kan_allocate_general (read_only_pack_operation_allocation_group,
+                                  sizeof (struct read_only_pack_builder_file_t) * items_count,
+                                  alignof (struct read_only_pack_builder_file_t)) :
+            NULL;
+
+    CUSHION_DEFER
+    {
+        if (files)
+        {
+            kan_free_general (read_only_pack_operation_allocation_group, files,
+                              sizeof (struct read_only_pack_builder_file_t) * items_count);
+        }
+    }
+
+    kan_instance_size_t strings_size = 1u;
+    for (uint32_t index = 1u; index < directories_count; ++index)
+    {
+        const kan_instance_size_t parent_length =
+            read_only_pack_builder_parent_length (directories[index].path, directories[index].length);
+        directories[index].parent = read_only_pack_builder_find_directory (directories, directories_count,
+                                                                           directories[index].path, parent_length);
+        KAN_ASSERT (directories[index].parent != KAN_INT_MAX (uint32_t))
+        strings_size += directories[index].length + 1u;
+    }
+
+    for (uint32_t index = 0u; index < items_count; ++index)
+    {
+        const kan_instance_size_t length = (kan_instance_size_t) strlen (items[index].path);
+        if (read_only_pack_builder_find_directory (directories, directories_count, items[index].path, length) !=
+            KAN_INT_MAX (uint32_t))
+        {
+            KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
+                     "Failed to add file inside read only pack \"%s\", directory with this name already exists!",
+                     items[index].path)
+            return false;
+        }
+
+        files[index].item = &items[index];
+        files[index].directory = read_only_pack_builder_find_directory (
+            directories, directories_count, items[index].path,
+            read_only_pack_builder_parent_length (items[index].path, length));
+        KAN_ASSERT (files[index].directory != KAN_INT_MAX (uint32_t))
+        strings_size += length + 1u;
+    }
+
+    {
+        struct read_only_pack_builder_file_t temporary;
+
+#define AT_INDEX(INDEX) (files[INDEX])
+#define LESS(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__ (AT_INDEX (first_index).directory < AT_INDEX (second_index).directory ||                      \
+                          (AT_INDEX (first_index).directory == AT_INDEX (second_index).directory &&                    \
+                           strcmp (AT_INDEX (first_index).item->path, AT_INDEX (second_index).item->path) < 0))
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = AT_INDEX (first_index), AT_INDEX (first_index) = AT_INDEX (second_index),                              \
+    AT_INDEX (second_index) = temporary
+
+        QSORT ((unsigned long) items_count, LESS, SWAP);
+#undef LESS
+#undef SWAP
+#undef AT_INDEX
+    }
+
+    for (uint32_t index = 1u; index < items_count; ++index)
+    {
+        if (strcmp (files[index - 1u].item->path, files[index].item->path) == 0)
+        {
+            KAN_LOG (virtual_file_system, KAN_LOG_ERROR,
+                     "Failed to add file inside read only pack \"%s\", file with this name already exists!",
+                     files[index].item->path)
+            return false;
+        }
+    }
+
+    struct read_only_pack_registry_header_t header = {
+        .magic = READ_ONLY_PACK_REGISTRY_MAGIC,
+        .version = READ_ONLY_PACK_REGISTRY_VERSION,
+        .directories_count = directories_count,
+        .files_count = items_count,
+        .lookup_count = directories_count - 1u + items_count,
+        .strings_size = (uint32_t) strings_size,
+    };
+
+    const struct read_only_pack_registry_layout_t layout = read_only_pack_registry_calculate_layout (&header);
+    uint8_t *registry_data = kan_allocate_general (read_only_pack_operation_allocation_group, layout.total_size,
+                                                   READ_ONLY_PACK_REGISTRY_ALIGNMENT);
+    CUSHION_DEFER { kan_free_general (read_only_pack_operation_allocation_group, registry_data, layout.total_size); }
+    memset (registry_data, 0, layout.total_size);
+
+    struct read_only_pack_directory_t *output_directories =
+        (struct read_only_pack_directory_t *) (registry_data + layout.directories_offset);
+    struct read_only_pack_file_t *output_files = (struct read_only_pack_file_t *) (registry_data + layout.files_offset);
+    struct read_only_pack_lookup_t *output_lookup =
+        (struct read_only_pack_lookup_t *) (registry_data + layout.lookup_offset);
+    char *output_strings = (char *) (registry_data + layout.strings_offset);
+
+    // Zero offset in string blob is an empty string that is used for the root directory.
+    uint32_t string_offset = 1u;
+    uint32_t lookup_index = 0u;
+
+    for (uint32_t index = 0u; index < directories_count; ++index)
+    {
+        struct read_only_pack_directory_t *output = &output_directories[index];
+        output->first_child = 0u;
+        output->children_count = 0u;
+        output->first_file = 0u;
+        output->files_count = 0u;
+
+        if (index == 0u)
+        {
+            output->path_offset = 0u;
+            output->name_offset = 0u;
+            continue;
+        }
+
+        const struct read_only_pack_builder_directory_t *directory = &directories[index];
+        const kan_instance_size_t parent_length =
+            read_only_pack_builder_parent_length (directory->path, directory->length);
+
+        output->path_offset = string_offset;
+        output->name_offset = string_offset + (parent_length > 0u ? parent_length + 1u : 0u);
+        memcpy (output_strings + string_offset, directory->path, directory->length);
+        output_strings[string_offset + directory->length] = '\0';
+        string_offset += directory->length + 1u;
+
+        struct read_only_pack_directory_t *parent = &output_directories[directory->parent];
+        if (parent->children_count == 0u)
+        {
+            parent->first_child = index;
+        }
+
+        KAN_ASSERT (parent->first_child + parent->children_count == index)
+        ++parent->children_count;
+
+        struct read_only_pack_lookup_t *lookup = &output_lookup[lookup_index++];
+        read_only_pack_path_hash (output_strings + output->path_offset, &lookup->path_hash);
+        lookup->index = index;
+        lookup->is_directory = 1u;
+    }
+
+    for (uint32_t index = 0u; index < items_count; ++index)
+    {
+        const struct read_only_pack_builder_file_t *file = &files[index];
+        struct read_only_pack_file_t *output = &output_files[index];
+        const kan_instance_size_t length = (kan_instance_size_t) strlen (file->item->path);
+        const kan_instance_size_t parent_length = read_only_pack_builder_parent_length (file->item->path, length);
+
+        output->offset = file->item->offset;
+        output->size = file->item->size;
+        output->path_offset = string_offset;
+        output->name_offset = string_offset + (parent_length > 0u ? parent_length + 1u : 0u);
+        memcpy (output_strings + string_offset, file->item->path, length + 1u);
+        string_offset += length + 1u;
+
+        struct read_only_pack_directory_t *parent = &output_directories[file->directory];
+        if (parent->files_count == 0u)
+        {
+            parent->first_file = index;
+        }
+
+        KAN_ASSERT (parent->first_file + parent->files_count == index)
+        ++parent->files_count;
+
+        struct read_only_pack_lookup_t *lookup = &output_lookup[lookup_index++];
+        read_only_pack_path_hash (output_strings + output->path_offset, &lookup->path_hash);
+        lookup->index = index;
+        lookup->is_directory = 0u;
+    }
+
+    KAN_ASSERT (string_offset == strings_size)
+    KAN_ASSERT (lookup_index == header.lookup_count)
+
+    {
+        struct read_only_pack_lookup_t temporary;
+
+#define AT_INDEX(INDEX) (output_lookup[INDEX])
+#define LESS(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__ AT_INDEX (first_index).path_hash < AT_INDEX (second_index).path_hash
+#define SWAP(first_index, second_index)                                                                                \
+    __CUSHION_PRESERVE__                                                                                               \
+    temporary = AT_INDEX (first_index), AT_INDEX (first_index) = AT_INDEX (second_index),                              \
+    AT_INDEX (second_index) = temporary
+
+        QSORT ((unsigned long) header.lookup_count, LESS, SWAP);
+#undef LESS
+#undef SWAP
+#undef AT_INDEX
+    }
+
+    if (builder->output_stream->operations->write (builder->output_stream, sizeof (header), &header) !=
+            sizeof (header) ||
+        builder->output_stream->operations->write (builder->output_stream, layout.total_size, registry_data) !=
+            layout.total_size)
+    {
+        KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to write registry for new read only pack.")
+        return false;
+    }
+
+    return true;
+}
+
 bool kan_virtual_file_system_read_only_pack_builder_finalize (kan_virtual_file_system_read_only_pack_builder_t builder)
 {
     struct read_only_pack_builder_t *builder_data = KAN_HANDLE_GET (builder);
@@ -3041,28 +3482,13 @@ bool kan_virtual_file_system_read_only_pack_builder_finalize (kan_virtual_file_s
         return false;
     }
 
-    kan_serialization_binary_writer_t writer = kan_serialization_binary_writer_create (
-        builder_data->output_stream, &builder_data->registry, KAN_STATIC_INTERNED_ID_GET (read_only_pack_registry_t),
-        serialization_script_storage, KAN_HANDLE_SET_INVALID (kan_serialization_interned_string_registry_t));
-
-    enum kan_serialization_state_t state = KAN_SERIALIZATION_IN_PROGRESS;
-    while (state != KAN_SERIALIZATION_FINISHED)
+    if (!read_only_pack_builder_write_registry (builder_data))
     {
-        switch ((state = kan_serialization_binary_writer_step (writer)))
-        {
-        case KAN_SERIALIZATION_IN_PROGRESS:
-        case KAN_SERIALIZATION_FINISHED:
-            break;
-
-        case KAN_SERIALIZATION_FAILED:
-            builder_data->output_stream = NULL;
-            read_only_pack_registry_reset (&builder_data->registry);
-            KAN_LOG (virtual_file_system, KAN_LOG_ERROR, "Failed to write registry for new read only pack.")
-            return false;
-        }
+        builder_data->output_stream = NULL;
+        read_only_pack_registry_reset (&builder_data->registry);
+        return false;
     }
 
-    kan_serialization_binary_writer_destroy (writer);
     builder_data->output_stream = NULL;
     read_only_pack_registry_reset (&builder_data->registry);
     return true;